@@ -4,7 +4,10 @@
 
 #include "wpi/apriltag/AprilTagDetector.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <numeric>
 #include <utility>
 
 #ifdef _WIN32
@@ -51,6 +54,13 @@ AprilTagDetector& AprilTagDetector::operator=(AprilTagDetector&& rhs) {
   m_families = std::move(rhs.m_families);
   rhs.m_families.clear();
   m_qtpCriticalAngle = rhs.m_qtpCriticalAngle;
+  m_trackingConfig = rhs.m_trackingConfig;
+  m_tracked = std::move(rhs.m_tracked);
+  m_predicted = std::move(rhs.m_predicted);
+  m_framesSinceFullScan = rhs.m_framesSinceFullScan;
+  m_lastWidth = rhs.m_lastWidth;
+  m_lastHeight = rhs.m_lastHeight;
+  m_lastDetectFullFrame = rhs.m_lastDetectFullFrame;
   return *this;
 }
 
@@ -103,6 +113,25 @@ AprilTagDetector::GetQuadThresholdParameters() const {
   };
 }
 
+void AprilTagDetector::SetTrackingConfig(const TrackingConfig& config) {
+  m_trackingConfig = config;
+  ResetTracking();
+}
+
+void AprilTagDetector::ResetTracking() {
+  m_tracked.clear();
+  m_predicted.clear();
+  m_framesSinceFullScan = 0;
+  m_lastWidth = 0;
+  m_lastHeight = 0;
+}
+
+void AprilTagDetector::AddTrackingPrediction(
+    std::span<const double, 8> corners) {
+  auto& predicted = m_predicted.emplace_back();
+  std::copy(corners.begin(), corners.end(), predicted.begin());
+}
+
 bool AprilTagDetector::AddFamily(std::string_view fam, int bitsCorrected) {
   auto& data = m_families[fam];
   if (data) {
@@ -143,10 +172,166 @@ void AprilTagDetector::ClearFamilies() {
 
 AprilTagDetector::Results AprilTagDetector::Detect(int width, int height,
                                                    int stride, uint8_t* buf) {
-  image_u8_t img{width, height, stride, buf};
-  return {
-      apriltag_detector_detect(static_cast<apriltag_detector_t*>(m_impl), &img),
-      Results::private_init{}};
+  auto td = static_cast<apriltag_detector_t*>(m_impl);
+  if (!m_trackingConfig.enabled) {
+    image_u8_t img{width, height, stride, buf};
+    return {apriltag_detector_detect(td, &img), Results::private_init{}};
+  }
+
+  zarray_t* detections = nullptr;
+  if (width == m_lastWidth && height == m_lastHeight &&
+      m_framesSinceFullScan + 1 < m_trackingConfig.fullScanPeriod &&
+      (!m_tracked.empty() || !m_predicted.empty())) {
+    detections =
+        static_cast<zarray_t*>(DetectRegions(width, height, stride, buf));
+    // a tracked tag was lost; rescan the whole frame for it
+    if (detections &&
+        zarray_size(detections) < static_cast<int>(m_tracked.size())) {
+      apriltag_detections_destroy(detections);
+      detections = nullptr;
+    }
+  }
+  m_predicted.clear();
+
+  if (detections) {
+    ++m_framesSinceFullScan;
+    m_lastDetectFullFrame = false;
+  } else {
+    image_u8_t img{width, height, stride, buf};
+    detections = apriltag_detector_detect(td, &img);
+    m_framesSinceFullScan = 0;
+    m_lastDetectFullFrame = true;
+  }
+  m_lastWidth = width;
+  m_lastHeight = height;
+
+  UpdateTracking(detections);
+  return {detections, Results::private_init{}};
+}
+
+AprilTagDetector::Region AprilTagDetector::ExpandRegion(
+    std::span<const double, 8> corners, int width, int height) const {
+  double minX = corners[0];
+  double maxX = corners[0];
+  double minY = corners[1];
+  double maxY = corners[1];
+  for (int i = 1; i < 4; ++i) {
+    minX = std::min(minX, corners[i * 2]);
+    maxX = std::max(maxX, corners[i * 2]);
+    minY = std::min(minY, corners[i * 2 + 1]);
+    maxY = std::max(maxY, corners[i * 2 + 1]);
+  }
+  double pad = std::max(static_cast<double>(m_trackingConfig.minPadding),
+                        m_trackingConfig.paddingScale *
+                            std::max(maxX - minX, maxY - minY));
+
+  auto clampTo = [](double v, int max) {
+    return static_cast<int>(std::clamp(v, 0.0, static_cast<double>(max)));
+  };
+  // Align the origin so the decimation and threshold tile grids match those
+  // of a full-frame scan. Threshold tiles are 4 decimated pixels; 1.5x
+  // decimation works on 3x3 pixel blocks. Also keep it a multiple of 8 for
+  // the SIMD row kernels.
+  float decimate = static_cast<apriltag_detector_t*>(m_impl)->quad_decimate;
+  int align = 8;
+  if (decimate == 1.5f) {
+    align = 24;
+  } else if (decimate > 1) {
+    align = std::lcm(8, 4 * static_cast<int>(decimate));
+  }
+  auto alignTo = [&](int v) { return v / align * align; };
+  return {alignTo(clampTo(std::floor(minX - pad), width)),
+          alignTo(clampTo(std::floor(minY - pad), height)),
+          clampTo(std::ceil(maxX + pad), width),
+          clampTo(std::ceil(maxY + pad), height)};
+}
+
+static void TranslateDetection(apriltag_detection_t* det, double dx,
+                               double dy) {
+  det->c[0] += dx;
+  det->c[1] += dy;
+  for (auto& p : det->p) {
+    p[0] += dx;
+    p[1] += dy;
+  }
+  // Premultiply the homography by the translation
+  for (int col = 0; col < 3; ++col) {
+    MATD_EL(det->H, 0, col) += dx * MATD_EL(det->H, 2, col);
+    MATD_EL(det->H, 1, col) += dy * MATD_EL(det->H, 2, col);
+  }
+}
+
+void* AprilTagDetector::DetectRegions(int width, int height, int stride,
+                                      uint8_t* buf) {
+  std::vector<Region> regions;
+  regions.reserve(m_tracked.size() + m_predicted.size());
+  for (auto&& corners : m_tracked) {
+    regions.emplace_back(ExpandRegion(corners, width, height));
+  }
+  for (auto&& corners : m_predicted) {
+    regions.emplace_back(ExpandRegion(corners, width, height));
+  }
+
+  // Merge overlapping regions so a tag can't be detected twice
+  for (bool merged = true; merged;) {
+    merged = false;
+    for (size_t i = 0; i < regions.size() && !merged; ++i) {
+      for (size_t j = i + 1; j < regions.size(); ++j) {
+        auto& a = regions[i];
+        auto& b = regions[j];
+        if (a.x0 <= b.x1 && b.x0 <= a.x1 && a.y0 <= b.y1 && b.y0 <= a.y1) {
+          a = {std::min(a.x0, b.x0), std::min(a.y0, b.y0),
+               std::max(a.x1, b.x1), std::max(a.y1, b.y1)};
+          regions.erase(regions.begin() + j);
+          merged = true;
+          break;
+        }
+      }
+    }
+  }
+
+  int64_t area = 0;
+  for (auto&& r : regions) {
+    area += static_cast<int64_t>(r.x1 - r.x0) * (r.y1 - r.y0);
+  }
+  if (area > m_trackingConfig.maxRegionFraction * width * height) {
+    return nullptr;
+  }
+
+  auto td = static_cast<apriltag_detector_t*>(m_impl);
+  zarray_t* detections = zarray_create(sizeof(apriltag_detection_t*));
+  for (auto&& r : regions) {
+    // too small to contain a tag (e.g. a prediction outside the frame)
+    if (r.x1 - r.x0 < 8 || r.y1 - r.y0 < 8) {
+      continue;
+    }
+    image_u8_t img{r.x1 - r.x0, r.y1 - r.y0, stride,
+                   buf + r.y0 * stride + r.x0};
+    zarray_t* regionDetections = apriltag_detector_detect(td, &img);
+    for (int i = 0; i < zarray_size(regionDetections); ++i) {
+      apriltag_detection_t* det;
+      zarray_get(regionDetections, i, &det);
+      TranslateDetection(det, r.x0, r.y0);
+      zarray_add(detections, &det);
+    }
+    // the detections are now owned by the combined array
+    zarray_destroy(regionDetections);
+  }
+  return detections;
+}
+
+void AprilTagDetector::UpdateTracking(void* detections) {
+  auto dets = static_cast<zarray_t*>(detections);
+  m_tracked.clear();
+  for (int i = 0; i < zarray_size(dets); ++i) {
+    apriltag_detection_t* det;
+    zarray_get(dets, i, &det);
+    auto& corners = m_tracked.emplace_back();
+    for (int j = 0; j < 4; ++j) {
+      corners[j * 2] = det->p[j][0];
+      corners[j * 2 + 1] = det->p[j][1];
+    }
+  }
 }
 
 void AprilTagDetector::Destroy() {
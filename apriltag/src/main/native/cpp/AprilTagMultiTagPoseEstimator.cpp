@@ -0,0 +1,305 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/apriltag/AprilTagMultiTagPoseEstimator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <Eigen/Cholesky>
+#include <Eigen/Geometry>
+#include <Eigen/LU>
+#include <Eigen/SVD>
+
+#include "wpi/apriltag/AprilTagDetection.hpp"
+
+using namespace wpi::apriltag;
+
+namespace {
+
+// Tag corner coordinates in units of half the tag size, in the same order as
+// the detection corners, in the apriltag tag frame (X right, Y down)
+constexpr double kCornerCoords[4][2] = {{-1, 1}, {1, 1}, {1, -1}, {-1, -1}};
+
+// Rotation from the apriltag tag frame (X right, Y down, Z into the tag) to
+// the WPILib tag frame (X out of the tag, Y right as seen facing the tag, Z up)
+const Eigen::Matrix3d kTagFromApriltag{{0, 0, -1}, {1, 0, 0}, {0, -1, 0}};
+
+// Rotation from the camera (X forward, Y left, Z up) to the optical frame
+// (X right, Y down, Z forward)
+const Eigen::Matrix3d kOpticalFromCamera{{0, -1, 0}, {0, 0, -1}, {1, 0, 0}};
+
+// Field to optical frame transform: p_optical = rotation * p_field +
+// translation
+struct CameraTransform {
+  Eigen::Matrix3d rotation;
+  Eigen::Vector3d translation;
+};
+
+Eigen::Matrix3d Orthonormalize(const Eigen::Matrix3d& m) {
+  Eigen::JacobiSVD<Eigen::Matrix3d> svd{
+      m, Eigen::ComputeFullU | Eigen::ComputeFullV};
+  Eigen::Matrix3d u = svd.matrixU();
+  if ((u * svd.matrixV().transpose()).determinant() < 0) {
+    u.col(2) = -u.col(2);
+  }
+  return u * svd.matrixV().transpose();
+}
+
+}  // namespace
+
+void AprilTagMultiTagPoseEstimator::SetConfig(
+    const AprilTagPoseEstimator::Config& config) {
+  bool resize = config.tagSize != m_config.tagSize;
+  m_config = config;
+  if (resize) {
+    for (auto&& tag : m_tags) {
+      UpdateTagCorners(tag);
+    }
+  }
+}
+
+void AprilTagMultiTagPoseEstimator::AddTagPose(int id,
+                                               const wpi::math::Pose3d& pose) {
+  auto it = std::lower_bound(
+      m_tags.begin(), m_tags.end(), id,
+      [](const Tag& tag, int id) { return tag.id < id; });
+  if (it == m_tags.end() || it->id != id) {
+    it = m_tags.insert(it, Tag{});
+    it->id = id;
+  }
+  it->rotation = pose.Rotation().ToMatrix() * kTagFromApriltag;
+  it->translation = pose.Translation().ToVector();
+  UpdateTagCorners(*it);
+}
+
+const AprilTagMultiTagPoseEstimator::Tag*
+AprilTagMultiTagPoseEstimator::FindTag(int id) const {
+  auto it = std::lower_bound(
+      m_tags.begin(), m_tags.end(), id,
+      [](const Tag& tag, int id) { return tag.id < id; });
+  if (it == m_tags.end() || it->id != id) {
+    return nullptr;
+  }
+  return &*it;
+}
+
+void AprilTagMultiTagPoseEstimator::UpdateTagCorners(Tag& tag) const {
+  double halfSize = m_config.tagSize.value() / 2;
+  for (int i = 0; i < 4; ++i) {
+    tag.corners[i] =
+        tag.rotation * Eigen::Vector3d{kCornerCoords[i][0] * halfSize,
+                                       kCornerCoords[i][1] * halfSize, 0} +
+        tag.translation;
+  }
+}
+
+std::optional<AprilTagMultiTagPoseEstimator::Result>
+AprilTagMultiTagPoseEstimator::Estimate(
+    std::span<const AprilTagDetection* const> detections) {
+  m_observations.clear();
+  for (auto&& detection : detections) {
+    const Tag* tag = FindTag(detection->GetId());
+    if (!tag) {
+      continue;
+    }
+    auto& obs = m_observations.emplace_back();
+    obs.tag = tag;
+    for (int i = 0; i < 4; ++i) {
+      auto& corner = detection->GetCorner(i);
+      obs.pixels[i] = {corner.x, corner.y};
+    }
+  }
+  return Solve();
+}
+
+std::optional<AprilTagMultiTagPoseEstimator::Result>
+AprilTagMultiTagPoseEstimator::Estimate(
+    std::span<const int> ids, std::span<const std::array<double, 8>> corners) {
+  m_observations.clear();
+  size_t count = std::min(ids.size(), corners.size());
+  for (size_t i = 0; i < count; ++i) {
+    const Tag* tag = FindTag(ids[i]);
+    if (!tag) {
+      continue;
+    }
+    auto& obs = m_observations.emplace_back();
+    obs.tag = tag;
+    for (int j = 0; j < 4; ++j) {
+      obs.pixels[j] = {corners[i][j * 2], corners[i][j * 2 + 1]};
+    }
+  }
+  return Solve();
+}
+
+namespace {
+
+struct Intrinsics {
+  double fx;
+  double fy;
+  double cx;
+  double cy;
+};
+
+// Estimates the pose of one tag in the optical frame from its corners using
+// the planar homography (tag frame to optical frame)
+CameraTransform EstimateTagHomography(
+    const std::array<Eigen::Vector2d, 4>& pixels, const Intrinsics& k,
+    double halfSize) {
+  // homography from tag coordinates to pixels, with H(2, 2) = 1
+  Eigen::Matrix<double, 8, 8> A;
+  Eigen::Vector<double, 8> b;
+  for (int i = 0; i < 4; ++i) {
+    double x = kCornerCoords[i][0];
+    double y = kCornerCoords[i][1];
+    double u = pixels[i].x();
+    double v = pixels[i].y();
+    A.row(i * 2) << x, y, 1, 0, 0, 0, -u * x, -u * y;
+    A.row(i * 2 + 1) << 0, 0, 0, x, y, 1, -v * x, -v * y;
+    b(i * 2) = u;
+    b(i * 2 + 1) = v;
+  }
+  Eigen::Vector<double, 8> h = A.partialPivLu().solve(b);
+
+  // remove intrinsics
+  Eigen::Matrix3d M;
+  M.row(2) << h(6), h(7), 1;
+  M.row(0) = (Eigen::RowVector3d{h(0), h(1), h(2)} - k.cx * M.row(2)) / k.fx;
+  M.row(1) = (Eigen::RowVector3d{h(3), h(4), h(5)} - k.cy * M.row(2)) / k.fy;
+
+  // the first two columns are the scaled rotation axes; the tag must be in
+  // front of the camera
+  double scale = 1.0 / std::sqrt(M.col(0).norm() * M.col(1).norm());
+  if (M(2, 2) < 0) {
+    scale = -scale;
+  }
+  Eigen::Matrix3d R;
+  R.col(0) = M.col(0) * scale;
+  R.col(1) = M.col(1) * scale;
+  R.col(2) = R.col(0).cross(R.col(1));
+  return {Orthonormalize(R), M.col(2) * scale * halfSize};
+}
+
+// Sum of squared reprojection errors, or infinity if any point is behind the
+// camera
+template <typename Observations>
+double ReprojectionCost(const Observations& observations,
+                        const CameraTransform& camera, const Intrinsics& k) {
+  double cost = 0;
+  for (auto&& obs : observations) {
+    for (int i = 0; i < 4; ++i) {
+      Eigen::Vector3d p =
+          camera.rotation * obs.tag->corners[i] + camera.translation;
+      if (p.z() <= 1e-9) {
+        return std::numeric_limits<double>::infinity();
+      }
+      double du = k.fx * p.x() / p.z() + k.cx - obs.pixels[i].x();
+      double dv = k.fy * p.y() / p.z() + k.cy - obs.pixels[i].y();
+      cost += du * du + dv * dv;
+    }
+  }
+  return cost;
+}
+
+}  // namespace
+
+std::optional<AprilTagMultiTagPoseEstimator::Result>
+AprilTagMultiTagPoseEstimator::Solve() {
+  if (m_observations.empty()) {
+    return {};
+  }
+
+  const Intrinsics k{m_config.fx, m_config.fy, m_config.cx, m_config.cy};
+  const double halfSize = m_config.tagSize.value() / 2;
+
+  // Initialize from whichever single-tag homography best explains all of the
+  // observations
+  CameraTransform camera;
+  double cost = std::numeric_limits<double>::infinity();
+  for (auto&& obs : m_observations) {
+    auto tagPose = EstimateTagHomography(obs.pixels, k, halfSize);
+    CameraTransform candidate;
+    candidate.rotation = tagPose.rotation * obs.tag->rotation.transpose();
+    candidate.translation =
+        tagPose.translation - candidate.rotation * obs.tag->translation;
+    double candidateCost = ReprojectionCost(m_observations, candidate, k);
+    if (candidateCost < cost) {
+      camera = candidate;
+      cost = candidateCost;
+    }
+  }
+  if (!std::isfinite(cost)) {
+    return {};
+  }
+
+  // Levenberg-Marquardt over a left-multiplied perturbation of the field to
+  // optical transform; the normal equations are accumulated directly so no
+  // Jacobian storage is needed
+  double lambda = 1e-3;
+  for (int iter = 0; iter < m_maxIterations; ++iter) {
+    Eigen::Matrix<double, 6, 6> JtJ = Eigen::Matrix<double, 6, 6>::Zero();
+    Eigen::Vector<double, 6> Jtr = Eigen::Vector<double, 6>::Zero();
+    for (auto&& obs : m_observations) {
+      for (int i = 0; i < 4; ++i) {
+        Eigen::Vector3d p =
+            camera.rotation * obs.tag->corners[i] + camera.translation;
+        double iz = 1.0 / p.z();
+        Eigen::Vector2d r{k.fx * p.x() * iz + k.cx - obs.pixels[i].x(),
+                          k.fy * p.y() * iz + k.cy - obs.pixels[i].y()};
+        Eigen::Matrix<double, 2, 3> dproj;
+        dproj << k.fx * iz, 0, -k.fx * p.x() * iz * iz, 0, k.fy * iz,
+            -k.fy * p.y() * iz * iz;
+        Eigen::Matrix3d pCross;
+        pCross << 0, -p.z(), p.y(), p.z(), 0, -p.x(), -p.y(), p.x(), 0;
+        Eigen::Matrix<double, 2, 6> J;
+        J << -dproj * pCross, dproj;
+        JtJ.noalias() += J.transpose() * J;
+        Jtr.noalias() += J.transpose() * r;
+      }
+    }
+
+    bool improved = false;
+    bool converged = false;
+    while (lambda < 1e10) {
+      Eigen::Matrix<double, 6, 6> A = JtJ;
+      A.diagonal() *= 1 + lambda;
+      Eigen::Vector<double, 6> delta = A.ldlt().solve(-Jtr);
+
+      Eigen::Vector3d omega = delta.head<3>();
+      double angle = omega.norm();
+      Eigen::Matrix3d dR = Eigen::Matrix3d::Identity();
+      if (angle > 0) {
+        dR = Eigen::AngleAxisd{angle, omega / angle}.toRotationMatrix();
+      }
+      CameraTransform candidate{dR * camera.rotation,
+                                dR * camera.translation + delta.tail<3>()};
+      double candidateCost = ReprojectionCost(m_observations, candidate, k);
+      if (candidateCost < cost) {
+        converged = cost - candidateCost <= 1e-12 * cost ||
+                    delta.squaredNorm() < 1e-20;
+        camera = candidate;
+        cost = candidateCost;
+        lambda = std::max(lambda / 10, 1e-9);
+        improved = true;
+        break;
+      }
+      lambda *= 10;
+    }
+    if (!improved || converged) {
+      break;
+    }
+  }
+
+  // invert to get the camera pose in the field
+  Eigen::Matrix3d fieldFromOptical =
+      Orthonormalize(camera.rotation).transpose();
+  Eigen::Vector3d position = -fieldFromOptical * camera.translation;
+  return Result{
+      wpi::math::Pose3d{wpi::math::Translation3d{position},
+                        wpi::math::Rotation3d{Orthonormalize(
+                            fieldFromOptical * kOpticalFromCamera)}},
+      std::sqrt(cost / (4 * m_observations.size())),
+      static_cast<int>(m_observations.size())};
+}
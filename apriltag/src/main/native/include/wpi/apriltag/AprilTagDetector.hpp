@@ -6,10 +6,12 @@
 
 #include <stdint.h>
 
+#include <array>
 #include <memory>
 #include <span>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "wpi/apriltag/AprilTagDetection.hpp"
 #include "wpi/units/angle.hpp"
@@ -123,6 +125,46 @@ class WPILIB_DLLEXPORT AprilTagDetector {
     bool deglitch = false;
   };
 
+  /**
+   * Region-of-interest tracking configuration. When enabled, Detect() only
+   * searches expanded regions around the tags found in the previous frame
+   * (plus any predicted regions), periodically falling back to a full-frame
+   * scan to pick up new tags.
+   */
+  struct TrackingConfig {
+    bool operator==(const TrackingConfig&) const = default;
+
+    /**
+     * Whether tracking is enabled. Default is disabled (false).
+     */
+    bool enabled = false;
+
+    /**
+     * A full-frame scan is done at least once every this many frames. Default
+     * is 10 frames.
+     */
+    int fullScanPeriod = 10;
+
+    /**
+     * Padding added to each side of a tag's bounding box to form its search
+     * region, as a fraction of the larger bounding box dimension. Should be
+     * large enough to cover the tag's motion between frames. Default is 0.5.
+     */
+    double paddingScale = 0.5;
+
+    /**
+     * Minimum padding added to each side of a tag's bounding box, in pixels.
+     * Default is 16 pixels.
+     */
+    int minPadding = 16;
+
+    /**
+     * When the search regions cover more than this fraction of the frame, a
+     * full-frame scan is done instead. Default is 0.5.
+     */
+    double maxRegionFraction = 0.5;
+  };
+
   /**
    * Array of detection results. Each array element is a pointer to an
    * AprilTagDetection.
@@ -155,7 +197,14 @@ class WPILIB_DLLEXPORT AprilTagDetector {
   AprilTagDetector(AprilTagDetector&& rhs)
       : m_impl{rhs.m_impl},
         m_families{std::move(rhs.m_families)},
-        m_qtpCriticalAngle{rhs.m_qtpCriticalAngle} {
+        m_qtpCriticalAngle{rhs.m_qtpCriticalAngle},
+        m_trackingConfig{rhs.m_trackingConfig},
+        m_tracked{std::move(rhs.m_tracked)},
+        m_predicted{std::move(rhs.m_predicted)},
+        m_framesSinceFullScan{rhs.m_framesSinceFullScan},
+        m_lastWidth{rhs.m_lastWidth},
+        m_lastHeight{rhs.m_lastHeight},
+        m_lastDetectFullFrame{rhs.m_lastDetectFullFrame} {
     rhs.m_impl = nullptr;
   }
   AprilTagDetector& operator=(AprilTagDetector&& rhs);
@@ -193,6 +242,54 @@ class WPILIB_DLLEXPORT AprilTagDetector {
    */
   QuadThresholdParameters GetQuadThresholdParameters() const;
 
+  /**
+   * Sets region-of-interest tracking configuration. Changing the
+   * configuration resets tracking, so the next detection scans the full
+   * frame.
+   *
+   * @param config Configuration
+   */
+  void SetTrackingConfig(const TrackingConfig& config);
+
+  /**
+   * Gets region-of-interest tracking configuration.
+   *
+   * @return Configuration
+   */
+  TrackingConfig GetTrackingConfig() const { return m_trackingConfig; }
+
+  /** @} */
+
+  /**
+   * @{
+   * @name Tracking functions
+   */
+
+  /**
+   * Forgets all tracked tags and predictions, so the next detection scans the
+   * full frame.
+   */
+  void ResetTracking();
+
+  /**
+   * Adds a predicted tag location for the next detection when tracking is
+   * enabled, e.g. from projecting the tag corners through a predicted camera
+   * pose. The region around the predicted corners is searched in addition to
+   * the regions around the previous frame's detections. Predictions are
+   * cleared after each detection.
+   *
+   * @param corners predicted corner pixel coordinates (x0, y0, x1, y1, ...)
+   */
+  void AddTrackingPrediction(std::span<const double, 8> corners);
+
+  /**
+   * Gets whether the most recent detection scanned the full frame (as opposed
+   * to only tracked regions).
+   *
+   * @return True if the last detection was a full-frame scan
+   */
+  bool WasLastDetectFullFrame() const { return m_lastDetectFullFrame; }
+
   /** @} */
 
   /**
@@ -227,6 +324,9 @@ class WPILIB_DLLEXPORT AprilTagDetector {
    * Detect tags from an 8-bit image.
    * The image must be grayscale.
    *
+   * When tracking is enabled (see SetTrackingConfig()), consecutive calls are
+   * assumed to be consecutive frames from the same camera.
+   *
    * @param width width of the image
    * @param height height of the image
    * @param stride number of bytes between image rows (often the same as width)
@@ -253,9 +353,30 @@ class WPILIB_DLLEXPORT AprilTagDetector {
   void DestroyFamilies();
   void DestroyFamily(std::string_view name, void* data);
 
+  struct Region {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+  };
+
+  Region ExpandRegion(std::span<const double, 8> corners, int width,
+                      int height) const;
+  void* DetectRegions(int width, int height, int stride, uint8_t* buf);
+  void UpdateTracking(void* detections);
+
   void* m_impl;
   wpi::util::StringMap<void*> m_families;
   wpi::units::radian_t m_qtpCriticalAngle = 10_deg;
+
+  TrackingConfig m_trackingConfig;
+  // corners of the tags found by the last detection
+  std::vector<std::array<double, 8>> m_tracked;
+  std::vector<std::array<double, 8>> m_predicted;
+  int m_framesSinceFullScan = 0;
+  int m_lastWidth = 0;
+  int m_lastHeight = 0;
+  bool m_lastDetectFullFrame = true;
 };
 
 }  // namespace wpi::apriltag
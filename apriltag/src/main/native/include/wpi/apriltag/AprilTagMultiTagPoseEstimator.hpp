@@ -0,0 +1,153 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <array>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "wpi/apriltag/AprilTagPoseEstimator.hpp"
+#include "wpi/math/geometry/Pose3d.hpp"
+#include "wpi/util/SymbolExports.hpp"
+
+namespace wpi::apriltag {
+
+class AprilTagDetection;
+
+/**
+ * Estimates a single camera pose from all of the tags visible in an image.
+ *
+ * The corners of every detected tag with a known field pose are combined into
+ * one perspective-n-point problem, which is initialized from the best
+ * single-tag homography and refined with Levenberg-Marquardt to minimize the
+ * reprojection error over all corners. Using several tags at once is both
+ * more accurate than per-tag estimation and removes the planar pose ambiguity
+ * of a single tag.
+ *
+ * Tag poses use the WPILib field convention (X axis pointing out of the tag
+ * face, Z axis up), e.g. as returned by wpi::fields::Field::GetTags(). The
+ * returned camera pose uses the WPILib robot convention (X forward, Y left, Z
+ * up).
+ *
+ * Estimation does not allocate once the internal buffers have grown to the
+ * number of visible tags. This class is not thread safe.
+ */
+class WPILIB_DLLEXPORT AprilTagMultiTagPoseEstimator {
+ public:
+  /** Result of a multi-tag pose estimate. */
+  struct Result {
+    /** Pose of the camera in the field. */
+    wpi::math::Pose3d cameraPose;
+
+    /** Root mean square reprojection error over all corners, in pixels. */
+    double error = 0;
+
+    /** Number of tags used for the estimate. */
+    int numTags = 0;
+  };
+
+  /**
+   * Creates estimator.
+   *
+   * @param config Camera intrinsics and tag size
+   */
+  explicit AprilTagMultiTagPoseEstimator(
+      const AprilTagPoseEstimator::Config& config)
+      : m_config{config} {}
+
+  /**
+   * Sets camera intrinsics and tag size.
+   *
+   * @param config Configuration
+   */
+  void SetConfig(const AprilTagPoseEstimator::Config& config);
+
+  /**
+   * Gets camera intrinsics and tag size.
+   *
+   * @return Configuration
+   */
+  const AprilTagPoseEstimator::Config& GetConfig() const { return m_config; }
+
+  /**
+   * Sets the maximum number of Levenberg-Marquardt iterations. Defaults to 20.
+   *
+   * @param iterations maximum number of iterations
+   */
+  void SetMaxIterations(int iterations) { m_maxIterations = iterations; }
+
+  /**
+   * Gets the maximum number of Levenberg-Marquardt iterations.
+   *
+   * @return maximum number of iterations
+   */
+  int GetMaxIterations() const { return m_maxIterations; }
+
+  /**
+   * Adds the field pose of a tag. Replaces the pose if the tag was already
+   * added.
+   *
+   * @param id Tag ID
+   * @param pose Pose of the tag in the field
+   */
+  void AddTagPose(int id, const wpi::math::Pose3d& pose);
+
+  /**
+   * Removes all tag poses.
+   */
+  void ClearTagPoses() { m_tags.clear(); }
+
+  /**
+   * Estimates the camera pose from a set of detections. Detections of tags
+   * without a known pose are ignored.
+   *
+   * @param detections Tag detections
+   * @return Camera pose estimate, or empty if no known tags were detected
+   */
+  std::optional<Result> Estimate(
+      std::span<const AprilTagDetection* const> detections);
+
+  /**
+   * Estimates the camera pose from a set of tag corners. Tags without a known
+   * pose are ignored.
+   *
+   * @param ids Tag IDs
+   * @param corners Corner points of each tag (X and Y for each corner in the
+   *                same order as AprilTagDetection::GetCorners())
+   * @return Camera pose estimate, or empty if no known tags were given
+   */
+  std::optional<Result> Estimate(
+      std::span<const int> ids, std::span<const std::array<double, 8>> corners);
+
+ private:
+  struct Tag {
+    int id;
+    // field from apriltag tag frame (X right, Y down, Z into the tag)
+    Eigen::Matrix3d rotation;
+    Eigen::Vector3d translation;
+    std::array<Eigen::Vector3d, 4> corners;
+  };
+
+  struct Observation {
+    const Tag* tag;
+    std::array<Eigen::Vector2d, 4> pixels;
+  };
+
+  const Tag* FindTag(int id) const;
+  void UpdateTagCorners(Tag& tag) const;
+  std::optional<Result> Solve();
+
+  AprilTagPoseEstimator::Config m_config;
+  int m_maxIterations = 20;
+  // sorted by id
+  std::vector<Tag> m_tags;
+  // scratch buffer reused across calls
+  std::vector<Observation> m_observations;
+};
+
+}  // namespace wpi::apriltag
@@ -0,0 +1,69 @@
+/* Copyright (c) FIRST and other WPILib contributors.
+Open Source Software; you can modify and/or share it under the terms of
+the WPILib BSD license file in the root directory of this project.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Row kernels for the hot pixel loops of quad detection (decimation and the
+// tile-based adaptive threshold). Every kernel has a scalar implementation
+// plus SSE2/AVX2 (x86) or NEON (ARM) versions selected at runtime. All
+// implementations produce bit-identical output.
+
+typedef enum {
+    IMAGE_U8_SIMD_SCALAR = 0,
+    IMAGE_U8_SIMD_SSE2 = 1,
+    IMAGE_U8_SIMD_AVX2 = 2,
+    IMAGE_U8_SIMD_NEON = 3,
+} image_u8_simd_level_t;
+
+// Tile size (in pixels, both directions) used by the threshold kernels.
+#define IMAGE_U8_SIMD_TILESZ 4
+
+// Returns nonzero if the running CPU supports the given level.
+int image_u8_simd_level_supported(image_u8_simd_level_t level);
+
+// Returns the fastest level supported by the running CPU.
+image_u8_simd_level_t image_u8_simd_best_level(void);
+
+// Returns the level currently used by the kernels below.
+image_u8_simd_level_t image_u8_simd_get_level(void);
+
+// Selects the level used by the kernels below. Intended for testing and
+// benchmarking; not safe to call while detection is running. Returns 0 (and
+// leaves the level unchanged) if the level is not supported.
+int image_u8_simd_set_level(image_u8_simd_level_t level);
+
+// Computes the max and min of each 4x4 tile in one row of tiles. src points at
+// the first pixel of the tile row; tw tiles are written to tile_max/tile_min.
+void image_u8_tile_minmax(const uint8_t *src, int stride, int tw,
+                          uint8_t *tile_max, uint8_t *tile_min);
+
+// Applies a 3x3 max (to im_max) and min (to im_min) filter to row ty of a
+// tw x th grid of tile statistics, writing tw values to out_max/out_min.
+// Neighbors outside the grid are ignored.
+void image_u8_tile_blur(const uint8_t *im_max, const uint8_t *im_min,
+                        int tw, int th, int ty,
+                        uint8_t *out_max, uint8_t *out_min);
+
+// Thresholds one row of 4x4 tiles. Pixels brighter than the tile midpoint
+// become 255 and the rest 0; tiles whose max - min is below
+// min_white_black_diff are filled with 127. src and dst share the stride.
+void image_u8_tile_threshold(const uint8_t *src, uint8_t *dst, int stride,
+                             const uint8_t *tile_max, const uint8_t *tile_min,
+                             int tw, int min_white_black_diff);
+
+// Writes every factor'th pixel of a source row of the given width to dst
+// (1 + (width - 1) / factor pixels).
+void image_u8_decimate_row(const uint8_t *src, int width, int factor,
+                           uint8_t *dst);
+
+#ifdef __cplusplus
+}
+#endif
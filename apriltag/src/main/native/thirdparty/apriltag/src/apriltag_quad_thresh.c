@@ -37,6 +37,7 @@ either expressed or implied, of the Regents of The University of Michigan.
 
 #include "apriltag.h"
 #include "common/image_u8x3.h"
+#include "common/image_u8_simd.h"
 #include "common/zarray.h"
 #include "common/unionfind.h"
 #include "common/timeprofile.h"
@@ -1092,24 +1093,8 @@ void do_minmax_task(void *p)
     int tw = task->im->width / tilesz;
     image_u8_t *im = task->im;
 
-    for (int tx = 0; tx < tw; tx++) {
-        uint8_t max = 0, min = 255;
-
-        for (int dy = 0; dy < tilesz; dy++) {
-
-            for (int dx = 0; dx < tilesz; dx++) {
-
-                uint8_t v = im->buf[(ty*tilesz+dy)*s + tx*tilesz + dx];
-                if (v < min)
-                    min = v;
-                if (v > max)
-                    max = v;
-            }
-        }
-
-        task->im_max[ty*tw+tx] = max;
-        task->im_min[ty*tw+tx] = min;
-    }
+    image_u8_tile_minmax(&im->buf[ty*tilesz*s], s, tw,
+                         &task->im_max[ty*tw], &task->im_min[ty*tw]);
 }
 
 void do_blur_task(void *p)
@@ -1119,31 +1104,9 @@ void do_blur_task(void *p)
     int ty = task->ty;
     int tw = task->im->width / tilesz;
     int th = task->im->height / tilesz;
-    uint8_t *im_max = task->im_max;
-    uint8_t *im_min = task->im_min;
-
-    for (int tx = 0; tx < tw; tx++) {
-        uint8_t max = 0, min = 255;
-
-        for (int dy = -1; dy <= 1; dy++) {
-            if (ty+dy < 0 || ty+dy >= th)
-                continue;
-            for (int dx = -1; dx <= 1; dx++) {
-                if (tx+dx < 0 || tx+dx >= tw)
-                    continue;
 
-                uint8_t m = im_max[(ty+dy)*tw+tx+dx];
-                if (m > max)
-                    max = m;
-                m = im_min[(ty+dy)*tw+tx+dx];
-                if (m < min)
-                    min = m;
-            }
-        }
-
-        task->im_max_tmp[ty*tw + tx] = max;
-        task->im_min_tmp[ty*tw + tx] = min;
-    }
+    image_u8_tile_blur(task->im_max, task->im_min, tw, th, ty,
+                       &task->im_max_tmp[ty*tw], &task->im_min_tmp[ty*tw]);
 }
 
 void do_threshold_task(void *p)
@@ -1153,50 +1116,13 @@ void do_threshold_task(void *p)
     int ty = task->ty;
     int tw = task->im->width / tilesz;
     int s = task->im->stride;
-    uint8_t *im_max = task->im_max;
-    uint8_t *im_min = task->im_min;
     image_u8_t *im = task->im;
     image_u8_t *threshim = task->threshim;
-    int min_white_black_diff = task->td->qtp.min_white_black_diff;
 
-    for (int tx = 0; tx < tw; tx++) {
-        int min = im_min[ty*tw + tx];
-        int max = im_max[ty*tw + tx];
-
-        // low contrast region? (no edges)
-        if (max - min < min_white_black_diff) {
-            for (int dy = 0; dy < tilesz; dy++) {
-                int y = ty*tilesz + dy;
-
-                for (int dx = 0; dx < tilesz; dx++) {
-                    int x = tx*tilesz + dx;
-
-                    threshim->buf[y*s+x] = 127;
-                }
-            }
-            continue;
-        }
-
-        // otherwise, actually threshold this tile.
-
-        // argument for biasing towards dark; specular highlights
-        // can be substantially brighter than white tag parts
-        uint8_t thresh = min + (max - min) / 2;
-
-        for (int dy = 0; dy < tilesz; dy++) {
-            int y = ty*tilesz + dy;
-
-            for (int dx = 0; dx < tilesz; dx++) {
-                int x = tx*tilesz + dx;
-
-                uint8_t v = im->buf[y*s+x];
-                if (v > thresh)
-                    threshim->buf[y*s+x] = 255;
-                else
-                    threshim->buf[y*s+x] = 0;
-            }
-        }
-    }
+    // threshim shares the stride of im; see threshold()
+    image_u8_tile_threshold(&im->buf[ty*tilesz*s], &threshim->buf[ty*tilesz*s], s,
+                            &task->im_max[ty*tw], &task->im_min[ty*tw], tw,
+                            task->td->qtp.min_white_black_diff);
 }
  
 image_u8_t *threshold(apriltag_detector_t *td, image_u8_t *im)
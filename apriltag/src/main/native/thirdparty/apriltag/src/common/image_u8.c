@@ -32,6 +32,7 @@ either expressed or implied, of the Regents of The University of Michigan.
 #include <math.h>
 
 #include "common/image_u8.h"
+#include "common/image_u8_simd.h"
 #include "common/pnm.h"
 #include "common/math_util.h"
 
@@ -493,11 +494,8 @@ image_u8_t *image_u8_decimate(image_u8_t *im, float ffactor)
     image_u8_t *decim = image_u8_create(swidth, sheight);
     int sy = 0;
     for (int y = 0; y < height; y += factor) {
-        int sx = 0;
-        for (int x = 0; x < width; x += factor) {
-            decim->buf[sy*decim->stride + sx] = im->buf[y*im->stride + x];
-            sx++;
-        }
+        image_u8_decimate_row(&im->buf[y*im->stride], width, factor,
+                              &decim->buf[sy*decim->stride]);
         sy++;
     }
     return decim;
@@ -0,0 +1,791 @@
+/* Copyright (c) FIRST and other WPILib contributors.
+Open Source Software; you can modify and/or share it under the terms of
+the WPILib BSD license file in the root directory of this project.
+*/
+
+#include <string.h>
+
+#include "common/image_u8_simd.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMAGE_U8_SIMD_X86 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define IMAGE_U8_SIMD_TARGET_AVX2
+#else
+#define IMAGE_U8_SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define IMAGE_U8_SIMD_ARM 1
+#include <arm_neon.h>
+#endif
+
+#define TILESZ IMAGE_U8_SIMD_TILESZ
+
+struct image_u8_simd_kernels
+{
+    void (*tile_minmax)(const uint8_t *src, int stride, int tw,
+                        uint8_t *tile_max, uint8_t *tile_min);
+    void (*tile_blur)(const uint8_t *im_max, const uint8_t *im_min,
+                      int tw, int th, int ty,
+                      uint8_t *out_max, uint8_t *out_min);
+    void (*tile_threshold)(const uint8_t *src, uint8_t *dst, int stride,
+                           const uint8_t *tile_max, const uint8_t *tile_min,
+                           int tw, int min_white_black_diff);
+    int (*decimate_row)(const uint8_t *src, int width, int factor,
+                        uint8_t *dst);
+};
+
+/////////////////////////////////////////////////////////////////////
+// Scalar reference implementations. The vector versions below process
+// as much of a row as they can and then fall through to these for the
+// remainder, so every level shares the edge handling.
+
+static void tile_minmax_scalar_range(const uint8_t *src, int stride, int tx0, int tw,
+                                     uint8_t *tile_max, uint8_t *tile_min)
+{
+    for (int tx = tx0; tx < tw; tx++) {
+        uint8_t max = 0, min = 255;
+
+        for (int dy = 0; dy < TILESZ; dy++) {
+            for (int dx = 0; dx < TILESZ; dx++) {
+                uint8_t v = src[dy*stride + tx*TILESZ + dx];
+                if (v < min)
+                    min = v;
+                if (v > max)
+                    max = v;
+            }
+        }
+
+        tile_max[tx] = max;
+        tile_min[tx] = min;
+    }
+}
+
+static void tile_minmax_scalar(const uint8_t *src, int stride, int tw,
+                               uint8_t *tile_max, uint8_t *tile_min)
+{
+    tile_minmax_scalar_range(src, stride, 0, tw, tile_max, tile_min);
+}
+
+static inline void tile_blur_scalar_one(const uint8_t *im_max, const uint8_t *im_min,
+                                        int tw, int th, int ty, int tx,
+                                        uint8_t *out_max, uint8_t *out_min)
+{
+    uint8_t max = 0, min = 255;
+
+    for (int dy = -1; dy <= 1; dy++) {
+        if (ty+dy < 0 || ty+dy >= th)
+            continue;
+        for (int dx = -1; dx <= 1; dx++) {
+            if (tx+dx < 0 || tx+dx >= tw)
+                continue;
+
+            uint8_t m = im_max[(ty+dy)*tw+tx+dx];
+            if (m > max)
+                max = m;
+            m = im_min[(ty+dy)*tw+tx+dx];
+            if (m < min)
+                min = m;
+        }
+    }
+
+    out_max[tx] = max;
+    out_min[tx] = min;
+}
+
+static void tile_blur_scalar(const uint8_t *im_max, const uint8_t *im_min,
+                             int tw, int th, int ty,
+                             uint8_t *out_max, uint8_t *out_min)
+{
+    for (int tx = 0; tx < tw; tx++)
+        tile_blur_scalar_one(im_max, im_min, tw, th, ty, tx, out_max, out_min);
+}
+
+static void tile_threshold_scalar_range(const uint8_t *src, uint8_t *dst, int stride,
+                                        const uint8_t *tile_max, const uint8_t *tile_min,
+                                        int tx0, int tw, int min_white_black_diff)
+{
+    for (int tx = tx0; tx < tw; tx++) {
+        int min = tile_min[tx];
+        int max = tile_max[tx];
+
+        // low contrast region? (no edges)
+        if (max - min < min_white_black_diff) {
+            for (int dy = 0; dy < TILESZ; dy++)
+                memset(&dst[dy*stride + tx*TILESZ], 127, TILESZ);
+            continue;
+        }
+
+        uint8_t thresh = min + (max - min) / 2;
+
+        for (int dy = 0; dy < TILESZ; dy++) {
+            for (int dx = 0; dx < TILESZ; dx++) {
+                int idx = dy*stride + tx*TILESZ + dx;
+                dst[idx] = src[idx] > thresh ? 255 : 0;
+            }
+        }
+    }
+}
+
+static void tile_threshold_scalar(const uint8_t *src, uint8_t *dst, int stride,
+                                  const uint8_t *tile_max, const uint8_t *tile_min,
+                                  int tw, int min_white_black_diff)
+{
+    tile_threshold_scalar_range(src, dst, stride, tile_max, tile_min, 0, tw,
+                                min_white_black_diff);
+}
+
+// Returns the number of destination pixels written (always all of them).
+static int decimate_row_scalar_range(const uint8_t *src, int width, int factor,
+                                     int sx0, uint8_t *dst)
+{
+    int sx = sx0;
+    for (int x = sx0 * factor; x < width; x += factor)
+        dst[sx++] = src[x];
+    return sx;
+}
+
+static int decimate_row_scalar(const uint8_t *src, int width, int factor, uint8_t *dst)
+{
+    return decimate_row_scalar_range(src, width, factor, 0, dst);
+}
+
+static const struct image_u8_simd_kernels kernels_scalar = {
+    tile_minmax_scalar,
+    tile_blur_scalar,
+    tile_threshold_scalar,
+    decimate_row_scalar,
+};
+
+// Rewrites the low contrast test max - min < min_white_black_diff as the
+// unsigned byte comparison diff <= limit. Returns -1 if no tile can be low
+// contrast.
+static inline int lowc_limit(int min_white_black_diff)
+{
+    if (min_white_black_diff <= 0)
+        return -1;
+    if (min_white_black_diff > 256)
+        return 255;
+    return min_white_black_diff - 1;
+}
+
+#ifdef IMAGE_U8_SIMD_X86
+
+/////////////////////////////////////////////////////////////////////
+// SSE2 (baseline on x86-64)
+
+// Reduces each 32-bit lane to the max/min of its four bytes, leaving the
+// result in the low byte and zeroing the rest.
+static inline __m128i sse2_hmax4(__m128i v)
+{
+    v = _mm_max_epu8(v, _mm_srli_epi32(v, 8));
+    v = _mm_max_epu8(v, _mm_srli_epi32(v, 16));
+    return _mm_and_si128(v, _mm_set1_epi32(0xff));
+}
+
+static inline __m128i sse2_hmin4(__m128i v)
+{
+    // the zeros shifted into the upper bytes never reach byte 0
+    v = _mm_min_epu8(v, _mm_srli_epi32(v, 8));
+    v = _mm_min_epu8(v, _mm_srli_epi32(v, 16));
+    return _mm_and_si128(v, _mm_set1_epi32(0xff));
+}
+
+static void tile_minmax_sse2(const uint8_t *src, int stride, int tw,
+                             uint8_t *tile_max, uint8_t *tile_min)
+{
+    int tx = 0;
+    for (; tx + 8 <= tw; tx += 8) {
+        const uint8_t *p = src + tx*TILESZ;
+        __m128i a0 = _mm_loadu_si128((const __m128i *) p);
+        __m128i b0 = _mm_loadu_si128((const __m128i *) (p + 16));
+        __m128i amax = a0, amin = a0, bmax = b0, bmin = b0;
+        for (int dy = 1; dy < TILESZ; dy++) {
+            __m128i a = _mm_loadu_si128((const __m128i *) (p + dy*stride));
+            __m128i b = _mm_loadu_si128((const __m128i *) (p + dy*stride + 16));
+            amax = _mm_max_epu8(amax, a);
+            amin = _mm_min_epu8(amin, a);
+            bmax = _mm_max_epu8(bmax, b);
+            bmin = _mm_min_epu8(bmin, b);
+        }
+
+        __m128i max = _mm_packs_epi32(sse2_hmax4(amax), sse2_hmax4(bmax));
+        __m128i min = _mm_packs_epi32(sse2_hmin4(amin), sse2_hmin4(bmin));
+        _mm_storel_epi64((__m128i *) (tile_max + tx), _mm_packus_epi16(max, max));
+        _mm_storel_epi64((__m128i *) (tile_min + tx), _mm_packus_epi16(min, min));
+    }
+
+    tile_minmax_scalar_range(src, stride, tx, tw, tile_max, tile_min);
+}
+
+static void tile_blur_sse2(const uint8_t *im_max, const uint8_t *im_min,
+                           int tw, int th, int ty,
+                           uint8_t *out_max, uint8_t *out_min)
+{
+    if (tw < 1)
+        return;
+
+    // Clamping the neighbor rows is equivalent to skipping them, since
+    // max and min are idempotent.
+    const uint8_t *maxr[3], *minr[3];
+    for (int i = 0; i < 3; i++) {
+        int y = ty - 1 + i;
+        if (y < 0)
+            y = 0;
+        if (y >= th)
+            y = th - 1;
+        maxr[i] = im_max + y*tw;
+        minr[i] = im_min + y*tw;
+    }
+
+    tile_blur_scalar_one(im_max, im_min, tw, th, ty, 0, out_max, out_min);
+
+    int tx = 1;
+    for (; tx + 16 + 1 <= tw; tx += 16) {
+        __m128i max = _mm_setzero_si128();
+        __m128i min = _mm_set1_epi8((char) 0xff);
+        for (int i = 0; i < 3; i++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                max = _mm_max_epu8(max, _mm_loadu_si128((const __m128i *) (maxr[i] + tx + dx)));
+                min = _mm_min_epu8(min, _mm_loadu_si128((const __m128i *) (minr[i] + tx + dx)));
+            }
+        }
+        _mm_storeu_si128((__m128i *) (out_max + tx), max);
+        _mm_storeu_si128((__m128i *) (out_min + tx), min);
+    }
+
+    for (; tx < tw; tx++)
+        tile_blur_scalar_one(im_max, im_min, tw, th, ty, tx, out_max, out_min);
+}
+
+// Replicates each of the low four bytes of v four times.
+static inline __m128i sse2_expand4(__m128i v)
+{
+    v = _mm_unpacklo_epi8(v, v);
+    return _mm_unpacklo_epi16(v, v);
+}
+
+static inline int32_t load_u32(const uint8_t *p)
+{
+    int32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static void tile_threshold_sse2(const uint8_t *src, uint8_t *dst, int stride,
+                                const uint8_t *tile_max, const uint8_t *tile_min,
+                                int tw, int min_white_black_diff)
+{
+    int lim = lowc_limit(min_white_black_diff);
+    const __m128i lowc_max = _mm_set1_epi8((char) (lim < 0 ? 0 : lim));
+    const __m128i lowc_en = _mm_set1_epi8(lim < 0 ? 0 : (char) 0xff);
+    const __m128i c127 = _mm_set1_epi8(127);
+    const __m128i c7f = _mm_set1_epi8(0x7f);
+    const __m128i ones = _mm_set1_epi8((char) 0xff);
+
+    int tx = 0;
+    for (; tx + 4 <= tw; tx += 4) {
+        __m128i max = sse2_expand4(_mm_cvtsi32_si128(load_u32(tile_max + tx)));
+        __m128i min = sse2_expand4(_mm_cvtsi32_si128(load_u32(tile_min + tx)));
+
+        __m128i diff = _mm_subs_epu8(max, min);
+        __m128i lowc = _mm_and_si128(
+            _mm_cmpeq_epi8(_mm_min_epu8(diff, lowc_max), diff), lowc_en);
+        // there is no 8-bit shift; mask off the bits shifted in from the
+        // neighboring byte
+        __m128i thresh = _mm_add_epi8(
+            min, _mm_and_si128(_mm_srli_epi16(diff, 1), c7f));
+        __m128i fill = _mm_and_si128(lowc, c127);
+
+        for (int dy = 0; dy < TILESZ; dy++) {
+            int idx = dy*stride + tx*TILESZ;
+            __m128i v = _mm_loadu_si128((const __m128i *) (src + idx));
+            // v > thresh <=> min(v, thresh) != v
+            __m128i le = _mm_cmpeq_epi8(_mm_min_epu8(v, thresh), v);
+            __m128i out = _mm_or_si128(_mm_andnot_si128(_mm_or_si128(le, lowc), ones), fill);
+            _mm_storeu_si128((__m128i *) (dst + idx), out);
+        }
+    }
+
+    tile_threshold_scalar_range(src, dst, stride, tile_max, tile_min, tx, tw,
+                                min_white_black_diff);
+}
+
+static int decimate_row_sse2(const uint8_t *src, int width, int factor, uint8_t *dst)
+{
+    int sx = 0;
+    if (factor == 2) {
+        const __m128i mask = _mm_set1_epi16(0xff);
+        for (; 2*sx + 32 <= width; sx += 16) {
+            __m128i a = _mm_loadu_si128((const __m128i *) (src + 2*sx));
+            __m128i b = _mm_loadu_si128((const __m128i *) (src + 2*sx + 16));
+            __m128i r = _mm_packus_epi16(_mm_and_si128(a, mask), _mm_and_si128(b, mask));
+            _mm_storeu_si128((__m128i *) (dst + sx), r);
+        }
+    } else if (factor == 4) {
+        const __m128i mask = _mm_set1_epi32(0xff);
+        for (; 4*sx + 64 <= width; sx += 16) {
+            const uint8_t *p = src + 4*sx;
+            __m128i a = _mm_and_si128(_mm_loadu_si128((const __m128i *) p), mask);
+            __m128i b = _mm_and_si128(_mm_loadu_si128((const __m128i *) (p + 16)), mask);
+            __m128i c = _mm_and_si128(_mm_loadu_si128((const __m128i *) (p + 32)), mask);
+            __m128i d = _mm_and_si128(_mm_loadu_si128((const __m128i *) (p + 48)), mask);
+            __m128i r = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+            _mm_storeu_si128((__m128i *) (dst + sx), r);
+        }
+    }
+    return decimate_row_scalar_range(src, width, factor, sx, dst);
+}
+
+static const struct image_u8_simd_kernels kernels_sse2 = {
+    tile_minmax_sse2,
+    tile_blur_sse2,
+    tile_threshold_sse2,
+    decimate_row_sse2,
+};
+
+/////////////////////////////////////////////////////////////////////
+// AVX2
+
+IMAGE_U8_SIMD_TARGET_AVX2
+static inline __m256i avx2_hmax4(__m256i v)
+{
+    v = _mm256_max_epu8(v, _mm256_srli_epi32(v, 8));
+    v = _mm256_max_epu8(v, _mm256_srli_epi32(v, 16));
+    return _mm256_and_si256(v, _mm256_set1_epi32(0xff));
+}
+
+IMAGE_U8_SIMD_TARGET_AVX2
+static inline __m256i avx2_hmin4(__m256i v)
+{
+    v = _mm256_min_epu8(v, _mm256_srli_epi32(v, 8));
+    v = _mm256_min_epu8(v, _mm256_srli_epi32(v, 16));
+    return _mm256_and_si256(v, _mm256_set1_epi32(0xff));
+}
+
+// Packs the low bytes of the 32-bit lanes of a and b (in that order) into
+// 16 bytes.
+IMAGE_U8_SIMD_TARGET_AVX2
+static inline __m128i avx2_pack_lanes(__m256i a, __m256i b)
+{
+    // the packs work within 128-bit halves, leaving 32-bit groups of
+    // a0-3 b0-3 a0-3 b0-3 | a4-7 b4-7 a4-7 b4-7
+    __m256i p = _mm256_packs_epi32(a, b);
+    p = _mm256_packus_epi16(p, p);
+    p = _mm256_permutevar8x32_epi32(p, _mm256_setr_epi32(0, 4, 1, 5, 0, 4, 1, 5));
+    return _mm256_castsi256_si128(p);
+}
+
+IMAGE_U8_SIMD_TARGET_AVX2
+static void tile_minmax_avx2(const uint8_t *src, int stride, int tw,
+                             uint8_t *tile_max, uint8_t *tile_min)
+{
+    int tx = 0;
+    for (; tx + 16 <= tw; tx += 16) {
+        const uint8_t *p = src + tx*TILESZ;
+        __m256i a0 = _mm256_loadu_si256((const __m256i *) p);
+        __m256i b0 = _mm256_loadu_si256((const __m256i *) (p + 32));
+        __m256i amax = a0, amin = a0, bmax = b0, bmin = b0;
+        for (int dy = 1; dy < TILESZ; dy++) {
+            __m256i a = _mm256_loadu_si256((const __m256i *) (p + dy*stride));
+            __m256i b = _mm256_loadu_si256((const __m256i *) (p + dy*stride + 32));
+            amax = _mm256_max_epu8(amax, a);
+            amin = _mm256_min_epu8(amin, a);
+            bmax = _mm256_max_epu8(bmax, b);
+            bmin = _mm256_min_epu8(bmin, b);
+        }
+
+        _mm_storeu_si128((__m128i *) (tile_max + tx),
+                         avx2_pack_lanes(avx2_hmax4(amax), avx2_hmax4(bmax)));
+        _mm_storeu_si128((__m128i *) (tile_min + tx),
+                         avx2_pack_lanes(avx2_hmin4(amin), avx2_hmin4(bmin)));
+    }
+
+    tile_minmax_sse2(src + tx*TILESZ, stride, tw - tx, tile_max + tx, tile_min + tx);
+}
+
+IMAGE_U8_SIMD_TARGET_AVX2
+static void tile_blur_avx2(const uint8_t *im_max, const uint8_t *im_min,
+                           int tw, int th, int ty,
+                           uint8_t *out_max, uint8_t *out_min)
+{
+    if (tw < 1)
+        return;
+
+    const uint8_t *maxr[3], *minr[3];
+    for (int i = 0; i < 3; i++) {
+        int y = ty - 1 + i;
+        if (y < 0)
+            y = 0;
+        if (y >= th)
+            y = th - 1;
+        maxr[i] = im_max + y*tw;
+        minr[i] = im_min + y*tw;
+    }
+
+    tile_blur_scalar_one(im_max, im_min, tw, th, ty, 0, out_max, out_min);
+
+    int tx = 1;
+    for (; tx + 32 + 1 <= tw; tx += 32) {
+        __m256i max = _mm256_setzero_si256();
+        __m256i min = _mm256_set1_epi8((char) 0xff);
+        for (int i = 0; i < 3; i++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                max = _mm256_max_epu8(max, _mm256_loadu_si256((const __m256i *) (maxr[i] + tx + dx)));
+                min = _mm256_min_epu8(min, _mm256_loadu_si256((const __m256i *) (minr[i] + tx + dx)));
+            }
+        }
+        _mm256_storeu_si256((__m256i *) (out_max + tx), max);
+        _mm256_storeu_si256((__m256i *) (out_min + tx), min);
+    }
+
+    for (; tx < tw; tx++)
+        tile_blur_scalar_one(im_max, im_min, tw, th, ty, tx, out_max, out_min);
+}
+
+IMAGE_U8_SIMD_TARGET_AVX2
+static inline __m256i avx2_expand4(const uint8_t *p)
+{
+    int64_t v;
+    memcpy(&v, p, sizeof(v));
+    const __m256i idx = _mm256_setr_epi8(
+        0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+        4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7);
+    return _mm256_shuffle_epi8(_mm256_set1_epi64x(v), idx);
+}
+
+IMAGE_U8_SIMD_TARGET_AVX2
+static void tile_threshold_avx2(const uint8_t *src, uint8_t *dst, int stride,
+                                const uint8_t *tile_max, const uint8_t *tile_min,
+                                int tw, int min_white_black_diff)
+{
+    int lim = lowc_limit(min_white_black_diff);
+    const __m256i lowc_max = _mm256_set1_epi8((char) (lim < 0 ? 0 : lim));
+    const __m256i lowc_en = _mm256_set1_epi8(lim < 0 ? 0 : (char) 0xff);
+    const __m256i c127 = _mm256_set1_epi8(127);
+    const __m256i c7f = _mm256_set1_epi8(0x7f);
+    const __m256i ones = _mm256_set1_epi8((char) 0xff);
+
+    int tx = 0;
+    for (; tx + 8 <= tw; tx += 8) {
+        __m256i max = avx2_expand4(tile_max + tx);
+        __m256i min = avx2_expand4(tile_min + tx);
+
+        __m256i diff = _mm256_subs_epu8(max, min);
+        __m256i lowc = _mm256_and_si256(
+            _mm256_cmpeq_epi8(_mm256_min_epu8(diff, lowc_max), diff), lowc_en);
+        __m256i thresh = _mm256_add_epi8(
+            min, _mm256_and_si256(_mm256_srli_epi16(diff, 1), c7f));
+        __m256i fill = _mm256_and_si256(lowc, c127);
+
+        for (int dy = 0; dy < TILESZ; dy++) {
+            int idx = dy*stride + tx*TILESZ;
+            __m256i v = _mm256_loadu_si256((const __m256i *) (src + idx));
+            __m256i le = _mm256_cmpeq_epi8(_mm256_min_epu8(v, thresh), v);
+            __m256i out = _mm256_or_si256(_mm256_andnot_si256(_mm256_or_si256(le, lowc), ones), fill);
+            _mm256_storeu_si256((__m256i *) (dst + idx), out);
+        }
+    }
+
+    tile_threshold_sse2(src + tx*TILESZ, dst + tx*TILESZ, stride,
+                        tile_max + tx, tile_min + tx, tw - tx, min_white_black_diff);
+}
+
+IMAGE_U8_SIMD_TARGET_AVX2
+static int decimate_row_avx2(const uint8_t *src, int width, int factor, uint8_t *dst)
+{
+    int sx = 0;
+    if (factor == 2) {
+        const __m256i mask = _mm256_set1_epi16(0xff);
+        for (; 2*sx + 64 <= width; sx += 32) {
+            __m256i a = _mm256_loadu_si256((const __m256i *) (src + 2*sx));
+            __m256i b = _mm256_loadu_si256((const __m256i *) (src + 2*sx + 32));
+            __m256i r = _mm256_packus_epi16(_mm256_and_si256(a, mask), _mm256_and_si256(b, mask));
+            // packus works within 128-bit halves: a0-7 b0-7 | a8-15 b8-15
+            r = _mm256_permute4x64_epi64(r, 0xd8);
+            _mm256_storeu_si256((__m256i *) (dst + sx), r);
+        }
+        int n = decimate_row_sse2(src + 2*sx, width - 2*sx, factor, dst + sx);
+        return sx + n;
+    }
+    return decimate_row_sse2(src, width, factor, dst);
+}
+
+static const struct image_u8_simd_kernels kernels_avx2 = {
+    tile_minmax_avx2,
+    tile_blur_avx2,
+    tile_threshold_avx2,
+    decimate_row_avx2,
+};
+
+static int cpu_has_avx2(void)
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return 0;
+    __cpuid(info, 1);
+    // OSXSAVE and AVX, then check the OS saves the YMM registers
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+        return 0;
+    if ((_xgetbv(0) & 0x6) != 0x6)
+        return 0;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // IMAGE_U8_SIMD_X86
+
+#ifdef IMAGE_U8_SIMD_ARM
+
+/////////////////////////////////////////////////////////////////////
+// NEON (baseline on AArch64)
+
+static void tile_minmax_neon(const uint8_t *src, int stride, int tw,
+                             uint8_t *tile_max, uint8_t *tile_min)
+{
+    int tx = 0;
+    for (; tx + 8 <= tw; tx += 8) {
+        const uint8_t *p = src + tx*TILESZ;
+        uint8x16_t amax = vld1q_u8(p), bmax = vld1q_u8(p + 16);
+        uint8x16_t amin = amax, bmin = bmax;
+        for (int dy = 1; dy < TILESZ; dy++) {
+            uint8x16_t a = vld1q_u8(p + dy*stride);
+            uint8x16_t b = vld1q_u8(p + dy*stride + 16);
+            amax = vmaxq_u8(amax, a);
+            amin = vminq_u8(amin, a);
+            bmax = vmaxq_u8(bmax, b);
+            bmin = vminq_u8(bmin, b);
+        }
+
+        // two rounds of pairwise reduction take groups of 4 bytes to 1
+        uint8x8_t max = vpmax_u8(vpmax_u8(vget_low_u8(amax), vget_high_u8(amax)),
+                                 vpmax_u8(vget_low_u8(bmax), vget_high_u8(bmax)));
+        uint8x8_t min = vpmin_u8(vpmin_u8(vget_low_u8(amin), vget_high_u8(amin)),
+                                 vpmin_u8(vget_low_u8(bmin), vget_high_u8(bmin)));
+        vst1_u8(tile_max + tx, max);
+        vst1_u8(tile_min + tx, min);
+    }
+
+    tile_minmax_scalar_range(src, stride, tx, tw, tile_max, tile_min);
+}
+
+static void tile_blur_neon(const uint8_t *im_max, const uint8_t *im_min,
+                           int tw, int th, int ty,
+                           uint8_t *out_max, uint8_t *out_min)
+{
+    if (tw < 1)
+        return;
+
+    const uint8_t *maxr[3], *minr[3];
+    for (int i = 0; i < 3; i++) {
+        int y = ty - 1 + i;
+        if (y < 0)
+            y = 0;
+        if (y >= th)
+            y = th - 1;
+        maxr[i] = im_max + y*tw;
+        minr[i] = im_min + y*tw;
+    }
+
+    tile_blur_scalar_one(im_max, im_min, tw, th, ty, 0, out_max, out_min);
+
+    int tx = 1;
+    for (; tx + 16 + 1 <= tw; tx += 16) {
+        uint8x16_t max = vdupq_n_u8(0);
+        uint8x16_t min = vdupq_n_u8(255);
+        for (int i = 0; i < 3; i++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                max = vmaxq_u8(max, vld1q_u8(maxr[i] + tx + dx));
+                min = vminq_u8(min, vld1q_u8(minr[i] + tx + dx));
+            }
+        }
+        vst1q_u8(out_max + tx, max);
+        vst1q_u8(out_min + tx, min);
+    }
+
+    for (; tx < tw; tx++)
+        tile_blur_scalar_one(im_max, im_min, tw, th, ty, tx, out_max, out_min);
+}
+
+static void tile_threshold_neon(const uint8_t *src, uint8_t *dst, int stride,
+                                const uint8_t *tile_max, const uint8_t *tile_min,
+                                int tw, int min_white_black_diff)
+{
+    int lim = lowc_limit(min_white_black_diff);
+    const uint8x16_t lowc_max = vdupq_n_u8(lim < 0 ? 0 : lim);
+    const uint8x16_t lowc_en = vdupq_n_u8(lim < 0 ? 0 : 0xff);
+    const uint8x16_t c127 = vdupq_n_u8(127);
+
+    int tx = 0;
+    for (; tx + 8 <= tw; tx += 8) {
+        // replicate each tile value 4 times: 8 tiles -> 2 x 16 pixels
+        uint8x8x2_t max2 = vzip_u8(vld1_u8(tile_max + tx), vld1_u8(tile_max + tx));
+        uint8x8x2_t min2 = vzip_u8(vld1_u8(tile_min + tx), vld1_u8(tile_min + tx));
+        uint8x16_t maxs[2], mins[2];
+        for (int i = 0; i < 2; i++) {
+            uint16x4x2_t m = vzip_u16(vreinterpret_u16_u8(max2.val[i]),
+                                      vreinterpret_u16_u8(max2.val[i]));
+            maxs[i] = vcombine_u8(vreinterpret_u8_u16(m.val[0]), vreinterpret_u8_u16(m.val[1]));
+            m = vzip_u16(vreinterpret_u16_u8(min2.val[i]), vreinterpret_u16_u8(min2.val[i]));
+            mins[i] = vcombine_u8(vreinterpret_u8_u16(m.val[0]), vreinterpret_u8_u16(m.val[1]));
+        }
+
+        for (int i = 0; i < 2; i++) {
+            uint8x16_t diff = vqsubq_u8(maxs[i], mins[i]);
+            uint8x16_t lowc = vandq_u8(vcleq_u8(diff, lowc_max), lowc_en);
+            uint8x16_t thresh = vaddq_u8(mins[i], vshrq_n_u8(diff, 1));
+
+            for (int dy = 0; dy < TILESZ; dy++) {
+                int idx = dy*stride + (tx + 4*i)*TILESZ;
+                uint8x16_t gt = vcgtq_u8(vld1q_u8(src + idx), thresh);
+                vst1q_u8(dst + idx, vbslq_u8(lowc, c127, gt));
+            }
+        }
+    }
+
+    tile_threshold_scalar_range(src, dst, stride, tile_max, tile_min, tx, tw,
+                                min_white_black_diff);
+}
+
+static int decimate_row_neon(const uint8_t *src, int width, int factor, uint8_t *dst)
+{
+    int sx = 0;
+    if (factor == 2) {
+        for (; 2*sx + 32 <= width; sx += 16)
+            vst1q_u8(dst + sx, vld2q_u8(src + 2*sx).val[0]);
+    } else if (factor == 4) {
+        for (; 4*sx + 64 <= width; sx += 16)
+            vst1q_u8(dst + sx, vld4q_u8(src + 4*sx).val[0]);
+    }
+    return decimate_row_scalar_range(src, width, factor, sx, dst);
+}
+
+static const struct image_u8_simd_kernels kernels_neon = {
+    tile_minmax_neon,
+    tile_blur_neon,
+    tile_threshold_neon,
+    decimate_row_neon,
+};
+
+#endif // IMAGE_U8_SIMD_ARM
+
+/////////////////////////////////////////////////////////////////////
+// Dispatch
+
+static const struct image_u8_simd_kernels *get_kernels(image_u8_simd_level_t level)
+{
+    switch (level) {
+#ifdef IMAGE_U8_SIMD_X86
+    case IMAGE_U8_SIMD_SSE2:
+        return &kernels_sse2;
+    case IMAGE_U8_SIMD_AVX2:
+        return &kernels_avx2;
+#endif
+#ifdef IMAGE_U8_SIMD_ARM
+    case IMAGE_U8_SIMD_NEON:
+        return &kernels_neon;
+#endif
+    default:
+        return &kernels_scalar;
+    }
+}
+
+// Written at most once by lazy initialization (every racing writer stores
+// the same value) or by image_u8_simd_set_level().
+static const struct image_u8_simd_kernels *volatile kernels = NULL;
+static volatile image_u8_simd_level_t kernels_level = IMAGE_U8_SIMD_SCALAR;
+
+int image_u8_simd_level_supported(image_u8_simd_level_t level)
+{
+    switch (level) {
+    case IMAGE_U8_SIMD_SCALAR:
+        return 1;
+#ifdef IMAGE_U8_SIMD_X86
+    case IMAGE_U8_SIMD_SSE2:
+        return 1;
+    case IMAGE_U8_SIMD_AVX2:
+        return cpu_has_avx2();
+#endif
+#ifdef IMAGE_U8_SIMD_ARM
+    case IMAGE_U8_SIMD_NEON:
+        return 1;
+#endif
+    default:
+        return 0;
+    }
+}
+
+image_u8_simd_level_t image_u8_simd_best_level(void)
+{
+#if defined(IMAGE_U8_SIMD_X86)
+    return cpu_has_avx2() ? IMAGE_U8_SIMD_AVX2 : IMAGE_U8_SIMD_SSE2;
+#elif defined(IMAGE_U8_SIMD_ARM)
+    return IMAGE_U8_SIMD_NEON;
+#else
+    return IMAGE_U8_SIMD_SCALAR;
+#endif
+}
+
+static inline const struct image_u8_simd_kernels *current_kernels(void)
+{
+    const struct image_u8_simd_kernels *k = kernels;
+    if (k == NULL) {
+        image_u8_simd_level_t level = image_u8_simd_best_level();
+        k = get_kernels(level);
+        kernels_level = level;
+        kernels = k;
+    }
+    return k;
+}
+
+image_u8_simd_level_t image_u8_simd_get_level(void)
+{
+    current_kernels();
+    return kernels_level;
+}
+
+int image_u8_simd_set_level(image_u8_simd_level_t level)
+{
+    if (!image_u8_simd_level_supported(level))
+        return 0;
+    kernels_level = level;
+    kernels = get_kernels(level);
+    return 1;
+}
+
+void image_u8_tile_minmax(const uint8_t *src, int stride, int tw,
+                          uint8_t *tile_max, uint8_t *tile_min)
+{
+    current_kernels()->tile_minmax(src, stride, tw, tile_max, tile_min);
+}
+
+void image_u8_tile_blur(const uint8_t *im_max, const uint8_t *im_min,
+                        int tw, int th, int ty,
+                        uint8_t *out_max, uint8_t *out_min)
+{
+    current_kernels()->tile_blur(im_max, im_min, tw, th, ty, out_max, out_min);
+}
+
+void image_u8_tile_threshold(const uint8_t *src, uint8_t *dst, int stride,
+                             const uint8_t *tile_max, const uint8_t *tile_min,
+                             int tw, int min_white_black_diff)
+{
+    current_kernels()->tile_threshold(src, dst, stride, tile_max, tile_min, tw,
+                                      min_white_black_diff);
+}
+
+void image_u8_decimate_row(const uint8_t *src, int width, int factor,
+                           uint8_t *dst)
+{
+    current_kernels()->decimate_row(src, width, factor, dst);
+}
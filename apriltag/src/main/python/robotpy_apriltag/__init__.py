@@ -4,6 +4,7 @@ from . import _init__apriltag
 from ._apriltag import (
     AprilTagDetection,
     AprilTagDetector,
+    AprilTagMultiTagPoseEstimator,
     AprilTagPoseEstimate,
     AprilTagPoseEstimator,
 )
@@ -11,6 +12,7 @@ from ._apriltag import (
 __all__ = [
     "AprilTagDetection",
     "AprilTagDetector",
+    "AprilTagMultiTagPoseEstimator",
     "AprilTagPoseEstimate",
     "AprilTagPoseEstimator",
 ]
@@ -4,10 +4,38 @@
 
 #include "wpi/apriltag/AprilTagDetector.hpp"
 
+#include <stdint.h>
+
+#include <vector>
+
+#include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "wpi/apriltag/AprilTagImageGenerator.hpp"
+#include "wpi/util/RawFrame.hpp"
 
 using namespace wpi::apriltag;
 
+namespace {
+constexpr int kWidth = 640;
+constexpr int kHeight = 480;
+
+// Renders a 36h11 tag with the given cell size onto a gray background
+std::vector<uint8_t> MakeTagImage(int id, int x, int y, int scale) {
+  std::vector<uint8_t> image(kWidth * kHeight, 128);
+  wpi::util::RawFrame frame;
+  Generate36h11AprilTagImage(&frame, id);
+  for (int ty = 0; ty < frame.height * scale; ++ty) {
+    for (int tx = 0; tx < frame.width * scale; ++tx) {
+      image[(y + ty) * kWidth + x + tx] =
+          frame.data[(ty / scale) * frame.stride + tx / scale];
+    }
+  }
+  return image;
+}
+}  // namespace
+
 TEST_CASE("AprilTagDetectorTest ConfigDefaults", "[apriltag][detector]") {
   AprilTagDetector detector;
   auto config = detector.GetConfig();
@@ -61,3 +89,115 @@ TEST_CASE("AprilTagDetectorTest RemoveFamily", "[apriltag][detector]") {
   detector.AddFamily("tag16h5");
   detector.RemoveFamily("tag16h5");
 }
+
+TEST_CASE("AprilTagDetectorTest TrackingConfigDefaults",
+          "[apriltag][detector]") {
+  AprilTagDetector detector;
+  REQUIRE(detector.GetTrackingConfig() == AprilTagDetector::TrackingConfig{});
+  REQUIRE_FALSE(detector.GetTrackingConfig().enabled);
+}
+
+TEST_CASE("AprilTagDetectorTest TrackingMatchesFullFrame",
+          "[apriltag][detector]") {
+  AprilTagDetector full;
+  full.AddFamily("tag36h11");
+  AprilTagDetector tracking;
+  tracking.AddFamily("tag36h11");
+  tracking.SetTrackingConfig({.enabled = true, .fullScanPeriod = 4});
+
+  for (int frame = 0; frame < 9; ++frame) {
+    auto image = MakeTagImage(5, 200 + 3 * frame, 150 + 2 * frame, 10);
+    auto expected = full.Detect(kWidth, kHeight, image.data());
+    auto actual = tracking.Detect(kWidth, kHeight, image.data());
+
+    INFO("frame " << frame);
+    CHECK(tracking.WasLastDetectFullFrame() == (frame % 4 == 0));
+    REQUIRE(expected.size() == 1);
+    REQUIRE(actual.size() == 1);
+    CHECK(actual[0]->GetId() == 5);
+    CHECK(actual[0]->GetCenter().x ==
+          Catch::Approx(expected[0]->GetCenter().x).margin(0.5));
+    CHECK(actual[0]->GetCenter().y ==
+          Catch::Approx(expected[0]->GetCenter().y).margin(0.5));
+    auto expectedH = expected[0]->GetHomographyMatrix();
+    auto actualH = actual[0]->GetHomographyMatrix();
+    // compare the projected center, as H is only defined up to scale
+    CHECK(actualH(0, 2) / actualH(2, 2) ==
+          Catch::Approx(expectedH(0, 2) / expectedH(2, 2)).margin(0.5));
+    CHECK(actualH(1, 2) / actualH(2, 2) ==
+          Catch::Approx(expectedH(1, 2) / expectedH(2, 2)).margin(0.5));
+  }
+}
+
+TEST_CASE("AprilTagDetectorTest TrackingMatchesFullFrameDecimated",
+          "[apriltag][detector]") {
+  float decimate = GENERATE(1.5f, 3.0f, 4.0f);
+  INFO("quadDecimate " << decimate);
+  AprilTagDetector full;
+  full.AddFamily("tag36h11");
+  full.SetConfig({.quadDecimate = decimate});
+  AprilTagDetector tracking;
+  tracking.AddFamily("tag36h11");
+  tracking.SetConfig({.quadDecimate = decimate});
+  tracking.SetTrackingConfig({.enabled = true, .fullScanPeriod = 100});
+
+  for (int frame = 0; frame < 4; ++frame) {
+    auto image = MakeTagImage(5, 203 + 5 * frame, 151 + 3 * frame, 20);
+    auto expected = full.Detect(kWidth, kHeight, image.data());
+    auto actual = tracking.Detect(kWidth, kHeight, image.data());
+
+    INFO("frame " << frame);
+    CHECK(tracking.WasLastDetectFullFrame() == (frame == 0));
+    REQUIRE(expected.size() == 1);
+    REQUIRE(actual.size() == 1);
+    for (int i = 0; i < 4; ++i) {
+      CHECK(actual[0]->GetCorner(i).x ==
+            Catch::Approx(expected[0]->GetCorner(i).x).margin(0.5));
+      CHECK(actual[0]->GetCorner(i).y ==
+            Catch::Approx(expected[0]->GetCorner(i).y).margin(0.5));
+    }
+  }
+}
+
+TEST_CASE("AprilTagDetectorTest TrackingLostTagRescans",
+          "[apriltag][detector]") {
+  AprilTagDetector detector;
+  detector.AddFamily("tag36h11");
+  detector.SetTrackingConfig({.enabled = true, .fullScanPeriod = 100});
+
+  auto image = MakeTagImage(3, 100, 100, 10);
+  REQUIRE(detector.Detect(kWidth, kHeight, image.data()).size() == 1);
+  REQUIRE(detector.WasLastDetectFullFrame());
+  REQUIRE(detector.Detect(kWidth, kHeight, image.data()).size() == 1);
+  REQUIRE_FALSE(detector.WasLastDetectFullFrame());
+
+  // the tag jumps far outside its tracked region
+  image = MakeTagImage(3, 400, 300, 10);
+  auto results = detector.Detect(kWidth, kHeight, image.data());
+  REQUIRE(results.size() == 1);
+  CHECK(detector.WasLastDetectFullFrame());
+  CHECK(results[0]->GetCenter().x == Catch::Approx(450).margin(1));
+}
+
+TEST_CASE("AprilTagDetectorTest TrackingPrediction", "[apriltag][detector]") {
+  AprilTagDetector detector;
+  detector.AddFamily("tag36h11");
+  detector.SetTrackingConfig({.enabled = true, .fullScanPeriod = 100});
+
+  auto image = MakeTagImage(3, 100, 100, 10);
+  REQUIRE(detector.Detect(kWidth, kHeight, image.data()).size() == 1);
+
+  // a second tag comes into view where it was predicted
+  image = MakeTagImage(3, 100, 100, 10);
+  auto other = MakeTagImage(7, 400, 300, 10);
+  for (int y = 300; y < 400; ++y) {
+    for (int x = 400; x < 500; ++x) {
+      image[y * kWidth + x] = other[y * kWidth + x];
+    }
+  }
+  const double corners[8] = {400, 400, 500, 400, 500, 300, 400, 300};
+  detector.AddTrackingPrediction(corners);
+  auto results = detector.Detect(kWidth, kHeight, image.data());
+  CHECK_FALSE(detector.WasLastDetectFullFrame());
+  REQUIRE(results.size() == 2);
+}
@@ -0,0 +1,193 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/apriltag/AprilTagMultiTagPoseEstimator.hpp"
+
+#include <stdint.h>
+
+#include <array>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "wpi/apriltag/AprilTagDetector.hpp"
+#include "wpi/apriltag/AprilTagImageGenerator.hpp"
+#include "wpi/util/RawFrame.hpp"
+
+using namespace wpi::apriltag;
+using namespace wpi::units::literals;
+
+namespace {
+constexpr AprilTagPoseEstimator::Config kConfig{0.1651_m, 600, 600, 320, 240};
+
+// Projects the corners of a tag with the given field pose into a camera with
+// the given field pose, in detection corner order
+std::array<double, 8> ProjectTag(const wpi::math::Pose3d& tag,
+                                 const wpi::math::Pose3d& camera,
+                                 const AprilTagPoseEstimator::Config& config) {
+  // bottom left, bottom right, top right, top left as seen facing the tag
+  constexpr double kCorners[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+  double halfSize = config.tagSize.value() / 2;
+  std::array<double, 8> pixels;
+  for (int i = 0; i < 4; ++i) {
+    wpi::math::Translation3d offset{
+        0_m, wpi::units::meter_t{kCorners[i][0] * halfSize},
+        wpi::units::meter_t{kCorners[i][1] * halfSize}};
+    auto corner = tag.TransformBy({offset, wpi::math::Rotation3d{}});
+    auto p = corner.RelativeTo(camera).Translation();
+    pixels[i * 2] = config.cx - config.fx * p.Y().value() / p.X().value();
+    pixels[i * 2 + 1] = config.cy - config.fy * p.Z().value() / p.X().value();
+  }
+  return pixels;
+}
+
+void AddTags(AprilTagMultiTagPoseEstimator& estimator,
+             std::span<const wpi::math::Pose3d> tags) {
+  for (size_t i = 0; i < tags.size(); ++i) {
+    estimator.AddTagPose(i + 1, tags[i]);
+  }
+}
+
+void CheckPose(const wpi::math::Pose3d& actual,
+               const wpi::math::Pose3d& expected, double tolerance) {
+  CHECK(actual.X().value() ==
+        Catch::Approx(expected.X().value()).margin(tolerance));
+  CHECK(actual.Y().value() ==
+        Catch::Approx(expected.Y().value()).margin(tolerance));
+  CHECK(actual.Z().value() ==
+        Catch::Approx(expected.Z().value()).margin(tolerance));
+  CHECK(actual.Rotation().RelativeTo(expected.Rotation()).Angle().value() ==
+        Catch::Approx(0).margin(tolerance));
+}
+
+// Two tags on a wall facing +X and one on a side wall facing -Y
+const wpi::math::Pose3d kTags[] = {
+    {0_m, 1_m, 0.5_m, wpi::math::Rotation3d{}},
+    {0_m, 2_m, 0.8_m, wpi::math::Rotation3d{}},
+    {1_m, 3_m, 0.6_m,
+     wpi::math::Rotation3d{0_rad, 0_rad,
+                           wpi::units::radian_t{-std::numbers::pi / 2}}}};
+
+const wpi::math::Pose3d kCamera{
+    3_m, 1.8_m, 0.4_m,
+    wpi::math::Rotation3d{0_rad, -0.1_rad, wpi::units::radian_t{3.0}}};
+}  // namespace
+
+TEST_CASE("AprilTagMultiTagPoseEstimatorTest NoKnownTags",
+          "[apriltag][pose]") {
+  AprilTagMultiTagPoseEstimator estimator{kConfig};
+  AddTags(estimator, kTags);
+  const int ids[] = {7};
+  const std::array<double, 8> corners[] = {
+      ProjectTag(kTags[0], kCamera, kConfig)};
+  REQUIRE_FALSE(estimator.Estimate(ids, corners));
+}
+
+TEST_CASE("AprilTagMultiTagPoseEstimatorTest ExactCorners",
+          "[apriltag][pose]") {
+  AprilTagMultiTagPoseEstimator estimator{kConfig};
+  AddTags(estimator, kTags);
+
+  const int ids[] = {1, 2, 3, 9};
+  std::array<double, 8> corners[4];
+  for (int i = 0; i < 3; ++i) {
+    corners[i] = ProjectTag(kTags[i], kCamera, kConfig);
+  }
+  // unknown tags are ignored
+  corners[3] = corners[0];
+
+  auto result = estimator.Estimate(ids, corners);
+  REQUIRE(result);
+  CHECK(result->numTags == 3);
+  CHECK(result->error == Catch::Approx(0).margin(1e-6));
+  CheckPose(result->cameraPose, kCamera, 1e-6);
+}
+
+TEST_CASE("AprilTagMultiTagPoseEstimatorTest SingleTag", "[apriltag][pose]") {
+  AprilTagMultiTagPoseEstimator estimator{kConfig};
+  AddTags(estimator, kTags);
+
+  const int ids[] = {2};
+  const std::array<double, 8> corners[] = {
+      ProjectTag(kTags[1], kCamera, kConfig)};
+  auto result = estimator.Estimate(ids, corners);
+  REQUIRE(result);
+  CHECK(result->numTags == 1);
+  CheckPose(result->cameraPose, kCamera, 1e-4);
+}
+
+TEST_CASE("AprilTagMultiTagPoseEstimatorTest NoisyCorners",
+          "[apriltag][pose]") {
+  AprilTagMultiTagPoseEstimator estimator{kConfig};
+  AddTags(estimator, kTags);
+
+  std::mt19937 gen{1};
+  std::normal_distribution<double> noise{0, 0.5};
+  const int ids[] = {1, 2, 3};
+  std::array<double, 8> corners[3];
+  for (int i = 0; i < 3; ++i) {
+    corners[i] = ProjectTag(kTags[i], kCamera, kConfig);
+    for (auto&& v : corners[i]) {
+      v += noise(gen);
+    }
+  }
+
+  auto result = estimator.Estimate(ids, corners);
+  REQUIRE(result);
+  CHECK(result->error < 1.0);
+  CheckPose(result->cameraPose, kCamera, 0.05);
+}
+
+TEST_CASE("AprilTagMultiTagPoseEstimatorTest TagSizeChange",
+          "[apriltag][pose]") {
+  auto config = kConfig;
+  config.tagSize = 0.2_m;
+  AprilTagMultiTagPoseEstimator estimator{config};
+  AddTags(estimator, kTags);
+  estimator.SetConfig(kConfig);
+
+  const int ids[] = {1, 2};
+  const std::array<double, 8> corners[] = {
+      ProjectTag(kTags[0], kCamera, kConfig),
+      ProjectTag(kTags[1], kCamera, kConfig)};
+  auto result = estimator.Estimate(ids, corners);
+  REQUIRE(result);
+  CheckPose(result->cameraPose, kCamera, 1e-6);
+}
+
+TEST_CASE("AprilTagMultiTagPoseEstimatorTest Detection", "[apriltag][pose]") {
+  // 10 pixel cells put the 8 cell black border of a 0.16 m tag at 1 m with
+  // these intrinsics
+  constexpr int kWidth = 640;
+  constexpr int kHeight = 480;
+  constexpr int kScale = 10;
+  std::vector<uint8_t> image(kWidth * kHeight, 128);
+  wpi::util::RawFrame frame;
+  Generate36h11AprilTagImage(&frame, 4);
+  for (int ty = 0; ty < frame.height * kScale; ++ty) {
+    for (int tx = 0; tx < frame.width * kScale; ++tx) {
+      image[(190 + ty) * kWidth + 270 + tx] =
+          frame.data[(ty / kScale) * frame.stride + tx / kScale];
+    }
+  }
+
+  AprilTagDetector detector;
+  detector.AddFamily("tag36h11");
+  auto detections = detector.Detect(kWidth, kHeight, image.data());
+  REQUIRE(detections.size() == 1);
+
+  AprilTagMultiTagPoseEstimator estimator{{0.16_m, 500, 500, 320, 240}};
+  estimator.AddTagPose(4, wpi::math::Pose3d{});
+  auto result = estimator.Estimate(detections);
+  REQUIRE(result);
+  CHECK(result->numTags == 1);
+  CheckPose(result->cameraPose,
+            {1_m, 0_m, 0_m,
+             wpi::math::Rotation3d{0_rad, 0_rad,
+                                   wpi::units::radian_t{std::numbers::pi}}},
+            0.02);
+}
@@ -0,0 +1,122 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <stdint.h>
+
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "common/image_u8_simd.h"
+
+namespace {
+
+struct TileOutputs {
+  std::vector<uint8_t> max;
+  std::vector<uint8_t> min;
+  std::vector<uint8_t> blurMax;
+  std::vector<uint8_t> blurMin;
+  std::vector<uint8_t> thresh;
+  std::vector<uint8_t> decim;
+};
+
+class LevelGuard {
+ public:
+  LevelGuard() : m_level{image_u8_simd_get_level()} {}
+  ~LevelGuard() { image_u8_simd_set_level(m_level); }
+
+ private:
+  image_u8_simd_level_t m_level;
+};
+
+std::vector<uint8_t> MakeImage(int width, int height, int stride,
+                               uint32_t seed) {
+  std::mt19937 gen{seed};
+  std::uniform_int_distribution<int> dist{0, 255};
+  std::vector<uint8_t> image(stride * height);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      // mix noise with flat patches so both the low contrast and the
+      // threshold paths are exercised
+      int v = dist(gen);
+      image[y * stride + x] =
+          ((x / 24 + y / 24) % 3 == 0) ? static_cast<uint8_t>(100 + v % 4)
+                                       : static_cast<uint8_t>(v);
+    }
+  }
+  return image;
+}
+
+TileOutputs RunKernels(image_u8_simd_level_t level,
+                       const std::vector<uint8_t>& image, int width,
+                       int height, int stride, int minWhiteBlackDiff,
+                       int factor) {
+  REQUIRE(image_u8_simd_set_level(level));
+
+  const int tw = width / IMAGE_U8_SIMD_TILESZ;
+  const int th = height / IMAGE_U8_SIMD_TILESZ;
+  TileOutputs out;
+  out.max.resize(tw * th);
+  out.min.resize(tw * th);
+  out.blurMax.resize(tw * th);
+  out.blurMin.resize(tw * th);
+  out.thresh.resize(stride * height);
+  out.decim.resize(1 + (width - 1) / factor);
+
+  const int rowStride = IMAGE_U8_SIMD_TILESZ * stride;
+  for (int ty = 0; ty < th; ++ty) {
+    image_u8_tile_minmax(&image[ty * rowStride], stride, tw, &out.max[ty * tw],
+                         &out.min[ty * tw]);
+  }
+  for (int ty = 0; ty < th; ++ty) {
+    image_u8_tile_blur(out.max.data(), out.min.data(), tw, th, ty,
+                       &out.blurMax[ty * tw], &out.blurMin[ty * tw]);
+  }
+  for (int ty = 0; ty < th; ++ty) {
+    image_u8_tile_threshold(&image[ty * rowStride], &out.thresh[ty * rowStride],
+                            stride, &out.blurMax[ty * tw],
+                            &out.blurMin[ty * tw], tw, minWhiteBlackDiff);
+  }
+  image_u8_decimate_row(image.data(), width, factor, out.decim.data());
+  return out;
+}
+
+}  // namespace
+
+TEST_CASE("ImageU8SimdTest ScalarAlwaysSupported", "[apriltag][simd]") {
+  REQUIRE(image_u8_simd_level_supported(IMAGE_U8_SIMD_SCALAR));
+  REQUIRE(image_u8_simd_level_supported(image_u8_simd_best_level()));
+}
+
+TEST_CASE("ImageU8SimdTest BitExact", "[apriltag][simd]") {
+  LevelGuard guard;
+
+  auto width = GENERATE(4, 7, 33, 64, 127, 130, 640, 1283);
+  auto height = GENERATE(4, 9, 41);
+  auto minWhiteBlackDiff = GENERATE(-1, 0, 1, 5, 128, 255, 256, 1000);
+  auto factor = GENERATE(1, 2, 3, 4);
+  const int stride = width + 29;
+
+  auto image = MakeImage(width, height, stride, width * 1000 + height);
+  auto expected = RunKernels(IMAGE_U8_SIMD_SCALAR, image, width, height,
+                             stride, minWhiteBlackDiff, factor);
+
+  for (auto level : {IMAGE_U8_SIMD_SSE2, IMAGE_U8_SIMD_AVX2,
+                     IMAGE_U8_SIMD_NEON}) {
+    if (!image_u8_simd_level_supported(level)) {
+      continue;
+    }
+    INFO("level " << level << " width " << width << " height " << height);
+    auto actual = RunKernels(level, image, width, height, stride,
+                             minWhiteBlackDiff, factor);
+    CHECK(actual.max == expected.max);
+    CHECK(actual.min == expected.min);
+    CHECK(actual.blurMax == expected.blurMax);
+    CHECK(actual.blurMin == expected.blurMin);
+    CHECK(actual.thresh == expected.thresh);
+    CHECK(actual.decim == expected.decim);
+  }
+}
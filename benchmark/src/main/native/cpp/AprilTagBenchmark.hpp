@@ -0,0 +1,313 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "common/image_u8_simd.h"
+#include "wpi/apriltag/AprilTagDetector.hpp"
+#include "wpi/apriltag/AprilTagImageGenerator.hpp"
+#include "wpi/apriltag/AprilTagMultiTagPoseEstimator.hpp"
+#include "wpi/apriltag/AprilTagPoseEstimator.hpp"
+#include "wpi/util/RawFrame.hpp"
+
+/** A 36h11 tag drawn into a synthetic scene. */
+struct AprilTagScenePlacement {
+  int id;
+  int x;
+  int y;
+  /** Size of one tag cell in pixels. */
+  int scale;
+};
+
+/**
+ * Renders a grayscale scene of the given size with 36h11 tags over a noisy
+ * gradient background.
+ */
+inline std::vector<uint8_t> MakeAprilTagScene(
+    int width, int height, std::span<const AprilTagScenePlacement> tags,
+    uint32_t seed = 0) {
+  std::vector<uint8_t> image(width * height);
+  std::mt19937 gen{seed};
+  std::uniform_int_distribution<int> noise{-8, 8};
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      int v = 64 + 128 * (x + y) / (width + height) + noise(gen);
+      image[y * width + x] = static_cast<uint8_t>(std::clamp(v, 0, 255));
+    }
+  }
+
+  wpi::util::RawFrame frame;
+  for (auto&& tag : tags) {
+    wpi::apriltag::Generate36h11AprilTagImage(&frame, tag.id);
+    for (int ty = 0; ty < frame.height * tag.scale; ++ty) {
+      int y = tag.y + ty;
+      if (y < 0 || y >= height) {
+        continue;
+      }
+      for (int tx = 0; tx < frame.width * tag.scale; ++tx) {
+        int x = tag.x + tx;
+        if (x < 0 || x >= width) {
+          continue;
+        }
+        uint8_t v = static_cast<uint8_t>(
+            frame.data[(ty / tag.scale) * frame.stride + tx / tag.scale]);
+        // keep the tag from being perfectly black and white
+        image[y * width + x] = v ? 230 : 25;
+      }
+    }
+  }
+  return image;
+}
+
+inline constexpr int kAprilTagBenchWidth = 1280;
+inline constexpr int kAprilTagBenchHeight = 800;
+
+inline const std::vector<uint8_t>& AprilTagBenchImage() {
+  static const std::vector<uint8_t> image = [] {
+    const AprilTagScenePlacement tags[] = {
+        {1, 100, 120, 16}, {2, 520, 200, 10}, {3, 900, 420, 20}};
+    return MakeAprilTagScene(kAprilTagBenchWidth, kAprilTagBenchHeight, tags);
+  }();
+  return image;
+}
+
+/**
+ * Selects the SIMD level given as the first benchmark argument, skipping the
+ * benchmark if the CPU doesn't support it. The previous level is restored
+ * when the guard is destroyed.
+ */
+class AprilTagSimdLevelGuard {
+ public:
+  explicit AprilTagSimdLevelGuard(benchmark::State& state)
+      : m_prev{image_u8_simd_get_level()} {
+    auto level = static_cast<image_u8_simd_level_t>(state.range(0));
+    if (!image_u8_simd_set_level(level)) {
+      state.SkipWithMessage("SIMD level not supported on this CPU");
+    }
+  }
+  ~AprilTagSimdLevelGuard() { image_u8_simd_set_level(m_prev); }
+
+ private:
+  image_u8_simd_level_t m_prev;
+};
+
+inline void BM_AprilTag_Decimate(benchmark::State& state) {
+  AprilTagSimdLevelGuard guard{state};
+  const auto& image = AprilTagBenchImage();
+  constexpr int w = kAprilTagBenchWidth;
+  constexpr int h = kAprilTagBenchHeight;
+  std::vector<uint8_t> out((w / 2) * (h / 2));
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    for (int y = 0; y < h; y += 2) {
+      image_u8_decimate_row(&image[y * w], w, 2, &out[(y / 2) * (w / 2)]);
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetBytesProcessed(state.iterations() * w * h);
+}
+
+inline void BM_AprilTag_TileMinMax(benchmark::State& state) {
+  AprilTagSimdLevelGuard guard{state};
+  const auto& image = AprilTagBenchImage();
+  constexpr int w = kAprilTagBenchWidth;
+  constexpr int tw = w / IMAGE_U8_SIMD_TILESZ;
+  constexpr int th = kAprilTagBenchHeight / IMAGE_U8_SIMD_TILESZ;
+  std::vector<uint8_t> max(tw * th), min(tw * th);
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    for (int ty = 0; ty < th; ++ty) {
+      image_u8_tile_minmax(&image[ty * IMAGE_U8_SIMD_TILESZ * w], w, tw,
+                           &max[ty * tw], &min[ty * tw]);
+    }
+    benchmark::DoNotOptimize(max.data());
+    benchmark::DoNotOptimize(min.data());
+  }
+  state.SetBytesProcessed(state.iterations() * w * kAprilTagBenchHeight);
+}
+
+inline void BM_AprilTag_TileBlur(benchmark::State& state) {
+  AprilTagSimdLevelGuard guard{state};
+  const auto& image = AprilTagBenchImage();
+  constexpr int w = kAprilTagBenchWidth;
+  constexpr int tw = w / IMAGE_U8_SIMD_TILESZ;
+  constexpr int th = kAprilTagBenchHeight / IMAGE_U8_SIMD_TILESZ;
+  std::vector<uint8_t> max(tw * th), min(tw * th);
+  std::vector<uint8_t> blurMax(tw * th), blurMin(tw * th);
+  for (int ty = 0; ty < th; ++ty) {
+    image_u8_tile_minmax(&image[ty * IMAGE_U8_SIMD_TILESZ * w], w, tw,
+                         &max[ty * tw], &min[ty * tw]);
+  }
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    for (int ty = 0; ty < th; ++ty) {
+      image_u8_tile_blur(max.data(), min.data(), tw, th, ty, &blurMax[ty * tw],
+                         &blurMin[ty * tw]);
+    }
+    benchmark::DoNotOptimize(blurMax.data());
+    benchmark::DoNotOptimize(blurMin.data());
+  }
+}
+
+inline void BM_AprilTag_TileThreshold(benchmark::State& state) {
+  AprilTagSimdLevelGuard guard{state};
+  const auto& image = AprilTagBenchImage();
+  constexpr int w = kAprilTagBenchWidth;
+  constexpr int tw = w / IMAGE_U8_SIMD_TILESZ;
+  constexpr int th = kAprilTagBenchHeight / IMAGE_U8_SIMD_TILESZ;
+  std::vector<uint8_t> max(tw * th), min(tw * th);
+  std::vector<uint8_t> thresh(image.size());
+  for (int ty = 0; ty < th; ++ty) {
+    image_u8_tile_minmax(&image[ty * IMAGE_U8_SIMD_TILESZ * w], w, tw,
+                         &max[ty * tw], &min[ty * tw]);
+  }
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    for (int ty = 0; ty < th; ++ty) {
+      int offset = ty * IMAGE_U8_SIMD_TILESZ * w;
+      image_u8_tile_threshold(&image[offset], &thresh[offset], w,
+                              &max[ty * tw], &min[ty * tw], tw, 5);
+    }
+    benchmark::DoNotOptimize(thresh.data());
+  }
+  state.SetBytesProcessed(state.iterations() * w * kAprilTagBenchHeight);
+}
+
+inline void BM_AprilTag_Detect(benchmark::State& state) {
+  AprilTagSimdLevelGuard guard{state};
+  auto image = AprilTagBenchImage();
+  wpi::apriltag::AprilTagDetector detector;
+  detector.AddFamily("tag36h11");
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    auto results = detector.Detect(kAprilTagBenchWidth, kAprilTagBenchHeight,
+                                   image.data());
+    benchmark::DoNotOptimize(results.size());
+  }
+}
+
+/**
+ * A sequence of frames with three tags drifting a few pixels per frame, as
+ * seen by a camera on a slowly moving robot.
+ */
+inline const std::vector<std::vector<uint8_t>>& AprilTagBenchSequence() {
+  static const std::vector<std::vector<uint8_t>> frames = [] {
+    std::vector<std::vector<uint8_t>> frames;
+    for (int i = 0; i < 30; ++i) {
+      const AprilTagScenePlacement tags[] = {{1, 100 + 4 * i, 120 + i, 16},
+                                             {2, 520 + 3 * i, 200 - i, 10},
+                                             {3, 900 - 5 * i, 420, 20}};
+      frames.emplace_back(MakeAprilTagScene(
+          kAprilTagBenchWidth, kAprilTagBenchHeight, tags, i));
+    }
+    return frames;
+  }();
+  return frames;
+}
+
+/**
+ * Detection cost per frame over an image sequence with region-of-interest
+ * tracking disabled (argument 0) or enabled (argument 1).
+ */
+inline void BM_AprilTag_DetectSequence(benchmark::State& state) {
+  auto frames = AprilTagBenchSequence();
+  wpi::apriltag::AprilTagDetector detector;
+  detector.AddFamily("tag36h11");
+  detector.SetTrackingConfig({.enabled = state.range(0) != 0});
+  size_t i = 0;
+  int64_t fullFrames = 0;
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    auto results = detector.Detect(kAprilTagBenchWidth, kAprilTagBenchHeight,
+                                   frames[i].data());
+    benchmark::DoNotOptimize(results.size());
+    if (detector.WasLastDetectFullFrame()) {
+      ++fullFrames;
+    }
+    i = (i + 1) % frames.size();
+  }
+  state.counters["fullFrameRatio"] = benchmark::Counter(
+      static_cast<double>(fullFrames) / state.iterations());
+}
+
+/**
+ * Four tags on a wall facing the camera, detected once. Every tag is drawn at
+ * the same scale so the image is an exact pinhole view of the wall with
+ * kAprilTagBenchPoseConfig.
+ */
+inline const wpi::apriltag::AprilTagDetector::Results&
+AprilTagBenchPoseDetections() {
+  static const std::vector<uint8_t> image = [] {
+    const AprilTagScenePlacement tags[] = {{1, 200, 150, 10},
+                                           {2, 900, 150, 10},
+                                           {3, 300, 550, 10},
+                                           {4, 1000, 500, 10}};
+    return MakeAprilTagScene(kAprilTagBenchWidth, kAprilTagBenchHeight, tags);
+  }();
+  static wpi::apriltag::AprilTagDetector detector = [] {
+    wpi::apriltag::AprilTagDetector detector;
+    detector.AddFamily("tag36h11");
+    return detector;
+  }();
+  static const auto results =
+      detector.Detect(kAprilTagBenchWidth, kAprilTagBenchHeight,
+                      const_cast<uint8_t*>(image.data()));
+  return results;
+}
+
+// 10 pixel cells put the 8 cell tag border at 1 m
+inline constexpr wpi::apriltag::AprilTagPoseEstimator::Config
+    kAprilTagBenchPoseConfig{wpi::units::meter_t{0.16}, 500, 500,
+                             kAprilTagBenchWidth / 2.0,
+                             kAprilTagBenchHeight / 2.0};
+
+/** Per-tag pose estimates for every detection. */
+inline void BM_AprilTag_PoseEstimatePerTag(benchmark::State& state) {
+  const auto& detections = AprilTagBenchPoseDetections();
+  wpi::apriltag::AprilTagPoseEstimator estimator{kAprilTagBenchPoseConfig};
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    for (auto&& detection : detections) {
+      auto pose = estimator.Estimate(*detection);
+      benchmark::DoNotOptimize(pose);
+    }
+  }
+  state.counters["tags"] = detections.size();
+}
+
+/** A single camera pose estimate from all detections. */
+inline void BM_AprilTag_PoseEstimateMultiTag(benchmark::State& state) {
+  const auto& detections = AprilTagBenchPoseDetections();
+  wpi::apriltag::AprilTagMultiTagPoseEstimator estimator{
+      kAprilTagBenchPoseConfig};
+  // wall at X = 0 facing the camera 1 m away
+  for (auto&& detection : detections) {
+    auto center = detection->GetCenter();
+    double scale = 1.0 / kAprilTagBenchPoseConfig.fx;
+    estimator.AddTagPose(
+        detection->GetId(),
+        {wpi::units::meter_t{0},
+         wpi::units::meter_t{(center.x - kAprilTagBenchPoseConfig.cx) * scale},
+         wpi::units::meter_t{(kAprilTagBenchPoseConfig.cy - center.y) * scale},
+         wpi::math::Rotation3d{}});
+  }
+  double error = 0;
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    auto result = estimator.Estimate(detections);
+    benchmark::DoNotOptimize(result);
+    error = result ? result->error : -1;
+  }
+  state.counters["tags"] = detections.size();
+  state.counters["error"] = error;
+}
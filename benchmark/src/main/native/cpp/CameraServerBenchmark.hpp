@@ -0,0 +1,388 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <ctime>
+#include <format>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgcodecs/imgcodecs.hpp>
+
+#include "wpi/cs/HttpCamera.hpp"
+#include "wpi/cs/MjpegServer.hpp"
+#include "wpi/cs/RawSink.hpp"
+#include "wpi/cs/RawSource.hpp"
+#include "wpi/cs/SharedMemorySink.hpp"
+#include "wpi/cs/SharedMemorySource.hpp"
+#include "wpi/cs/cscore_raw.hpp"
+#include "wpi/net/EventLoopRunner.hpp"
+#include "wpi/net/uv/Tcp.hpp"
+#include "wpi/util/PixelFormat.hpp"
+#include "wpi/util/RawFrame.hpp"
+
+inline constexpr unsigned int kCameraServerBenchPort = 10210;
+
+/**
+ * Minimal stand-in for an IP camera. Each connection gets a
+ * multipart/x-mixed-replace response and then a small JPEG frame every time
+ * the previous one has been written.
+ */
+class CameraServerBenchServer {
+ public:
+  explicit CameraServerBenchServer(unsigned int port) {
+    using namespace std::string_view_literals;
+    std::string jpeg{"\xff\xd8"sv};
+    jpeg += "\xff\xc0\x00\x0b\x08\x00\xf0\x01\x40\x01\x01\x11\x00"sv;
+    jpeg += "\xff\xda\x00\x08\x01\x01\x00\x00\x3f\x00"sv;
+    jpeg += std::string(4000, '\x55');
+    jpeg += "\xff\xd9"sv;
+    m_part = std::format(
+        "\r\n--bound\r\nContent-Type: image/jpeg\r\nContent-Length: {}"
+        "\r\n\r\n{}",
+        jpeg.size(), jpeg);
+
+    m_runner.ExecSync([&](auto& loop) {
+      auto server = wpi::net::uv::Tcp::Create(loop);
+      server->Bind("127.0.0.1", port);
+      server->connection.connect([this, srv = server.get()] {
+        auto client = srv->Accept();
+        if (!client) {
+          return;
+        }
+        // respond to the request without parsing it
+        client->data.connect([this, c = client.get(), started = false](
+                                 auto&, size_t) mutable {
+          if (!started) {
+            started = true;
+            c->Write({{"HTTP/1.1 200 OK\r\nContent-Type: "
+                       "multipart/x-mixed-replace;boundary=bound\r\n\r\n"}},
+                     [](auto, auto) {});
+            SendFrame(*c);
+          }
+        });
+        client->end.connect([c = client.get()] { c->Close(); });
+        client->error.connect([c = client.get()](auto) { c->Close(); });
+        client->StartRead();
+      });
+      server->Listen();
+    });
+  }
+
+ private:
+  void SendFrame(wpi::net::uv::Stream& client) {
+    client.Write({{m_part}}, [this, c = client.shared_from_this()](auto,
+                                                                   auto err) {
+      if (!err && !c->IsClosing()) {
+        SendFrame(*c);
+      }
+    });
+  }
+
+  std::string m_part;
+  wpi::net::EventLoopRunner m_runner;
+};
+
+/**
+ * Streams MJPEG from a local server into many HTTP cameras at once. Each
+ * iteration grabs the next frame from every camera with a raw sink that
+ * passes the JPEG through without decoding it. Argument is the number of
+ * cameras.
+ */
+inline void BM_CameraServer_HttpCameraStreams(benchmark::State& state) {
+  int numCameras = state.range(0);
+  CameraServerBenchServer server{kCameraServerBenchPort};
+
+  struct Camera {
+    wpi::cs::HttpCamera camera;
+    wpi::cs::RawSink sink;
+    wpi::util::RawFrame frame;
+
+    uint64_t GrabFrame(double timeout) {
+      // unknown format gets the JPEG as received
+      frame.pixelFormat = WPI_PIXFMT_UNKNOWN;
+      CS_Status status = 0;
+      return wpi::cs::GrabSinkFrameTimeout(sink.GetHandle(), frame, timeout,
+                                           &status);
+    }
+  };
+  std::vector<std::unique_ptr<Camera>> cameras;
+  for (int i = 0; i < numCameras; ++i) {
+    auto url = std::format("http://127.0.0.1:{}/?camera={}",
+                           kCameraServerBenchPort, i);
+    cameras.emplace_back(new Camera{
+        wpi::cs::HttpCamera{std::format("bench{}", i), url},
+        wpi::cs::RawSink{std::format("benchsink{}", i)}, {}});
+    cameras.back()->sink.SetSource(cameras.back()->camera);
+  }
+
+  // wait for every camera to connect
+  for (auto&& camera : cameras) {
+    if (camera->GrabFrame(5.0) == 0) {
+      state.SkipWithError("camera did not connect");
+      return;
+    }
+  }
+
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    for (auto&& camera : cameras) {
+      if (camera->GrabFrame(1.0) == 0) {
+        state.SkipWithError("timed out waiting for frame");
+        return;
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * numCameras);
+}
+
+/**
+ * Makes a camera-like BGR sample image: smooth gradients with fine texture.
+ */
+inline cv::Mat MakeCameraServerBenchMat(int width, int height) {
+  cv::Mat image{height, width, CV_8UC3};
+  uint32_t noise = 1;
+  for (int y = 0; y < height; ++y) {
+    uchar* row = image.ptr<uchar>(y);
+    for (int x = 0; x < width; ++x) {
+      noise = noise * 1103515245 + 12345;
+      int texture = (noise >> 16) & 0x7;
+      row[x * 3] = (x * 255 / width + texture) & 0xff;
+      row[x * 3 + 1] = (y * 255 / height + texture) & 0xff;
+      row[x * 3 + 2] = ((x + y) * 127 / (width + height) + texture) & 0xff;
+    }
+  }
+  return image;
+}
+
+/**
+ * Makes a MakeCameraServerBenchMat() image compressed at quality 90.
+ */
+inline std::vector<uchar> MakeCameraServerBenchJpeg(int width, int height) {
+  std::vector<uchar> jpeg;
+  cv::imencode(".jpg", MakeCameraServerBenchMat(width, height), jpeg,
+               {cv::IMWRITE_JPEG_QUALITY, 90});
+  return jpeg;
+}
+
+/**
+ * Converts a 1280x720 MJPEG frame to BGR or grayscale at full, 1/2, 1/4, and
+ * 1/8 size, as done when serving a smaller stream from an MJPEG camera. Each
+ * iteration puts the frame on a raw source and grabs it from a raw sink.
+ * Arguments are the size divisor and whether to convert to grayscale.
+ */
+inline void BM_CameraServer_MjpegDownscale(benchmark::State& state) {
+  int divisor = state.range(0);
+  bool gray = state.range(1) != 0;
+  constexpr int kWidth = 1280;
+  constexpr int kHeight = 720;
+
+  auto jpeg = MakeCameraServerBenchJpeg(kWidth, kHeight);
+  wpi::cs::RawSource source{"benchsource", wpi::util::PixelFormat::MJPEG,
+                            kWidth, kHeight, 30};
+  wpi::cs::RawSink sink{"benchsink"};
+  sink.SetSource(source);
+
+  // the source copies the frame, so it doesn't need to own the data
+  WPI_RawFrame in{};
+  in.data = jpeg.data();
+  in.size = jpeg.size();
+  in.width = kWidth;
+  in.height = kHeight;
+  in.pixelFormat = WPI_PIXFMT_MJPEG;
+  wpi::util::RawFrame out;
+  CS_Status status = 0;
+  // any time other than the current frame's
+  uint64_t lastTime = 1;
+
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    wpi::cs::PutSourceFrame(source.GetHandle(), in, &status);
+    out.width = kWidth / divisor;
+    out.height = kHeight / divisor;
+    out.pixelFormat = gray ? WPI_PIXFMT_GRAY : WPI_PIXFMT_BGR;
+    lastTime = wpi::cs::GrabSinkFrameTimeoutLastTime(sink.GetHandle(), out,
+                                                     1.0, lastTime, &status);
+    if (lastTime == 0) {
+      state.SkipWithError("timed out waiting for frame");
+      break;
+    }
+  }
+}
+
+/**
+ * Makes a frame of the given format for a raw source. JPEGs are made with
+ * MakeCameraServerBenchJpeg(); other formats are filled with noise.
+ */
+inline std::vector<uchar> MakeCameraServerBenchImage(
+    wpi::util::PixelFormat pixelFormat, int width, int height) {
+  int bytesPerPixel = 0;
+  switch (pixelFormat) {
+    case wpi::util::PixelFormat::MJPEG:
+      return MakeCameraServerBenchJpeg(width, height);
+    case wpi::util::PixelFormat::GRAY:
+      bytesPerPixel = 1;
+      break;
+    case wpi::util::PixelFormat::BGR:
+      bytesPerPixel = 3;
+      break;
+    case wpi::util::PixelFormat::BGRA:
+      bytesPerPixel = 4;
+      break;
+    default:
+      bytesPerPixel = 2;
+      break;
+  }
+  std::vector<uchar> data(width * height * bytesPerPixel);
+  uint32_t noise = 1;
+  for (auto&& byte : data) {
+    noise = noise * 1103515245 + 12345;
+    byte = noise >> 24;
+  }
+  return data;
+}
+
+/**
+ * Puts a 640x480 frame of each pixel format on a raw source and grabs it from
+ * raw sinks in other pixel formats. Each iteration puts one frame and grabs it
+ * from every sink. Arguments are the source format and up to four sink
+ * formats (UNKNOWN for none).
+ */
+inline void BM_CameraServer_FrameConvert(benchmark::State& state) {
+  constexpr int kWidth = 640;
+  constexpr int kHeight = 480;
+  auto pixelFormat = static_cast<wpi::util::PixelFormat>(state.range(0));
+
+  auto data = MakeCameraServerBenchImage(pixelFormat, kWidth, kHeight);
+  wpi::cs::RawSource source{"benchsource", pixelFormat, kWidth, kHeight, 30};
+  struct Sink {
+    wpi::cs::RawSink sink;
+    WPI_PixelFormat pixelFormat;
+    wpi::util::RawFrame frame;
+  };
+  std::vector<std::unique_ptr<Sink>> sinks;
+  for (size_t i = 1; i < state.range_size(); ++i) {
+    if (state.range(i) != WPI_PIXFMT_UNKNOWN) {
+      sinks.emplace_back(new Sink{
+          wpi::cs::RawSink{std::format("benchsink{}", i)},
+          static_cast<WPI_PixelFormat>(state.range(i)), {}});
+      sinks.back()->sink.SetSource(source);
+    }
+  }
+
+  // the source copies the frame, so it doesn't need to own the data
+  WPI_RawFrame in{};
+  in.data = data.data();
+  in.size = data.size();
+  in.width = kWidth;
+  in.height = kHeight;
+  in.pixelFormat = static_cast<WPI_PixelFormat>(pixelFormat);
+  CS_Status status = 0;
+  // any time other than the current frame's
+  uint64_t lastTime = 1;
+
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    wpi::cs::PutSourceFrame(source.GetHandle(), in, &status);
+    uint64_t time = 0;
+    for (auto&& sink : sinks) {
+      sink->frame.width = kWidth;
+      sink->frame.height = kHeight;
+      sink->frame.pixelFormat = sink->pixelFormat;
+      time = wpi::cs::GrabSinkFrameTimeoutLastTime(
+          sink->sink.GetHandle(), sink->frame, 1.0, lastTime, &status);
+      if (time == 0) {
+        state.SkipWithError("timed out waiting for frame");
+        return;
+      }
+    }
+    lastTime = time;
+  }
+}
+
+/**
+ * Passes 640x480 BGR frames from a raw source to a raw sink through a
+ * publishing sink and a receiving source, as when a vision process gets
+ * frames from a separate camera process. Each iteration puts one frame and
+ * waits for it to arrive, so the time is the end-to-end latency. The
+ * process_cpu counter is the CPU time used by all threads per frame.
+ * Argument is the transport: 0 for a MJPEG server streaming to a HTTP camera
+ * over loopback, 1 for shared memory.
+ */
+inline void BM_CameraServer_FrameTransport(benchmark::State& state) {
+  bool sharedMemory = state.range(0) != 0;
+  constexpr int kWidth = 640;
+  constexpr int kHeight = 480;
+  constexpr int kPort = kCameraServerBenchPort + 1;
+
+  cv::Mat image = MakeCameraServerBenchMat(kWidth, kHeight);
+  wpi::cs::RawSource source{"benchsource", wpi::util::PixelFormat::BGR, kWidth,
+                            kHeight, 30};
+  wpi::cs::VideoSink publisher;
+  wpi::cs::VideoSource receiver;
+  if (sharedMemory) {
+    publisher = wpi::cs::SharedMemorySink{"benchpublisher", "cscore_bench"};
+    receiver = wpi::cs::SharedMemorySource{"benchreceiver", "cscore_bench"};
+  } else {
+    publisher = wpi::cs::MjpegServer{"benchpublisher", "127.0.0.1", kPort};
+    receiver = wpi::cs::HttpCamera{
+        "benchreceiver", std::format("http://127.0.0.1:{}/stream.mjpg", kPort)};
+  }
+  publisher.SetSource(source);
+  wpi::cs::RawSink sink{"benchsink"};
+  sink.SetSource(receiver);
+
+  // the source copies the frame, so it doesn't need to own the data
+  WPI_RawFrame in{};
+  in.data = image.data;
+  in.size = image.total() * image.elemSize();
+  in.width = kWidth;
+  in.height = kHeight;
+  in.pixelFormat = WPI_PIXFMT_BGR;
+  wpi::util::RawFrame out;
+  CS_Status status = 0;
+  auto putAndGrab = [&](uint64_t lastTime, double timeout) {
+    wpi::cs::PutSourceFrame(source.GetHandle(), in, &status);
+    out.width = kWidth;
+    out.height = kHeight;
+    out.pixelFormat = WPI_PIXFMT_BGR;
+    return wpi::cs::GrabSinkFrameTimeoutLastTime(sink.GetHandle(), out,
+                                                 timeout, lastTime, &status);
+  };
+
+  // wait for the receiver to connect; frames put before then are lost
+  uint64_t lastTime = 1;
+  for (int i = 0; i < 50; ++i) {
+    uint64_t time = putAndGrab(lastTime, 0.1);
+    if (time != 0) {
+      lastTime = time;
+      break;
+    }
+  }
+  if (lastTime == 1) {
+    state.SkipWithError("receiver did not connect");
+    return;
+  }
+
+  std::clock_t startCpu = std::clock();
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    lastTime = putAndGrab(lastTime, 1.0);
+    if (lastTime == 0) {
+      state.SkipWithError("timed out waiting for frame");
+      return;
+    }
+  }
+  state.counters["process_cpu"] = benchmark::Counter(
+      static_cast<double>(std::clock() - startCpu) / CLOCKS_PER_SEC,
+      benchmark::Counter::kAvgIterations);
+}
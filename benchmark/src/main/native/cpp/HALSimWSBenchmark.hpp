@@ -0,0 +1,106 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <format>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "wpi/halsim/ws_core/WSMessageBatcher.hpp"
+#include "wpi/util/json.hpp"
+#include "wpi/util/raw_ostream.hpp"
+
+inline wpi::util::json MakeHALSimWSMessage(std::string_view type,
+                                           std::string_view device,
+                                           wpi::util::json data) {
+  return wpi::util::json::object("type", type, "device", device, "data",
+                                 std::move(data));
+}
+
+/**
+ * One sim tick of 20 PWM, 10 DIO and 8 encoder channels, each updated
+ * through several HAL callbacks.
+ */
+inline std::vector<wpi::util::json> MakeHALSimWSTick() {
+  std::vector<wpi::util::json> tick;
+  for (int i = 0; i < 20; ++i) {
+    auto device = std::format("{}", i);
+    tick.emplace_back(MakeHALSimWSMessage(
+        "PWM", device, wpi::util::json::object("<raw", 1000 + i)));
+    tick.emplace_back(MakeHALSimWSMessage(
+        "PWM", device, wpi::util::json::object("<output_period", 5)));
+  }
+  for (int i = 0; i < 10; ++i) {
+    tick.emplace_back(
+        MakeHALSimWSMessage("DIO", std::format("{}", i),
+                            wpi::util::json::object("<>value", i % 2 == 0)));
+  }
+  for (int i = 0; i < 8; ++i) {
+    auto device = std::format("{}", i);
+    for (int j = 0; j < 3; ++j) {
+      tick.emplace_back(MakeHALSimWSMessage(
+          "Encoder", device, wpi::util::json::object(">count", j)));
+      tick.emplace_back(MakeHALSimWSMessage(
+          "Encoder", device, wpi::util::json::object(">period", 0.01 * j)));
+    }
+  }
+  return tick;
+}
+
+/** Encoding one tick as one JSON text frame per HAL callback. */
+inline void BM_HALSimWS_PerCallbackJson(benchmark::State& state) {
+  auto tick = MakeHALSimWSTick();
+  std::string out;
+  size_t frames = 0;
+  size_t bytes = 0;
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    for (auto&& msg : tick) {
+      out.clear();
+      wpi::util::raw_string_ostream os{out};
+      os << msg;
+      os.flush();
+      ++frames;
+      bytes += out.size();
+    }
+  }
+  state.counters["frames"] =
+      benchmark::Counter(frames, benchmark::Counter::kAvgIterations);
+  state.counters["bytes"] =
+      benchmark::Counter(bytes, benchmark::Counter::kAvgIterations);
+}
+
+/** Batching and flushing one tick as a single frame. */
+inline void BM_HALSimWS_Batched(benchmark::State& state) {
+  auto format = static_cast<wpilibws::HALSimWSMessageBatcher::Format>(
+      state.range(0));
+  auto tick = MakeHALSimWSTick();
+  wpilibws::HALSimWSMessageBatcher batcher;
+  std::vector<uint8_t> out;
+  size_t frames = 0;
+  size_t bytes = 0;
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    for (auto&& msg : tick) {
+      batcher.Add(msg);
+    }
+    out.clear();
+    wpi::util::raw_uvector_ostream os{out};
+    if (batcher.Flush(os, format)) {
+      ++frames;
+      bytes += out.size();
+    }
+  }
+  state.counters["frames"] =
+      benchmark::Counter(frames, benchmark::Counter::kAvgIterations);
+  state.counters["bytes"] =
+      benchmark::Counter(bytes, benchmark::Counter::kAvgIterations);
+}
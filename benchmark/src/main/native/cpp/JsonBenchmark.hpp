@@ -0,0 +1,79 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <benchmark/benchmark.h>
+
+#include "wpi/util/json.hpp"
+
+/** A single NT4 text frame announcing the given number of topics. */
+inline std::string MakeJsonAnnounceFrame(int count) {
+  std::string msg = "[";
+  for (int i = 0; i < count; ++i) {
+    if (i != 0) {
+      msg += ',';
+    }
+    msg += "{\"method\":\"announce\",\"params\":{\"id\":";
+    msg += std::to_string(i);
+    msg += ",\"name\":\"/SmartDashboard/Subsystem";
+    msg += std::to_string(i / 10);
+    msg += "/Value";
+    msg += std::to_string(i % 10);
+    msg += "\",\"properties\":{\"persistent\":false},\"pubuid\":";
+    msg += std::to_string(i);
+    msg += ",\"type\":\"double\"}}";
+  }
+  msg += ']';
+  return msg;
+}
+
+/** Parses an announce frame into a DOM and walks it. Argument is topics. */
+inline void BM_Json_ParseAnnounce(benchmark::State& state) {
+  auto msg = MakeJsonAnnounceFrame(state.range(0));
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    auto j = wpi::util::json::parse(msg);
+    size_t total = 0;
+    for (auto&& elem : j->get_array()) {
+      auto& params = elem["params"];
+      total += params["name"].get_string().size();
+      total += params["id"].get_int();
+    }
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetBytesProcessed(state.iterations() * msg.size());
+}
+
+/** Reads an announce frame with json_reader. Argument is topics. */
+inline void BM_Json_ReadAnnounce(benchmark::State& state) {
+  using enum wpi::util::json_reader::Event;
+  auto msg = MakeJsonAnnounceFrame(state.range(0));
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    wpi::util::json_reader reader{msg};
+    size_t total = 0;
+    // string() is only valid until the next event, so remember the key kind
+    enum { kOther, kName, kId } key = kOther;
+    for (auto event = reader.next(); event != End && event != Error;
+         event = reader.next()) {
+      if (event == Key) {
+        std::string_view str = reader.string();
+        key = str == "name" ? kName : str == "id" ? kId : kOther;
+        if (str == "properties") {
+          reader.skip_value();
+        }
+      } else if (event == String && key == kName) {
+        total += reader.string().size();
+      } else if (event == Value && key == kId) {
+        total += reader.value().get_int();
+      }
+    }
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetBytesProcessed(state.iterations() * msg.size());
+}
@@ -4,11 +4,176 @@
 
 #include <benchmark/benchmark.h>
 
+#include "AprilTagBenchmark.hpp"
+#include "CameraServerBenchmark.hpp"
 #include "CartPoleBenchmark.hpp"
+#include "HALSimWSBenchmark.hpp"
+#include "JsonBenchmark.hpp"
+#include "NetworkTablesBenchmark.hpp"
+#include "ProfilerBenchmark.hpp"
+#include "SimulationBenchmark.hpp"
+#include "SynchronizationBenchmark.hpp"
+#include "TelemetryBenchmark.hpp"
 #include "TravelingSalesmanBenchmark.hpp"
+#include "WebSocketBenchmark.hpp"
 
+// Argument is the image_u8_simd_level_t; unsupported levels are skipped
+static void AprilTagSimdLevels(benchmark::Benchmark* b) {
+  b->Arg(IMAGE_U8_SIMD_SCALAR)
+      ->Arg(IMAGE_U8_SIMD_SSE2)
+      ->Arg(IMAGE_U8_SIMD_AVX2)
+      ->Arg(IMAGE_U8_SIMD_NEON);
+}
+
+BENCHMARK(BM_AprilTag_Decimate)->Apply(AprilTagSimdLevels);
+BENCHMARK(BM_AprilTag_TileMinMax)->Apply(AprilTagSimdLevels);
+BENCHMARK(BM_AprilTag_TileBlur)->Apply(AprilTagSimdLevels);
+BENCHMARK(BM_AprilTag_TileThreshold)->Apply(AprilTagSimdLevels);
+BENCHMARK(BM_AprilTag_Detect)
+    ->Apply(AprilTagSimdLevels)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_AprilTag_DetectSequence)
+    ->ArgName("tracking")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_AprilTag_PoseEstimatePerTag)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_AprilTag_PoseEstimateMultiTag)->Unit(benchmark::kMicrosecond);
+// Argument is the number of cameras
+BENCHMARK(BM_CameraServer_HttpCameraStreams)
+    ->ArgName("cameras")
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->UseRealTime();
+// Arguments are the size divisor and whether to convert to grayscale
+BENCHMARK(BM_CameraServer_MjpegDownscale)
+    ->ArgNames({"divisor", "gray"})
+    ->ArgsProduct({{1, 2, 4, 8}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+// Arguments are the source and sink pixel formats
+BENCHMARK(BM_CameraServer_FrameConvert)
+    ->ArgNames({"from", "to"})
+    ->ArgsProduct({{WPI_PIXFMT_MJPEG, WPI_PIXFMT_YUYV, WPI_PIXFMT_UYVY,
+                    WPI_PIXFMT_RGB565, WPI_PIXFMT_BGR, WPI_PIXFMT_GRAY,
+                    WPI_PIXFMT_Y16},
+                   {WPI_PIXFMT_BGR, WPI_PIXFMT_GRAY, WPI_PIXFMT_RGB565,
+                    WPI_PIXFMT_Y16, WPI_PIXFMT_BGRA}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+// Several sinks sharing one frame
+BENCHMARK(BM_CameraServer_FrameConvert)
+    ->Name("BM_CameraServer_FrameConvertSinks")
+    ->ArgNames({"from", "to", "to", "to", "to"})
+    ->Args({WPI_PIXFMT_YUYV, WPI_PIXFMT_GRAY, WPI_PIXFMT_Y16, WPI_PIXFMT_BGR,
+            WPI_PIXFMT_RGB565})
+    ->Args({WPI_PIXFMT_MJPEG, WPI_PIXFMT_GRAY, WPI_PIXFMT_Y16, WPI_PIXFMT_BGR,
+            WPI_PIXFMT_BGRA})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+// Argument is whether to use shared memory instead of MJPEG over loopback
+BENCHMARK(BM_CameraServer_FrameTransport)
+    ->ArgName("shm")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
 BENCHMARK(BM_CartPole);
+BENCHMARK(BM_HALSimWS_PerCallbackJson)->Unit(benchmark::kMicrosecond);
+// Argument is the batch format: 0 is JSON, 1 is MessagePack
+BENCHMARK(BM_HALSimWS_Batched)
+    ->ArgName("format")
+    ->Arg(wpilibws::HALSimWSMessageBatcher::kJson)
+    ->Arg(wpilibws::HALSimWSMessageBatcher::kMsgPack)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Json_ParseAnnounce)
+    ->RangeMultiplier(8)
+    ->Range(8, 4096)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Json_ReadAnnounce)
+    ->RangeMultiplier(8)
+    ->Range(8, 4096)
+    ->Unit(benchmark::kMicrosecond);
+// Arguments are the number of server I/O threads and the number of clients
+// (each client is an instance, and a process can have at most 16 instances)
+BENCHMARK(BM_NetworkTables_EchoRoundTrip)
+    ->ArgNames({"ioThreads", "clients"})
+    ->ArgsProduct({{0, 1, 2, 4}, {1, 4, 12}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+// Argument is 0 for server to client and 1 for client to server
+BENCHMARK(BM_NetworkTables_SetLatency)
+    ->ArgName("fromClient")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+// Arguments are the number of persistent topics and whether to use the journal
+BENCHMARK(BM_NetworkTables_PersistentLoad)
+    ->ArgNames({"topics", "journal"})
+    ->ArgsProduct({{100, 1000, 10000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_NetworkTables_PersistentSave)
+    ->ArgNames({"topics", "journal"})
+    ->ArgsProduct({{100, 1000, 10000}, {0, 1}})
+    ->Iterations(5)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+// Argument is the number of listeners on the same subscriber
+BENCHMARK(BM_NetworkTables_ValueListener)
+    ->ArgName("listeners")
+    ->Arg(1)
+    ->Arg(8)
+    ->Arg(64)
+    ->UseRealTime();
+// Argument is whether the profiler is enabled
+BENCHMARK(BM_Profiler_Zone)->ArgName("enabled")->Arg(0)->Arg(1);
+// Argument is the number of subsystem zones per loop
+BENCHMARK(BM_Profiler_Loop)->RangeMultiplier(4)->Range(4, 64);
+BENCHMARK(BM_Profiler_TracerEpoch);
+BENCHMARK(BM_Simulation_CanSendContention)
+    ->ArgName("churn")
+    ->Arg(0)
+    ->Arg(1)
+    ->ThreadRange(1, 8)
+    ->UseRealTime()
+    ->Setup(SimulationCanSendSetup)
+    ->Teardown(SimulationCanSendTeardown);
+BENCHMARK(BM_Simulation_StepMatch)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_Simulation_SwarmUpdate)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_Simulation_SwarmBatchUpdate)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_Synchronization_SetWait)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(BM_Synchronization_PingPong)->UseRealTime();
+// Argument selects the backend: 0 is NetworkTables, 1 is DataLog
+BENCHMARK(BM_Telemetry_LogDouble)->ArgName("backend")->Arg(0)->Arg(1);
+BENCHMARK(BM_Telemetry_HandleLogDouble)->ArgName("backend")->Arg(0)->Arg(1);
+BENCHMARK(BM_Telemetry_LogStruct)->ArgName("backend")->Arg(0)->Arg(1);
+BENCHMARK(BM_Telemetry_HandleLogStruct)->ArgName("backend")->Arg(0)->Arg(1);
+BENCHMARK(BM_Telemetry_AsyncHandleLogDouble)
+    ->ArgName("backend")
+    ->Arg(0)
+    ->Arg(1);
+BENCHMARK(BM_Telemetry_AsyncHandleLogStruct)
+    ->ArgName("backend")
+    ->Arg(0)
+    ->Arg(1);
 BENCHMARK(BM_TravelingSalesman_Transform);
 BENCHMARK(BM_TravelingSalesman_Twist);
+// 16 B to 1 MB frames
+BENCHMARK(BM_WebSocket_MaskBytewise)->RangeMultiplier(4)->Range(16, 1 << 20);
+BENCHMARK(BM_WebSocket_MaskCopy)->RangeMultiplier(4)->Range(16, 1 << 20);
+BENCHMARK(BM_WebSocket_MaskCopyUnaligned)
+    ->RangeMultiplier(4)
+    ->Range(16, 1 << 20);
+BENCHMARK(BM_WebSocket_DeflateAnnounce)
+    ->ArgName("context")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_WebSocket_InflateAnnounce)->Unit(benchmark::kMicrosecond);
 
 BENCHMARK_MAIN();
@@ -0,0 +1,391 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "wpi/nt/IntegerTopic.hpp"
+#include "wpi/nt/NetworkTableInstance.hpp"
+#include "wpi/nt/NetworkTableListener.hpp"
+#include "wpi/util/Synchronization.hpp"
+
+inline constexpr unsigned int kNetworkTablesBenchPort = 10200;
+
+/**
+ * Round trips between a server and many clients over loopback. Each iteration
+ * the server sets a value and every client echoes it back on its own topic;
+ * the iteration ends when the server has received every echo, so the real
+ * time per iteration is the latency to reach the slowest client and back.
+ * Arguments are the number of server I/O threads (0 handles clients on the
+ * server storage thread) and the number of clients.
+ */
+inline void BM_NetworkTables_EchoRoundTrip(benchmark::State& state) {
+  unsigned int ioThreads = state.range(0);
+  int numClients = state.range(1);
+  constexpr wpi::nt::PubSubOptions kOptions{.periodic = 0.005,
+                                            .sendAll = true};
+
+  auto server = wpi::nt::NetworkTableInstance::Create();
+  auto persistFile =
+      std::filesystem::temp_directory_path() / "nt_benchmark.json";
+  server.StartServer(persistFile.string(), "127.0.0.1", "",
+                     kNetworkTablesBenchPort, ioThreads);
+  auto ping = server.GetIntegerTopic("/bench/ping").Publish(kOptions);
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  int64_t expected = -1;
+  int received = 0;
+  std::string_view prefixes[] = {"/bench/pong"};
+  server.AddListener(
+      prefixes, NT_EVENT_VALUE_REMOTE, [&](const wpi::nt::Event& event) {
+        auto data = event.GetValueEventData();
+        if (!data || !data->value.IsInteger()) {
+          return;
+        }
+        std::scoped_lock lock{mutex};
+        if (data->value.GetInteger() == expected && ++received == numClients) {
+          cond.notify_one();
+        }
+      });
+
+  struct Client {
+    wpi::nt::NetworkTableInstance inst;
+    wpi::nt::IntegerSubscriber sub;
+    wpi::nt::IntegerPublisher pub;
+  };
+  std::vector<Client> clients(numClients);
+  for (int i = 0; i < numClients; ++i) {
+    auto& client = clients[i];
+    client.inst = wpi::nt::NetworkTableInstance::Create();
+    client.sub =
+        client.inst.GetIntegerTopic("/bench/ping").Subscribe(0, kOptions);
+    client.pub = client.inst.GetIntegerTopic(std::format("/bench/pong{}", i))
+                     .Publish(kOptions);
+    client.inst.AddListener(client.sub, NT_EVENT_VALUE_REMOTE,
+                            [&client](const wpi::nt::Event& event) {
+                              if (auto data = event.GetValueEventData()) {
+                                client.pub.Set(data->value.GetInteger());
+                                client.inst.Flush();
+                              }
+                            });
+    client.inst.StartClient(std::format("bench{}", i));
+    client.inst.SetServer("127.0.0.1", kNetworkTablesBenchPort);
+  }
+
+  auto roundTrip = [&](int64_t value, std::chrono::milliseconds timeout) {
+    std::unique_lock lock{mutex};
+    expected = value;
+    received = 0;
+    lock.unlock();
+    ping.Set(value);
+    server.Flush();
+    lock.lock();
+    return cond.wait_for(lock, timeout, [&] { return received == numClients; });
+  };
+
+  // wait for every client to connect and subscribe
+  bool connected = false;
+  for (int64_t i = 1; i <= 50 && !connected; ++i) {
+    connected = roundTrip(-i, std::chrono::milliseconds{100});
+  }
+  if (!connected) {
+    state.SkipWithError("clients did not connect");
+  } else {
+    int64_t value = 0;
+    int timeouts = 0;
+    // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+    for (auto _ : state) {
+      if (!roundTrip(value++, std::chrono::milliseconds{1000})) {
+        ++timeouts;
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * numClients);
+    state.counters["timeouts"] = timeouts;
+  }
+
+  for (auto&& client : clients) {
+    wpi::nt::NetworkTableInstance::Destroy(client.inst);
+  }
+  wpi::nt::NetworkTableInstance::Destroy(server);
+}
+
+/**
+ * Latency of a value set without an explicit flush to reach the other side of
+ * a loopback connection. Each iteration sets a value and waits for the
+ * receiving instance to be notified of it. The argument selects the direction:
+ * 0 publishes on the server and receives on a client, 1 publishes on a client
+ * and receives on the server.
+ */
+inline void BM_NetworkTables_SetLatency(benchmark::State& state) {
+  bool fromClient = state.range(0) != 0;
+  constexpr wpi::nt::PubSubOptions kOptions{.periodic = 0.005};
+
+  auto server = wpi::nt::NetworkTableInstance::Create();
+  auto persistFile =
+      std::filesystem::temp_directory_path() / "nt_benchmark.json";
+  server.StartServer(persistFile.string(), "127.0.0.1", "",
+                     kNetworkTablesBenchPort);
+  auto client = wpi::nt::NetworkTableInstance::Create();
+  auto& sender = fromClient ? client : server;
+  auto& receiver = fromClient ? server : client;
+
+  auto pub = sender.GetIntegerTopic("/bench/value").Publish(kOptions);
+  auto sub = receiver.GetIntegerTopic("/bench/value").Subscribe(-1, kOptions);
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  int64_t received = -1;
+  receiver.AddListener(sub, NT_EVENT_VALUE_REMOTE,
+                       [&](const wpi::nt::Event& event) {
+                         if (auto data = event.GetValueEventData()) {
+                           std::scoped_lock lock{mutex};
+                           received = data->value.GetInteger();
+                           cond.notify_one();
+                         }
+                       });
+  client.StartClient("bench");
+  client.SetServer("127.0.0.1", kNetworkTablesBenchPort);
+
+  auto set = [&](int64_t value, std::chrono::milliseconds timeout) {
+    pub.Set(value);
+    std::unique_lock lock{mutex};
+    return cond.wait_for(lock, timeout, [&] { return received == value; });
+  };
+
+  // wait for the client to connect and subscribe
+  bool connected = false;
+  for (int64_t i = 1; i <= 50 && !connected; ++i) {
+    connected = set(-i - 1, std::chrono::milliseconds{100});
+  }
+  if (!connected) {
+    state.SkipWithError("client did not connect");
+  } else {
+    int64_t value = 0;
+    int timeouts = 0;
+    // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+    for (auto _ : state) {
+      if (!set(value++, std::chrono::milliseconds{1000})) {
+        ++timeouts;
+      }
+    }
+    state.counters["timeouts"] = timeouts;
+  }
+
+  wpi::nt::NetworkTableInstance::Destroy(client);
+  wpi::nt::NetworkTableInstance::Destroy(server);
+}
+
+/**
+ * Temporary persistent file with a number of persistent integer topics named
+ * /bench/persist/0 and up. If journal is true, a server is run once in journal
+ * mode to update a tenth of the values so a journal is left to replay.
+ */
+class NetworkTablesPersistentFile {
+ public:
+  NetworkTablesPersistentFile(int numTopics, bool journal)
+      : m_dir{std::filesystem::temp_directory_path() /
+              std::format("nt_benchmark_persist_{}", numTopics)},
+        m_numTopics{numTopics},
+        m_journal{journal} {
+    std::filesystem::create_directories(m_dir);
+    m_filename = (m_dir / "networktables.json").string();
+    std::error_code ec;
+    std::filesystem::remove(m_filename + ".journal", ec);
+    {
+      std::ofstream os{m_filename};
+      os << "[\n";
+      for (int i = 0; i < numTopics; ++i) {
+        os << std::format(
+            "  {{\"name\": \"/bench/persist/{}\", \"type\": \"int\", "
+            "\"value\": {}, \"properties\": {{\"persistent\": true}}}}{}\n",
+            i, i, i + 1 == numTopics ? "" : ",");
+      }
+      os << "]\n";
+    }
+    if (journal) {
+      auto inst = StartServer();
+      std::vector<wpi::nt::IntegerPublisher> pubs;
+      for (int i = 0; i < numTopics; i += 10) {
+        pubs.emplace_back(
+            inst.GetIntegerTopic(std::format("/bench/persist/{}", i))
+                .Publish());
+        pubs.back().Set(-i);
+      }
+      auto size = JournalSize();
+      for (int i = 0; i < 50 && JournalSize() == size; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+      }
+      pubs.clear();
+      wpi::nt::NetworkTableInstance::Destroy(inst);
+    }
+  }
+
+  ~NetworkTablesPersistentFile() {
+    std::error_code ec;
+    std::filesystem::remove_all(m_dir, ec);
+  }
+
+  /**
+   * Starts a server (without a listening port) and waits until the persistent
+   * values are loaded.
+   */
+  wpi::nt::NetworkTableInstance StartServer() {
+    auto inst = wpi::nt::NetworkTableInstance::Create();
+    auto sub = inst.GetIntegerTopic(
+                       std::format("/bench/persist/{}", m_numTopics - 1))
+                   .Subscribe(-1);
+    wpi::nt::NetworkTableListenerPoller poller{inst};
+    poller.AddListener(sub, NT_EVENT_VALUE_ALL);
+    inst.StartServer(m_filename, "", "", 0, 0, m_journal);
+    bool timedOut = false;
+    wpi::util::WaitForObject(poller.GetHandle(), 10, &timedOut);
+    return inst;
+  }
+
+  /**
+   * Returns a value that changes when the server saves persistent values.
+   */
+  std::pair<std::filesystem::file_time_type, uintmax_t> SaveStamp() const {
+    std::error_code ec;
+    return {std::filesystem::last_write_time(m_filename, ec), JournalSize()};
+  }
+
+  /**
+   * Returns the number of bytes written by a save between two stamps.
+   */
+  uintmax_t BytesWritten(
+      const std::pair<std::filesystem::file_time_type, uintmax_t>& before,
+      const std::pair<std::filesystem::file_time_type, uintmax_t>& after)
+      const {
+    uintmax_t bytes = 0;
+    if (after.first != before.first) {
+      std::error_code ec;
+      bytes += std::filesystem::file_size(m_filename, ec);
+    }
+    if (after.second > before.second) {
+      bytes += after.second - before.second;
+    } else if (after.second != before.second) {
+      bytes += after.second;  // restarted after compaction
+    }
+    return bytes;
+  }
+
+ private:
+  uintmax_t JournalSize() const {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(m_filename + ".journal", ec);
+    return ec ? 0 : size;
+  }
+
+  std::filesystem::path m_dir;
+  std::string m_filename;
+  int m_numTopics;
+  bool m_journal;
+};
+
+/**
+ * Server startup time until persistent values are loaded. Arguments are the
+ * number of persistent topics and whether journal mode is used (which also
+ * replays a journal updating a tenth of the values).
+ */
+inline void BM_NetworkTables_PersistentLoad(benchmark::State& state) {
+  NetworkTablesPersistentFile file{static_cast<int>(state.range(0)),
+                                   state.range(1) != 0};
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    auto inst = file.StartServer();
+    state.PauseTiming();
+    wpi::nt::NetworkTableInstance::Destroy(inst);
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/**
+ * Bytes written to flash per save after changing one persistent value, with
+ * the same arguments as BM_NetworkTables_PersistentLoad. Saves happen once a
+ * second, so the real time is not meaningful; compare the bytesPerSave
+ * counter.
+ */
+inline void BM_NetworkTables_PersistentSave(benchmark::State& state) {
+  NetworkTablesPersistentFile file{static_cast<int>(state.range(0)),
+                                   state.range(1) != 0};
+  auto inst = file.StartServer();
+  auto pub = inst.GetIntegerTopic("/bench/persist/0").Publish();
+  int64_t value = 0;
+  uintmax_t bytes = 0;
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    auto before = file.SaveStamp();
+    pub.Set(++value);
+    auto after = before;
+    for (int i = 0; i < 100 && after == before; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds{20});
+      after = file.SaveStamp();
+    }
+    bytes += file.BytesWritten(before, after);
+  }
+  state.counters["bytesPerSave"] = benchmark::Counter(
+      bytes, benchmark::Counter::kAvgIterations);
+  pub = {};
+  wpi::nt::NetworkTableInstance::Destroy(inst);
+}
+
+/**
+ * Throughput of value events delivered to callback listeners on a local
+ * instance. Each iteration sets a value, which is delivered to every listener;
+ * the listener thread is drained before timing ends. The argument is the
+ * number of listeners, and items processed is the number of callbacks made.
+ */
+inline void BM_NetworkTables_ValueListener(benchmark::State& state) {
+  auto inst = wpi::nt::NetworkTableInstance::Create();
+  auto topic = inst.GetIntegerTopic("/bench/value");
+  auto pub = topic.Publish();
+  auto sub = topic.Subscribe(0);
+
+  std::atomic<int64_t> received{0};
+  std::vector<wpi::nt::NetworkTableListener> listeners;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    listeners.emplace_back(wpi::nt::NetworkTableListener::CreateListener(
+        sub, NT_EVENT_VALUE_ALL, [&](const wpi::nt::Event&) {
+          received.fetch_add(1, std::memory_order_relaxed);
+        }));
+  }
+
+  int64_t value = 0;
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    pub.Set(++value);
+  }
+  inst.WaitForListenerQueue(10);
+
+  int64_t expected = state.iterations() * state.range(0);
+  if (received != expected) {
+    state.SkipWithError(
+        std::format("received {} of {} events", received.load(), expected));
+  }
+  state.SetItemsProcessed(received);
+
+  listeners.clear();
+  sub = {};
+  pub = {};
+  wpi::nt::NetworkTableInstance::Destroy(inst);
+}
@@ -0,0 +1,69 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "wpi/system/Profiler.hpp"
+#include "wpi/system/Tracer.hpp"
+
+/**
+ * Entering and exiting one zone, with the profiler disabled (0) or enabled
+ * (1). The loop is ended every 64 zones.
+ */
+inline void BM_Profiler_Zone(benchmark::State& state) {
+  wpi::Profiler::SetEnabled(state.range(0) != 0);
+  int count = 0;
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    {
+      wpi::Profiler::Zone zone{"BM_Profiler_Zone"};
+    }
+    if (++count % 64 == 0) {
+      wpi::Profiler::EndLoop();
+    }
+  }
+  wpi::Profiler::EndLoop();
+  wpi::Profiler::SetEnabled(false);
+  state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * One loop of a robot program with the given number of zones nested two
+ * deep, as with CommandScheduler subsystems and commands.
+ */
+inline void BM_Profiler_Loop(benchmark::State& state) {
+  std::vector<std::string> names;
+  for (int i = 0; i < state.range(0); ++i) {
+    names.emplace_back("Subsystem" + std::to_string(i) + ".Periodic()");
+  }
+  wpi::Profiler::SetEnabled(true);
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    {
+      wpi::Profiler::Zone loopZone{"LoopFunc()"};
+      wpi::Profiler::Zone runZone{"CommandScheduler::Run()"};
+      for (auto&& name : names) {
+        wpi::Profiler::Zone zone{name};
+      }
+    }
+    wpi::Profiler::EndLoop();
+  }
+  wpi::Profiler::SetEnabled(false);
+  state.SetItemsProcessed(state.iterations() * (names.size() + 2));
+}
+
+/** Adding one Tracer epoch, for comparison with BM_Profiler_Zone. */
+inline void BM_Profiler_TracerEpoch(benchmark::State& state) {
+  wpi::Tracer tracer;
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    tracer.AddEpoch("BM_Profiler_TracerEpoch");
+  }
+  state.SetItemsProcessed(state.iterations());
+}
@@ -0,0 +1,160 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "wpi/hal/CAN.h"
+#include "wpi/hal/HAL.h"
+#include "wpi/hal/Notifier.h"
+#include "wpi/hal/simulation/CanData.h"
+#include "wpi/hal/simulation/MockHooks.h"
+#include "wpi/math/system/Models.hpp"
+#include "wpi/simulation/DCMotorSim.hpp"
+#include "wpi/simulation/LinearSystemSimBatch.hpp"
+#include "wpi/util/Synchronization.hpp"
+
+/**
+ * Steps a simulated 150 s match with a 20 ms periodic notifier whose handler
+ * acknowledges each alarm the way TimedRobot does. The sim_s_per_s counter is
+ * simulated seconds per wall clock second.
+ */
+inline void BM_Simulation_StepMatch(benchmark::State& state) {
+  constexpr uint64_t kPeriod = 20000;
+  constexpr uint64_t kMatchLength = 150000000;
+
+  HAL_Initialize();
+  if (HAL_GetRuntimeType() != HAL_RUNTIME_SIMULATION) {
+    state.SkipWithError("requires the simulation HAL");
+    return;
+  }
+  HALSIM_PauseTiming();
+
+  int32_t status = 0;
+  HAL_NotifierHandle notifier = HAL_CreateNotifier(&status);
+  HAL_SetNotifierAlarm(notifier, kPeriod, kPeriod, false, false, &status);
+  int64_t loops = 0;
+  std::thread handler{[&] {
+    while (wpi::util::WaitForObject(notifier)) {
+      ++loops;
+      int32_t ackStatus = 0;
+      HAL_AcknowledgeNotifierAlarm(notifier, &ackStatus);
+    }
+  }};
+
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    HALSIM_StepTiming(kMatchLength);
+  }
+
+  HAL_DestroyNotifier(notifier);
+  handler.join();
+  HALSIM_ResumeTiming();
+
+  state.counters["sim_s_per_s"] =
+      benchmark::Counter(state.iterations() * kMatchLength / 1e6,
+                         benchmark::Counter::kIsRate);
+  state.counters["loops"] = benchmark::Counter(
+      static_cast<double>(loops), benchmark::Counter::kAvgIterations);
+}
+
+inline void SimulationCanSendCallback(const char* name, void* param,
+                                      int32_t busId, uint32_t messageId,
+                                      const HAL_CANMessage* message,
+                                      int32_t periodMs, int32_t* status) {
+  uint32_t sum = messageId;
+  for (uint8_t i = 0; i < message->dataSize; ++i) {
+    sum = sum * 31 + message->data[i];
+  }
+  benchmark::DoNotOptimize(sum);
+}
+
+inline int32_t gSimulationCanSendUid = 0;
+
+inline void SimulationCanSendSetup(const benchmark::State&) {
+  HAL_Initialize();
+  gSimulationCanSendUid =
+      HALSIM_RegisterCanSendMessageCallback(SimulationCanSendCallback, nullptr);
+}
+
+inline void SimulationCanSendTeardown(const benchmark::State&) {
+  HALSIM_CancelCanSendMessageCallback(gSimulationCanSendUid);
+}
+
+/**
+ * Sends CAN frames from every benchmark thread through the sim send message
+ * callback, as devices on separate threads do. Argument is whether the first
+ * thread also registers and cancels a callback every 64 frames.
+ */
+inline void BM_Simulation_CanSendContention(benchmark::State& state) {
+  bool churn = state.range(0) != 0 && state.thread_index() == 0;
+  HAL_CANMessage message{};
+  message.dataSize = 8;
+  int64_t count = 0;
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    message.data[0] = static_cast<uint8_t>(count);
+    int32_t status = 0;
+    HAL_CAN_SendMessage(0, 0x2050000 + state.thread_index(), &message, 0,
+                        &status);
+    if (churn && ++count % 64 == 0) {
+      HALSIM_CancelCanSendMessageCallback(HALSIM_RegisterCanSendMessageCallback(
+          SimulationCanSendCallback, nullptr));
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * DC motor simulations for a swarm, cycling through four different mechanism
+ * sizes.
+ */
+inline std::vector<wpi::sim::DCMotorSim> MakeSimulationSwarm(int count) {
+  std::vector<wpi::sim::DCMotorSim> sims;
+  sims.reserve(count);
+  for (int i = 0; i < count; ++i) {
+    sims.emplace_back(
+        wpi::math::Models::SingleJointedArmFromPhysicalConstants(
+            wpi::math::DCMotor::NEO(1),
+            wpi::units::kilogram_square_meter_t{0.0005 * (1 + i % 4)}, 1.0),
+        wpi::math::DCMotor::NEO(1));
+  }
+  return sims;
+}
+
+/** Updates each simulation individually. Argument is mechanisms. */
+inline void BM_Simulation_SwarmUpdate(benchmark::State& state) {
+  auto sims = MakeSimulationSwarm(state.range(0));
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    for (auto&& sim : sims) {
+      sim.SetInput(0, 6.0);
+      sim.Update(20_ms);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * sims.size());
+}
+
+/** Updates the simulations as a batch. Argument is mechanisms. */
+inline void BM_Simulation_SwarmBatchUpdate(benchmark::State& state) {
+  auto sims = MakeSimulationSwarm(state.range(0));
+  wpi::sim::LinearSystemSimBatch<2, 1, 2> batch;
+  for (auto&& sim : sims) {
+    batch.Add(sim);
+  }
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    for (auto&& sim : sims) {
+      sim.SetInput(0, 6.0);
+    }
+    batch.Update(20_ms);
+  }
+  state.SetItemsProcessed(state.iterations() * sims.size());
+}
@@ -0,0 +1,46 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+#include "wpi/util/Synchronization.hpp"
+
+/**
+ * Each benchmark thread signals and waits on its own event, so the only
+ * contention is inside the handle manager.
+ */
+inline void BM_Synchronization_SetWait(benchmark::State& state) {
+  wpi::util::Event event{false, false};
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    wpi::util::SetEvent(event.GetHandle());
+    benchmark::DoNotOptimize(wpi::util::WaitForObject(event.GetHandle()));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/** Round trip wake-up between two threads. */
+inline void BM_Synchronization_PingPong(benchmark::State& state) {
+  wpi::util::Event ping{false, false};
+  wpi::util::Event pong{false, false};
+  std::jthread thr{[&](std::stop_token stop) {
+    while (wpi::util::WaitForObject(ping.GetHandle()) &&
+           !stop.stop_requested()) {
+      wpi::util::SetEvent(pong.GetHandle());
+    }
+  }};
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    wpi::util::SetEvent(ping.GetHandle());
+    wpi::util::WaitForObject(pong.GetHandle());
+  }
+  thr.request_stop();
+  wpi::util::SetEvent(ping.GetHandle());
+  thr.join();
+  state.SetItemsProcessed(state.iterations());
+}
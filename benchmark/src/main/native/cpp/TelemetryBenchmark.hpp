@@ -0,0 +1,184 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <optional>
+
+#include <benchmark/benchmark.h>
+
+#include "wpi/backend/DataLogTelemetryBackend.hpp"
+#include "wpi/backend/NetworkTablesTelemetryBackend.hpp"
+#include "wpi/datalog/DataLogWriter.hpp"
+#include "wpi/math/geometry/Pose2d.hpp"
+#include "wpi/math/geometry/struct/Pose2dStruct.hpp"
+#include "wpi/nt/NetworkTableInstance.hpp"
+#include "wpi/telemetry/AsyncTelemetryBackend.hpp"
+#include "wpi/telemetry/TelemetryHandle.hpp"
+#include "wpi/telemetry/TelemetryRegistry.hpp"
+#include "wpi/telemetry/TelemetryTable.hpp"
+#include "wpi/units/length.hpp"
+#include "wpi/util/raw_ostream.hpp"
+
+/**
+ * Registers a telemetry backend for the duration of a benchmark. The argument
+ * selects the backend: 0 is NetworkTables (a local instance with no
+ * connections) and 1 is a DataLog whose output is discarded. If async is true,
+ * the backend is wrapped in an AsyncTelemetryBackend.
+ */
+class TelemetryBenchmarkBackend {
+ public:
+  explicit TelemetryBenchmarkBackend(int64_t backend, bool async = false) {
+    wpi::telemetry::TelemetryRegistry::Reset();
+    std::shared_ptr<wpi::telemetry::TelemetryBackend> inner;
+    if (backend == 0) {
+      m_inst = wpi::nt::NetworkTableInstance::Create();
+      inner = std::make_shared<wpi::backend::NetworkTablesTelemetryBackend>(
+          m_inst, "/Telemetry");
+    } else {
+      m_log.emplace(std::make_unique<NullOutputStream>());
+      inner = std::make_shared<wpi::backend::DataLogTelemetryBackend>(
+          *m_log, "/Telemetry");
+    }
+    if (async) {
+      m_async = std::make_shared<wpi::telemetry::AsyncTelemetryBackend>(inner);
+      inner = m_async;
+    }
+    wpi::telemetry::TelemetryRegistry::RegisterBackend("", std::move(inner));
+  }
+
+  ~TelemetryBenchmarkBackend() {
+    wpi::telemetry::TelemetryRegistry::Reset();
+    if (m_inst) {
+      wpi::nt::NetworkTableInstance::Destroy(m_inst);
+    }
+  }
+
+  wpi::telemetry::TelemetryTable& GetTable() {
+    return wpi::telemetry::TelemetryRegistry::GetTable("/bench");
+  }
+
+  /**
+   * Waits for queued values to reach the wrapped backend and reports the
+   * number of values dropped along the way.
+   */
+  void ReportAsync(benchmark::State& state) {
+    if (m_async) {
+      m_async->Flush();
+      auto stats = m_async->GetStats();
+      state.counters["dropped"] = stats.dropped;
+      state.counters["maxBufferUsage"] = stats.maxBufferUsage;
+    }
+  }
+
+ private:
+  class NullOutputStream : public wpi::util::raw_ostream {
+   public:
+    ~NullOutputStream() override { flush(); }
+
+   private:
+    void write_impl(const char* ptr, size_t size) override { m_pos += size; }
+    uint64_t current_pos() const override { return m_pos; }
+
+    uint64_t m_pos = 0;
+  };
+
+  wpi::nt::NetworkTableInstance m_inst;
+  std::optional<wpi::log::DataLogWriter> m_log;
+  std::shared_ptr<wpi::telemetry::AsyncTelemetryBackend> m_async;
+};
+
+/** Logs a double by name with TelemetryTable::Log(). */
+inline void BM_Telemetry_LogDouble(benchmark::State& state) {
+  TelemetryBenchmarkBackend backend{state.range(0)};
+  auto& table = backend.GetTable();
+  double value = 0;
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    table.Log("value", value);
+    value += 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/** Logs a double through a cached TelemetryHandle. */
+inline void BM_Telemetry_HandleLogDouble(benchmark::State& state) {
+  TelemetryBenchmarkBackend backend{state.range(0)};
+  wpi::telemetry::TelemetryHandle<double> handle{backend.GetTable(), "value"};
+  double value = 0;
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    handle.Log(value);
+    value += 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/** Logs a struct by name with TelemetryTable::Log(). */
+inline void BM_Telemetry_LogStruct(benchmark::State& state) {
+  TelemetryBenchmarkBackend backend{state.range(0)};
+  auto& table = backend.GetTable();
+  double x = 0;
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    table.Log("pose", wpi::math::Pose2d{wpi::units::meter_t{x},
+                                        wpi::units::meter_t{0}, {}});
+    x += 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/** Logs a struct through a cached TelemetryHandle. */
+inline void BM_Telemetry_HandleLogStruct(benchmark::State& state) {
+  TelemetryBenchmarkBackend backend{state.range(0)};
+  wpi::telemetry::TelemetryHandle<wpi::math::Pose2d> handle{backend.GetTable(),
+                                                           "pose"};
+  double x = 0;
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    handle.Log(wpi::math::Pose2d{wpi::units::meter_t{x},
+                                 wpi::units::meter_t{0}, {}});
+    x += 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * Logs a double through a cached TelemetryHandle to an AsyncTelemetryBackend.
+ * Only the cost on the logging thread is measured.
+ */
+inline void BM_Telemetry_AsyncHandleLogDouble(benchmark::State& state) {
+  TelemetryBenchmarkBackend backend{state.range(0), true};
+  wpi::telemetry::TelemetryHandle<double> handle{backend.GetTable(), "value"};
+  double value = 0;
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    handle.Log(value);
+    value += 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+  backend.ReportAsync(state);
+}
+
+/**
+ * Logs a struct through a cached TelemetryHandle to an AsyncTelemetryBackend.
+ * Only the cost on the logging thread is measured.
+ */
+inline void BM_Telemetry_AsyncHandleLogStruct(benchmark::State& state) {
+  TelemetryBenchmarkBackend backend{state.range(0), true};
+  wpi::telemetry::TelemetryHandle<wpi::math::Pose2d> handle{backend.GetTable(),
+                                                           "pose"};
+  double x = 0;
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    handle.Log(wpi::math::Pose2d{wpi::units::meter_t{x},
+                                 wpi::units::meter_t{0}, {}});
+    x += 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+  backend.ReportAsync(state);
+}
@@ -0,0 +1,157 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "wpi/net/detail/WebSocketDeflate.hpp"
+#include "wpi/net/detail/WebSocketMask.hpp"
+#include "wpi/util/SmallVector.hpp"
+
+inline constexpr uint8_t kWebSocketBenchKey[4] = {0x12, 0x34, 0x56, 0x78};
+
+/** Byte at a time masking, for comparison. */
+inline void BM_WebSocket_MaskBytewise(benchmark::State& state) {
+  std::vector<uint8_t> src(state.range(0), 0x5a);
+  std::vector<uint8_t> dst(src.size());
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    int n = 0;
+    for (size_t i = 0; i < src.size(); ++i) {
+      dst[i] = src[i] ^ kWebSocketBenchKey[n++];
+      if (n >= 4) {
+        n = 0;
+      }
+    }
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * src.size());
+}
+
+/** Copy and mask, as done by the client when serializing frames. */
+inline void BM_WebSocket_MaskCopy(benchmark::State& state) {
+  std::vector<uint8_t> src(state.range(0), 0x5a);
+  std::vector<uint8_t> dst(src.size());
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    wpi::net::detail::WebSocketMaskCopy(dst.data(), src.data(), src.size(),
+                                        kWebSocketBenchKey);
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * src.size());
+}
+
+/**
+ * Copy and mask from an odd source offset, as when unmasking a payload that
+ * follows a frame header in the receive buffer.
+ */
+inline void BM_WebSocket_MaskCopyUnaligned(benchmark::State& state) {
+  std::vector<uint8_t> src(state.range(0) + 3, 0x5a);
+  std::vector<uint8_t> dst(state.range(0));
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    wpi::net::detail::WebSocketMaskCopy(dst.data(), src.data() + 3, dst.size(),
+                                        kWebSocketBenchKey, 1);
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * dst.size());
+}
+
+/**
+ * A burst of NetworkTables announce messages, as sent to a newly connected
+ * client, split into messages of about 1 KB.
+ */
+inline std::vector<std::string> MakeWebSocketAnnounceBurst() {
+  std::vector<std::string> msgs;
+  std::string msg = "[";
+  for (int i = 0; i < 500; ++i) {
+    if (msg.size() > 1) {
+      msg += ',';
+    }
+    msg += "{\"method\":\"announce\",\"params\":{\"id\":";
+    msg += std::to_string(i);
+    msg += ",\"name\":\"/SmartDashboard/Subsystem";
+    msg += std::to_string(i / 10);
+    msg += "/Value";
+    msg += std::to_string(i % 10);
+    msg += "\",\"properties\":{},\"pubuid\":";
+    msg += std::to_string(i);
+    msg += ",\"type\":\"double\"}}";
+    if (msg.size() >= 1000) {
+      msg += ']';
+      msgs.emplace_back(std::move(msg));
+      msg = "[";
+    }
+  }
+  if (msg.size() > 1) {
+    msg += ']';
+    msgs.emplace_back(std::move(msg));
+  }
+  return msgs;
+}
+
+/**
+ * Compresses an announce burst. Argument is 1 for context takeover (as used by
+ * SendFrames) or 0 to compress each message independently (as used by
+ * TrySendFrames). The ratio counter is compressed size / original size.
+ */
+inline void BM_WebSocket_DeflateAnnounce(benchmark::State& state) {
+  auto msgs = MakeWebSocketAnnounceBurst();
+  bool contextTakeover = state.range(0) != 0;
+  wpi::net::detail::WebSocketDeflater deflater;
+  wpi::util::SmallVector<uint8_t, 2048> out;
+  size_t inBytes = 0;
+  size_t outBytes = 0;
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    deflater.Reset();
+    for (auto&& msg : msgs) {
+      if (!contextTakeover) {
+        deflater.Reset();
+      }
+      out.clear();
+      deflater.Compress(
+          {reinterpret_cast<const uint8_t*>(msg.data()), msg.size()}, out);
+      benchmark::DoNotOptimize(out.data());
+      inBytes += msg.size();
+      outBytes += out.size();
+    }
+  }
+  state.SetBytesProcessed(inBytes);
+  state.counters["ratio"] =
+      static_cast<double>(outBytes) / static_cast<double>(inBytes);
+}
+
+/** Decompresses an announce burst compressed with context takeover. */
+inline void BM_WebSocket_InflateAnnounce(benchmark::State& state) {
+  auto msgs = MakeWebSocketAnnounceBurst();
+  wpi::net::detail::WebSocketDeflater deflater;
+  std::vector<std::vector<uint8_t>> compressed;
+  size_t inBytes = 0;
+  for (auto&& msg : msgs) {
+    wpi::util::SmallVector<uint8_t, 2048> out;
+    deflater.Compress(
+        {reinterpret_cast<const uint8_t*>(msg.data()), msg.size()}, out);
+    compressed.emplace_back(out.begin(), out.end());
+    inBytes += msg.size();
+  }
+  // NOLINTNEXTLINE(clang-analyzer-deadcode.DeadStores)
+  for (auto _ : state) {
+    wpi::net::detail::WebSocketInflater inflater;
+    for (auto&& data : compressed) {
+      auto out = inflater.Decompress(data, SIZE_MAX);
+      benchmark::DoNotOptimize(out);
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * inBytes);
+}
@@ -0,0 +1,124 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/vision/PipelinedVisionRunner.hpp"
+
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+
+#include "wpi/cameraserver/CameraServerShared.hpp"
+#include "wpi/util/timestamp.hpp"
+
+using namespace wpi::vision;
+
+PipelinedVisionRunnerBase::PipelinedVisionRunnerBase(
+    cs::VideoSource videoSource, int numWorkers)
+    : m_cvSink("PipelinedVisionRunner CvSink"),
+      m_numWorkers(numWorkers),
+      m_enabled(true),
+      m_slotImage(std::make_unique<cv::Mat>()) {
+  m_cvSink.SetSource(videoSource);
+}
+
+// Located here and not in header due to cv::Mat forward declaration.
+PipelinedVisionRunnerBase::~PipelinedVisionRunnerBase() = default;
+
+void PipelinedVisionRunnerBase::RunForever() {
+  auto csShared = wpi::GetCameraServerShared();
+  auto res = csShared->GetRobotMainThreadId();
+  if (res.second && (std::this_thread::get_id() == res.first)) {
+    csShared->SetVisionRunnerError(
+        "PipelinedVisionRunner::RunForever() cannot be called from the main "
+        "robot thread");
+    return;
+  }
+
+  std::vector<std::thread> workers;
+  for (int i = 0; i < m_numWorkers; ++i) {
+    workers.emplace_back([this, i] { WorkerMain(i); });
+  }
+
+  cv::Mat image;
+  while (m_enabled) {
+    auto frameTime = m_cvSink.GrabFrame(image);
+    if (frameTime == 0) {
+      auto error = m_cvSink.GetError();
+      csShared->ReportDriverStationError(error.c_str());
+      continue;
+    }
+    auto grabTime = wpi::util::Now();
+
+    // Replace the waiting frame (if any) with this one. Swapping keeps the
+    // old frame's buffer for the next grab instead of reallocating it.
+    {
+      std::scoped_lock lock{m_slotMutex};
+      if (m_slotFull) {
+        ++m_slotDropped;
+        ++m_droppedFrames;
+      }
+      m_slotImage->swap(image);
+      m_slotFull = true;
+      m_slotCaptureTime = frameTime;
+      m_slotGrabTime = grabTime;
+    }
+    m_slotCond.notify_one();
+  }
+
+  {
+    std::scoped_lock lock{m_slotMutex};
+    m_slotFull = false;
+    m_slotDropped = 0;
+  }
+  m_slotCond.notify_all();
+  for (auto&& worker : workers) {
+    worker.join();
+  }
+}
+
+void PipelinedVisionRunnerBase::Stop() {
+  {
+    std::scoped_lock lock{m_slotMutex};
+    m_enabled = false;
+  }
+  m_slotCond.notify_all();
+}
+
+void PipelinedVisionRunnerBase::WorkerMain(int worker) {
+  cv::Mat image;
+  VisionFrameTiming timing;
+  for (;;) {
+    {
+      std::unique_lock lock{m_slotMutex};
+      m_slotCond.wait(lock, [&] { return m_slotFull || !m_enabled; });
+      if (!m_enabled) {
+        break;
+      }
+      image.swap(*m_slotImage);
+      m_slotFull = false;
+      timing.sequence = m_nextSequence++;
+      timing.captureTime = m_slotCaptureTime;
+      timing.grabTime = m_slotGrabTime;
+      timing.droppedFrames = std::exchange(m_slotDropped, 0);
+    }
+
+    timing.processStartTime = wpi::util::Now();
+    DoProcess(worker, image);
+    timing.processEndTime = wpi::util::Now();
+
+    // wait for results of earlier frames to be delivered
+    {
+      std::unique_lock lock{m_resultMutex};
+      m_resultCond.wait(lock,
+                        [&] { return m_nextResult == timing.sequence; });
+      timing.resultTime = wpi::util::Now();
+      DoResult(worker, timing);
+      ++m_nextResult;
+    }
+    m_resultCond.notify_all();
+  }
+}
@@ -0,0 +1,202 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "wpi/cs/CvSink.hpp"
+#include "wpi/cs/VideoSource.hpp"
+#include "wpi/vision/VisionPipeline.hpp"
+
+namespace wpi::vision {
+
+/**
+ * Timestamps of a frame as it moves through a PipelinedVisionRunner. All times
+ * are in the same time base as wpi::util::Now(), in 1 us increments.
+ */
+struct VisionFrameTiming {
+  /// Frame number, counting frames in the order they were processed.
+  uint64_t sequence = 0;
+  /// Time the frame was captured by the source.
+  uint64_t captureTime = 0;
+  /// Time the frame was grabbed from the source.
+  uint64_t grabTime = 0;
+  /// Time the pipeline started processing the frame.
+  uint64_t processStartTime = 0;
+  /// Time the pipeline finished processing the frame.
+  uint64_t processEndTime = 0;
+  /// Time the result was delivered to the listener.
+  uint64_t resultTime = 0;
+  /// Number of frames dropped since the previous processed frame because a
+  /// newer frame arrived before a pipeline was free.
+  uint64_t droppedFrames = 0;
+};
+
+/**
+ * Non-template base class for PipelinedVisionRunner.
+ */
+class PipelinedVisionRunnerBase {
+ public:
+  /**
+   * Creates a new pipelined vision runner. It will take images from the {@code
+   * videoSource}, call the virtual DoProcess() method on up to {@code
+   * numWorkers} images at once, and call the virtual DoResult() method in
+   * frame order.
+   *
+   * @param videoSource the video source to use to supply images for the
+   *                    pipeline
+   * @param numWorkers  the number of images to process concurrently
+   */
+  PipelinedVisionRunnerBase(cs::VideoSource videoSource, int numWorkers);
+
+  virtual ~PipelinedVisionRunnerBase();
+
+  PipelinedVisionRunnerBase(const PipelinedVisionRunnerBase&) = delete;
+  PipelinedVisionRunnerBase& operator=(const PipelinedVisionRunnerBase&) =
+      delete;
+
+  /**
+   * Grabs images from the video source and processes them until Stop() is
+   * called. Grabbing runs on the calling thread and each worker runs on its
+   * own thread, so the next image is grabbed while earlier ones are being
+   * processed. Only the latest grabbed image is kept; if no worker is free
+   * when a new image arrives, the waiting image is dropped. This must be run
+   * in a dedicated thread, and cannot be used in the main robot thread because
+   * it will freeze the robot program.
+   *
+   * <strong>Do not call this method directly from the main thread.</strong>
+   */
+  void RunForever();
+
+  /**
+   * Stop a RunForever() loop. Images already being processed will finish and
+   * have their results delivered before RunForever() returns.
+   */
+  void Stop();
+
+  /**
+   * Gets the total number of images dropped because a newer image arrived
+   * before a worker was free.
+   *
+   * @return number of dropped images
+   */
+  uint64_t GetDroppedFrames() const { return m_droppedFrames; }
+
+ protected:
+  /**
+   * Processes an image. This is called concurrently from each worker thread.
+   *
+   * @param worker worker index, from 0 to numWorkers-1
+   * @param image image to process
+   */
+  virtual void DoProcess(int worker, cv::Mat& image) = 0;
+
+  /**
+   * Delivers the result of processing an image. This is called from the
+   * worker thread that processed the image, one call at a time in the order
+   * the images were grabbed.
+   *
+   * @param worker worker index, from 0 to numWorkers-1
+   * @param timing image timing
+   */
+  virtual void DoResult(int worker, const VisionFrameTiming& timing) = 0;
+
+ private:
+  void WorkerMain(int worker);
+
+  cs::CvSink m_cvSink;
+  int m_numWorkers;
+  std::atomic_bool m_enabled;
+  std::atomic<uint64_t> m_droppedFrames{0};
+
+  // latest grabbed frame, waiting for a free worker
+  std::mutex m_slotMutex;
+  std::condition_variable m_slotCond;
+  std::unique_ptr<cv::Mat> m_slotImage;
+  bool m_slotFull = false;
+  uint64_t m_slotCaptureTime = 0;
+  uint64_t m_slotGrabTime = 0;
+  uint64_t m_slotDropped = 0;
+  uint64_t m_nextSequence = 0;
+
+  // in-order result delivery
+  std::mutex m_resultMutex;
+  std::condition_variable m_resultCond;
+  uint64_t m_nextResult = 0;
+};
+
+/**
+ * A pipelined vision runner overlaps grabbing images with processing them,
+ * always processes the most recent image, and can run several copies of a
+ * pipeline at once. Results are delivered to the listener in the order the
+ * images were grabbed, along with the latency of each stage. Run it with
+ * RunForever() in a std::thread.
+ *
+ * @see VisionRunner
+ * @see VisionPipeline
+ */
+template <typename T>
+class PipelinedVisionRunner : public PipelinedVisionRunnerBase {
+ public:
+  /**
+   * Creates a new pipelined vision runner. Each pipeline is used by one
+   * worker, so the number of pipelines is the number of images processed at
+   * once. The {@code listener} is called with the pipeline that processed
+   * each image after it has finished; the pipeline is not given another image
+   * until the listener returns.
+   *
+   * @param videoSource The video source to use to supply images for the
+   *                    pipelines
+   * @param pipelines   The vision pipelines to run
+   * @param listener    A function to call after a pipeline has finished
+   *                    running
+   */
+  PipelinedVisionRunner(
+      cs::VideoSource videoSource, std::vector<T*> pipelines,
+      std::function<void(T&, const VisionFrameTiming&)> listener)
+      : PipelinedVisionRunnerBase(videoSource, pipelines.size()),
+        m_pipelines(std::move(pipelines)),
+        m_listener(std::move(listener)) {}
+
+  /**
+   * Creates a new pipelined vision runner with a single pipeline. Images are
+   * still grabbed while the pipeline is running, so the pipeline always gets
+   * the most recent image.
+   *
+   * @param videoSource The video source to use to supply images for the
+   *                    pipeline
+   * @param pipeline    The vision pipeline to run
+   * @param listener    A function to call after the pipeline has finished
+   *                    running
+   */
+  PipelinedVisionRunner(
+      cs::VideoSource videoSource, T* pipeline,
+      std::function<void(T&, const VisionFrameTiming&)> listener)
+      : PipelinedVisionRunner(videoSource, std::vector<T*>{pipeline},
+                              std::move(listener)) {}
+
+ protected:
+  void DoProcess(int worker, cv::Mat& image) override {
+    m_pipelines[worker]->Process(image);
+  }
+
+  void DoResult(int worker, const VisionFrameTiming& timing) override {
+    m_listener(*m_pipelines[worker], timing);
+  }
+
+ private:
+  std::vector<T*> m_pipelines;
+  std::function<void(T&, const VisionFrameTiming&)> m_listener;
+};
+
+}  // namespace wpi::vision
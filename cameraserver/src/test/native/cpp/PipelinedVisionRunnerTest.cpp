@@ -0,0 +1,164 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/vision/PipelinedVisionRunner.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <opencv2/core/mat.hpp>
+
+#include "wpi/cs/CvSource.hpp"
+#include "wpi/vision/VisionPipeline.hpp"
+
+namespace wpi::vision {
+
+namespace {
+
+// Synthetic camera that puts a new frame every millisecond; the first byte of
+// each frame is a counter so the order of processed frames can be checked.
+class SyntheticCamera {
+ public:
+  SyntheticCamera()
+      : m_source{"synthetic", wpi::util::PixelFormat::BGR, 8, 8, 1000},
+        m_thread{[this] {
+          cv::Mat image{8, 8, CV_8UC3};
+          while (m_running) {
+            std::fill_n(image.data, image.total() * image.elemSize(),
+                        m_count++);
+            m_source.PutFrame(image);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          }
+        }} {}
+
+  ~SyntheticCamera() {
+    m_running = false;
+    m_thread.join();
+  }
+
+  cs::CvSource& GetSource() { return m_source; }
+
+ private:
+  cs::CvSource m_source;
+  std::atomic_bool m_running{true};
+  uint8_t m_count = 0;
+  std::thread m_thread;
+};
+
+class SlowPipeline : public VisionPipeline {
+ public:
+  explicit SlowPipeline(std::atomic_int& active) : m_active{active} {}
+
+  void Process(cv::Mat& mat) override {
+    int active = ++m_active;
+    maxActive = std::max(maxActive, active);
+    value = mat.data[0];
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    --m_active;
+  }
+
+  uint8_t value = 0;
+  int maxActive = 0;
+
+ private:
+  std::atomic_int& m_active;
+};
+
+struct Result {
+  uint8_t value;
+  VisionFrameTiming timing;
+};
+
+// Runs until the listener calls Stop()
+void Run(PipelinedVisionRunnerBase& runner) {
+  std::thread thread{[&] { runner.RunForever(); }};
+  thread.join();
+}
+
+}  // namespace
+
+TEST_CASE("PipelinedVisionRunner in order results",
+          "[cameraserver][vision-runner]") {
+  SyntheticCamera camera;
+  std::atomic_int active{0};
+  std::vector<SlowPipeline> pipelines(3, SlowPipeline{active});
+  std::vector<SlowPipeline*> pipelinePtrs;
+  for (auto&& pipeline : pipelines) {
+    pipelinePtrs.emplace_back(&pipeline);
+  }
+
+  // the listener is called one result at a time
+  std::vector<Result> results;
+  PipelinedVisionRunner<SlowPipeline> runner{
+      camera.GetSource(), pipelinePtrs,
+      [&](SlowPipeline& pipeline, const VisionFrameTiming& timing) {
+        results.emplace_back(pipeline.value, timing);
+        if (results.size() == 20) {
+          runner.Stop();
+        }
+      }};
+  Run(runner);
+
+  REQUIRE(results.size() >= 20);
+  for (size_t i = 0; i < results.size(); ++i) {
+    auto& timing = results[i].timing;
+    CHECK(timing.sequence == i);
+    CHECK(timing.captureTime <= timing.grabTime);
+    CHECK(timing.grabTime <= timing.processStartTime);
+    CHECK(timing.processStartTime <= timing.processEndTime);
+    CHECK(timing.processEndTime <= timing.resultTime);
+    if (i > 0) {
+      // frames are delivered in the order they were grabbed
+      CHECK(timing.captureTime > results[i - 1].timing.captureTime);
+      CHECK(results[i].value != results[i - 1].value);
+    }
+  }
+
+  // the camera is faster than processing, so frames were dropped and
+  // processed concurrently
+  CHECK(runner.GetDroppedFrames() > 0);
+  int maxActive = 0;
+  for (auto&& pipeline : pipelines) {
+    maxActive = std::max(maxActive, pipeline.maxActive);
+  }
+  CHECK(maxActive > 1);
+}
+
+TEST_CASE("PipelinedVisionRunner single pipeline",
+          "[cameraserver][vision-runner]") {
+  SyntheticCamera camera;
+  std::atomic_int active{0};
+  SlowPipeline pipeline{active};
+
+  // the listener is called one result at a time
+  std::vector<Result> results;
+  PipelinedVisionRunner<SlowPipeline> runner{
+      camera.GetSource(), &pipeline,
+      [&](SlowPipeline& pipeline, const VisionFrameTiming& timing) {
+        results.emplace_back(pipeline.value, timing);
+        if (results.size() == 5) {
+          runner.Stop();
+        }
+      }};
+  Run(runner);
+
+  REQUIRE(results.size() == 5);
+  CHECK(pipeline.maxActive == 1);
+  uint64_t dropped = 0;
+  for (auto&& result : results) {
+    dropped += result.timing.droppedFrames;
+  }
+  // the camera keeps being read while the pipeline runs
+  CHECK(dropped > 0);
+  CHECK(dropped <= runner.GetDroppedFrames());
+}
+
+}  // namespace wpi::vision
@@ -16,6 +16,7 @@
 #include "wpi/framework/RobotBase.hpp"
 #include "wpi/framework/TimedRobot.hpp"
 #include "wpi/hal/UsageReporting.hpp"
+#include "wpi/system/Profiler.hpp"
 #include "wpi/telemetry/TelemetryTable.hpp"
 #include "wpi/tunables/TunableConfig.hpp"
 #include "wpi/tunables/TunableTable.hpp"
@@ -162,23 +163,29 @@ void CommandScheduler::Run() {
     return;
   }
 
+  wpi::Profiler::Zone runZone{"CommandScheduler::Run()"};
   m_watchdog.Reset();
 
   // Run the periodic method of all registered subsystems.
   for (auto&& subsystem : m_impl->subsystems) {
+    std::string epoch = subsystem.getFirst()->GetName() + ".Periodic()";
+    wpi::Profiler::Zone zone{epoch};
     subsystem.getFirst()->Periodic();
     if constexpr (wpi::RobotBase::IsSimulation()) {
       subsystem.getFirst()->SimulationPeriodic();
     }
-    m_watchdog.AddEpoch(subsystem.getFirst()->GetName() + ".Periodic()");
+    m_watchdog.AddEpoch(epoch);
   }
 
   // Cache the active instance to avoid concurrency problems if SetActiveLoop()
   // is called from inside the button bindings.
   wpi::EventLoop* loopCache = m_impl->activeButtonLoop;
   // Poll buttons for new commands to add.
-  loopCache->Poll();
-  m_watchdog.AddEpoch("buttons.Run()");
+  {
+    wpi::Profiler::Zone zone{"buttons.Run()"};
+    loopCache->Poll();
+    m_watchdog.AddEpoch("buttons.Run()");
+  }
 
   bool isDisabled = wpi::RobotState::IsDisabled();
   // create a new set to avoid iterator invalidation.
@@ -192,13 +199,19 @@ void CommandScheduler::Run() {
       continue;
     }
 
-    command->Execute();
-    for (auto&& action : m_impl->executeActions) {
-      action(*command);
+    {
+      std::string epoch = command->GetName() + ".Execute()";
+      wpi::Profiler::Zone zone{epoch};
+      command->Execute();
+      for (auto&& action : m_impl->executeActions) {
+        action(*command);
+      }
+      m_watchdog.AddEpoch(epoch);
     }
-    m_watchdog.AddEpoch(command->GetName() + ".Execute()");
 
     if (command->IsFinished()) {
+      std::string epoch = command->GetName() + ".End(false)";
+      wpi::Profiler::Zone zone{epoch};
       m_impl->scheduledCommands.erase(command);
       command->End(false);
       for (auto&& action : m_impl->finishActions) {
@@ -209,7 +222,7 @@ void CommandScheduler::Run() {
         m_impl->requirements.erase(requirement);
       }
 
-      m_watchdog.AddEpoch(command->GetName() + ".End(false)");
+      m_watchdog.AddEpoch(epoch);
       // remove owned commands after everything else is done
       m_impl->ownedCommands.erase(command);
     }
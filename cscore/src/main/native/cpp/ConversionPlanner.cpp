@@ -0,0 +1,157 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "ConversionPlanner.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+using namespace wpi::cs;
+using wpi::util::PixelFormat;
+
+namespace {
+
+constexpr int kNumFormats = static_cast<int>(PixelFormat::BGRA) + 1;
+
+struct Conversion {
+  PixelFormat from;
+  PixelFormat to;
+  // approximate relative cost per pixel
+  int cost;
+};
+
+// Every conversion Frame has a kernel for.  YUV formats have direct luma
+// extraction for grayscale; JPEG can be decoded directly to grayscale and
+// grayscale images encoded directly.
+constexpr Conversion kConversions[] = {
+    {PixelFormat::MJPEG, PixelFormat::BGR, 30},
+    {PixelFormat::MJPEG, PixelFormat::GRAY, 20},
+    {PixelFormat::YUYV, PixelFormat::BGR, 4},
+    {PixelFormat::YUYV, PixelFormat::GRAY, 1},
+    {PixelFormat::UYVY, PixelFormat::BGR, 4},
+    {PixelFormat::UYVY, PixelFormat::GRAY, 1},
+    {PixelFormat::BGR, PixelFormat::RGB565, 3},
+    {PixelFormat::RGB565, PixelFormat::BGR, 3},
+    {PixelFormat::BGR, PixelFormat::GRAY, 3},
+    {PixelFormat::GRAY, PixelFormat::BGR, 2},
+    {PixelFormat::BGR, PixelFormat::MJPEG, 40},
+    {PixelFormat::GRAY, PixelFormat::MJPEG, 15},
+    {PixelFormat::GRAY, PixelFormat::Y16, 2},
+    {PixelFormat::Y16, PixelFormat::GRAY, 4},
+    {PixelFormat::BGR, PixelFormat::BGRA, 2},
+};
+
+// What an image in a format can hold
+struct Fidelity {
+  bool color;
+  int depth;
+
+  bool Covers(const Fidelity& other) const {
+    return (color || !other.color) && depth >= other.depth;
+  }
+
+  Fidelity Min(const Fidelity& other) const {
+    return {color && other.color, std::min(depth, other.depth)};
+  }
+};
+
+Fidelity GetFidelity(PixelFormat pixelFormat) {
+  switch (pixelFormat) {
+    case PixelFormat::RGB565:
+      return {true, 5};
+    case PixelFormat::GRAY:
+      return {false, 8};
+    case PixelFormat::Y16:
+      return {false, 16};
+    default:
+      return {true, 8};
+  }
+}
+
+int Index(PixelFormat pixelFormat) {
+  return static_cast<int>(pixelFormat);
+}
+
+}  // namespace
+
+bool wpi::cs::PlanConversion(
+    PixelFormat original, std::span<const PixelFormat> available,
+    PixelFormat pixelFormat, wpi::util::SmallVectorImpl<PixelFormat>& path) {
+  path.clear();
+
+  // Formats that hold less than a direct conversion from the original would
+  // can't be on the path.  If nothing available is good enough (e.g. the
+  // original image is no longer at this size), settle for the best available.
+  Fidelity needed = GetFidelity(original).Min(GetFidelity(pixelFormat));
+  if (std::none_of(available.begin(), available.end(), [&](auto f) {
+        return GetFidelity(f).Covers(needed);
+      })) {
+    Fidelity best{false, 0};
+    for (auto f : available) {
+      Fidelity fidelity = GetFidelity(f);
+      if (fidelity.Covers(best)) {
+        best = fidelity;
+      }
+    }
+    needed = needed.Min(best);
+  }
+
+  // Dijkstra's algorithm; there are few enough formats to not need a queue
+  constexpr int kInfinity = std::numeric_limits<int>::max();
+  std::array<int, kNumFormats> cost;
+  std::array<int, kNumFormats> prev;
+  std::array<bool, kNumFormats> done{};
+  cost.fill(kInfinity);
+  prev.fill(-1);
+  for (auto f : available) {
+    if (Index(f) < kNumFormats && GetFidelity(f).Covers(needed)) {
+      cost[Index(f)] = 0;
+    }
+  }
+  for (;;) {
+    int cur = -1;
+    for (int i = 0; i < kNumFormats; ++i) {
+      if (!done[i] && cost[i] != kInfinity &&
+          (cur == -1 || cost[i] < cost[cur])) {
+        cur = i;
+      }
+    }
+    if (cur == -1) {
+      break;
+    }
+    done[cur] = true;
+    for (auto&& conv : kConversions) {
+      int to = Index(conv.to);
+      if (Index(conv.from) == cur && GetFidelity(conv.to).Covers(needed) &&
+          cost[cur] + conv.cost < cost[to]) {
+        cost[to] = cost[cur] + conv.cost;
+        prev[to] = cur;
+      }
+    }
+  }
+
+  // The output has to be converted to, even if its format was available, so
+  // take the cheapest conversion into it.
+  int last = -1;
+  int lastCost = kInfinity;
+  for (auto&& conv : kConversions) {
+    int from = Index(conv.from);
+    if (conv.to == pixelFormat && cost[from] != kInfinity &&
+        cost[from] + conv.cost < lastCost) {
+      last = from;
+      lastCost = cost[from] + conv.cost;
+    }
+  }
+  if (last == -1) {
+    return false;
+  }
+
+  path.push_back(pixelFormat);
+  for (int i = last; i != -1; i = prev[i]) {
+    path.push_back(static_cast<PixelFormat>(i));
+  }
+  std::reverse(path.begin(), path.end());
+  return true;
+}
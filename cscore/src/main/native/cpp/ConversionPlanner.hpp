@@ -0,0 +1,38 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <span>
+
+#include "wpi/util/PixelFormat.hpp"
+#include "wpi/util/SmallVector.hpp"
+
+namespace wpi::cs {
+
+/**
+ * Finds the cheapest sequence of pixel format conversions that produces
+ * pixelFormat, starting from any of the formats already available at the
+ * output size.
+ *
+ * Conversions are weighted by their approximate per-pixel cost. Paths that
+ * would lose color or bit depth that a direct conversion from the original
+ * format keeps (e.g. making BGR from a grayscale intermediate of a color
+ * image) are not considered. An available image in the output format is
+ * assumed to not be usable as-is (e.g. a JPEG of the wrong quality), but may
+ * still be converted from.
+ *
+ * @param original    pixel format of the frame's original image
+ * @param available   pixel formats of the images that can be started from
+ * @param pixelFormat desired pixel format
+ * @param path        filled with the formats of the path, starting with one
+ *                    of the available formats and ending with pixelFormat
+ * @return False if there is no path
+ */
+bool PlanConversion(wpi::util::PixelFormat original,
+                    std::span<const wpi::util::PixelFormat> available,
+                    wpi::util::PixelFormat pixelFormat,
+                    wpi::util::SmallVectorImpl<wpi::util::PixelFormat>& path);
+
+}  // namespace wpi::cs
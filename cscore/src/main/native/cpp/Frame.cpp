@@ -4,6 +4,7 @@
 
 #include "Frame.hpp"
 
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
 
@@ -11,9 +12,12 @@
 #include <opencv2/imgcodecs/imgcodecs.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 
+#include "ConversionPlanner.hpp"
 #include "Instance.hpp"
+#include "JpegUtil.hpp"
 #include "SourceImpl.hpp"
 #include "wpi/util/PixelFormat.hpp"
+#include "wpi/util/timestamp.hpp"
 
 using namespace wpi::cs;
 
@@ -24,6 +28,7 @@ Frame::Frame(SourceImpl& source, std::string_view error, Time time,
   m_impl->error = error;
   m_impl->time = time;
   m_impl->timeSource = timeSrc;
+  m_impl->stats = {};
 }
 
 Frame::Frame(SourceImpl& source, std::unique_ptr<Image> image, Time time,
@@ -33,9 +38,26 @@ Frame::Frame(SourceImpl& source, std::unique_ptr<Image> image, Time time,
   m_impl->error.resize(0);
   m_impl->time = time;
   m_impl->timeSource = timeSrc;
+  m_impl->stats = {};
   m_impl->images.push_back(image.release());
 }
 
+// Gets the imdecode flags to decode a JPEG at 1/scale size (scale is 1, 2, 4,
+// or 8). libjpeg scales in the DCT domain, so a scaled decode does much less
+// work than a full decode.
+static int GetDecodeFlags(bool gray, int scale) {
+  switch (scale) {
+    case 2:
+      return gray ? cv::IMREAD_REDUCED_GRAYSCALE_2 : cv::IMREAD_REDUCED_COLOR_2;
+    case 4:
+      return gray ? cv::IMREAD_REDUCED_GRAYSCALE_4 : cv::IMREAD_REDUCED_COLOR_4;
+    case 8:
+      return gray ? cv::IMREAD_REDUCED_GRAYSCALE_8 : cv::IMREAD_REDUCED_COLOR_8;
+    default:
+      return gray ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR;
+  }
+}
+
 Image* Frame::GetNearestImage(int width, int height) const {
   if (!m_impl) {
     return nullptr;
@@ -209,194 +231,105 @@ Image* Frame::ConvertImpl(Image* image, wpi::util::PixelFormat pixelFormat,
                           requiredJpegQuality)) {
     return image;
   }
-  Image* cur = image;
+  if (!m_impl) {
+    return nullptr;
+  }
+  std::scoped_lock lock(m_impl->mutex);
 
-  // If the source image is a JPEG, we need to decode it before we can do
-  // anything else with it.  Note that if the destination format is JPEG, we
-  // still need to do this (unless it was already a JPEG, in which case we
-  // would have returned above).
-  if (cur->pixelFormat == wpi::util::PixelFormat::MJPEG) {
-    cur = ConvertMJPEGToBGR(cur);
-    if (pixelFormat == wpi::util::PixelFormat::BGR) {
-      return cur;
+  // Any image of the same size can start the conversion, so intermediates
+  // made for other sinks (e.g. the BGR image between YUYV and JPEG) are
+  // reused.  Only the original JPEG is decoded; decoding one compressed here
+  // would lose quality.
+  Image* original = m_impl->images[0];
+  wpi::util::SmallVector<Image*, 4> starts;
+  wpi::util::SmallVector<wpi::util::PixelFormat, 4> available;
+  starts.push_back(image);
+  available.push_back(image->pixelFormat);
+  for (auto i : m_impl->images) {
+    if (i != image && i->Is(image->width, image->height) &&
+        (i->pixelFormat != wpi::util::PixelFormat::MJPEG || i == original)) {
+      starts.push_back(i);
+      available.push_back(i->pixelFormat);
     }
   }
 
-  // Color convert
+  wpi::util::SmallVector<wpi::util::PixelFormat, 4> path;
+  if (!PlanConversion(original->pixelFormat, available, pixelFormat, path)) {
+    return nullptr;  // Unsupported
+  }
+
+  Image* cur = *std::find_if(starts.begin(), starts.end(),
+                             [&](auto i) { return i->pixelFormat == path[0]; });
+  for (size_t i = 1; i < path.size() && cur; ++i) {
+    cur = ConvertStep(cur, path[i], defaultJpegQuality);
+    ++m_impl->stats.conversions;
+  }
+  return cur;
+}
+
+Image* Frame::ConvertStep(Image* image, wpi::util::PixelFormat pixelFormat,
+                          int jpegQuality) {
   switch (pixelFormat) {
-    case wpi::util::PixelFormat::RGB565:
-      // If source is YUYV, UYVY, Gray, or Y16, need to convert to BGR first
-      if (cur->pixelFormat == wpi::util::PixelFormat::YUYV) {
-        // Check to see if BGR version already exists...
-        if (Image* newImage = GetExistingImage(cur->width, cur->height,
-                                               wpi::util::PixelFormat::BGR)) {
-          cur = newImage;
-        } else {
-          cur = ConvertYUYVToBGR(cur);
-        }
-      } else if (cur->pixelFormat == wpi::util::PixelFormat::UYVY) {
-        // Check to see if BGR version already exists...
-        if (Image* newImage = GetExistingImage(cur->width, cur->height,
-                                               wpi::util::PixelFormat::BGR)) {
-          cur = newImage;
-        } else {
-          cur = ConvertUYVYToBGR(cur);
-        }
-      } else if (cur->pixelFormat == wpi::util::PixelFormat::GRAY) {
-        // Check to see if BGR version already exists...
-        if (Image* newImage = GetExistingImage(cur->width, cur->height,
-                                               wpi::util::PixelFormat::BGR)) {
-          cur = newImage;
-        } else {
-          cur = ConvertGrayToBGR(cur);
-        }
-      } else if (cur->pixelFormat == wpi::util::PixelFormat::Y16) {
-        // Check to see if BGR version already exists...
-        if (Image* newImage = GetExistingImage(cur->width, cur->height,
-                                               wpi::util::PixelFormat::BGR)) {
-          cur = newImage;
-        } else if (Image* newImage = GetExistingImage(
-                       cur->width, cur->height, wpi::util::PixelFormat::GRAY)) {
-          cur = ConvertGrayToBGR(newImage);
-        } else {
-          cur = ConvertGrayToBGR(ConvertY16ToGray(cur));
-        }
+    case wpi::util::PixelFormat::BGR:
+      switch (image->pixelFormat) {
+        case wpi::util::PixelFormat::MJPEG:
+          return ConvertMJPEGToBGR(image);
+        case wpi::util::PixelFormat::YUYV:
+          return ConvertYUYVToBGR(image);
+        case wpi::util::PixelFormat::UYVY:
+          return ConvertUYVYToBGR(image);
+        case wpi::util::PixelFormat::RGB565:
+          return ConvertRGB565ToBGR(image);
+        case wpi::util::PixelFormat::GRAY:
+          return ConvertGrayToBGR(image);
+        default:
+          return nullptr;
       }
-      return ConvertBGRToRGB565(cur);
     case wpi::util::PixelFormat::GRAY:
-    case wpi::util::PixelFormat::Y16:
-      // If source is also grayscale, convert directly
-      if (pixelFormat == wpi::util::PixelFormat::GRAY &&
-          cur->pixelFormat == wpi::util::PixelFormat::Y16) {
-        return ConvertY16ToGray(cur);
-      } else if (pixelFormat == wpi::util::PixelFormat::Y16 &&
-                 cur->pixelFormat == wpi::util::PixelFormat::GRAY) {
-        return ConvertGrayToY16(cur);
-      }
-      // If source is YUYV, UYVY, convert directly to Gray
-      // If RGB565, need to convert to BGR first
-      if (cur->pixelFormat == wpi::util::PixelFormat::YUYV) {
-        cur = ConvertYUYVToGray(cur);
-      } else if (cur->pixelFormat == wpi::util::PixelFormat::UYVY) {
-        cur = ConvertUYVYToGray(cur);
-      } else if (cur->pixelFormat == wpi::util::PixelFormat::RGB565) {
-        // Check to see if BGR version already exists...
-        if (Image* newImage = GetExistingImage(cur->width, cur->height,
-                                               wpi::util::PixelFormat::BGR)) {
-          cur = newImage;
-        } else {
-          cur = ConvertRGB565ToBGR(cur);
-        }
-        cur = ConvertBGRToGray(cur);
+      switch (image->pixelFormat) {
+        case wpi::util::PixelFormat::MJPEG:
+          return ConvertMJPEGToGray(image);
+        case wpi::util::PixelFormat::YUYV:
+          return ConvertYUYVToGray(image);
+        case wpi::util::PixelFormat::UYVY:
+          return ConvertUYVYToGray(image);
+        case wpi::util::PixelFormat::BGR:
+          return ConvertBGRToGray(image);
+        case wpi::util::PixelFormat::Y16:
+          return ConvertY16ToGray(image);
+        default:
+          return nullptr;
       }
-      if (pixelFormat == wpi::util::PixelFormat::Y16) {
-        cur = ConvertGrayToY16(cur);
-      }
-      return cur;
-    case wpi::util::PixelFormat::BGR:
     case wpi::util::PixelFormat::MJPEG:
-      if (cur->pixelFormat == wpi::util::PixelFormat::YUYV) {
-        cur = ConvertYUYVToBGR(cur);
-      } else if (cur->pixelFormat == wpi::util::PixelFormat::UYVY) {
-        cur = ConvertUYVYToBGR(cur);
-      } else if (cur->pixelFormat == wpi::util::PixelFormat::RGB565) {
-        cur = ConvertRGB565ToBGR(cur);
-      } else if (cur->pixelFormat == wpi::util::PixelFormat::GRAY) {
-        if (pixelFormat == wpi::util::PixelFormat::BGR) {
-          return ConvertGrayToBGR(cur);
-        } else {
-          return ConvertGrayToMJPEG(cur, defaultJpegQuality);
-        }
-      } else if (cur->pixelFormat == wpi::util::PixelFormat::Y16) {
-        // Check to see if Gray version already exists...
-        if (Image* newImage = GetExistingImage(cur->width, cur->height,
-                                               wpi::util::PixelFormat::GRAY)) {
-          cur = newImage;
-        } else {
-          cur = ConvertY16ToGray(cur);
-        }
-        if (pixelFormat == wpi::util::PixelFormat::BGR) {
-          return ConvertGrayToBGR(cur);
-        } else {
-          return ConvertGrayToMJPEG(cur, defaultJpegQuality);
-        }
+      if (image->pixelFormat == wpi::util::PixelFormat::GRAY) {
+        return ConvertGrayToMJPEG(image, jpegQuality);
       }
-      break;
+      return ConvertBGRToMJPEG(image, jpegQuality);
+    case wpi::util::PixelFormat::RGB565:
+      return ConvertBGRToRGB565(image);
+    case wpi::util::PixelFormat::Y16:
+      return ConvertGrayToY16(image);
     case wpi::util::PixelFormat::BGRA:
-      // If source is RGB565, YUYV, UYVY, Gray or Y16, need to convert to BGR
-      // first
-      if (cur->pixelFormat == wpi::util::PixelFormat::RGB565) {
-        // Check to see if BGR version already exists...
-        if (Image* newImage = GetExistingImage(cur->width, cur->height,
-                                               wpi::util::PixelFormat::BGR)) {
-          cur = newImage;
-        } else {
-          cur = ConvertRGB565ToBGR(cur);
-        }
-      } else if (cur->pixelFormat == wpi::util::PixelFormat::YUYV) {
-        // Check to see if BGR version already exists...
-        if (Image* newImage = GetExistingImage(cur->width, cur->height,
-                                               wpi::util::PixelFormat::BGR)) {
-          cur = newImage;
-        } else {
-          cur = ConvertYUYVToBGR(cur);
-        }
-      } else if (cur->pixelFormat == wpi::util::PixelFormat::UYVY) {
-        // Check to see if BGR version already exists...
-        if (Image* newImage = GetExistingImage(cur->width, cur->height,
-                                               wpi::util::PixelFormat::BGR)) {
-          cur = newImage;
-        } else {
-          cur = ConvertUYVYToBGR(cur);
-        }
-      } else if (cur->pixelFormat == wpi::util::PixelFormat::GRAY) {
-        // Check to see if BGR version already exists...
-        if (Image* newImage = GetExistingImage(cur->width, cur->height,
-                                               wpi::util::PixelFormat::BGR)) {
-          cur = newImage;
-        } else {
-          cur = ConvertGrayToBGR(cur);
-        }
-      } else if (cur->pixelFormat == wpi::util::PixelFormat::Y16) {
-        // Check to see if BGR version already exists...
-        if (Image* newImage = GetExistingImage(cur->width, cur->height,
-                                               wpi::util::PixelFormat::BGR)) {
-          cur = newImage;
-        } else if (Image* newImage = GetExistingImage(
-                       cur->width, cur->height, wpi::util::PixelFormat::GRAY)) {
-          cur = ConvertGrayToBGR(newImage);
-        } else {
-          cur = ConvertGrayToBGR(ConvertY16ToGray(cur));
-        }
-      }
-      return ConvertBGRToBGRA(cur);
-    case wpi::util::PixelFormat::YUYV:
-    case wpi::util::PixelFormat::UYVY:
+      return ConvertBGRToBGRA(image);
     default:
-      return nullptr;  // Unsupported
-  }
-
-  // Compress if destination is JPEG
-  if (pixelFormat == wpi::util::PixelFormat::MJPEG) {
-    cur = ConvertBGRToMJPEG(cur, defaultJpegQuality);
+      return nullptr;
   }
-
-  return cur;
 }
 
-Image* Frame::ConvertMJPEGToBGR(Image* image) {
+Image* Frame::ConvertMJPEGToBGR(Image* image, int scale) {
   if (!image || image->pixelFormat != wpi::util::PixelFormat::MJPEG) {
     return nullptr;
   }
 
-  // Allocate an BGR image
+  // Allocate an BGR image; a scaled decode rounds the size up
+  int width = (image->width + scale - 1) / scale;
+  int height = (image->height + scale - 1) / scale;
   auto newImage = m_impl->source.AllocImage(wpi::util::PixelFormat::BGR,
-                                            image->width, image->height,
-                                            image->width * image->height * 3);
+                                            width, height, width * height * 3);
 
   // Decode
   cv::Mat newMat = newImage->AsMat();
-  cv::imdecode(image->AsInputArray(), cv::IMREAD_COLOR, &newMat);
+  cv::imdecode(image->AsInputArray(), GetDecodeFlags(false, scale), &newMat);
 
   // Save the result
   Image* rv = newImage.release();
@@ -407,19 +340,20 @@ Image* Frame::ConvertMJPEGToBGR(Image* image) {
   return rv;
 }
 
-Image* Frame::ConvertMJPEGToGray(Image* image) {
+Image* Frame::ConvertMJPEGToGray(Image* image, int scale) {
   if (!image || image->pixelFormat != wpi::util::PixelFormat::MJPEG) {
     return nullptr;
   }
 
-  // Allocate an grayscale image
-  auto newImage =
-      m_impl->source.AllocImage(wpi::util::PixelFormat::GRAY, image->width,
-                                image->height, image->width * image->height);
+  // Allocate an grayscale image; a scaled decode rounds the size up
+  int width = (image->width + scale - 1) / scale;
+  int height = (image->height + scale - 1) / scale;
+  auto newImage = m_impl->source.AllocImage(wpi::util::PixelFormat::GRAY,
+                                            width, height, width * height);
 
   // Decode
   cv::Mat newMat = newImage->AsMat();
-  cv::imdecode(image->AsInputArray(), cv::IMREAD_GRAYSCALE, &newMat);
+  cv::imdecode(image->AsInputArray(), GetDecodeFlags(true, scale), &newMat);
 
   // Save the result
   Image* rv = newImage.release();
@@ -635,6 +569,8 @@ Image* Frame::ConvertBGRToMJPEG(Image* image, int quality) {
   cv::imencode(".jpg", image->AsMat(), newImage->vec(),
                m_impl->compressionParams);
 
+  newImage->jpegQuality = quality;
+
   // Save the result
   Image* rv = newImage.release();
   m_impl->images.push_back(rv);
@@ -670,6 +606,8 @@ Image* Frame::ConvertGrayToMJPEG(Image* image, int quality) {
   cv::imencode(".jpg", image->AsMat(), newImage->vec(),
                m_impl->compressionParams);
 
+  newImage->jpegQuality = quality;
+
   // Save the result
   Image* rv = newImage.release();
   m_impl->images.push_back(rv);
@@ -686,8 +624,11 @@ Image* Frame::ConvertGrayToY16(Image* image) {
                                             image->width, image->height,
                                             image->width * image->height * 2);
 
-  // Convert with linear scaling
-  image->AsMat().convertTo(newImage->AsMat(), CV_16U, 256);
+  // Convert with linear scaling.  AsMat() treats Y16 as two 8-bit channels,
+  // which convertTo() would reallocate, so use a 16-bit header instead.
+  cv::Mat newMat{newImage->height, newImage->width, CV_16UC1,
+                 newImage->data()};
+  image->AsMat().convertTo(newMat, CV_16U, 256);
 
   // Save the result
   Image* rv = newImage.release();
@@ -709,7 +650,8 @@ Image* Frame::ConvertY16ToGray(Image* image) {
                                 image->height, image->width * image->height);
 
   // Scale min to 0 and max to 255
-  cv::normalize(image->AsMat(), newImage->AsMat(), 255, 0, cv::NORM_MINMAX);
+  cv::Mat mat{image->height, image->width, CV_16UC1, image->data()};
+  cv::normalize(mat, newImage->AsMat(), 255, 0, cv::NORM_MINMAX, CV_8U);
 
   // Save the result
   Image* rv = newImage.release();
@@ -749,8 +691,12 @@ Image* Frame::GetImageImpl(int width, int height,
     return nullptr;
   }
   std::scoped_lock lock(m_impl->mutex);
+  ++m_impl->stats.requests;
   Image* cur = GetNearestImage(width, height, pixelFormat, requiredJpegQuality);
   if (!cur || cur->Is(width, height, pixelFormat, requiredJpegQuality)) {
+    if (cur) {
+      ++m_impl->stats.hits;
+    }
     return cur;
   }
 
@@ -759,12 +705,50 @@ Image* Frame::GetImageImpl(int width, int height,
              cur->height, static_cast<int>(cur->pixelFormat), width, height,
              static_cast<int>(pixelFormat));
 
-  // If the source image is a JPEG, we need to decode it before we can do
-  // anything else with it.  Note that if the destination format is JPEG, we
-  // still need to do this (unless the width/height/compression were the same,
-  // in which case we already returned the existing JPEG above).
-  if (cur->pixelFormat == wpi::util::PixelFormat::MJPEG) {
-    cur = ConvertMJPEGToBGR(cur);
+  // Re-encoding a JPEG at a higher quality than it was compressed with makes
+  // it larger without making it any better, so pass it through instead.
+  // Camera images have an unknown quality, so estimate it.
+  if (pixelFormat == wpi::util::PixelFormat::MJPEG &&
+      requiredJpegQuality != -1) {
+    for (auto i : m_impl->images) {
+      if (!i->Is(width, height, wpi::util::PixelFormat::MJPEG)) {
+        continue;
+      }
+      if (i->jpegQuality == -1) {
+        i->jpegQuality = GetJpegQuality(i->str());
+      }
+      if (i->jpegQuality != -1 && i->jpegQuality <= requiredJpegQuality + 5) {
+        ++m_impl->stats.hits;
+        return i;
+      }
+    }
+  }
+
+  auto start = wpi::util::Now();
+
+  // If the source image is a JPEG of a different size, we need to decode it
+  // before we can resize it.  Decode at the smallest 1/2, 1/4, or 1/8 scale
+  // that is at least the requested size, leaving less (or nothing) for
+  // resize to do, and to whichever of BGR and grayscale the conversion to
+  // the output format would go through.  Same-size JPEGs are left to
+  // ConvertImpl.
+  if (cur->pixelFormat == wpi::util::PixelFormat::MJPEG &&
+      !cur->Is(width, height)) {
+    int scale = 8;
+    while (scale > 1 && ((cur->width + scale - 1) / scale < width ||
+                         (cur->height + scale - 1) / scale < height)) {
+      scale /= 2;
+    }
+    wpi::util::PixelFormat decoded[] = {wpi::util::PixelFormat::MJPEG};
+    wpi::util::SmallVector<wpi::util::PixelFormat, 4> path;
+    if (PlanConversion(wpi::util::PixelFormat::MJPEG, decoded, pixelFormat,
+                       path) &&
+        path[1] == wpi::util::PixelFormat::GRAY) {
+      cur = ConvertMJPEGToGray(cur, scale);
+    } else {
+      cur = ConvertMJPEGToBGR(cur, scale);
+    }
+    ++m_impl->stats.conversions;
   }
 
   // Resize
@@ -781,10 +765,13 @@ Image* Frame::GetImageImpl(int width, int height,
     // Save the result
     cur = newImage.release();
     m_impl->images.push_back(cur);
+    ++m_impl->stats.conversions;
   }
 
   // Convert to output format
-  return ConvertImpl(cur, pixelFormat, requiredJpegQuality, defaultJpegQuality);
+  cur = ConvertImpl(cur, pixelFormat, requiredJpegQuality, defaultJpegQuality);
+  m_impl->stats.time += wpi::util::Now() - start;
+  return cur;
 }
 
 bool Frame::GetCv(cv::Mat& image, int width, int height,
@@ -798,6 +785,13 @@ bool Frame::GetCv(cv::Mat& image, int width, int height,
 }
 
 void Frame::ReleaseFrame() {
+  if (m_impl->stats.conversions > 0) {
+    WPI_DEBUG4(Instance::GetInstance().logger,
+               "frame served {} requests ({} existing) with {} conversions "
+               "in {} us",
+               m_impl->stats.requests, m_impl->stats.hits,
+               m_impl->stats.conversions, m_impl->stats.time);
+  }
   for (auto image : m_impl->images) {
     m_impl->source.ReleaseImage(std::unique_ptr<Image>(image));
   }
@@ -31,6 +31,18 @@ class Frame {
  public:
   using Time = uint64_t;
 
+  // Image conversion work done for a frame, shared by all of its sinks
+  struct ConversionStats {
+    // number of GetImage requests
+    int requests = 0;
+    // requests satisfied by an existing image
+    int hits = 0;
+    // decodes, resizes, and color conversions run
+    int conversions = 0;
+    // time spent converting, in microseconds
+    uint64_t time = 0;
+  };
+
  private:
   struct Impl {
     explicit Impl(SourceImpl& source_) : source(source_) {}
@@ -43,6 +55,7 @@ class Frame {
     std::string error;
     wpi::util::SmallVector<Image*, 4> images;
     std::vector<int> compressionParams;
+    ConversionStats stats;
   };
 
  public:
@@ -132,6 +145,14 @@ class Frame {
     return m_impl->images[0]->jpegQuality;
   }
 
+  ConversionStats GetConversionStats() const {
+    if (!m_impl) {
+      return {};
+    }
+    std::scoped_lock lock(m_impl->mutex);
+    return m_impl->stats;
+  }
+
   Image* GetExistingImage(size_t i = 0) const {
     if (!m_impl) {
       return nullptr;
@@ -201,8 +222,9 @@ class Frame {
     return ConvertImpl(image, wpi::util::PixelFormat::MJPEG, requiredQuality,
                        defaultQuality);
   }
-  Image* ConvertMJPEGToBGR(Image* image);
-  Image* ConvertMJPEGToGray(Image* image);
+  // scale of 2, 4, or 8 decodes at reduced size (rounded up)
+  Image* ConvertMJPEGToBGR(Image* image, int scale = 1);
+  Image* ConvertMJPEGToGray(Image* image, int scale = 1);
   Image* ConvertYUYVToBGR(Image* image);
   Image* ConvertYUYVToGray(Image* image);
   Image* ConvertUYVYToBGR(Image* image);
@@ -238,6 +260,9 @@ class Frame {
  private:
   Image* ConvertImpl(Image* image, wpi::util::PixelFormat pixelFormat,
                      int requiredJpegQuality, int defaultJpegQuality);
+  // runs a single conversion kernel
+  Image* ConvertStep(Image* image, wpi::util::PixelFormat pixelFormat,
+                     int jpegQuality);
   Image* GetImageImpl(int width, int height, wpi::util::PixelFormat pixelFormat,
                       int requiredJpegQuality, int defaultJpegQuality);
   void DecRef() {
@@ -4,6 +4,8 @@
 
 #include "HttpCameraImpl.hpp"
 
+#include <chrono>
+#include <cstring>
 #include <format>
 #include <memory>
 #include <string>
@@ -16,149 +18,107 @@
 #include "Notifier.hpp"
 #include "Telemetry.hpp"
 #include "c_util.hpp"
-#include "wpi/net/TCPConnector.h"
+#include "wpi/net/EventLoopRunner.hpp"
+#include "wpi/net/uv/GetAddrInfo.hpp"
+#include "wpi/net/uv/Tcp.hpp"
+#include "wpi/net/uv/Timer.hpp"
+#include "wpi/net/uv/util.hpp"
 #include "wpi/util/StringExtras.hpp"
+#include "wpi/util/raw_ostream.hpp"
 #include "wpi/util/string.hpp"
 #include "wpi/util/timestamp.hpp"
 
 using namespace wpi::cs;
+namespace uv = wpi::net::uv;
 
-HttpCameraImpl::HttpCameraImpl(std::string_view name, CS_HttpCameraKind kind,
-                               wpi::util::Logger& logger, Notifier& notifier,
-                               Telemetry& telemetry)
-    : SourceImpl{name, logger, notifier, telemetry}, m_kind{kind} {}
+// time between connection attempts
+static constexpr uv::Timer::Time kRetryTime{250};
 
-HttpCameraImpl::~HttpCameraImpl() {
-  m_active = false;
+// time between checks for a hung stream
+static constexpr uv::Timer::Time kMonitorTime{1000};
 
-  // force wakeup of monitor thread
-  m_monitorCond.notify_one();
+// minimum free space to read stream data into
+static constexpr size_t kReadSize = 16384;
 
-  // join monitor thread
-  if (m_monitorThread.joinable()) {
-    m_monitorThread.join();
-  }
+HttpCameraImpl::HttpCameraImpl(std::string_view name, CS_HttpCameraKind kind,
+                               wpi::util::Logger& logger, Notifier& notifier,
+                               Telemetry& telemetry,
+                               wpi::net::EventLoopRunner& eventLoop)
+    : SourceImpl{name, logger, notifier, telemetry},
+      m_eventLoop{eventLoop},
+      m_kind{kind} {}
 
-  // Close file if it's open
-  {
-    std::scoped_lock lock(m_mutex);
-    if (m_streamConn) {
-      m_streamConn->stream->close();
+HttpCameraImpl::~HttpCameraImpl() {
+  // Loop callbacks reference this, so wait for the stream and timers to be
+  // closed (this runs immediately if called from the loop thread)
+  m_eventLoop.ExecSync([this](uv::Loop&) {
+    StreamClose();
+    if (m_retryTimer) {
+      m_retryTimer->Close();
     }
-    if (m_settingsConn) {
-      m_settingsConn->stream->close();
+    if (m_monitorTimer) {
+      m_monitorTimer->Close();
     }
-  }
-
-  // force wakeup of camera thread in case it's waiting on cv
-  m_sinkEnabledCond.notify_one();
-
-  // join camera thread
-  if (m_streamThread.joinable()) {
-    m_streamThread.join();
-  }
-
-  // force wakeup of settings thread
-  m_settingsCond.notify_one();
-
-  // join settings thread
-  if (m_settingsThread.joinable()) {
-    m_settingsThread.join();
-  }
+  });
 }
 
 void HttpCameraImpl::Start() {
-  // Kick off the stream and settings threads
-  m_streamThread = std::thread(&HttpCameraImpl::StreamThreadMain, this);
-  m_settingsThread = std::thread(&HttpCameraImpl::SettingsThreadMain, this);
-  m_monitorThread = std::thread(&HttpCameraImpl::MonitorThreadMain, this);
+  m_eventLoop.ExecAsync([this](uv::Loop& loop) { StreamStart(loop); });
 }
 
-void HttpCameraImpl::MonitorThreadMain() {
-  while (m_active) {
-    std::unique_lock lock(m_mutex);
-    // sleep for 1 second between checks
-    m_monitorCond.wait_for(lock, std::chrono::seconds(1),
-                           [=, this] { return !m_active; });
-
-    if (!m_active) {
-      break;
-    }
-
-    // check to see if we got any frames, and close the stream if not
-    // (this will result in an error at the read point, and ultimately
-    // a reconnect attempt)
-    if (m_streamConn && m_frameCount == 0) {
-      SWARNING("Monitor detected stream hung, disconnecting");
-      m_streamConn->stream->close();
-    }
-
-    // reset the frame counter
-    m_frameCount = 0;
+void HttpCameraImpl::StreamStart(uv::Loop& loop) {
+  m_retryTimer = uv::Timer::Create(loop);
+  m_monitorTimer = uv::Timer::Create(loop);
+  if (!m_retryTimer || !m_monitorTimer) {
+    SERROR("could not create timers");
+    return;
   }
-
-  SDEBUG("Monitor Thread exiting");
+  m_retryTimer->timeout.connect([this] { StreamConnect(); });
+  m_monitorTimer->timeout.connect([this] { MonitorCheck(); });
+  m_monitorTimer->Start(kMonitorTime, kMonitorTime);
+  m_retryTimer->Start(kRetryTime);
 }
 
-void HttpCameraImpl::StreamThreadMain() {
-  while (m_active) {
-    SetConnected(false);
-
-    // sleep between retries
-    std::this_thread::sleep_for(std::chrono::milliseconds(250));
-
-    // disconnect if not enabled
-    if (!IsEnabled()) {
-      std::unique_lock lock(m_mutex);
-      if (m_streamConn) {
-        m_streamConn->stream->close();
-      }
-      // Wait for enable
-      m_sinkEnabledCond.wait(lock,
-                             [=, this] { return !m_active || IsEnabled(); });
-      if (!m_active) {
-        return;
-      }
-    }
-
-    // connect
-    wpi::util::SmallString<64> boundary;
-    wpi::net::HttpConnection* conn = DeviceStreamConnect(boundary);
-
-    if (!m_active) {
-      break;
-    }
-
-    // keep retrying
-    if (!conn) {
-      continue;
-    }
+void HttpCameraImpl::MonitorCheck() {
+  // check to see if we got any frames, and close the stream if not
+  // (this will result in a reconnect attempt)
+  if (m_streamTcp && m_frameCount == 0) {
+    SWARNING("Monitor detected stream hung, disconnecting");
+    StreamDisconnect();
+  }
 
-    // update connected since we're actually connected
-    SetConnected(true);
+  // reset the frame counter
+  m_frameCount = 0;
+}
 
-    // stream
-    DeviceStream(conn->is, boundary.str());
-    {
-      std::unique_lock lock(m_mutex);
-      m_streamConn = nullptr;
+void HttpCameraImpl::StreamUpdate() {
+  if (!m_retryTimer) {
+    return;  // not started yet
+  }
+  if (m_streamTcp || m_streamResolver) {
+    // disconnect if not enabled or the stream settings changed
+    if (!IsEnabled() || m_streamSettingsUpdated) {
+      StreamDisconnect();
     }
+  } else if (!m_retryTimer->IsActive()) {
+    StreamConnect();
   }
-
-  SDEBUG("Camera Thread exiting");
-  SetConnected(false);
 }
 
-wpi::net::HttpConnection* HttpCameraImpl::DeviceStreamConnect(
-    wpi::util::SmallVectorImpl<char>& boundary) {
+void HttpCameraImpl::StreamConnect() {
+  // wait for enable if not enabled (StreamUpdate() is called on change)
+  if (m_streamTcp || m_streamResolver || !IsEnabled()) {
+    return;
+  }
+
   // Build the request
   wpi::net::HttpRequest req;
   {
     std::scoped_lock lock(m_mutex);
     if (m_locations.empty()) {
       SERROR("locations array is empty!?");
-      std::this_thread::sleep_for(std::chrono::seconds(1));
-      return nullptr;
+      m_retryTimer->Start(std::chrono::seconds(1));
+      return;
     }
     if (m_nextLocation >= m_locations.size()) {
       m_nextLocation = 0;
@@ -168,164 +128,134 @@ wpi::net::HttpConnection* HttpCameraImpl::DeviceStreamConnect(
     m_streamSettingsUpdated = false;
   }
 
-  // Try to connect
-  auto stream =
-      wpi::net::TCPConnector::connect(req.host.c_str(), req.port, m_logger, 1);
-
-  if (!m_active || !stream) {
-    return nullptr;
+  m_streamHost = req.host.str();
+  m_streamPort = req.port;
+  m_streamRequest.clear();
+  wpi::util::raw_string_ostream os{m_streamRequest};
+  os << "GET /" << req.path << " HTTP/1.1\r\n";
+  os << "Host: " << req.host << "\r\n";
+  if (!req.auth.empty()) {
+    os << "Authorization: Basic " << req.auth << "\r\n";
   }
+  os << "\r\n";
+  os.flush();
 
-  auto connPtr =
-      std::make_unique<wpi::net::HttpConnection>(std::move(stream), 1);
-  wpi::net::HttpConnection* conn = connPtr.get();
+  m_frameCount = 1;  // give the connection a full monitor period
 
-  // update m_streamConn
-  {
-    std::scoped_lock lock(m_mutex);
-    m_frameCount = 1;  // avoid a race with monitor thread
-    m_streamConn = std::move(connPtr);
-  }
-
-  std::string warn;
-  if (!conn->Handshake(req, &warn)) {
-    SWARNING("{}", warn);
-    std::scoped_lock lock(m_mutex);
-    m_streamConn = nullptr;
-    return nullptr;
-  }
-
-  // Parse Content-Type header to get the boundary
-  auto [mediaType, contentType] =
-      wpi::util::split(conn->contentType.str(), ';');
-  mediaType = wpi::util::trim(mediaType);
-  if (mediaType != "multipart/x-mixed-replace") {
-    SWARNING("\"{}\": unrecognized Content-Type \"{}\"", req.host.str(),
-             mediaType);
-    std::scoped_lock lock(m_mutex);
-    m_streamConn = nullptr;
-    return nullptr;
-  }
-
-  // media parameters
-  boundary.clear();
-  while (!contentType.empty()) {
-    std::string_view keyvalue;
-    std::tie(keyvalue, contentType) = wpi::util::split(contentType, ';');
-    contentType = wpi::util::ltrim(contentType);
-    auto [key, value] = wpi::util::split(keyvalue, '=');
-    if (wpi::util::trim(key) == "boundary") {
-      value =
-          wpi::util::trim(wpi::util::trim(value), '"');  // value may be quoted
-      if (wpi::util::starts_with(value, "--")) {
-        value = wpi::util::substr(value, 2);
-      }
-      boundary.append(value.begin(), value.end());
-    }
+  // Connect directly to numeric addresses; otherwise look up the name
+  sockaddr_in addr;
+  if (uv::NameToAddr(m_streamHost, m_streamPort, &addr) == 0) {
+    StreamTcpConnect(reinterpret_cast<const sockaddr&>(addr));
+    return;
   }
 
-  if (boundary.empty()) {
-    SWARNING("\"{}\": empty multi-part boundary or no Content-Type",
-             req.host.str());
-    std::scoped_lock lock(m_mutex);
-    m_streamConn = nullptr;
-    return nullptr;
+  m_streamResolver = std::make_shared<uv::GetAddrInfoReq>();
+  m_streamResolver->resolved.connect([this](const addrinfo& ai) {
+    m_streamResolver.reset();
+    StreamTcpConnect(*ai.ai_addr);
+  });
+  m_streamResolver->error = [this](uv::Error err) {
+    SERROR("could not resolve {} address: {}", m_streamHost, err.str());
+    StreamDisconnect();
+  };
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_protocol = IPPROTO_TCP;
+  hints.ai_flags = AI_NUMERICSERV;
+  uv::GetAddrInfo(m_retryTimer->GetLoopRef(), m_streamResolver, m_streamHost,
+                  std::format("{}", m_streamPort), hints);
+}
+
+void HttpCameraImpl::StreamTcpConnect(const sockaddr& addr) {
+  m_streamTcp = uv::Tcp::Create(m_retryTimer->GetLoopRef());
+  if (!m_streamTcp) {
+    StreamDisconnect();
+    return;
   }
-
-  return conn;
-}
-
-void HttpCameraImpl::DeviceStream(wpi::util::raw_istream& is,
-                                  std::string_view boundary) {
-  // Stored here so we reuse it from frame to frame
-  std::string imageBuf;
-
-  // keep track of number of bad images received; if we receive 3 bad images
-  // in a row, we reconnect
-  int numErrors = 0;
-
-  // streaming loop
-  while (m_active && !is.has_error() && IsEnabled() && numErrors < 3 &&
-         !m_streamSettingsUpdated) {
-    if (!wpi::net::FindMultipartBoundary(is, boundary, nullptr)) {
-      break;
-    }
-
-    // Read the next two characters after the boundary (normally \r\n)
-    // Handle just \n for LabVIEW however
-    char eol[2];
-    is.read(eol, 1);
-    if (!m_active || is.has_error()) {
-      break;
+  m_streamOpen = false;
+  m_streamParser.Reset();
+  m_numErrors = 0;
+
+  // read directly into the parser buffer
+  m_streamTcp->SetBufferAllocator(
+      [this](size_t) {
+        auto buf = m_streamParser.GetBuffer(kReadSize);
+        return uv::Buffer{buf.data(), buf.size()};
+      },
+      [](uv::Buffer&) {});
+
+  m_streamTcp->error.connect([this](uv::Error err) {
+    if (m_streamOpen) {
+      SDEBUG("stream error: {}", err.str());
+    } else {
+      SERROR("connect() to {} port {} failed: {}", m_streamHost, m_streamPort,
+             err.str());
     }
-    if (eol[0] != '\n') {
-      is.read(eol + 1, 1);
-      if (!m_active || is.has_error()) {
+    StreamDisconnect();
+  });
+  m_streamTcp->end.connect([this] { StreamDisconnect(); });
+  m_streamTcp->data.connect(
+      [this](uv::Buffer&, size_t len) { StreamData(len); });
+
+  m_streamTcp->Connect(addr, [this] {
+    m_streamOpen = true;
+    m_streamTcp->Write({uv::Buffer{m_streamRequest}},
+                       [](auto bufs, uv::Error) {});
+    m_streamTcp->StartRead();
+  });
+}
+
+void HttpCameraImpl::StreamData(size_t len) {
+  m_streamParser.Commit(len);
+  for (;;) {
+    switch (m_streamParser.Next()) {
+      case MjpegStreamParser::kNeedData:
+        return;
+      case MjpegStreamParser::kResponse:
+        // update connected since we're actually connected
+        SetConnected(true);
         break;
-      }
-      // End-of-stream is indicated with trailing --
-      if (eol[0] == '-' && eol[1] == '-') {
+      case MjpegStreamParser::kFrame:
+        if (StreamFrame(m_streamParser.GetFrame())) {
+          m_numErrors = 0;
+        } else {
+          ++m_numErrors;
+        }
+        break;
+      case MjpegStreamParser::kFrameError: {
+        auto errMsg = m_streamParser.GetError();
+        SWARNING("{}", errMsg);
+        PutError(errMsg, wpi::util::Now());
+        ++m_numErrors;
         break;
       }
+      case MjpegStreamParser::kStreamError:
+        SWARNING("\"{}\": {}", m_streamHost, m_streamParser.GetError());
+        StreamDisconnect();
+        return;
+      case MjpegStreamParser::kEnd:
+        StreamDisconnect();
+        return;
     }
 
-    if (!DeviceStreamFrame(is, imageBuf)) {
-      ++numErrors;
-    } else {
-      numErrors = 0;
+    if (m_numErrors >= 3 || !IsEnabled() || m_streamSettingsUpdated) {
+      StreamDisconnect();
+      return;
     }
   }
 }
 
-bool HttpCameraImpl::DeviceStreamFrame(wpi::util::raw_istream& is,
-                                       std::string& imageBuf) {
-  // Read the headers
-  wpi::util::SmallString<64> contentTypeBuf;
-  wpi::util::SmallString<64> contentLengthBuf;
-  if (!wpi::net::ParseHttpHeaders(is, &contentTypeBuf, &contentLengthBuf)) {
-    SWARNING("disconnected during headers");
-    PutError("disconnected during headers", wpi::util::Now());
-    return false;
-  }
-
-  // Check the content type (if present)
-  if (!contentTypeBuf.str().empty() &&
-      !wpi::util::starts_with(contentTypeBuf, "image/jpeg")) {
-    auto errMsg = std::format("received unknown Content-Type \"{}\"",
-                              contentTypeBuf.str());
-    SWARNING("{}", errMsg);
-    PutError(errMsg, wpi::util::Now());
-    return false;
-  }
-
+bool HttpCameraImpl::StreamFrame(std::string_view data) {
   int width, height;
-  if (auto v = wpi::util::parse_integer<unsigned int>(contentLengthBuf, 10)) {
-    // We know how big it is!  Just get a frame of the right size and read
-    // the data directly into it.
-    unsigned int contentLength = v.value();
-    auto image = AllocImage(wpi::util::PixelFormat::MJPEG, 0, 0, contentLength);
-    is.read(image->data(), contentLength);
-    if (!m_active || is.has_error()) {
-      return false;
-    }
-    if (!GetJpegSize(image->str(), &width, &height)) {
-      SWARNING("did not receive a JPEG image");
-      PutError("did not receive a JPEG image", wpi::util::Now());
-      return false;
-    }
-    image->width = width;
-    image->height = height;
-    PutFrame(std::move(image), wpi::util::Now());
-  } else {
-    // Ugh, no Content-Length?  Read the blocks of the JPEG file.
-    if (!ReadJpeg(is, imageBuf, &width, &height)) {
-      SWARNING("did not receive a JPEG image");
-      PutError("did not receive a JPEG image", wpi::util::Now());
-      return false;
-    }
-    PutFrame(wpi::util::PixelFormat::MJPEG, width, height, imageBuf,
-             wpi::util::Now());
+  if (!GetJpegSize(data, &width, &height)) {
+    SWARNING("did not receive a JPEG image");
+    PutError("did not receive a JPEG image", wpi::util::Now());
+    return false;
   }
+  PutFrame(wpi::util::PixelFormat::MJPEG, width, height, data,
+           wpi::util::Now());
 
   ++m_frameCount;
 
@@ -340,54 +270,31 @@ bool HttpCameraImpl::DeviceStreamFrame(wpi::util::raw_istream& is,
   return true;
 }
 
-void HttpCameraImpl::SettingsThreadMain() {
-  for (;;) {
-    wpi::net::HttpRequest req;
-    {
-      std::unique_lock lock(m_mutex);
-      m_settingsCond.wait(lock, [=, this] {
-        return !m_active || (m_prefLocation != -1 && !m_settings.empty());
-      });
-      if (!m_active) {
-        break;
-      }
-
-      // Build the request
-      req = wpi::net::HttpRequest{m_locations[m_prefLocation], m_settings};
-    }
-
-    DeviceSendSettings(req);
-  }
+void HttpCameraImpl::StreamDisconnect() {
+  StreamClose();
+  SetConnected(false);
 
-  SDEBUG("Settings Thread exiting");
+  // sleep between retries
+  m_retryTimer->Start(kRetryTime);
 }
 
-void HttpCameraImpl::DeviceSendSettings(wpi::net::HttpRequest& req) {
-  // Try to connect
-  auto stream =
-      wpi::net::TCPConnector::connect(req.host.c_str(), req.port, m_logger, 1);
-
-  if (!m_active || !stream) {
-    return;
+void HttpCameraImpl::StreamClose() {
+  // disconnect first so callbacks for requests cancelled by closing are
+  // ignored
+  if (m_streamResolver) {
+    m_streamResolver->resolved.disconnect_all();
+    m_streamResolver->error = [](uv::Error) {};
+    m_streamResolver->Cancel();
+    m_streamResolver.reset();
   }
-
-  auto connPtr =
-      std::make_unique<wpi::net::HttpConnection>(std::move(stream), 1);
-  wpi::net::HttpConnection* conn = connPtr.get();
-
-  // update m_settingsConn
-  {
-    std::scoped_lock lock(m_mutex);
-    m_settingsConn = std::move(connPtr);
-  }
-
-  // Just need a handshake as settings are sent via GET parameters
-  std::string warn;
-  if (!conn->Handshake(req, &warn)) {
-    SWARNING("{}", warn);
+  if (m_streamTcp) {
+    m_streamTcp->error.disconnect_all();
+    m_streamTcp->end.disconnect_all();
+    m_streamTcp->data.disconnect_all();
+    m_streamTcp->Close();
+    m_streamTcp.reset();
   }
-
-  conn->stream->close();
+  m_streamOpen = false;
 }
 
 CS_HttpCameraKind HttpCameraImpl::GetKind() const {
@@ -409,10 +316,13 @@ bool HttpCameraImpl::SetUrls(std::span<const std::string> urls,
     }
   }
 
-  std::scoped_lock lock(m_mutex);
-  m_locations.swap(locations);
-  m_nextLocation = 0;
-  m_streamSettingsUpdated = true;
+  {
+    std::scoped_lock lock(m_mutex);
+    m_locations.swap(locations);
+    m_nextLocation = 0;
+    m_streamSettingsUpdated = true;
+  }
+  m_eventLoop.ExecAsync([this](uv::Loop&) { StreamUpdate(); });
   return true;
 }
 
@@ -537,6 +447,7 @@ bool HttpCameraImpl::SetVideoMode(const VideoMode& mode, CS_Status* status) {
     m_streamSettings["fps"] = std::format("{}", mode.fps);
   }
   m_streamSettingsUpdated = true;
+  m_eventLoop.ExecAsync([this](uv::Loop&) { StreamUpdate(); });
   return true;
 }
 
@@ -545,7 +456,7 @@ void HttpCameraImpl::NumSinksChanged() {
 }
 
 void HttpCameraImpl::NumSinksEnabledChanged() {
-  m_sinkEnabledCond.notify_one();
+  m_eventLoop.ExecAsync([this](uv::Loop&) { StreamUpdate(); });
 }
 
 namespace wpi::cs {
@@ -553,8 +464,8 @@ namespace wpi::cs {
 CS_Source CreateHttpCamera(std::string_view name, std::string_view url,
                            CS_HttpCameraKind kind, CS_Status* status) {
   auto& inst = Instance::GetInstance();
-  auto source = std::make_shared<HttpCameraImpl>(name, kind, inst.logger,
-                                                 inst.notifier, inst.telemetry);
+  auto source = std::make_shared<HttpCameraImpl>(
+      name, kind, inst.logger, inst.notifier, inst.telemetry, inst.eventLoop);
   std::string urlStr{url};
   if (!source->SetUrls(std::span{&urlStr, 1}, status)) {
     return 0;
@@ -570,8 +481,8 @@ CS_Source CreateHttpCamera(std::string_view name,
     *status = CS_EMPTY_VALUE;
     return 0;
   }
-  auto source = std::make_shared<HttpCameraImpl>(name, kind, inst.logger,
-                                                 inst.notifier, inst.telemetry);
+  auto source = std::make_shared<HttpCameraImpl>(
+      name, kind, inst.logger, inst.notifier, inst.telemetry, inst.eventLoop);
   if (!source->SetUrls(urls, status)) {
     return 0;
   }
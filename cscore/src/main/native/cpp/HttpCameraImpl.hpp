@@ -10,24 +10,39 @@
 #include <span>
 #include <string>
 #include <string_view>
-#include <thread>
 #include <vector>
 
+#include "MjpegStreamParser.hpp"
 #include "SourceImpl.hpp"
 #include "wpi/cs/VideoMode.hpp"
 #include "wpi/cs/cscore_c.h"
 #include "wpi/net/HttpUtil.hpp"
 #include "wpi/util/StringMap.hpp"
-#include "wpi/util/condition_variable.hpp"
-#include "wpi/util/raw_istream.hpp"
+
+struct sockaddr;
+
+namespace wpi::net {
+class EventLoopRunner;
+}  // namespace wpi::net
+
+namespace wpi::net::uv {
+class GetAddrInfoReq;
+class Loop;
+class Tcp;
+class Timer;
+}  // namespace wpi::net::uv
 
 namespace wpi::cs {
 
+// All cameras share a single event loop thread (Instance::eventLoop), which
+// handles connecting, reading, and parsing the stream and monitoring for hung
+// connections.
+
 class HttpCameraImpl : public SourceImpl {
  public:
   HttpCameraImpl(std::string_view name, CS_HttpCameraKind kind,
                  wpi::util::Logger& logger, Notifier& notifier,
-                 Telemetry& telemetry);
+                 Telemetry& telemetry, wpi::net::EventLoopRunner& eventLoop);
   ~HttpCameraImpl() override;
 
   void Start() override;
@@ -94,53 +109,49 @@ class HttpCameraImpl : public SourceImpl {
                           std::initializer_list<T> choices) const;
 
  private:
-  // The camera streaming thread
-  void StreamThreadMain();
+  // Functions run on the event loop
+  void StreamStart(wpi::net::uv::Loop& loop);
+  void StreamUpdate();
+  void StreamConnect();
+  void StreamTcpConnect(const sockaddr& addr);
+  void StreamData(size_t len);
+  bool StreamFrame(std::string_view data);
+  void StreamDisconnect();
+  void StreamClose();
+  void MonitorCheck();
+
+  wpi::net::EventLoopRunner& m_eventLoop;
 
-  // Functions used by StreamThreadMain()
-  wpi::net::HttpConnection* DeviceStreamConnect(
-      wpi::util::SmallVectorImpl<char>& boundary);
-  void DeviceStream(wpi::util::raw_istream& is, std::string_view boundary);
-  bool DeviceStreamFrame(wpi::util::raw_istream& is, std::string& imageBuf);
+  //
+  // Variables only accessed from the event loop
+  //
 
-  // The camera settings thread
-  void SettingsThreadMain();
-  void DeviceSendSettings(wpi::net::HttpRequest& req);
+  std::shared_ptr<wpi::net::uv::Timer> m_retryTimer;
+  std::shared_ptr<wpi::net::uv::Timer> m_monitorTimer;
+  std::shared_ptr<wpi::net::uv::GetAddrInfoReq> m_streamResolver;
+  std::shared_ptr<wpi::net::uv::Tcp> m_streamTcp;
+  bool m_streamOpen = false;
+  std::string m_streamHost;
+  unsigned int m_streamPort = 0;
+  std::string m_streamRequest;
+  MjpegStreamParser m_streamParser;
 
-  // The monitor thread
-  void MonitorThreadMain();
+  // number of bad images received in a row; if we receive 3, we reconnect
+  int m_numErrors = 0;
 
-  std::atomic_bool m_connected{false};
-  std::atomic_bool m_active{true};  // set to false to terminate thread
-  std::thread m_streamThread;
-  std::thread m_settingsThread;
-  std::thread m_monitorThread;
+  int m_frameCount = 0;
 
   //
   // Variables protected by m_mutex
   //
 
-  // The camera connections
-  std::unique_ptr<wpi::net::HttpConnection> m_streamConn;
-  std::unique_ptr<wpi::net::HttpConnection> m_settingsConn;
-
   CS_HttpCameraKind m_kind;
 
   std::vector<wpi::net::HttpLocation> m_locations;
   size_t m_nextLocation{0};
-  int m_prefLocation{-1};  // preferred location
-
-  std::atomic_int m_frameCount{0};
-
-  wpi::util::condition_variable m_sinkEnabledCond;
-
-  wpi::util::StringMap<std::string> m_settings;
-  wpi::util::condition_variable m_settingsCond;
 
   wpi::util::StringMap<std::string> m_streamSettings;
   std::atomic_bool m_streamSettingsUpdated{false};
-
-  wpi::util::condition_variable m_monitorCond;
 };
 
 }  // namespace wpi::cs
@@ -4,6 +4,7 @@
 
 #include "JpegUtil.hpp"
 
+#include <algorithm>
 #include <string>
 
 #include "wpi/util/StringExtras.hpp"
@@ -49,6 +50,14 @@ static const unsigned char dhtData[] = {
     0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7,
     0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa};
 
+// Standard luminance quantization table (JPEG spec Annex K); the IJG quality
+// setting scales this table.
+static constexpr unsigned char stdLuminanceQuantTbl[64] = {
+    16, 11, 10, 16, 24,  40,  51,  61,  12, 12, 14, 19, 26,  58,  60,  55,
+    14, 13, 16, 24, 40,  57,  69,  56,  14, 17, 22, 29, 51,  87,  80,  62,
+    18, 22, 37, 56, 68,  109, 103, 77,  24, 35, 55, 64, 81,  104, 113, 92,
+    49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99};
+
 bool IsJpeg(std::string_view data) {
   if (data.size() < 11) {
     return false;
@@ -96,6 +105,64 @@ bool GetJpegSize(std::string_view data, int* width, int* height) {
   }
 }
 
+int GetJpegQuality(std::string_view data) {
+  if (!IsJpeg(data)) {
+    return -1;
+  }
+
+  data = wpi::util::substr(data, 2);  // Get to the first block
+  for (;;) {
+    if (data.size() < 4) {
+      return -1;  // EOF
+    }
+    auto bytes = reinterpret_cast<const unsigned char*>(data.data());
+    if (bytes[0] != 0xff) {
+      return -1;  // not a tag
+    }
+    if (bytes[1] == 0xd9 || bytes[1] == 0xda) {
+      return -1;  // EOI or SOS without finding DQT
+    }
+    size_t len = bytes[2] * 256 + bytes[3] + 2;
+    if (bytes[1] == 0xdb) {
+      // DQT may contain multiple tables, each with a precision/id byte
+      auto tables = wpi::util::substr(data.substr(0, len), 4);
+      while (!tables.empty()) {
+        auto table = reinterpret_cast<const unsigned char*>(tables.data());
+        bool wide = (table[0] >> 4) != 0;
+        size_t tableLen = 1 + (wide ? 128 : 64);
+        if (tables.size() < tableLen) {
+          return -1;
+        }
+        if ((table[0] & 0x0f) == 0) {
+          // Luminance table. The table is in zigzag order, but the sums are
+          // independent of order.
+          unsigned int sum = 0;
+          unsigned int stdSum = 0;
+          for (int i = 0; i < 64; ++i) {
+            sum += wide ? table[1 + i * 2] * 256 + table[2 + i * 2]
+                        : table[1 + i];
+            stdSum += stdLuminanceQuantTbl[i];
+          }
+          // Invert the IJG quality scaling
+          unsigned int scale = (sum * 100 + stdSum / 2) / stdSum;
+          int quality;
+          if (scale == 0) {
+            quality = 100;
+          } else if (scale <= 100) {
+            quality = (200 - scale + 1) / 2;
+          } else {
+            quality = 5000 / scale;
+          }
+          return std::clamp(quality, 1, 100);
+        }
+        tables = wpi::util::substr(tables, tableLen);
+      }
+    }
+    // Go to the next block
+    data = wpi::util::substr(data, len);
+  }
+}
+
 bool JpegNeedsDHT(const char* data, size_t* size, size_t* locSOF) {
   std::string_view sdata(data, *size);
   if (!IsJpeg(sdata)) {
@@ -17,6 +17,15 @@ bool IsJpeg(std::string_view data);
 
 bool GetJpegSize(std::string_view data, int* width, int* height);
 
+/**
+ * Estimates the quality (1-100) a JPEG was compressed with, by comparing its
+ * luminance quantization table to the standard table that the IJG quality
+ * setting scales.
+ *
+ * @return quality, or -1 if the image has no luminance quantization table
+ */
+int GetJpegQuality(std::string_view data);
+
 bool JpegNeedsDHT(const char* data, size_t* size, size_t* locSOF);
 
 std::string_view JpegGetDHT();
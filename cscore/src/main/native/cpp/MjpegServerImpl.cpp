@@ -684,6 +684,8 @@ void MjpegServerImpl::ConnThread::SendStream(wpi::net::raw_socket_ostream& os) {
   SDEBUG("Headers send, sending stream now");
 
   Frame::Time lastFrameTime = 0;
+  // most recent frame seen, including dropped and error frames
+  Frame::Time lastSeenTime = 0;
   Frame::Time timePerFrame = 0;
   if (m_fps != 0) {
     timePerFrame = 1000000.0 / m_fps;
@@ -704,10 +706,12 @@ void MjpegServerImpl::ConnThread::SendStream(wpi::net::raw_socket_ostream& os) {
       continue;
     }
     SDEBUG4("waiting for frame");
-    Frame frame = source->GetNextFrame(0.225);  // blocks
+    // don't miss a frame that arrived while the last one was being sent
+    Frame frame = source->GetNextFrame(0.225, lastSeenTime);  // blocks
     if (!m_active) {
       break;
     }
+    lastSeenTime = frame.GetTime();
     if (!frame) {
       // Bad frame; sleep for 20 ms so we don't consume all processor time.
       os << "\r\n";  // Keep connection alive
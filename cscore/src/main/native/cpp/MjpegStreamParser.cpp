@@ -0,0 +1,382 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "MjpegStreamParser.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <string>
+#include <tuple>
+
+#include "wpi/util/StringExtras.hpp"
+
+using namespace wpi::cs;
+
+// longest header line accepted
+static constexpr size_t kMaxLineLength = 1024;
+
+// largest image accepted
+static constexpr size_t kMaxImageSize = 32 * 1024 * 1024;
+
+void MjpegStreamParser::Reset() {
+  m_begin = 0;
+  m_end = 0;
+  m_needed = 0;
+  m_state = State::kStatus;
+  m_boundary.clear();
+  m_frame = {};
+  m_error.clear();
+  m_field = Field::kOther;
+  m_contentType.clear();
+  m_contentLength.clear();
+}
+
+std::span<char> MjpegStreamParser::GetBuffer(size_t minSize) {
+  size_t len = m_end - m_begin;
+  size_t needed = std::max(minSize, m_needed > len ? m_needed - len : 0);
+  if (m_capacity - m_end < needed) {
+    if (m_capacity - len < needed) {
+      // grow, moving unparsed data to the start of the new buffer
+      size_t capacity = std::max(m_capacity * 2, len + needed);
+      auto buf = std::make_unique_for_overwrite<char[]>(capacity);
+      if (len > 0) {
+        std::memcpy(buf.get(), m_buf.get() + m_begin, len);
+      }
+      m_buf = std::move(buf);
+      m_capacity = capacity;
+    } else {
+      // move unparsed data to the start of the buffer
+      std::memmove(m_buf.get(), m_buf.get() + m_begin, len);
+    }
+    m_begin = 0;
+    m_end = len;
+  }
+  return {m_buf.get() + m_end, m_capacity - m_end};
+}
+
+void MjpegStreamParser::Append(std::string_view data) {
+  auto buf = GetBuffer(data.size());
+  std::memcpy(buf.data(), data.data(), data.size());
+  Commit(data.size());
+}
+
+void MjpegStreamParser::Consume(size_t len) {
+  m_begin += len;
+  if (m_begin == m_end) {
+    // empty; start again at the beginning of the buffer
+    m_begin = 0;
+    m_end = 0;
+  }
+}
+
+MjpegStreamParser::Event MjpegStreamParser::Next() {
+  m_frame = {};
+  for (;;) {
+    m_needed = 0;
+    auto avail = Available();
+    switch (m_state) {
+      case State::kStatus: {
+        std::string_view line;
+        if (!ReadLine(&line)) {
+          if (avail.size() > kMaxLineLength) {
+            return StreamError("did not receive HTTP response");
+          }
+          return kNeedData;
+        }
+
+        // see if we got a HTTP 200 response
+        std::string_view httpver, code, codeText;
+        std::tie(httpver, line) = wpi::util::split(line, ' ');
+        std::tie(code, codeText) = wpi::util::split(line, ' ');
+        if (!wpi::util::starts_with(httpver, "HTTP")) {
+          return StreamError("did not receive HTTP response");
+        }
+        if (code != "200") {
+          return StreamError(
+              std::format("received {} {} response", code, codeText));
+        }
+        m_field = Field::kOther;
+        m_contentType.clear();
+        m_contentLength.clear();
+        m_state = State::kResponseHeaders;
+        break;
+      }
+      case State::kResponseHeaders:
+      case State::kPartHeaders: {
+        std::string_view line;
+        if (!ReadLine(&line)) {
+          if (avail.size() > kMaxLineLength) {
+            if (m_state == State::kResponseHeaders) {
+              return StreamError("header line too long");
+            }
+            return FrameError("header line too long");
+          }
+          return kNeedData;
+        }
+        if (!line.empty()) {
+          ParseHeader(line);
+        } else if (m_state == State::kResponseHeaders) {
+          // empty line signals end of headers
+          return ResponseHeadersDone();
+        } else if (auto event = PartHeadersDone(); event != kNeedData) {
+          return event;
+        }
+        break;
+      }
+      case State::kBoundary: {
+        size_t pos = avail.find(m_boundary);
+        if (pos == std::string_view::npos) {
+          // keep enough to match a boundary split across reads
+          if (avail.size() >= m_boundary.size()) {
+            Consume(avail.size() - m_boundary.size() + 1);
+          }
+          return kNeedData;
+        }
+        Consume(pos + m_boundary.size());
+        m_state = State::kBoundaryEnd;
+        break;
+      }
+      case State::kBoundaryEnd:
+        // The next two characters after the boundary are normally \r\n.
+        // Handle just \n for LabVIEW however
+        if (avail.empty()) {
+          return kNeedData;
+        }
+        if (avail[0] == '\n') {
+          Consume(1);
+        } else {
+          if (avail.size() < 2) {
+            return kNeedData;
+          }
+          // End-of-stream is indicated with trailing --
+          if (avail[0] == '-' && avail[1] == '-') {
+            Consume(avail.size());
+            m_state = State::kDone;
+            return kEnd;
+          }
+          Consume(2);
+        }
+        m_field = Field::kOther;
+        m_contentType.clear();
+        m_contentLength.clear();
+        m_state = State::kPartHeaders;
+        break;
+      case State::kBody:
+        if (avail.size() < m_imageSize) {
+          m_needed = m_imageSize;
+          return kNeedData;
+        }
+        m_frame = avail.substr(0, m_imageSize);
+        Consume(m_imageSize);
+        m_state = State::kBoundary;
+        return kFrame;
+      case State::kJpeg:
+        return ScanJpeg();
+      case State::kDone:
+        Consume(avail.size());
+        return kNeedData;
+    }
+  }
+}
+
+bool MjpegStreamParser::ReadLine(std::string_view* line) {
+  auto avail = Available();
+  size_t pos = avail.find('\n');
+  if (pos == std::string_view::npos) {
+    return false;
+  }
+  *line = wpi::util::rtrim(avail.substr(0, pos));
+  Consume(pos + 1);
+  return true;
+}
+
+void MjpegStreamParser::ParseHeader(std::string_view line) {
+  // header fields start at the beginning of the line
+  if (!std::isspace(static_cast<unsigned char>(line[0]))) {
+    std::string_view field;
+    std::tie(field, line) = wpi::util::split(line, ':');
+    field = wpi::util::rtrim(field);
+    if (wpi::util::equals_lower(field, "content-type")) {
+      m_field = Field::kContentType;
+    } else if (wpi::util::equals_lower(field, "content-length")) {
+      m_field = Field::kContentLength;
+    } else {
+      m_field = Field::kOther;
+      return;  // ignore other fields
+    }
+  }
+
+  // collapse whitespace
+  line = wpi::util::ltrim(line);
+
+  // save field data
+  if (m_field == Field::kContentType) {
+    m_contentType.append(line.begin(), line.end());
+  } else if (m_field == Field::kContentLength) {
+    m_contentLength.append(line.begin(), line.end());
+  }
+}
+
+MjpegStreamParser::Event MjpegStreamParser::ResponseHeadersDone() {
+  // Parse Content-Type header to get the boundary
+  auto [mediaType, contentType] = wpi::util::split(m_contentType.str(), ';');
+  mediaType = wpi::util::trim(mediaType);
+  if (mediaType != "multipart/x-mixed-replace") {
+    return StreamError(
+        std::format("unrecognized Content-Type \"{}\"", mediaType));
+  }
+
+  // media parameters
+  m_boundary = "--";
+  while (!contentType.empty()) {
+    std::string_view keyvalue;
+    std::tie(keyvalue, contentType) = wpi::util::split(contentType, ';');
+    contentType = wpi::util::ltrim(contentType);
+    auto [key, value] = wpi::util::split(keyvalue, '=');
+    if (wpi::util::trim(key) == "boundary") {
+      value =
+          wpi::util::trim(wpi::util::trim(value), '"');  // value may be quoted
+      if (wpi::util::starts_with(value, "--")) {
+        value = wpi::util::substr(value, 2);
+      }
+      m_boundary.append(value.begin(), value.end());
+    }
+  }
+
+  if (m_boundary.size() == 2) {
+    return StreamError("empty multi-part boundary or no Content-Type");
+  }
+
+  m_state = State::kBoundary;
+  return kResponse;
+}
+
+MjpegStreamParser::Event MjpegStreamParser::PartHeadersDone() {
+  // Check the content type (if present)
+  if (!m_contentType.str().empty() &&
+      !wpi::util::starts_with(m_contentType, "image/jpeg")) {
+    return FrameError(std::format("received unknown Content-Type \"{}\"",
+                                  m_contentType.str()));
+  }
+
+  if (auto v = wpi::util::parse_integer<size_t>(m_contentLength, 10)) {
+    // We know how big it is, so wait until it has all been received
+    if (v.value() > kMaxImageSize) {
+      return FrameError("image too large");
+    }
+    m_imageSize = v.value();
+    m_state = State::kBody;
+  } else {
+    // No Content-Length, so find the end by walking the JPEG markers
+    m_scanPos = 0;
+    m_inEntropy = false;
+    m_state = State::kJpeg;
+  }
+  return kNeedData;
+}
+
+MjpegStreamParser::Event MjpegStreamParser::ScanJpeg() {
+  auto avail = Available();
+  auto bytes = reinterpret_cast<const unsigned char*>(avail.data());
+  size_t size = avail.size();
+  size_t pos = m_scanPos;
+
+  if (pos == 0) {
+    // Check for valid SOI
+    if (size < 2) {
+      return kNeedData;
+    }
+    if (bytes[0] != 0xff || bytes[1] != 0xd8) {
+      return FrameError("did not receive a JPEG image");
+    }
+    pos = 2;  // point to first marker
+  }
+
+  for (;;) {
+    if (m_inEntropy) {
+      // Entropy-coded data continues until a marker other than a restart
+      // marker. Byte stuffing ensures we don't get false markers.
+      if (pos >= size) {
+        break;
+      }
+      auto ff = static_cast<const unsigned char*>(
+          std::memchr(bytes + pos, 0xff, size - pos));
+      if (!ff) {
+        pos = size;
+        break;
+      }
+      pos = ff - bytes;
+      if (pos + 1 >= size) {
+        break;
+      }
+      unsigned char next = bytes[pos + 1];
+      if (next == 0x00 || (next >= 0xd0 && next <= 0xd7)) {
+        pos += 2;
+      } else if (next == 0xff) {
+        ++pos;  // fill byte
+      } else {
+        m_inEntropy = false;  // pos points to the marker
+      }
+      continue;
+    }
+
+    if (pos + 2 > size) {
+      break;
+    }
+    if (bytes[pos] != 0xff) {
+      return FrameError("did not receive a JPEG image");  // not a marker
+    }
+    unsigned char marker = bytes[pos + 1];
+
+    if (marker == 0xd9) {
+      // EOI, we're done
+      m_frame = avail.substr(0, pos + 2);
+      Consume(pos + 2);
+      m_state = State::kBoundary;
+      return kFrame;
+    }
+
+    if (marker == 0xff) {
+      ++pos;  // fill byte
+      continue;
+    }
+    if (marker == 0x01 || (marker >= 0xd0 && marker <= 0xd7)) {
+      pos += 2;  // marker without a length
+      continue;
+    }
+
+    // A normal block; skip it (it may not all be received yet)
+    if (pos + 4 > size) {
+      break;
+    }
+    pos += 2 + bytes[pos + 2] * 256 + bytes[pos + 3];
+
+    // SOS: the block is followed by entropy-coded data
+    if (marker == 0xda) {
+      m_inEntropy = true;
+    }
+  }
+
+  if (pos > kMaxImageSize) {
+    return FrameError("image too large");
+  }
+  m_scanPos = pos;
+  m_needed = pos + 4;
+  return kNeedData;
+}
+
+MjpegStreamParser::Event MjpegStreamParser::FrameError(std::string_view msg) {
+  m_error = msg;
+  m_state = State::kBoundary;
+  return kFrameError;
+}
+
+MjpegStreamParser::Event MjpegStreamParser::StreamError(std::string_view msg) {
+  m_error = msg;
+  m_state = State::kDone;
+  return kStreamError;
+}
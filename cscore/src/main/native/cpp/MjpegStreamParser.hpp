@@ -0,0 +1,133 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "wpi/util/SmallString.hpp"
+
+namespace wpi::cs {
+
+/**
+ * Incremental parser for an MJPEG stream (the HTTP response followed by the
+ * multipart/x-mixed-replace body).
+ *
+ * Stream data is read directly into the parser's buffer with GetBuffer() and
+ * Commit(), and Next() is then called repeatedly until it returns kNeedData.
+ * Frames are returned in place without copying.
+ */
+class MjpegStreamParser {
+ public:
+  enum Event {
+    /// more data is needed
+    kNeedData,
+    /// the HTTP response was accepted
+    kResponse,
+    /// a frame is available from GetFrame()
+    kFrame,
+    /// a part was not an image; GetError() has the reason
+    kFrameError,
+    /// the stream cannot be read further; GetError() has the reason
+    kStreamError,
+    /// the end of stream marker was received
+    kEnd
+  };
+
+  MjpegStreamParser() = default;
+  MjpegStreamParser(const MjpegStreamParser&) = delete;
+  MjpegStreamParser& operator=(const MjpegStreamParser&) = delete;
+
+  /**
+   * Resets to the start of a new HTTP response, discarding any buffered data.
+   */
+  void Reset();
+
+  /**
+   * Gets free space at the end of the buffer for reading stream data into.
+   * This may move unparsed data, invalidating the result of GetFrame().
+   *
+   * @param minSize minimum size to return; the buffer is also grown to fit
+   *                the whole of an image with a known length
+   */
+  std::span<char> GetBuffer(size_t minSize);
+
+  /**
+   * Adds data that was read into the space returned by GetBuffer().
+   */
+  void Commit(size_t len) { m_end += len; }
+
+  /**
+   * Copies data into the buffer.
+   */
+  void Append(std::string_view data);
+
+  /**
+   * Parses buffered data until an event occurs.
+   */
+  Event Next();
+
+  /**
+   * Gets the JPEG image data after Next() returns kFrame. This is valid until
+   * the next call to Next() or GetBuffer().
+   */
+  std::string_view GetFrame() const { return m_frame; }
+
+  /**
+   * Gets the reason after Next() returns kFrameError or kStreamError.
+   */
+  std::string_view GetError() const { return m_error; }
+
+ private:
+  enum class State {
+    kStatus,
+    kResponseHeaders,
+    kBoundary,
+    kBoundaryEnd,
+    kPartHeaders,
+    kBody,
+    kJpeg,
+    kDone
+  };
+
+  std::string_view Available() const {
+    return {m_buf.get() + m_begin, m_end - m_begin};
+  }
+  void Consume(size_t len);
+  bool ReadLine(std::string_view* line);
+  void ParseHeader(std::string_view line);
+  Event ResponseHeadersDone();
+  Event PartHeadersDone();
+  Event ScanJpeg();
+  Event FrameError(std::string_view msg);
+  Event StreamError(std::string_view msg);
+
+  std::unique_ptr<char[]> m_buf;
+  size_t m_capacity = 0;
+  size_t m_begin = 0;
+  size_t m_end = 0;
+  // number of unparsed bytes the current state is waiting for
+  size_t m_needed = 0;
+
+  State m_state = State::kStatus;
+  std::string m_boundary;
+  std::string_view m_frame;
+  std::string m_error;
+
+  // header parsing
+  enum class Field { kOther, kContentType, kContentLength };
+  Field m_field = Field::kOther;
+  wpi::util::SmallString<64> m_contentType;
+  wpi::util::SmallString<64> m_contentLength;
+
+  // image parsing
+  size_t m_imageSize = 0;
+  size_t m_scanPos = 0;
+  bool m_inEntropy = false;
+};
+
+}  // namespace wpi::cs
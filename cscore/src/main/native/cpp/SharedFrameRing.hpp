@@ -0,0 +1,131 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "wpi/util/PixelFormat.hpp"
+#include "wpi/util/RawFrame.h"
+
+namespace wpi::cs {
+
+/**
+ * Ring of raw frames in named shared memory, written by one process and read
+ * in place by any number of others on the same machine.
+ *
+ * Each slot is guarded by a sequence lock, so the writer never waits for
+ * readers. A reader that is lapped by the writer while reading a slot finds
+ * out from Validate() instead of getting a torn image. Readers sleep on a
+ * futex in the shared header until the next frame is published.
+ *
+ * Only supported on Linux; elsewhere Create() and Open() return nullptr.
+ */
+class SharedFrameRing {
+ public:
+  struct FrameInfo {
+    int width = 0;
+    int height = 0;
+    wpi::util::PixelFormat pixelFormat = wpi::util::PixelFormat::UNKNOWN;
+    uint64_t time = 0;
+    WPI_TimestampSource timeSource = WPI_TIMESRC_UNKNOWN;
+  };
+
+  /**
+   * Creates a ring for writing, replacing any existing one with the same
+   * name. The ring is removed when the writer is destroyed.
+   *
+   * @param name     shared memory object name
+   * @param slotSize maximum frame data size
+   * @param numSlots number of frames held
+   * @return Ring, or nullptr on error (errno is set)
+   */
+  static std::unique_ptr<SharedFrameRing> Create(std::string_view name,
+                                                 size_t slotSize,
+                                                 int numSlots);
+
+  /**
+   * Opens an existing ring for reading.
+   *
+   * @param name shared memory object name
+   * @return Ring, or nullptr if it doesn't exist (yet) or is invalid
+   */
+  static std::unique_ptr<SharedFrameRing> Open(std::string_view name);
+
+  SharedFrameRing(const SharedFrameRing&) = delete;
+  SharedFrameRing& operator=(const SharedFrameRing&) = delete;
+  ~SharedFrameRing();
+
+  size_t GetSlotSize() const { return m_slotSize; }
+
+  /**
+   * Copies a frame into the next slot and wakes up readers.
+   *
+   * @return False if the data doesn't fit in a slot
+   */
+  bool Write(const FrameInfo& info, std::string_view data);
+
+  /**
+   * Gets the sequence number of the most recently written frame. Sequence
+   * numbers start at 1.
+   */
+  uint64_t GetLatest() const;
+
+  /**
+   * Waits for a frame newer than sequence to be written.
+   *
+   * @param sequence last sequence number seen
+   * @param timeout  timeout in seconds
+   * @return Sequence number of the newest frame, or 0 on timeout or if the
+   *         ring has been closed
+   */
+  uint64_t Wait(uint64_t sequence, double timeout);
+
+  /**
+   * Gets a frame in place. The data points into shared memory and may be
+   * overwritten by the writer at any time; call Validate() after using it.
+   *
+   * @return False if the frame has already been overwritten
+   */
+  bool Get(uint64_t sequence, FrameInfo* info, std::string_view* data) const;
+
+  /**
+   * Checks that a frame from Get() wasn't overwritten while it was used.
+   */
+  bool Validate(uint64_t sequence) const;
+
+  /**
+   * Checks whether the writer has closed the ring or replaced it with a new
+   * one. Readers should reopen the ring when this returns true.
+   */
+  bool IsClosed() const;
+
+ private:
+  struct Header;
+  struct Slot;
+
+  SharedFrameRing() = default;
+
+  Slot& GetSlot(uint64_t sequence) const;
+  char* GetData(uint64_t sequence) const;
+
+  std::string m_name;
+  bool m_writer = false;
+  int m_fd = -1;
+  void* m_mem = nullptr;
+  size_t m_memSize = 0;
+  Header* m_header = nullptr;
+  Slot* m_slots = nullptr;
+  char* m_data = nullptr;
+  size_t m_slotSize = 0;
+  size_t m_slotStride = 0;
+  uint32_t m_numSlots = 0;
+};
+
+}  // namespace wpi::cs
@@ -0,0 +1,134 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "SharedMemorySinkImpl.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <memory>
+#include <system_error>
+
+#include "Instance.hpp"
+#include "Log.hpp"
+#include "SourceImpl.hpp"
+#include "wpi/cs/cscore_raw.hpp"
+
+using namespace wpi::cs;
+
+// One slot for the writer, one for a reader still copying, and one spare so
+// that a reader that's slightly behind doesn't get overwritten.
+static constexpr int kNumSlots = 3;
+
+SharedMemorySinkImpl::SharedMemorySinkImpl(std::string_view name,
+                                           wpi::util::Logger& logger,
+                                           Notifier& notifier,
+                                           Telemetry& telemetry,
+                                           std::string_view shmName,
+                                           const VideoMode& mode)
+    : SinkImpl{name, logger, notifier, telemetry},
+      m_shmName{shmName},
+      m_mode{mode} {
+  m_thread = std::thread(&SharedMemorySinkImpl::ThreadMain, this);
+}
+
+SharedMemorySinkImpl::~SharedMemorySinkImpl() {
+  {
+    std::scoped_lock lock(m_sourceMutex);
+    m_active = false;
+  }
+  m_sourceCv.notify_one();
+
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+void SharedMemorySinkImpl::SetSourceImpl(std::shared_ptr<SourceImpl> source) {
+  // the thread checks for a source while holding m_sourceMutex
+  std::scoped_lock lock(m_sourceMutex);
+  m_sourceCv.notify_one();
+}
+
+void SharedMemorySinkImpl::ThreadMain() {
+  Enable();
+  Frame::Time lastFrameTime = 0;
+  while (m_active) {
+    auto source = GetSource();
+    if (!source) {
+      std::unique_lock lock(m_sourceMutex);
+      m_sourceCv.wait_for(lock, std::chrono::seconds(1),
+                          [&] { return !m_active || GetSource(); });
+      continue;
+    }
+    // Times out so a change of source is noticed; frames that arrive while
+    // the last one is being published aren't missed.
+    SDEBUG4("waiting for frame");
+    Frame frame = source->GetNextFrame(0.225, lastFrameTime);  // blocks
+    if (!m_active) {
+      break;
+    }
+    // timeouts also replace the current frame
+    lastFrameTime = frame.GetTime();
+    if (!frame) {
+      continue;
+    }
+
+    // Unknown format or zero size means as received
+    int width = m_mode.width > 0 ? m_mode.width : frame.GetOriginalWidth();
+    int height = m_mode.height > 0 ? m_mode.height : frame.GetOriginalHeight();
+    Image* image = nullptr;
+    switch (m_mode.pixelFormat) {
+      case wpi::util::PixelFormat::UNKNOWN:
+        image = frame.GetExistingImage(0);
+        break;
+      case wpi::util::PixelFormat::MJPEG:
+        image = frame.GetImageMJPEG(width, height, -1);
+        break;
+      default:
+        image = frame.GetImage(width, height, m_mode.pixelFormat);
+        break;
+    }
+    if (!image) {
+      // Shouldn't happen, but just in case...
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      continue;
+    }
+
+    // Size slots for the largest uncompressed format at this resolution.
+    // Readers reopen the ring if it has to be replaced with a larger one.
+    if (!m_ring || image->size() > m_ring->GetSlotSize()) {
+      m_ring.reset();
+      size_t slotSize = std::max<size_t>(
+          image->size(), static_cast<size_t>(image->width) * image->height * 4);
+      m_ring = SharedFrameRing::Create(m_shmName, slotSize, kNumSlots);
+      if (!m_ring) {
+        SERROR("could not create shared memory '{}': {}", m_shmName,
+               std::generic_category().message(errno));
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        continue;
+      }
+      SDEBUG("created shared memory '{}' with {} byte slots", m_shmName,
+             slotSize);
+    }
+
+    m_ring->Write({image->width, image->height, image->pixelFormat,
+                   frame.GetTime(), frame.GetTimeSource()},
+                  image->str());
+  }
+  Disable();
+}
+
+namespace wpi::cs {
+
+CS_Sink CreateSharedMemorySink(std::string_view name, std::string_view shmName,
+                               const VideoMode& mode, CS_Status* status) {
+  auto& inst = Instance::GetInstance();
+  // Not a raw sink, as frames can't be grabbed from it
+  return inst.CreateSink(
+      CS_SINK_UNKNOWN,
+      std::make_shared<SharedMemorySinkImpl>(name, inst.logger, inst.notifier,
+                                             inst.telemetry, shmName, mode));
+}
+
+}  // namespace wpi::cs
@@ -0,0 +1,44 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "SharedFrameRing.hpp"
+#include "SinkImpl.hpp"
+#include "wpi/cs/VideoMode.hpp"
+#include "wpi/util/condition_variable.hpp"
+#include "wpi/util/mutex.hpp"
+
+namespace wpi::cs {
+
+class SharedMemorySinkImpl : public SinkImpl {
+ public:
+  SharedMemorySinkImpl(std::string_view name, wpi::util::Logger& logger,
+                       Notifier& notifier, Telemetry& telemetry,
+                       std::string_view shmName, const VideoMode& mode);
+  ~SharedMemorySinkImpl() override;
+
+ private:
+  void SetSourceImpl(std::shared_ptr<SourceImpl> source) override;
+
+  void ThreadMain();
+
+  std::string m_shmName;
+  VideoMode m_mode;
+  std::unique_ptr<SharedFrameRing> m_ring;  // only used by m_thread
+
+  std::atomic_bool m_active{true};  // set to false to terminate thread
+  std::thread m_thread;
+  // wakes up the thread when there's a new source
+  wpi::util::mutex m_sourceMutex;
+  wpi::util::condition_variable m_sourceCv;
+};
+
+}  // namespace wpi::cs
@@ -0,0 +1,122 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "SharedMemorySourceImpl.hpp"
+
+#include <algorithm>
+#include <memory>
+
+#include "Instance.hpp"
+#include "Log.hpp"
+#include "Notifier.hpp"
+#include "wpi/cs/cscore_raw.hpp"
+
+using namespace wpi::cs;
+
+SharedMemorySourceImpl::SharedMemorySourceImpl(std::string_view name,
+                                               wpi::util::Logger& logger,
+                                               Notifier& notifier,
+                                               Telemetry& telemetry,
+                                               std::string_view shmName)
+    : RawSourceImpl{name, logger, notifier, telemetry, VideoMode{}},
+      m_shmName{shmName} {}
+
+SharedMemorySourceImpl::~SharedMemorySourceImpl() {
+  m_active = false;
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+void SharedMemorySourceImpl::Start() {
+  // connected once the ring is opened
+  m_notifier.NotifySource(*this, CS_SOURCE_VIDEOMODES_UPDATED);
+  m_notifier.NotifySourceVideoMode(*this, m_mode);
+  m_thread = std::thread(&SharedMemorySourceImpl::ThreadMain, this);
+}
+
+void SharedMemorySourceImpl::ThreadMain() {
+  uint64_t sequence = 0;
+  while (m_active) {
+    if (!m_ring) {
+      // the publishing process may not have started yet
+      m_ring = SharedFrameRing::Open(m_shmName);
+      if (!m_ring) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        continue;
+      }
+      SDEBUG("opened shared memory '{}'", m_shmName);
+      sequence = m_ring->GetLatest();
+      SetConnected(true);
+    }
+
+    // short timeout so m_active and the writer going away are noticed
+    uint64_t latest = m_ring->Wait(sequence, 0.1);
+    if (latest == 0) {
+      if (m_ring->IsClosed()) {
+        SDEBUG("shared memory '{}' closed", m_shmName);
+        m_ring.reset();
+        SetConnected(false);
+      }
+      continue;
+    }
+    sequence = latest;
+
+    // don't bother copying frames nobody is listening for
+    if (IsEnabled()) {
+      PutRingFrame(sequence);
+    }
+  }
+}
+
+void SharedMemorySourceImpl::PutRingFrame(uint64_t sequence) {
+  SharedFrameRing::FrameInfo info;
+  std::string_view data;
+  if (!m_ring->Get(sequence, &info, &data)) {
+    return;
+  }
+
+  // Frames own their images, so this is the one copy made; if the writer
+  // laps us while copying, drop the frame rather than publish a torn one.
+  auto image =
+      AllocImage(info.pixelFormat, info.width, info.height, data.size());
+  std::copy(data.begin(), data.end(), image->data());
+  if (!m_ring->Validate(sequence)) {
+    SDEBUG4("dropped frame {} overwritten while copying", sequence);
+    return;
+  }
+
+  CS_Status status = 0;
+  VideoMode mode = GetVideoMode(&status);
+  if (info.pixelFormat != mode.pixelFormat || info.width != mode.width ||
+      info.height != mode.height) {
+    mode.pixelFormat = info.pixelFormat;
+    mode.width = info.width;
+    mode.height = info.height;
+    SetVideoMode(mode, &status);
+  }
+
+  // The producer's timestamp is from the same monotonic clock
+  if (info.pixelFormat == wpi::util::PixelFormat::BGRA) {
+    // frames can't be converted from BGRA; this converts it to BGR
+    SourceImpl::PutFrame(info.pixelFormat, info.width, info.height,
+                         image->str(), info.time, info.timeSource);
+  } else {
+    SourceImpl::PutFrame(std::move(image), info.time, info.timeSource);
+  }
+}
+
+namespace wpi::cs {
+
+CS_Source CreateSharedMemorySource(std::string_view name,
+                                   std::string_view shmName,
+                                   CS_Status* status) {
+  auto& inst = Instance::GetInstance();
+  return inst.CreateSource(
+      CS_SOURCE_RAW,
+      std::make_shared<SharedMemorySourceImpl>(name, inst.logger, inst.notifier,
+                                               inst.telemetry, shmName));
+}
+
+}  // namespace wpi::cs
@@ -0,0 +1,40 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "RawSourceImpl.hpp"
+#include "SharedFrameRing.hpp"
+
+namespace wpi::cs {
+
+class SharedMemorySourceImpl : public RawSourceImpl {
+ public:
+  SharedMemorySourceImpl(std::string_view name, wpi::util::Logger& logger,
+                         Notifier& notifier, Telemetry& telemetry,
+                         std::string_view shmName);
+  ~SharedMemorySourceImpl() override;
+
+  void Start() override;
+
+ private:
+  void ThreadMain();
+
+  // Copies a published frame out of the ring and puts it on this source
+  void PutRingFrame(uint64_t sequence);
+
+  std::string m_shmName;
+  std::unique_ptr<SharedFrameRing> m_ring;  // only used by m_thread
+
+  std::atomic_bool m_active{true};
+  std::thread m_thread;
+};
+
+}  // namespace wpi::cs
@@ -455,6 +455,7 @@ std::unique_ptr<Image> SourceImpl::AllocImage(
   image->pixelFormat = pixelFormat;
   image->width = width;
   image->height = height;
+  image->jpegQuality = -1;
 
   return image;
 }
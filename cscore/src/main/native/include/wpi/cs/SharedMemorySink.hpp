@@ -0,0 +1,44 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <string_view>
+
+#include "wpi/cs/VideoMode.hpp"
+#include "wpi/cs/VideoSink.hpp"
+#include "wpi/cs/cscore_raw.hpp"
+
+namespace wpi::cs {
+
+/**
+ * A sink that publishes raw frames to other processes on the same machine
+ * through shared memory, for a SharedMemorySource to receive.
+ *
+ * This avoids the JPEG encode, network transfer, and decode of passing
+ * frames through a MjpegServer and HttpCamera. Only supported on Linux.
+ */
+class SharedMemorySink : public VideoSink {
+ public:
+  SharedMemorySink() = default;
+
+  /**
+   * Create a shared memory sink.
+   *
+   * <p>Frames are converted to the given mode before being published. An
+   * unknown pixel format or zero width or height keeps that property of the
+   * source's frames as they are. Any other sink publishing with the same
+   * shared memory name is replaced.
+   *
+   * @param name Sink name (arbitrary unique identifier)
+   * @param shmName Shared memory name; must be unique on the machine
+   * @param mode Video mode to publish
+   */
+  SharedMemorySink(std::string_view name, std::string_view shmName,
+                   const VideoMode& mode = {}) {
+    m_handle = CreateSharedMemorySink(name, shmName, mode, &m_status);
+  }
+};
+
+}  // namespace wpi::cs
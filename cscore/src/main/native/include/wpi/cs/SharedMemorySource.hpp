@@ -0,0 +1,37 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <string_view>
+
+#include "wpi/cs/VideoSource.hpp"
+#include "wpi/cs/cscore_raw.hpp"
+
+namespace wpi::cs {
+
+/**
+ * A source that receives frames published by a SharedMemorySink in another
+ * process on the same machine. Only supported on Linux.
+ *
+ * The source is connected while the publishing sink exists, and reconnects
+ * when it is restarted. Its video mode follows the frames received; frame
+ * times are those of the original frames.
+ */
+class SharedMemorySource : public VideoSource {
+ public:
+  SharedMemorySource() = default;
+
+  /**
+   * Create a shared memory source.
+   *
+   * @param name Source name (arbitrary unique identifier)
+   * @param shmName Shared memory name of the publishing SharedMemorySink
+   */
+  SharedMemorySource(std::string_view name, std::string_view shmName) {
+    m_handle = CreateSharedMemorySource(name, shmName, &m_status);
+  }
+};
+
+}  // namespace wpi::cs
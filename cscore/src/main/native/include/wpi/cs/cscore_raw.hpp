@@ -37,6 +37,12 @@ uint64_t GrabSinkFrameTimeoutLastTime(CS_Sink sink, WPI_RawFrame& image,
                                       double timeout, uint64_t lastFrameTime,
                                       CS_Status* status);
 
+CS_Sink CreateSharedMemorySink(std::string_view name, std::string_view shmName,
+                               const VideoMode& mode, CS_Status* status);
+CS_Source CreateSharedMemorySource(std::string_view name,
+                                   std::string_view shmName,
+                                   CS_Status* status);
+
 /** @} */
 
 }  // namespace wpi::cs
@@ -0,0 +1,314 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "SharedFrameRing.hpp"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+
+using namespace wpi::cs;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+namespace {
+constexpr uint32_t kMagic = 0x46534357;  // "WCSF"
+constexpr uint32_t kVersion = 1;
+constexpr size_t kAlign = 64;
+
+constexpr size_t RoundUp(size_t size) {
+  return (size + kAlign - 1) & ~(kAlign - 1);
+}
+
+std::string GetShmName(std::string_view name) {
+  if (name.starts_with('/')) {
+    return std::string{name};
+  }
+  std::string shmName{"/"};
+  shmName += name;
+  return shmName;
+}
+
+// Not FUTEX_PRIVATE_FLAG; the waiters are in other processes
+void FutexWait(std::atomic<uint32_t>* addr, uint32_t value, double timeout) {
+  timespec ts;
+  ts.tv_sec = static_cast<time_t>(timeout);
+  ts.tv_nsec = static_cast<long>((timeout - ts.tv_sec) * 1e9);  // NOLINT
+  syscall(SYS_futex, addr, FUTEX_WAIT, value, &ts, nullptr, 0);
+}
+
+void FutexWake(std::atomic<uint32_t>* addr) {
+  syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+// Checks whether the name still refers to the object open as fd; a new writer
+// replaces it with a different object
+bool IsCurrent(const std::string& name, int fd) {
+  int curFd = ::shm_open(name.c_str(), O_RDONLY, 0);
+  if (curFd < 0) {
+    return false;
+  }
+  struct stat cur;
+  struct stat ours;
+  bool current = ::fstat(curFd, &cur) == 0 && ::fstat(fd, &ours) == 0 &&
+                 cur.st_ino == ours.st_ino;
+  ::close(curFd);
+  return current;
+}
+}  // namespace
+
+struct SharedFrameRing::Header {
+  // written last when creating, so readers never see a partial header
+  std::atomic<uint32_t> magic;
+  uint32_t version;
+  uint32_t numSlots;
+  uint64_t slotSize;
+
+  // sequence number of the newest complete frame
+  alignas(kAlign) std::atomic<uint64_t> published;
+  // incremented on every publish; readers wait on it
+  std::atomic<uint32_t> futex;
+  std::atomic<uint32_t> waiters;
+  std::atomic<uint32_t> closed;
+};
+
+// Sequence lock is 2 * sequence + 1 while being written, 2 * sequence when
+// complete.  The other fields are atomic only so that reading them while they
+// are being written isn't undefined; the lock says whether they are valid.
+struct alignas(kAlign) SharedFrameRing::Slot {
+  std::atomic<uint64_t> lock;
+  std::atomic<uint64_t> time;
+  std::atomic<uint64_t> size;
+  std::atomic<int32_t> width;
+  std::atomic<int32_t> height;
+  std::atomic<int32_t> pixelFormat;
+  std::atomic<int32_t> timeSource;
+};
+
+std::unique_ptr<SharedFrameRing> SharedFrameRing::Create(std::string_view name,
+                                                         size_t slotSize,
+                                                         int numSlots) {
+  if (numSlots <= 0) {
+    errno = EINVAL;
+    return nullptr;
+  }
+
+  std::unique_ptr<SharedFrameRing> ring{new SharedFrameRing};
+  ring->m_name = GetShmName(name);
+  ring->m_writer = true;
+  ring->m_numSlots = numSlots;
+  ring->m_slotSize = slotSize;
+  ring->m_slotStride = RoundUp(slotSize);
+  size_t dataOffset =
+      RoundUp(sizeof(Header)) + RoundUp(sizeof(Slot) * numSlots);
+  ring->m_memSize = dataOffset + ring->m_slotStride * numSlots;
+
+  // replace any stale ring left behind by a previous writer
+  ::shm_unlink(ring->m_name.c_str());
+  ring->m_fd = ::shm_open(ring->m_name.c_str(), O_RDWR | O_CREAT | O_EXCL,
+                          S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+  if (ring->m_fd < 0) {
+    return nullptr;
+  }
+  if (::ftruncate(ring->m_fd, ring->m_memSize) < 0) {
+    ::shm_unlink(ring->m_name.c_str());
+    return nullptr;
+  }
+  ring->m_mem = ::mmap(nullptr, ring->m_memSize, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, ring->m_fd, 0);
+  if (ring->m_mem == MAP_FAILED) {
+    ring->m_mem = nullptr;
+    ::shm_unlink(ring->m_name.c_str());
+    return nullptr;
+  }
+
+  // ftruncate zero-fills, which is a valid initial state for the atomics
+  char* mem = static_cast<char*>(ring->m_mem);
+  ring->m_header = new (mem) Header;
+  ring->m_slots = new (mem + RoundUp(sizeof(Header))) Slot[numSlots];
+  ring->m_data = mem + dataOffset;
+  ring->m_header->version = kVersion;
+  ring->m_header->numSlots = numSlots;
+  ring->m_header->slotSize = slotSize;
+  ring->m_header->magic.store(kMagic, std::memory_order_release);
+  return ring;
+}
+
+std::unique_ptr<SharedFrameRing> SharedFrameRing::Open(std::string_view name) {
+  std::unique_ptr<SharedFrameRing> ring{new SharedFrameRing};
+  ring->m_name = GetShmName(name);
+  ring->m_fd = ::shm_open(ring->m_name.c_str(), O_RDWR, 0);
+  if (ring->m_fd < 0) {
+    return nullptr;
+  }
+
+  // the writer may still be setting it up
+  struct stat st;
+  if (::fstat(ring->m_fd, &st) < 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(Header)) {
+    return nullptr;
+  }
+  // read-write, as waiting updates the header
+  ring->m_memSize = st.st_size;
+  ring->m_mem = ::mmap(nullptr, ring->m_memSize, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, ring->m_fd, 0);
+  if (ring->m_mem == MAP_FAILED) {
+    ring->m_mem = nullptr;
+    return nullptr;
+  }
+
+  char* mem = static_cast<char*>(ring->m_mem);
+  ring->m_header = reinterpret_cast<Header*>(mem);
+  if (ring->m_header->magic.load(std::memory_order_acquire) != kMagic ||
+      ring->m_header->version != kVersion ||
+      ring->m_header->numSlots == 0) {
+    return nullptr;
+  }
+  ring->m_numSlots = ring->m_header->numSlots;
+  ring->m_slotSize = ring->m_header->slotSize;
+  ring->m_slotStride = RoundUp(ring->m_slotSize);
+  size_t dataOffset =
+      RoundUp(sizeof(Header)) + RoundUp(sizeof(Slot) * ring->m_numSlots);
+  if (dataOffset + ring->m_slotStride * ring->m_numSlots > ring->m_memSize) {
+    return nullptr;
+  }
+  ring->m_slots = reinterpret_cast<Slot*>(mem + RoundUp(sizeof(Header)));
+  ring->m_data = mem + dataOffset;
+  return ring;
+}
+
+SharedFrameRing::~SharedFrameRing() {
+  if (m_writer && m_header) {
+    m_header->closed.store(1);
+    m_header->futex.fetch_add(1);
+    FutexWake(&m_header->futex);
+    if (IsCurrent(m_name, m_fd)) {
+      ::shm_unlink(m_name.c_str());
+    }
+  }
+  if (m_mem) {
+    ::munmap(m_mem, m_memSize);
+  }
+  if (m_fd >= 0) {
+    ::close(m_fd);
+  }
+}
+
+SharedFrameRing::Slot& SharedFrameRing::GetSlot(uint64_t sequence) const {
+  return m_slots[sequence % m_numSlots];
+}
+
+char* SharedFrameRing::GetData(uint64_t sequence) const {
+  return m_data + (sequence % m_numSlots) * m_slotStride;
+}
+
+bool SharedFrameRing::Write(const FrameInfo& info, std::string_view data) {
+  if (data.size() > m_slotSize) {
+    return false;
+  }
+
+  uint64_t sequence = m_header->published.load(std::memory_order_relaxed) + 1;
+  Slot& slot = GetSlot(sequence);
+  slot.lock.store(sequence * 2 + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.time.store(info.time, std::memory_order_relaxed);
+  slot.size.store(data.size(), std::memory_order_relaxed);
+  slot.width.store(info.width, std::memory_order_relaxed);
+  slot.height.store(info.height, std::memory_order_relaxed);
+  slot.pixelFormat.store(static_cast<int32_t>(info.pixelFormat),
+                         std::memory_order_relaxed);
+  slot.timeSource.store(info.timeSource, std::memory_order_relaxed);
+  std::memcpy(GetData(sequence), data.data(), data.size());
+  slot.lock.store(sequence * 2, std::memory_order_release);
+  m_header->published.store(sequence, std::memory_order_release);
+
+  // Only make the syscall if someone is waiting.  A reader that starts
+  // waiting after this check sees the new futex value and doesn't sleep.
+  m_header->futex.fetch_add(1);
+  if (m_header->waiters.load() > 0) {
+    FutexWake(&m_header->futex);
+  }
+  return true;
+}
+
+uint64_t SharedFrameRing::GetLatest() const {
+  return m_header->published.load(std::memory_order_acquire);
+}
+
+uint64_t SharedFrameRing::Wait(uint64_t sequence, double timeout) {
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::duration<double>(timeout);
+  for (;;) {
+    uint32_t futex = m_header->futex.load();
+    uint64_t latest = m_header->published.load(std::memory_order_acquire);
+    if (latest != sequence) {
+      return latest;
+    }
+    if (m_header->closed.load() != 0) {
+      return 0;
+    }
+    std::chrono::duration<double> remaining =
+        deadline - std::chrono::steady_clock::now();
+    if (remaining.count() <= 0) {
+      return 0;
+    }
+    m_header->waiters.fetch_add(1);
+    FutexWait(&m_header->futex, futex, remaining.count());
+    m_header->waiters.fetch_sub(1);
+  }
+}
+
+bool SharedFrameRing::Get(uint64_t sequence, FrameInfo* info,
+                          std::string_view* data) const {
+  const Slot& slot = GetSlot(sequence);
+  if (slot.lock.load(std::memory_order_acquire) != sequence * 2) {
+    return false;
+  }
+  info->time = slot.time.load(std::memory_order_relaxed);
+  info->width = slot.width.load(std::memory_order_relaxed);
+  info->height = slot.height.load(std::memory_order_relaxed);
+  info->pixelFormat = static_cast<wpi::util::PixelFormat>(
+      slot.pixelFormat.load(std::memory_order_relaxed));
+  info->timeSource = static_cast<WPI_TimestampSource>(
+      slot.timeSource.load(std::memory_order_relaxed));
+  size_t size = slot.size.load(std::memory_order_relaxed);
+  // size is only trustworthy once validated; don't read past the slot
+  if (size > m_slotSize) {
+    return false;
+  }
+  *data = {GetData(sequence), size};
+  return Validate(sequence);
+}
+
+bool SharedFrameRing::Validate(uint64_t sequence) const {
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return GetSlot(sequence).lock.load(std::memory_order_relaxed) ==
+         sequence * 2;
+}
+
+bool SharedFrameRing::IsClosed() const {
+  if (m_header->closed.load() != 0) {
+    return true;
+  }
+  if (m_writer) {
+    return false;
+  }
+
+  // a writer that exited without closing leaves the ring behind
+  return !IsCurrent(m_name, m_fd);
+}
@@ -0,0 +1,49 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "SharedFrameRing.hpp"
+
+#include <memory>
+
+using namespace wpi::cs;
+
+struct SharedFrameRing::Header {};
+struct SharedFrameRing::Slot {};
+
+std::unique_ptr<SharedFrameRing> SharedFrameRing::Create(std::string_view name,
+                                                         size_t slotSize,
+                                                         int numSlots) {
+  return nullptr;
+}
+
+std::unique_ptr<SharedFrameRing> SharedFrameRing::Open(std::string_view name) {
+  return nullptr;
+}
+
+SharedFrameRing::~SharedFrameRing() = default;
+
+bool SharedFrameRing::Write(const FrameInfo& info, std::string_view data) {
+  return false;
+}
+
+uint64_t SharedFrameRing::GetLatest() const {
+  return 0;
+}
+
+uint64_t SharedFrameRing::Wait(uint64_t sequence, double timeout) {
+  return 0;
+}
+
+bool SharedFrameRing::Get(uint64_t sequence, FrameInfo* info,
+                          std::string_view* data) const {
+  return false;
+}
+
+bool SharedFrameRing::Validate(uint64_t sequence) const {
+  return false;
+}
+
+bool SharedFrameRing::IsClosed() const {
+  return true;
+}
@@ -0,0 +1,82 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "ConversionPlanner.hpp"
+
+#include <initializer_list>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace wpi::cs {
+
+namespace {
+
+using enum wpi::util::PixelFormat;
+
+std::vector<wpi::util::PixelFormat> Plan(
+    wpi::util::PixelFormat original,
+    std::initializer_list<wpi::util::PixelFormat> available,
+    wpi::util::PixelFormat pixelFormat) {
+  wpi::util::SmallVector<wpi::util::PixelFormat, 4> path;
+  if (!PlanConversion(original, available, pixelFormat, path)) {
+    return {};
+  }
+  return {path.begin(), path.end()};
+}
+
+using Path = std::vector<wpi::util::PixelFormat>;
+
+}  // namespace
+
+TEST_CASE("PlanConversion direct", "[cscore][conversion-planner]") {
+  CHECK(Plan(YUYV, {YUYV}, BGR) == Path{YUYV, BGR});
+  CHECK(Plan(YUYV, {YUYV}, GRAY) == Path{YUYV, GRAY});
+  CHECK(Plan(UYVY, {UYVY}, GRAY) == Path{UYVY, GRAY});
+  CHECK(Plan(MJPEG, {MJPEG}, GRAY) == Path{MJPEG, GRAY});
+  CHECK(Plan(BGR, {BGR}, BGRA) == Path{BGR, BGRA});
+}
+
+TEST_CASE("PlanConversion through intermediates",
+          "[cscore][conversion-planner]") {
+  CHECK(Plan(YUYV, {YUYV}, MJPEG) == Path{YUYV, BGR, MJPEG});
+  CHECK(Plan(YUYV, {YUYV}, Y16) == Path{YUYV, GRAY, Y16});
+  CHECK(Plan(MJPEG, {MJPEG}, Y16) == Path{MJPEG, GRAY, Y16});
+  CHECK(Plan(RGB565, {RGB565}, GRAY) == Path{RGB565, BGR, GRAY});
+  CHECK(Plan(Y16, {Y16}, BGR) == Path{Y16, GRAY, BGR});
+  CHECK(Plan(GRAY, {GRAY}, MJPEG) == Path{GRAY, MJPEG});
+}
+
+TEST_CASE("PlanConversion reuses intermediates",
+          "[cscore][conversion-planner]") {
+  CHECK(Plan(YUYV, {YUYV, BGR}, MJPEG) == Path{BGR, MJPEG});
+  CHECK(Plan(YUYV, {YUYV, BGR}, RGB565) == Path{BGR, RGB565});
+  CHECK(Plan(MJPEG, {MJPEG, BGR}, GRAY) == Path{BGR, GRAY});
+  CHECK(Plan(Y16, {Y16, GRAY}, BGR) == Path{GRAY, BGR});
+}
+
+TEST_CASE("PlanConversion keeps color and depth",
+          "[cscore][conversion-planner]") {
+  // grayscale and RGB565 intermediates have lost information
+  CHECK(Plan(YUYV, {YUYV, GRAY}, BGR) == Path{YUYV, BGR});
+  CHECK(Plan(YUYV, {YUYV, GRAY}, MJPEG) == Path{YUYV, BGR, MJPEG});
+  CHECK(Plan(YUYV, {YUYV, RGB565}, BGRA) == Path{YUYV, BGR, BGRA});
+  // unless that's all there is
+  CHECK(Plan(YUYV, {GRAY}, BGR) == Path{GRAY, BGR});
+}
+
+TEST_CASE("PlanConversion output format available",
+          "[cscore][conversion-planner]") {
+  // e.g. a JPEG of the wrong quality is re-encoded
+  CHECK(Plan(MJPEG, {MJPEG}, MJPEG) == Path{MJPEG, BGR, MJPEG});
+  CHECK(Plan(MJPEG, {MJPEG, BGR}, MJPEG) == Path{BGR, MJPEG});
+}
+
+TEST_CASE("PlanConversion unsupported", "[cscore][conversion-planner]") {
+  CHECK(Plan(BGR, {BGR}, YUYV).empty());
+  CHECK(Plan(BGR, {BGR}, UYVY).empty());
+  CHECK(Plan(BGR, {}, GRAY).empty());
+}
+
+}  // namespace wpi::cs
@@ -0,0 +1,51 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "JpegUtil.hpp"
+
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgcodecs/imgcodecs.hpp>
+
+namespace wpi::cs {
+
+namespace {
+
+std::vector<uchar> Encode(int quality) {
+  cv::Mat image{64, 64, CV_8UC3};
+  for (int y = 0; y < image.rows; ++y) {
+    uchar* row = image.ptr<uchar>(y);
+    for (int x = 0; x < image.cols * 3; ++x) {
+      row[x] = (x * 7 + y * 13) & 0xff;
+    }
+  }
+  std::vector<uchar> jpeg;
+  cv::imencode(".jpg", image, jpeg, {cv::IMWRITE_JPEG_QUALITY, quality});
+  return jpeg;
+}
+
+std::string_view AsString(const std::vector<uchar>& data) {
+  return {reinterpret_cast<const char*>(data.data()), data.size()};
+}
+
+}  // namespace
+
+TEST_CASE("GetJpegQuality matches encoder quality", "[cscore][jpeg-util]") {
+  for (int quality : {30, 50, 75, 90}) {
+    auto jpeg = Encode(quality);
+    INFO("quality " << quality);
+    CHECK(GetJpegQuality(AsString(jpeg)) == quality);
+  }
+}
+
+TEST_CASE("GetJpegQuality without quantization table", "[cscore][jpeg-util]") {
+  using namespace std::string_view_literals;
+  CHECK(GetJpegQuality("\xff\xd8\xff\xd9"sv) == -1);
+  CHECK(GetJpegQuality("not a jpeg"sv) == -1);
+}
+
+}  // namespace wpi::cs
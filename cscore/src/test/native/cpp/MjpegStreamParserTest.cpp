@@ -0,0 +1,161 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "MjpegStreamParser.hpp"
+
+#include <algorithm>
+#include <format>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace wpi::cs {
+
+namespace {
+
+// A JPEG with an APP0 block, a SOF0 block, and entropy-coded data containing
+// a stuffed byte, a restart marker, and a fill byte.
+std::string MakeJpeg(char fill) {
+  using namespace std::string_view_literals;
+  std::string jpeg{"\xff\xd8"sv};
+  jpeg += "\xff\xe0\x00\x06JFIF"sv;
+  jpeg += "\xff\xc0\x00\x0b\x08\x00\xf0\x01\x40\x01\x01\x11\x00"sv;
+  jpeg += "\xff\xda\x00\x08\x01\x01\x00\x00\x3f\x00"sv;
+  jpeg += std::string(100, fill);
+  jpeg += "\xff\x00\x12\xff\xd0\x34\xff\xff\xd9"sv;
+  return jpeg;
+}
+
+constexpr std::string_view kResponse =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: multipart/x-mixed-replace;boundary=\"--bound\"\r\n"
+    "\r\n";
+
+std::string MakePart(std::string_view image, bool contentLength) {
+  std::string part = "\r\n--bound\r\nContent-Type: image/jpeg\r\n";
+  if (contentLength) {
+    part += std::format("Content-Length: {}\r\n", image.size());
+  }
+  part += "\r\n";
+  part += image;
+  return part;
+}
+
+struct Result {
+  std::vector<MjpegStreamParser::Event> events;
+  std::vector<std::string> frames;
+};
+
+// Feeds data in chunks of the given size, collecting events until more data
+// is needed
+Result Parse(MjpegStreamParser& parser, std::string_view data,
+             size_t chunkSize) {
+  Result result;
+  while (!data.empty()) {
+    parser.Append(data.substr(0, chunkSize));
+    data.remove_prefix(std::min(chunkSize, data.size()));
+    for (;;) {
+      auto event = parser.Next();
+      if (event == MjpegStreamParser::kNeedData) {
+        break;
+      }
+      result.events.emplace_back(event);
+      if (event == MjpegStreamParser::kFrame) {
+        result.frames.emplace_back(parser.GetFrame());
+      }
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST_CASE("MjpegStreamParser frames", "[cscore][mjpeg-parser]") {
+  auto jpeg1 = MakeJpeg('\x55');
+  auto jpeg2 = MakeJpeg('\xaa');
+  bool contentLength = false;
+  size_t chunkSize = 1;
+  SECTION("with Content-Length, all at once") {
+    contentLength = true;
+    chunkSize = 4096;
+  }
+  SECTION("with Content-Length, byte at a time") {
+    contentLength = true;
+  }
+  SECTION("without Content-Length, all at once") {
+    chunkSize = 4096;
+  }
+  SECTION("without Content-Length, byte at a time") {}
+
+  MjpegStreamParser parser;
+  auto result = Parse(parser,
+                      std::string{kResponse} + MakePart(jpeg1, contentLength) +
+                          MakePart(jpeg2, contentLength) + "\r\n--bound--\r\n",
+                      chunkSize);
+  REQUIRE(result.events ==
+          std::vector{MjpegStreamParser::kResponse, MjpegStreamParser::kFrame,
+                      MjpegStreamParser::kFrame, MjpegStreamParser::kEnd});
+  CHECK(result.frames[0] == jpeg1);
+  CHECK(result.frames[1] == jpeg2);
+}
+
+TEST_CASE("MjpegStreamParser bad response", "[cscore][mjpeg-parser]") {
+  MjpegStreamParser parser;
+  auto result = Parse(parser, "HTTP/1.1 404 Not Found\r\n\r\n", 4096);
+  REQUIRE(result.events == std::vector{MjpegStreamParser::kStreamError});
+  CHECK(parser.GetError() == "received 404 Not Found response");
+}
+
+TEST_CASE("MjpegStreamParser not multipart", "[cscore][mjpeg-parser]") {
+  MjpegStreamParser parser;
+  auto result = Parse(parser,
+                      "HTTP/1.1 200 OK\r\nContent-Type: image/jpeg\r\n\r\n",
+                      4096);
+  REQUIRE(result.events == std::vector{MjpegStreamParser::kStreamError});
+}
+
+TEST_CASE("MjpegStreamParser skips bad parts", "[cscore][mjpeg-parser]") {
+  auto jpeg = MakeJpeg('\x55');
+  MjpegStreamParser parser;
+  auto result = Parse(parser,
+                      std::string{kResponse} +
+                          "--bound\r\nContent-Type: text/plain\r\n\r\nhi" +
+                          "\r\n--bound\r\n\r\nnot a jpeg" +
+                          MakePart(jpeg, false),
+                      4096);
+  REQUIRE(result.events == std::vector{MjpegStreamParser::kResponse,
+                                       MjpegStreamParser::kFrameError,
+                                       MjpegStreamParser::kFrameError,
+                                       MjpegStreamParser::kFrame});
+  CHECK(result.frames[0] == jpeg);
+}
+
+TEST_CASE("MjpegStreamParser LabVIEW newline", "[cscore][mjpeg-parser]") {
+  auto jpeg = MakeJpeg('\x55');
+  MjpegStreamParser parser;
+  auto result =
+      Parse(parser,
+            std::string{kResponse} + "--bound\nContent-Type: image/jpeg\n\n" +
+                jpeg,
+            4096);
+  REQUIRE(result.events == std::vector{MjpegStreamParser::kResponse,
+                                       MjpegStreamParser::kFrame});
+  CHECK(result.frames[0] == jpeg);
+}
+
+TEST_CASE("MjpegStreamParser reset", "[cscore][mjpeg-parser]") {
+  auto jpeg = MakeJpeg('\x55');
+  MjpegStreamParser parser;
+  Parse(parser, std::string{kResponse} + "--bound\r\n\r\n\xff\xd8", 4096);
+  parser.Reset();
+  auto result =
+      Parse(parser, std::string{kResponse} + MakePart(jpeg, true), 4096);
+  REQUIRE(result.events == std::vector{MjpegStreamParser::kResponse,
+                                       MjpegStreamParser::kFrame});
+  CHECK(result.frames[0] == jpeg);
+}
+
+}  // namespace wpi::cs
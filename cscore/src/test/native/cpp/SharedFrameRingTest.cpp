@@ -0,0 +1,172 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "SharedFrameRing.hpp"
+
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "wpi/cs/RawSink.hpp"
+#include "wpi/cs/RawSource.hpp"
+#include "wpi/cs/SharedMemorySink.hpp"
+#include "wpi/cs/SharedMemorySource.hpp"
+
+#ifdef __linux__
+
+namespace wpi::cs {
+
+namespace {
+
+SharedFrameRing::FrameInfo MakeInfo(uint64_t time) {
+  return {2, 2, wpi::util::PixelFormat::GRAY, time, WPI_TIMESRC_FRAME_DEQUEUE};
+}
+
+// Reads a frame, or an empty string if it was overwritten
+std::string Read(SharedFrameRing& ring, uint64_t sequence,
+                 SharedFrameRing::FrameInfo* info) {
+  std::string_view data;
+  if (!ring.Get(sequence, info, &data)) {
+    return {};
+  }
+  std::string copy{data};
+  if (!ring.Validate(sequence)) {
+    return {};
+  }
+  return copy;
+}
+
+class TestSink : public RawSink {
+ public:
+  using RawSink::GrabFrame;
+  using RawSink::RawSink;
+};
+
+}  // namespace
+
+TEST_CASE("SharedFrameRing write and read", "[cscore][shared-frame-ring]") {
+  auto writer = SharedFrameRing::Create("cscore_test_ring", 4, 2);
+  REQUIRE(writer);
+  auto reader = SharedFrameRing::Open("cscore_test_ring");
+  REQUIRE(reader);
+  CHECK(reader->GetSlotSize() == 4);
+  CHECK(reader->GetLatest() == 0);
+  CHECK(reader->Wait(0, 0.01) == 0);
+
+  CHECK(writer->Write(MakeInfo(100), "abcd"));
+  CHECK(reader->Wait(0, 1.0) == 1);
+  SharedFrameRing::FrameInfo info;
+  CHECK(Read(*reader, 1, &info) == "abcd");
+  CHECK(info.width == 2);
+  CHECK(info.height == 2);
+  CHECK(info.pixelFormat == wpi::util::PixelFormat::GRAY);
+  CHECK(info.time == 100);
+  CHECK(info.timeSource == WPI_TIMESRC_FRAME_DEQUEUE);
+
+  // too large for a slot
+  CHECK_FALSE(writer->Write(MakeInfo(200), "abcde"));
+  CHECK(reader->GetLatest() == 1);
+}
+
+TEST_CASE("SharedFrameRing overwritten frames",
+          "[cscore][shared-frame-ring]") {
+  auto writer = SharedFrameRing::Create("cscore_test_ring", 4, 2);
+  REQUIRE(writer);
+  auto reader = SharedFrameRing::Open("cscore_test_ring");
+  REQUIRE(reader);
+
+  writer->Write(MakeInfo(1), "1111");
+  std::string_view data;
+  SharedFrameRing::FrameInfo info;
+  REQUIRE(reader->Get(1, &info, &data));
+  // lap the reader while it holds frame 1
+  writer->Write(MakeInfo(2), "2222");
+  writer->Write(MakeInfo(3), "3333");
+  CHECK_FALSE(reader->Validate(1));
+  CHECK(Read(*reader, 1, &info).empty());
+  CHECK(reader->Wait(1, 1.0) == 3);
+  CHECK(Read(*reader, 2, &info) == "2222");
+  CHECK(Read(*reader, 3, &info) == "3333");
+}
+
+TEST_CASE("SharedFrameRing closed", "[cscore][shared-frame-ring]") {
+  CHECK_FALSE(SharedFrameRing::Open("cscore_test_ring_missing"));
+
+  auto writer = SharedFrameRing::Create("cscore_test_ring", 4, 2);
+  REQUIRE(writer);
+  auto reader = SharedFrameRing::Open("cscore_test_ring");
+  REQUIRE(reader);
+  CHECK_FALSE(reader->IsClosed());
+
+  // replaced by a new writer
+  auto writer2 = SharedFrameRing::Create("cscore_test_ring", 4, 2);
+  REQUIRE(writer2);
+  CHECK(reader->IsClosed());
+
+  reader = SharedFrameRing::Open("cscore_test_ring");
+  REQUIRE(reader);
+  writer2.reset();
+  CHECK(reader->Wait(0, 1.0) == 0);
+  CHECK(reader->IsClosed());
+  CHECK_FALSE(SharedFrameRing::Open("cscore_test_ring"));
+}
+
+TEST_CASE("SharedMemorySink to SharedMemorySource",
+          "[cscore][shared-frame-ring]") {
+  RawSource source{"shmtestsource", wpi::util::PixelFormat::GRAY, 4, 2, 30};
+  SharedMemorySink shmSink{"shmtestsink", "cscore_test_shm"};
+  shmSink.SetSource(source);
+  SharedMemorySource shmSource{"shmtestsource2", "cscore_test_shm"};
+  TestSink sink{"shmtestsink2"};
+  sink.SetSource(shmSource);
+
+  uint8_t data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  WPI_RawFrame in{};
+  in.data = data;
+  in.size = sizeof(data);
+  in.width = 4;
+  in.height = 2;
+  in.pixelFormat = WPI_PIXFMT_GRAY;
+  CS_Status status = 0;
+
+  // the ring is created with the first frame, so keep publishing until the
+  // source has opened it
+  wpi::util::RawFrame out;
+  uint64_t time = 0;
+  for (int i = 0; i < 50 && time == 0; ++i) {
+    PutSourceFrame(source.GetHandle(), in, &status);
+    out.pixelFormat = WPI_PIXFMT_UNKNOWN;
+    time = sink.GrabFrame(out, 0.1);
+  }
+  REQUIRE(time != 0);
+  CHECK(shmSource.IsConnected());
+  CHECK(out.width == 4);
+  CHECK(out.height == 2);
+  CHECK(out.pixelFormat == WPI_PIXFMT_GRAY);
+  REQUIRE(out.size == sizeof(data));
+  CHECK(std::string_view{reinterpret_cast<char*>(out.data), out.size} ==
+        std::string_view{reinterpret_cast<char*>(data), sizeof(data)});
+  auto mode = shmSource.GetVideoMode();
+  CHECK(mode.pixelFormat == wpi::util::PixelFormat::GRAY);
+  CHECK(mode.width == 4);
+  CHECK(mode.height == 2);
+}
+
+TEST_CASE("SharedMemorySink can't grab frames",
+          "[cscore][shared-frame-ring]") {
+  SharedMemorySink shmSink{"shmtestsink", "cscore_test_shm"};
+  CHECK(shmSink.GetKind() == VideoSink::kUnknown);
+
+  wpi::util::RawFrame out;
+  CS_Status status = 0;
+  CHECK(GrabSinkFrameTimeout(shmSink.GetHandle(), out, 0.1, &status) == 0);
+  CHECK(status == CS_INVALID_HANDLE);
+}
+
+}  // namespace wpi::cs
+
+#endif  // __linux__
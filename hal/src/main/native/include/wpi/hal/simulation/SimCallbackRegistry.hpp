@@ -4,8 +4,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <utility>
+#include <vector>
 
 #include "wpi/hal/simulation/NotifyListener.hpp"
 #include "wpi/util/Compiler.hpp"
@@ -16,6 +19,17 @@ namespace wpi::hal {
 
 namespace impl {
 
+/**
+ * Base for simulation callback registries.
+ *
+ * Registered callbacks are kept in an immutable snapshot that is replaced on
+ * every registration or cancellation (copy-on-write). Invoking callbacks only
+ * pins the current snapshot, so it never takes m_mutex and callbacks may
+ * register or cancel callbacks (including themselves) while being invoked.
+ * Cancel() and Reset() wait for invocations on other threads that may still
+ * use the replaced snapshot, so once they return the cancelled callbacks will
+ * not be called again.
+ */
 class SimCallbackRegistryBase {
  public:
   using RawFunctor = void (*)();
@@ -23,18 +37,48 @@ class SimCallbackRegistryBase {
  protected:
   using CallbackVector =
       wpi::util::UidVector<HalCallbackListener<RawFunctor>, 4>;
+  using Snapshot = std::vector<HalCallbackListener<RawFunctor>>;
+
+  /** Pins the current snapshot for the lifetime of this object. */
+  class SnapshotRef {
+   public:
+    explicit SnapshotRef(const SimCallbackRegistryBase& registry);
+    ~SnapshotRef();
+
+    SnapshotRef(const SnapshotRef&) = delete;
+    SnapshotRef& operator=(const SnapshotRef&) = delete;
+
+    const Snapshot* get() const { return m_snapshot; }
+
+   private:
+    std::atomic<int>* m_readers;
+    const Snapshot* m_snapshot;
+  };
 
  public:
+  SimCallbackRegistryBase() = default;
+  SimCallbackRegistryBase(const SimCallbackRegistryBase&) = delete;
+  SimCallbackRegistryBase& operator=(const SimCallbackRegistryBase&) = delete;
+  ~SimCallbackRegistryBase();
+
   void Cancel(int32_t uid) {
-    std::scoped_lock lock(m_mutex);
-    if (m_callbacks && uid > 0) {
+    {
+      std::scoped_lock lock(m_mutex);
+      if (!m_callbacks || uid <= 0) {
+        return;
+      }
       m_callbacks->erase(uid - 1);
+      Publish();
     }
+    Synchronize();
   }
 
   void Reset() {
-    std::scoped_lock lock(m_mutex);
-    DoReset();
+    {
+      std::scoped_lock lock(m_mutex);
+      DoReset();
+    }
+    Synchronize();
   }
 
   wpi::util::recursive_spinlock& GetMutex() { return m_mutex; }
@@ -48,17 +92,61 @@ class SimCallbackRegistryBase {
     if (!m_callbacks) {
       m_callbacks = std::make_unique<CallbackVector>();
     }
-    return m_callbacks->emplace_back(param, callback) + 1;
+    int32_t uid = m_callbacks->emplace_back(param, callback) + 1;
+    Publish();
+    return uid;
   }
 
   LLVM_ATTRIBUTE_ALWAYS_INLINE void DoReset() {
     if (m_callbacks) {
       m_callbacks->clear();
+      Publish();
     }
   }
 
+  /**
+   * Calls func for each callback in the current snapshot. Does not lock
+   * m_mutex.
+   */
+  template <typename F>
+  LLVM_ATTRIBUTE_ALWAYS_INLINE void ForEachCallback(F&& func) const {
+    // fast path for the common case of nothing registered
+    if (!m_snapshot.load(std::memory_order_relaxed)) {
+      return;
+    }
+    SnapshotRef snapshot{*this};
+    if (auto callbacks = snapshot.get()) {
+      for (auto&& cb : *callbacks) {
+        func(cb);
+      }
+    }
+  }
+
+  /**
+   * Replaces the snapshot with a copy of m_callbacks. The old snapshot is
+   * freed once no invocation can be using it. Must be called with m_mutex
+   * held.
+   */
+  void Publish();
+
+  /**
+   * Waits until invocations on other threads that started before the last
+   * Publish() have finished, then frees replaced snapshots. Must be called
+   * without m_mutex held. Called from within a callback it does not wait (the
+   * snapshots are freed later instead).
+   */
+  void Synchronize();
+
   mutable wpi::util::recursive_spinlock m_mutex;
   std::unique_ptr<CallbackVector> m_callbacks;
+
+ private:
+  std::atomic<const Snapshot*> m_snapshot{nullptr};
+  // readers of the snapshot, split by grace period epoch
+  mutable std::atomic<unsigned int> m_epoch{0};
+  mutable std::atomic<int> m_readers[2]{};
+  // replaced snapshots not yet freed; protected by m_mutex
+  std::vector<const Snapshot*> m_retired;
 };
 
 }  // namespace impl
@@ -79,14 +167,11 @@ class SimCallbackRegistry : public impl::SimCallbackRegistryBase {
 
   template <typename... U>
   void Invoke(U&&... u) const {
-    std::scoped_lock lock(m_mutex);
-    if (m_callbacks) {
-      const char* name = GetName();
-      for (auto&& cb : *m_callbacks) {
-        reinterpret_cast<CallbackFunction>(cb.callback)(name, cb.param,
-                                                        std::forward<U>(u)...);
-      }
-    }
+    const char* name = GetName();
+    ForEachCallback([&](const auto& cb) {
+      reinterpret_cast<CallbackFunction>(cb.callback)(name, cb.param,
+                                                      std::forward<U>(u)...);
+    });
   }
 
   template <typename... U>
@@ -29,9 +29,12 @@ class SimDataValueBase : protected SimCallbackRegistryBase {
   LLVM_ATTRIBUTE_ALWAYS_INLINE operator T() const { return Get(); }  // NOLINT
 
   void Reset(T value) {
-    std::scoped_lock lock(m_mutex);
-    DoReset();
-    m_value = value;
+    {
+      std::scoped_lock lock(m_mutex);
+      DoReset();
+      m_value = value;
+    }
+    Synchronize();
   }
 
   wpi::util::recursive_spinlock& GetMutex() { return m_mutex; }
@@ -54,11 +57,14 @@ class SimDataValueBase : protected SimCallbackRegistryBase {
   }
 
   void DoSet(T value, const char* name) {
-    std::scoped_lock lock(this->m_mutex);
-    if (m_value != value) {
+    {
+      std::scoped_lock lock(this->m_mutex);
+      if (m_value == value) {
+        return;
+      }
       m_value = value;
-      DoNotify(name);
     }
+    Invoke(name, MakeValue(value));
   }
 
   bool DoSetNoNotify(T value) {
@@ -70,15 +76,15 @@ class SimDataValueBase : protected SimCallbackRegistryBase {
     return true;
   }
 
-  void DoNotify(const char* name) {
-    std::scoped_lock lock(this->m_mutex);
-    if (m_callbacks) {
-      HAL_Value halValue = MakeValue(m_value);
-      for (auto&& cb : *m_callbacks) {
-        reinterpret_cast<HAL_NotifyCallback>(cb.callback)(name, cb.param,
-                                                          &halValue);
-      }
-    }
+  void DoNotify(const char* name) { Invoke(name, MakeValue(Get())); }
+
+  // Callbacks are called without m_mutex held, so they may use this value
+  // (including registering and cancelling callbacks on it).
+  void Invoke(const char* name, HAL_Value halValue) const {
+    ForEachCallback([&](const auto& cb) {
+      reinterpret_cast<HAL_NotifyCallback>(cb.callback)(name, cb.param,
+                                                        &halValue);
+    });
   }
 
   T m_value;
@@ -89,6 +95,12 @@ class SimDataValueBase : protected SimCallbackRegistryBase {
  * Simulation data value wrapper.  Provides callback functionality when the
  * data value is changed.
  *
+ * Callbacks are called after the value is set, without the lock held. When
+ * the value is set from multiple threads at once, callbacks for the sets may
+ * run concurrently and in a different order than the sets, so the last value
+ * a callback was called with may not be the current value. Use Get() for the
+ * current value.
+ *
  * @tparam T value type (e.g. double)
  * @tparam MakeValue function that takes a T and returns a HAL_Value
  * @tparam GetName function that returns a const char* for the name
@@ -117,6 +129,19 @@ class SimDataValue final : public impl::SimDataValueBase<T, MakeValue> {
   explicit SimDataValue(T value)
       : impl::SimDataValueBase<T, MakeValue>(value) {}
 
+  /**
+   * Register a callback to be called when the value changes.
+   *
+   * Callbacks for concurrent sets of the value may be called in a different
+   * order than the sets, so the value passed to the callback isn't
+   * necessarily the current value.
+   *
+   * @param callback the callback
+   * @param param parameter passed to the callback
+   * @param initialNotify if true, call the callback with the current value
+   *                      before returning
+   * @return the callback uid, or -1 if the callback is null
+   */
   LLVM_ATTRIBUTE_ALWAYS_INLINE int32_t RegisterCallback(
       HAL_NotifyCallback callback, void* param, HAL_Bool initialNotify) {
     return this->DoRegisterCallback(callback, param, initialNotify, GetName());
@@ -43,12 +43,9 @@ class SimPeriodicCallbackRegistry : public impl::SimCallbackRegistryBase {
   }
 
   void operator()() const {
-    std::scoped_lock lock(m_mutex);
-    if (m_callbacks) {
-      for (auto&& cb : *m_callbacks) {
-        reinterpret_cast<HALSIM_SimPeriodicCallback>(cb.callback)(cb.param);
-      }
-    }
+    ForEachCallback([](const auto& cb) {
+      reinterpret_cast<HALSIM_SimPeriodicCallback>(cb.callback)(cb.param);
+    });
   }
 };
 }  // namespace
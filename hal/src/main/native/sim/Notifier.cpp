@@ -6,6 +6,7 @@
 
 #include <sys/types.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstring>
@@ -26,6 +27,7 @@
 #include "wpi/util/SmallVector.hpp"
 #include "wpi/util/StringExtras.hpp"
 #include "wpi/util/Synchronization.hpp"
+#include "wpi/util/condition_variable.hpp"
 #include "wpi/util/priority_queue.hpp"
 #include "wpi/util/string.hpp"
 
@@ -48,8 +50,15 @@ class NotifierThread : public wpi::util::SafeThread {
 
   void ProcessAlarms(wpi::util::SmallVectorImpl<HAL_NotifierHandle>* signaled);
 
+  // Marks the last alarm as handled and wakes any DoWaitNotifiers caller
+  void Acknowledge(HAL_NotifierHandle handle, Notifier& notifier);
+
   bool m_paused = false;
 
+  // Notified (under m_mutex) whenever a handler acknowledges an alarm or a
+  // notifier is destroyed, so simulated time stepping never has to poll
+  wpi::util::condition_variable m_ackCond;
+
   UnlimitedHandleResource<HAL_NotifierHandle, Notifier,
                           HAL_HandleEnum::NOTIFIER>
       m_handles;
@@ -154,6 +163,13 @@ void NotifierThread::ProcessAlarms(
   }
 }
 
+void NotifierThread::Acknowledge(HAL_NotifierHandle handle,
+                                 Notifier& notifier) {
+  notifier.handlerSignaled.clear();
+  wpi::util::ResetSignalObject(handle);
+  m_ackCond.notify_all();
+}
+
 void wpi::hal::PauseNotifiers() {
   auto thr = notifierInstance->owner.GetThread();
   thr->m_paused = true;
@@ -173,8 +189,10 @@ void wpi::hal::WakeupNotifiers() {
 static void DoWaitNotifiers(
     wpi::util::detail::SafeThreadProxy<NotifierThread>& thr,
     wpi::util::SmallVectorImpl<HAL_NotifierHandle>& signaled) {
-  // Wait for signaled notifiers to acknowledge their last alarm
-  for (;;) {
+  // Wait for signaled notifiers to acknowledge their last alarm. Handlers
+  // notify m_ackCond when they do, so this returns as soon as the last one
+  // finishes rather than on the next poll.
+  thr->m_ackCond.wait(thr.GetLock(), [&] {
     signaled.erase(std::remove_if(signaled.begin(), signaled.end(),
                                   [&](HAL_NotifierHandle handle) {
                                     auto notifier = thr->m_handles.Get(handle);
@@ -182,11 +200,8 @@ static void DoWaitNotifiers(
                                            !notifier->handlerSignaled.test();
                                   }),
                    signaled.end());
-    if (signaled.empty()) {
-      break;
-    }
-    thr->m_cond.wait_for(thr.GetLock(), std::chrono::milliseconds{1});
-  }
+    return signaled.empty();
+  });
 }
 
 void wpi::hal::WaitNotifiers() {
@@ -243,6 +258,7 @@ void HAL_DestroyNotifier(HAL_NotifierHandle notifierHandle) {
   auto thr = notifierInstance->owner.GetThread();
   auto notifier = thr->m_handles.Free(notifierHandle);
   thr->m_alarmQueue.remove({notifierHandle, notifier});
+  thr->m_ackCond.notify_all();
 }
 
 void HAL_SetNotifierAlarm(HAL_NotifierHandle notifierHandle, uint64_t alarmTime,
@@ -255,8 +271,7 @@ void HAL_SetNotifierAlarm(HAL_NotifierHandle notifierHandle, uint64_t alarmTime,
   }
 
   if (ack) {
-    notifier->handlerSignaled.clear();
-    wpi::util::ResetSignalObject(notifierHandle);
+    thr->Acknowledge(notifierHandle, *notifier);
   }
 
   if (!absolute) {
@@ -289,8 +304,7 @@ void HAL_CancelNotifierAlarm(HAL_NotifierHandle notifierHandle, HAL_Bool ack,
   }
 
   if (ack) {
-    notifier->handlerSignaled.clear();
-    wpi::util::ResetSignalObject(notifierHandle);
+    thr->Acknowledge(notifierHandle, *notifier);
   }
 
   thr->m_alarmQueue.remove({notifierHandle, notifier});
@@ -304,8 +318,7 @@ void HAL_AcknowledgeNotifierAlarm(HAL_NotifierHandle notifierHandle,
   if (!notifier) {
     return;
   }
-  notifier->handlerSignaled.clear();
-  wpi::util::ResetSignalObject(notifierHandle);
+  thr->Acknowledge(notifierHandle, *notifier);
 }
 
 int32_t HAL_GetNotifierOverrun(HAL_NotifierHandle notifierHandle,
@@ -0,0 +1,102 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/hal/simulation/SimCallbackRegistry.hpp"
+
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "wpi/util/mutex.hpp"
+
+using namespace wpi::hal::impl;
+
+// number of snapshots pinned by this thread; nonzero while in a callback
+static thread_local int gPinnedSnapshots = 0;
+// serializes grace period waits so epoch flips can't race
+static wpi::util::mutex gSynchronizeMutex;
+
+SimCallbackRegistryBase::SnapshotRef::SnapshotRef(
+    const SimCallbackRegistryBase& registry) {
+  // Count this reader in the current epoch. If the epoch flipped before we
+  // were counted, Synchronize() may have already checked that counter, so
+  // retry in the new epoch.
+  for (;;) {
+    unsigned int epoch = registry.m_epoch.load();
+    m_readers = &registry.m_readers[epoch & 1];
+    m_readers->fetch_add(1);
+    if (registry.m_epoch.load() == epoch) {
+      break;
+    }
+    m_readers->fetch_sub(1);
+  }
+  m_snapshot = registry.m_snapshot.load();
+  ++gPinnedSnapshots;
+}
+
+SimCallbackRegistryBase::SnapshotRef::~SnapshotRef() {
+  --gPinnedSnapshots;
+  m_readers->fetch_sub(1);
+}
+
+SimCallbackRegistryBase::~SimCallbackRegistryBase() {
+  delete m_snapshot.load();
+  for (auto snapshot : m_retired) {
+    delete snapshot;
+  }
+}
+
+void SimCallbackRegistryBase::Publish() {
+  Snapshot* snapshot = nullptr;
+  if (m_callbacks && !m_callbacks->empty()) {
+    snapshot = new Snapshot;
+    for (auto&& cb : *m_callbacks) {
+      snapshot->emplace_back(cb);
+    }
+  }
+  auto old = m_snapshot.exchange(snapshot);
+  if (old) {
+    m_retired.emplace_back(old);
+  }
+
+  // Any reader of a replaced snapshot was counted before the exchange above,
+  // so if nothing is counted now they can all be freed without waiting.
+  if (m_readers[0].load() == 0 && m_readers[1].load() == 0) {
+    for (auto retired : m_retired) {
+      delete retired;
+    }
+    m_retired.clear();
+  }
+}
+
+void SimCallbackRegistryBase::Synchronize() {
+  // Waiting from within a callback could wait on ourselves (or on a thread
+  // waiting for us); leave the replaced snapshots for a later call instead.
+  if (gPinnedSnapshots != 0) {
+    return;
+  }
+
+  std::scoped_lock syncLock{gSynchronizeMutex};
+  std::vector<const Snapshot*> retired;
+  {
+    std::scoped_lock lock(m_mutex);
+    retired.swap(m_retired);
+  }
+  // everything replaced was already freed, so no reader can be using it
+  if (retired.empty()) {
+    return;
+  }
+
+  // New readers are counted in the new epoch and see the current snapshot;
+  // wait for the readers counted in the old epoch to finish.
+  unsigned int epoch = m_epoch.fetch_add(1);
+  auto& readers = m_readers[epoch & 1];
+  while (readers.load() != 0) {
+    std::this_thread::yield();
+  }
+
+  for (auto snapshot : retired) {
+    delete snapshot;
+  }
+}
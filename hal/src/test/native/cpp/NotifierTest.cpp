@@ -0,0 +1,47 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/hal/Notifier.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "wpi/hal/HAL.h"
+#include "wpi/hal/simulation/MockHooks.h"
+#include "wpi/util/Synchronization.hpp"
+
+namespace wpi::hal {
+TEST_CASE("NotifierTest StepTimingWaitsForAck", "[hal]") {
+  HALSIM_PauseTiming();
+
+  int32_t status = 0;
+  HAL_NotifierHandle notifier = HAL_CreateNotifier(&status);
+  REQUIRE(status == 0);
+  std::atomic<int> loops = 0;
+  std::thread handler{[&] {
+    while (wpi::util::WaitForObject(notifier)) {
+      // simulate some robot code work before acknowledging
+      std::this_thread::sleep_for(std::chrono::microseconds{100});
+      ++loops;
+      int32_t ackStatus = 0;
+      HAL_AcknowledgeNotifierAlarm(notifier, &ackStatus);
+    }
+  }};
+  HAL_SetNotifierAlarm(notifier, 20000, 20000, false, false, &status);
+
+  // every alarm is handled before the next step, so none are skipped
+  for (int i = 1; i <= 10; ++i) {
+    HALSIM_StepTiming(100000);
+    CHECK(loops == 5 * i);
+  }
+  CHECK(HAL_GetNotifierOverrun(notifier, &status) == 0);
+
+  HAL_DestroyNotifier(notifier);
+  handler.join();
+  HALSIM_ResumeTiming();
+}
+}  // namespace wpi::hal
@@ -0,0 +1,178 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/hal/simulation/SimCallbackRegistry.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "wpi/hal/Value.h"
+#include "wpi/hal/simulation/SimDataValue.hpp"
+
+namespace wpi::hal {
+
+namespace {
+
+using TestCallback = void (*)(const char* name, void* param, int value);
+
+HAL_SIMCALLBACKREGISTRY_DEFINE_NAME(Test)
+HAL_SIMDATAVALUE_DEFINE_NAME(Value)
+
+using TestRegistry = SimCallbackRegistry<TestCallback, GetTestName>;
+
+struct SelfCancel {
+  TestRegistry* registry;
+  int32_t uid = 0;
+  int calls = 0;
+};
+
+struct Counter {
+  int calls = 0;
+  int lastValue = 0;
+};
+
+void CountCallback(const char* name, void* param, int value) {
+  auto counter = static_cast<Counter*>(param);
+  ++counter->calls;
+  counter->lastValue = value;
+}
+
+}  // namespace
+
+TEST_CASE("SimCallbackRegistryTest CancelSelfDuringInvoke",
+          "[hal][mockdata]") {
+  TestRegistry registry;
+  SelfCancel data{&registry};
+  Counter counter;
+  data.uid = registry.Register(
+      [](const char* name, void* param, int value) {
+        auto data = static_cast<SelfCancel*>(param);
+        ++data->calls;
+        data->registry->Cancel(data->uid);
+      },
+      &data);
+  registry.Register(CountCallback, &counter);
+
+  registry(1);
+  registry(2);
+  CHECK(data.calls == 1);
+  // cancelling from a callback does not skip the rest of the invoke
+  CHECK(counter.calls == 2);
+  CHECK(counter.lastValue == 2);
+}
+
+TEST_CASE("SimCallbackRegistryTest RegisterDuringInvoke", "[hal][mockdata]") {
+  struct Data {
+    TestRegistry registry;
+    Counter counter;
+    int registered = 0;
+  } data;
+  data.registry.Register(
+      [](const char* name, void* param, int value) {
+        auto data = static_cast<Data*>(param);
+        // registrations take effect on the next invoke
+        if (data->registered++ < 100) {
+          data->registry.Register(CountCallback, &data->counter);
+        }
+      },
+      &data);
+
+  data.registry(1);
+  CHECK(data.counter.calls == 0);
+  data.registry(2);
+  CHECK(data.counter.calls == 1);
+  data.registry(3);
+  CHECK(data.counter.calls == 3);
+}
+
+TEST_CASE("SimCallbackRegistryTest CancelWaitsForInvoke", "[hal][mockdata]") {
+  struct Data {
+    std::atomic_bool entered{false};
+    std::atomic_bool release{false};
+    std::atomic_bool exited{false};
+  } data;
+  TestRegistry registry;
+  int32_t uid = registry.Register(
+      [](const char* name, void* param, int value) {
+        auto data = static_cast<Data*>(param);
+        data->entered = true;
+        while (!data->release) {
+          std::this_thread::yield();
+        }
+        data->exited = true;
+      },
+      &data);
+
+  std::thread invoker{[&] { registry(1); }};
+  while (!data.entered) {
+    std::this_thread::yield();
+  }
+  std::thread releaser{[&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    data.release = true;
+  }};
+  registry.Cancel(uid);
+  CHECK(data.exited);
+  invoker.join();
+  releaser.join();
+}
+
+TEST_CASE("SimCallbackRegistryTest ConcurrentInvoke", "[hal][mockdata]") {
+  TestRegistry registry;
+  std::atomic_int calls{0};
+  registry.Register(
+      [](const char* name, void* param, int value) {
+        ++*static_cast<std::atomic_int*>(param);
+      },
+      &calls);
+
+  std::atomic_bool done{false};
+  std::thread churn{[&] {
+    while (!done) {
+      registry.Cancel(registry.Register(
+          [](const char* name, void* param, int value) {}, nullptr));
+    }
+  }};
+  std::thread threads[4];
+  for (auto&& thr : threads) {
+    thr = std::thread{[&] {
+      for (int i = 0; i < 10000; ++i) {
+        registry(i);
+      }
+    }};
+  }
+  for (auto&& thr : threads) {
+    thr.join();
+  }
+  done = true;
+  churn.join();
+  CHECK(calls == 40000);
+}
+
+TEST_CASE("SimCallbackRegistryTest ValueCallbackReadsValue",
+          "[hal][mockdata]") {
+  using Value = SimDataValue<int32_t, HAL_MakeInt, GetValueName>;
+  struct Data {
+    Value value{0};
+    int32_t uid = 0;
+    int32_t seen = -1;
+  } data;
+  data.uid = data.value.RegisterCallback(
+      [](const char* name, void* param, const HAL_Value* value) {
+        auto data = static_cast<Data*>(param);
+        data->seen = data->value.Get();
+        data->value.CancelCallback(data->uid);
+      },
+      &data, false);
+
+  data.value.Set(5);
+  data.value.Set(6);
+  CHECK(data.seen == 5);
+  CHECK(data.value.Get() == 6);
+}
+
+}  // namespace wpi::hal
@@ -104,7 +104,8 @@ void InstanceImpl::StopLocal() {
 void InstanceImpl::StartServer(std::string_view persistFilename,
                                std::string_view listenAddress,
                                std::string_view mdnsService,
-                               unsigned int port) {
+                               unsigned int port, unsigned int ioThreads,
+                               bool persistJournal) {
   std::scoped_lock lock{m_mutex};
   if (networkMode != NT_NET_MODE_NONE) {
     return;
@@ -117,7 +118,8 @@ void InstanceImpl::StartServer(std::string_view persistFilename,
         if (announcingmDNS) {
           networkMode |= NT_NET_MODE_MDNS_ANNOUNCING;
         }
-      });
+      },
+      ioThreads, persistJournal);
   networkMode = NT_NET_MODE_SERVER | NT_NET_MODE_STARTING;
   listenerStorage.NotifyTimeSync({}, NT_EVENT_TIME_SYNC, 0, 0, true);
   m_serverTimeOffset = 0;
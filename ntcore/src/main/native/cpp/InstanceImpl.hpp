@@ -45,7 +45,8 @@ class InstanceImpl {
   void StopLocal();
   void StartServer(std::string_view persistFilename,
                    std::string_view listenAddress, std::string_view mdnsService,
-                   unsigned int port);
+                   unsigned int port, unsigned int ioThreads,
+                   bool persistJournal);
   void StopServer();
   void StartClient(std::string_view identity);
   void StopClient();
@@ -5,9 +5,12 @@
 #include "ListenerStorage.hpp"
 
 #include <algorithm>
+#include <memory>
+#include <span>
 #include <utility>
 #include <vector>
 
+#include "InstanceImpl.hpp"
 #include "wpi/nt/ntcore_c.h"
 #include "wpi/util/SmallVector.hpp"
 
@@ -22,20 +25,37 @@ void ListenerStorage::Thread::Main() {
     if (signaled.empty() || !m_active) {
       return;
     }
-    // call all the way back out to the C++ API to ensure valid handle
-    auto events = wpi::nt::ReadListenerQueue(m_poller);
-    if (!events.empty()) {
-      std::unique_lock lock{m_mutex};
-      for (auto&& event : events) {
-        auto callbackIt = m_callbacks.find(event.listener);
+    // look up the instance from the handle to ensure it's still valid
+    if (auto ii = InstanceImpl::GetTyped(m_poller, Handle::LISTENER_POLLER)) {
+      ii->listenerStorage.ReadListenerQueue(m_poller, &m_events);
+    }
+    // deliver each run of events for the same listener with a single lookup
+    std::span<const Event> events{m_events};
+    while (!events.empty()) {
+      NT_Listener listener = events.front().listener;
+      size_t count = 1;
+      while (count < events.size() && events[count].listener == listener) {
+        ++count;
+      }
+      std::shared_ptr<Callback> callback;
+      {
+        std::scoped_lock lock{m_mutex};
+        auto callbackIt = m_callbacks.find(listener);
         if (callbackIt != m_callbacks.end()) {
-          auto callback = callbackIt->second;
-          lock.unlock();
-          callback(event);
-          lock.lock();
+          callback = callbackIt->second;
+        }
+      }
+      if (callback) {
+        for (auto&& event : events.first(count)) {
+          if (callback->removed.load(std::memory_order_relaxed)) {
+            break;
+          }
+          callback->func(event);
         }
       }
+      events = events.subspan(count);
     }
+    m_events.clear();
     if (std::find(signaled.begin(), signaled.end(),
                   m_waitQueueWakeup.GetHandle()) != signaled.end()) {
       m_waitQueueWaiter.Set();
@@ -43,6 +63,18 @@ void ListenerStorage::Thread::Main() {
   }
 }
 
+void ListenerStorage::Signal(ListenerData& listener) {
+  if (!listener.signaled) {
+    listener.signaled = true;
+    listener.handle.Set();
+    listener.poller->signaledListeners.emplace_back(listener.handle);
+  }
+  if (!listener.poller->signaled) {
+    listener.poller->signaled = true;
+    listener.poller->handle.Set();
+  }
+}
+
 void ListenerStorage::Activate(NT_Listener listenerHandle, unsigned int mask,
                                FinishEventFunc finishEvent) {
   std::scoped_lock lock{m_mutex};
@@ -89,8 +121,7 @@ void ListenerStorage::Notify(std::span<const NT_Listener> handles,
           }
         }
       }
-      listener.handle.Set();
-      listener.poller->handle.Set();
+      Signal(listener);
     }
   };
 
@@ -132,8 +163,7 @@ void ListenerStorage::Notify(std::span<const NT_Listener> handles,
         }
       }
       if (count > 0) {
-        listener.handle.Set();
-        listener.poller->handle.Set();
+        Signal(listener);
       }
     }
   };
@@ -175,8 +205,7 @@ void ListenerStorage::Notify(std::span<const NT_Listener> handles,
         }
       }
       if (count > 0) {
-        listener.handle.Set();
-        listener.poller->handle.Set();
+        Signal(listener);
       }
     }
   };
@@ -217,8 +246,7 @@ void ListenerStorage::Notify(unsigned int flags, unsigned int level,
         }
       }
       if (count > 0) {
-        listener->handle.Set();
-        listener->poller->handle.Set();
+        Signal(*listener);
       }
     }
   }
@@ -242,8 +270,7 @@ void ListenerStorage::NotifyTimeSync(std::span<const NT_Listener> handles,
           // finishEvent is never set (see InstanceImpl)
         }
       }
-      listener.handle.Set();
-      listener.poller->handle.Set();
+      Signal(listener);
     }
   };
 
@@ -268,7 +295,8 @@ NT_Listener ListenerStorage::AddListener(ListenerCallback callback) {
   if (auto thr = m_thread.GetThread()) {
     auto listener = DoAddListener(thr->m_poller);
     if (listener) {
-      thr->m_callbacks.try_emplace(listener, std::move(callback));
+      thr->m_callbacks.try_emplace(
+          listener, std::make_shared<Thread::Callback>(std::move(callback)));
     }
     return listener;
   } else {
@@ -281,6 +309,16 @@ NT_Listener ListenerStorage::AddListener(NT_ListenerPoller pollerHandle) {
   return DoAddListener(pollerHandle);
 }
 
+void ListenerStorage::ClearSignaled(PollerData& poller) {
+  poller.signaled = false;
+  for (auto handle : poller.signaledListeners) {
+    if (auto listener = m_listeners.Get(handle)) {
+      listener->signaled = false;
+    }
+  }
+  poller.signaledListeners.clear();
+}
+
 NT_Listener ListenerStorage::DoAddListener(NT_ListenerPoller pollerHandle) {
   if (auto poller = m_pollers.Get(pollerHandle)) {
     return m_listeners.Add(m_inst, poller)->handle;
@@ -317,12 +355,23 @@ std::vector<Event> ListenerStorage::ReadListenerQueue(
   if (auto poller = m_pollers.Get(pollerHandle)) {
     std::vector<Event> rv;
     rv.swap(poller->queue);
+    ClearSignaled(*poller);
     return rv;
   } else {
     return {};
   }
 }
 
+void ListenerStorage::ReadListenerQueue(NT_ListenerPoller pollerHandle,
+                                        std::vector<Event>* out) {
+  out->clear();
+  std::scoped_lock lock{m_mutex};
+  if (auto poller = m_pollers.Get(pollerHandle)) {
+    out->swap(poller->queue);
+    ClearSignaled(*poller);
+  }
+}
+
 std::vector<std::pair<NT_Listener, unsigned int>>
 ListenerStorage::RemoveListener(NT_Listener listenerHandle) {
   std::scoped_lock lock{m_mutex};
@@ -368,7 +417,11 @@ ListenerStorage::DoRemoveListeners(std::span<const NT_Listener> handles) {
       rv.emplace_back(handle, listener->eventMask);
       if (thr) {
         if (thr->m_poller == listener->poller->handle) {
-          thr->m_callbacks.erase(handle);
+          auto callbackIt = thr->m_callbacks.find(handle);
+          if (callbackIt != thr->m_callbacks.end()) {
+            callbackIt->second->removed = true;
+            thr->m_callbacks.erase(callbackIt);
+          }
         }
       }
       if ((listener->eventMask & NT_EVENT_CONNECTION) != 0) {
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <span>
@@ -55,6 +56,10 @@ class ListenerStorage final : public IListenerStorage {
       NT_ListenerPoller pollerHandle);
 
   std::vector<Event> ReadListenerQueue(NT_ListenerPoller pollerHandle);
+  // swaps the queue with out (which is cleared first), so the poller and the
+  // caller reuse each other's allocations
+  void ReadListenerQueue(NT_ListenerPoller pollerHandle,
+                         std::vector<Event>* out);
 
   // returns listener handle and mask for each listener that was destroyed
   [[nodiscard]]
@@ -66,7 +71,12 @@ class ListenerStorage final : public IListenerStorage {
   void Reset();
 
  private:
+  struct PollerData;
+  struct ListenerData;
+
   // these assume the mutex is already held
+  void Signal(ListenerData& listener);
+  void ClearSignaled(PollerData& poller);
   NT_Listener DoAddListener(NT_ListenerPoller pollerHandle);
   std::vector<std::pair<NT_Listener, unsigned int>> DoRemoveListeners(
       std::span<const NT_Listener> handles);
@@ -81,6 +91,10 @@ class ListenerStorage final : public IListenerStorage {
 
     wpi::util::SignalObject<NT_ListenerPoller> handle;
     std::vector<Event> queue;
+    // handle and listener handles are only set when not already signaled
+    // since the queue was last read, so a burst of events is a single wakeup
+    bool signaled{false};
+    std::vector<NT_Listener> signaledListeners;
   };
   HandleMap<PollerData, 8> m_pollers;
 
@@ -94,6 +108,7 @@ class ListenerStorage final : public IListenerStorage {
     PollerData* poller;
     wpi::util::SmallVector<std::pair<FinishEventFunc, unsigned int>, 2> sources;
     unsigned int eventMask{0};
+    bool signaled{false};
   };
   HandleMap<ListenerData, 8> m_listeners;
 
@@ -109,8 +124,17 @@ class ListenerStorage final : public IListenerStorage {
 
     void Main() final;
 
+    struct Callback {
+      explicit Callback(ListenerCallback func) : func{std::move(func)} {}
+
+      ListenerCallback func;
+      // set on removal so the rest of a batch is not delivered
+      std::atomic<bool> removed{false};
+    };
+
     NT_ListenerPoller m_poller;
-    wpi::util::DenseMap<NT_Listener, ListenerCallback> m_callbacks;
+    wpi::util::DenseMap<NT_Listener, std::shared_ptr<Callback>> m_callbacks;
+    std::vector<Event> m_events;
     wpi::util::Event m_waitQueueWakeup;
     wpi::util::Event m_waitQueueWaiter;
   };
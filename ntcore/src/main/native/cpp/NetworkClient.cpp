@@ -257,9 +257,6 @@ void NetworkClientBase::UpdateConnectorServers() {
 }
 
 void NetworkClientBase::DoDisconnect(std::string_view reason) {
-  if (m_readLocalTimer) {
-    m_readLocalTimer->Stop();
-  }
   if (m_sendOutgoingTimer) {
     m_sendOutgoingTimer->Stop();
   }
@@ -289,17 +286,6 @@ NetworkClient::NetworkClient(
         loop, kReconnectRate, m_logger,
         [this](uv::Tcp& tcp) { TcpConnected(tcp); }, true);
 
-    m_readLocalTimer = uv::Timer::Create(loop);
-    if (m_readLocalTimer) {
-      m_readLocalTimer->timeout.connect([this] {
-        if (m_clientImpl) {
-          HandleLocal();
-          m_clientImpl->SendOutgoing(m_loop.Now().count(), false);
-        }
-      });
-      m_readLocalTimer->Start(uv::Timer::Time{100}, uv::Timer::Time{100});
-    }
-
     m_sendOutgoingTimer = uv::Timer::Create(loop);
     if (m_sendOutgoingTimer) {
       m_sendOutgoingTimer->timeout.connect([this] {
@@ -327,6 +313,11 @@ NetworkClient::NetworkClient(
       m_flushLocal->wakeup.connect([this] { HandleLocal(); });
     }
     m_flushLocalAtomic = m_flushLocal.get();
+
+    // process local changes as they are made; they are sent to the server
+    // at the periodic rate by the send outgoing timer
+    m_localWakeup.emplace(loop, [this] { HandleLocal(); });
+    m_localQueue.SetWakeup([wakeup = &*m_localWakeup] { wakeup->Send(); });
   });
 }
 
@@ -365,6 +356,9 @@ void NetworkClient::TcpConnected(uv::Tcp& tcp) {
   }
   wpi::net::WebSocket::ClientOptions options;
   options.handshakeTimeout = kWebsocketHandshakeTimeout;
+  // compress the JSON control messages (e.g. publish bursts); binary value
+  // updates are small and latency sensitive
+  options.deflate.emplace().compressBinary = false;
   wpi::util::SmallString<128> idBuf;
   auto ws = wpi::net::WebSocket::CreateClient(
       tcp, std::format("/nt/{}", wpi::net::EscapeURI(m_id, idBuf)), "",
@@ -17,6 +17,7 @@
 #include "INetworkClient.hpp"
 #include "net/ClientImpl.hpp"
 #include "net/ClientMessageQueue.hpp"
+#include "net/LocalQueueWakeup.hpp"
 #include "net/Message.hpp"
 #include "net/WebSocketConnection.hpp"
 #include "wpi/net/DsClient.hpp"
@@ -84,10 +85,10 @@ class NetworkClientBase : public INetworkClient {
 
   // used only from loop
   std::shared_ptr<wpi::net::ParallelTcpConnector> m_parallelConnect;
-  std::shared_ptr<wpi::net::uv::Timer> m_readLocalTimer;
   std::shared_ptr<wpi::net::uv::Timer> m_sendOutgoingTimer;
   std::shared_ptr<wpi::net::uv::Async<>> m_flushLocal;
   std::shared_ptr<wpi::net::uv::Async<>> m_flush;
+  std::optional<net::LocalQueueWakeup> m_localWakeup;
 
   using Queue = net::LocalClientMessageQueue;
   net::ClientMessage m_localMsgs[Queue::kBlockSize];
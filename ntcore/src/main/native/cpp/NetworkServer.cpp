@@ -6,18 +6,24 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <atomic>
 #include <format>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <span>
 #include <string>
 #include <system_error>
+#include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include "IConnectionList.hpp"
 #include "InstanceImpl.hpp"
 #include "Log.hpp"
+#include "net/MessageHandler.hpp"
 #include "net/WebSocketConnection.hpp"
 #include "net/WireDecoder.hpp"
 #include "net/WireEncoder.hpp"
@@ -32,6 +38,7 @@
 #include "wpi/util/fs.hpp"
 #include "wpi/util/mutex.hpp"
 #include "wpi/util/raw_ostream.hpp"
+#include "wpi/util/sha1.hpp"
 #include "wpi/util/timestamp.h"
 
 using namespace wpi::nt;
@@ -43,32 +50,191 @@ static constexpr size_t kMaxMessageSize = 2 * 1024 * 1024;
 static constexpr size_t kClientProcessMessageCountMax = 16;
 static constexpr uv::Timer::Time kHandshakeTimeout{5000};
 
+// the journal is compacted once it is larger than both this and the
+// persistent file
+static constexpr size_t kJournalCompactMinSize = 64 * 1024;
+
+// The first line of a journal; identifies the persistent file contents the
+// journal applies to. Carriage returns are ignored since the persistent file
+// is written in text mode.
+static std::string JournalHeader(std::string_view persistentData) {
+  wpi::util::SHA1 sha;
+  wpi::util::split(persistentData, '\r', -1, true,
+                   [&](auto part) { sha.Update(part); });
+  return std::format("{{\"snapshot\":\"{}\"}}\n", sha.Final());
+}
+
+namespace {
+
+// Collects decoded client messages so they can be handed to another thread
+class ClientMessageCollector final : public net::ClientMessageHandler {
+ public:
+  void ClientPublish(int pubuid, std::string_view name,
+                     std::string_view typeStr,
+                     const wpi::util::json& properties,
+                     const PubSubOptionsImpl& options) final {
+    msgs.emplace_back(net::ClientMessage{net::PublishMsg{
+        pubuid, std::string{name}, std::string{typeStr}, properties, options}});
+  }
+
+  void ClientUnpublish(int pubuid) final {
+    msgs.emplace_back(net::ClientMessage{net::UnpublishMsg{pubuid}});
+  }
+
+  void ClientSetProperties(std::string_view name,
+                           const wpi::util::json& update) final {
+    msgs.emplace_back(
+        net::ClientMessage{net::SetPropertiesMsg{std::string{name}, update}});
+  }
+
+  void ClientSubscribe(int subuid, std::span<const std::string> topicNames,
+                       const PubSubOptionsImpl& options) final {
+    msgs.emplace_back(net::ClientMessage{
+        net::SubscribeMsg{subuid, {topicNames.begin(), topicNames.end()},
+                          options}});
+  }
+
+  void ClientUnsubscribe(int subuid) final {
+    msgs.emplace_back(net::ClientMessage{net::UnsubscribeMsg{subuid}});
+  }
+
+  void ClientSetValue(int pubuid, const Value& value) final {
+    msgs.emplace_back(net::ClientMessage{net::ClientValueMsg{pubuid, value}});
+  }
+
+  std::vector<net::ClientMessage> msgs;
+};
+
+}  // namespace
+
+// Runs functions posted from any thread on a loop. Unlike
+// EventLoopRunner::ExecAsync(), functions are not run while holding the
+// queue's lock, so a function may post to any other queue (the storage and
+// I/O loops post to each other).
+class NetworkServer::TaskQueue {
+ public:
+  using Task = std::function<void()>;
+
+  // Must be called from the loop thread; runs anything posted before now
+  void Start(uv::Loop& loop) {
+    auto async = uv::Async<>::Create(loop);
+    if (!async) {
+      return;
+    }
+    async->wakeup.connect([this] { RunAll(); });
+    {
+      std::scoped_lock lock{m_mutex};
+      if (m_closed) {
+        async->Close();
+        return;
+      }
+      m_async = std::move(async);
+      m_loopThread = std::this_thread::get_id();
+    }
+    RunAll();
+  }
+
+  // Tasks posted from the loop thread itself are run immediately
+  void Post(Task task) {
+    std::unique_lock lock{m_mutex};
+    if (m_closed) {
+      return;
+    }
+    if (m_async && std::this_thread::get_id() == m_loopThread) {
+      lock.unlock();
+      task();
+      return;
+    }
+    m_tasks.emplace_back(std::move(task));
+    if (m_async && m_tasks.size() == 1) {
+      m_async->UnsafeSend();
+    }
+  }
+
+  // Discards pending tasks; later posts are ignored
+  void Close() {
+    std::vector<Task> tasks;
+    std::scoped_lock lock{m_mutex};
+    m_closed = true;
+    m_tasks.swap(tasks);
+    m_async.reset();
+  }
+
+ private:
+  void RunAll() {
+    {
+      std::scoped_lock lock{m_mutex};
+      m_running.swap(m_tasks);
+    }
+    for (auto&& task : m_running) {
+      if (m_closed) {
+        break;
+      }
+      task();
+    }
+    m_running.clear();
+  }
+
+  wpi::util::mutex m_mutex;
+  std::vector<Task> m_tasks;
+  std::shared_ptr<uv::Async<>> m_async;
+  std::thread::id m_loopThread;
+  std::atomic_bool m_closed{false};
+
+  // used only from loop
+  std::vector<Task> m_running;
+};
+
+// Storage loop state for a NT4 client. Only the wire may be used from the
+// connection's loop.
+struct NetworkServer::Client {
+  Client(std::shared_ptr<net::WebSocketConnection> wire,
+         const ConnectionInfo& info, std::string_view name,
+         std::string_view connInfo)
+      : wire{std::move(wire)}, info{info}, name{name}, connInfo{connInfo} {}
+
+  std::shared_ptr<net::WebSocketConnection> wire;
+  ConnectionInfo info;
+  std::string name;
+  std::string connInfo;
+  int id = -1;
+  std::shared_ptr<uv::Timer> outgoingTimer;
+};
+
+struct NetworkServer::IoLoop {
+  IoLoop() {
+    runner.ExecAsync([tasks = tasks](uv::Loop& loop) { tasks->Start(loop); });
+  }
+  ~IoLoop() {
+    tasks->Close();
+    runner.Stop();
+  }
+
+  std::shared_ptr<TaskQueue> tasks = std::make_shared<TaskQueue>();
+  wpi::net::EventLoopRunner runner;
+};
+
 class NetworkServer::ServerConnection {
  public:
   ServerConnection(NetworkServer& server, std::string_view addr,
-                   unsigned int port, wpi::util::Logger& logger)
+                   unsigned int port, std::shared_ptr<TaskQueue> tasks,
+                   wpi::util::Logger& logger)
       : m_server{server},
         m_connInfo{std::format("{}:{}", addr, port)},
+        m_tasks{std::move(tasks)},
         m_logger{logger} {
     m_info.remote_ip = addr;
     m_info.remote_port = port;
   }
 
-  int GetClientId() const { return m_clientId; }
-
  protected:
-  void SetupOutgoingTimer();
-  void UpdateOutgoingTimer(uint32_t repeatMs);
-  void ConnectionClosed();
-
   NetworkServer& m_server;
   ConnectionInfo m_info;
   std::string m_connInfo;
+  // tasks for this connection's I/O loop; null if it is the storage loop
+  std::shared_ptr<TaskQueue> m_tasks;
   wpi::util::Logger& m_logger;
-  int m_clientId;
-
- private:
-  std::shared_ptr<uv::Timer> m_outgoingTimer;
+  std::shared_ptr<Client> m_client;
 };
 
 class NetworkServer::ServerConnection4 final
@@ -77,53 +243,28 @@ class NetworkServer::ServerConnection4 final
  public:
   ServerConnection4(std::shared_ptr<uv::Stream> stream, NetworkServer& server,
                     std::string_view addr, unsigned int port,
+                    std::shared_ptr<TaskQueue> tasks,
                     wpi::util::Logger& logger)
-      : ServerConnection{server, addr, port, logger},
+      : ServerConnection{server, addr, port, std::move(tasks), logger},
         HttpWebSocketServerConnection(
             stream,
             {"v4.1.networktables.first.wpi.edu", "networktables.first.wpi.edu",
              "rtt.networktables.first.wpi.edu"},
             kHandshakeTimeout) {
     m_info.protocol_version = 0x0400;
+    // compress the JSON control messages (e.g. announce bursts); binary value
+    // updates are small and latency sensitive
+    m_deflateOptions.emplace().compressBinary = false;
   }
 
  private:
   void ProcessRequest() final;
   void ProcessWsUpgrade() final;
+  void ProcessDecoded(std::vector<net::ClientMessage> msgs);
 
   std::shared_ptr<net::WebSocketConnection> m_wire;
 };
 
-void NetworkServer::ServerConnection::SetupOutgoingTimer() {
-  m_outgoingTimer = uv::Timer::Create(m_server.m_loop);
-  m_outgoingTimer->timeout.connect([this] {
-    m_server.m_serverImpl.SendOutgoing(m_clientId,
-                                       m_server.m_loop.Now().count());
-  });
-}
-
-void NetworkServer::ServerConnection::UpdateOutgoingTimer(uint32_t repeatMs) {
-  DEBUG4("Setting periodic timer to {}", repeatMs);
-  if (repeatMs == UINT32_MAX) {
-    m_outgoingTimer->Stop();
-  } else if (!m_outgoingTimer->IsActive() ||
-             uv::Timer::Time{repeatMs} != m_outgoingTimer->GetRepeat()) {
-    m_outgoingTimer->Start(uv::Timer::Time{repeatMs},
-                           uv::Timer::Time{repeatMs});
-  }
-}
-
-void NetworkServer::ServerConnection::ConnectionClosed() {
-  // don't call back into m_server if it's being destroyed
-  if (!m_outgoingTimer->IsLoopClosing()) {
-    uv::Timer::SingleShot(m_outgoingTimer->GetLoopRef(), uv::Timer::Time{0},
-                          [client = m_server.m_serverImpl.RemoveClient(
-                               m_clientId)]() mutable { client.reset(); });
-    m_server.RemoveConnection(this);
-  }
-  m_outgoingTimer->Close();
-}
-
 void NetworkServer::ServerConnection4::ProcessRequest() {
   DEBUG1("HTTP request: '{}'", m_request.GetUrl());
   auto url = wpi::net::ParseUrl(m_request.GetUrl());
@@ -153,8 +294,20 @@ void NetworkServer::ServerConnection4::ProcessRequest() {
                  "<body><p>WebSockets must be used to access NetworkTables."
                  "</body></html>");
   } else if (isGET && path == "/nt/persistent.json") {
-    SendResponse(200, "OK", "application/json",
-                 m_server.m_serverImpl.DumpPersistent());
+    if (!m_tasks) {
+      SendResponse(200, "OK", "application/json",
+                   m_server.m_serverImpl.DumpPersistent());
+      return;
+    }
+    // dump on the storage loop, then respond from this one
+    m_server.RunOnStorage(
+        [server = &m_server, tasks = m_tasks, self = weak_from_this()] {
+          tasks->Post([self, data = server->m_serverImpl.DumpPersistent()] {
+            if (auto conn = self.lock()) {
+              conn->SendResponse(200, "OK", "application/json", data);
+            }
+          });
+        });
   } else {
     SendError(404, "Resource not found");
   }
@@ -189,8 +342,14 @@ void NetworkServer::ServerConnection4::ProcessWsUpgrade() {
                                 std::string_view protocol) {
     m_info.protocol_version =
         protocol == "v4.1.networktables.first.wpi.edu" ? 0x0401 : 0x0400;
+    net::WebSocketConnection::Executor executor;
+    if (m_tasks) {
+      executor = [tasks = m_tasks](std::function<void()> func) {
+        tasks->Post(std::move(func));
+      };
+    }
     m_wire = std::make_shared<net::WebSocketConnection>(
-        *m_websocket, m_info.protocol_version, m_logger);
+        *m_websocket, m_info.protocol_version, m_logger, std::move(executor));
 
     if (protocol == "rtt.networktables.first.wpi.edu") {
       INFO("CONNECTED RTT client (from {})", m_connInfo);
@@ -221,32 +380,79 @@ void NetworkServer::ServerConnection4::ProcessWsUpgrade() {
       return;
     }
 
-    bool local = wpi::util::starts_with(m_info.remote_ip, "127.");
-    std::string dedupName;
-    std::tie(dedupName, m_clientId) = m_server.m_serverImpl.AddClient(
-        name, m_connInfo, local, *m_wire,
-        [this](uint32_t repeatMs) { UpdateOutgoingTimer(repeatMs); });
-    INFO("CONNECTED NT4 client '{}' (from {})", dedupName, m_connInfo);
-    m_info.remote_id = dedupName;
-    m_server.AddConnection(this, m_info);
+    m_client = std::make_shared<Client>(m_wire, m_info, name, m_connInfo);
+    m_server.RunOnStorage(
+        [server = &m_server, client = m_client] { server->AddClient(client); });
     m_websocket->closed.connect([this](uint16_t, std::string_view reason) {
       auto realReason = m_wire->GetDisconnectReason();
-      INFO("DISCONNECTED NT4 client '{}' (from {}): {}", m_info.remote_id,
-           m_connInfo, realReason.empty() ? reason : realReason);
-      ConnectionClosed();
+      m_server.RunOnStorage(
+          [server = &m_server, client = m_client,
+           reason = std::string{realReason.empty() ? reason : realReason}] {
+            server->RemoveClient(client, reason);
+          });
     });
+
+    if (!m_tasks) {
+      // on the storage loop; process directly
+      m_websocket->text.connect([this](std::string_view data, bool) {
+        if (m_server.m_serverImpl.ProcessIncomingText(m_client->id, data)) {
+          m_server.m_idle->Start();
+        }
+      });
+      m_websocket->binary.connect([this](std::span<const uint8_t> data, bool) {
+        if (m_server.m_serverImpl.ProcessIncomingBinary(m_client->id, data)) {
+          m_server.m_idle->Start();
+        }
+      });
+      return;
+    }
+
+    // decode here and hand the messages to the storage loop
     m_websocket->text.connect([this](std::string_view data, bool) {
-      if (m_server.m_serverImpl.ProcessIncomingText(m_clientId, data)) {
-        m_server.m_idle->Start();
-      }
+      ClientMessageCollector collector;
+      net::WireDecodeText(data, collector, m_logger);
+      ProcessDecoded(std::move(collector.msgs));
     });
     m_websocket->binary.connect([this](std::span<const uint8_t> data, bool) {
-      if (m_server.m_serverImpl.ProcessIncomingBinary(m_clientId, data)) {
-        m_server.m_idle->Start();
+      std::vector<net::ClientMessage> msgs;
+      while (!data.empty()) {
+        // decode message
+        int pubuid;
+        Value value;
+        std::string error;
+        if (!net::WireDecodeBinary(&data, &pubuid, &value, &error, 0)) {
+          m_wire->Disconnect(std::format("binary decode error: {}", error));
+          break;
+        }
+
+        // respond to RTT ping
+        if (pubuid == -1) {
+          auto now = wpi::util::Now();
+          DEBUG4("RTT ping from {}, responding with time={}", m_connInfo, now);
+          m_wire->SendBinary(
+              [&](auto& os) { net::WireEncodeBinary(os, -1, now, value); });
+          continue;
+        }
+
+        msgs.emplace_back(
+            net::ClientMessage{net::ClientValueMsg{pubuid, std::move(value)}});
       }
+      ProcessDecoded(std::move(msgs));
     });
+  });
+}
 
-    SetupOutgoingTimer();
+void NetworkServer::ServerConnection4::ProcessDecoded(
+    std::vector<net::ClientMessage> msgs) {
+  if (msgs.empty()) {
+    return;
+  }
+  m_server.RunOnStorage([server = &m_server, client = m_client,
+                         msgs = std::move(msgs)]() mutable {
+    if (client->id >= 0 &&
+        server->m_serverImpl.ProcessIncomingDecoded(client->id, msgs)) {
+      server->m_idle->Start();
+    }
   });
 }
 
@@ -256,19 +462,29 @@ NetworkServer::NetworkServer(std::string_view persistentFilename,
                              net::ILocalStorage& localStorage,
                              IConnectionList& connList,
                              wpi::util::Logger& logger,
-                             std::function<void(bool)> initDone)
+                             std::function<void(bool)> initDone,
+                             unsigned int ioThreads, bool persistentJournal)
     : m_localStorage{localStorage},
       m_connList{connList},
       m_logger{logger},
       m_initDone{std::move(initDone)},
       m_persistentFilename{persistentFilename},
+      m_journalFilename{std::format("{}.journal", persistentFilename)},
       m_listenAddress{wpi::util::trim(listenAddress)},
       m_mdnsService{wpi::util::trim(mdnsService)},
       m_port{port},
+      m_ioThreads{ioThreads},
+      m_persistentJournal{persistentJournal},
       m_serverImpl{logger},
       m_localQueue{logger},
+      m_storageTasks{std::make_shared<TaskQueue>()},
       m_loop(*m_loopRunner.GetLoop()) {
+  for (unsigned int i = 0; i < m_ioThreads; ++i) {
+    m_ioLoops.emplace_back(std::make_unique<IoLoop>());
+  }
   m_loopRunner.ExecAsync([=, this](uv::Loop& loop) {
+    m_storageTasks->Start(loop);
+
     // connect local storage to server
     m_serverImpl.SetLocal(&m_localStorage, &m_localQueue);
     m_localStorage.StartNetwork(&m_localQueue);
@@ -281,6 +497,8 @@ NetworkServer::NetworkServer(std::string_view persistentFilename,
 
 NetworkServer::~NetworkServer() {
   m_loopRunner.ExecAsync([this](uv::Loop&) { m_shutdown = true; });
+  // connections closed during shutdown must not call back into the server
+  m_storageTasks->Close();
   m_localStorage.ClearNetwork();
   m_connList.ClearConnections();
 }
@@ -334,14 +552,37 @@ void NetworkServer::LoadPersistent() {
       os << "[]\n";
       os.close();
     }
+    LoadJournal("[]\n");
     return;
   }
   m_persistentData =
       std::string{fileBuffer.value()->begin(), fileBuffer.value()->end()};
   DEBUG4("read data: {}", m_persistentData);
+  LoadJournal(m_persistentData);
 }
 
-void NetworkServer::SavePersistent(std::string_view filename,
+void NetworkServer::LoadJournal(std::string_view persistentData) {
+  m_persistentSize = persistentData.size();
+  auto header = JournalHeader(persistentData);
+  auto fileBuffer = wpi::util::MemoryBuffer::GetFile(m_journalFilename);
+  if (fileBuffer) {
+    auto buf = fileBuffer.value()->GetCharBuffer();
+    std::string_view data{buf.data(), buf.size()};
+    if (data.starts_with(header)) {
+      m_journalData = data.substr(header.size());
+      m_journalSize = m_journalData.size();
+      DEBUG4("read journal: {}", m_journalData);
+      return;
+    }
+    INFO("ignoring persistent journal '{}' that does not match '{}'",
+         m_journalFilename, m_persistentFilename);
+  }
+  if (m_persistentJournal && !WriteJournal(header, false)) {
+    m_journalCompact = true;  // try again by rewriting both files
+  }
+}
+
+bool NetworkServer::SavePersistent(std::string_view filename,
                                    std::string_view data) {
   // write to temporary file
   auto tmp = std::format("{}.tmp", filename);
@@ -350,13 +591,13 @@ void NetworkServer::SavePersistent(std::string_view filename,
   if (ec.value() != 0) {
     INFO("could not open persistent file '{}' for write: {}", tmp,
          ec.message());
-    return;
+    return false;
   }
   os << data;
   os.close();
   if (os.has_error()) {
     fs::remove(tmp);
-    return;
+    return false;
   }
 
   // move to real file
@@ -367,6 +608,71 @@ void NetworkServer::SavePersistent(std::string_view filename,
   if (ec.value() != 0) {
     // attempt to restore backup
     fs::rename(bak, filename, ec);
+    return false;
+  }
+  return true;
+}
+
+bool NetworkServer::WriteJournal(std::string_view data, bool append) {
+  std::error_code ec;
+  wpi::util::raw_fd_ostream os{
+      m_journalFilename, ec, append ? fs::CD_OpenAlways : fs::CD_CreateAlways,
+      fs::FA_Write, append ? fs::OF_Append : fs::OF_None};
+  if (ec.value() != 0) {
+    INFO("could not open persistent journal '{}' for write: {}",
+         m_journalFilename, ec.message());
+    return false;
+  }
+  os << data;
+  os.close();
+  return !os.has_error();
+}
+
+void NetworkServer::SaveJournal() {
+  if (m_journalSaving) {
+    return;  // changes are picked up after the current write completes
+  }
+  auto ok = std::make_shared<bool>(false);
+  if (m_journalCompact ||
+      m_journalSize > (std::max)(m_persistentSize, kJournalCompactMinSize)) {
+    // rewrite the persistent file, which includes every change, then start a
+    // new journal for it
+    m_serverImpl.PersistentChanged();
+    auto data = m_serverImpl.DumpPersistent();
+    size_t size = data.size();
+    m_journalSaving = true;
+    uv::QueueWork(
+        m_loop,
+        [this, ok, data = std::move(data)] {
+          *ok = SavePersistent(m_persistentFilename, data) &&
+                WriteJournal(JournalHeader(data), false);
+        },
+        [this, ok, size] {
+          m_journalSaving = false;
+          m_journalCompact = !*ok;
+          if (*ok) {
+            m_persistentSize = size;
+            m_journalSize = 0;
+          }
+        });
+  } else {
+    auto changes = m_serverImpl.DumpPersistentChanges();
+    if (changes.empty()) {
+      return;
+    }
+    m_journalSize += changes.size();
+    m_journalSaving = true;
+    uv::QueueWork(
+        m_loop,
+        [this, ok, changes = std::move(changes)] {
+          *ok = WriteJournal(changes, true);
+        },
+        [this, ok] {
+          m_journalSaving = false;
+          if (!*ok) {
+            m_journalCompact = true;  // the changes were lost
+          }
+        });
   }
 }
 
@@ -374,27 +680,32 @@ void NetworkServer::Init() {
   if (m_shutdown) {
     return;
   }
-  auto errs = m_serverImpl.LoadPersistent(m_persistentData);
+  auto errs = m_serverImpl.LoadPersistent(m_persistentData, m_journalData);
   if (!errs.empty()) {
     WARN("error reading persistent file: {}", errs);
   }
-
-  // set up timers
-  m_readLocalTimer = uv::Timer::Create(m_loop);
-  if (m_readLocalTimer) {
-    m_readLocalTimer->timeout.connect([this] {
-      if (m_serverImpl.ProcessLocalMessages(kClientProcessMessageCountMax)) {
-        DEBUG4("Starting idle processing");
-        m_idle->Start();  // more to process
-      }
-    });
-    m_readLocalTimer->Start(uv::Timer::Time{100}, uv::Timer::Time{100});
+  if (!m_persistentJournal && !m_journalData.empty()) {
+    // fold a journal left by a previous run into the persistent file
+    uv::QueueWork(
+        m_loop,
+        [this, data = m_serverImpl.DumpPersistent()] {
+          if (SavePersistent(m_persistentFilename, data)) {
+            std::error_code ec;
+            fs::remove(m_journalFilename, ec);
+          }
+        },
+        nullptr);
   }
+  m_journalData.clear();
+  m_journalData.shrink_to_fit();
 
+  // set up timers
   m_savePersistentTimer = uv::Timer::Create(m_loop);
   if (m_savePersistentTimer) {
     m_savePersistentTimer->timeout.connect([this] {
-      if (m_serverImpl.PersistentChanged()) {
+      if (m_persistentJournal) {
+        SaveJournal();
+      } else if (m_serverImpl.PersistentChanged()) {
         uv::QueueWork(
             m_loop,
             [this, fn = m_persistentFilename,
@@ -428,6 +739,15 @@ void NetworkServer::Init() {
   }
   m_flushLocalAtomic = m_flushLocal.get();
 
+  // process local changes as they are made instead of polling for them
+  m_localWakeup.emplace(m_loop, [this] {
+    if (m_serverImpl.ProcessLocalMessages(kClientProcessMessageCountMax)) {
+      DEBUG4("Starting idle processing");
+      m_idle->Start();  // more to process
+    }
+  });
+  m_localQueue.SetWakeup([wakeup = &*m_localWakeup] { wakeup->Send(); });
+
   m_idle = uv::Idle::Create(m_loop);
   if (m_idle) {
     m_idle->idle.connect([this] {
@@ -444,36 +764,27 @@ void NetworkServer::Init() {
   INFO("Listening on port {}", m_port);
 
   if (m_port != 0) {
-    auto tcp4 = uv::Tcp::Create(m_loop);
-    tcp4->error.connect([logger = &m_logger](uv::Error err) {
-      WPI_INFO(*logger, "NT4 server socket error: {}", err.str());
-    });
-    tcp4->Bind(m_listenAddress, m_port);
-
-    // when we get a NT4 connection, accept it and start reading
-    tcp4->connection.connect([this, srv = tcp4.get()] {
-      auto tcp = srv->Accept();
-      if (!tcp) {
-        return;
-      }
-      tcp->SetLogger(&m_logger);
-      tcp->error.connect([logger = &m_logger](uv::Error err) {
-        WPI_INFO(*logger, "NT4 socket error: {}", err.str());
-      });
-      tcp->SetNoDelay(true);
-      std::string peerAddr;
-      unsigned int peerPort = 0;
-      if (uv::AddrToName(tcp->GetPeer(), &peerAddr, &peerPort) == 0) {
-        INFO("Got a NT4 connection from {} port {}", peerAddr, peerPort);
-      } else {
-        INFO("Got a NT4 connection from unknown");
+    if (m_ioLoops.empty()) {
+      Listen(m_loop, nullptr, false);
+    } else {
+      // each I/O loop gets its own listening socket, and the kernel balances
+      // incoming connections between them
+      for (auto&& ioLoop : m_ioLoops) {
+        bool ok = false;
+        ioLoop->runner.ExecSync([&](uv::Loop& loop) {
+          ok = Listen(loop, ioLoop->tasks, true);
+        });
+        if (!ok) {
+          WARN(
+              "SO_REUSEPORT is not supported; all connections will be handled "
+              "by one I/O thread");
+          auto& first = m_ioLoops.front();
+          first->runner.ExecSync(
+              [&](uv::Loop& loop) { Listen(loop, first->tasks, false); });
+          break;
+        }
       }
-      auto conn = std::make_shared<ServerConnection4>(tcp, *this, peerAddr,
-                                                      peerPort, m_logger);
-      tcp->SetData(conn);
-    });
-
-    tcp4->Listen();
+    }
   }
 
   bool announcingmDNS = false;
@@ -497,17 +808,118 @@ void NetworkServer::Init() {
   }
 }
 
-void NetworkServer::AddConnection(ServerConnection* conn,
-                                  const ConnectionInfo& info) {
+bool NetworkServer::Listen(uv::Loop& loop, std::shared_ptr<TaskQueue> tasks,
+                           bool reusePort) {
+  auto tcp4 = uv::Tcp::Create(loop);
+  tcp4->error.connect([logger = &m_logger](uv::Error err) {
+    WPI_INFO(*logger, "NT4 server socket error: {}", err.str());
+  });
+  if (reusePort) {
+    sockaddr_in addr;
+    int err = uv::NameToAddr(m_listenAddress, m_port, &addr);
+    if (err == 0) {
+      err = uv_tcp_bind(tcp4->GetRaw(), reinterpret_cast<sockaddr*>(&addr),
+                        UV_TCP_REUSEPORT);
+    }
+    if (err == UV_ENOTSUP) {
+      tcp4->Close();
+      return false;
+    } else if (err < 0) {
+      tcp4->ReportError(err);
+    }
+  } else {
+    tcp4->Bind(m_listenAddress, m_port);
+  }
+
+  // when we get a NT4 connection, accept it and start reading
+  tcp4->connection.connect([this, srv = tcp4.get(), tasks = std::move(tasks)] {
+    auto tcp = srv->Accept();
+    if (!tcp) {
+      return;
+    }
+    tcp->SetLogger(&m_logger);
+    tcp->error.connect([logger = &m_logger](uv::Error err) {
+      WPI_INFO(*logger, "NT4 socket error: {}", err.str());
+    });
+    tcp->SetNoDelay(true);
+    std::string peerAddr;
+    unsigned int peerPort = 0;
+    if (uv::AddrToName(tcp->GetPeer(), &peerAddr, &peerPort) == 0) {
+      INFO("Got a NT4 connection from {} port {}", peerAddr, peerPort);
+    } else {
+      INFO("Got a NT4 connection from unknown");
+    }
+    auto conn = std::make_shared<ServerConnection4>(tcp, *this, peerAddr,
+                                                    peerPort, tasks, m_logger);
+    tcp->SetData(conn);
+  });
+
+  tcp4->Listen();
+  return true;
+}
+
+void NetworkServer::RunOnStorage(std::function<void()> func) {
+  m_storageTasks->Post(std::move(func));
+}
+
+void NetworkServer::AddClient(const std::shared_ptr<Client>& client) {
+  client->outgoingTimer = uv::Timer::Create(m_loop);
+  client->outgoingTimer->timeout.connect([this, client = client.get()] {
+    m_serverImpl.SendOutgoing(client->id, m_loop.Now().count());
+  });
+
+  bool local = wpi::util::starts_with(client->info.remote_ip, "127.");
+  std::tie(client->info.remote_id, client->id) = m_serverImpl.AddClient(
+      client->name, client->connInfo, local, *client->wire,
+      [this, client = client.get()](uint32_t repeatMs) {
+        auto& timer = *client->outgoingTimer;
+        DEBUG4("Setting periodic timer to {}", repeatMs);
+        if (repeatMs == UINT32_MAX) {
+          timer.Stop();
+        } else if (!timer.IsActive() ||
+                   uv::Timer::Time{repeatMs} != timer.GetRepeat()) {
+          timer.Start(uv::Timer::Time{repeatMs}, uv::Timer::Time{repeatMs});
+        }
+      });
+  INFO("CONNECTED NT4 client '{}' (from {})", client->info.remote_id,
+       client->connInfo);
+  AddConnection(client);
+}
+
+void NetworkServer::RemoveClient(const std::shared_ptr<Client>& client,
+                                 std::string_view reason) {
+  INFO("DISCONNECTED NT4 client '{}' (from {}): {}", client->info.remote_id,
+       client->connInfo, reason);
+  if (client->id < 0) {
+    return;
+  }
+  // don't call back into the server if it's being destroyed
+  if (!client->outgoingTimer->IsLoopClosing()) {
+    uv::Timer::SingleShot(
+        m_loop, uv::Timer::Time{0},
+        [serverClient = m_serverImpl.RemoveClient(client->id),
+         client = client]() mutable {
+          // the server client refers to the wire, so release it first
+          serverClient.reset();
+          client.reset();
+        });
+    RemoveConnection(client.get());
+  }
+  client->id = -1;
+  client->outgoingTimer->Close();
+}
+
+void NetworkServer::AddConnection(const std::shared_ptr<Client>& client) {
   std::scoped_lock lock{m_mutex};
-  m_connections.emplace_back(Connection{conn, m_connList.AddConnection(info)});
+  m_connections.emplace_back(
+      Connection{client, m_connList.AddConnection(client->info)});
   m_serverImpl.ConnectionsChanged(m_connList.GetConnections());
 }
 
-void NetworkServer::RemoveConnection(ServerConnection* conn) {
+void NetworkServer::RemoveConnection(Client* client) {
   std::scoped_lock lock{m_mutex};
   auto it = std::find_if(m_connections.begin(), m_connections.end(),
-                         [=](auto&& c) { return c.conn == conn; });
+                         [=](auto&& c) { return c.client.get() == client; });
   if (it != m_connections.end()) {
     m_connList.RemoveConnection(it->connHandle);
     m_connections.erase(it);
@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "net/ClientMessageQueue.hpp"
+#include "net/LocalQueueWakeup.hpp"
 #include "net/Message.hpp"
 #include "server/ServerImpl.hpp"
 #include "wpi/net/EventLoopRunner.hpp"
@@ -34,28 +35,53 @@ namespace wpi::nt {
 
 class IConnectionList;
 
+// All server state is owned by a single "storage" loop thread. If ioThreads is
+// nonzero, client connections are instead accepted on that many additional
+// loop threads, which handle the connection's socket I/O, WebSocket framing,
+// compression, and message decoding, and exchange messages with the storage
+// loop through task queues.
+//
+// If persistentJournal is true, changed persistent values are appended to a
+// journal file (the persistent filename with a .journal suffix) instead of
+// rewriting the whole persistent file. The journal starts with a hash of the
+// persistent file it applies to, so a journal left over from before the last
+// rewrite is ignored. The persistent file is rewritten and the journal
+// restarted once the journal grows larger than the persistent file.
 class NetworkServer {
  public:
   NetworkServer(std::string_view persistentFilename,
                 std::string_view listenAddress, std::string_view mdnsService,
                 unsigned int port, net::ILocalStorage& localStorage,
                 IConnectionList& connList, wpi::util::Logger& logger,
-                std::function<void(bool)> initDone);
+                std::function<void(bool)> initDone,
+                unsigned int ioThreads = 0, bool persistentJournal = false);
   ~NetworkServer();
 
   void FlushLocal();
   void Flush();
 
  private:
+  class TaskQueue;
   class ServerConnection;
   class ServerConnection4;
+  struct Client;
+  struct IoLoop;
 
   void ProcessAllLocal();
   void LoadPersistent();
-  void SavePersistent(std::string_view filename, std::string_view data);
+  void LoadJournal(std::string_view persistentData);
+  bool SavePersistent(std::string_view filename, std::string_view data);
+  bool WriteJournal(std::string_view data, bool append);
+  void SaveJournal();
   void Init();
-  void AddConnection(ServerConnection* conn, const ConnectionInfo& info);
-  void RemoveConnection(ServerConnection* conn);
+  bool Listen(wpi::net::uv::Loop& loop, std::shared_ptr<TaskQueue> tasks,
+              bool reusePort);
+  void RunOnStorage(std::function<void()> func);
+  void AddClient(const std::shared_ptr<Client>& client);
+  void RemoveClient(const std::shared_ptr<Client>& client,
+                    std::string_view reason);
+  void AddConnection(const std::shared_ptr<Client>& client);
+  void RemoveConnection(Client* client);
 
   net::ILocalStorage& m_localStorage;
   IConnectionList& m_connList;
@@ -63,18 +89,27 @@ class NetworkServer {
   std::function<void(bool)> m_initDone;
   std::string m_persistentData;
   std::string m_persistentFilename;
+  std::string m_journalFilename;
+  std::string m_journalData;
   std::string m_listenAddress;
   std::string m_mdnsService;
   unsigned int m_port;
+  unsigned int m_ioThreads;
+  bool m_persistentJournal;
 
   // used only from loop
   std::optional<wpi::net::MulticastServiceAnnouncer> m_mdnsAnnouncer;
-  std::shared_ptr<wpi::net::uv::Timer> m_readLocalTimer;
   std::shared_ptr<wpi::net::uv::Timer> m_savePersistentTimer;
   std::shared_ptr<wpi::net::uv::Async<>> m_flushLocal;
   std::shared_ptr<wpi::net::uv::Async<>> m_flush;
   std::shared_ptr<wpi::net::uv::Idle> m_idle;
+  std::optional<net::LocalQueueWakeup> m_localWakeup;
   bool m_shutdown = false;
+  // journal state
+  size_t m_persistentSize = 0;
+  size_t m_journalSize = 0;
+  bool m_journalSaving = false;
+  bool m_journalCompact = false;
 
   using Queue = net::LocalClientMessageQueue;
   net::ClientMessage m_localMsgs[Queue::kBlockSize];
@@ -86,13 +121,17 @@ class NetworkServer {
   std::atomic<wpi::net::uv::Async<>*> m_flushAtomic{nullptr};
   mutable wpi::util::mutex m_mutex;
   struct Connection {
-    ServerConnection* conn;
+    std::shared_ptr<Client> client;
     int connHandle;
   };
   std::vector<Connection> m_connections;
 
   Queue m_localQueue;
 
+  // work posted to the storage loop by connection I/O threads
+  std::shared_ptr<TaskQueue> m_storageTasks;
+  // the storage loop is stopped first, then the connection I/O loops
+  std::vector<std::unique_ptr<IoLoop>> m_ioLoops;
   wpi::net::EventLoopRunner m_loopRunner;
   wpi::net::uv::Loop& m_loop;
 };
@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <functional>
 #include <span>
 #include <string>
+#include <utility>
 
 #include "Message.hpp"
 #include "MessageHandler.hpp"
@@ -40,6 +42,19 @@ class ClientMessageQueueImpl final : public ClientMessageHandler,
 
   bool empty() const { return m_queue.empty(); }
 
+  // Sets a function to call when a message is added to the queue. It is called
+  // (with the queue locked) only for the first message added after the queue
+  // has been emptied by ReadQueue() or ClearQueue(), so a burst of messages
+  // results in a single call.
+  void SetWakeup(std::function<void()> wakeup) {
+    std::scoped_lock lock{m_mutex};
+    m_wakeup = std::move(wakeup);
+    m_wakeupPending = false;
+    if (!m_queue.empty()) {
+      Wakeup();
+    }
+  }
+
   // ClientMessageQueue - calls to these read the queue
   std::span<ClientMessage> ReadQueue(std::span<ClientMessage> out) final {
     std::scoped_lock lock{m_mutex};
@@ -56,6 +71,9 @@ class ClientMessageQueueImpl final : public ClientMessageHandler,
       }
       ++count;
     }
+    if (count < out.size()) {
+      m_wakeupPending = false;  // emptied the queue
+    }
     return out.subspan(0, count);
   }
 
@@ -68,6 +86,7 @@ class ClientMessageQueueImpl final : public ClientMessageHandler,
       m_valueSize.size = 0;
       m_valueSize.errored = false;
     }
+    m_wakeupPending = false;
   }
 
   // ClientMessageHandler - calls to these append to the queue
@@ -78,17 +97,20 @@ class ClientMessageQueueImpl final : public ClientMessageHandler,
     std::scoped_lock lock{m_mutex};
     m_queue.enqueue(ClientMessage{PublishMsg{
         pubuid, std::string{name}, std::string{typeStr}, properties, options}});
+    Wakeup();
   }
 
   void ClientUnpublish(int pubuid) final {
     std::scoped_lock lock{m_mutex};
     m_queue.enqueue(ClientMessage{UnpublishMsg{pubuid}});
+    Wakeup();
   }
 
   void ClientSetProperties(std::string_view name,
                            const wpi::util::json& update) final {
     std::scoped_lock lock{m_mutex};
     m_queue.enqueue(ClientMessage{SetPropertiesMsg{std::string{name}, update}});
+    Wakeup();
   }
 
   void ClientSubscribe(int subuid, std::span<const std::string> topicNames,
@@ -96,11 +118,13 @@ class ClientMessageQueueImpl final : public ClientMessageHandler,
     std::scoped_lock lock{m_mutex};
     m_queue.enqueue(ClientMessage{
         SubscribeMsg{subuid, {topicNames.begin(), topicNames.end()}, options}});
+    Wakeup();
   }
 
   void ClientUnsubscribe(int subuid) final {
     std::scoped_lock lock{m_mutex};
     m_queue.enqueue(ClientMessage{UnsubscribeMsg{subuid}});
+    Wakeup();
   }
 
   void ClientSetValue(int pubuid, const Value& value) final {
@@ -117,9 +141,37 @@ class ClientMessageQueueImpl final : public ClientMessageHandler,
       m_valueSize.size += addedSize;
     }
     m_queue.enqueue(ClientMessage{ClientValueMsg{pubuid, value}});
+    Wakeup();
+  }
+
+  // Appends a message that has already been decoded
+  void Enqueue(ClientMessage&& msg) {
+    std::scoped_lock lock{m_mutex};
+    if constexpr (MaxValueSize != 0) {
+      if (auto* val = std::get_if<ClientValueMsg>(&msg.contents)) {
+        size_t addedSize = sizeof(ClientMessage) + val->value.size();
+        if (m_valueSize.size + addedSize > MaxValueSize) {
+          if (!m_valueSize.errored) {
+            WPI_ERROR(m_logger, "NT: dropping value set due to memory limits");
+            m_valueSize.errored = true;
+          }
+          return;  // avoid potential out of memory
+        }
+        m_valueSize.size += addedSize;
+      }
+    }
+    m_queue.enqueue(std::move(msg));
+    Wakeup();
   }
 
  private:
+  void Wakeup() {
+    if (m_wakeup && !m_wakeupPending) {
+      m_wakeupPending = true;
+      m_wakeup();
+    }
+  }
+
   wpi::util::FastQueue<ClientMessage, kBlockSize> m_queue{kBlockSize - 1};
   wpi::util::Logger& m_logger;
 
@@ -138,6 +190,9 @@ class ClientMessageQueueImpl final : public ClientMessageHandler,
   struct Empty {};
   [[no_unique_address]]
   std::conditional_t<MaxValueSize != 0, ValueSize, Empty> m_valueSize;
+
+  std::function<void()> m_wakeup;
+  bool m_wakeupPending = false;
 };
 
 }  // namespace detail
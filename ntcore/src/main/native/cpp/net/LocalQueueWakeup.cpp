@@ -0,0 +1,40 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "LocalQueueWakeup.hpp"
+
+#include <utility>
+
+using namespace wpi::nt::net;
+namespace uv = wpi::net::uv;
+
+LocalQueueWakeup::LocalQueueWakeup(uv::Loop& loop, std::function<void()> func)
+    : m_func{std::move(func)} {
+  m_timer = uv::Timer::Create(loop);
+  if (m_timer) {
+    m_timer->timeout.connect([this] {
+      if (m_deferred) {
+        m_deferred = false;
+        Run();
+      }
+    });
+  }
+  m_async = uv::Async<>::Create(loop);
+  if (m_async) {
+    m_async->wakeup.connect([this] {
+      if (m_timer && m_timer->IsActive()) {
+        m_deferred = true;  // run when the timer expires
+      } else {
+        Run();
+      }
+    });
+  }
+}
+
+void LocalQueueWakeup::Run() {
+  m_func();
+  if (m_timer) {
+    m_timer->Start(kMinPeriod);
+  }
+}
@@ -0,0 +1,41 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include "wpi/net/uv/Async.hpp"
+#include "wpi/net/uv/Timer.hpp"
+
+namespace wpi::nt::net {
+
+// Runs a function on the loop when local changes are queued. Wakeups are
+// rate limited to one per kMinPeriod; wakeups that arrive while limited are
+// coalesced into a single run at the end of the period.
+class LocalQueueWakeup {
+ public:
+  static constexpr wpi::net::uv::Timer::Time kMinPeriod{5};
+
+  // must be called from the loop
+  LocalQueueWakeup(wpi::net::uv::Loop& loop, std::function<void()> func);
+
+  // may be called from any thread
+  void Send() {
+    if (m_async) {
+      m_async->UnsafeSend();
+    }
+  }
+
+ private:
+  void Run();
+
+  std::function<void()> m_func;
+  std::shared_ptr<wpi::net::uv::Async<>> m_async;
+  std::shared_ptr<wpi::net::uv::Timer> m_timer;
+  bool m_deferred = false;
+};
+
+}  // namespace wpi::nt::net
@@ -6,7 +6,11 @@
 
 #include <algorithm>
 #include <bit>
+#include <memory>
+#include <mutex>
 #include <span>
+#include <utility>
+#include <vector>
 
 #include "wpi/net/WebSocket.hpp"
 #include "wpi/net/raw_uv_ostream.hpp"
@@ -109,10 +113,35 @@ void WebSocketConnection::Stream::write_impl(const char* data, size_t len) {
   }
 }
 
+// Frames handed to the WebSocket's loop by an executor. The buffers are
+// deallocated if the executor never runs the send (e.g. the loop stopped).
+struct WebSocketConnection::PendingSend {
+  PendingSend(std::vector<Frame> frames, std::vector<wpi::net::uv::Buffer> bufs)
+      : frames{std::move(frames)}, bufs{std::move(bufs)} {}
+  PendingSend(const PendingSend&) = delete;
+  PendingSend& operator=(const PendingSend&) = delete;
+  ~PendingSend() {
+    for (auto&& buf : bufs) {
+      buf.Deallocate();
+    }
+  }
+
+  std::vector<Frame> frames;
+  std::vector<wpi::net::uv::Buffer> bufs;
+};
+
 WebSocketConnection::WebSocketConnection(wpi::net::WebSocket& ws,
                                          unsigned int version,
-                                         wpi::util::Logger& logger)
-    : m_ws{ws}, m_logger{logger}, m_version{version} {}
+                                         wpi::util::Logger& logger,
+                                         Executor executor)
+    : m_ws{ws},
+      m_logger{logger},
+      m_version{version},
+      m_executor{std::move(executor)} {
+  if (m_executor) {
+    m_wsWeak = ws.weak_from_this();
+  }
+}
 
 WebSocketConnection::~WebSocketConnection() {
   for (auto&& buf : m_bufs) {
@@ -123,19 +152,55 @@ WebSocketConnection::~WebSocketConnection() {
   }
 }
 
+template <typename F>
+void WebSocketConnection::RunOnLoop(F&& func) {
+  if (!m_executor) {
+    func(*this, m_ws);
+    return;
+  }
+  m_executor([selfweak = weak_from_this(), wsweak = m_wsWeak,
+              func = std::forward<F>(func)]() mutable {
+    auto self = selfweak.lock();
+    auto ws = wsweak.lock();
+    if (self && ws) {
+      func(*self, *ws);
+    }
+  });
+}
+
 void WebSocketConnection::SendPing(uint64_t time) {
   WPI_DEBUG4(m_logger, "conn: sending ping {}", time);
-  auto buf = AllocBuf();
-  buf.len = 8;
-  wpi::util::support::endian::write64<std::endian::native>(buf.base, time);
-  m_ws.SendPing({buf}, [selfweak = weak_from_this()](auto bufs, auto err) {
-    if (auto self = selfweak.lock()) {
-      self->m_err = err;
-      self->ReleaseBufs(bufs);
-    } else {
-      for (auto&& buf : bufs) {
-        buf.Deallocate();
+  RunOnLoop([time](WebSocketConnection& self, wpi::net::WebSocket& ws) {
+    auto buf = self.AllocBuf();
+    buf.len = 8;
+    wpi::util::support::endian::write64<std::endian::native>(buf.base, time);
+    ws.SendPing({buf}, [selfweak = self.weak_from_this()](auto bufs, auto err) {
+      if (auto self = selfweak.lock()) {
+        self->SetWriteError(err);
+        self->ReleaseBufs(bufs);
+      } else {
+        for (auto&& buf : bufs) {
+          buf.Deallocate();
+        }
       }
+    });
+  });
+}
+
+void WebSocketConnection::StopRead() {
+  RunOnLoop([](WebSocketConnection& self, wpi::net::WebSocket& ws) {
+    if (self.m_readActive) {
+      ws.GetStream().StopRead();
+      self.m_readActive = false;
+    }
+  });
+}
+
+void WebSocketConnection::StartRead() {
+  RunOnLoop([](WebSocketConnection& self, wpi::net::WebSocket& ws) {
+    if (!self.m_readActive) {
+      ws.GetStream().StartRead();
+      self.m_readActive = true;
     }
   });
 }
@@ -207,6 +272,19 @@ int WebSocketConnection::Flush() {
   }
   m_frames.back().opcode |= wpi::net::WebSocket::FLAG_FIN;
 
+  if (m_executor) {
+    // writes complete on the loop, so an error is returned by the next flush
+    if (int err = m_executorErr.load(std::memory_order_relaxed)) {
+      ReleaseBufs(m_bufs);
+      m_frames.clear();
+      m_bufs.clear();
+      return err;
+    }
+    // the WebSocket queues everything, so nothing is ever left unsent
+    SendRemote(std::exchange(m_frames, {}), std::exchange(m_bufs, {}));
+    return 0;
+  }
+
   // convert internal frames into WS frames
   m_ws_frames.clear();
   m_ws_frames.reserve(m_frames.size());
@@ -258,8 +336,15 @@ void WebSocketConnection::Send(
   if (opcode == wpi::net::WebSocket::Frame::TEXT) {
     os << ']';
   }
-  wpi::net::WebSocket::Frame frame{opcode, os.bufs()};
   WPI_DEBUG4(m_logger, "Send({})", static_cast<uint8_t>(opcode));
+  auto data = os.bufs();
+  if (m_executor) {
+    std::vector<Frame> frames;
+    frames.emplace_back(opcode, 0, data.size());
+    SendRemote(std::move(frames), {data.begin(), data.end()});
+    return;
+  }
+  wpi::net::WebSocket::Frame frame{opcode, data};
   m_ws.SendFrames({{frame}}, [selfweak = weak_from_this()](auto bufs, auto) {
     if (auto self = selfweak.lock()) {
       self->ReleaseBufs(bufs);
@@ -271,12 +356,54 @@ void WebSocketConnection::Send(
   });
 }
 
+void WebSocketConnection::SendRemote(std::vector<Frame> frames,
+                                     std::vector<wpi::net::uv::Buffer> bufs) {
+  ++m_sendsInFlight;
+  RunOnLoop([pending = std::make_shared<PendingSend>(std::move(frames),
+                                                     std::move(bufs))](
+                WebSocketConnection& self, wpi::net::WebSocket& ws) {
+    std::vector<wpi::net::WebSocket::Frame> wsFrames;
+    wsFrames.reserve(pending->frames.size());
+    for (auto&& frame : pending->frames) {
+      wsFrames.emplace_back(frame.opcode,
+                            std::span{pending->bufs}.subspan(
+                                frame.start, frame.end - frame.start));
+    }
+    ws.SendFrames(wsFrames, [selfweak = self.weak_from_this()](auto bufs,
+                                                                auto err) {
+      if (auto self = selfweak.lock()) {
+        self->SetWriteError(err);
+        self->ReleaseBufs(bufs);
+        self->m_sendsInFlight.fetch_sub(1, std::memory_order_release);
+      } else {
+        for (auto&& buf : bufs) {
+          buf.Deallocate();
+        }
+      }
+    });
+    // the WebSocket now owns the buffers
+    pending->bufs.clear();
+  });
+}
+
 void WebSocketConnection::Disconnect(std::string_view reason) {
-  m_reason = reason;
-  m_ws.Fail(1001, reason);
+  RunOnLoop([reason = std::string{reason}](WebSocketConnection& self,
+                                           wpi::net::WebSocket& ws) {
+    self.m_reason = reason;
+    ws.Fail(1001, reason);
+  });
+}
+
+void WebSocketConnection::SetWriteError(wpi::net::uv::Error err) {
+  if (!m_executor) {
+    m_err = err;
+  } else if (err) {
+    m_executorErr.store(err.code(), std::memory_order_relaxed);
+  }
 }
 
 wpi::net::uv::Buffer WebSocketConnection::AllocBuf() {
+  std::scoped_lock lock{m_poolMutex};
   if (!m_buf_pool.empty()) {
     auto buf = m_buf_pool.back();
     m_buf_pool.pop_back();
@@ -289,6 +416,7 @@ void WebSocketConnection::ReleaseBufs(std::span<wpi::net::uv::Buffer> bufs) {
 #ifdef __SANITIZE_ADDRESS__
   size_t numToPool = 0;
 #else
+  std::scoped_lock lock{m_poolMutex};
   size_t numToPool = (std::min)(bufs.size(), kMaxPoolSize - m_buf_pool.size());
   m_buf_pool.insert(m_buf_pool.end(), bufs.begin(), bufs.begin() + numToPool);
 #endif
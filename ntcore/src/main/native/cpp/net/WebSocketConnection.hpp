@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -14,6 +16,7 @@
 #include "wpi/net/uv/Buffer.hpp"
 #include "wpi/net/uv/Stream.hpp"
 #include "wpi/util/function_ref.hpp"
+#include "wpi/util/mutex.hpp"
 
 namespace wpi::util {
 class Logger;
@@ -25,8 +28,15 @@ class WebSocketConnection final
     : public WireConnection,
       public std::enable_shared_from_this<WebSocketConnection> {
  public:
+  // Runs a function on the WebSocket's loop thread
+  using Executor = std::function<void(std::function<void()>)>;
+
+  // If an executor is provided, the connection may be written from a thread
+  // other than the WebSocket's loop thread (but from only one thread at a
+  // time), and SendText()/SendBinary() may also be called from the loop
+  // thread; all operations on the WebSocket itself are run via the executor.
   WebSocketConnection(wpi::net::WebSocket& ws, unsigned int version,
-                      wpi::util::Logger& logger);
+                      wpi::util::Logger& logger, Executor executor = nullptr);
   ~WebSocketConnection() override;
   WebSocketConnection(const WebSocketConnection&) = delete;
   WebSocketConnection& operator=(const WebSocketConnection&) = delete;
@@ -35,7 +45,12 @@ class WebSocketConnection final
 
   void SendPing(uint64_t time) final;
 
-  bool Ready() const final { return !m_ws.IsWriteInProgress(); }
+  bool Ready() const final {
+    if (m_executor) {
+      return m_sendsInFlight.load(std::memory_order_acquire) == 0;
+    }
+    return !m_ws.IsWriteInProgress();
+  }
 
   int WriteText(
       wpi::util::function_ref<void(wpi::util::raw_ostream& os)> writer) final {
@@ -62,21 +77,12 @@ class WebSocketConnection final
     return m_ws.GetLastReceivedTime();
   }
 
-  void StopRead() final {
-    if (m_readActive) {
-      m_ws.GetStream().StopRead();
-      m_readActive = false;
-    }
-  }
-  void StartRead() final {
-    if (!m_readActive) {
-      m_ws.GetStream().StartRead();
-      m_readActive = true;
-    }
-  }
+  void StopRead() final;
+  void StartRead() final;
 
   void Disconnect(std::string_view reason) final;
 
+  // If an executor is used, this must be called from the WebSocket's loop
   std::string_view GetDisconnectReason() const { return m_reason; }
 
  private:
@@ -87,8 +93,14 @@ class WebSocketConnection final
   void Send(uint8_t opcode,
             wpi::util::function_ref<void(wpi::util::raw_ostream& os)> writer);
 
+  // Calls func(*this, ws) on the WebSocket's loop
+  template <typename F>
+  void RunOnLoop(F&& func);
+
   void StartFrame(uint8_t opcode);
   void FinishText();
+  // Called on the WebSocket's loop with the result of a write
+  void SetWriteError(wpi::net::uv::Error err);
   wpi::net::uv::Buffer AllocBuf();
   void ReleaseBufs(std::span<wpi::net::uv::Buffer> bufs);
 
@@ -107,9 +119,15 @@ class WebSocketConnection final
     unsigned int count = 0;
     uint8_t opcode;
   };
+  struct PendingSend;
+
+  void SendRemote(std::vector<Frame> frames,
+                  std::vector<wpi::net::uv::Buffer> bufs);
+
   std::vector<wpi::net::WebSocket::Frame> m_ws_frames;  // to reduce allocs
   std::vector<Frame> m_frames;
   std::vector<wpi::net::uv::Buffer> m_bufs;
+  wpi::util::mutex m_poolMutex;  // only contended when using an executor
   std::vector<wpi::net::uv::Buffer> m_buf_pool;
   size_t m_framePos = 0;
   size_t m_written = 0;
@@ -118,6 +136,13 @@ class WebSocketConnection final
   std::string m_reason;
   uint64_t m_lastFlushTime = 0;
   unsigned int m_version;
+
+  Executor m_executor;
+  std::weak_ptr<wpi::net::WebSocket> m_wsWeak;
+  std::atomic_int m_sendsInFlight{0};
+  // write error from the loop when using an executor (m_err is only used
+  // without one)
+  std::atomic_int m_executorErr{0};
 };
 
 }  // namespace wpi::nt::net
@@ -9,8 +9,11 @@
 #include <concepts>
 #include <format>
 #include <limits>
+#include <optional>
 #include <string>
+#include <type_traits>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "Message.hpp"
@@ -25,7 +28,7 @@ using namespace wpi::nt;
 using namespace wpi::nt::net;
 using namespace mpack;
 
-static bool GetNumber(wpi::util::json& val, double* num) {
+static bool GetNumber(const wpi::util::json& val, double* num) {
   if (val.is_number()) {
     *num = val.get_number();
   } else {
@@ -34,7 +37,7 @@ static bool GetNumber(wpi::util::json& val, double* num) {
   return true;
 }
 
-static bool GetNumber(wpi::util::json& val, int64_t* num) {
+static bool GetNumber(const wpi::util::json& val, int64_t* num) {
   if (val.is_int()) {
     *num = val.get_int();
   } else {
@@ -43,401 +46,580 @@ static bool GetNumber(wpi::util::json& val, int64_t* num) {
   return true;
 }
 
-static std::string* ObjGetString(wpi::util::json& obj, std::string_view key,
-                                 std::string* error) {
-  auto val = obj.lookup(key);
-  if (!val) {
+namespace {
+
+using JsonEvent = wpi::util::json_reader::Event;
+
+// A field of a JSON object. As with json objects, the first occurrence of a
+// key is used.
+using Field = std::optional<wpi::util::json>;
+
+// Fields of the subscribe "options" object
+struct OptionsField {
+  bool present = false;
+  bool isObject = false;
+  Field periodic;
+  Field sendAll;
+  Field topicsOnly;
+  Field prefixMatch;
+};
+
+// The subscribe "topics" array, decoded directly into strings
+struct TopicsField {
+  bool present = false;
+  bool isArray = false;
+  // index of the first element that isn't a string
+  std::optional<size_t> badIndex;
+  std::vector<std::string> names;
+};
+
+// Fields of a message's "params" object. The method may come after params,
+// so all fields used by any method are kept.
+struct Params {
+  Field name;
+  Field type;
+  Field pubuid;
+  Field properties;
+  Field update;
+  // client messages only
+  Field subuid;
+  OptionsField options;
+  TopicsField topics;
+  // server messages only
+  Field id;
+  Field ack;
+};
+
+}  // namespace
+
+static bool ReadField(wpi::util::json_reader& reader, Field& field) {
+  if (field) {
+    return reader.skip_value();
+  }
+  return reader.read_value(field.emplace());
+}
+
+// Skips the rest of a value after its first event, returning false on error
+static bool SkipRest(wpi::util::json_reader& reader, JsonEvent event) {
+  switch (event) {
+    case JsonEvent::BeginArray:
+    case JsonEvent::BeginObject:
+      return reader.skip_container();
+    case JsonEvent::Error:
+      return false;
+    default:
+      return true;
+  }
+}
+
+static bool ReadOptions(wpi::util::json_reader& reader, OptionsField& options) {
+  options.present = true;
+  auto event = reader.next();
+  if (event != JsonEvent::BeginObject) {
+    return SkipRest(reader, event);
+  }
+  options.isObject = true;
+  for (;;) {
+    event = reader.next();
+    if (event != JsonEvent::Key) {
+      return event == JsonEvent::EndObject;
+    }
+    auto key = reader.string();
+    bool ok;
+    if (key == "periodic") {
+      ok = ReadField(reader, options.periodic);
+    } else if (key == "all") {
+      ok = ReadField(reader, options.sendAll);
+    } else if (key == "topicsonly") {
+      ok = ReadField(reader, options.topicsOnly);
+    } else if (key == "prefix") {
+      ok = ReadField(reader, options.prefixMatch);
+    } else {
+      ok = reader.skip_value();
+    }
+    if (!ok) {
+      return false;
+    }
+  }
+}
+
+static bool ReadTopics(wpi::util::json_reader& reader, TopicsField& topics) {
+  topics.present = true;
+  auto event = reader.next();
+  if (event != JsonEvent::BeginArray) {
+    return SkipRest(reader, event);
+  }
+  topics.isArray = true;
+  for (;;) {
+    event = reader.next();
+    if (event == JsonEvent::EndArray) {
+      return true;
+    }
+    if (event == JsonEvent::String && !topics.badIndex) {
+      topics.names.emplace_back(reader.string());
+      continue;
+    }
+    if (!topics.badIndex) {
+      topics.badIndex = topics.names.size();
+    }
+    if (!SkipRest(reader, event)) {
+      return false;
+    }
+  }
+}
+
+template <bool IsClient>
+static bool ReadParams(wpi::util::json_reader& reader, Params& params) {
+  for (;;) {
+    auto event = reader.next();
+    if (event != JsonEvent::Key) {
+      return event == JsonEvent::EndObject;
+    }
+    auto key = reader.string();
+    bool ok;
+    if (key == "name") {
+      ok = ReadField(reader, params.name);
+    } else if (key == "type") {
+      ok = ReadField(reader, params.type);
+    } else if (key == "pubuid") {
+      ok = ReadField(reader, params.pubuid);
+    } else if (key == "properties") {
+      ok = ReadField(reader, params.properties);
+    } else if (key == "update") {
+      ok = ReadField(reader, params.update);
+    } else if (IsClient && key == "subuid") {
+      ok = ReadField(reader, params.subuid);
+    } else if (IsClient && key == "options" && !params.options.present) {
+      ok = ReadOptions(reader, params.options);
+    } else if (IsClient && key == "topics" && !params.topics.present) {
+      ok = ReadTopics(reader, params.topics);
+    } else if (!IsClient && key == "id") {
+      ok = ReadField(reader, params.id);
+    } else if (!IsClient && key == "ack") {
+      ok = ReadField(reader, params.ack);
+    } else {
+      ok = reader.skip_value();
+    }
+    if (!ok) {
+      return false;
+    }
+  }
+}
+
+static std::string* GetString(Field& field, std::string_view key,
+                              std::string* error) {
+  if (!field) {
     *error = std::format("no {} key", key);
     return nullptr;
   }
-  if (!val->is_string()) {
+  if (!field->is_string()) {
     *error = std::format("{} must be a string", key);
     return nullptr;
   }
-  return &val->get_string();
+  return &field->get_string();
 }
 
-static bool ObjGetNumber(wpi::util::json& obj, std::string_view key,
-                         std::string* error, int64_t* num) {
-  auto val = obj.lookup(key);
-  if (!val) {
+static bool GetNumber(const Field& field, std::string_view key,
+                      std::string* error, int64_t* num) {
+  if (!field) {
     *error = std::format("no {} key", key);
     return false;
   }
-  if (!GetNumber(*val, num)) {
+  if (!GetNumber(*field, num)) {
     *error = std::format("{} must be a number", key);
     return false;
   }
   return true;
 }
 
-static bool ObjGetStringArray(wpi::util::json& obj, std::string_view key,
-                              std::string* error,
-                              std::vector<std::string>* out) {
-  // prefixes
-  auto val = obj.lookup(key);
-  if (!val) {
+static bool GetObject(Field& field, std::string_view key, std::string* error) {
+  if (!field) {
     *error = std::format("no {} key", key);
     return false;
   }
-  if (!val->is_array()) {
-    *error = std::format("{} must be an array", key);
+  if (!field->is_object()) {
+    *error = std::format("{} must be an object", key);
     return false;
   }
-  auto& arr = val->get_array();
-  out->resize(0);
-  out->reserve(arr.size());
-  for (auto&& jval : arr) {
-    if (!jval.is_string()) {
-      *error = std::format("{}/{} must be a string", key, out->size());
+  return true;
+}
+
+// limit to 32-bit range and exclude endpoints used by wpi::util::DenseMap
+static bool IsIdInRange(int64_t id) {
+  return id < 0x7fffffffLL && id > (-0x7fffffffLL - 1);
+}
+
+static bool DecodeParams(std::string_view method, Params& params,
+                         std::vector<ClientMessage>& out, std::string* error,
+                         std::vector<std::string>&) {
+  if (method == PublishMsg::kMethodStr) {
+    auto name = GetString(params.name, "name", error);
+    if (!name) {
+      return false;
+    }
+    auto typeStr = GetString(params.type, "type", error);
+    if (!typeStr) {
+      return false;
+    }
+    int64_t pubuid;
+    if (!GetNumber(params.pubuid, "pubuid", error, &pubuid)) {
+      return false;
+    }
+    if (!IsIdInRange(pubuid)) {
+      *error = "pubuid out of range";
+      return false;
+    }
+    // properties; allow missing (treated as empty)
+    if (!params.properties) {
+      params.properties = wpi::util::json::object();
+    } else if (!params.properties->is_object()) {
+      *error = "properties must be an object";
+      return false;
+    }
+    out.emplace_back(ClientMessage{PublishMsg{
+        static_cast<int>(pubuid), std::move(*name), std::move(*typeStr),
+        std::move(*params.properties), {}}});
+  } else if (method == UnpublishMsg::kMethodStr) {
+    int64_t pubuid;
+    if (!GetNumber(params.pubuid, "pubuid", error, &pubuid)) {
+      return false;
+    }
+    if (!IsIdInRange(pubuid)) {
+      *error = "pubuid out of range";
+      return false;
+    }
+    out.emplace_back(ClientMessage{UnpublishMsg{static_cast<int>(pubuid)}});
+  } else if (method == SetPropertiesMsg::kMethodStr) {
+    auto name = GetString(params.name, "name", error);
+    if (!name) {
       return false;
     }
-    out->emplace_back(jval.get_string());
+    if (!GetObject(params.update, "update", error)) {
+      return false;
+    }
+    out.emplace_back(ClientMessage{
+        SetPropertiesMsg{std::move(*name), std::move(*params.update)}});
+  } else if (method == SubscribeMsg::kMethodStr) {
+    int64_t subuid;
+    if (!GetNumber(params.subuid, "subuid", error, &subuid)) {
+      return false;
+    }
+    if (!IsIdInRange(subuid)) {
+      *error = "subuid out of range";
+      return false;
+    }
+
+    PubSubOptionsImpl options;
+    auto& joptions = params.options;
+    if (joptions.present) {
+      if (!joptions.isObject) {
+        *error = "options must be an object";
+        return false;
+      }
+
+      // periodic
+      if (auto& periodic = joptions.periodic) {
+        double val;
+        if (!GetNumber(*periodic, &val)) {
+          *error = "periodic value must be a number";
+          return false;
+        }
+        if (!std::isfinite(val) || val < 0 ||
+            val > static_cast<double>(
+                      std::numeric_limits<unsigned int>::max()) /
+                      1000.0) {
+          *error = "periodic value out of range";
+          return false;
+        }
+        options.periodic = val;
+        options.periodicMs = static_cast<unsigned int>(val * 1000.0);
+      }
+
+      // send all changes
+      if (auto& sendAll = joptions.sendAll) {
+        if (!sendAll->is_bool()) {
+          *error = "all value must be a boolean";
+          return false;
+        }
+        options.sendAll = sendAll->get_bool();
+      }
+
+      // topics only
+      if (auto& topicsOnly = joptions.topicsOnly) {
+        if (!topicsOnly->is_bool()) {
+          *error = "topicsonly value must be a boolean";
+          return false;
+        }
+        options.topicsOnly = topicsOnly->get_bool();
+      }
+
+      // prefix match
+      if (auto& prefixMatch = joptions.prefixMatch) {
+        if (!prefixMatch->is_bool()) {
+          *error = "prefix value must be a boolean";
+          return false;
+        }
+        options.prefixMatch = prefixMatch->get_bool();
+      }
+    }
+
+    // topic names
+    auto& topics = params.topics;
+    if (!topics.present) {
+      *error = "no topics key";
+      return false;
+    }
+    if (!topics.isArray) {
+      *error = "topics must be an array";
+      return false;
+    }
+    if (topics.badIndex) {
+      *error = std::format("topics/{} must be a string", *topics.badIndex);
+      return false;
+    }
+
+    out.emplace_back(ClientMessage{SubscribeMsg{
+        static_cast<int>(subuid), std::move(topics.names), options}});
+  } else if (method == UnsubscribeMsg::kMethodStr) {
+    int64_t subuid;
+    if (!GetNumber(params.subuid, "subuid", error, &subuid)) {
+      return false;
+    }
+    if (!IsIdInRange(subuid)) {
+      *error = "pubuid out of range";
+      return false;
+    }
+    out.emplace_back(ClientMessage{UnsubscribeMsg{static_cast<int>(subuid)}});
+  } else {
+    *error = std::format("unrecognized method '{}'", method);
+    return false;
+  }
+  return true;
+}
+
+static bool DecodeParams(std::string_view method, Params& params,
+                         std::vector<ServerMessage>& out, std::string* error,
+                         std::vector<std::string>& warnings) {
+  if (method == AnnounceMsg::kMethodStr) {
+    auto name = GetString(params.name, "name", error);
+    if (!name) {
+      return false;
+    }
+    int64_t id;
+    if (!GetNumber(params.id, "id", error, &id)) {
+      return false;
+    }
+    if (!IsIdInRange(id)) {
+      *error = "id out of range";
+      return false;
+    }
+    auto typeStr = GetString(params.type, "type", error);
+    if (!typeStr) {
+      return false;
+    }
+
+    // pubuid
+    std::optional<int> pubuid;
+    if (params.pubuid) {
+      int64_t val;
+      if (!GetNumber(*params.pubuid, &val)) {
+        *error = "pubuid value must be a number";
+        return false;
+      }
+      if (!IsIdInRange(val)) {
+        *error = "pubuid out of range";
+        return false;
+      }
+      pubuid = val;
+    }
+
+    // properties
+    if (!params.properties) {
+      *error = "no properties key";
+      return false;
+    }
+    if (!params.properties->is_object()) {
+      warnings.emplace_back(
+          std::format("{}: properties is not an object", *name));
+      *params.properties = wpi::util::json::object();
+    }
+
+    out.emplace_back(ServerMessage{
+        AnnounceMsg{std::move(*name), static_cast<int>(id),
+                    std::move(*typeStr), pubuid,
+                    std::move(*params.properties)}});
+  } else if (method == UnannounceMsg::kMethodStr) {
+    auto name = GetString(params.name, "name", error);
+    if (!name) {
+      return false;
+    }
+    int64_t id;
+    if (!GetNumber(params.id, "id", error, &id)) {
+      return false;
+    }
+    if (!IsIdInRange(id)) {
+      *error = "id out of range";
+      return false;
+    }
+    out.emplace_back(
+        ServerMessage{UnannounceMsg{std::move(*name), static_cast<int>(id)}});
+  } else if (method == PropertiesUpdateMsg::kMethodStr) {
+    auto name = GetString(params.name, "name", error);
+    if (!name) {
+      return false;
+    }
+    if (!GetObject(params.update, "update", error)) {
+      return false;
+    }
+    bool ack = false;
+    if (params.ack) {
+      if (!params.ack->is_bool()) {
+        *error = "ack must be a boolean";
+        return false;
+      }
+      ack = params.ack->get_bool();
+    }
+    out.emplace_back(ServerMessage{PropertiesUpdateMsg{
+        std::move(*name), std::move(*params.update), ack}});
+  } else {
+    *error = std::format("unrecognized method '{}'", method);
+    return false;
   }
   return true;
 }
 
+// Returns true if client pub/sub metadata needs updating
+static bool Dispatch(std::vector<ClientMessage>& msgs,
+                     ClientMessageHandler& out) {
+  bool rv = false;
+  for (auto&& msg : msgs) {
+    if (auto m = std::get_if<PublishMsg>(&msg.contents)) {
+      out.ClientPublish(m->pubuid, m->name, m->typeStr, m->properties, {});
+      rv = true;
+    } else if (auto m = std::get_if<UnpublishMsg>(&msg.contents)) {
+      out.ClientUnpublish(m->pubuid);
+      rv = true;
+    } else if (auto m = std::get_if<SetPropertiesMsg>(&msg.contents)) {
+      out.ClientSetProperties(m->name, m->update);
+    } else if (auto m = std::get_if<SubscribeMsg>(&msg.contents)) {
+      out.ClientSubscribe(m->subuid, m->topicNames, m->options);
+      rv = true;
+    } else if (auto m = std::get_if<UnsubscribeMsg>(&msg.contents)) {
+      out.ClientUnsubscribe(m->subuid);
+      rv = true;
+    }
+  }
+  return rv;
+}
+
+static bool Dispatch(std::vector<ServerMessage>& msgs,
+                     ServerMessageHandler& out) {
+  for (auto&& msg : msgs) {
+    if (auto m = std::get_if<AnnounceMsg>(&msg.contents)) {
+      out.ServerAnnounce(m->name, m->id, m->typeStr, m->properties,
+                         m->pubuid);
+    } else if (auto m = std::get_if<UnannounceMsg>(&msg.contents)) {
+      out.ServerUnannounce(m->name, m->id);
+    } else if (auto m = std::get_if<PropertiesUpdateMsg>(&msg.contents)) {
+      out.ServerPropertiesUpdate(m->name, m->update, m->ack);
+    }
+  }
+  return false;
+}
+
+// Decodes a text frame with a streaming parser, straight into messages.
+// Messages are only passed to the handler once the whole frame has parsed,
+// so a JSON error anywhere in the frame rejects all of it.
 template <typename T>
   requires(std::same_as<T, ClientMessageHandler> ||
            std::same_as<T, ServerMessageHandler>)
 static bool WireDecodeTextImpl(std::string_view in, T& out,
                                wpi::util::Logger& logger) {
-  auto j = wpi::util::json::parse(in);
-  if (!j) {
-    WPI_WARNING(logger, "could not decode JSON message: {}", j.error());
-    return false;
-  }
-
-  if (!j->is_array()) {
-    WPI_WARNING(logger, "expected JSON array at top level");
+  constexpr bool isClient = std::same_as<T, ClientMessageHandler>;
+  using Message = std::conditional_t<isClient, ClientMessage, ServerMessage>;
+
+  wpi::util::json_reader reader{in};
+  auto event = reader.next();
+  if (event != JsonEvent::BeginArray) {
+    if (SkipRest(reader, event) && reader.next() == JsonEvent::End) {
+      WPI_WARNING(logger, "expected JSON array at top level");
+    } else {
+      WPI_WARNING(logger, "could not decode JSON message: {}", reader.error());
+    }
     return false;
   }
 
-  bool rv = false;
-  int i = -1;
-  for (auto&& jmsg : j->get_array()) {
-    ++i;
-    std::string error;
-    {
-      if (!jmsg.is_object()) {
-        error = "expected message to be an object";
-        goto err;
+  std::vector<Message> msgs;
+  std::vector<std::string> warnings;
+  for (int i = 0;; ++i) {
+    event = reader.next();
+    if (event == JsonEvent::EndArray) {
+      break;
+    }
+    if (event != JsonEvent::BeginObject) {
+      if (!SkipRest(reader, event)) {
+        break;
       }
+      warnings.emplace_back(
+          std::format("{}: expected message to be an object", i));
+      continue;
+    }
 
-      auto method = ObjGetString(jmsg, "method", &error);
-      if (!method) {
-        goto err;
+    Field method;
+    bool hasParams = false;
+    bool paramsIsObject = false;
+    Params params;
+    bool ok = true;
+    while (ok) {
+      event = reader.next();
+      if (event != JsonEvent::Key) {
+        ok = event == JsonEvent::EndObject;
+        break;
       }
+      auto key = reader.string();
+      if (key == "method") {
+        ok = ReadField(reader, method);
+      } else if (key == "params" && !hasParams) {
+        hasParams = true;
+        event = reader.next();
+        if (event == JsonEvent::BeginObject) {
+          paramsIsObject = true;
+          ok = ReadParams<isClient>(reader, params);
+        } else {
+          ok = SkipRest(reader, event);
+        }
+      } else {
+        ok = reader.skip_value();
+      }
+    }
+    if (!ok) {
+      break;
+    }
 
-      auto params = jmsg.lookup("params");
-      if (!params) {
+    std::string error;
+    auto methodStr = GetString(method, "method", &error);
+    if (methodStr) {
+      if (!hasParams) {
         error = "no params key";
-        goto err;
-      }
-      if (!params->is_object()) {
+      } else if (!paramsIsObject) {
         error = "params must be an object";
-        goto err;
-      }
-
-      if constexpr (std::same_as<T, ClientMessageHandler>) {
-        if (*method == PublishMsg::kMethodStr) {
-          // name
-          auto name = ObjGetString(*params, "name", &error);
-          if (!name) {
-            goto err;
-          }
-
-          // type
-          auto typeStr = ObjGetString(*params, "type", &error);
-          if (!typeStr) {
-            goto err;
-          }
-
-          // pubuid
-          int64_t pubuid;
-          if (!ObjGetNumber(*params, "pubuid", &error, &pubuid)) {
-            goto err;
-          }
-
-          // limit to 32-bit range and exclude endpoints used by
-          // wpi::util::DenseMap
-          if (pubuid >= 0x7fffffffLL || pubuid <= (-0x7fffffffLL - 1)) {
-            error = "pubuid out of range";
-            goto err;
-          }
-
-          // properties; allow missing (treated as empty)
-          auto properties = params->lookup("properties");
-          if (properties && !properties->is_object()) {
-            error = "properties must be an object";
-            goto err;
-          }
-          wpi::util::json propertiesEmpty;
-          if (!properties) {
-            propertiesEmpty = wpi::util::json::object();
-            properties = &propertiesEmpty;
-          }
-
-          // complete
-          out.ClientPublish(pubuid, *name, *typeStr, *properties, {});
-          rv = true;
-        } else if (*method == UnpublishMsg::kMethodStr) {
-          // pubuid
-          int64_t pubuid;
-          if (!ObjGetNumber(*params, "pubuid", &error, &pubuid)) {
-            goto err;
-          }
-
-          // limit to 32-bit range and exclude endpoints used by
-          // wpi::util::DenseMap
-          if (pubuid >= 0x7fffffffLL || pubuid <= (-0x7fffffffLL - 1)) {
-            error = "pubuid out of range";
-            goto err;
-          }
-
-          // complete
-          out.ClientUnpublish(pubuid);
-          rv = true;
-        } else if (*method == SetPropertiesMsg::kMethodStr) {
-          // name
-          auto name = ObjGetString(*params, "name", &error);
-          if (!name) {
-            goto err;
-          }
-
-          // update
-          auto update = params->lookup("update");
-          if (!update) {
-            error = "no update key";
-            goto err;
-          }
-          if (!update->is_object()) {
-            error = "update must be an object";
-            goto err;
-          }
-
-          // complete
-          out.ClientSetProperties(*name, *update);
-        } else if (*method == SubscribeMsg::kMethodStr) {
-          // subuid
-          int64_t subuid;
-          if (!ObjGetNumber(*params, "subuid", &error, &subuid)) {
-            goto err;
-          }
-
-          // limit to 32-bit range and exclude endpoints used by
-          // wpi::util::DenseMap
-          if (subuid >= 0x7fffffffLL || subuid <= (-0x7fffffffLL - 1)) {
-            error = "subuid out of range";
-            goto err;
-          }
-
-          // options
-          PubSubOptionsImpl options;
-          if (auto joptions = params->lookup("options")) {
-            if (!joptions->is_object()) {
-              error = "options must be an object";
-              goto err;
-            }
-
-            // periodic
-            if (auto periodic = joptions->lookup("periodic")) {
-              double val;
-              if (!GetNumber(*periodic, &val)) {
-                error = "periodic value must be a number";
-                goto err;
-              }
-              if (!std::isfinite(val) || val < 0 ||
-                  val > static_cast<double>(
-                            std::numeric_limits<unsigned int>::max()) /
-                            1000.0) {
-                error = "periodic value out of range";
-                goto err;
-              }
-              options.periodic = val;
-              options.periodicMs = static_cast<unsigned int>(val * 1000.0);
-            }
-
-            // send all changes
-            if (auto sendAll = joptions->lookup("all")) {
-              if (!sendAll->is_bool()) {
-                error = "all value must be a boolean";
-                goto err;
-              }
-              options.sendAll = sendAll->get_bool();
-            }
-
-            // topics only
-            if (auto topicsOnly = joptions->lookup("topicsonly")) {
-              if (!topicsOnly->is_bool()) {
-                error = "topicsonly value must be a boolean";
-                goto err;
-              }
-              options.topicsOnly = topicsOnly->get_bool();
-            }
-
-            // prefix match
-            if (auto prefixMatch = joptions->lookup("prefix")) {
-              if (!prefixMatch->is_bool()) {
-                error = "prefix value must be a boolean";
-                goto err;
-              }
-              options.prefixMatch = prefixMatch->get_bool();
-            }
-          }
-
-          // topic names
-          std::vector<std::string> topicNames;
-          if (!ObjGetStringArray(*params, "topics", &error, &topicNames)) {
-            goto err;
-          }
-
-          // complete
-          out.ClientSubscribe(subuid, topicNames, options);
-          rv = true;
-        } else if (*method == UnsubscribeMsg::kMethodStr) {
-          // subuid
-          int64_t subuid;
-          if (!ObjGetNumber(*params, "subuid", &error, &subuid)) {
-            goto err;
-          }
-
-          // limit to 32-bit range and exclude endpoints used by
-          // wpi::util::DenseMap
-          if (subuid >= 0x7fffffffLL || subuid <= (-0x7fffffffLL - 1)) {
-            error = "pubuid out of range";
-            goto err;
-          }
-
-          // complete
-          out.ClientUnsubscribe(subuid);
-          rv = true;
-        } else {
-          error = std::format("unrecognized method '{}'", *method);
-          goto err;
-        }
-      } else if constexpr (std::same_as<T, ServerMessageHandler>) {
-        if (*method == AnnounceMsg::kMethodStr) {
-          // name
-          auto name = ObjGetString(*params, "name", &error);
-          if (!name) {
-            goto err;
-          }
-
-          // id
-          int64_t id;
-          if (!ObjGetNumber(*params, "id", &error, &id)) {
-            goto err;
-          }
-
-          // limit to 32-bit range and exclude endpoints used by
-          // wpi::util::DenseMap
-          if (id >= 0x7fffffffLL || id <= (-0x7fffffffLL - 1)) {
-            error = "id out of range";
-            goto err;
-          }
-
-          // type
-          auto typeStr = ObjGetString(*params, "type", &error);
-          if (!typeStr) {
-            goto err;
-          }
-
-          // pubuid
-          std::optional<int64_t> pubuid;
-          if (auto jpubuid = params->lookup("pubuid")) {
-            int64_t val;
-            if (!GetNumber(*jpubuid, &val)) {
-              error = "pubuid value must be a number";
-              goto err;
-            }
-
-            // limit to 32-bit range and exclude endpoints used by
-            // wpi::util::DenseMap
-            if (val >= 0x7fffffffLL || val <= (-0x7fffffffLL - 1)) {
-              error = "pubuid out of range";
-              goto err;
-            }
-
-            pubuid = val;
-          }
-
-          // properties
-          auto properties = params->lookup("properties");
-          if (!properties) {
-            error = "no properties key";
-            goto err;
-          }
-          if (!properties->is_object()) {
-            WPI_WARNING(logger, "{}: properties is not an object", *name);
-            *properties = wpi::util::json::object();
-          }
-
-          // complete
-          out.ServerAnnounce(*name, id, *typeStr, *properties, pubuid);
-        } else if (*method == UnannounceMsg::kMethodStr) {
-          // name
-          auto name = ObjGetString(*params, "name", &error);
-          if (!name) {
-            goto err;
-          }
-
-          // id
-          int64_t id;
-          if (!ObjGetNumber(*params, "id", &error, &id)) {
-            goto err;
-          }
-
-          // limit to 32-bit range and exclude endpoints used by
-          // wpi::util::DenseMap
-          if (id >= 0x7fffffffLL || id <= (-0x7fffffffLL - 1)) {
-            error = "id out of range";
-            goto err;
-          }
-
-          // complete
-          out.ServerUnannounce(*name, id);
-        } else if (*method == PropertiesUpdateMsg::kMethodStr) {
-          // name
-          auto name = ObjGetString(*params, "name", &error);
-          if (!name) {
-            goto err;
-          }
-
-          // update
-          auto update = params->lookup("update");
-          if (!update) {
-            error = "no update key";
-            goto err;
-          }
-          if (!update->is_object()) {
-            error = "update must be an object";
-            goto err;
-          }
-
-          bool ack = false;
-          if (auto jack = params->lookup("ack")) {
-            if (!jack->is_bool()) {
-              error = "ack must be a boolean";
-              goto err;
-            }
-            ack = jack->get_bool();
-          }
-
-          // complete
-          out.ServerPropertiesUpdate(*name, *update, ack);
-        } else {
-          error = std::format("unrecognized method '{}'", *method);
-          goto err;
-        }
+      } else {
+        DecodeParams(*methodStr, params, msgs, &error, warnings);
       }
-      continue;
     }
-  err:
-    WPI_WARNING(logger, "{}: {}", i, error);
+    if (!error.empty()) {
+      warnings.emplace_back(std::format("{}: {}", i, error));
+    }
   }
 
-  return rv;
+  if (event == JsonEvent::Error || reader.next() != JsonEvent::End) {
+    WPI_WARNING(logger, "could not decode JSON message: {}", reader.error());
+    return false;
+  }
+  for (auto&& warning : warnings) {
+    WPI_WARNING(logger, "{}", warning);
+  }
+  return Dispatch(msgs, out);
 }
 
 bool wpi::nt::net::WireDecodeText(std::string_view in,
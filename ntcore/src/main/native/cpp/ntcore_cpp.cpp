@@ -647,9 +647,11 @@ void StopLocal(NT_Inst inst) {
 
 void StartServer(NT_Inst inst, std::string_view persist_filename,
                  std::string_view listen_address, std::string_view mdns_service,
-                 unsigned int port) {
+                 unsigned int port, unsigned int io_threads,
+                 bool persist_journal) {
   if (auto ii = InstanceImpl::GetTyped(inst, Handle::INSTANCE)) {
-    ii->StartServer(persist_filename, listen_address, mdns_service, port);
+    ii->StartServer(persist_filename, listen_address, mdns_service, port,
+                    io_threads, persist_journal);
   }
 }
 
@@ -50,6 +50,8 @@ class ServerClient {
   // these return true if any messages have been queued for later processing
   virtual bool ProcessIncomingText(std::string_view data) = 0;
   virtual bool ProcessIncomingBinary(std::span<const uint8_t> data) = 0;
+  // messages decoded by a connection thread; contents may be moved from
+  virtual bool ProcessIncomingDecoded(std::span<net::ClientMessage> msgs) = 0;
 
   virtual void SendValue(ServerTopic* topic, const Value& value,
                          net::ValueSendMode mode) = 0;
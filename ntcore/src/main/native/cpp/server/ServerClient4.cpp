@@ -5,6 +5,7 @@
 #include "ServerClient4.hpp"
 
 #include <string>
+#include <utility>
 
 #include "Log.hpp"
 #include "net/WireDecoder.hpp"
@@ -88,6 +89,21 @@ bool ServerClient4::ProcessIncomingBinary(std::span<const uint8_t> data) {
   return false;
 }
 
+bool ServerClient4::ProcessIncomingDecoded(
+    std::span<net::ClientMessage> msgs) {
+  constexpr int kMaxImmProcessing = 10;
+  bool queueWasEmpty = m_incoming.empty();
+  for (auto&& msg : msgs) {
+    m_incoming.Enqueue(std::move(msg));
+  }
+  if (queueWasEmpty &&
+      DoProcessIncomingMessages(m_incoming, kMaxImmProcessing)) {
+    m_wire.StopRead();
+    return true;
+  }
+  return false;
+}
+
 void ServerClient4::SendValue(ServerTopic* topic, const Value& value,
                               net::ValueSendMode mode) {
   m_outgoing.SendValue(topic->id, value, mode);
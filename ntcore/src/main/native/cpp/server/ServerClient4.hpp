@@ -21,6 +21,7 @@ class ServerClient4 final : public ServerClient4Base {
 
   bool ProcessIncomingText(std::string_view data) final;
   bool ProcessIncomingBinary(std::span<const uint8_t> data) final;
+  bool ProcessIncomingDecoded(std::span<net::ClientMessage> msgs) final;
 
   bool ProcessIncomingMessages(size_t max) final {
     if (!DoProcessIncomingMessages(m_incoming, max)) {
@@ -19,6 +19,9 @@ class ServerClientLocal final : public ServerClient4Base {
   bool ProcessIncomingBinary(std::span<const uint8_t> data) final {
     return false;
   }
+  bool ProcessIncomingDecoded(std::span<net::ClientMessage> msgs) final {
+    return false;
+  }
 
   bool ProcessIncomingMessages(size_t max) final {
     if (!m_queue) {
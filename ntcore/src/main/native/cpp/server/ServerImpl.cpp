@@ -177,6 +177,15 @@ bool ServerImpl::ProcessIncomingBinary(int clientId,
   }
 }
 
+bool ServerImpl::ProcessIncomingDecoded(int clientId,
+                                        std::span<net::ClientMessage> msgs) {
+  if (auto client = m_clients[clientId].get()) {
+    return client->ProcessIncomingDecoded(msgs);
+  } else {
+    return false;
+  }
+}
+
 bool ServerImpl::ProcessIncomingMessages(size_t max) {
   DEBUG4("ProcessIncomingMessages({})", max);
   bool rv = false;
@@ -200,3 +209,11 @@ std::string ServerImpl::DumpPersistent() {
   os.flush();
   return rv;
 }
+
+std::string ServerImpl::DumpPersistentChanges() {
+  std::string rv;
+  wpi::util::raw_string_ostream os{rv};
+  m_storage.DumpPersistentChanges(os);
+  os.flush();
+  return rv;
+}
@@ -50,6 +50,9 @@ class ServerImpl final {
   // these return true if any messages have been queued for later processing
   bool ProcessIncomingText(int clientId, std::string_view data);
   bool ProcessIncomingBinary(int clientId, std::span<const uint8_t> data);
+  // messages already decoded (e.g. by a connection thread)
+  bool ProcessIncomingDecoded(int clientId,
+                              std::span<net::ClientMessage> msgs);
 
   // later processing -- returns true if more to process
   bool ProcessIncomingMessages(size_t max);
@@ -71,9 +74,13 @@ class ServerImpl final {
   bool PersistentChanged() { return m_storage.PersistentChanged(); }
 
   std::string DumpPersistent();
+  // journal records for persistent values changed since the last call to this
+  // function or PersistentChanged(); empty if nothing changed
+  std::string DumpPersistentChanges();
   // returns newline-separated errors
-  std::string LoadPersistent(std::string_view in) {
-    return m_storage.LoadPersistent(in);
+  std::string LoadPersistent(std::string_view in,
+                             std::string_view journal = {}) {
+    return m_storage.LoadPersistent(in, journal);
   }
 
  private:
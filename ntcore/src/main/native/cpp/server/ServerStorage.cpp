@@ -7,6 +7,7 @@
 #include <format>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -15,6 +16,7 @@
 #include "server/ServerClient.hpp"
 #include "wpi/util/Base64.hpp"
 #include "wpi/util/MessagePack.hpp"
+#include "wpi/util/StringExtras.hpp"
 #include "wpi/util/json.hpp"
 
 using namespace wpi::nt;
@@ -97,7 +99,7 @@ void ServerStorage::SetProperties(ServerClient* client, ServerTopic* topic,
   if (topic->SetProperties(update)) {
     // update persistentChanged flag
     if (topic->persistent != wasPersistent) {
-      m_persistentChanged = true;
+      MarkPersistentChanged(topic);
     }
     PropertiesChanged(client, topic, update);
   }
@@ -109,7 +111,7 @@ void ServerStorage::SetFlags(ServerClient* client, ServerTopic* topic,
   if (topic->SetFlags(flags)) {
     // update persistentChanged flag
     if (topic->persistent != wasPersistent) {
-      m_persistentChanged = true;
+      MarkPersistentChanged(topic);
       wpi::util::json update;
       if (topic->persistent) {
         update = wpi::util::json::object("persistent", true);
@@ -135,7 +137,7 @@ void ServerStorage::SetValue(ServerClient* client, ServerTopic* topic,
 
     // if persistent, update flag
     if (topic->persistent) {
-      m_persistentChanged = true;
+      MarkPersistentChanged(topic);
     }
   }
 
@@ -361,6 +363,43 @@ void ServerStorage::DumpPersistent(wpi::util::raw_ostream& os) {
   os << "\n]\n";
 }
 
+bool ServerStorage::DumpPersistentChanges(wpi::util::raw_ostream& os) {
+  if (m_persistentChanges.empty()) {
+    return false;
+  }
+  for (auto&& name : m_persistentChanges) {
+    auto topic = GetTopic(name);
+    if (topic) {
+      topic->persistentChanged = false;
+    }
+    os << "{\"name\":";
+    wpi::util::json::stringify_string(os, name);
+    if (!topic || !topic->persistent || !topic->lastValue) {
+      os << ",\"deleted\":true}\n";
+      continue;
+    }
+    os << ",\"type\":";
+    wpi::util::json::stringify_string(os, topic->typeStr);
+    os << ",\"value\":";
+    DumpValue(os, topic->lastValue);
+    os << ",\"properties\":";
+    topic->properties.marshal(os);
+    os << "}\n";
+  }
+  m_persistentChanges.clear();
+  m_persistentChanged = false;
+  return true;
+}
+
+void ServerStorage::ClearPersistentChanges(size_t start) {
+  for (size_t i = start; i < m_persistentChanges.size(); ++i) {
+    if (auto topic = GetTopic(m_persistentChanges[i])) {
+      topic->persistentChanged = false;
+    }
+  }
+  m_persistentChanges.resize(start);
+}
+
 static std::string* ObjGetString(wpi::util::json& obj, std::string_view key,
                                  std::string* error) {
   auto value = obj.lookup(key);
@@ -375,27 +414,96 @@ static std::string* ObjGetString(wpi::util::json& obj, std::string_view key,
   return &value->get_string();
 }
 
-std::string ServerStorage::LoadPersistent(std::string_view in) {
-  if (in.empty()) {
+// Applies journal records to the items loaded from the persistent file. The
+// last record for a name wins; deleted items are flagged rather than erased so
+// the indices used in error messages stay the same.
+static void ReplayJournal(wpi::util::json::array_t& items,
+                          std::vector<bool>& deleted, std::string_view journal,
+                          std::string& allerrors) {
+  wpi::util::StringMap<size_t> index;
+  for (size_t i = 0; i < items.size(); ++i) {
+    if (items[i].is_object()) {
+      if (auto name = items[i].lookup("name"); name && name->is_string()) {
+        index[name->get_string()] = i;
+      }
+    }
+  }
+  deleted.resize(items.size());
+
+  int lineNum = 0;
+  while (!journal.empty()) {
+    std::string_view line;
+    std::tie(line, journal) = wpi::util::split(journal, '\n');
+    ++lineNum;
+    if (line.empty()) {
+      continue;
+    }
+    auto j = wpi::util::json::parse(line);
+    if (!j || !j->is_object()) {
+      // most likely a partial write of the last record
+      allerrors += std::format("journal {}: could not decode JSON\n", lineNum);
+      continue;
+    }
+    auto name = j->lookup("name");
+    if (!name || !name->is_string()) {
+      allerrors += std::format("journal {}: no name key\n", lineNum);
+      continue;
+    }
+    auto [it, inserted] = index.try_emplace(name->get_string(), items.size());
+    auto del = j->lookup("deleted");
+    if (del && del->is_bool() && del->get_bool()) {
+      if (!inserted) {
+        deleted[it->second] = true;
+      } else {
+        index.erase(it);
+      }
+      continue;
+    }
+    if (inserted) {
+      items.emplace_back(std::move(*j));
+      deleted.push_back(false);
+    } else {
+      items[it->second] = std::move(*j);
+      deleted[it->second] = false;
+    }
+  }
+}
+
+std::string ServerStorage::LoadPersistent(std::string_view in,
+                                          std::string_view journal) {
+  if (in.empty() && journal.empty()) {
     return {};
   }
 
-  auto j = wpi::util::json::parse(in);
-  if (!j) {
-    return std::format("could not decode JSON: {}", j.error());
+  wpi::util::json::array_t items;
+  if (!in.empty()) {
+    auto j = wpi::util::json::parse(in);
+    if (!j) {
+      return std::format("could not decode JSON: {}", j.error());
+    }
+
+    if (!j->is_array()) {
+      return "expected JSON array at top level";
+    }
+    items = std::move(j->get_array());
   }
 
-  if (!j->is_array()) {
-    return "expected JSON array at top level";
+  std::string allerrors;
+  std::vector<bool> deleted;
+  if (!journal.empty()) {
+    ReplayJournal(items, deleted, journal, allerrors);
   }
 
   bool persistentChanged = m_persistentChanged;
+  size_t numChanges = m_persistentChanges.size();
 
-  std::string allerrors;
   int i = -1;
   auto time = wpi::nt::Now();
-  for (auto&& jitem : j->get_array()) {
+  for (auto&& jitem : items) {
     ++i;
+    if (!deleted.empty() && deleted[i]) {
+      continue;
+    }
     std::string error;
     {
       if (!jitem.is_object()) {
@@ -578,7 +686,9 @@ std::string ServerStorage::LoadPersistent(std::string_view in) {
     allerrors += std::format("{}: {}\n", i, error);
   }
 
-  m_persistentChanged = persistentChanged;  // restore flag
+  // restore flag; loaded values don't need to be saved again
+  m_persistentChanged = persistentChanged;
+  ClearPersistentChanges(numChanges);
 
   return allerrors;
 }
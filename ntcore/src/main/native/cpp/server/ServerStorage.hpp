@@ -8,6 +8,7 @@
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "server/ServerTopic.hpp"
 #include "wpi/util/StringMap.hpp"
@@ -72,16 +73,25 @@ class ServerStorage final {
   void UpdateMetaTopicPub(ServerTopic* topic);
   void UpdateMetaTopicSub(ServerTopic* topic);
 
-  // if any persistent values changed since the last call to this function
+  // if any persistent values changed since the last call to this function or
+  // DumpPersistentChanges()
   bool PersistentChanged() {
     bool rv = m_persistentChanged;
     m_persistentChanged = false;
+    ClearPersistentChanges();
     return rv;
   }
 
   void DumpPersistent(wpi::util::raw_ostream& os);
-  // returns newline-separated errors
-  std::string LoadPersistent(std::string_view in);
+  // writes a journal record (one JSON object per line) for each persistent
+  // topic changed since the last call to this function or PersistentChanged();
+  // topics that are no longer persistent are written as deletion records.
+  // returns false if nothing changed.
+  bool DumpPersistentChanges(wpi::util::raw_ostream& os);
+  // journal contains records from DumpPersistentChanges() to apply on top of
+  // the in data; returns newline-separated errors
+  std::string LoadPersistent(std::string_view in,
+                             std::string_view journal = {});
 
  private:
   wpi::util::Logger& m_logger;
@@ -90,6 +100,16 @@ class ServerStorage final {
   wpi::util::UidVector<std::unique_ptr<ServerTopic>, 16> m_topics;
   wpi::util::StringMap<ServerTopic*> m_nameTopics;
   bool m_persistentChanged{false};
+  std::vector<std::string> m_persistentChanges;
+
+  void MarkPersistentChanged(ServerTopic* topic) {
+    m_persistentChanged = true;
+    if (!topic->persistentChanged) {
+      topic->persistentChanged = true;
+      m_persistentChanges.emplace_back(topic->name);
+    }
+  }
+  void ClearPersistentChanges(size_t start = 0);
 };
 
 }  // namespace wpi::nt::server
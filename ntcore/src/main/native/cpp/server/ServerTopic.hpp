@@ -79,6 +79,7 @@ struct ServerTopic {
   bool retained{false};
   bool cached{true};
   bool special{false};
+  bool persistentChanged{false};  // in ServerStorage changed list
   int localTopic{0};
 
   void AddPublisher(ServerClient* client, ServerPublisher* pub) {
@@ -611,13 +611,25 @@ class NetworkTableInstance final {
    *                          string to not announce via mDNS (UTF-8 string,
    *                          null terminated)
    * @param port              port to communicate over
+   * @param io_threads        number of threads to handle client connection
+   *                          I/O on; 0 handles clients on the same thread as
+   *                          the server storage. Using more than one thread
+   *                          is useful with many clients.
+   * @param persist_journal   if true, changed persistent values are appended
+   *                          to a journal file (persist_filename with a
+   *                          .journal suffix) instead of rewriting the persist
+   *                          file; the persist file is rewritten only when the
+   *                          journal grows larger than it. This reduces the
+   *                          amount written when there are many persistent
+   *                          values.
    */
   void StartServer(std::string_view persist_filename = "networktables.json",
                    std::string_view listen_address = "",
                    std::string_view mdns_service = "",
-                   unsigned int port = DEFAULT_PORT) {
+                   unsigned int port = DEFAULT_PORT,
+                   unsigned int io_threads = 0, bool persist_journal = false) {
     ::wpi::nt::StartServer(m_handle, persist_filename, listen_address,
-                           mdns_service, port);
+                           mdns_service, port, io_threads, persist_journal);
   }
 
   /**
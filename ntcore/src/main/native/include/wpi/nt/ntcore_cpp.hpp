@@ -1088,10 +1088,17 @@ void StopLocal(NT_Inst inst);
  *                          string to not advertise via mDNS. (UTF-8 string,
  *                          null terminated)
  * @param port              port to communicate over
+ * @param io_threads        number of threads to handle client connection
+ *                          I/O on; 0 handles clients on the same thread as
+ *                          the server storage
+ * @param persist_journal   if true, changed persistent values are appended to
+ *                          a journal file (persist_filename with a .journal
+ *                          suffix) instead of rewriting the persist file
  */
 void StartServer(NT_Inst inst, std::string_view persist_filename,
                  std::string_view listen_address, std::string_view mdns_service,
-                 unsigned int port);
+                 unsigned int port, unsigned int io_threads = 0,
+                 bool persist_journal = false);
 
 /**
  * Stops the server if it is running.
@@ -4,9 +4,12 @@
 
 #include <chrono>
 #include <filesystem>
+#include <format>
 #include <fstream>
+#include <iterator>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <catch2/catch_message.hpp>
 #include <catch2/catch_test_macros.hpp>
@@ -28,6 +31,7 @@ static constexpr unsigned int RESTORE_BACKUP_PORT = 10040;
 static constexpr unsigned int NORMAL_LOAD_PORT = 10041;
 static constexpr unsigned int ORIGINAL_OVER_BACKUP_PORT = 10042;
 static constexpr unsigned int NO_FILE_PORT = 10043;
+static constexpr unsigned int IO_THREADS_PORT = 10044;
 
 class NetworkServerPersistentTest {
  public:
@@ -193,3 +197,146 @@ TEST_CASE_METHOD(NetworkServerPersistentTest,
   inst.StopServer();
   wpi::nt::NetworkTableInstance::Destroy(inst);
 }
+
+// Verify that clients handled on separate I/O threads exchange values with the
+// server and are removed when they disconnect.
+TEST_CASE_METHOD(NetworkServerPersistentTest,
+                 "NetworkServerPersistentTest IoThreads",
+                 "[ntcore][network-server]") {
+  auto server = wpi::nt::NetworkTableInstance::Create();
+  server.StartServer(m_persistFile, "127.0.0.1", "", IO_THREADS_PORT, 2);
+  auto serverPub = server.GetIntegerTopic("/server").Publish();
+  serverPub.Set(5);
+
+  constexpr int kNumClients = 4;
+  std::vector<wpi::nt::NetworkTableInstance> clients;
+  std::vector<wpi::nt::IntegerPublisher> clientPubs;
+  std::vector<wpi::nt::IntegerSubscriber> clientSubs;
+  for (int i = 0; i < kNumClients; ++i) {
+    auto& client =
+        clients.emplace_back(wpi::nt::NetworkTableInstance::Create());
+    clientSubs.emplace_back(client.GetIntegerTopic("/server").Subscribe(0));
+    clientPubs.emplace_back(
+        client.GetIntegerTopic(std::format("/client{}", i)).Publish());
+    clientPubs.back().Set(i + 10);
+    client.StartClient(std::format("client{}", i));
+    client.SetServer("127.0.0.1", IO_THREADS_PORT);
+  }
+
+  auto waitFor = [](auto&& cond) {
+    auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds{3000};
+    while (std::chrono::steady_clock::now() < deadline) {
+      if (cond()) {
+        return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    }
+    return false;
+  };
+
+  CHECK(waitFor([&] { return server.GetConnections().size() == kNumClients; }));
+
+  // client to server
+  for (int i = 0; i < kNumClients; ++i) {
+    auto sub = server.GetIntegerTopic(std::format("/client{}", i)).Subscribe(0);
+    CHECK(waitFor([&] { return sub.Get() == i + 10; }));
+  }
+
+  // server to clients
+  serverPub.Set(6);
+  server.Flush();
+  for (auto&& sub : clientSubs) {
+    CHECK(waitFor([&] { return sub.Get() == 6; }));
+  }
+
+  // disconnect
+  clients.back().StopClient();
+  CHECK(waitFor(
+      [&] { return server.GetConnections().size() == kNumClients - 1; }));
+
+  clientPubs.clear();
+  clientSubs.clear();
+  for (auto&& client : clients) {
+    wpi::nt::NetworkTableInstance::Destroy(client);
+  }
+  serverPub = {};
+  server.StopServer();
+  wpi::nt::NetworkTableInstance::Destroy(server);
+}
+
+// Verify that persistent changes are written to the journal rather than the
+// persistent file, that the journal is replayed at startup, and that a journal
+// is folded into the persistent file when journaling is turned off.
+TEST_CASE_METHOD(NetworkServerPersistentTest,
+                 "NetworkServerPersistentTest Journal",
+                 "[ntcore][network-server]") {
+  WriteFile(m_persistFile, PERSISTENT_JSON);
+  auto journalFile = m_persistFile + ".journal";
+
+  auto readFile = [](const std::string& path) {
+    std::ifstream is{path};
+    return std::string{std::istreambuf_iterator<char>{is}, {}};
+  };
+  auto waitFor = [](auto&& cond) {
+    auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds{3000};
+    while (std::chrono::steady_clock::now() < deadline) {
+      if (cond()) {
+        return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    }
+    return false;
+  };
+
+  // subscribe before starting the server so persistent topics are announced
+  auto inst = wpi::nt::NetworkTableInstance::Create();
+  auto sub = inst.GetIntegerTopic("/test/persistent_value").Subscribe(0);
+  auto journalSub = inst.GetIntegerTopic("/test/journal_value").Subscribe(0);
+  inst.StartServer(m_persistFile, "127.0.0.1", "", 0, 0, true);
+  REQUIRE(WaitForTopic(inst, "/test/persistent_value"));
+  {
+    auto pub = inst.GetIntegerTopic("/test/persistent_value").Publish();
+    pub.Set(43);
+    auto topic = inst.GetIntegerTopic("/test/journal_value");
+    auto journalPub = topic.Publish();
+    topic.SetPersistent(true);
+    journalPub.Set(7);
+    CHECK(waitFor([&] {
+      return readFile(journalFile).find("journal_value") !=
+             std::string::npos;
+    }));
+  }
+  CHECK(readFile(m_persistFile) == PERSISTENT_JSON);
+  sub = {};
+  journalSub = {};
+  inst.StopServer();
+  wpi::nt::NetworkTableInstance::Destroy(inst);
+
+  // replay the journal
+  inst = wpi::nt::NetworkTableInstance::Create();
+  sub = inst.GetIntegerTopic("/test/persistent_value").Subscribe(0);
+  journalSub = inst.GetIntegerTopic("/test/journal_value").Subscribe(0);
+  inst.StartServer(m_persistFile, "127.0.0.1", "", 0, 0, true);
+  REQUIRE(WaitForTopic(inst, "/test/journal_value"));
+  CHECK(sub.Get() == 43);
+  CHECK(journalSub.Get() == 7);
+  sub = {};
+  journalSub = {};
+  inst.StopServer();
+  wpi::nt::NetworkTableInstance::Destroy(inst);
+
+  // fold the journal into the persistent file
+  inst = wpi::nt::NetworkTableInstance::Create();
+  sub = inst.GetIntegerTopic("/test/persistent_value").Subscribe(0);
+  inst.StartServer(m_persistFile, "127.0.0.1", "", 0);
+  REQUIRE(WaitForTopic(inst, "/test/persistent_value"));
+  CHECK(sub.Get() == 43);
+  CHECK(waitFor([&] { return !std::filesystem::exists(journalFile); }));
+  CHECK(readFile(m_persistFile).find("journal_value") !=
+        std::string::npos);
+  sub = {};
+  inst.StopServer();
+  wpi::nt::NetworkTableInstance::Destroy(inst);
+}
@@ -0,0 +1,67 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "net/ClientMessageQueue.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "net/Message.hpp"
+#include "wpi/nt/NetworkTableValue.hpp"
+#include "wpi/util/Logger.hpp"
+
+namespace wpi::nt::net {
+
+TEST_CASE("ClientMessageQueue wakeup", "[ClientMessageQueue]") {
+  wpi::util::Logger logger;
+  LocalClientMessageQueue queue{logger};
+  int wakeups = 0;
+  ClientMessage msgs[4];
+
+  SECTION("burst wakes once") {
+    queue.SetWakeup([&] { ++wakeups; });
+    queue.ClientSetValue(1, Value::MakeInteger(1));
+    queue.ClientSetValue(1, Value::MakeInteger(2));
+    queue.ClientUnpublish(1);
+    CHECK(wakeups == 1);
+  }
+
+  SECTION("wakes again after queue emptied") {
+    queue.SetWakeup([&] { ++wakeups; });
+    queue.ClientSetValue(1, Value::MakeInteger(1));
+    CHECK(queue.ReadQueue(msgs).size() == 1);
+    queue.ClientSetValue(1, Value::MakeInteger(2));
+    CHECK(wakeups == 2);
+  }
+
+  SECTION("partial read does not rearm") {
+    queue.SetWakeup([&] { ++wakeups; });
+    for (int i = 0; i < 5; ++i) {
+      queue.ClientSetValue(1, Value::MakeInteger(i));
+    }
+    CHECK(queue.ReadQueue(msgs).size() == 4);
+    queue.ClientSetValue(1, Value::MakeInteger(5));
+    CHECK(wakeups == 1);
+    CHECK(queue.ReadQueue(msgs).size() == 2);
+    queue.ClientSetValue(1, Value::MakeInteger(6));
+    CHECK(wakeups == 2);
+  }
+
+  SECTION("wakes again after clear") {
+    queue.SetWakeup([&] { ++wakeups; });
+    queue.ClientSetValue(1, Value::MakeInteger(1));
+    queue.ClearQueue();
+    queue.ClientSetValue(1, Value::MakeInteger(2));
+    CHECK(wakeups == 2);
+  }
+
+  SECTION("set with pending messages wakes immediately") {
+    queue.ClientSetValue(1, Value::MakeInteger(1));
+    queue.SetWakeup([&] { ++wakeups; });
+    CHECK(wakeups == 1);
+    queue.ClientSetValue(1, Value::MakeInteger(2));
+    CHECK(wakeups == 1);
+  }
+}
+
+}  // namespace wpi::nt::net
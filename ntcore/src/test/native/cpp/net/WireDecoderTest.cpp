@@ -279,4 +279,109 @@ TEST_CASE_METHOD(WireDecodeTextClientTest,
   CheckNoClientCalls(handler);
 }
 
+TEST_CASE_METHOD(WireDecodeTextClientTest,
+                 "WireDecodeTextClientTest ParamsBeforeMethod",
+                 "[ntcore][wire][decoder]") {
+  net::WireDecodeText(
+      "[{\"params\":{\"type\":\"double\",\"pubuid\":5,\"name\":\"test\"},"
+      "\"method\":\"publish\"}]",
+      handler, logger);
+  logger.CheckMessages({});
+  CheckClientMessageCounts(handler, {.publish = 1});
+  CheckPublish(handler.publishCalls[0], 5, "test", "double",
+               wpi::util::json::object());
+}
+
+TEST_CASE_METHOD(WireDecodeTextClientTest,
+                 "WireDecodeTextClientTest EscapedName",
+                 "[ntcore][wire][decoder]") {
+  net::WireDecodeText(
+      "[{\"method\":\"publish\",\"params\":{"
+      "\"name\":\"a\\\"b\\u00e9\\/c\",\"pubuid\":5,\"type\":\"double\"}}]",
+      handler, logger);
+  logger.CheckMessages({});
+  CheckClientMessageCounts(handler, {.publish = 1});
+  CheckPublish(handler.publishCalls[0], 5, "a\"b\xc3\xa9/c", "double",
+               wpi::util::json::object());
+}
+
+TEST_CASE_METHOD(WireDecodeTextClientTest,
+                 "WireDecodeTextClientTest DuplicateKeyFirstWins",
+                 "[ntcore][wire][decoder]") {
+  net::WireDecodeText(
+      "[{\"method\":\"unpublish\",\"method\":\"publish\","
+      "\"params\":{\"pubuid\":5,\"pubuid\":6}}]",
+      handler, logger);
+  logger.CheckMessages({});
+  CheckClientMessageCounts(handler, {.unpublish = 1});
+  CHECK(handler.unpublishCalls[0] == 5);
+}
+
+TEST_CASE_METHOD(WireDecodeTextClientTest,
+                 "WireDecodeTextClientTest ErrorAfterValidMessage",
+                 "[ntcore][wire][decoder]") {
+  net::WireDecodeText(
+      "[{\"method\":\"unpublish\",\"params\":{\"pubuid\":5}},{\"method\":",
+      handler, logger);
+  logger.CheckMessage(NT_LOG_WARNING,
+                      "could not decode JSON message: unexpected_eof"sv);
+  CheckNoClientCalls(handler);
+}
+
+TEST_CASE_METHOD(WireDecodeTextClientTest,
+                 "WireDecodeTextClientTest Subscribe",
+                 "[ntcore][wire][decoder]") {
+  net::WireDecodeText(
+      "[{\"method\":\"subscribe\",\"params\":{\"subuid\":3,"
+      "\"topics\":[\"a\",\"b\\n\"],\"options\":{\"periodic\":0.5,"
+      "\"all\":true,\"prefix\":true,\"unknown\":[{}]}}}]",
+      handler, logger);
+  logger.CheckMessages({});
+  CheckClientMessageCounts(handler, {.subscribe = 1});
+  auto& call = handler.subscribeCalls[0];
+  CHECK(call.subuid == 3);
+  CHECK(call.prefixes == std::vector<std::string>{"a", "b\n"});
+  CHECK(call.options.periodicMs == 500u);
+  CHECK(call.options.sendAll);
+  CHECK(call.options.prefixMatch);
+}
+
+TEST_CASE_METHOD(WireDecodeTextClientTest,
+                 "WireDecodeTextClientTest SubscribeTopicsError",
+                 "[ntcore][wire][decoder]") {
+  net::WireDecodeText(
+      "[{\"method\":\"subscribe\",\"params\":{\"subuid\":3,"
+      "\"topics\":[\"a\",5]}}]",
+      handler, logger);
+  logger.CheckMessage(NT_LOG_WARNING, "0: topics/1 must be a string"sv);
+  CheckNoClientCalls(handler);
+}
+
+TEST_CASE_METHOD(WireDecodeTextServerTest,
+                 "WireDecodeTextServerTest Announce",
+                 "[ntcore][wire][decoder]") {
+  net::WireDecodeText(
+      "[{\"method\":\"announce\",\"params\":{\"name\":\"test\",\"id\":4,"
+      "\"type\":\"double\",\"pubuid\":7,\"properties\":{\"k\":[1,2]}}},"
+      "{\"method\":\"unannounce\",\"params\":{\"name\":\"old\",\"id\":3}},"
+      "{\"method\":\"properties\",\"params\":{\"name\":\"test\","
+      "\"update\":{\"k\":null},\"ack\":true}}]",
+      handler, logger);
+  logger.CheckMessages({});
+  CheckServerMessageCounts(handler, {.announce = 1,
+                                     .unannounce = 1,
+                                     .propertiesUpdate = 1});
+  auto& announce = handler.announceCalls[0];
+  CHECK(announce.name == "test");
+  CHECK(announce.id == 4);
+  CHECK(announce.typeStr == "double");
+  CHECK(announce.pubuid == 7);
+  CHECK(announce.properties ==
+        wpi::util::json::object("k", wpi::util::json::array(1, 2)));
+  CHECK(handler.unannounceCalls[0].name == "old");
+  CHECK(handler.unannounceCalls[0].id == 3);
+  CHECK(handler.propertiesUpdateCalls[0].name == "test");
+  CHECK(handler.propertiesUpdateCalls[0].ack);
+}
+
 }  // namespace wpi::nt
@@ -0,0 +1,165 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/halsim/ws_core/WSMessageBatcher.hpp"
+
+#include <mutex>
+#include <utility>
+
+#include "wpi/util/MessagePack.hpp"
+#include "wpi/util/SmallString.hpp"
+#include "wpi/util/raw_ostream.hpp"
+
+using namespace wpilibws;
+using namespace mpack;
+
+namespace {
+
+// mpack writer that flushes into a raw_ostream
+struct Writer : public mpack_writer_t {
+  explicit Writer(wpi::util::raw_ostream& os) {
+    mpack_writer_init(this, buf, sizeof(buf));
+    mpack_writer_set_context(this, &os);
+    mpack_writer_set_flush(
+        this, [](mpack_writer_t* w, const char* buffer, size_t count) {
+          static_cast<wpi::util::raw_ostream*>(w->context)
+              ->write(buffer, count);
+        });
+  }
+
+  char buf[256];
+};
+
+}  // namespace
+
+static void WriteValue(mpack_writer_t* w, const wpi::util::json& value) {
+  using Type = wpi::util::json::Type;
+  switch (value.type()) {
+    case Type::Null:
+      mpack_write_nil(w);
+      break;
+    case Type::Bool:
+      mpack_write_bool(w, value.get_bool());
+      break;
+    case Type::Int:
+      mpack_write_i64(w, value.get_int());
+      break;
+    case Type::Uint:
+      mpack_write_u64(w, value.get_uint());
+      break;
+    case Type::Float:
+      mpack_write_float(w, value.get_float());
+      break;
+    case Type::Double:
+      mpack_write_double(w, value.get_double());
+      break;
+    case Type::String:
+      mpack_write_str(w, value.get_string());
+      break;
+    case Type::Array: {
+      auto& arr = value.get_array();
+      mpack_start_array(w, arr.size());
+      for (auto&& elem : arr) {
+        WriteValue(w, elem);
+      }
+      mpack_finish_array(w);
+      break;
+    }
+    case Type::Object: {
+      auto& obj = value.get_object();
+      mpack_start_map(w, obj.size());
+      for (auto&& [key, elem] : obj) {
+        mpack_write_str(w, key);
+        WriteValue(w, elem);
+      }
+      mpack_finish_map(w);
+      break;
+    }
+  }
+}
+
+std::optional<HALSimWSMessageBatcher::Format>
+HALSimWSMessageBatcher::ParseFormat(std::string_view name) {
+  if (name == "json" || name == "1") {
+    return kJson;
+  } else if (name == "msgpack") {
+    return kMsgPack;
+  } else {
+    return std::nullopt;
+  }
+}
+
+void HALSimWSMessageBatcher::Add(const wpi::util::json& msg) {
+  auto type = msg.lookup("type");
+  auto device = msg.lookup("device");
+  auto data = msg.lookup("data");
+  if (!type || !type->is_string() || !device || !device->is_string() ||
+      !data || !data->is_object()) {
+    return;
+  }
+
+  wpi::util::SmallString<64> key;
+  key.append(type->get_string());
+  key.append("/");
+  key.append(device->get_string());
+
+  std::scoped_lock lock{m_mutex};
+  auto [it, isNew] = m_index.try_emplace(key.str(), m_pending.size());
+  if (isNew) {
+    m_pending.emplace_back(type->get_string(), device->get_string(), *data);
+    return;
+  }
+  auto& pending = m_pending[it->second].data;
+  for (auto&& [name, value] : data->get_object()) {
+    pending[name] = value;
+  }
+}
+
+bool HALSimWSMessageBatcher::Flush(wpi::util::raw_ostream& os, Format format) {
+  std::vector<Pending> batch;
+  {
+    std::scoped_lock lock{m_mutex};
+    if (m_pending.empty()) {
+      return false;
+    }
+    batch.swap(m_pending);
+    m_index.clear();
+  }
+
+  if (format == kMsgPack) {
+    Writer w{os};
+    mpack_start_array(&w, batch.size());
+    for (auto&& msg : batch) {
+      mpack_start_map(&w, 3);
+      mpack_write_str(&w, "type");
+      mpack_write_str(&w, msg.type);
+      mpack_write_str(&w, "device");
+      mpack_write_str(&w, msg.device);
+      mpack_write_str(&w, "data");
+      WriteValue(&w, msg.data);
+      mpack_finish_map(&w);
+    }
+    mpack_finish_array(&w);
+    mpack_writer_destroy(&w);
+    return true;
+  }
+
+  os << '[';
+  bool first = true;
+  for (auto&& msg : batch) {
+    if (!first) {
+      os << ',';
+    }
+    first = false;
+    os << "{\"type\":";
+    wpi::util::json::stringify_string(os, msg.type);
+    os << ",\"device\":";
+    wpi::util::json::stringify_string(os, msg.device);
+    os << ",\"data\":";
+    msg.data.marshal(os);
+    os << '}';
+  }
+  os << ']';
+  return true;
+}
@@ -14,6 +14,9 @@ class HALSimBaseWebSocketConnection {
  public:
   virtual void OnSimValueChanged(const wpi::util::json& msg) = 0;
 
+  // Sends any batched sim values; only used when batching is enabled
+  virtual void FlushSimValues() {}
+
  protected:
   virtual ~HALSimBaseWebSocketConnection() = default;
 };
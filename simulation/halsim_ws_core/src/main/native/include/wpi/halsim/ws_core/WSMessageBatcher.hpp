@@ -0,0 +1,59 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "wpi/util/StringMap.hpp"
+#include "wpi/util/json.hpp"
+#include "wpi/util/mutex.hpp"
+
+namespace wpi::util {
+class raw_ostream;
+}  // namespace wpi::util
+
+namespace wpilibws {
+
+// Coalesces sim -> network messages per device until the next flush, so that
+// many HAL callbacks in one tick go out as a single websocket frame.
+class HALSimWSMessageBatcher {
+ public:
+  enum Format {
+    // text frame containing a JSON array of messages
+    kJson,
+    // binary frame containing a MessagePack array of messages
+    kMsgPack
+  };
+
+  // Parses a format name ("json" or "msgpack"); "1" is treated as "json"
+  static std::optional<Format> ParseFormat(std::string_view name);
+
+  // Adds a {"type", "device", "data"} message. Its data fields are merged
+  // into any pending message for the same device, replacing older values.
+  // Callable from any thread.
+  void Add(const wpi::util::json& msg);
+
+  // Writes all pending messages as one frame payload and clears them.
+  // Returns false (and writes nothing) if nothing is pending.
+  // Callable from any thread.
+  bool Flush(wpi::util::raw_ostream& os, Format format);
+
+ private:
+  struct Pending {
+    std::string type;
+    std::string device;
+    wpi::util::json data;
+  };
+
+  wpi::util::mutex m_mutex;
+  // "type/device" -> index into m_pending
+  wpi::util::StringMap<size_t> m_index;
+  std::vector<Pending> m_pending;
+};
+
+}  // namespace wpilibws
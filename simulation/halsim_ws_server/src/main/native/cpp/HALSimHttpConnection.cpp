@@ -8,6 +8,7 @@
 #include <format>
 #include <string>
 #include <string_view>
+#include <utility>
 
 #include <llhttp.h>
 #include <uv.h>
@@ -85,6 +86,12 @@ void HALSimHttpConnection::OnSimValueChanged(const wpi::util::json& msg) {
     wpi::util::print(stderr, "Error with message: {}\n", e.what());
   }
 
+  if (m_server->GetBatchFormat()) {
+    // sent on the next batch timer tick
+    m_batcher.Add(msg);
+    return;
+  }
+
   // render json to buffers
   wpi::util::SmallVector<uv::Buffer, 4> sendBufs;
   wpi::net::raw_uv_ostream os{sendBufs, [this]() -> uv::Buffer {
@@ -94,22 +101,48 @@ void HALSimHttpConnection::OnSimValueChanged(const wpi::util::json& msg) {
   os << msg;
 
   // call the websocket send function on the uv loop
-  m_server->GetExec().Send([self = shared_from_this(), sendBufs] {
-    self->m_websocket->SendText(sendBufs,
-                                [self](auto bufs, wpi::net::uv::Error err) {
-                                  {
-                                    std::lock_guard lock(self->m_buffers_mutex);
-                                    self->m_buffers.Release(bufs);
-                                  }
-
-                                  if (err) {
-                                    wpi::util::print(stderr, "{}\n", err.str());
-                                    std::fflush(stderr);
-                                  }
-                                });
+  m_server->GetExec().Send([self = shared_from_this(), sendBufs]() mutable {
+    self->SendBuffers(sendBufs, false);
   });
 }
 
+void HALSimHttpConnection::FlushSimValues() {
+  auto format = m_server->GetBatchFormat();
+  if (!format || !m_isWsConnected) {
+    return;
+  }
+
+  wpi::util::SmallVector<uv::Buffer, 4> sendBufs;
+  wpi::net::raw_uv_ostream os{sendBufs, [this]() -> uv::Buffer {
+                                std::lock_guard lock(m_buffers_mutex);
+                                return m_buffers.Allocate();
+                              }};
+  if (m_batcher.Flush(os, *format)) {
+    SendBuffers(os.bufs(), *format == HALSimWSMessageBatcher::kMsgPack);
+  }
+}
+
+void HALSimHttpConnection::SendBuffers(std::span<uv::Buffer> bufs,
+                                       bool binary) {
+  auto callback = [self = shared_from_this()](auto bufs,
+                                              wpi::net::uv::Error err) {
+    {
+      std::lock_guard lock(self->m_buffers_mutex);
+      self->m_buffers.Release(bufs);
+    }
+
+    if (err) {
+      wpi::util::print(stderr, "{}\n", err.str());
+      std::fflush(stderr);
+    }
+  };
+  if (binary) {
+    m_websocket->SendBinary(bufs, std::move(callback));
+  } else {
+    m_websocket->SendText(bufs, std::move(callback));
+  }
+}
+
 void HALSimHttpConnection::SendFileResponse(int code, std::string_view codeText,
                                             std::string_view contentType,
                                             std::string_view filename,
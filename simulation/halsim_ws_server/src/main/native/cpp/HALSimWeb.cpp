@@ -12,6 +12,7 @@
 #include "wpi/net/raw_uv_ostream.hpp"
 #include "wpi/net/uv/Loop.hpp"
 #include "wpi/net/uv/Tcp.hpp"
+#include "wpi/net/uv/Timer.hpp"
 #include "wpi/util/SmallString.hpp"
 #include "wpi/util/StringExtras.hpp"
 #include "wpi/util/fs.hpp"
@@ -90,6 +91,29 @@ bool HALSimWeb::Initialize() {
     m_useMsgFiltering = false;
   }
 
+  const char* batch = std::getenv("HALSIMWS_BATCH");
+  if (batch != nullptr) {
+    m_batchFormat = HALSimWSMessageBatcher::ParseFormat(batch);
+    if (!m_batchFormat) {
+      wpi::util::print(stderr,
+                       "Error decoding HALSIMWS_BATCH ({}), expected json or "
+                       "msgpack\n",
+                       batch);
+      return false;
+    }
+  }
+
+  const char* batchPeriod = std::getenv("HALSIMWS_BATCH_PERIOD");
+  if (batchPeriod != nullptr) {
+    auto period = wpi::util::parse_integer<uint64_t>(batchPeriod, 10);
+    if (!period || *period == 0) {
+      wpi::util::print(stderr, "Error decoding HALSIMWS_BATCH_PERIOD ({})\n",
+                       batchPeriod);
+      return false;
+    }
+    m_batchPeriod = wpi::net::uv::Timer::Time{*period};
+  }
+
   return true;
 }
 
@@ -123,6 +147,24 @@ void HALSimWeb::Start() {
   } else {
     wpi::util::print("No WS Message Filters specified");
   }
+
+  // flush coalesced sim values once per batch period
+  if (m_batchFormat) {
+    wpi::util::print("WS batching: {}, every {} ms\n",
+                     *m_batchFormat == HALSimWSMessageBatcher::kMsgPack
+                         ? "msgpack"
+                         : "json",
+                     m_batchPeriod.count());
+    m_batchTimer = uv::Timer::Create(m_loop);
+    if (m_batchTimer) {
+      m_batchTimer->timeout.connect([this] {
+        if (auto hws = m_hws.lock()) {
+          hws->FlushSimValues();
+        }
+      });
+      m_batchTimer->Start(m_batchPeriod, m_batchPeriod);
+    }
+  }
 }
 
 bool HALSimWeb::RegisterWebsocket(
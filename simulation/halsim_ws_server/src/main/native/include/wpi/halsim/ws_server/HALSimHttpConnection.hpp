@@ -5,10 +5,12 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include <string_view>
 #include <utility>
 
 #include "wpi/halsim/ws_core/HALSimBaseWebSocketConnection.hpp"
+#include "wpi/halsim/ws_core/WSMessageBatcher.hpp"
 #include "wpi/halsim/ws_server/HALSimWeb.hpp"
 #include "wpi/net/HttpWebSocketServerConnection.hpp"
 #include "wpi/net/uv/Buffer.hpp"
@@ -34,6 +36,9 @@ class HALSimHttpConnection
   // callable from any thread
   void OnSimValueChanged(const wpi::util::json& msg) override;
 
+  // must be called from the uv loop
+  void FlushSimValues() override;
+
  protected:
   void ProcessRequest() override;
   bool IsValidWsUpgrade(std::string_view protocol) override;
@@ -45,6 +50,9 @@ class HALSimHttpConnection
   void MySendError(int code, std::string_view message);
   void Log(int code);
 
+  // must be called from the uv loop
+  void SendBuffers(std::span<wpi::net::uv::Buffer> bufs, bool binary);
+
  private:
   std::shared_ptr<HALSimWeb> m_server;
 
@@ -54,6 +62,9 @@ class HALSimHttpConnection
   // these are only valid if the websocket is connected
   wpi::net::uv::SimpleBufferPool<4> m_buffers;
   std::mutex m_buffers_mutex;
+
+  // pending sim values, if batching is enabled
+  HALSimWSMessageBatcher m_batcher;
 };
 
 }  // namespace wpilibws
@@ -6,15 +6,18 @@
 
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 
 #include "wpi/halsim/ws_core/HALSimBaseWebSocketConnection.hpp"
+#include "wpi/halsim/ws_core/WSMessageBatcher.hpp"
 #include "wpi/halsim/ws_core/WSProviderContainer.hpp"
 #include "wpi/halsim/ws_core/WSProvider_SimDevice.hpp"
 #include "wpi/net/uv/Async.hpp"
 #include "wpi/net/uv/Loop.hpp"
 #include "wpi/net/uv/Tcp.hpp"
+#include "wpi/net/uv/Timer.hpp"
 #include "wpi/util/StringMap.hpp"
 
 namespace wpi::util {
@@ -45,6 +48,11 @@ class HALSimWeb : public std::enable_shared_from_this<HALSimWeb> {
 
   bool CanSendMessage(std::string_view type);
 
+  // set if sim values should be coalesced and sent once per batch period
+  std::optional<HALSimWSMessageBatcher::Format> GetBatchFormat() const {
+    return m_batchFormat;
+  }
+
   const std::string& GetWebrootSys() const { return m_webroot_sys; }
   const std::string& GetWebrootUser() const { return m_webroot_user; }
   const std::string& GetServerUri() const { return m_uri; }
@@ -60,6 +68,7 @@ class HALSimWeb : public std::enable_shared_from_this<HALSimWeb> {
   wpi::net::uv::Loop& m_loop;
   std::shared_ptr<wpi::net::uv::Tcp> m_server;
   std::shared_ptr<UvExecFunc> m_exec;
+  std::shared_ptr<wpi::net::uv::Timer> m_batchTimer;
 
   // list of providers
   ProviderContainer& m_providers;
@@ -76,6 +85,9 @@ class HALSimWeb : public std::enable_shared_from_this<HALSimWeb> {
 
   bool m_useMsgFiltering;
   wpi::util::StringMap<bool> m_msgFilters;
+
+  std::optional<HALSimWSMessageBatcher::Format> m_batchFormat;
+  wpi::net::uv::Timer::Time m_batchPeriod{20};
 };
 
 }  // namespace wpilibws
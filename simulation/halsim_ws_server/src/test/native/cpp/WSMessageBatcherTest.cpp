@@ -0,0 +1,82 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/halsim/ws_core/WSMessageBatcher.hpp"
+
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "wpi/util/MessagePack.hpp"
+#include "wpi/util/json.hpp"
+#include "wpi/util/raw_ostream.hpp"
+
+using namespace wpilibws;
+
+static wpi::util::json MakeMsg(std::string_view type, std::string_view device,
+                               wpi::util::json data) {
+  return wpi::util::json::object("type", type, "device", device, "data",
+                                 std::move(data));
+}
+
+TEST_CASE("WSMessageBatcherTest CoalescesPerDevice", "[halsim_ws]") {
+  HALSimWSMessageBatcher batcher;
+  batcher.Add(MakeMsg("PWM", "0", wpi::util::json::object("<raw", 1000)));
+  batcher.Add(MakeMsg("DIO", "3", wpi::util::json::object("<>value", true)));
+  batcher.Add(MakeMsg("PWM", "0", wpi::util::json::object("<raw", 1500)));
+  batcher.Add(MakeMsg("PWM", "0", wpi::util::json::object("<init", true)));
+
+  std::string out;
+  wpi::util::raw_string_ostream os{out};
+  REQUIRE(batcher.Flush(os, HALSimWSMessageBatcher::kJson));
+  os.flush();
+
+  auto j = wpi::util::json::parse_or_throw(out);
+  REQUIRE(j.is_array());
+  REQUIRE(j.get_array().size() == 2u);
+  CHECK(j[0] == MakeMsg("PWM", "0",
+                        wpi::util::json::object("<raw", 1500, "<init", true)));
+  CHECK(j[1] == MakeMsg("DIO", "3", wpi::util::json::object("<>value", true)));
+
+  // nothing pending after a flush
+  CHECK_FALSE(batcher.Flush(os, HALSimWSMessageBatcher::kJson));
+}
+
+TEST_CASE("WSMessageBatcherTest MsgPack", "[halsim_ws]") {
+  HALSimWSMessageBatcher batcher;
+  batcher.Add(MakeMsg("PWM", "1", wpi::util::json::object("<raw", 1500)));
+
+  std::vector<uint8_t> out;
+  wpi::util::raw_uvector_ostream os{out};
+  REQUIRE(batcher.Flush(os, HALSimWSMessageBatcher::kMsgPack));
+
+  mpack::mpack_reader_t reader;
+  mpack::mpack_reader_init_data(&reader, out);
+  CHECK(mpack::mpack_expect_array(&reader) == 1u);
+  CHECK(mpack::mpack_expect_map(&reader) == 3u);
+  std::string str;
+  mpack::mpack_expect_str(&reader, &str);
+  CHECK(str == "type");
+  mpack::mpack_expect_str(&reader, &str);
+  CHECK(str == "PWM");
+  mpack::mpack_expect_str(&reader, &str);
+  CHECK(str == "device");
+  mpack::mpack_expect_str(&reader, &str);
+  CHECK(str == "1");
+  mpack::mpack_expect_str(&reader, &str);
+  CHECK(str == "data");
+  CHECK(mpack::mpack_expect_map(&reader) == 1u);
+  mpack::mpack_expect_str(&reader, &str);
+  CHECK(str == "<raw");
+  CHECK(mpack::mpack_expect_i64(&reader) == 1500);
+  mpack::mpack_done_map(&reader);
+  mpack::mpack_done_map(&reader);
+  mpack::mpack_done_array(&reader);
+  CHECK(mpack::mpack_reader_destroy(&reader) == mpack::mpack_ok);
+}
@@ -0,0 +1,703 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/telemetry/AsyncTelemetryBackend.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "wpi/telemetry/TelemetryEntry.hpp"
+#include "wpi/telemetry/TelemetryTime.hpp"
+#include "wpi/util/timestamp.hpp"
+
+using namespace wpi;
+using namespace wpi::telemetry;
+
+namespace {
+
+enum class RecordType : uint32_t {
+  kPadding,
+  kBoolean,
+  kInt8,
+  kInt16,
+  kInt32,
+  kInt64,
+  kFloat,
+  kDouble,
+  kString,
+  kBooleanArray,
+  kBooleanIntArray,
+  kInt16Array,
+  kInt32Array,
+  kInt64Array,
+  kFloatArray,
+  kDoubleArray,
+  kStringArray,
+  kRaw,
+};
+
+constexpr size_t kRecordAlign = 8;
+
+// Every record starts with a header and is padded to a multiple of
+// kRecordAlign. The space left at the end of the buffer may be smaller than a
+// header, so padding records are only a RecordPrefix.
+//
+// Payload layouts:
+// - scalars: the value
+// - string/raw: uint32 value size, uint32 type string size, value, type string
+// - arrays: uint32 count, 4 bytes padding, elements
+// - string arrays: uint32 count, 4 bytes padding, uint32 sizes[count], chars
+struct RecordPrefix {
+  uint32_t size;
+  RecordType type;
+};
+
+struct alignas(kRecordAlign) RecordHeader {
+  RecordPrefix prefix;
+  // time the value was logged at, for GetLogTime()
+  int64_t time;
+  void* entry;
+};
+
+static_assert(sizeof(RecordPrefix) == kRecordAlign);
+static_assert(sizeof(RecordHeader) % kRecordAlign == 0);
+
+constexpr size_t kArrayHeaderSize = 8;
+
+uint64_t NextBackendId() {
+  static std::atomic<uint64_t> nextId{1};
+  return nextId++;
+}
+
+void PutSize(uint8_t* dest, size_t size) {
+  uint32_t size32 = size;
+  std::memcpy(dest, &size32, sizeof(size32));
+}
+
+uint32_t GetSize(const uint8_t* src) {
+  uint32_t size;
+  std::memcpy(&size, src, sizeof(size));
+  return size;
+}
+
+}  // namespace
+
+class AsyncTelemetryBackend::Buffer {
+ public:
+  Buffer(std::thread::id owner, size_t size)
+      : owner{owner},
+        m_data{std::make_unique<Block[]>(size / kRecordAlign)},
+        m_mask{size - 1} {}
+
+  size_t Size() const { return m_mask + 1; }
+
+  size_t Usage() const {
+    // on the consumer side, the tail can be past the head; see Restart()
+    size_t head = m_head.load(std::memory_order_acquire);
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    return head > tail ? head - tail : 0;
+  }
+
+  // Producer side. Returns false if the record was dropped. The fill function
+  // is called with a pointer to payloadSize bytes.
+  template <typename F>
+  bool Write(void* entry, RecordType type, size_t payloadSize, F&& fill) {
+    // keep the time of values forwarded from another AsyncTelemetryBackend
+    int64_t time = GetLogTime();
+    if (time == 0) {
+      time = wpi::util::Now();
+    }
+
+    size_t recordSize =
+        (sizeof(RecordHeader) + payloadSize + kRecordAlign - 1) &
+        ~(kRecordAlign - 1);
+    size_t head = m_head.load(std::memory_order_relaxed);
+    size_t pos = head & m_mask;
+    // records don't wrap; one that doesn't fit before the end of the buffer
+    // starts at the beginning, after a padding record
+    size_t padding = 0;
+    if (Size() - pos < recordSize) {
+      padding = Size() - pos;
+    }
+    if (padding + recordSize > Size() - (head - m_cachedTail)) {
+      m_cachedTail = m_tail.load(std::memory_order_acquire);
+      if (padding + recordSize > Size() - (head - m_cachedTail)) {
+        if (!Restart(&head, recordSize)) {
+          m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+          return false;
+        }
+        pos = 0;
+        padding = 0;
+      }
+    }
+
+    if (padding != 0) {
+      RecordPrefix prefix{static_cast<uint32_t>(padding),
+                          RecordType::kPadding};
+      std::memcpy(Data(pos), &prefix, sizeof(prefix));
+      pos = 0;
+    }
+    RecordHeader header{{static_cast<uint32_t>(recordSize), type}, time, entry};
+    std::memcpy(Data(pos), &header, sizeof(header));
+    fill(Data(pos) + sizeof(header));
+    m_queued.store(m_queued.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+    m_head.store(head + padding + recordSize, std::memory_order_release);
+    return true;
+  }
+
+  // Position after the last record published by the producer
+  size_t GetHead() const { return m_head.load(std::memory_order_acquire); }
+
+  // Consumer side. Returns true if every record before pos has been read.
+  bool IsDrainedTo(size_t pos) const {
+    return m_tail.load(std::memory_order_relaxed) >= pos;
+  }
+
+  bool ShouldWake() {
+    return Usage() > Size() / 2 &&
+           !m_wakeRequested.exchange(true, std::memory_order_relaxed);
+  }
+
+  // Consumer side. Calls func(header, payload) for each record.
+  template <typename F>
+  void Read(F&& func) {
+    m_wakeRequested.store(false, std::memory_order_relaxed);
+    // the head is read first, as Restart() can move the tail of an empty
+    // buffer past it until the record after the restart is published
+    size_t head = m_head.load(std::memory_order_acquire);
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    while (tail < head) {
+      const uint8_t* record = Data(tail & m_mask);
+      RecordPrefix prefix;
+      std::memcpy(&prefix, record, sizeof(prefix));
+      if (prefix.type != RecordType::kPadding) {
+        RecordHeader header;
+        std::memcpy(&header, record, sizeof(header));
+        func(header, record + sizeof(header));
+      }
+      tail += prefix.size;
+      m_tail.store(tail, std::memory_order_release);
+    }
+  }
+
+  uint64_t GetQueued() const {
+    return m_queued.load(std::memory_order_relaxed);
+  }
+
+  uint64_t GetDropped() const {
+    return m_dropped.load(std::memory_order_relaxed);
+  }
+
+  const std::thread::id owner;
+
+ private:
+  struct alignas(kRecordAlign) Block {
+    uint8_t data[kRecordAlign];
+  };
+
+  // Producer side. If the buffer is empty, moves the tail to the next start
+  // of the buffer so a record up to Size() bytes fits without padding. The
+  // consumer only writes the tail while there are records to read, so it
+  // can't be writing it while the buffer is empty.
+  bool Restart(size_t* head, size_t recordSize) {
+    if (recordSize > Size() || m_cachedTail != *head) {
+      return false;
+    }
+    size_t start = (*head + m_mask) & ~m_mask;
+    m_tail.store(start, std::memory_order_relaxed);
+    m_cachedTail = start;
+    *head = start;
+    return true;
+  }
+
+  uint8_t* Data(size_t pos) {
+    return reinterpret_cast<uint8_t*>(m_data.get()) + pos;
+  }
+
+  std::unique_ptr<Block[]> m_data;
+  size_t m_mask;
+
+  // written by the producer
+  alignas(64) std::atomic<size_t> m_head{0};
+  size_t m_cachedTail = 0;
+  std::atomic<uint64_t> m_queued{0};
+  std::atomic<uint64_t> m_dropped{0};
+
+  // written by the consumer, and by Restart() while the buffer is empty
+  alignas(64) std::atomic<size_t> m_tail{0};
+  std::atomic_bool m_wakeRequested{false};
+};
+
+class AsyncTelemetryBackend::Entry : public TelemetryEntry {
+ public:
+  Entry(AsyncTelemetryBackend& backend, std::shared_ptr<TelemetryEntry> entry)
+      : m_backend{backend}, m_entry{std::move(entry)} {}
+
+  TelemetryEntry& GetEntry() const { return *m_entry; }
+
+  void MarkRemoved() { m_removed.store(true); }
+
+  bool IsRemoved() const { return m_removed.load(std::memory_order_relaxed); }
+
+  bool IsDiscard() const override {
+    return m_removed.load() || m_entry->IsDiscard();
+  }
+
+  void KeepDuplicates() override {
+    if (!m_removed.load()) {
+      m_entry->KeepDuplicates();
+    }
+  }
+
+  void SetProperty(std::string_view key, std::string_view value) override {
+    if (!m_removed.load()) {
+      m_entry->SetProperty(key, value);
+    }
+  }
+
+  void LogBoolean(bool value) override {
+    LogScalar(RecordType::kBoolean, value);
+  }
+
+  void LogInt8(int8_t value) override { LogScalar(RecordType::kInt8, value); }
+
+  void LogInt16(int16_t value) override {
+    LogScalar(RecordType::kInt16, value);
+  }
+
+  void LogInt32(int32_t value) override {
+    LogScalar(RecordType::kInt32, value);
+  }
+
+  void LogInt64(int64_t value) override {
+    LogScalar(RecordType::kInt64, value);
+  }
+
+  void LogFloat(float value) override { LogScalar(RecordType::kFloat, value); }
+
+  void LogDouble(double value) override {
+    LogScalar(RecordType::kDouble, value);
+  }
+
+  void LogString(std::string_view value, std::string_view typeString) override {
+    LogBytes(RecordType::kString, value.data(), value.size(), typeString);
+  }
+
+  void LogBooleanArray(std::span<const bool> value) override {
+    LogArray(RecordType::kBooleanArray, value);
+  }
+
+  void LogBooleanArray(std::span<const int> value) override {
+    LogArray(RecordType::kBooleanIntArray, value);
+  }
+
+  void LogInt16Array(std::span<const int16_t> value) override {
+    LogArray(RecordType::kInt16Array, value);
+  }
+
+  void LogInt32Array(std::span<const int32_t> value) override {
+    LogArray(RecordType::kInt32Array, value);
+  }
+
+  void LogInt64Array(std::span<const int64_t> value) override {
+    LogArray(RecordType::kInt64Array, value);
+  }
+
+  void LogFloatArray(std::span<const float> value) override {
+    LogArray(RecordType::kFloatArray, value);
+  }
+
+  void LogDoubleArray(std::span<const double> value) override {
+    LogArray(RecordType::kDoubleArray, value);
+  }
+
+  void LogStringArray(std::span<const std::string> value) override {
+    LogStrings(value);
+  }
+
+  void LogStringArray(std::span<const std::string_view> value) override {
+    LogStrings(value);
+  }
+
+  void LogRaw(std::span<const uint8_t> value,
+              std::string_view typeString) override {
+    LogBytes(RecordType::kRaw, value.data(), value.size(), typeString);
+  }
+
+ private:
+  template <typename F>
+  void Write(RecordType type, size_t payloadSize, F&& fill) {
+    auto& buffer = m_backend.GetBuffer();
+    if (buffer.Write(this, type, payloadSize, fill) && buffer.ShouldWake()) {
+      // set with the lock held, so it can't be missed between the thread
+      // checking it and waiting
+      {
+        std::scoped_lock lock{m_backend.m_mutex};
+        m_backend.m_wakeup = true;
+      }
+      m_backend.m_cond.notify_one();
+    }
+  }
+
+  template <typename T>
+  void LogScalar(RecordType type, T value) {
+    Write(type, sizeof(T),
+          [&](uint8_t* dest) { std::memcpy(dest, &value, sizeof(T)); });
+  }
+
+  void LogBytes(RecordType type, const void* data, size_t size,
+                std::string_view typeString) {
+    Write(type, 8 + size + typeString.size(), [&](uint8_t* dest) {
+      PutSize(dest, size);
+      PutSize(dest + 4, typeString.size());
+      std::memcpy(dest + 8, data, size);
+      std::memcpy(dest + 8 + size, typeString.data(), typeString.size());
+    });
+  }
+
+  template <typename T>
+  void LogArray(RecordType type, std::span<const T> value) {
+    Write(type, kArrayHeaderSize + value.size_bytes(), [&](uint8_t* dest) {
+      PutSize(dest, value.size());
+      std::memcpy(dest + kArrayHeaderSize, value.data(), value.size_bytes());
+    });
+  }
+
+  template <typename T>
+  void LogStrings(std::span<const T> value) {
+    size_t chars = 0;
+    for (auto&& str : value) {
+      chars += str.size();
+    }
+    size_t sizesSize = 4 * value.size();
+    Write(RecordType::kStringArray, kArrayHeaderSize + sizesSize + chars,
+          [&](uint8_t* dest) {
+            PutSize(dest, value.size());
+            uint8_t* sizes = dest + kArrayHeaderSize;
+            uint8_t* out = sizes + sizesSize;
+            for (auto&& str : value) {
+              PutSize(sizes, str.size());
+              sizes += 4;
+              std::memcpy(out, str.data(), str.size());
+              out += str.size();
+            }
+          });
+  }
+
+  AsyncTelemetryBackend& m_backend;
+  std::shared_ptr<TelemetryEntry> m_entry;
+  std::atomic_bool m_removed{false};
+};
+
+AsyncTelemetryBackend::AsyncTelemetryBackend(
+    std::shared_ptr<TelemetryBackend> backend, size_t bufferSize, double period)
+    : m_backend{std::move(backend)},
+      m_bufferSize{std::bit_ceil(std::max<size_t>(bufferSize, 256))},
+      m_period{period},
+      m_id{NextBackendId()} {
+  if (!m_backend) {
+    throw std::invalid_argument{
+        "AsyncTelemetryBackend backend cannot be null"};
+  }
+  m_thread = std::thread{[this] { ThreadMain(); }};
+}
+
+AsyncTelemetryBackend::~AsyncTelemetryBackend() {
+  {
+    std::scoped_lock lock{m_mutex};
+    m_active = false;
+  }
+  m_cond.notify_all();
+  m_thread.join();
+}
+
+std::shared_ptr<TelemetryEntry> AsyncTelemetryBackend::GetEntry(
+    std::string_view path) {
+  std::scoped_lock lock{m_mutex};
+  auto it = m_entries.find(path);
+  if (it != m_entries.end()) {
+    return it->second;
+  }
+  auto entry = std::make_shared<Entry>(*this, m_backend->GetEntry(path));
+  m_entries.try_emplace(path, entry);
+  return entry;
+}
+
+void AsyncTelemetryBackend::RemoveEntry(std::string_view path) {
+  {
+    std::scoped_lock lock{m_mutex};
+    auto it = m_entries.find(path);
+    if (it != m_entries.end()) {
+      auto entry = std::move(it->second);
+      m_entries.erase(it);
+      entry->MarkRemoved();
+      m_removedEntries.emplace_back(std::move(entry));
+    }
+  }
+  m_backend->RemoveEntry(path);
+}
+
+bool AsyncTelemetryBackend::HasSchema(std::string_view schemaName) const {
+  return m_backend->HasSchema(schemaName);
+}
+
+void AsyncTelemetryBackend::AddSchema(std::string_view schemaName,
+                                      std::string_view type,
+                                      std::span<const uint8_t> schema) {
+  m_backend->AddSchema(schemaName, type, schema);
+}
+
+void AsyncTelemetryBackend::AddSchema(std::string_view schemaName,
+                                      std::string_view type,
+                                      std::string_view schema) {
+  m_backend->AddSchema(schemaName, type, schema);
+}
+
+void AsyncTelemetryBackend::Flush() {
+  std::unique_lock lock{m_mutex};
+  uint64_t request = ++m_flushRequested;
+  m_wakeup = true;
+  m_cond.notify_all();
+  m_cond.wait(lock,
+              [&] { return m_flushCompleted >= request || !m_active; });
+}
+
+AsyncTelemetryBackend::Stats AsyncTelemetryBackend::GetStats() const {
+  Stats stats;
+  std::scoped_lock lock{m_mutex};
+  for (auto&& buffer : m_buffers) {
+    stats.queued += buffer->GetQueued();
+    stats.dropped += buffer->GetDropped();
+  }
+  stats.maxBufferUsage = m_maxBufferUsage.load(std::memory_order_relaxed);
+  return stats;
+}
+
+AsyncTelemetryBackend::Buffer& AsyncTelemetryBackend::GetBuffer() {
+  // Backend ids are never reused, so a cached buffer for this id is still
+  // owned by this backend
+  thread_local uint64_t cachedId = 0;
+  thread_local Buffer* cachedBuffer = nullptr;
+  if (cachedId == m_id) {
+    return *cachedBuffer;
+  }
+
+  auto thisThread = std::this_thread::get_id();
+  std::scoped_lock lock{m_mutex};
+  auto it = std::find_if(
+      m_buffers.begin(), m_buffers.end(),
+      [&](auto& buffer) { return buffer->owner == thisThread; });
+  if (it == m_buffers.end()) {
+    it = m_buffers.emplace(m_buffers.end(),
+                           std::make_unique<Buffer>(thisThread, m_bufferSize));
+  }
+  cachedId = m_id;
+  cachedBuffer = it->get();
+  return *cachedBuffer;
+}
+
+void AsyncTelemetryBackend::ThreadMain() {
+  // A removed entry waiting for the records queued for it to be drained
+  struct PendingRelease {
+    std::shared_ptr<Entry> entry;
+    // head of each buffer when the last reference to the entry was dropped
+    std::vector<std::pair<Buffer*, size_t>> heads;
+  };
+
+  std::vector<Buffer*> buffers;
+  std::vector<PendingRelease> pendingReleases;
+  auto period = std::chrono::duration<double>(m_period);
+  std::unique_lock lock{m_mutex};
+  for (;;) {
+    bool active = m_active;
+    if (active) {
+      m_cond.wait_for(lock, period, [&] { return m_wakeup || !m_active; });
+    }
+    m_wakeup = false;
+    uint64_t flushRequest = m_flushRequested;
+
+    buffers.clear();
+    for (auto&& buffer : m_buffers) {
+      buffers.emplace_back(buffer.get());
+    }
+    // Entries that nothing else refers to can't be logged to anymore, but
+    // records queued for them still point to them. The fence pairs with the
+    // release of the last reference, so the heads read after it include
+    // every record logged to the entry; it's released once every buffer has
+    // been drained up to those heads.
+    std::erase_if(m_removedEntries, [&](auto& entry) {
+      if (entry.use_count() != 1) {
+        return false;
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      auto& pending = pendingReleases.emplace_back(std::move(entry));
+      for (auto buffer : buffers) {
+        pending.heads.emplace_back(buffer, buffer->GetHead());
+      }
+      return true;
+    });
+    lock.unlock();
+
+    Drain(buffers);
+    std::erase_if(pendingReleases, [](auto& pending) {
+      return std::all_of(
+          pending.heads.begin(), pending.heads.end(), [](auto& head) {
+            return head.first->IsDrainedTo(head.second);
+          });
+    });
+
+    lock.lock();
+    if (m_flushCompleted < flushRequest) {
+      m_flushCompleted = flushRequest;
+      m_cond.notify_all();
+    }
+    if (!active) {
+      return;
+    }
+  }
+}
+
+void AsyncTelemetryBackend::Drain(std::span<Buffer* const> buffers) {
+  std::vector<std::string_view> strings;
+  for (auto buffer : buffers) {
+    size_t usage = buffer->Usage();
+    size_t maxUsage = m_maxBufferUsage.load(std::memory_order_relaxed);
+    if (usage > maxUsage) {
+      m_maxBufferUsage.store(usage, std::memory_order_relaxed);
+    }
+
+    buffer->Read([&](const RecordHeader& header, const uint8_t* payload) {
+      auto& asyncEntry = *static_cast<Entry*>(header.entry);
+      if (asyncEntry.IsRemoved()) {
+        return;
+      }
+      auto& entry = asyncEntry.GetEntry();
+      auto scalar = [&]<typename T>(T* value) {
+        std::memcpy(value, payload, sizeof(T));
+      };
+      auto array = [&]<typename T>(const T*) {
+        return std::span<const T>{
+            reinterpret_cast<const T*>(payload + kArrayHeaderSize),
+            GetSize(payload)};
+      };
+      auto bytes = [&]<typename T>(const T*) {
+        uint32_t size = GetSize(payload);
+        uint32_t typeSize = GetSize(payload + 4);
+        auto data = reinterpret_cast<const T*>(payload + 8);
+        return std::pair{
+            std::span<const T>{data, size},
+            std::string_view{reinterpret_cast<const char*>(payload + 8 + size),
+                             typeSize}};
+      };
+
+      ScopedLogTime logTime{header.time};
+      switch (header.prefix.type) {
+        case RecordType::kPadding:
+          break;
+        case RecordType::kBoolean: {
+          bool value;
+          scalar(&value);
+          entry.LogBoolean(value);
+          break;
+        }
+        case RecordType::kInt8: {
+          int8_t value;
+          scalar(&value);
+          entry.LogInt8(value);
+          break;
+        }
+        case RecordType::kInt16: {
+          int16_t value;
+          scalar(&value);
+          entry.LogInt16(value);
+          break;
+        }
+        case RecordType::kInt32: {
+          int32_t value;
+          scalar(&value);
+          entry.LogInt32(value);
+          break;
+        }
+        case RecordType::kInt64: {
+          int64_t value;
+          scalar(&value);
+          entry.LogInt64(value);
+          break;
+        }
+        case RecordType::kFloat: {
+          float value;
+          scalar(&value);
+          entry.LogFloat(value);
+          break;
+        }
+        case RecordType::kDouble: {
+          double value;
+          scalar(&value);
+          entry.LogDouble(value);
+          break;
+        }
+        case RecordType::kString: {
+          auto [value, typeString] = bytes(static_cast<const char*>(nullptr));
+          entry.LogString(std::string_view{value.data(), value.size()},
+                          typeString);
+          break;
+        }
+        case RecordType::kBooleanArray:
+          entry.LogBooleanArray(array(static_cast<const bool*>(nullptr)));
+          break;
+        case RecordType::kBooleanIntArray:
+          entry.LogBooleanArray(array(static_cast<const int*>(nullptr)));
+          break;
+        case RecordType::kInt16Array:
+          entry.LogInt16Array(array(static_cast<const int16_t*>(nullptr)));
+          break;
+        case RecordType::kInt32Array:
+          entry.LogInt32Array(array(static_cast<const int32_t*>(nullptr)));
+          break;
+        case RecordType::kInt64Array:
+          entry.LogInt64Array(array(static_cast<const int64_t*>(nullptr)));
+          break;
+        case RecordType::kFloatArray:
+          entry.LogFloatArray(array(static_cast<const float*>(nullptr)));
+          break;
+        case RecordType::kDoubleArray:
+          entry.LogDoubleArray(array(static_cast<const double*>(nullptr)));
+          break;
+        case RecordType::kStringArray: {
+          uint32_t count = GetSize(payload);
+          const uint8_t* sizes = payload + kArrayHeaderSize;
+          auto chars = reinterpret_cast<const char*>(sizes + 4 * count);
+          strings.clear();
+          for (uint32_t i = 0; i < count; ++i) {
+            uint32_t size = GetSize(sizes + 4 * i);
+            strings.emplace_back(chars, size);
+            chars += size;
+          }
+          entry.LogStringArray(std::span<const std::string_view>{strings});
+          break;
+        }
+        case RecordType::kRaw: {
+          auto [value, typeString] =
+              bytes(static_cast<const uint8_t*>(nullptr));
+          entry.LogRaw(value, typeString);
+          break;
+        }
+      }
+    });
+  }
+}
@@ -332,8 +332,8 @@ TelemetryTable::EntryHandle TelemetryTable::GetEntry(std::string_view name,
       lock.unlock();
       continue;
     }
-    EntryHandle entry{name, resetGeneration, std::move(newEntry.entry),
-                      std::move(newEntry.backend)};
+    EntryHandle entry{std::move(path), resetGeneration,
+                      std::move(newEntry.entry), std::move(newEntry.backend)};
     auto insertedIt = m_entriesMap.try_emplace(name, entry).first;
     entry = insertedIt->second;
     lock.unlock();
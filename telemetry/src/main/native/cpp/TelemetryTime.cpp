@@ -0,0 +1,25 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/telemetry/TelemetryTime.hpp"
+
+#include <stdint.h>
+
+namespace wpi::telemetry {
+
+static thread_local int64_t gLogTime = 0;
+
+int64_t GetLogTime() {
+  return gLogTime;
+}
+
+ScopedLogTime::ScopedLogTime(int64_t time) : m_prev{gLogTime} {
+  gLogTime = time;
+}
+
+ScopedLogTime::~ScopedLogTime() {
+  gLogTime = m_prev;
+}
+
+}  // namespace wpi::telemetry
@@ -0,0 +1,159 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "wpi/telemetry/TelemetryBackend.hpp"
+#include "wpi/util/StringMap.hpp"
+#include "wpi/util/condition_variable.hpp"
+#include "wpi/util/mutex.hpp"
+
+namespace wpi::telemetry {
+
+/**
+ * A telemetry backend that moves logging work off of the calling thread.
+ *
+ * Logged values are copied into a per-thread single-producer, single-consumer
+ * ring buffer and forwarded to the wrapped backend (which may be a
+ * MultiTelemetryBackend) by a background thread. Logging a value never blocks
+ * on the wrapped backend; if a thread's buffer is full, the value is dropped
+ * and counted in GetStats().
+ *
+ * Values are forwarded with the time they were logged at, which backends that
+ * timestamp values (e.g. NetworkTables and DataLog) get from GetLogTime().
+ * Metadata (KeepDuplicates() and SetProperty()) and schemas are forwarded
+ * immediately.
+ *
+ * Entries returned by this backend must not outlive it. This is guaranteed for
+ * entries obtained through TelemetryRegistry and TelemetryTable.
+ */
+class AsyncTelemetryBackend : public TelemetryBackend {
+ public:
+  /** Default size of each thread's buffer, in bytes. */
+  static constexpr size_t kDefaultBufferSize = 64 * 1024;
+
+  /** Statistics for values passing through the backend. */
+  struct Stats {
+    /** Number of values queued for the background thread. */
+    uint64_t queued = 0;
+
+    /** Number of values dropped because a buffer was full. */
+    uint64_t dropped = 0;
+
+    /** Largest number of bytes found waiting in a single buffer. */
+    size_t maxBufferUsage = 0;
+  };
+
+  /**
+   * Constructs an asynchronous wrapper around a backend.
+   *
+   * @param backend backend to forward logged data to
+   * @param bufferSize size of each logging thread's buffer in bytes (rounded
+   *                   up to a power of 2)
+   * @param period time between drains of the buffers, in seconds; buffers that
+   *               are more than half full are drained immediately
+   */
+  explicit AsyncTelemetryBackend(std::shared_ptr<TelemetryBackend> backend,
+                                 size_t bufferSize = kDefaultBufferSize,
+                                 double period = 0.005);
+
+  ~AsyncTelemetryBackend() override;
+
+  /**
+   * Create an entry for the given path.
+   *
+   * @param path full name
+   * @return telemetry entry
+   */
+  std::shared_ptr<TelemetryEntry> GetEntry(std::string_view path) override;
+
+  /**
+   * Removes an entry for the given path.
+   *
+   * @param path normalized full name
+   */
+  void RemoveEntry(std::string_view path) override;
+
+  /**
+   * Returns whether the wrapped backend has a data schema already registered
+   * with the given name.
+   *
+   * @param schemaName Name (the string passed as the data type for topics using
+   * this schema)
+   * @return True if schema already registered
+   */
+  bool HasSchema(std::string_view schemaName) const override;
+
+  /**
+   * Registers a data schema with the wrapped backend.
+   *
+   * @param schemaName Name (the string passed as the data type for topics using
+   * this schema)
+   * @param type Type of schema (e.g. "protobuf", "struct", etc)
+   * @param schema Schema data
+   */
+  void AddSchema(std::string_view schemaName, std::string_view type,
+                 std::span<const uint8_t> schema) override;
+
+  /**
+   * Registers a data schema with the wrapped backend.
+   *
+   * @param schemaName Name (the string passed as the data type for topics using
+   * this schema)
+   * @param type Type of schema (e.g. "protobuf", "struct", etc)
+   * @param schema Schema data
+   */
+  void AddSchema(std::string_view schemaName, std::string_view type,
+                 std::string_view schema) override;
+
+  /**
+   * Blocks until every value logged before this call has been forwarded to
+   * the wrapped backend. Must not be called from the wrapped backend.
+   */
+  void Flush();
+
+  /**
+   * Gets statistics for values logged through this backend.
+   *
+   * @return statistics
+   */
+  Stats GetStats() const;
+
+ private:
+  class Buffer;
+  class Entry;
+
+  Buffer& GetBuffer();
+  void ThreadMain();
+  void Drain(std::span<Buffer* const> buffers);
+
+  std::shared_ptr<TelemetryBackend> m_backend;
+  size_t m_bufferSize;
+  double m_period;
+  uint64_t m_id;
+
+  mutable wpi::util::mutex m_mutex;
+  wpi::util::condition_variable m_cond;
+  bool m_wakeup = false;
+  wpi::util::StringMap<std::shared_ptr<Entry>> m_entries;
+  // removed entries that queued values may still refer to
+  std::vector<std::shared_ptr<Entry>> m_removedEntries;
+  std::vector<std::unique_ptr<Buffer>> m_buffers;
+  std::atomic<size_t> m_maxBufferUsage{0};
+  uint64_t m_flushRequested = 0;
+  uint64_t m_flushCompleted = 0;
+  bool m_active = true;
+  std::thread m_thread;
+};
+
+}  // namespace wpi::telemetry
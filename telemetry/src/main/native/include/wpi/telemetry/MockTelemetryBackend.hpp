@@ -14,6 +14,7 @@
 #include <vector>
 
 #include "wpi/telemetry/TelemetryBackend.hpp"
+#include "wpi/telemetry/TelemetryTime.hpp"
 #include "wpi/util/StringMap.hpp"
 #include "wpi/util/mutex.hpp"
 
@@ -68,6 +69,8 @@ class MockTelemetryBackend : public TelemetryBackend {
                  std::vector<int64_t>, std::vector<float>, std::vector<double>,
                  std::vector<std::string>, LogRawValue>
         value;
+    /** GetLogTime() when the action was logged. */
+    int64_t time = GetLogTime();
   };
 
   struct Schema {
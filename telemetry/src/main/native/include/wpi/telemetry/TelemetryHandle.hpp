@@ -0,0 +1,147 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <atomic>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "wpi/telemetry/TelemetryLoggable.hpp"
+#include "wpi/telemetry/TelemetryTable.hpp"
+#include "wpi/util/protobuf/Protobuf.hpp"
+#include "wpi/util/struct/Struct.hpp"
+
+namespace wpi::telemetry {
+
+/**
+ * A cached handle for repeatedly logging values of one type to a single name
+ * in a telemetry table.
+ *
+ * TelemetryTable::Log() looks up the entry by name on every call. A handle
+ * looks up the entry once and keeps it until the table is reset (e.g. when a
+ * backend is registered), so logging the same name every loop does not
+ * allocate or search any maps. Struct and protobuf schemas are likewise only
+ * checked the first time a value is logged to each entry.
+ *
+ * Only single values and arrays can be logged through a handle; objects that
+ * log to a child table should use TelemetryTable::Log().
+ *
+ * A handle may be copied, but a single handle must not be used from multiple
+ * threads concurrently.
+ *
+ * @tparam T value type
+ * @tparam I type parameters for struct serializer (optional)
+ */
+template <typename T, typename... I>
+class TelemetryHandle {
+  static_assert(!SupportsTelemetry<T, I...> &&
+                    !SupportsTelemetryValue<T, I...>,
+                "Objects that log to a table must use TelemetryTable::Log()");
+
+ public:
+  /** Constructs an empty handle. */
+  TelemetryHandle() = default;
+
+  /**
+   * Constructs a handle for a name in a table.
+   *
+   * @param table the table
+   * @param name the name
+   * @param info type parameters for struct serializer (optional)
+   */
+  TelemetryHandle(TelemetryTable& table, std::string_view name, I... info)
+      : m_table{&table}, m_name{name}, m_info{std::move(info)...} {}
+
+  /**
+   * Checks if this handle refers to a table.
+   */
+  explicit operator bool() const { return m_table != nullptr; }
+
+  /**
+   * Gets the name of the value within its table.
+   *
+   * @return name
+   */
+  std::string_view GetName() const { return m_name; }
+
+  /**
+   * Logs a value.
+   *
+   * @param value the value
+   */
+  void Log(const T& value) {
+    if (!m_table) {
+      return;
+    }
+    const auto& entry = GetEntry();
+    if (entry->IsDiscard()) {
+      return;
+    }
+    std::apply(
+        [&](const I&... info) {
+          if constexpr (impl::IsSpanConvertible<T> &&
+                        !std::constructible_from<std::string_view, T>) {
+            if constexpr (impl::HasValueType<T>) {
+              using V = typename std::remove_cvref_t<T>::value_type;
+              TelemetryTable::LogArray(entry, std::span<const V>{value},
+                                       info...);
+            } else {
+              using V = std::remove_extent_t<std::remove_cvref_t<T>>;
+              TelemetryTable::LogArray(entry, std::span<const V>{value},
+                                       info...);
+            }
+          } else if constexpr (wpi::util::StructSerializable<T, I...> &&
+                               !impl::IsEntryPrimitive<T>) {
+            if (!m_schemaPublished) {
+              m_schemaPublished =
+                  TelemetryTable::PublishStructSchema<T>(entry, info...);
+              if (!m_schemaPublished) {
+                return;
+              }
+            }
+            TelemetryTable::LogStruct(entry, value, info...);
+          } else if constexpr (wpi::util::ProtobufSerializable<T>) {
+            wpi::util::ProtobufMessage<T> msg;
+            if (!m_schemaPublished) {
+              m_schemaPublished =
+                  TelemetryTable::PublishProtobufSchema<T>(entry, msg);
+              if (!m_schemaPublished) {
+                return;
+              }
+            }
+            TelemetryTable::LogProtobuf(entry, msg, value);
+          } else {
+            TelemetryTable::LogValue(entry, value, info...);
+          }
+        },
+        m_info);
+  }
+
+ private:
+  const TelemetryTable::EntryHandle& GetEntry() {
+    // The table resets its generation whenever backend routing changes, which
+    // invalidates the cached entry
+    if (!m_entry || m_entry.GetResetGeneration() !=
+                        m_table->m_resetGeneration.load(
+                            std::memory_order_acquire)) {
+      m_entry = m_table->GetEntry(m_name);
+      m_schemaPublished = false;
+    }
+    return m_entry;
+  }
+
+  TelemetryTable* m_table = nullptr;
+  std::string m_name;
+  [[no_unique_address]]
+  std::tuple<I...> m_info;
+  TelemetryTable::EntryHandle m_entry;
+  bool m_schemaPublished = false;
+};
+
+}  // namespace wpi::telemetry
@@ -6,6 +6,7 @@
 
 #include <stdint.h>
 
+#include <atomic>
 #include <exception>
 #include <format>
 #include <initializer_list>
@@ -30,6 +31,8 @@ namespace wpi::telemetry {
 
 class TelemetryBackend;
 class TelemetryEntry;
+template <typename T, typename... I>
+class TelemetryHandle;
 class TelemetryTable;
 
 namespace python {
@@ -56,17 +59,30 @@ concept IsSpanConvertible =
          std::span<const typename std::remove_cvref_t<T>::value_type>,
          const T&>) ||
     std::is_bounded_array_v<std::remove_cvref_t<T>>;
+
+// Types with a dedicated TelemetryEntry log function
+template <typename T>
+concept IsEntryPrimitive =
+    std::same_as<T, bool> || std::same_as<T, int8_t> ||
+    std::same_as<T, int16_t> || std::same_as<T, int32_t> ||
+    std::same_as<T, int64_t> || std::same_as<T, float> ||
+    std::same_as<T, double>;
 }  // namespace impl
 
 /**
  * Telemetry sends information from the robot program to dashboards, debug
  * tools, or log files.
  *
+ * Values that are logged to the same name every loop can be logged through a
+ * TelemetryHandle instead, which skips the per-call entry lookup.
+ *
  * For more advanced use cases, use the NetworkTables or DataLog APIs.
  */
 class TelemetryTable final {
   friend class TelemetryRegistry;
   friend class python::PyTelemetryTable;
+  template <typename T, typename... I>
+  friend class TelemetryHandle;
   struct private_init {};
 
   /**
@@ -75,18 +91,20 @@ class TelemetryTable final {
    */
   class EntryHandle {
     friend class TelemetryTable;
+    template <typename T, typename... I>
+    friend class TelemetryHandle;
 
    private:
     struct CachedEntry {
-      CachedEntry(std::string_view name, uint64_t resetGeneration,
+      CachedEntry(std::string path, uint64_t resetGeneration,
                   std::shared_ptr<TelemetryEntry> entry,
                   std::shared_ptr<TelemetryBackend> backend)
-          : name{name},
+          : path{std::move(path)},
             resetGeneration{resetGeneration},
             entry{std::move(entry)},
             backend{std::move(backend)} {}
 
-      std::string name;
+      std::string path;
       uint64_t resetGeneration;
       std::shared_ptr<TelemetryEntry> entry;
       std::shared_ptr<TelemetryBackend> backend;
@@ -107,6 +125,9 @@ class TelemetryTable final {
     /** Gets the backend that owns the entry. */
     TelemetryBackend& GetBackend() const { return *m_entry->backend; }
 
+    /** Gets the full path of the entry. */
+    std::string_view GetPath() const { return m_entry->path; }
+
     bool HasPublishedSchema(std::string_view schemaName) const {
       std::scoped_lock lock{m_entry->schemaMutex};
       return m_entry->publishedSchemas.contains(schemaName);
@@ -118,11 +139,17 @@ class TelemetryTable final {
     }
 
    private:
-    EntryHandle(std::string_view name, uint64_t resetGeneration,
+    EntryHandle() = default;
+
+    EntryHandle(std::string path, uint64_t resetGeneration,
                 std::shared_ptr<TelemetryEntry> entry,
                 std::shared_ptr<TelemetryBackend> backend)
-        : m_entry{std::make_shared<CachedEntry>(
-              name, resetGeneration, std::move(entry), std::move(backend))} {}
+        : m_entry{std::make_shared<CachedEntry>(std::move(path),
+                                                resetGeneration,
+                                                std::move(entry),
+                                                std::move(backend))} {}
+
+    uint64_t GetResetGeneration() const { return m_entry->resetGeneration; }
 
     std::shared_ptr<CachedEntry> m_entry;
   };
@@ -228,22 +255,8 @@ class TelemetryTable final {
         return;
       }
       LogValueTo(*this, name, value, info...);
-    } else if constexpr (std::constructible_from<std::string_view, T>) {
-      auto entry = GetEntry(name);
-      if (entry->IsDiscard()) {
-        return;
-      }
-      if constexpr (sizeof...(I) == 0) {
-        entry->LogString(std::string_view{value}, "string");
-      } else if constexpr (sizeof...(I) == 1 &&
-                           (std::constructible_from<std::string_view, I> &&
-                            ...)) {
-        entry->LogString(std::string_view{value}, std::string_view{info...});
-      } else {
-        static_assert(impl::always_false<T>::value,
-                      "Don't know how to serialize type");
-      }
-    } else if constexpr (impl::IsSpanConvertible<T>) {
+    } else if constexpr (impl::IsSpanConvertible<T> &&
+                         !std::constructible_from<std::string_view, T>) {
       if constexpr (impl::HasValueType<T>) {
         using V = typename std::remove_cvref_t<T>::value_type;
         Log(name, std::span<const V>{value}, info...);
@@ -251,79 +264,12 @@ class TelemetryTable final {
         using V = std::remove_extent_t<std::remove_cvref_t<T>>;
         Log(name, std::span<const V>{value}, info...);
       }
-    } else if constexpr (wpi::util::StructSerializable<T, I...>) {
-      auto entry = GetEntry(name);
-      if (entry->IsDiscard()) {
-        return;
-      }
-      auto path = std::format("{}{}", m_path, name);
-      using S = wpi::util::Struct<T, I...>;
-      auto typeString = wpi::util::GetStructTypeString<T>(info...);
-      if (!PublishStructSchema<T>(entry, path, typeString, info...)) {
-        return;
-      }
-      try {
-        if constexpr (sizeof...(I) == 0) {
-          if constexpr (wpi::util::is_constexpr([] { S::GetSize(); })) {
-            uint8_t buf[S::GetSize()];
-            S::Pack(buf, value);
-            entry->LogRaw(std::span{buf}, typeString);
-            return;
-          }
-        }
-        wpi::util::SmallVector<uint8_t, 128> buf;
-        buf.resize_for_overwrite(S::GetSize(info...));
-        S::Pack(buf, value, info...);
-        entry->LogRaw(std::span{buf}, typeString);
-      } catch (const std::exception& e) {
-        ReportWarning(path, "failed to publish struct value", e);
-      } catch (...) {
-        ReportWarning(path, "failed to publish struct value");
-      }
-    } else if constexpr (wpi::util::ProtobufSerializable<T>) {
-      auto entry = GetEntry(name);
-      if (entry->IsDiscard()) {
-        return;
-      }
-      auto path = std::format("{}{}", m_path, name);
-      wpi::util::ProtobufMessage<T> msg;
-      auto typeString = msg.GetTypeString();
-      if (!PublishProtobufSchema<T>(entry, path, typeString, msg)) {
-        return;
-      }
-      wpi::util::SmallVector<uint8_t, 128> buf;
-      try {
-        if (!msg.Pack(buf, value)) {
-          ReportWarning(path, "failed to publish protobuf value");
-          return;
-        }
-        entry->LogRaw(buf, typeString);
-      } catch (const std::exception& e) {
-        ReportWarning(path, "failed to publish protobuf value", e);
-      } catch (...) {
-        ReportWarning(path, "failed to publish protobuf value");
-      }
-    } else if constexpr (std::integral<T>) {
-      auto entry = GetEntry(name);
-      if (entry->IsDiscard()) {
-        return;
-      }
-      entry->LogInt64(static_cast<int64_t>(value));
-    } else if constexpr (std::floating_point<T>) {
-      auto entry = GetEntry(name);
-      if (entry->IsDiscard()) {
-        return;
-      }
-      entry->LogDouble(static_cast<double>(value));
-    } else if constexpr (std::constructible_from<std::formatter<T>>) {
+    } else {
       auto entry = GetEntry(name);
       if (entry->IsDiscard()) {
         return;
       }
-      entry->LogString(std::format("{}", value), "string");
-    } else {
-      static_assert(impl::always_false<T>::value,
-                    "Don't know how to serialize type");
+      LogValue(entry, value, info...);
     }
   }
 
@@ -340,73 +286,7 @@ class TelemetryTable final {
     if (entry->IsDiscard()) {
       return;
     }
-    using U = std::remove_cv_t<T>;
-    if constexpr (std::same_as<U, bool>) {
-      entry->LogBooleanArray(value);
-    } else if constexpr (std::same_as<U, int16_t>) {
-      entry->LogInt16Array(value);
-    } else if constexpr (std::same_as<U, int32_t>) {
-      entry->LogInt32Array(value);
-    } else if constexpr (std::same_as<U, int64_t>) {
-      entry->LogInt64Array(value);
-    } else if constexpr (std::same_as<U, float>) {
-      entry->LogFloatArray(value);
-    } else if constexpr (std::same_as<U, double>) {
-      entry->LogDoubleArray(value);
-    } else if constexpr (std::same_as<U, std::string>) {
-      entry->LogStringArray(value);
-    } else if constexpr (std::same_as<U, std::string_view>) {
-      entry->LogStringArray(value);
-    } else if constexpr (std::same_as<U, uint8_t>) {
-      if constexpr (sizeof...(I) == 0) {
-        entry->LogRaw(value, "raw");
-      } else if constexpr (sizeof...(I) == 1 &&
-                           (std::constructible_from<std::string_view, I> &&
-                            ...)) {
-        entry->LogRaw(value, std::string_view{info...});
-      } else {
-        static_assert(impl::always_false<T>::value,
-                      "Don't know how to serialize type");
-      }
-    } else if constexpr (std::integral<U>) {
-      std::vector<int64_t> values;
-      values.reserve(value.size());
-      for (auto&& v : value) {
-        values.emplace_back(static_cast<int64_t>(v));
-      }
-      entry->LogInt64Array(values);
-    } else if constexpr (wpi::util::StructSerializable<T, I...>) {
-      auto structTypeString = wpi::util::GetStructTypeString<T>(info...);
-      auto path = std::format("{}{}", m_path, name);
-      if (!PublishStructSchema<T>(entry, path, structTypeString, info...)) {
-        return;
-      }
-      try {
-        wpi::util::StructArrayBuffer<T, I...> buf;
-        buf.Write(
-            value,
-            [&](auto bytes) {
-              entry->LogRaw(
-                  bytes,
-                  std::format("{}[]", std::string_view{structTypeString}));
-            },
-            info...);
-      } catch (const std::exception& e) {
-        ReportWarning(path, "failed to publish struct array value", e);
-      } catch (...) {
-        ReportWarning(path, "failed to publish struct array value");
-      }
-    } else if constexpr (std::constructible_from<std::formatter<T>>) {
-      std::vector<std::string> strings;
-      strings.reserve(value.size());
-      for (auto&& v : value) {
-        strings.emplace_back(std::format("{}", v));
-      }
-      entry->LogStringArray(strings);
-    } else {
-      static_assert(impl::always_false<T>::value,
-                    "Don't know how to serialize type");
-    }
+    LogArray(entry, value, info...);
   }
 
   /**
@@ -650,20 +530,196 @@ class TelemetryTable final {
 
   void TypeMismatch(std::string_view expectedType, std::string_view typeString);
 
+  /**
+   * Logs a single value (not a table or an array) to an entry. The entry must
+   * not be a discard entry.
+   */
+  template <typename T, typename... I>
+  static void LogValue(const EntryHandle& entry, const T& value,
+                       const I&... info) {
+    if constexpr (std::same_as<T, bool>) {
+      entry->LogBoolean(value);
+    } else if constexpr (std::same_as<T, int8_t>) {
+      entry->LogInt8(value);
+    } else if constexpr (std::same_as<T, int16_t>) {
+      entry->LogInt16(value);
+    } else if constexpr (std::same_as<T, int32_t>) {
+      entry->LogInt32(value);
+    } else if constexpr (std::same_as<T, int64_t>) {
+      entry->LogInt64(value);
+    } else if constexpr (std::same_as<T, float>) {
+      entry->LogFloat(value);
+    } else if constexpr (std::same_as<T, double>) {
+      entry->LogDouble(value);
+    } else if constexpr (std::constructible_from<std::string_view, T>) {
+      if constexpr (sizeof...(I) == 0) {
+        entry->LogString(std::string_view{value}, "string");
+      } else if constexpr (sizeof...(I) == 1 &&
+                           (std::constructible_from<std::string_view, I> &&
+                            ...)) {
+        entry->LogString(std::string_view{value}, std::string_view{info...});
+      } else {
+        static_assert(impl::always_false<T>::value,
+                      "Don't know how to serialize type");
+      }
+    } else if constexpr (wpi::util::StructSerializable<T, I...>) {
+      if (PublishStructSchema<T>(entry, info...)) {
+        LogStruct(entry, value, info...);
+      }
+    } else if constexpr (wpi::util::ProtobufSerializable<T>) {
+      wpi::util::ProtobufMessage<T> msg;
+      if (PublishProtobufSchema<T>(entry, msg)) {
+        LogProtobuf(entry, msg, value);
+      }
+    } else if constexpr (std::integral<T>) {
+      entry->LogInt64(static_cast<int64_t>(value));
+    } else if constexpr (std::floating_point<T>) {
+      entry->LogDouble(static_cast<double>(value));
+    } else if constexpr (std::constructible_from<std::formatter<T>>) {
+      entry->LogString(std::format("{}", value), "string");
+    } else {
+      static_assert(impl::always_false<T>::value,
+                    "Don't know how to serialize type");
+    }
+  }
+
+  /**
+   * Logs an array to an entry. The entry must not be a discard entry.
+   */
+  template <typename T, typename... I>
+  static void LogArray(const EntryHandle& entry, std::span<const T> value,
+                       const I&... info) {
+    using U = std::remove_cv_t<T>;
+    if constexpr (std::same_as<U, bool>) {
+      entry->LogBooleanArray(value);
+    } else if constexpr (std::same_as<U, int16_t>) {
+      entry->LogInt16Array(value);
+    } else if constexpr (std::same_as<U, int32_t>) {
+      entry->LogInt32Array(value);
+    } else if constexpr (std::same_as<U, int64_t>) {
+      entry->LogInt64Array(value);
+    } else if constexpr (std::same_as<U, float>) {
+      entry->LogFloatArray(value);
+    } else if constexpr (std::same_as<U, double>) {
+      entry->LogDoubleArray(value);
+    } else if constexpr (std::same_as<U, std::string>) {
+      entry->LogStringArray(value);
+    } else if constexpr (std::same_as<U, std::string_view>) {
+      entry->LogStringArray(value);
+    } else if constexpr (std::same_as<U, uint8_t>) {
+      if constexpr (sizeof...(I) == 0) {
+        entry->LogRaw(value, "raw");
+      } else if constexpr (sizeof...(I) == 1 &&
+                           (std::constructible_from<std::string_view, I> &&
+                            ...)) {
+        entry->LogRaw(value, std::string_view{info...});
+      } else {
+        static_assert(impl::always_false<T>::value,
+                      "Don't know how to serialize type");
+      }
+    } else if constexpr (std::integral<U>) {
+      std::vector<int64_t> values;
+      values.reserve(value.size());
+      for (auto&& v : value) {
+        values.emplace_back(static_cast<int64_t>(v));
+      }
+      entry->LogInt64Array(values);
+    } else if constexpr (wpi::util::StructSerializable<T, I...>) {
+      if (!PublishStructSchema<T>(entry, info...)) {
+        return;
+      }
+      auto structTypeString = wpi::util::GetStructTypeString<T>(info...);
+      try {
+        wpi::util::StructArrayBuffer<T, I...> buf;
+        buf.Write(
+            value,
+            [&](auto bytes) {
+              entry->LogRaw(
+                  bytes,
+                  std::format("{}[]", std::string_view{structTypeString}));
+            },
+            info...);
+      } catch (const std::exception& e) {
+        ReportWarning(entry, "failed to publish struct array value", e);
+      } catch (...) {
+        ReportWarning(entry, "failed to publish struct array value");
+      }
+    } else if constexpr (std::constructible_from<std::formatter<T>>) {
+      std::vector<std::string> strings;
+      strings.reserve(value.size());
+      for (auto&& v : value) {
+        strings.emplace_back(std::format("{}", v));
+      }
+      entry->LogStringArray(strings);
+    } else {
+      static_assert(impl::always_false<T>::value,
+                    "Don't know how to serialize type");
+    }
+  }
+
+  /**
+   * Logs a struct value to an entry whose schema has already been published.
+   */
+  template <typename T, typename... I>
+    requires wpi::util::StructSerializable<T, I...>
+  static void LogStruct(const EntryHandle& entry, const T& value,
+                        const I&... info) {
+    using S = wpi::util::Struct<T, I...>;
+    auto typeString = wpi::util::GetStructTypeString<T>(info...);
+    try {
+      if constexpr (sizeof...(I) == 0) {
+        if constexpr (wpi::util::is_constexpr([] { S::GetSize(); })) {
+          uint8_t buf[S::GetSize()];
+          S::Pack(buf, value);
+          entry->LogRaw(std::span{buf}, typeString);
+          return;
+        }
+      }
+      wpi::util::SmallVector<uint8_t, 128> buf;
+      buf.resize_for_overwrite(S::GetSize(info...));
+      S::Pack(buf, value, info...);
+      entry->LogRaw(std::span{buf}, typeString);
+    } catch (const std::exception& e) {
+      ReportWarning(entry, "failed to publish struct value", e);
+    } catch (...) {
+      ReportWarning(entry, "failed to publish struct value");
+    }
+  }
+
+  /**
+   * Logs a protobuf value to an entry whose schema has already been published.
+   */
+  template <wpi::util::ProtobufSerializable T>
+  static void LogProtobuf(const EntryHandle& entry,
+                          wpi::util::ProtobufMessage<T>& msg, const T& value) {
+    wpi::util::SmallVector<uint8_t, 128> buf;
+    try {
+      if (!msg.Pack(buf, value)) {
+        ReportWarning(entry, "failed to publish protobuf value");
+        return;
+      }
+      entry->LogRaw(buf, msg.GetTypeString());
+    } catch (const std::exception& e) {
+      ReportWarning(entry, "failed to publish protobuf value", e);
+    } catch (...) {
+      ReportWarning(entry, "failed to publish protobuf value");
+    }
+  }
+
   template <typename T, typename... I>
     requires wpi::util::StructSerializable<T, I...>
-  bool PublishStructSchema(const EntryHandle& entry, std::string_view path,
-                           std::string_view typeString, const I&... info) {
+  static bool PublishStructSchema(const EntryHandle& entry, const I&... info) {
+    auto typeString = wpi::util::GetStructTypeString<T>(info...);
     if (entry.HasPublishedSchema(typeString)) {
       return true;
     }
     try {
       TelemetryRegistry::AddStructSchema<T>(entry.GetBackend(), info...);
     } catch (const std::exception& e) {
-      ReportWarning(path, "failed to publish struct schema", e);
+      ReportWarning(entry, "failed to publish struct schema", e);
       return false;
     } catch (...) {
-      ReportWarning(path, "failed to publish struct schema");
+      ReportWarning(entry, "failed to publish struct schema");
       return false;
     }
     entry.MarkSchemaPublished(typeString);
@@ -671,33 +727,34 @@ class TelemetryTable final {
   }
 
   template <wpi::util::ProtobufSerializable T>
-  bool PublishProtobufSchema(const EntryHandle& entry, std::string_view path,
-                             std::string_view typeString,
-                             wpi::util::ProtobufMessage<T>& msg) {
+  static bool PublishProtobufSchema(const EntryHandle& entry,
+                                    wpi::util::ProtobufMessage<T>& msg) {
+    auto typeString = msg.GetTypeString();
     if (entry.HasPublishedSchema(typeString)) {
       return true;
     }
     try {
       TelemetryRegistry::AddProtobufSchema<T>(entry.GetBackend(), msg);
     } catch (const std::exception& e) {
-      ReportWarning(path, "failed to publish protobuf schema", e);
+      ReportWarning(entry, "failed to publish protobuf schema", e);
       return false;
     } catch (...) {
-      ReportWarning(path, "failed to publish protobuf schema");
+      ReportWarning(entry, "failed to publish protobuf schema");
       return false;
     }
     entry.MarkSchemaPublished(typeString);
     return true;
   }
 
-  static void ReportWarning(std::string_view path, std::string_view msg,
+  // The entry path is only formatted when a warning is actually reported
+  static void ReportWarning(const EntryHandle& entry, std::string_view msg,
                             const std::exception& e) {
-    TelemetryRegistry::ReportWarning(path,
+    TelemetryRegistry::ReportWarning(entry.GetPath(),
                                      std::format("{}: {}", msg, e.what()));
   }
 
-  static void ReportWarning(std::string_view path, std::string_view msg) {
-    TelemetryRegistry::ReportWarning(path, msg);
+  static void ReportWarning(const EntryHandle& entry, std::string_view msg) {
+    TelemetryRegistry::ReportWarning(entry.GetPath(), msg);
   }
 
   /** Clears the table's cached entries. */
@@ -711,7 +768,7 @@ class TelemetryTable final {
   std::string m_type;
   bool m_hasNonDiscardDescendant = false;
   bool m_hasNonDiscardDescendantCached = false;
-  uint64_t m_resetGeneration = 0;
+  std::atomic<uint64_t> m_resetGeneration{0};
 };
 
 }  // namespace wpi::telemetry
@@ -0,0 +1,45 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stdint.h>
+
+namespace wpi::telemetry {
+
+/**
+ * Gets the time the values being logged on the current thread were logged
+ * at. Backends that timestamp values should use this time if it is nonzero.
+ * It is only nonzero while a backend that forwards values later, such as
+ * AsyncTelemetryBackend, is forwarding them.
+ *
+ * @return time in microseconds, in the same time base as wpi::util::Now(),
+ *         or 0 if values are being logged as they are produced
+ */
+int64_t GetLogTime();
+
+/**
+ * Sets the time returned by GetLogTime() on the current thread for the
+ * lifetime of this object.
+ */
+class ScopedLogTime {
+ public:
+  /**
+   * Sets the log time.
+   *
+   * @param time time in microseconds, in the same time base as
+   *             wpi::util::Now()
+   */
+  explicit ScopedLogTime(int64_t time);
+
+  ~ScopedLogTime();
+
+  ScopedLogTime(const ScopedLogTime&) = delete;
+  ScopedLogTime& operator=(const ScopedLogTime&) = delete;
+
+ private:
+  int64_t m_prev;
+};
+
+}  // namespace wpi::telemetry
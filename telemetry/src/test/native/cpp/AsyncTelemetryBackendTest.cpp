@@ -0,0 +1,397 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/telemetry/AsyncTelemetryBackend.hpp"  // NOLINT(build/include_order)
+
+#include <stdint.h>
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "wpi/telemetry/MockTelemetryBackend.hpp"
+#include "wpi/telemetry/MultiTelemetryBackend.hpp"
+#include "wpi/telemetry/TelemetryEntry.hpp"
+#include "wpi/telemetry/TelemetryRegistry.hpp"
+#include "wpi/telemetry/TelemetryTable.hpp"
+#include "wpi/telemetry/TelemetryTime.hpp"
+#include "wpi/util/timestamp.hpp"
+
+using wpi::telemetry::AsyncTelemetryBackend;
+using wpi::telemetry::MockTelemetryBackend;
+
+namespace {
+
+// Backend whose entries block in LogDouble() until released
+class GatedTelemetryBackend : public MockTelemetryBackend {
+ public:
+  GatedTelemetryBackend() : m_releaseFuture{m_release.get_future().share()} {}
+
+  std::shared_ptr<wpi::telemetry::TelemetryEntry> GetEntry(
+      std::string_view path) override {
+    return std::make_shared<Entry>(*this,
+                                   MockTelemetryBackend::GetEntry(path));
+  }
+
+  void WaitFirstLog() { m_enteredFuture.wait(); }
+
+  void Release() { m_release.set_value(); }
+
+ private:
+  class Entry : public wpi::telemetry::TelemetryEntry {
+   public:
+    Entry(GatedTelemetryBackend& backend,
+          std::shared_ptr<wpi::telemetry::TelemetryEntry> entry)
+        : m_backend{backend}, m_entry{std::move(entry)} {}
+
+    void KeepDuplicates() override { m_entry->KeepDuplicates(); }
+    void SetProperty(std::string_view key, std::string_view value) override {
+      m_entry->SetProperty(key, value);
+    }
+    void LogBoolean(bool value) override { m_entry->LogBoolean(value); }
+    void LogInt64(int64_t value) override { m_entry->LogInt64(value); }
+    void LogFloat(float value) override { m_entry->LogFloat(value); }
+    void LogDouble(double value) override {
+      if (!m_backend.m_entered.exchange(true)) {
+        m_backend.m_enteredPromise.set_value();
+      }
+      m_backend.m_releaseFuture.wait();
+      m_entry->LogDouble(value);
+    }
+    void LogString(std::string_view value,
+                   std::string_view typeString) override {
+      m_entry->LogString(value, typeString);
+    }
+    void LogBooleanArray(std::span<const bool> value) override {
+      m_entry->LogBooleanArray(value);
+    }
+    void LogBooleanArray(std::span<const int> value) override {
+      m_entry->LogBooleanArray(value);
+    }
+    void LogInt16Array(std::span<const int16_t> value) override {
+      m_entry->LogInt16Array(value);
+    }
+    void LogInt32Array(std::span<const int32_t> value) override {
+      m_entry->LogInt32Array(value);
+    }
+    void LogInt64Array(std::span<const int64_t> value) override {
+      m_entry->LogInt64Array(value);
+    }
+    void LogFloatArray(std::span<const float> value) override {
+      m_entry->LogFloatArray(value);
+    }
+    void LogDoubleArray(std::span<const double> value) override {
+      m_entry->LogDoubleArray(value);
+    }
+    void LogStringArray(std::span<const std::string> value) override {
+      m_entry->LogStringArray(value);
+    }
+    void LogStringArray(std::span<const std::string_view> value) override {
+      m_entry->LogStringArray(value);
+    }
+    void LogRaw(std::span<const uint8_t> value,
+                std::string_view typeString) override {
+      m_entry->LogRaw(value, typeString);
+    }
+
+   private:
+    GatedTelemetryBackend& m_backend;
+    std::shared_ptr<wpi::telemetry::TelemetryEntry> m_entry;
+  };
+
+  std::promise<void> m_enteredPromise;
+  std::future<void> m_enteredFuture = m_enteredPromise.get_future();
+  std::atomic_bool m_entered{false};
+  std::promise<void> m_release;
+  std::shared_future<void> m_releaseFuture;
+};
+
+}  // namespace
+
+TEST_CASE("AsyncTelemetryBackendTest NullBackend", "[telemetry]") {
+  REQUIRE_THROWS_AS(AsyncTelemetryBackend{nullptr}, std::invalid_argument);
+}
+
+TEST_CASE("AsyncTelemetryBackendTest ForwardsAllTypes", "[telemetry]") {
+  auto mock = std::make_shared<MockTelemetryBackend>();
+  AsyncTelemetryBackend backend{mock};
+
+  backend.GetEntry("/bool")->LogBoolean(true);
+  backend.GetEntry("/int16")->LogInt16(-5);
+  backend.GetEntry("/int64")->LogInt64(1234567890123);
+  backend.GetEntry("/float")->LogFloat(1.5f);
+  backend.GetEntry("/double")->LogDouble(2.5);
+  backend.GetEntry("/string")->LogString("hello", "text");
+  bool bools[] = {true, false, true};
+  backend.GetEntry("/bools")->LogBooleanArray(bools);
+  int ints[] = {0, 1};
+  backend.GetEntry("/boolints")->LogBooleanArray(ints);
+  int32_t int32s[] = {1, 2, 3};
+  backend.GetEntry("/int32s")->LogInt32Array(int32s);
+  double doubles[] = {1.0, 2.0};
+  backend.GetEntry("/doubles")->LogDoubleArray(doubles);
+  std::string strings[] = {"a", "", "abc"};
+  backend.GetEntry("/strings")->LogStringArray(strings);
+  std::string_view views[] = {"x", "yz"};
+  backend.GetEntry("/views")->LogStringArray(views);
+  uint8_t raw[] = {1, 2, 3, 4, 5};
+  backend.GetEntry("/raw")->LogRaw(raw, "bytes");
+
+  backend.Flush();
+
+  REQUIRE(mock->GetLastValue<bool>("/bool") == true);
+  REQUIRE(mock->GetLastValue<int16_t>("/int16") == -5);
+  REQUIRE(mock->GetLastValue<int64_t>("/int64") == 1234567890123);
+  REQUIRE(mock->GetLastValue<float>("/float") == 1.5f);
+  REQUIRE(mock->GetLastValue<double>("/double") == 2.5);
+  auto str = mock->GetLastValue<MockTelemetryBackend::LogStringValue>(
+      "/string");
+  REQUIRE(str);
+  REQUIRE(str->value == "hello");
+  REQUIRE(str->typeString == "text");
+  auto boolArr =
+      mock->GetLastValue<MockTelemetryBackend::LogBooleanArrayValue>("/bools");
+  REQUIRE(boolArr);
+  REQUIRE(boolArr->value == std::vector<int>{1, 0, 1});
+  boolArr = mock->GetLastValue<MockTelemetryBackend::LogBooleanArrayValue>(
+      "/boolints");
+  REQUIRE(boolArr);
+  REQUIRE(boolArr->value == std::vector<int>{0, 1});
+  REQUIRE(mock->GetLastValue<std::vector<int32_t>>("/int32s") ==
+          std::vector<int32_t>{1, 2, 3});
+  REQUIRE(mock->GetLastValue<std::vector<double>>("/doubles") ==
+          std::vector<double>{1.0, 2.0});
+  REQUIRE(mock->GetLastValue<std::vector<std::string>>("/strings") ==
+          std::vector<std::string>{"a", "", "abc"});
+  REQUIRE(mock->GetLastValue<std::vector<std::string>>("/views") ==
+          std::vector<std::string>{"x", "yz"});
+  auto rawValue = mock->GetLastValue<MockTelemetryBackend::LogRawValue>("/raw");
+  REQUIRE(rawValue);
+  REQUIRE(rawValue->value == std::vector<uint8_t>{1, 2, 3, 4, 5});
+  REQUIRE(rawValue->typeString == "bytes");
+
+  auto stats = backend.GetStats();
+  REQUIRE(stats.queued == 13);
+  REQUIRE(stats.dropped == 0);
+}
+
+TEST_CASE("AsyncTelemetryBackendTest PreservesOrderAcrossWrap",
+          "[telemetry]") {
+  auto mock = std::make_shared<MockTelemetryBackend>();
+  AsyncTelemetryBackend backend{mock, 256};
+  auto entry = backend.GetEntry("/value");
+  for (int i = 0; i < 1000; ++i) {
+    // variable sized records so the ring wraps at different offsets
+    std::vector<int64_t> value(i % 5, i);
+    entry->LogInt64Array(value);
+    if (i % 2 == 0) {
+      backend.Flush();
+    }
+  }
+  backend.Flush();
+
+  auto stats = backend.GetStats();
+  REQUIRE(stats.queued + stats.dropped == 1000);
+  REQUIRE(stats.maxBufferUsage <= 256);
+  int64_t last = -1;
+  for (auto&& action : mock->GetActions()) {
+    auto& value = std::get<std::vector<int64_t>>(action.value);
+    for (auto v : value) {
+      REQUIRE(v > last);
+    }
+    if (!value.empty()) {
+      last = value.front();
+    }
+  }
+  REQUIRE(mock->GetLastValue<std::vector<int64_t>>("/value") ==
+          std::vector<int64_t>(4, 999));
+}
+
+TEST_CASE("AsyncTelemetryBackendTest DropsWhenFull", "[telemetry]") {
+  auto gated = std::make_shared<GatedTelemetryBackend>();
+  AsyncTelemetryBackend backend{gated, 256};
+  auto entry = backend.GetEntry("/value");
+
+  entry->LogDouble(0);
+  gated->WaitFirstLog();
+  // the background thread is blocked, so the buffer fills up
+  for (int i = 1; i <= 100; ++i) {
+    entry->LogDouble(i);
+  }
+  auto stats = backend.GetStats();
+  REQUIRE(stats.dropped > 0);
+  REQUIRE(stats.queued + stats.dropped == 101);
+
+  gated->Release();
+  backend.Flush();
+  REQUIRE(gated->GetActions().size() == backend.GetStats().queued);
+}
+
+TEST_CASE("AsyncTelemetryBackendTest MultipleThreads", "[telemetry]") {
+  auto mock = std::make_shared<MockTelemetryBackend>();
+  AsyncTelemetryBackend backend{mock};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      auto entry = backend.GetEntry("/thread" + std::to_string(t));
+      for (int i = 0; i < 1000; ++i) {
+        entry->LogInt64(i);
+      }
+    });
+  }
+  for (auto&& thread : threads) {
+    thread.join();
+  }
+  backend.Flush();
+
+  auto stats = backend.GetStats();
+  REQUIRE(stats.queued + stats.dropped == 4000);
+  REQUIRE(mock->GetActions().size() == stats.queued);
+  if (stats.dropped == 0) {
+    for (int t = 0; t < 4; ++t) {
+      REQUIRE(mock->GetLastValue<int64_t>("/thread" + std::to_string(t)) ==
+              999);
+    }
+  }
+}
+
+TEST_CASE("AsyncTelemetryBackendTest WrapsMultiBackend", "[telemetry]") {
+  auto mock1 = std::make_shared<MockTelemetryBackend>();
+  auto mock2 = std::make_shared<MockTelemetryBackend>();
+  auto backend = std::make_shared<AsyncTelemetryBackend>(
+      std::make_shared<wpi::telemetry::MultiTelemetryBackend>(
+          std::vector<std::shared_ptr<wpi::telemetry::TelemetryBackend>>{
+              mock1, mock2}));
+
+  wpi::telemetry::TelemetryRegistry::Reset();
+  wpi::telemetry::TelemetryRegistry::RegisterBackend("", backend);
+  auto& table = wpi::telemetry::TelemetryRegistry::GetTable("/robot");
+  table.Log("speed", 3.0);
+  table.Log("name", "bot");
+  backend->Flush();
+
+  REQUIRE(mock1->GetLastValue<double>("/robot/speed") == 3.0);
+  REQUIRE(mock2->GetLastValue<double>("/robot/speed") == 3.0);
+  REQUIRE(mock1->GetLastValue<MockTelemetryBackend::LogStringValue>(
+                  "/robot/name")
+              ->value == "bot");
+  wpi::telemetry::TelemetryRegistry::Reset();
+}
+
+TEST_CASE("AsyncTelemetryBackendTest RemoveEntry", "[telemetry]") {
+  auto mock = std::make_shared<MockTelemetryBackend>();
+  AsyncTelemetryBackend backend{mock};
+
+  auto entry = backend.GetEntry("/value");
+  entry->LogDouble(1.0);
+  backend.Flush();
+  backend.RemoveEntry("/value");
+  REQUIRE(entry->IsDiscard());
+
+  // values logged to a removed entry are discarded
+  entry->LogDouble(2.0);
+  entry.reset();
+  backend.Flush();
+
+  auto newEntry = backend.GetEntry("/value");
+  REQUIRE(!newEntry->IsDiscard());
+  newEntry->LogDouble(3.0);
+  backend.Flush();
+
+  std::vector<double> logged;
+  for (auto&& action : mock->GetActions()) {
+    if (auto value = std::get_if<double>(&action.value)) {
+      logged.emplace_back(*value);
+    }
+  }
+  REQUIRE(logged == std::vector<double>{1.0, 3.0});
+}
+
+TEST_CASE("AsyncTelemetryBackendTest RemoveEntryWhileLogging",
+          "[telemetry]") {
+  auto mock = std::make_shared<MockTelemetryBackend>();
+  AsyncTelemetryBackend backend{mock, 256, 0.0001};
+
+  // the last reference is dropped while the background thread drains, so
+  // entries must stay alive until the records queued for them are read
+  for (int i = 0; i < 200; ++i) {
+    auto entry = backend.GetEntry("/value");
+    std::thread thread{[entry = std::move(entry)]() mutable {
+      for (int j = 0; j < 20; ++j) {
+        entry->LogInt64(j);
+      }
+      entry.reset();
+    }};
+    backend.RemoveEntry("/value");
+    thread.join();
+  }
+  backend.Flush();
+
+  auto stats = backend.GetStats();
+  REQUIRE(stats.queued + stats.dropped == 4000);
+}
+
+TEST_CASE("AsyncTelemetryBackendTest WrapsEmptyBuffer", "[telemetry]") {
+  auto mock = std::make_shared<MockTelemetryBackend>();
+  AsyncTelemetryBackend backend{mock, 256};
+  auto entry = backend.GetEntry("/value");
+
+  // the second and third records don't fit before the end of the buffer
+  // after the previous record, but do fit in the whole buffer once it's empty
+  entry->LogInt64Array(std::vector<int64_t>(10, 1));
+  backend.Flush();
+  entry->LogInt64Array(std::vector<int64_t>(25, 2));
+  backend.Flush();
+  entry->LogInt64Array(std::vector<int64_t>(27, 3));
+  backend.Flush();
+  // larger than the buffer
+  entry->LogInt64Array(std::vector<int64_t>(30, 4));
+  backend.Flush();
+
+  auto stats = backend.GetStats();
+  REQUIRE(stats.queued == 3);
+  REQUIRE(stats.dropped == 1);
+  REQUIRE(mock->GetLastValue<std::vector<int64_t>>("/value") ==
+          std::vector<int64_t>(27, 3));
+}
+
+namespace {
+std::atomic<uint64_t> gNow{0};
+}  // namespace
+
+TEST_CASE("AsyncTelemetryBackendTest KeepsLogTime", "[telemetry]") {
+  wpi::util::SetNowImpl([] { return gNow.load(); });
+  auto mock = std::make_shared<MockTelemetryBackend>();
+  {
+    // values forwarded between async backends keep the original time
+    AsyncTelemetryBackend inner{mock};
+    AsyncTelemetryBackend backend{
+        std::shared_ptr<wpi::telemetry::TelemetryBackend>{
+            &inner, [](auto) {}}};
+
+    gNow = 1000;
+    backend.GetEntry("/value")->LogDouble(1.0);
+    gNow = 2000;
+    backend.GetEntry("/value")->LogDouble(2.0);
+    gNow = 5000;
+    backend.Flush();
+    inner.Flush();
+  }
+  wpi::util::SetNowImpl(nullptr);
+
+  auto& actions = mock->GetActions();
+  REQUIRE(actions.size() == 2);
+  CHECK(actions[0].time == 1000);
+  CHECK(actions[1].time == 2000);
+  CHECK(wpi::telemetry::GetLogTime() == 0);
+}
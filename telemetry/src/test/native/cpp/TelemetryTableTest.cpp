@@ -27,6 +27,7 @@
 #include "wpi/telemetry/MultiTelemetryBackend.hpp"
 #include "wpi/telemetry/Telemetry.hpp"
 #include "wpi/telemetry/TelemetryEntry.hpp"
+#include "wpi/telemetry/TelemetryHandle.hpp"
 #include "wpi/telemetry/TelemetryRegistry.hpp"
 #include "wpi/util/StringMap.hpp"
 #include "wpi/util/struct/Struct.hpp"
@@ -130,6 +131,20 @@ class CountingSchemaBackend : public wpi::telemetry::MockTelemetryBackend {
   std::atomic_int m_schemaAdds{0};
 };
 
+class CountingEntryBackend : public wpi::telemetry::MockTelemetryBackend {
+ public:
+  int GetEntryCount() const { return m_getEntries.load(); }
+
+  std::shared_ptr<wpi::telemetry::TelemetryEntry> GetEntry(
+      std::string_view path) override {
+    ++m_getEntries;
+    return wpi::telemetry::MockTelemetryBackend::GetEntry(path);
+  }
+
+ private:
+  std::atomic_int m_getEntries{0};
+};
+
 class RegisteringTelemetryBackend
     : public wpi::telemetry::MockTelemetryBackend {
  public:
@@ -1641,3 +1656,103 @@ TEST_CASE_METHOD(
   REQUIRE(value.has_value());
   REQUIRE(*value == 2.0);
 }
+
+TEST_CASE_METHOD(TelemetryTableTest, "TelemetryTableTest HandleLogsValues",
+                 "[telemetry]") {
+  auto& drive = wpi::telemetry::GetTable("drive");
+  wpi::telemetry::TelemetryHandle<bool> enabled{drive, "enabled"};
+  wpi::telemetry::TelemetryHandle<int32_t> count{drive, "count"};
+  wpi::telemetry::TelemetryHandle<float> ratio{drive, "ratio"};
+  wpi::telemetry::TelemetryHandle<double> speed{drive, "speed"};
+  wpi::telemetry::TelemetryHandle<std::string> mode{drive, "mode"};
+  wpi::telemetry::TelemetryHandle<std::vector<double>> wheels{drive, "wheels"};
+
+  enabled.Log(true);
+  count.Log(3);
+  ratio.Log(0.5f);
+  speed.Log(1.5);
+  mode.Log("auto");
+  wheels.Log({1.0, 2.0});
+
+  REQUIRE(Last<bool>("/drive/enabled"));
+  REQUIRE(Last<int32_t>("/drive/count") == 3);
+  REQUIRE(Last<float>("/drive/ratio") == 0.5f);
+  REQUIRE(Last<double>("/drive/speed") == 1.5);
+  auto modeValue =
+      Last<wpi::telemetry::MockTelemetryBackend::LogStringValue>("/drive/mode");
+  REQUIRE(modeValue.value == "auto");
+  REQUIRE(modeValue.typeString == "string");
+  REQUIRE(Last<std::vector<double>>("/drive/wheels") ==
+          std::vector<double>{1.0, 2.0});
+
+  wpi::telemetry::TelemetryHandle<double> empty;
+  REQUIRE_FALSE(empty);
+  empty.Log(1.0);
+}
+
+TEST_CASE_METHOD(TelemetryTableTest,
+                 "TelemetryTableTest HandleLooksUpEntryOnce", "[telemetry]") {
+  auto countingMock = std::make_shared<telemetrytest::CountingEntryBackend>();
+  wpi::telemetry::TelemetryRegistry::RegisterBackend("", countingMock);
+
+  wpi::telemetry::TelemetryHandle<double> speed{wpi::telemetry::GetTable(),
+                                                "speed"};
+  for (int i = 0; i < 10; ++i) {
+    speed.Log(i);
+  }
+  REQUIRE(countingMock->GetEntryCount() == 1);
+  REQUIRE(countingMock->GetLastValue<double>("/speed") == 9.0);
+}
+
+TEST_CASE_METHOD(TelemetryTableTest,
+                 "TelemetryTableTest HandleFollowsBackendRegistration",
+                 "[telemetry]") {
+  wpi::telemetry::TelemetryHandle<double> speed{wpi::telemetry::GetTable(),
+                                                "speed"};
+  speed.Log(1.0);
+  REQUIRE(mock->GetLastValue<double>("/speed") == 1.0);
+
+  auto replacement = std::make_shared<wpi::telemetry::MockTelemetryBackend>();
+  wpi::telemetry::TelemetryRegistry::RegisterBackend("", replacement);
+  speed.Log(2.0);
+  REQUIRE(replacement->GetLastValue<double>("/speed") == 2.0);
+
+  wpi::telemetry::TelemetryRegistry::RegisterBackend(
+      "", std::make_shared<wpi::telemetry::DiscardTelemetryBackend>());
+  speed.Log(3.0);
+  auto actions = replacement->GetActions();
+  REQUIRE(actions.size() == 1u);
+  REQUIRE(std::get<double>(actions[0].value) == 2.0);
+}
+
+TEST_CASE_METHOD(TelemetryTableTest,
+                 "TelemetryTableTest HandleStructSchemaRegisteredOnce",
+                 "[telemetry]") {
+  auto countingMock = std::make_shared<telemetrytest::CountingSchemaBackend>();
+  wpi::telemetry::TelemetryRegistry::RegisterBackend("", countingMock);
+
+  wpi::telemetry::TelemetryHandle<telemetrytest::StructPoint> point{
+      wpi::telemetry::GetTable(), "point"};
+  point.Log({1.0, 2});
+  point.Log({3.0, 4});
+  REQUIRE(countingMock->GetSchemaAddCount() == 1);
+
+  auto raw = countingMock
+                 ->GetLastValue<
+                     wpi::telemetry::MockTelemetryBackend::LogRawValue>(
+                     "/point")
+                 .value();
+  REQUIRE(raw.typeString == "struct:telemetrytest.StructPoint");
+  auto unpacked = wpi::util::UnpackStruct<telemetrytest::StructPoint>(
+      std::span<const uint8_t>{raw.value});
+  REQUIRE(unpacked.x == 3.0);
+  REQUIRE(unpacked.y == 4);
+
+  // a new backend needs the schema again
+  auto replacement = std::make_shared<telemetrytest::CountingSchemaBackend>();
+  wpi::telemetry::TelemetryRegistry::RegisterBackend("", replacement);
+  point.Log({5.0, 6});
+  REQUIRE(replacement->GetSchemaAddCount() == 1);
+  REQUIRE(replacement->GetSchema("struct:telemetrytest.StructPoint") !=
+          nullptr);
+}
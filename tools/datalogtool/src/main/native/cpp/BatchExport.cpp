@@ -0,0 +1,510 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "BatchExport.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "CsvFormat.hpp"
+#include "wpi/datalog/DataLogReader.hpp"
+#include "wpi/util/DenseMap.hpp"
+#include "wpi/util/Endian.hpp"
+#include "wpi/util/MemoryBuffer.hpp"
+#include "wpi/util/StringExtras.hpp"
+#include "wpi/util/fs.hpp"
+#include "wpi/util/json.hpp"
+#include "wpi/util/mutex.hpp"
+#include "wpi/util/print.hpp"
+#include "wpi/util/raw_ostream.hpp"
+
+namespace {
+
+enum class ExportFormat { kCsv, kColumns };
+
+struct Options {
+  fs::path outputDir{"."};
+  // 0 = list, 1 = table (same as the GUI)
+  int style = 0;
+  ExportFormat format = ExportFormat::kCsv;
+  // 0 = one per hardware thread
+  unsigned int jobs = 0;
+  bool force = false;
+  std::vector<std::string_view> files;
+};
+
+// An entry ID's state while exporting CSV
+struct CsvEntry {
+  std::string_view name;
+  CsvValueType valueType;
+  int column;
+};
+
+// One column of the columnar export. Data is buffered in memory and written
+// out once the whole log has been read.
+struct Column {
+  Column(std::string_view name, std::string_view type,
+         std::string_view metadata)
+      : name{name}, type{type}, metadata{metadata} {
+    if (type == "double" || type == "int64" || type == "int") {
+      valueSize = 8;
+    } else if (type == "float") {
+      valueSize = 4;
+    } else if (type == "boolean") {
+      valueSize = 1;
+    } else {
+      // variable size; record byte offsets of each value
+      AppendU64(offsets, 0);
+    }
+  }
+
+  static void AppendU64(std::vector<uint8_t>& out, uint64_t value) {
+    size_t pos = out.size();
+    out.resize(pos + 8);
+    wpi::util::support::endian::write64le(&out[pos], value);
+  }
+
+  std::string_view name;
+  std::string_view type;
+  std::string_view metadata;
+  // 0 if values are variable size
+  size_t valueSize = 0;
+  size_t count = 0;
+  // records with the wrong size for a fixed size type
+  size_t skipped = 0;
+  std::vector<uint8_t> timestamps;
+  std::vector<uint8_t> values;
+  std::vector<uint8_t> offsets;
+};
+
+}  // namespace
+
+static constexpr std::string_view kUsage =
+    "usage: datalogtool export [options] FILE...\n"
+    "\n"
+    "Exports each data log FILE without opening the GUI.\n"
+    "\n"
+    "options:\n"
+    "  -o, --output DIR        output directory (default: current directory)\n"
+    "  -j, --jobs N            number of logs to export in parallel\n"
+    "                          (default: number of hardware threads)\n"
+    "  --style list|table      CSV layout, as in the GUI (default: list)\n"
+    "  --format csv|columns    output format (default: csv)\n"
+    "  -f, --force             overwrite existing output\n"
+    "\n"
+    "The csv format writes STEM.csv for each log. The columns format writes a\n"
+    "STEM directory for each log containing index.json and, for each entry,\n"
+    "N.timestamps (int64 microseconds), N.values (raw little-endian values,\n"
+    "as stored in the log) and, for variable size types, N.offsets (uint64\n"
+    "byte offsets of each value into N.values, plus the end offset).\n";
+
+static std::optional<std::string> ParseArgs(std::span<char*> args,
+                                            Options* options) {
+  for (size_t i = 0; i < args.size(); ++i) {
+    std::string_view arg{args[i]};
+    auto value = [&]() -> std::optional<std::string_view> {
+      if (i + 1 >= args.size()) {
+        return std::nullopt;
+      }
+      return std::string_view{args[++i]};
+    };
+
+    if (arg == "-h" || arg == "--help") {
+      return std::string{};
+    } else if (arg == "-o" || arg == "--output") {
+      auto dir = value();
+      if (!dir) {
+        return std::format("{} requires a directory", arg);
+      }
+      options->outputDir = *dir;
+    } else if (arg == "-j" || arg == "--jobs") {
+      auto str = value();
+      std::optional<unsigned int> jobs;
+      if (str) {
+        jobs = wpi::util::parse_integer<unsigned int>(*str, 10);
+      }
+      if (!jobs || *jobs == 0) {
+        return std::format("{} requires a positive number", arg);
+      }
+      options->jobs = *jobs;
+    } else if (arg == "--style") {
+      auto style = value();
+      if (style == "list") {
+        options->style = 0;
+      } else if (style == "table") {
+        options->style = 1;
+      } else {
+        return std::format("{} must be list or table", arg);
+      }
+    } else if (arg == "--format") {
+      auto format = value();
+      if (format == "csv") {
+        options->format = ExportFormat::kCsv;
+      } else if (format == "columns") {
+        options->format = ExportFormat::kColumns;
+      } else {
+        return std::format("{} must be csv or columns", arg);
+      }
+    } else if (arg == "-f" || arg == "--force") {
+      options->force = true;
+    } else if (wpi::util::starts_with(arg, '-')) {
+      return std::format("unknown option {}", arg);
+    } else {
+      options->files.emplace_back(arg);
+    }
+  }
+  if (options->files.empty()) {
+    return "no input files";
+  }
+  return std::nullopt;
+}
+
+// Same output as the GUI export with every entry selected
+static void ExportLogCsv(const wpi::log::DataLogReader& reader,
+                         wpi::util::raw_ostream& os, int style,
+                         size_t* records) {
+  // header
+  std::map<std::string_view, int, std::less<>> columns;
+  if (style == 0) {
+    os << "Timestamp,Name,Value\n";
+  } else if (style == 1) {
+    // scan for entry names to print header and assign columns
+    for (auto&& record : reader) {
+      wpi::log::StartRecordData data;
+      if (record.IsStart() && record.GetStartData(&data)) {
+        columns.try_emplace(data.name, 0);
+      }
+    }
+    os << "Timestamp";
+    int columnNum = 0;
+    for (auto&& column : columns) {
+      os << ',' << '"';
+      PrintEscapedCsvString(os, column.first);
+      os << '"';
+      column.second = columnNum++;
+    }
+    os << '\n';
+  }
+
+  wpi::util::DenseMap<int, CsvEntry> entries;
+  for (auto&& record : reader) {
+    if (record.IsStart()) {
+      wpi::log::StartRecordData data;
+      if (record.GetStartData(&data)) {
+        auto column = columns.find(data.name);
+        entries[data.entry] = {
+            data.name, GetCsvValueType(data.name, data.type),
+            column != columns.end() ? column->second : -1};
+      }
+    } else if (record.IsFinish()) {
+      int entry;
+      if (record.GetFinishEntry(&entry)) {
+        entries.erase(entry);
+      }
+    } else if (!record.IsControl()) {
+      auto entryIt = entries.find(record.GetEntry());
+      if (entryIt == entries.end()) {
+        continue;
+      }
+      auto& entry = entryIt->second;
+
+      if (style == 0) {
+        PrintCsvTimestamp(os, record.GetTimestamp());
+        os << ',' << '"';
+        PrintEscapedCsvString(os, entry.name);
+        os << '"' << ',';
+        ValueToCsv(os, entry.valueType, record);
+        os << '\n';
+      } else if (style == 1 && entry.column != -1) {
+        PrintCsvTimestamp(os, record.GetTimestamp());
+        os << ',';
+        for (int i = 0; i < entry.column; ++i) {
+          os << ',';
+        }
+        ValueToCsv(os, entry.valueType, record);
+        os << '\n';
+      }
+      ++*records;
+    }
+  }
+}
+
+static std::error_code WriteFile(const fs::path& path,
+                                 std::span<const uint8_t> data,
+                                 fs::CreationDisposition disposition) {
+  std::error_code ec;
+  auto f = fs::OpenFileForWrite(path, ec, disposition, fs::OF_None);
+  if (ec) {
+    return ec;
+  }
+  wpi::util::raw_fd_ostream os{fs::FileToFd(f, ec, fs::OF_None), true, true};
+  os << data;
+  os.close();
+  ec = os.error();
+  os.clear_error();
+  return ec;
+}
+
+// Removes the files of a previous columnar export, so a log with fewer
+// entries doesn't leave stale columns behind
+static std::error_code RemoveColumnFiles(const fs::path& dir) {
+  std::error_code ec;
+  std::vector<fs::path> paths;
+  for (auto&& entry : fs::directory_iterator{dir, ec}) {
+    auto name = entry.path().filename().string();
+    auto [column, suffix] = wpi::util::split(name, '.');
+    if (name == "index.json" ||
+        (wpi::util::parse_integer<size_t>(column, 10) &&
+         (suffix == "timestamps" || suffix == "values" ||
+          suffix == "offsets"))) {
+      paths.emplace_back(entry.path());
+    }
+  }
+  for (auto&& path : paths) {
+    if (!ec) {
+      fs::remove(path, ec);
+    }
+  }
+  return ec;
+}
+
+static std::string ExportLogColumns(const wpi::log::DataLogReader& reader,
+                                    const fs::path& dir, bool force,
+                                    size_t* records) {
+  std::error_code ec;
+  if (!fs::create_directory(dir, ec) && !ec) {
+    if (!force) {
+      return std::format("{} already exists", dir.string());
+    }
+    ec = RemoveColumnFiles(dir);
+  }
+  if (ec) {
+    return std::format("{}: {}", dir.string(), ec.message());
+  }
+
+  std::vector<Column> columns;
+  std::map<std::pair<std::string_view, std::string_view>, size_t> columnIds;
+  wpi::util::DenseMap<int, size_t> entries;
+  for (auto&& record : reader) {
+    if (record.IsStart()) {
+      wpi::log::StartRecordData data;
+      if (record.GetStartData(&data)) {
+        auto [it, isNew] =
+            columnIds.try_emplace({data.name, data.type}, columns.size());
+        if (isNew) {
+          columns.emplace_back(data.name, data.type, data.metadata);
+        }
+        entries[data.entry] = it->second;
+      }
+    } else if (record.IsFinish()) {
+      int entry;
+      if (record.GetFinishEntry(&entry)) {
+        entries.erase(entry);
+      }
+    } else if (record.IsSetMetadata()) {
+      wpi::log::MetadataRecordData data;
+      if (record.GetSetMetadataData(&data)) {
+        auto entryIt = entries.find(data.entry);
+        if (entryIt != entries.end()) {
+          columns[entryIt->second].metadata = data.metadata;
+        }
+      }
+    } else if (!record.IsControl()) {
+      auto entryIt = entries.find(record.GetEntry());
+      if (entryIt == entries.end()) {
+        continue;
+      }
+      auto& column = columns[entryIt->second];
+      auto data = record.GetRaw();
+      if (column.valueSize != 0 && data.size() != column.valueSize) {
+        ++column.skipped;
+        continue;
+      }
+      Column::AppendU64(column.timestamps, record.GetTimestamp());
+      column.values.insert(column.values.end(), data.begin(), data.end());
+      if (column.valueSize == 0) {
+        Column::AppendU64(column.offsets, column.values.size());
+      }
+      ++column.count;
+      ++*records;
+    }
+  }
+
+  auto disposition = force ? fs::CD_CreateAlways : fs::CD_CreateNew;
+  auto index = wpi::util::json::array();
+  for (size_t i = 0; i < columns.size(); ++i) {
+    auto& column = columns[i];
+    auto info = wpi::util::json::object(
+        "name", column.name, "type", column.type, "metadata", column.metadata,
+        "count", column.count, "timestamps", std::format("{}.timestamps", i),
+        "values", std::format("{}.values", i));
+    if (column.valueSize == 0) {
+      info["offsets"] = std::format("{}.offsets", i);
+    }
+    if (column.skipped != 0) {
+      info["skipped"] = column.skipped;
+    }
+    index.get_array().emplace_back(std::move(info));
+
+    for (auto&& [suffix, data] :
+         {std::pair{"timestamps", std::span<const uint8_t>{column.timestamps}},
+          std::pair{"values", std::span<const uint8_t>{column.values}},
+          std::pair{"offsets", std::span<const uint8_t>{column.offsets}}}) {
+      if (data.empty() && column.valueSize != 0 &&
+          std::string_view{suffix} == "offsets") {
+        continue;
+      }
+      auto path = dir / std::format("{}.{}", i, suffix);
+      if (auto ec = WriteFile(path, data, disposition)) {
+        return std::format("{}: {}", path.string(), ec.message());
+      }
+    }
+  }
+
+  std::string indexStr =
+      wpi::util::json::object("source", reader.GetBufferIdentifier(),
+                              "columns", std::move(index))
+          .to_string();
+  auto path = dir / "index.json";
+  if (auto ec = WriteFile(
+          path,
+          {reinterpret_cast<const uint8_t*>(indexStr.data()), indexStr.size()},
+          disposition)) {
+    return std::format("{}: {}", path.string(), ec.message());
+  }
+  return {};
+}
+
+// The file or directory a log is exported to
+static fs::path GetOutputPath(std::string_view filename,
+                              const Options& options) {
+  fs::path stem = fs::path{filename}.stem();
+  if (options.format == ExportFormat::kCsv) {
+    stem.replace_extension("csv");
+  }
+  return options.outputDir / stem;
+}
+
+// Returns an error message, or an empty string on success
+static std::string ExportFile(std::string_view filename,
+                              const Options& options, size_t* records) {
+  auto fileBuffer = wpi::util::MemoryBuffer::GetFile(filename);
+  if (!fileBuffer) {
+    return std::format("Could not open file: {}",
+                       fileBuffer.error().message());
+  }
+  wpi::log::DataLogReader reader{std::move(*fileBuffer)};
+  if (!reader.IsValid()) {
+    return "Not a valid datalog file";
+  }
+
+  auto path = GetOutputPath(filename, options);
+  if (options.format == ExportFormat::kColumns) {
+    return ExportLogColumns(reader, path, options.force, records);
+  }
+
+  std::error_code ec;
+  auto of = fs::OpenFileForWrite(
+      path, ec, options.force ? fs::CD_CreateAlways : fs::CD_CreateNew,
+      fs::OF_Text);
+  if (ec) {
+    return ec.message();
+  }
+  wpi::util::raw_fd_ostream os{fs::FileToFd(of, ec, fs::OF_Text), true};
+  os.SetBufferSize(kCsvBufferSize);
+  ExportLogCsv(reader, os, options.style, records);
+  os.close();
+  if (os.has_error()) {
+    auto msg = os.error().message();
+    os.clear_error();
+    return msg;
+  }
+  return {};
+}
+
+int RunBatchExport(std::span<char*> args) {
+  Options options;
+  if (auto err = ParseArgs(args, &options)) {
+    if (err->empty()) {
+      wpi::util::print("{}", kUsage);
+      return 0;
+    }
+    wpi::util::print(stderr, "datalogtool export: {}\n\n{}", *err, kUsage);
+    return 2;
+  }
+
+  // Logs from different directories can have the same name. Check before
+  // starting, as parallel exports to the same output would interleave.
+  std::map<fs::path, std::string_view> outputs;
+  for (auto filename : options.files) {
+    auto [it, isNew] =
+        outputs.try_emplace(GetOutputPath(filename, options), filename);
+    if (!isNew) {
+      wpi::util::print(stderr,
+                       "datalogtool export: {} and {} would both be exported "
+                       "to {}; export them to different output directories\n",
+                       it->second, filename, it->first.string());
+      return 2;
+    }
+  }
+
+  unsigned int jobs = options.jobs;
+  if (jobs == 0) {
+    jobs = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  jobs = std::min<size_t>(jobs, options.files.size());
+
+  // each worker takes the next file until none are left
+  std::atomic_size_t next{0};
+  int failures = 0;
+  wpi::util::mutex printMutex;
+  auto worker = [&] {
+    for (size_t i; (i = next++) < options.files.size();) {
+      auto filename = options.files[i];
+      auto start = std::chrono::steady_clock::now();
+      size_t records = 0;
+      auto err = ExportFile(filename, options, &records);
+      std::chrono::duration<double, std::milli> time =
+          std::chrono::steady_clock::now() - start;
+
+      std::scoped_lock lock{printMutex};
+      if (err.empty()) {
+        wpi::util::print("{}: {} records in {:.1f} ms\n", filename, records,
+                         time.count());
+      } else {
+        wpi::util::print(stderr, "{}: {}\n", filename, err);
+        ++failures;
+      }
+    }
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < jobs; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto&& thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+  wpi::util::print("exported {} of {} files in {:.3f} s using {} jobs\n",
+                   options.files.size() - failures, options.files.size(),
+                   time.count(), jobs);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,11 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <span>
+
+// Runs the headless "export" command with the arguments that follow it.
+// Returns the process exit code.
+int RunBatchExport(std::span<char*> args);
@@ -0,0 +1,187 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "CsvFormat.hpp"
+
+#include <stdint.h>
+
+#include <charconv>
+#include <chrono>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "wpi/datalog/DataLogReader.hpp"
+#include "wpi/util/StringExtras.hpp"
+#include "wpi/util/fmt/raw_ostream.hpp"
+#include "wpi/util/print.hpp"
+#include "wpi/util/raw_ostream.hpp"
+
+// std::to_chars produces the same shortest round-trip output as "{}", without
+// going through a format string and a temporary string for every value
+template <typename T>
+static void PrintNumber(wpi::util::raw_ostream& os, T value) {
+  char buf[32];
+  auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+  os.write(buf, end - buf);
+}
+
+template <typename T>
+static void PrintNumberArray(wpi::util::raw_ostream& os,
+                             std::span<const T> arr) {
+  bool first = true;
+  for (auto&& v : arr) {
+    if (!first) {
+      os << ';';
+    }
+    first = false;
+    PrintNumber(os, v);
+  }
+}
+
+CsvValueType GetCsvValueType(std::string_view name, std::string_view type) {
+  // handle systemTime specially
+  if (name == "systemTime" && type == "int64") {
+    return CsvValueType::kSystemTime;
+  } else if (type == "double") {
+    return CsvValueType::kDouble;
+  } else if (type == "int64" || type == "int") {
+    // support "int" for compatibility with old NT4 datalogs
+    return CsvValueType::kInteger;
+  } else if (type == "string" || type == "json") {
+    return CsvValueType::kString;
+  } else if (type == "boolean") {
+    return CsvValueType::kBoolean;
+  } else if (type == "boolean[]") {
+    return CsvValueType::kBooleanArray;
+  } else if (type == "double[]") {
+    return CsvValueType::kDoubleArray;
+  } else if (type == "float[]") {
+    return CsvValueType::kFloatArray;
+  } else if (type == "int64[]") {
+    return CsvValueType::kIntegerArray;
+  } else if (type == "string[]") {
+    return CsvValueType::kStringArray;
+  } else {
+    return CsvValueType::kInvalid;
+  }
+}
+
+void PrintEscapedCsvString(wpi::util::raw_ostream& os, std::string_view str) {
+  auto s = str;
+  while (!s.empty()) {
+    std::string_view fragment;
+    std::tie(fragment, s) = wpi::util::split(s, '"');
+    os << fragment;
+    if (!s.empty()) {
+      os << '"' << '"';
+    }
+  }
+  if (wpi::util::ends_with(str, '"')) {
+    os << '"' << '"';
+  }
+}
+
+void PrintCsvTimestamp(wpi::util::raw_ostream& os, int64_t timestamp) {
+  PrintNumber(os, timestamp / 1000000.0);
+}
+
+void ValueToCsv(wpi::util::raw_ostream& os, CsvValueType type,
+                const wpi::log::DataLogRecord& record) {
+  // reused between records to avoid allocating for every array
+  thread_local std::vector<int> boolArr;
+  thread_local std::vector<double> doubleArr;
+  thread_local std::vector<float> floatArr;
+  thread_local std::vector<int64_t> intArr;
+  thread_local std::vector<std::string_view> stringArr;
+
+  switch (type) {
+    case CsvValueType::kSystemTime: {
+      int64_t val;
+      if (record.GetInteger(&val)) {
+        auto timeval = std::chrono::system_clock::time_point(
+            std::chrono::microseconds(val));
+        wpi::util::print(os, "{:%Y-%m-%d %H:%M:%OS}.{:06}", timeval,
+                         val % 1000000);
+        return;
+      }
+      break;
+    }
+    case CsvValueType::kDouble: {
+      double val;
+      if (record.GetDouble(&val)) {
+        PrintNumber(os, val);
+        return;
+      }
+      break;
+    }
+    case CsvValueType::kInteger: {
+      int64_t val;
+      if (record.GetInteger(&val)) {
+        PrintNumber(os, val);
+        return;
+      }
+      break;
+    }
+    case CsvValueType::kString: {
+      std::string_view val;
+      record.GetString(&val);
+      os << '"';
+      PrintEscapedCsvString(os, val);
+      os << '"';
+      return;
+    }
+    case CsvValueType::kBoolean: {
+      bool val;
+      if (record.GetBoolean(&val)) {
+        os << (val ? "true" : "false");
+        return;
+      }
+      break;
+    }
+    case CsvValueType::kBooleanArray:
+      if (record.GetBooleanArray(&boolArr)) {
+        PrintNumberArray<int>(os, boolArr);
+        return;
+      }
+      break;
+    case CsvValueType::kDoubleArray:
+      if (record.GetDoubleArray(&doubleArr)) {
+        PrintNumberArray<double>(os, doubleArr);
+        return;
+      }
+      break;
+    case CsvValueType::kFloatArray:
+      if (record.GetFloatArray(&floatArr)) {
+        PrintNumberArray<float>(os, floatArr);
+        return;
+      }
+      break;
+    case CsvValueType::kIntegerArray:
+      if (record.GetIntegerArray(&intArr)) {
+        PrintNumberArray<int64_t>(os, intArr);
+        return;
+      }
+      break;
+    case CsvValueType::kStringArray:
+      if (record.GetStringArray(&stringArr)) {
+        os << '"';
+        bool first = true;
+        for (auto&& v : stringArr) {
+          if (!first) {
+            os << ';';
+          }
+          first = false;
+          PrintEscapedCsvString(os, v);
+        }
+        os << '"';
+        return;
+      }
+      break;
+    case CsvValueType::kInvalid:
+      break;
+  }
+  os << "<invalid>";
+}
@@ -0,0 +1,48 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string_view>
+
+namespace wpi::log {
+class DataLogRecord;
+}  // namespace wpi::log
+
+namespace wpi::util {
+class raw_ostream;
+}  // namespace wpi::util
+
+// Output buffer size for exported files; large writes are much faster than
+// the default buffer size when exporting large logs
+inline constexpr size_t kCsvBufferSize = 1024 * 1024;
+
+// How an entry's values are formatted in CSV output. Determined once per
+// entry so records don't need to compare type strings.
+enum class CsvValueType {
+  kInvalid,
+  kSystemTime,
+  kDouble,
+  kInteger,
+  kString,
+  kBoolean,
+  kBooleanArray,
+  kDoubleArray,
+  kFloatArray,
+  kIntegerArray,
+  kStringArray
+};
+
+CsvValueType GetCsvValueType(std::string_view name, std::string_view type);
+
+void PrintEscapedCsvString(wpi::util::raw_ostream& os, std::string_view str);
+
+// Prints a record timestamp (in microseconds) as seconds
+void PrintCsvTimestamp(wpi::util::raw_ostream& os, int64_t timestamp);
+
+void ValueToCsv(wpi::util::raw_ostream& os, CsvValueType type,
+                const wpi::log::DataLogRecord& record);
@@ -7,7 +7,6 @@
 #include <stdint.h>
 
 #include <atomic>
-#include <chrono>
 #include <format>
 #include <functional>
 #include <future>
@@ -25,6 +24,7 @@
 #include <imgui_stdlib.h>
 
 #include "App.hpp"
+#include "CsvFormat.hpp"
 #include "wpi/datalog/DataLogReaderThread.hpp"
 #include "wpi/glass/Storage.hpp"
 #include "wpi/gui/portable-file-dialogs.h"
@@ -33,10 +33,8 @@
 #include "wpi/util/SmallVector.hpp"
 #include "wpi/util/SpanExtras.hpp"
 #include "wpi/util/StringExtras.hpp"
-#include "wpi/util/fmt/raw_ostream.hpp"
 #include "wpi/util/fs.hpp"
 #include "wpi/util/mutex.hpp"
-#include "wpi/util/print.hpp"
 #include "wpi/util/raw_ostream.hpp"
 
 namespace {
@@ -59,11 +57,15 @@ struct InputFile {
 
 struct Entry {
   explicit Entry(const wpi::log::StartRecordData& srd)
-      : name{srd.name}, type{srd.type}, metadata{srd.metadata} {}
+      : name{srd.name},
+        type{srd.type},
+        metadata{srd.metadata},
+        valueType{GetCsvValueType(srd.name, srd.type)} {}
 
   std::string name;
   std::string type;
   std::string metadata;
+  CsvValueType valueType;
   std::set<InputFile*> inputFiles;
   bool typeConflict = false;
   bool metadataConflict = false;
@@ -441,103 +443,6 @@ void DisplayEntries() {
 static wpi::util::mutex gExportMutex;
 static std::vector<std::string> gExportErrors;
 
-static void PrintEscapedCsvString(wpi::util::raw_ostream& os,
-                                  std::string_view str) {
-  auto s = str;
-  while (!s.empty()) {
-    std::string_view fragment;
-    std::tie(fragment, s) = wpi::util::split(s, '"');
-    os << fragment;
-    if (!s.empty()) {
-      os << '"' << '"';
-    }
-  }
-  if (wpi::util::ends_with(str, '"')) {
-    os << '"' << '"';
-  }
-}
-
-static void ValueToCsv(wpi::util::raw_ostream& os, const Entry& entry,
-                       const wpi::log::DataLogRecord& record) {
-  // handle systemTime specially
-  if (entry.name == "systemTime" && entry.type == "int64") {
-    int64_t val;
-    if (record.GetInteger(&val)) {
-      auto timeval =
-          std::chrono::system_clock::time_point(std::chrono::microseconds(val));
-      wpi::util::print(os, "{:%Y-%m-%d %H:%M:%OS}.{:06}", timeval,
-                       val % 1000000);
-      return;
-    }
-  } else if (entry.type == "double") {
-    double val;
-    if (record.GetDouble(&val)) {
-      wpi::util::print(os, "{}", val);
-      return;
-    }
-  } else if (entry.type == "int64" || entry.type == "int") {
-    // support "int" for compatibility with old NT4 datalogs
-    int64_t val;
-    if (record.GetInteger(&val)) {
-      wpi::util::print(os, "{}", val);
-      return;
-    }
-  } else if (entry.type == "string" || entry.type == "json") {
-    std::string_view val;
-    record.GetString(&val);
-    os << '"';
-    PrintEscapedCsvString(os, val);
-    os << '"';
-    return;
-  } else if (entry.type == "boolean") {
-    bool val;
-    if (record.GetBoolean(&val)) {
-      wpi::util::print(os, "{}", val);
-      return;
-    }
-  } else if (entry.type == "boolean[]") {
-    std::vector<int> val;
-    if (record.GetBooleanArray(&val)) {
-      wpi::util::print(os, "{}", wpi::util::join(val, ";"));
-      return;
-    }
-  } else if (entry.type == "double[]") {
-    std::vector<double> val;
-    if (record.GetDoubleArray(&val)) {
-      wpi::util::print(os, "{}", wpi::util::join(val, ";"));
-      return;
-    }
-  } else if (entry.type == "float[]") {
-    std::vector<float> val;
-    if (record.GetFloatArray(&val)) {
-      wpi::util::print(os, "{}", wpi::util::join(val, ";"));
-      return;
-    }
-  } else if (entry.type == "int64[]") {
-    std::vector<int64_t> val;
-    if (record.GetIntegerArray(&val)) {
-      wpi::util::print(os, "{}", wpi::util::join(val, ";"));
-      return;
-    }
-  } else if (entry.type == "string[]") {
-    std::vector<std::string_view> val;
-    if (record.GetStringArray(&val)) {
-      os << '"';
-      bool first = true;
-      for (auto&& v : val) {
-        if (!first) {
-          os << ';';
-        }
-        first = false;
-        PrintEscapedCsvString(os, v);
-      }
-      os << '"';
-      return;
-    }
-  }
-  wpi::util::print(os, "<invalid>");
-}
-
 static void ExportCsvFile(InputFile& f, wpi::util::raw_ostream& os, int style) {
   // header
   if (style == 0) {
@@ -583,17 +488,19 @@ static void ExportCsvFile(InputFile& f, wpi::util::raw_ostream& os, int style) {
       Entry* entry = entryIt->second;
 
       if (style == 0) {
-        wpi::util::print(os, "{},\"", record.GetTimestamp() / 1000000.0);
+        PrintCsvTimestamp(os, record.GetTimestamp());
+        os << ',' << '"';
         PrintEscapedCsvString(os, entry->name);
         os << '"' << ',';
-        ValueToCsv(os, *entry, record);
+        ValueToCsv(os, entry->valueType, record);
         os << '\n';
       } else if (style == 1 && entry->column != -1) {
-        wpi::util::print(os, "{},", record.GetTimestamp() / 1000000.0);
+        PrintCsvTimestamp(os, record.GetTimestamp());
+        os << ',';
         for (int i = 0; i < entry->column; ++i) {
           os << ',';
         }
-        ValueToCsv(os, *entry, record);
+        ValueToCsv(os, entry->valueType, record);
         os << '\n';
       }
     }
@@ -616,6 +523,7 @@ static void ExportCsv(std::string_view outputFolder, int style) {
         continue;
       }
       wpi::util::raw_fd_ostream os{fs::FileToFd(of, ec, fs::OF_Text), true};
+      os.SetBufferSize(kCsvBufferSize);
       ExportCsvFile(*f.second, os, style);
     }
     ++gExportCount;
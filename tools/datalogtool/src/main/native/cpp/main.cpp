@@ -4,6 +4,10 @@
 
 #include <string_view>
 
+#include "BatchExport.hpp"
+
+#ifndef RUNNING_DATALOGTOOL_TESTS
+
 void Application(std::string_view saveDir);
 
 #ifdef _WIN32
@@ -14,6 +18,10 @@ int __stdcall WinMain(void* hInstance, void* hPrevInstance, char* pCmdLine,
 #else
 int main(int argc, char** argv) {
 #endif
+  if (argc >= 2 && std::string_view{argv[1]} == "export") {
+    return RunBatchExport({argv + 2, argv + argc});
+  }
+
   std::string_view saveDir;
   if (argc == 2) {
     saveDir = argv[1];
@@ -23,3 +31,5 @@ int main(int argc, char** argv) {
 
   return 0;
 }
+
+#endif
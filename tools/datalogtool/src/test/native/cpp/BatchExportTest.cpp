@@ -0,0 +1,186 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "BatchExport.hpp"
+
+#include <stdint.h>
+
+#include <chrono>
+#include <format>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "wpi/datalog/DataLogWriter.hpp"
+#include "wpi/util/MemoryBuffer.hpp"
+#include "wpi/util/fs.hpp"
+#include "wpi/util/json.hpp"
+
+namespace {
+class BatchExportTest {
+ public:
+  BatchExportTest() {
+    static int count = 0;
+    m_dir = fs::temp_directory_path() /
+            std::format("wpi_datalogtool_test_{}_{}",
+                        std::chrono::steady_clock::now()
+                            .time_since_epoch()
+                            .count(),
+                        count++);
+    fs::create_directories(m_dir);
+  }
+
+  ~BatchExportTest() {
+    std::error_code ec;
+    fs::remove_all(m_dir, ec);
+  }
+
+  // Writes a log with a double entry "/a" and a string entry "/b"
+  std::string WriteLog(std::string_view name, bool withB = true) {
+    auto path = m_dir / name;
+    fs::create_directories(path.parent_path());
+    std::error_code ec;
+    wpi::log::DataLogWriter log{path.string(), ec};
+    REQUIRE(!ec);
+    int a = log.Start("/a", "double", "meta", 1);
+    log.AppendDouble(a, 1.5, 1000000);
+    if (withB) {
+      int b = log.Start("/b", "string", {}, 1);
+      log.AppendString(b, "x\"y", 2000000);
+    }
+    log.AppendDouble(a, -2, 2500000);
+    return path.string();
+  }
+
+  int Run(std::initializer_list<std::string_view> args) {
+    std::vector<std::string> strs{args.begin(), args.end()};
+    std::vector<char*> argv;
+    for (auto&& str : strs) {
+      argv.emplace_back(str.data());
+    }
+    return RunBatchExport(argv);
+  }
+
+  std::string Read(const fs::path& path) {
+    auto buf = wpi::util::MemoryBuffer::GetFile(path.string());
+    REQUIRE(buf);
+    auto data = (*buf)->GetCharBuffer();
+    return {data.data(), data.size()};
+  }
+
+  std::string Out() const { return (m_dir / "out").string(); }
+
+ protected:
+  fs::path m_dir;
+};
+}  // namespace
+
+TEST_CASE_METHOD(BatchExportTest, "BatchExportTest Options",
+                 "[datalogtool]") {
+  auto log = WriteLog("FRC_1.wpilog");
+  CHECK(Run({"--help"}) == 0);
+  CHECK(Run({}) == 2);
+  CHECK(Run({"-o", Out()}) == 2);
+  CHECK(Run({log, "-o"}) == 2);
+  CHECK(Run({log, "-j", "0"}) == 2);
+  CHECK(Run({log, "--jobs", "x"}) == 2);
+  CHECK(Run({log, "--style", "grid"}) == 2);
+  CHECK(Run({log, "--format", "json"}) == 2);
+  CHECK(Run({log, "--bogus"}) == 2);
+  CHECK(!fs::exists(m_dir / "FRC_1.csv"));
+  CHECK(!fs::exists(Out()));
+}
+
+TEST_CASE_METHOD(BatchExportTest, "BatchExportTest CsvList", "[datalogtool]") {
+  auto log = WriteLog("FRC_1.wpilog");
+  fs::create_directory(Out());
+  REQUIRE(Run({"-o", Out(), log}) == 0);
+  CHECK(Read(m_dir / "out" / "FRC_1.csv") ==
+        "Timestamp,Name,Value\n"
+        "1,\"/a\",1.5\n"
+        "2,\"/b\",\"x\"\"y\"\n"
+        "2.5,\"/a\",-2\n");
+}
+
+TEST_CASE_METHOD(BatchExportTest, "BatchExportTest CsvTable", "[datalogtool]") {
+  auto log = WriteLog("FRC_1.wpilog");
+  fs::create_directory(Out());
+  REQUIRE(Run({"--style", "table", "-o", Out(), log}) == 0);
+  CHECK(Read(m_dir / "out" / "FRC_1.csv") ==
+        "Timestamp,\"/a\",\"/b\"\n"
+        "1,1.5\n"
+        "2,,\"x\"\"y\"\n"
+        "2.5,-2\n");
+}
+
+TEST_CASE_METHOD(BatchExportTest, "BatchExportTest Force", "[datalogtool]") {
+  auto log = WriteLog("FRC_1.wpilog");
+  fs::create_directory(Out());
+  REQUIRE(Run({"-o", Out(), log}) == 0);
+  CHECK(Run({"-o", Out(), log}) == 1);
+  CHECK(Run({"-f", "-o", Out(), log}) == 0);
+}
+
+TEST_CASE_METHOD(BatchExportTest, "BatchExportTest Columns", "[datalogtool]") {
+  auto log = WriteLog("FRC_1.wpilog");
+  fs::create_directory(Out());
+  REQUIRE(Run({"--format", "columns", "-o", Out(), log}) == 0);
+
+  auto dir = m_dir / "out" / "FRC_1";
+  auto index = wpi::util::json::parse_or_throw(Read(dir / "index.json"));
+  CHECK(index["source"].get_string() == log);
+  auto& columns = index["columns"];
+  REQUIRE(columns.get_array().size() == 2);
+
+  CHECK(columns[0]["name"].get_string() == "/a");
+  CHECK(columns[0]["type"].get_string() == "double");
+  CHECK(columns[0]["metadata"].get_string() == "meta");
+  CHECK(columns[0]["count"].get_int() == 2);
+  CHECK(!columns[0].contains("offsets"));
+  CHECK(Read(dir / "0.timestamps").size() == 16);
+  CHECK(Read(dir / "0.values").size() == 16);
+  CHECK(!fs::exists(dir / "0.offsets"));
+
+  CHECK(columns[1]["name"].get_string() == "/b");
+  CHECK(columns[1]["count"].get_int() == 1);
+  CHECK(columns[1]["offsets"].get_string() == "1.offsets");
+  CHECK(Read(dir / "1.values") == "x\"y");
+  CHECK(Read(dir / "1.offsets") ==
+        std::string_view{"\0\0\0\0\0\0\0\0\3\0\0\0\0\0\0\0", 16});
+}
+
+TEST_CASE_METHOD(BatchExportTest, "BatchExportTest ColumnsForceRemovesStale",
+                 "[datalogtool]") {
+  auto log = WriteLog("FRC_1.wpilog");
+  fs::create_directory(Out());
+  REQUIRE(Run({"--format", "columns", "-o", Out(), log}) == 0);
+  auto dir = m_dir / "out" / "FRC_1";
+  REQUIRE(fs::exists(dir / "1.values"));
+
+  CHECK(Run({"--format", "columns", "-o", Out(), log}) == 1);
+
+  WriteLog("FRC_1.wpilog", false);
+  REQUIRE(Run({"-f", "--format", "columns", "-o", Out(), log}) == 0);
+  CHECK(fs::exists(dir / "0.values"));
+  CHECK(!fs::exists(dir / "1.timestamps"));
+  CHECK(!fs::exists(dir / "1.values"));
+  CHECK(!fs::exists(dir / "1.offsets"));
+}
+
+TEST_CASE_METHOD(BatchExportTest, "BatchExportTest NameCollision",
+                 "[datalogtool]") {
+  auto log1 = WriteLog("a/FRC_1.wpilog");
+  auto log2 = WriteLog("b/FRC_1.wpilog");
+  auto log3 = WriteLog("b/FRC_2.wpilog");
+  fs::create_directory(Out());
+  CHECK(Run({"-o", Out(), log1, log3, log2}) == 2);
+  CHECK(fs::is_empty(Out()));
+  CHECK(Run({"--format", "columns", "-o", Out(), log1, log2}) == 2);
+  CHECK(fs::is_empty(Out()));
+  CHECK(Run({"-o", Out(), log1, log3}) == 0);
+}
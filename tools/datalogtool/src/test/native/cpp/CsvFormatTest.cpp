@@ -0,0 +1,142 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "CsvFormat.hpp"
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "wpi/datalog/DataLogReader.hpp"
+#include "wpi/datalog/DataLogWriter.hpp"
+#include "wpi/util/MemoryBuffer.hpp"
+#include "wpi/util/raw_ostream.hpp"
+
+namespace {
+// Logs one value with append and returns it formatted as CSV
+template <typename F>
+std::string FormatValue(std::string_view name, std::string_view type,
+                        F&& append) {
+  std::vector<uint8_t> data;
+  {
+    wpi::log::DataLogWriter writer{
+        std::make_unique<wpi::util::raw_uvector_ostream>(data)};
+    append(writer, writer.Start(name, type, {}, 1));
+  }
+
+  wpi::log::DataLogReader reader{
+      wpi::util::MemoryBuffer::GetMemBufferCopy(data, "csv-format")};
+  std::string out;
+  wpi::util::raw_string_ostream os{out};
+  for (auto&& record : reader) {
+    if (!record.IsControl()) {
+      ValueToCsv(os, GetCsvValueType(name, type), record);
+    }
+  }
+  os.flush();
+  return out;
+}
+
+std::string Escape(std::string_view str) {
+  std::string out;
+  wpi::util::raw_string_ostream os{out};
+  PrintEscapedCsvString(os, str);
+  os.flush();
+  return out;
+}
+
+std::string Timestamp(int64_t timestamp) {
+  std::string out;
+  wpi::util::raw_string_ostream os{out};
+  PrintCsvTimestamp(os, timestamp);
+  os.flush();
+  return out;
+}
+}  // namespace
+
+TEST_CASE("CsvFormatTest EscapedString", "[datalogtool]") {
+  CHECK(Escape("") == "");
+  CHECK(Escape("plain, text") == "plain, text");
+  CHECK(Escape("a\"b") == "a\"\"b");
+  CHECK(Escape("\"") == "\"\"");
+  CHECK(Escape("\"quoted\"") == "\"\"quoted\"\"");
+  CHECK(Escape("a\"\"b") == "a\"\"\"\"b");
+}
+
+TEST_CASE("CsvFormatTest Timestamp", "[datalogtool]") {
+  CHECK(Timestamp(0) == "0");
+  CHECK(Timestamp(1000000) == "1");
+  CHECK(Timestamp(1500) == "0.0015");
+  CHECK(Timestamp(-2000000) == "-2");
+}
+
+TEST_CASE("CsvFormatTest ValueType", "[datalogtool]") {
+  CHECK(GetCsvValueType("systemTime", "int64") == CsvValueType::kSystemTime);
+  CHECK(GetCsvValueType("/a", "int64") == CsvValueType::kInteger);
+  CHECK(GetCsvValueType("/a", "int") == CsvValueType::kInteger);
+  CHECK(GetCsvValueType("/a", "double") == CsvValueType::kDouble);
+  CHECK(GetCsvValueType("/a", "json") == CsvValueType::kString);
+  CHECK(GetCsvValueType("/a", "boolean[]") == CsvValueType::kBooleanArray);
+  CHECK(GetCsvValueType("/a", "string[]") == CsvValueType::kStringArray);
+  CHECK(GetCsvValueType("/a", "raw") == CsvValueType::kInvalid);
+  CHECK(GetCsvValueType("/a", "float") == CsvValueType::kInvalid);
+}
+
+TEST_CASE("CsvFormatTest Scalars", "[datalogtool]") {
+  CHECK(FormatValue("/d", "double", [](auto& log, int entry) {
+          log.AppendDouble(entry, 0.1, 2);
+        }) == "0.1");
+  CHECK(FormatValue("/i", "int64", [](auto& log, int entry) {
+          log.AppendInteger(entry, -42, 2);
+        }) == "-42");
+  CHECK(FormatValue("/b", "boolean", [](auto& log, int entry) {
+          log.AppendBoolean(entry, true, 2);
+        }) == "true");
+  CHECK(FormatValue("systemTime", "int64", [](auto& log, int entry) {
+          log.AppendInteger(entry, 1000000000000001, 2);
+        }) == "2001-09-09 01:46:40.000001");
+}
+
+TEST_CASE("CsvFormatTest Strings", "[datalogtool]") {
+  CHECK(FormatValue("/s", "string", [](auto& log, int entry) {
+          log.AppendString(entry, "say \"hi\", twice", 2);
+        }) == "\"say \"\"hi\"\", twice\"");
+  CHECK(FormatValue("/s", "string", [](auto& log, int entry) {
+          log.AppendString(entry, "", 2);
+        }) == "\"\"");
+}
+
+TEST_CASE("CsvFormatTest Arrays", "[datalogtool]") {
+  CHECK(FormatValue("/b", "boolean[]", [](auto& log, int entry) {
+          log.AppendBooleanArray(entry, std::vector<int>{1, 0, 1}, 2);
+        }) == "1;0;1");
+  CHECK(FormatValue("/d", "double[]", [](auto& log, int entry) {
+          log.AppendDoubleArray(entry, std::vector<double>{1.5, -2}, 2);
+        }) == "1.5;-2");
+  CHECK(FormatValue("/f", "float[]", [](auto& log, int entry) {
+          log.AppendFloatArray(entry, std::vector<float>{0.25f}, 2);
+        }) == "0.25");
+  CHECK(FormatValue("/i", "int64[]", [](auto& log, int entry) {
+          log.AppendIntegerArray(entry, std::vector<int64_t>{}, 2);
+        }) == "");
+  CHECK(FormatValue("/s", "string[]", [](auto& log, int entry) {
+          log.AppendStringArray(
+              entry, std::vector<std::string>{"a", "b\"c", "d;e"}, 2);
+        }) == "\"a;b\"\"c;d;e\"");
+}
+
+TEST_CASE("CsvFormatTest Invalid", "[datalogtool]") {
+  // wrong size for the type
+  CHECK(FormatValue("/d", "double", [](auto& log, int entry) {
+          log.AppendBoolean(entry, true, 2);
+        }) == "<invalid>");
+  CHECK(FormatValue("/r", "raw", [](auto& log, int entry) {
+          log.AppendString(entry, "raw", 2);
+        }) == "<invalid>");
+}
@@ -4,24 +4,35 @@
 
 #include "wpi/sysid/analysis/AnalysisManager.hpp"
 
+#include <algorithm>
 #include <format>
 #include <limits>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "wpi/sysid/analysis/FeedforwardAnalysis.hpp"
 #include "wpi/sysid/analysis/FilteringUtils.hpp"
 #include "wpi/util/MathExtras.hpp"
-#include "wpi/util/StringExtras.hpp"
-#include "wpi/util/StringMap.hpp"
 
 using namespace sysid;
 
+/**
+ * Linearly interpolates the measurement at the given time.
+ *
+ * @param time The time to interpolate at.
+ * @param data The samples to interpolate between.
+ * @param start The index to start searching for the next sample from. It is
+ *              updated with the index of the next sample, so a series of calls
+ *              with nondecreasing times only searches the data once.
+ */
 static double Lerp(wpi::units::second_t time,
-                   std::vector<MotorData::Run::Sample<double>>& data) {
-  auto next = std::find_if(data.begin(), data.end(), [&](const auto& entry) {
-    return entry.time > time;
-  });
+                   const std::vector<MotorData::Run::Sample<double>>& data,
+                   size_t* start) {
+  auto next = std::find_if(
+      data.begin() + *start, data.end(),
+      [&](const auto& entry) { return entry.time > time; });
+  *start = next - data.begin();
 
   if (next == data.begin()) {
     next++;
@@ -56,15 +67,26 @@ static std::vector<PreparedData> ConvertToPrepared(const MotorData& data) {
   std::vector<PreparedData> prepared;
 
   // Assume we've selected down to a single contiguous run by this point
-  auto run = data.runs[0];
+  const auto& run = data.runs[0];
+  prepared.reserve(run.voltage.size());
 
+  size_t positionStart = 0;
+  size_t velocityStart = 0;
   for (int i = 0; i < static_cast<int>(run.voltage.size()) - 1; ++i) {
     const auto& currentVoltage = run.voltage[i];
     const auto& nextVoltage = run.voltage[i + 1];
 
-    auto currentPosition = Lerp(currentVoltage.time, run.position);
+    // Samples are normally in time order; if not, search from the beginning
+    if (i > 0 && currentVoltage.time < run.voltage[i - 1].time) {
+      positionStart = 0;
+      velocityStart = 0;
+    }
+
+    auto currentPosition =
+        Lerp(currentVoltage.time, run.position, &positionStart);
 
-    auto currentVelocity = Lerp(currentVoltage.time, run.velocity);
+    auto currentVelocity =
+        Lerp(currentVoltage.time, run.velocity, &velocityStart);
 
     prepared.emplace_back(PreparedData{currentVoltage.time,
                                        currentVoltage.measurement.value(),
@@ -75,29 +97,6 @@ static std::vector<PreparedData> ConvertToPrepared(const MotorData& data) {
   return prepared;
 }
 
-/**
- * To preserve a raw copy of the data, this method saves a raw version
- * in the dataset wpi::util::StringMap where the key of the raw data starts with
- * "raw-" before the name of the original data.
- *
- * @tparam S The size of the array data that's being used
- *
- * @param dataset A reference to the dataset being used
- */
-static void CopyRawData(wpi::util::StringMap<MotorData>* dataset) {
-  auto& data = *dataset;
-  // Loads the Raw Data
-  for (auto& it : data) {
-    auto& key = it.first;
-    auto& motorData = it.second;
-
-    if (!wpi::util::contains(key, "raw")) {
-      data[std::format("raw-{}", key)] = motorData;
-      data[std::format("original-raw-{}", key)] = motorData;
-    }
-  }
-}
-
 /**
  * Combines the various datasets into a single one for analysis.
  *
@@ -113,21 +112,30 @@ static Storage CombineDatasets(const std::vector<PreparedData>& slowForward,
   return Storage{slowForward, slowBackward, fastForward, fastBackward};
 }
 
-void AnalysisManager::PrepareGeneralData() {
-  wpi::util::StringMap<std::vector<PreparedData>> preparedData;
-
-  WPI_INFO(m_logger, "{}", "Preprocessing raw data.");
+AnalysisManager::AnalysisManager(Settings& settings, wpi::util::Logger& logger)
+    : m_logger{logger}, m_settings{settings} {}
 
-  WPI_INFO(m_logger, "{}", "Copying raw data.");
-  CopyRawData(&m_data.motorData);
+AnalysisManager::AnalysisManager(TestData data, Settings& settings,
+                                 wpi::util::Logger& logger)
+    : m_data{std::move(data)}, m_logger{logger}, m_settings{settings} {
+  // Reset settings for Dynamic Test Limits
+  m_settings.stepTestDuration = 0_s;
+  m_settings.velocityThreshold = std::numeric_limits<double>::infinity();
+}
 
+void AnalysisManager::ConvertData() {
   WPI_INFO(m_logger, "{}", "Converting raw data to PreparedData struct.");
-  // Convert data to PreparedData structs
-  for (auto& it : m_data.motorData) {
-    auto key = it.first;
+  std::array<std::vector<PreparedData>, 4> convertedData;
+  for (size_t test = 0; test < convertedData.size(); ++test) {
+    std::string_view key = kJsonDataKeys[test];
+
+    auto it = m_data.motorData.find(key);
+    if (it == m_data.motorData.end() || it->second.runs.empty()) {
+      throw sysid::InvalidDataError(std::format("{} data is missing.", key));
+    }
 
     // Assume we've selected down to a single contiguous run by this point
-    auto run = m_data.motorData[key].runs[0];
+    const auto& run = it->second.runs[0];
 
     // Ensure data has at least two samples in it or linear interpolation within
     // ConvertToPrepared() will fail
@@ -147,61 +155,142 @@ void AnalysisManager::PrepareGeneralData() {
           run.velocity.size()));
     }
 
-    preparedData[key] = ConvertToPrepared(m_data.motorData[key]);
-    WPI_INFO(m_logger, "SAMPLES {}", preparedData[key].size());
+    convertedData[test] = ConvertToPrepared(it->second);
+    WPI_INFO(m_logger, "SAMPLES {}", convertedData[test].size());
   }
 
   // Store the original datasets
-  m_originalDataset =
-      CombineDatasets(preparedData["original-raw-quasistatic-forward"],
-                      preparedData["original-raw-quasistatic-reverse"],
-                      preparedData["original-raw-dynamic-forward"],
-                      preparedData["original-raw-dynamic-reverse"]);
+  m_originalDataset = CombineDatasets(convertedData[0], convertedData[1],
+                                      convertedData[2], convertedData[3]);
+
+  // Find the maximum step test duration of the dynamic tests
+  m_maxStepTime = 0_s;
+  for (size_t test = 2; test < convertedData.size(); ++test) {
+    auto& dataset = convertedData[test];
+    if (!dataset.empty()) {
+      m_maxStepTime = std::max(
+          m_maxStepTime, dataset.back().timestamp - dataset.front().timestamp);
+    }
+  }
 
-  WPI_INFO(m_logger, "{}", "Initial trimming and filtering.");
-  sysid::InitialTrimAndFilter(&preparedData, &m_settings, m_positionDelays,
-                              m_velocityDelays, m_minStepTime, m_maxStepTime,
-                              m_data.distanceUnit);
+  m_convertedData = std::move(convertedData);
+}
 
-  WPI_INFO(m_logger, "{}", m_minStepTime);
-  WPI_INFO(m_logger, "{}", m_maxStepTime);
+void AnalysisManager::UpdateStage(Stage* stage, size_t test, bool filtered) {
+  bool quasistatic = test < 2;
 
-  WPI_INFO(m_logger, "{}", "Acceleration filtering.");
-  sysid::AccelFilter(&preparedData);
+  // Only the settings that affect this dataset are part of its key
+  StageKey key{.unit = m_data.distanceUnit};
+  if (quasistatic) {
+    key.velocityThreshold = m_settings.velocityThreshold;
+  }
+  if (filtered) {
+    key.medianWindow = m_settings.medianWindow;
+    if (!quasistatic) {
+      key.stepTestDuration = m_settings.stepTestDuration;
+    }
+  }
+  if (stage->key == key) {
+    return;
+  }
+  stage->key.reset();
 
-  WPI_INFO(m_logger, "{}", "Storing datasets.");
-  // Store the raw datasets
-  m_rawDataset = CombineDatasets(preparedData["raw-quasistatic-forward"],
-                                 preparedData["raw-quasistatic-reverse"],
-                                 preparedData["raw-dynamic-forward"],
-                                 preparedData["raw-dynamic-reverse"]);
+  auto dataset = m_convertedData[test];
 
-  // Store the filtered datasets
-  m_filteredDataset = CombineDatasets(
-      preparedData["quasistatic-forward"], preparedData["quasistatic-reverse"],
-      preparedData["dynamic-forward"], preparedData["dynamic-reverse"]);
+  // Trim quasistatic test data to remove all points where voltage is zero or
+  // velocity < velocity threshold.
+  if (quasistatic) {
+    TrimQuasistaticData(&dataset, m_settings.velocityThreshold);
+  }
 
-  m_startTimes = {preparedData["raw-quasistatic-forward"][0].timestamp,
-                  preparedData["raw-quasistatic-reverse"][0].timestamp,
-                  preparedData["raw-dynamic-forward"][0].timestamp,
-                  preparedData["raw-dynamic-reverse"][0].timestamp};
-}
+  // Apply Median filter
+  if (filtered && m_settings.medianWindow > 1) {
+    ApplyMedianFilter(&dataset, m_settings.medianWindow);
+  }
 
-AnalysisManager::AnalysisManager(Settings& settings, wpi::util::Logger& logger)
-    : m_logger{logger}, m_settings{settings} {}
+  // Calculate Accel and Cosine
+  PrepareMechData(&dataset, m_data.distanceUnit);
 
-AnalysisManager::AnalysisManager(TestData data, Settings& settings,
-                                 wpi::util::Logger& logger)
-    : m_data{std::move(data)}, m_logger{logger}, m_settings{settings} {
-  // Reset settings for Dynamic Test Limits
-  m_settings.stepTestDuration = 0_s;
-  m_settings.velocityThreshold = std::numeric_limits<double>::infinity();
+  // Trim filtered Dynamic Test Data
+  if (filtered && !quasistatic) {
+    auto [minStepTime, positionDelay, velocityDelay] = TrimStepVoltageData(
+        &dataset, &m_settings, m_minStepTime, m_maxStepTime);
+    stage->positionDelay = positionDelay;
+    stage->velocityDelay = velocityDelay;
+
+    // Confirm there's still data
+    if (dataset.empty()) {
+      throw sysid::NoDynamicDataError();
+    }
+
+    // The step test duration is set to a default if it wasn't set yet
+    key.stepTestDuration = m_settings.stepTestDuration;
+  }
+
+  AccelFilter(&dataset);
+
+  if (filtered) {
+    stage->sums = AccumulateFeedforwardData(dataset, m_data.mechanismType);
+  }
+  stage->dataset = std::move(dataset);
+  stage->key = key;
 }
 
 void AnalysisManager::PrepareData() {
   //  WPI_INFO(m_logger, "Preparing {} data", m_data.mechanismType.name);
 
-  PrepareGeneralData();
+  // Only the stages whose inputs changed since the last call are recomputed
+  if (m_originalDataset.empty()) {
+    ConvertData();
+  }
+
+  // Calculate Velocity Threshold if it hasn't been set yet
+  if (m_settings.velocityThreshold == std::numeric_limits<double>::infinity()) {
+    for (size_t test = 0; test < 2; ++test) {
+      m_settings.velocityThreshold = std::min(
+          m_settings.velocityThreshold,
+          GetNoiseFloor(m_convertedData[test], kNoiseMeanWindow,
+                        [](auto&& pt) { return pt.velocity; }));
+    }
+  }
+
+  WPI_INFO(m_logger, "{}", "Trimming and filtering.");
+  for (size_t test = 0; test < m_convertedData.size(); ++test) {
+    UpdateStage(&m_rawStages[test], test, false);
+    UpdateStage(&m_filteredStages[test], test, true);
+  }
+
+  // Confirm there's still data
+  for (auto* stages : {&m_rawStages, &m_filteredStages}) {
+    for (auto&& stage : *stages) {
+      if (stage.dataset.empty()) {
+        throw sysid::InvalidDataError(
+            "Acceleration filtering has removed all data.");
+      }
+    }
+  }
+
+  WPI_INFO(m_logger, "{}", "Storing datasets.");
+  m_rawDataset =
+      CombineDatasets(m_rawStages[0].dataset, m_rawStages[1].dataset,
+                      m_rawStages[2].dataset, m_rawStages[3].dataset);
+  m_filteredDataset = CombineDatasets(
+      m_filteredStages[0].dataset, m_filteredStages[1].dataset,
+      m_filteredStages[2].dataset, m_filteredStages[3].dataset);
+
+  m_filteredSums = m_filteredStages[0].sums;
+  for (size_t test = 1; test < m_filteredStages.size(); ++test) {
+    m_filteredSums += m_filteredStages[test].sums;
+  }
+
+  m_positionDelays = {m_filteredStages[2].positionDelay,
+                      m_filteredStages[3].positionDelay};
+  m_velocityDelays = {m_filteredStages[2].velocityDelay,
+                      m_filteredStages[3].velocityDelay};
+
+  for (size_t test = 0; test < m_rawStages.size(); ++test) {
+    m_startTimes[test] = m_rawStages[test].dataset[0].timestamp;
+  }
 
   WPI_INFO(m_logger, "{}", "Finished Preparing Data");
 }
@@ -216,7 +305,7 @@ AnalysisManager::FeedforwardGains AnalysisManager::CalculateFeedforward() {
   // Calculate feedforward gains from the data.
   const auto& analysisType = m_data.mechanismType;
   const auto& ff =
-      sysid::CalculateFeedforwardGains(GetFilteredData(), analysisType, false);
+      sysid::CalculateFeedforwardGains(m_filteredSums, analysisType, false);
 
   const auto& Ks = ff.coeffs[0];
   FeedforwardGain KsGain = {
@@ -4,10 +4,12 @@
 
 #include "wpi/sysid/analysis/FeedforwardAnalysis.hpp"
 
+#include <algorithm>
 #include <array>
 #include <bitset>
 #include <cmath>
 #include <format>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -43,7 +45,7 @@ namespace sysid {
  * @param X Vector representation of X in y = Xβ.
  * @param y Vector representation of y in y = Xβ.
  */
-static void PopulateOLSData(const std::vector<PreparedData>& d,
+static void PopulateOLSData(std::span<const PreparedData> d,
                             const AnalysisType& type,
                             Eigen::Block<Eigen::MatrixXd> X,
                             Eigen::VectorBlock<Eigen::VectorXd> y) {
@@ -78,12 +80,12 @@ static void PopulateOLSData(const std::vector<PreparedData>& d,
 /**
  * Throws an InsufficientSamplesError if the collected data is poor for OLS.
  *
- * @param X The collected data in matrix form for OLS.
+ * @param XtX XᵀX of the collected data in matrix form for OLS.
  * @param type The analysis type.
  */
-static void CheckOLSDataQuality(const Eigen::MatrixXd& X,
+static void CheckOLSDataQuality(const Eigen::MatrixXd& XtX,
                                 const AnalysisType& type) {
-  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigSolver{X.transpose() * X};
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigSolver{XtX};
   const Eigen::VectorXd& eigvals = eigSolver.eigenvalues();
   const Eigen::MatrixXd& eigvecs = eigSolver.eigenvectors();
 
@@ -174,48 +176,50 @@ static void CheckOLSDataQuality(const Eigen::MatrixXd& X,
   }
 }
 
-OLSResult CalculateFeedforwardGains(const Storage& data,
-                                    const AnalysisType& type,
-                                    bool throwOnBadData) {
-  // Iterate through the data and add it to our raw vector.
-  const auto& [slowForward, slowBackward, fastForward, fastBackward] = data;
+OLSAccumulator AccumulateFeedforwardData(const std::vector<PreparedData>& data,
+                                         const AnalysisType& type) {
+  // Populate X and y a chunk at a time so they stay small and in cache
+  constexpr size_t kChunkSize = 1024;
 
-  const auto size = slowForward.size() + slowBackward.size() +
-                    fastForward.size() + fastBackward.size();
+  OLSAccumulator sums{type.independentVariables};
+  Eigen::MatrixXd X{kChunkSize, type.independentVariables};
+  Eigen::VectorXd y{kChunkSize};
 
-  // Create a raw vector of doubles with our data in it.
-  Eigen::MatrixXd X{size, type.independentVariables};
-  Eigen::VectorXd y{size};
+  for (size_t offset = 0; offset < data.size(); offset += kChunkSize) {
+    size_t rows = std::min(kChunkSize, data.size() - offset);
+    PopulateOLSData(std::span{data}.subspan(offset, rows), type,
+                    X.block(0, 0, rows, X.cols()), y.segment(0, rows));
+    sums.Add(X.topRows(rows), y.head(rows));
+  }
 
-  int rowOffset = 0;
-  PopulateOLSData(slowForward, type,
-                  X.block(rowOffset, 0, slowForward.size(), X.cols()),
-                  y.segment(rowOffset, slowForward.size()));
+  return sums;
+}
 
-  rowOffset += slowForward.size();
-  PopulateOLSData(slowBackward, type,
-                  X.block(rowOffset, 0, slowBackward.size(), X.cols()),
-                  y.segment(rowOffset, slowBackward.size()));
+OLSResult CalculateFeedforwardGains(const Storage& data,
+                                    const AnalysisType& type,
+                                    bool throwOnBadData) {
+  const auto& [slowForward, slowBackward, fastForward, fastBackward] = data;
 
-  rowOffset += slowBackward.size();
-  PopulateOLSData(fastForward, type,
-                  X.block(rowOffset, 0, fastForward.size(), X.cols()),
-                  y.segment(rowOffset, fastForward.size()));
+  auto sums = AccumulateFeedforwardData(slowForward, type);
+  sums += AccumulateFeedforwardData(slowBackward, type);
+  sums += AccumulateFeedforwardData(fastForward, type);
+  sums += AccumulateFeedforwardData(fastBackward, type);
 
-  rowOffset += fastForward.size();
-  PopulateOLSData(fastBackward, type,
-                  X.block(rowOffset, 0, fastBackward.size(), X.cols()),
-                  y.segment(rowOffset, fastBackward.size()));
+  return CalculateFeedforwardGains(sums, type, throwOnBadData);
+}
 
+OLSResult CalculateFeedforwardGains(const OLSAccumulator& sums,
+                                    const AnalysisType& type,
+                                    bool throwOnBadData) {
   // Check quality of collected data
   if (throwOnBadData) {
-    CheckOLSDataQuality(X, type);
+    CheckOLSDataQuality(sums.XtX(), type);
   }
 
   std::vector<double> gains;
-  gains.reserve(X.rows());
+  gains.reserve(type.independentVariables);
 
-  auto ols = OLS(X, y);
+  auto ols = OLS(sums);
 
   // Calculate feedforward gains
   //
@@ -7,7 +7,6 @@
 #include <algorithm>
 #include <format>
 #include <functional>
-#include <limits>
 #include <numbers>
 #include <numeric>
 #include <string>
@@ -17,7 +16,6 @@
 #include "wpi/math/filter/LinearFilter.hpp"
 #include "wpi/math/filter/MedianFilter.hpp"
 #include "wpi/util/MathExtras.hpp"
-#include "wpi/util/StringExtras.hpp"
 
 using namespace sysid;
 
@@ -39,39 +37,8 @@ static void CheckSize(const std::vector<PreparedData>& data, size_t window,
   }
 }
 
-/**
- * Helper function that determines if a certain key is storing raw data.
- *
- * @param key The key of the dataset
- *
- * @return True, if the key corresponds to a raw dataset.
- */
-static bool IsRaw(std::string_view key) {
-  return wpi::util::contains(key, "raw") &&
-         !wpi::util::contains(key, "original");
-}
-
-/**
- * Helper function that determines if a certain key is storing filtered data.
- *
- * @param key The key of the dataset
- *
- * @return True, if the key corresponds to a filtered dataset.
- */
-static bool IsFiltered(std::string_view key) {
-  return !wpi::util::contains(key, "raw") &&
-         !wpi::util::contains(key, "original");
-}
-
-/**
- * Fills in the rest of the PreparedData Structs for a PreparedData Vector.
- *
- * @param data A reference to a vector of the raw data.
- * @param unit The units that the data is in (rotations, radians, or degrees)
- *             for arm mechanisms.
- */
-static void PrepareMechData(std::vector<PreparedData>* data,
-                            std::string_view unit = "") {
+void sysid::PrepareMechData(std::vector<PreparedData>* data,
+                            std::string_view unit) {
   constexpr size_t kWindow = 3;
 
   CheckSize(*data, kWindow, "Acceleration Calculation");
@@ -296,152 +263,19 @@ void sysid::ApplyMedianFilter(std::vector<PreparedData>* data, int window) {
   }
 }
 
-/**
- * Removes a substring from a string reference
- *
- * @param str The std::string_view that needs modification
- * @param removeStr The substring that needs to be removed
- *
- * @return an std::string without the specified substring
- */
-static std::string RemoveStr(std::string_view str, std::string_view removeStr) {
-  size_t idx = str.find(removeStr);
-  if (idx == std::string_view::npos) {
-    return std::string{str};
-  } else {
-    return std::format("{}{}", str.substr(0, idx),
-                       str.substr(idx + removeStr.size()));
-  }
-}
+void sysid::TrimQuasistaticData(std::vector<PreparedData>* data,
+                                double velocityThreshold) {
+  std::erase_if(*data, [&](const auto& pt) {
+    return std::abs(pt.voltage) <= 0 ||
+           std::abs(pt.velocity) < velocityThreshold;
+  });
 
-/**
- * Figures out the max duration of the Dynamic tests
- *
- * @param data The raw data String Map
- *
- * @return The maximum duration of the Dynamic Tests
- */
-static wpi::units::second_t GetMaxStepTime(
-    wpi::util::StringMap<std::vector<PreparedData>>& data) {
-  auto maxStepTime = 0_s;
-  for (auto& it : data) {
-    auto& key = it.first;
-    auto& dataset = it.second;
-
-    if (IsRaw(key) && wpi::util::contains(key, "dynamic")) {
-      if (!dataset.empty()) {
-        auto duration = dataset.back().timestamp - dataset.front().timestamp;
-        if (duration > maxStepTime) {
-          maxStepTime = duration;
-        }
-      }
-    }
-  }
-  return maxStepTime;
-}
-
-void sysid::InitialTrimAndFilter(
-    wpi::util::StringMap<std::vector<PreparedData>>* data,
-    AnalysisManager::Settings* settings,
-    std::vector<wpi::units::second_t>& positionDelays,
-    std::vector<wpi::units::second_t>& velocityDelays,
-    wpi::units::second_t& minStepTime, wpi::units::second_t& maxStepTime,
-    std::string_view unit) {
-  auto& preparedData = *data;
-
-  // Find the maximum Step Test Duration of the dynamic tests
-  maxStepTime = GetMaxStepTime(preparedData);
-
-  // Calculate Velocity Threshold if it hasn't been set yet
-  if (settings->velocityThreshold == std::numeric_limits<double>::infinity()) {
-    for (auto& it : preparedData) {
-      auto& key = it.first;
-      auto& dataset = it.second;
-      if (wpi::util::contains(key, "quasistatic")) {
-        settings->velocityThreshold =
-            std::min(settings->velocityThreshold,
-                     GetNoiseFloor(dataset, kNoiseMeanWindow,
-                                   [](auto&& pt) { return pt.velocity; }));
-      }
-    }
-  }
-
-  for (auto& it : preparedData) {
-    auto& key = it.first;
-    auto& dataset = it.second;
-
-    // Trim quasistatic test data to remove all points where voltage is zero or
-    // velocity < velocity threshold.
-    if (wpi::util::contains(key, "quasistatic")) {
-      dataset.erase(std::remove_if(dataset.begin(), dataset.end(),
-                                   [&](const auto& pt) {
-                                     return std::abs(pt.voltage) <= 0 ||
-                                            std::abs(pt.velocity) <
-                                                settings->velocityThreshold;
-                                   }),
-                    dataset.end());
-
-      // Confirm there's still data
-      if (dataset.empty()) {
-        throw sysid::NoQuasistaticDataError();
-      }
-    }
-
-    // Apply Median filter
-    if (IsFiltered(key) && settings->medianWindow > 1) {
-      ApplyMedianFilter(&dataset, settings->medianWindow);
-    }
-
-    // Recalculate Accel and Cosine
-    PrepareMechData(&dataset, unit);
-
-    // Trims filtered Dynamic Test Data
-    if (IsFiltered(key) && wpi::util::contains(key, "dynamic")) {
-      // Get the filtered dataset name
-      auto filteredKey = RemoveStr(key, "raw-");
-
-      // Trim Filtered Data
-      auto [tempMinStepTime, positionDelay, velocityDelay] =
-          TrimStepVoltageData(&preparedData[filteredKey], settings, minStepTime,
-                              maxStepTime);
-
-      positionDelays.emplace_back(positionDelay);
-      velocityDelays.emplace_back(velocityDelay);
-
-      // Set the Raw Data to start at the same time as the Filtered Data
-      auto startTime = preparedData[filteredKey].front().timestamp;
-      auto rawStart =
-          std::find_if(preparedData[key].begin(), preparedData[key].end(),
-                       [&](auto&& pt) { return pt.timestamp == startTime; });
-      preparedData[key].erase(preparedData[key].begin(), rawStart);
-
-      // Confirm there's still data
-      if (preparedData[key].empty()) {
-        throw sysid::NoDynamicDataError();
-      }
-    }
+  // Confirm there's still data
+  if (data->empty()) {
+    throw sysid::NoQuasistaticDataError();
   }
 }
 
-void sysid::AccelFilter(wpi::util::StringMap<std::vector<PreparedData>>* data) {
-  auto& preparedData = *data;
-
-  // Remove points with acceleration = 0
-  for (auto& it : preparedData) {
-    auto& dataset = it.second;
-
-    for (size_t i = 0; i < dataset.size(); i++) {
-      if (dataset.at(i).acceleration == 0.0) {
-        dataset.erase(dataset.begin() + i);
-        i--;
-      }
-    }
-  }
-
-  // Confirm there's still data
-  if (std::any_of(preparedData.begin(), preparedData.end(),
-                  [](const auto& it) { return it.second.empty(); })) {
-    throw sysid::InvalidDataError(
-        "Acceleration filtering has removed all data.");
-  }
+void sysid::AccelFilter(std::vector<PreparedData>* data) {
+  std::erase_if(*data, [](const auto& pt) { return pt.acceleration == 0.0; });
 }
@@ -4,6 +4,7 @@
 
 #include "wpi/sysid/analysis/OLS.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 
@@ -11,6 +12,76 @@
 
 namespace sysid {
 
+/**
+ * Computes the goodness of fit statistics for a regression.
+ *
+ * @param β The regression coefficients.
+ * @param SSE The error sum of squares.
+ * @param yty yᵀy.
+ * @param sumY Σy.
+ * @param n The sample size.
+ */
+static OLSResult MakeResult(const Eigen::VectorXd& β, double SSE, double yty,
+                            double sumY, int n) {
+  // Number of explanatory variables
+  int p = β.rows();
+
+  // Total sum of squares (total variation in y)
+  //
+  // From slide 24 of
+  // http://www.stat.columbia.edu/~fwood/Teaching/w4315/Fall2009/lecture_11:
+  //
+  //   SSTO = yᵀy - 1/n yᵀJy
+  //
+  // where J is a matrix of ones. yᵀJy = (Σy)², so J never needs to be formed.
+  double SSTO = yty - sumY * sumY / n;
+
+  // R² or the coefficient of determination, which represents how much of the
+  // total variation (variation in y) can be explained by the regression model
+  double rSquared = 1.0 - SSE / SSTO;
+
+  // Adjusted R²
+  //
+  //                       n − 1
+  //   R̅² = 1 − (1 − R²) ---------
+  //                     n − p − 1
+  //
+  // See https://en.wikipedia.org/wiki/Coefficient_of_determination#Adjusted_R2
+  double adjRSquared = 1.0 - (1.0 - rSquared) * ((n - 1.0) / (n - p - 1.0));
+
+  // Root-mean-square error
+  double RMSE = std::sqrt(SSE / n);
+
+  return {{β.data(), β.data() + β.size()}, adjRSquared, RMSE};
+}
+
+OLSAccumulator::OLSAccumulator(size_t independentVariables)
+    : m_XtX{Eigen::MatrixXd::Zero(independentVariables, independentVariables)},
+      m_Xty{Eigen::VectorXd::Zero(independentVariables)} {}
+
+void OLSAccumulator::Add(const Eigen::Ref<const Eigen::MatrixXd>& X,
+                         const Eigen::Ref<const Eigen::VectorXd>& y) {
+  assert(X.rows() == y.rows());
+  assert(X.cols() == m_XtX.cols());
+
+  m_XtX.selfadjointView<Eigen::Lower>().rankUpdate(X.transpose());
+  m_Xty.noalias() += X.transpose() * y;
+  m_yty += y.squaredNorm();
+  m_sumY += y.sum();
+  m_size += X.rows();
+}
+
+OLSAccumulator& OLSAccumulator::operator+=(const OLSAccumulator& other) {
+  assert(other.m_XtX.cols() == m_XtX.cols());
+
+  m_XtX += other.m_XtX;
+  m_Xty += other.m_Xty;
+  m_yty += other.m_yty;
+  m_sumY += other.m_sumY;
+  m_size += other.m_size;
+  return *this;
+}
+
 OLSResult OLS(const Eigen::MatrixXd& X, const Eigen::VectorXd& y) {
   assert(X.rows() == y.rows());
 
@@ -42,47 +113,28 @@ OLSResult OLS(const Eigen::MatrixXd& X, const Eigen::VectorXd& y) {
   //
   // XᵀX is guaranteed to be symmetric positive definite, so an LLT
   // decomposition can be used.
-  Eigen::MatrixXd β = (X.transpose() * X).llt().solve(X.transpose() * y);
+  Eigen::VectorXd β = (X.transpose() * X).llt().solve(X.transpose() * y);
 
   // Error sum of squares
   double SSE = (y - X * β).squaredNorm();
 
-  // Sample size
-  int n = X.rows();
-
-  // Number of explanatory variables
-  int p = β.rows();
-
-  // Total sum of squares (total variation in y)
-  //
-  // From slide 24 of
-  // http://www.stat.columbia.edu/~fwood/Teaching/w4315/Fall2009/lecture_11:
-  //
-  //   SSTO = yᵀy - 1/n yᵀJy
-  //
-  // where J is a matrix of ones.
-  double SSTO =
-      (y.transpose() * y - 1.0 / y.rows() * y.transpose() *
-                               Eigen::MatrixXd::Ones(y.rows(), y.rows()) * y)
-          .value();
+  return MakeResult(β, SSE, y.squaredNorm(), y.sum(), X.rows());
+}
 
-  // R² or the coefficient of determination, which represents how much of the
-  // total variation (variation in y) can be explained by the regression model
-  double rSquared = 1.0 - SSE / SSTO;
+OLSResult OLS(const OLSAccumulator& sums) {
+  // β = (XᵀX)⁻¹Xᵀy, as above
+  Eigen::VectorXd β = sums.XtX().llt().solve(sums.Xty());
 
-  // Adjusted R²
+  // Error sum of squares, expanded so it only needs the sums
   //
-  //                       n − 1
-  //   R̅² = 1 − (1 − R²) ---------
-  //                     n − p − 1
-  //
-  // See https://en.wikipedia.org/wiki/Coefficient_of_determination#Adjusted_R2
-  double adjRSquared = 1.0 - (1.0 - rSquared) * ((n - 1.0) / (n - p - 1.0));
+  //   SSE = (y − Xβ)ᵀ(y − Xβ)
+  //       = yᵀy − 2βᵀXᵀy + βᵀXᵀXβ
+  double SSE = sums.yty() - 2.0 * β.dot(sums.Xty()) + β.dot(sums.XtX() * β);
 
-  // Root-mean-square error
-  double RMSE = std::sqrt(SSE / n);
+  // Round-off can make a near-perfect fit slightly negative
+  SSE = std::max(SSE, 0.0);
 
-  return {{β.data(), β.data() + β.size()}, adjRSquared, RMSE};
+  return MakeResult(β, SSE, sums.yty(), sums.SumY(), sums.Size());
 }
 
 }  // namespace sysid
@@ -10,6 +10,7 @@
 #include <format>
 #include <limits>
 #include <numeric>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -203,6 +204,10 @@ class AnalysisManager {
   /**
    * Prepares data from the JSON and stores the output in Storage member
    * variables.
+   *
+   * The results of each filtering stage are cached along with the settings
+   * they were computed with, so after a settings change only the datasets
+   * affected by that setting are recomputed.
    */
   void PrepareData();
 
@@ -344,6 +349,39 @@ class AnalysisManager {
   std::vector<wpi::units::second_t> m_positionDelays;
   std::vector<wpi::units::second_t> m_velocityDelays;
 
-  void PrepareGeneralData();
+  // The settings a stage's output depends on
+  struct StageKey {
+    double velocityThreshold = 0.0;
+    int medianWindow = 1;
+    wpi::units::second_t stepTestDuration = 0_s;
+    std::string unit;
+
+    bool operator==(const StageKey&) const = default;
+  };
+
+  // The cached trimmed and filtered version of one test's data
+  struct Stage {
+    // The inputs the dataset was computed with; empty if not computed yet
+    std::optional<StageKey> key;
+    std::vector<PreparedData> dataset;
+
+    // OLS sufficient statistics of the dataset (filtered datasets only)
+    OLSAccumulator sums;
+
+    // Signal delays (filtered dynamic datasets only)
+    wpi::units::second_t positionDelay = 0_s;
+    wpi::units::second_t velocityDelay = 0_s;
+  };
+
+  // The raw data converted to PreparedData, in kJsonDataKeys order
+  std::array<std::vector<PreparedData>, 4> m_convertedData;
+  std::array<Stage, 4> m_rawStages;
+  std::array<Stage, 4> m_filteredStages;
+
+  // OLS sufficient statistics of m_filteredDataset
+  OLSAccumulator m_filteredSums;
+
+  void ConvertData();
+  void UpdateStage(Stage* stage, size_t test, bool filtered);
 };
 }  // namespace sysid
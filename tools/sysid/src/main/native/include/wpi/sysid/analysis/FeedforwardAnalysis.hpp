@@ -6,6 +6,7 @@
 
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "wpi/sysid/analysis/AnalysisType.hpp"
 #include "wpi/sysid/analysis/OLS.hpp"
@@ -49,4 +50,27 @@ OLSResult CalculateFeedforwardGains(const Storage& data,
                                     const AnalysisType& type,
                                     bool throwOnRankDeficiency = true);
 
+/**
+ * Accumulates the OLS sufficient statistics of one dataset for feedforward
+ * gain calculation.
+ *
+ * @param data The OLS input data.
+ * @param type The analysis type.
+ */
+OLSAccumulator AccumulateFeedforwardData(const std::vector<PreparedData>& data,
+                                         const AnalysisType& type);
+
+/**
+ * Calculates feedforward gains given the accumulated sufficient statistics of
+ * the data and the type of analysis to perform.
+ *
+ * @param sums The accumulated OLS input data.
+ * @param type The analysis type.
+ * @param throwOnRankDeficiency Whether to throw if the fit is going to be poor.
+ *   This option is provided for unit testing purposes.
+ */
+OLSResult CalculateFeedforwardGains(const OLSAccumulator& sums,
+                                    const AnalysisType& type,
+                                    bool throwOnRankDeficiency = true);
+
 }  // namespace sysid
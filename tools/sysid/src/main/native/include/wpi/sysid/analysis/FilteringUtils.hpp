@@ -18,7 +18,6 @@
 #include "wpi/sysid/analysis/Storage.hpp"
 #include "wpi/units/time.hpp"
 #include "wpi/util/StringExtras.hpp"
-#include "wpi/util/StringMap.hpp"
 #include "wpi/util/array.hpp"
 
 namespace sysid {
@@ -202,37 +201,32 @@ wpi::math::LinearFilter<double> CentralFiniteDifference(
 }
 
 /**
- * Trims the quasistatic tests, applies a median filter to the velocity data,
- * calculates acceleration and cosine (arm only) data, and trims the dynamic
- * tests.
+ * Removes all quasistatic test points where voltage is zero or velocity is
+ * below the velocity threshold.
  *
- * @param data A pointer to a data vector recently created by the
- *             ConvertToPrepared method
- * @param settings A reference to the analysis settings
- * @param positionDelays A reference to the vector of computed position signal
- * delays.
- * @param velocityDelays A reference to the vector of computed velocity signal
- * delays.
- * @param minStepTime A reference to the minimum dynamic test duration as one of
- *                    the trimming procedures will remove this amount from the
- *                    start of the test.
- * @param maxStepTime A reference to the maximum dynamic test duration
+ * @param data A pointer to a PreparedData vector
+ * @param velocityThreshold The velocity threshold
+ * @throws NoQuasistaticDataError if no data remains
+ */
+void TrimQuasistaticData(std::vector<PreparedData>* data,
+                         double velocityThreshold);
+
+/**
+ * Fills in the acceleration, cosine, and sine (arm only) fields of a
+ * PreparedData vector.
+ *
+ * @param data A pointer to a PreparedData vector
  * @param unit The angular unit that the arm test is in (only for calculating
- *             cosine data)
+ *             cosine and sine data)
  */
-void InitialTrimAndFilter(wpi::util::StringMap<std::vector<PreparedData>>* data,
-                          AnalysisManager::Settings* settings,
-                          std::vector<wpi::units::second_t>& positionDelays,
-                          std::vector<wpi::units::second_t>& velocityDelays,
-                          wpi::units::second_t& minStepTime,
-                          wpi::units::second_t& maxStepTime,
-                          std::string_view unit = "");
+void PrepareMechData(std::vector<PreparedData>* data,
+                     std::string_view unit = "");
 
 /**
  * Removes all points with acceleration = 0.
  *
  * @param data A pointer to a PreparedData vector
  */
-void AccelFilter(wpi::util::StringMap<std::vector<PreparedData>>* data);
+void AccelFilter(std::vector<PreparedData>* data);
 
 }  // namespace sysid
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 #include <Eigen/Core>
@@ -21,6 +22,75 @@ struct OLSResult {
   double rmse = 0.0;
 };
 
+/**
+ * Sufficient statistics for ordinary least squares regression (XᵀX, Xᵀy, yᵀy,
+ * Σy, and the sample count).
+ *
+ * Samples can be added incrementally, and accumulators for disjoint sets of
+ * samples can be summed, so a regression over several datasets only needs to
+ * revisit the datasets that changed.
+ */
+class OLSAccumulator {
+ public:
+  /**
+   * Constructs an empty accumulator.
+   *
+   * @param independentVariables The number of columns of X in y = Xβ.
+   */
+  explicit OLSAccumulator(size_t independentVariables = 0);
+
+  /**
+   * Adds samples to the accumulator.
+   *
+   * @param X The independent data in y = Xβ.
+   * @param y The dependent data in y = Xβ.
+   */
+  void Add(const Eigen::Ref<const Eigen::MatrixXd>& X,
+           const Eigen::Ref<const Eigen::VectorXd>& y);
+
+  /**
+   * Adds the samples of another accumulator to this one.
+   *
+   * @param other The accumulator to add.
+   */
+  OLSAccumulator& operator+=(const OLSAccumulator& other);
+
+  /**
+   * Returns XᵀX.
+   */
+  Eigen::MatrixXd XtX() const {
+    return m_XtX.selfadjointView<Eigen::Lower>();
+  }
+
+  /**
+   * Returns Xᵀy.
+   */
+  const Eigen::VectorXd& Xty() const { return m_Xty; }
+
+  /**
+   * Returns yᵀy.
+   */
+  double yty() const { return m_yty; }
+
+  /**
+   * Returns Σy.
+   */
+  double SumY() const { return m_sumY; }
+
+  /**
+   * Returns the number of samples.
+   */
+  int Size() const { return m_size; }
+
+ private:
+  // Only the lower triangle is kept up to date
+  Eigen::MatrixXd m_XtX;
+  Eigen::VectorXd m_Xty;
+  double m_yty = 0.0;
+  double m_sumY = 0.0;
+  int m_size = 0;
+};
+
 /**
  * Performs ordinary least squares multiple regression on the provided data.
  *
@@ -29,4 +99,12 @@ struct OLSResult {
  */
 OLSResult OLS(const Eigen::MatrixXd& X, const Eigen::VectorXd& y);
 
+/**
+ * Performs ordinary least squares multiple regression on the accumulated
+ * sufficient statistics of the data.
+ *
+ * @param sums The accumulated data.
+ */
+OLSResult OLS(const OLSAccumulator& sums);
+
 }  // namespace sysid
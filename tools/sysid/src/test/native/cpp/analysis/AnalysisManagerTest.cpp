@@ -0,0 +1,134 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/sysid/analysis/AnalysisManager.hpp"
+
+#include <cmath>
+#include <string>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "wpi/sysid/analysis/SimpleMotorSim.hpp"
+#include "wpi/units/time.hpp"
+#include "wpi/units/voltage.hpp"
+#include "wpi/util/Logger.hpp"
+
+namespace {
+
+/**
+ * Returns a simulated test run with position and velocity sampled slightly
+ * after voltage.
+ *
+ * @param model The simulation model.
+ * @param dynamic True for a dynamic (step voltage) test, false for a
+ *                quasistatic (ramp voltage) test.
+ * @param direction 1 for a forward test, -1 for a reverse test.
+ */
+sysid::MotorData CollectData(sysid::SimpleMotorSim& model, bool dynamic,
+                             double direction) {
+  constexpr wpi::units::second_t T = 5_ms;
+  constexpr int kSamples = 1000;
+
+  sysid::MotorData data;
+  auto& run = data.runs.emplace_back();
+  model.Reset();
+  for (int i = 0; i < kSamples; ++i) {
+    auto voltage = 0_V;
+    if (i > 10) {
+      voltage = dynamic ? direction * 7_V : direction * 0.25_V / 1_s * (i * T);
+    }
+    run.voltage.emplace_back(i * T, voltage);
+    run.position.emplace_back(i * T + 1_ms, model.GetPosition());
+    // A bit of deterministic noise so the fit isn't perfect
+    run.velocity.emplace_back(i * T + 1_ms,
+                              model.GetVelocity() + 0.01 * std::sin(i));
+    model.Update(voltage, T);
+  }
+  return data;
+}
+
+sysid::TestData CollectTestData() {
+  sysid::SimpleMotorSim model{0.5, 2.0, 0.3};
+
+  sysid::TestData data;
+  data.distanceUnit = "Meters";
+  data.mechanismType = sysid::analysis::kSimple;
+  data.motorData["quasistatic-forward"] = CollectData(model, false, 1);
+  data.motorData["quasistatic-reverse"] = CollectData(model, false, -1);
+  data.motorData["dynamic-forward"] = CollectData(model, true, 1);
+  data.motorData["dynamic-reverse"] = CollectData(model, true, -1);
+  return data;
+}
+
+void CheckSameResults(sysid::AnalysisManager& actual,
+                      sysid::AnalysisManager& expected) {
+  auto actualGains = actual.CalculateFeedforward().olsResult;
+  auto expectedGains = expected.CalculateFeedforward().olsResult;
+  REQUIRE(actualGains.coeffs.size() == expectedGains.coeffs.size());
+  for (size_t i = 0; i < actualGains.coeffs.size(); ++i) {
+    CHECK(actualGains.coeffs[i] ==
+          Catch::Approx(expectedGains.coeffs[i]).margin(1e-9));
+  }
+  CHECK(actualGains.rSquared ==
+        Catch::Approx(expectedGains.rSquared).margin(1e-9));
+  CHECK(actualGains.rmse == Catch::Approx(expectedGains.rmse).margin(1e-9));
+
+  CHECK(actual.GetFilteredData().slowForward ==
+        expected.GetFilteredData().slowForward);
+  CHECK(actual.GetFilteredData().fastBackward ==
+        expected.GetFilteredData().fastBackward);
+  CHECK(actual.GetRawData().fastForward == expected.GetRawData().fastForward);
+  CHECK(actual.GetPositionDelay() == expected.GetPositionDelay());
+  CHECK(actual.GetVelocityDelay() == expected.GetVelocityDelay());
+}
+
+}  // namespace
+
+TEST_CASE("AnalysisManagerTest SettingsChangeMatchesFreshAnalysis",
+          "[sysid]") {
+  wpi::util::Logger logger;
+  auto data = CollectTestData();
+
+  sysid::AnalysisManager::Settings settings;
+  sysid::AnalysisManager manager{data, settings, logger};
+  manager.PrepareData();
+
+  // The first analysis picks defaults for these
+  CHECK(std::isfinite(settings.velocityThreshold));
+  CHECK(settings.stepTestDuration > 0_s);
+
+  auto check = [&] {
+    manager.PrepareData();
+
+    // A new manager with the same settings analyzes from scratch
+    sysid::AnalysisManager::Settings freshSettings;
+    sysid::AnalysisManager fresh{data, freshSettings, logger};
+    freshSettings = settings;
+    fresh.PrepareData();
+
+    CheckSameResults(manager, fresh);
+  };
+
+  SECTION("Test duration") {
+    settings.stepTestDuration *= 0.5;
+    check();
+  }
+
+  SECTION("Median window") {
+    settings.medianWindow = 5;
+    check();
+  }
+
+  SECTION("Velocity threshold") {
+    settings.velocityThreshold *= 2;
+    check();
+  }
+
+  SECTION("Units") {
+    manager.OverrideUnits("Feet");
+    data.distanceUnit = "Feet";
+    check();
+  }
+}
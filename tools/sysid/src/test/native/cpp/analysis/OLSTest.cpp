@@ -69,6 +69,28 @@ TEST_CASE("OLSTest TwoVariablesFivePoints", "[sysid]") {
   CHECK(rSquared == Catch::Approx(0.91906029466386019).margin(1e-12));
 }
 
+TEST_CASE("OLSTest AccumulatorMatchesOLS", "[sysid]") {
+  Eigen::MatrixXd X{{1, 2}, {1, 3}, {1, 5}, {1, 7}, {1, 9}};
+  Eigen::VectorXd y{{4}, {5}, {7}, {10}, {15}};
+
+  // Accumulate the samples in two disjoint parts
+  sysid::OLSAccumulator sums{2};
+  sums.Add(X.topRows(2), y.head(2));
+  sysid::OLSAccumulator rest{2};
+  rest.Add(X.bottomRows(3), y.tail(3));
+  sums += rest;
+  CHECK(sums.Size() == 5);
+
+  auto expected = sysid::OLS(X, y);
+  auto [coeffs, rSquared, rmse] = sysid::OLS(sums);
+  CHECK(coeffs.size() == 2u);
+
+  CHECK(coeffs[0] == Catch::Approx(expected.coeffs[0]).margin(1e-12));
+  CHECK(coeffs[1] == Catch::Approx(expected.coeffs[1]).margin(1e-12));
+  CHECK(rSquared == Catch::Approx(expected.rSquared).margin(1e-12));
+  CHECK(rmse == Catch::Approx(expected.rmse).margin(1e-12));
+}
+
 #if !defined(NDEBUG) && !defined(_WIN32)
 TEST_CASE("OLSTest MalformedData", "[sysid]") {
   Eigen::MatrixXd X{{1, 2}, {1, 3}, {1, 4}};
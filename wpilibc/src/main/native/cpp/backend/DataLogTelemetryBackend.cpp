@@ -17,6 +17,7 @@
 #include "wpi/datalog/DataLog.hpp"
 #include "wpi/telemetry/TelemetryEntry.hpp"
 #include "wpi/telemetry/TelemetryRegistry.hpp"
+#include "wpi/telemetry/TelemetryTime.hpp"
 #include "wpi/util/json.hpp"
 #include "wpi/util/mutex.hpp"
 
@@ -96,9 +97,9 @@ class DataLogTelemetryBackend::Entry : public wpi::telemetry::TelemetryEntry {
       }
       if (auto entry = std::get_if<EntryType>(&m_entry)) {
         if (m_keepDuplicates) {
-          entry->Append(value);
+          entry->Append(value, wpi::telemetry::GetLogTime());
         } else {
-          entry->Update(value);
+          entry->Update(value, wpi::telemetry::GetLogTime());
         }
       } else {
         typeMismatch = true;
@@ -126,9 +127,9 @@ class DataLogTelemetryBackend::Entry : public wpi::telemetry::TelemetryEntry {
       if (auto entry = std::get_if<EntryType>(&m_entry);
           entry && m_typeString == typeString) {
         if (m_keepDuplicates) {
-          entry->Append(value);
+          entry->Append(value, wpi::telemetry::GetLogTime());
         } else {
-          entry->Update(value);
+          entry->Update(value, wpi::telemetry::GetLogTime());
         }
       } else {
         typeMismatch = true;
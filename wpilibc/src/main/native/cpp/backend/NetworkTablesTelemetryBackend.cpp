@@ -16,6 +16,7 @@
 #include "wpi/nt/NetworkTableInstance.hpp"
 #include "wpi/telemetry/TelemetryEntry.hpp"
 #include "wpi/telemetry/TelemetryRegistry.hpp"
+#include "wpi/telemetry/TelemetryTime.hpp"
 #include "wpi/util/json.hpp"
 #include "wpi/util/mutex.hpp"
 
@@ -94,7 +95,7 @@ class NetworkTablesTelemetryBackend::Entry
       if (!m_pub) {
         m_pub = Publish("boolean");
       }
-      typeMismatch = !m_pub.SetBoolean(value);
+      typeMismatch = !m_pub.SetBoolean(value, wpi::telemetry::GetLogTime());
     }
     if (typeMismatch) {
       wpi::telemetry::TelemetryRegistry::ReportWarning(m_path, "type mismatch");
@@ -111,7 +112,7 @@ class NetworkTablesTelemetryBackend::Entry
       if (!m_pub) {
         m_pub = Publish("int");
       }
-      typeMismatch = !m_pub.SetInteger(value);
+      typeMismatch = !m_pub.SetInteger(value, wpi::telemetry::GetLogTime());
     }
     if (typeMismatch) {
       wpi::telemetry::TelemetryRegistry::ReportWarning(m_path, "type mismatch");
@@ -128,7 +129,7 @@ class NetworkTablesTelemetryBackend::Entry
       if (!m_pub) {
         m_pub = Publish("float");
       }
-      typeMismatch = !m_pub.SetFloat(value);
+      typeMismatch = !m_pub.SetFloat(value, wpi::telemetry::GetLogTime());
     }
     if (typeMismatch) {
       wpi::telemetry::TelemetryRegistry::ReportWarning(m_path, "type mismatch");
@@ -145,7 +146,7 @@ class NetworkTablesTelemetryBackend::Entry
       if (!m_pub) {
         m_pub = Publish("double");
       }
-      typeMismatch = !m_pub.SetDouble(value);
+      typeMismatch = !m_pub.SetDouble(value, wpi::telemetry::GetLogTime());
     }
     if (typeMismatch) {
       wpi::telemetry::TelemetryRegistry::ReportWarning(m_path, "type mismatch");
@@ -162,7 +163,8 @@ class NetworkTablesTelemetryBackend::Entry
       if (!m_pub) {
         m_pub = Publish(typeString);
       }
-      typeMismatch = m_typeString != typeString || !m_pub.SetString(value);
+      typeMismatch = m_typeString != typeString ||
+                     !m_pub.SetString(value, wpi::telemetry::GetLogTime());
     }
     if (typeMismatch) {
       wpi::telemetry::TelemetryRegistry::ReportWarning(m_path, "type mismatch");
@@ -179,7 +181,8 @@ class NetworkTablesTelemetryBackend::Entry
       if (!m_pub) {
         m_pub = Publish("boolean[]");
       }
-      typeMismatch = !m_pub.SetBooleanArray(value);
+      typeMismatch =
+          !m_pub.SetBooleanArray(value, wpi::telemetry::GetLogTime());
     }
     if (typeMismatch) {
       wpi::telemetry::TelemetryRegistry::ReportWarning(m_path, "type mismatch");
@@ -196,7 +199,8 @@ class NetworkTablesTelemetryBackend::Entry
       if (!m_pub) {
         m_pub = Publish("boolean[]");
       }
-      typeMismatch = !m_pub.SetBooleanArray(value);
+      typeMismatch =
+          !m_pub.SetBooleanArray(value, wpi::telemetry::GetLogTime());
     }
     if (typeMismatch) {
       wpi::telemetry::TelemetryRegistry::ReportWarning(m_path, "type mismatch");
@@ -223,7 +227,8 @@ class NetworkTablesTelemetryBackend::Entry
       if (!m_pub) {
         m_pub = Publish("int[]");
       }
-      typeMismatch = !m_pub.SetIntegerArray(value);
+      typeMismatch =
+          !m_pub.SetIntegerArray(value, wpi::telemetry::GetLogTime());
     }
     if (typeMismatch) {
       wpi::telemetry::TelemetryRegistry::ReportWarning(m_path, "type mismatch");
@@ -240,7 +245,7 @@ class NetworkTablesTelemetryBackend::Entry
       if (!m_pub) {
         m_pub = Publish("float[]");
       }
-      typeMismatch = !m_pub.SetFloatArray(value);
+      typeMismatch = !m_pub.SetFloatArray(value, wpi::telemetry::GetLogTime());
     }
     if (typeMismatch) {
       wpi::telemetry::TelemetryRegistry::ReportWarning(m_path, "type mismatch");
@@ -257,7 +262,7 @@ class NetworkTablesTelemetryBackend::Entry
       if (!m_pub) {
         m_pub = Publish("double[]");
       }
-      typeMismatch = !m_pub.SetDoubleArray(value);
+      typeMismatch = !m_pub.SetDoubleArray(value, wpi::telemetry::GetLogTime());
     }
     if (typeMismatch) {
       wpi::telemetry::TelemetryRegistry::ReportWarning(m_path, "type mismatch");
@@ -274,7 +279,7 @@ class NetworkTablesTelemetryBackend::Entry
       if (!m_pub) {
         m_pub = Publish("string[]");
       }
-      typeMismatch = !m_pub.SetStringArray(value);
+      typeMismatch = !m_pub.SetStringArray(value, wpi::telemetry::GetLogTime());
     }
     if (typeMismatch) {
       wpi::telemetry::TelemetryRegistry::ReportWarning(m_path, "type mismatch");
@@ -301,7 +306,8 @@ class NetworkTablesTelemetryBackend::Entry
       if (!m_pub) {
         m_pub = Publish(typeString);
       }
-      typeMismatch = m_typeString != typeString || !m_pub.SetRaw(value);
+      typeMismatch = m_typeString != typeString ||
+                     !m_pub.SetRaw(value, wpi::telemetry::GetLogTime());
     }
     if (typeMismatch) {
       wpi::telemetry::TelemetryRegistry::ReportWarning(m_path, "type mismatch");
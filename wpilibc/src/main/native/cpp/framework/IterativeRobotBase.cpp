@@ -10,6 +10,7 @@
 #include "wpi/hal/DriverStationTypes.hpp"
 #include "wpi/nt/NetworkTableInstance.hpp"
 #include "wpi/system/Errors.hpp"
+#include "wpi/system/Profiler.hpp"
 #include "wpi/tunables/TunableRegistry.hpp"
 #include "wpi/util/print.hpp"
 
@@ -92,6 +93,7 @@ wpi::units::second_t IterativeRobotBase::GetPeriod() const {
 }
 
 void IterativeRobotBase::LoopFunc() {
+  Profiler::Zone loopZone{"LoopFunc()"};
   wpi::internal::DriverStationBackend::RefreshData();
   m_watchdog.Reset();
 
@@ -120,15 +122,19 @@ void IterativeRobotBase::LoopFunc() {
 
     // Call current mode's entry function
     if (mode == RobotMode::UNKNOWN) {
+      Profiler::Zone zone{"DisabledInit()"};
       DisabledInit();
       m_watchdog.AddEpoch("DisabledInit()");
     } else if (mode == RobotMode::AUTONOMOUS) {
+      Profiler::Zone zone{"AutonomousInit()"};
       AutonomousInit();
       m_watchdog.AddEpoch("AutonomousInit()");
     } else if (mode == RobotMode::TELEOPERATED) {
+      Profiler::Zone zone{"TeleopInit()"};
       TeleopInit();
       m_watchdog.AddEpoch("TeleopInit()");
     } else if (mode == RobotMode::UTILITY) {
+      Profiler::Zone zone{"UtilityInit()"};
       UtilityInit();
       m_watchdog.AddEpoch("UtilityInit()");
     }
@@ -139,26 +145,37 @@ void IterativeRobotBase::LoopFunc() {
   // Call the appropriate function depending upon the current robot mode
   HAL_ObserveUserProgram(word.GetValue());
   if (mode == RobotMode::UNKNOWN) {
+    Profiler::Zone zone{"DisabledPeriodic()"};
     DisabledPeriodic();
     m_watchdog.AddEpoch("DisabledPeriodic()");
   } else if (mode == RobotMode::AUTONOMOUS) {
+    Profiler::Zone zone{"AutonomousPeriodic()"};
     AutonomousPeriodic();
     m_watchdog.AddEpoch("AutonomousPeriodic()");
   } else if (mode == RobotMode::TELEOPERATED) {
+    Profiler::Zone zone{"TeleopPeriodic()"};
     TeleopPeriodic();
     m_watchdog.AddEpoch("TeleopPeriodic()");
   } else if (mode == RobotMode::UTILITY) {
+    Profiler::Zone zone{"UtilityPeriodic()"};
     UtilityPeriodic();
     m_watchdog.AddEpoch("UtilityPeriodic()");
   }
 
-  RobotPeriodic();
-  m_watchdog.AddEpoch("RobotPeriodic()");
+  {
+    Profiler::Zone zone{"RobotPeriodic()"};
+    RobotPeriodic();
+    m_watchdog.AddEpoch("RobotPeriodic()");
+  }
 
-  wpi::tunables::TunableRegistry::Update();
-  m_watchdog.AddEpoch("TunableRegistry::Update()");
+  {
+    Profiler::Zone zone{"TunableRegistry::Update()"};
+    wpi::tunables::TunableRegistry::Update();
+    m_watchdog.AddEpoch("TunableRegistry::Update()");
+  }
 
   if constexpr (IsSimulation()) {
+    Profiler::Zone zone{"SimulationPeriodic()"};
     HAL_SimPeriodicBefore();
     SimulationPeriodic();
     HAL_SimPeriodicAfter();
@@ -14,6 +14,7 @@
 #include "wpi/hal/DriverStation.hpp"
 #include "wpi/hal/UsageReporting.hpp"
 #include "wpi/system/Errors.hpp"
+#include "wpi/system/Profiler.hpp"
 #include "wpi/system/RobotController.hpp"
 
 using namespace wpi;
@@ -32,6 +33,7 @@ void TimedRobot::StartCompetition() {
     if (!m_callbacks.RunCallbacks(m_notifier)) {
       break;
     }
+    Profiler::EndLoop();
   }
 }
 
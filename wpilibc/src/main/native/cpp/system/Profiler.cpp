@@ -0,0 +1,295 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/system/Profiler.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <deque>
+#include <format>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "wpi/datalog/DataLog.hpp"
+#include "wpi/system/Errors.hpp"
+#include "wpi/util/SmallString.hpp"
+#include "wpi/util/mutex.hpp"
+#include "wpi/util/raw_ostream.hpp"
+
+using namespace wpi;
+
+namespace {
+
+struct ThreadProfile;
+
+// A zone at a particular path. Only the owning thread enters and exits nodes,
+// so the per-loop fields aren't locked. The statistics are only updated by
+// EndLoop() with the profile mutex held, so they can be read by other threads.
+struct Node {
+  Node(ThreadProfile* profile, std::string_view name, Node* parent)
+      : profile{profile}, name{name}, parent{parent} {}
+
+  ThreadProfile* profile;
+  std::string name;
+  Node* parent;
+  std::vector<Node*> children;
+  // zones are usually entered in the same order every loop, so try the child
+  // after the last one entered first
+  size_t nextChild = 0;
+
+  // time in the zone during the current loop
+  int64_t loopTime = 0;
+  bool inLoop = false;
+
+  uint64_t loops = 0;
+  int64_t minTime = std::numeric_limits<int64_t>::max();
+  int64_t maxTime = 0;
+  int64_t totalTime = 0;
+  // loop times of the most recent loops, for percentiles
+  std::vector<uint32_t> samples;
+
+  wpi::log::DoubleLogEntry logEntry;
+  bool logStarted = false;
+
+  std::string GetPath() const;
+  void Reset();
+};
+
+struct ThreadProfile {
+  ThreadProfile() : current{&nodes.emplace_back(this, "", nullptr)} {}
+
+  // protects creating nodes and the node statistics
+  wpi::util::mutex mutex;
+  // deque, as nodes are pointed to
+  std::deque<Node> nodes;
+  Node* current;
+  // nodes with time in the current loop
+  std::vector<Node*> touched;
+};
+
+struct Registry {
+  wpi::util::mutex mutex;
+  std::vector<ThreadProfile*> profiles;
+};
+
+Registry& GetRegistry() {
+  static Registry registry;
+  return registry;
+}
+
+// Owns the profile of a thread, and removes it from the registry on thread
+// exit
+struct ThreadProfileHolder {
+  ~ThreadProfileHolder() {
+    if (profile) {
+      auto& registry = GetRegistry();
+      std::scoped_lock lock{registry.mutex};
+      std::erase(registry.profiles, profile.get());
+    }
+  }
+
+  std::unique_ptr<ThreadProfile> profile;
+};
+
+thread_local ThreadProfileHolder gThreadProfile;
+
+std::atomic<wpi::log::DataLog*> gLog{nullptr};
+
+}  // namespace
+
+std::string Node::GetPath() const {
+  if (!parent || !parent->parent) {
+    return name;
+  }
+  std::string path = parent->GetPath();
+  path += '/';
+  path += name;
+  return path;
+}
+
+void Node::Reset() {
+  loops = 0;
+  minTime = std::numeric_limits<int64_t>::max();
+  maxTime = 0;
+  totalTime = 0;
+  samples.clear();
+}
+
+static ThreadProfile& GetThreadProfile() {
+  auto& profile = gThreadProfile.profile;
+  if (!profile) {
+    profile = std::make_unique<ThreadProfile>();
+    auto& registry = GetRegistry();
+    std::scoped_lock lock{registry.mutex};
+    registry.profiles.emplace_back(profile.get());
+  }
+  return *profile;
+}
+
+static void AddStats(std::vector<Profiler::ZoneStats>& stats, const Node& node,
+                     const std::string& path, int depth) {
+  if (node.loops > 0) {
+    auto& zone = stats.emplace_back();
+    zone.path = path;
+    zone.depth = depth;
+    zone.loops = node.loops;
+    zone.min = wpi::units::microsecond_t{static_cast<double>(node.minTime)};
+    zone.max = wpi::units::microsecond_t{static_cast<double>(node.maxTime)};
+    zone.mean = wpi::units::microsecond_t{static_cast<double>(node.totalTime) /
+                                          node.loops};
+    std::vector<uint32_t> samples = node.samples;
+    size_t n = (samples.size() * 99 + 99) / 100 - 1;
+    std::nth_element(samples.begin(), samples.begin() + n, samples.end());
+    zone.p99 = wpi::units::microsecond_t{static_cast<double>(samples[n])};
+  }
+  for (auto child : node.children) {
+    AddStats(stats, *child, path + '/' + child->name, depth + 1);
+  }
+}
+
+std::atomic_bool Profiler::s_enabled{false};
+
+void Profiler::SetEnabled(bool enabled) {
+  s_enabled = enabled;
+}
+
+bool Profiler::IsEnabled() {
+  return s_enabled;
+}
+
+void* Profiler::Enter(std::string_view name) {
+  auto& profile = GetThreadProfile();
+  Node* parent = profile.current;
+  auto& children = parent->children;
+  Node* node = nullptr;
+  if (parent->nextChild < children.size() &&
+      children[parent->nextChild]->name == name) {
+    node = children[parent->nextChild];
+    ++parent->nextChild;
+  } else {
+    auto it = std::find_if(children.begin(), children.end(),
+                           [&](auto child) { return child->name == name; });
+    if (it == children.end()) {
+      std::scoped_lock lock{profile.mutex};
+      it = children.emplace(
+          children.end(), &profile.nodes.emplace_back(&profile, name, parent));
+    }
+    node = *it;
+    parent->nextChild = it - children.begin() + 1;
+  }
+  profile.current = node;
+  return node;
+}
+
+void Profiler::Exit(void* zone, wpi::hal::monotonic_clock::time_point start) {
+  auto node = static_cast<Node*>(zone);
+  node->loopTime += (wpi::hal::monotonic_clock::now() - start).count();
+  if (!node->inLoop) {
+    node->inLoop = true;
+    node->profile->touched.emplace_back(node);
+  }
+  node->profile->current = node->parent;
+}
+
+void Profiler::EndLoop() {
+  auto profile = gThreadProfile.profile.get();
+  if (!profile || profile->touched.empty()) {
+    return;
+  }
+
+  std::scoped_lock lock{profile->mutex};
+  // loaded with the lock held, so StopDataLog() waits for this loop to finish
+  // logging
+  auto log = gLog.load();
+  for (auto node : profile->touched) {
+    int64_t time = node->loopTime;
+    if (node->samples.size() < kNumSamples) {
+      node->samples.emplace_back(time);
+    } else {
+      node->samples[node->loops % kNumSamples] = time;
+    }
+    ++node->loops;
+    node->minTime = (std::min)(node->minTime, time);
+    node->maxTime = (std::max)(node->maxTime, time);
+    node->totalTime += time;
+
+    if (log) {
+      if (!node->logStarted) {
+        node->logEntry =
+            wpi::log::DoubleLogEntry{*log, "Profiler/" + node->GetPath()};
+        node->logStarted = true;
+      }
+      node->logEntry.Append(time / 1.0e6);
+    }
+
+    node->loopTime = 0;
+    node->inLoop = false;
+  }
+  profile->touched.clear();
+}
+
+std::vector<Profiler::ZoneStats> Profiler::GetStats() {
+  std::vector<ZoneStats> stats;
+  auto& registry = GetRegistry();
+  std::scoped_lock lock{registry.mutex};
+  for (auto profile : registry.profiles) {
+    std::scoped_lock profileLock{profile->mutex};
+    for (auto child : profile->nodes.front().children) {
+      AddStats(stats, *child, child->name, 0);
+    }
+  }
+  return stats;
+}
+
+void Profiler::ResetStats() {
+  auto& registry = GetRegistry();
+  std::scoped_lock lock{registry.mutex};
+  for (auto profile : registry.profiles) {
+    std::scoped_lock profileLock{profile->mutex};
+    for (auto& node : profile->nodes) {
+      node.Reset();
+    }
+  }
+}
+
+void Profiler::PrintStats() {
+  wpi::util::SmallString<1024> buf;
+  wpi::util::raw_svector_ostream os(buf);
+  PrintStats(os);
+  if (!buf.empty()) {
+    WPILIB_ReportWarning("{}", buf.c_str());
+  }
+}
+
+void Profiler::PrintStats(wpi::util::raw_ostream& os) {
+  for (auto&& zone : GetStats()) {
+    os << std::format(
+        "\t{}: min {:.6f}s mean {:.6f}s p99 {:.6f}s max {:.6f}s ({} loops)\n",
+        zone.path, zone.min.value(), zone.mean.value(), zone.p99.value(),
+        zone.max.value(), zone.loops);
+  }
+}
+
+void Profiler::StartDataLog(wpi::log::DataLog& log) {
+  wpi::log::DataLog* expected = nullptr;
+  gLog.compare_exchange_strong(expected, &log);
+}
+
+void Profiler::StopDataLog() {
+  if (!gLog.exchange(nullptr)) {
+    return;
+  }
+  auto& registry = GetRegistry();
+  std::scoped_lock lock{registry.mutex};
+  for (auto profile : registry.profiles) {
+    std::scoped_lock profileLock{profile->mutex};
+    for (auto& node : profile->nodes) {
+      node.logEntry = wpi::log::DoubleLogEntry{};
+      node.logStarted = false;
+    }
+  }
+}
@@ -9,7 +9,7 @@
 using namespace wpi;
 
 ScopedTracer::ScopedTracer(std::string_view name, wpi::util::raw_ostream& os)
-    : m_name(name), m_os(os) {
+    : m_name(name), m_os(os), m_zone(name) {
   m_tracer.ResetTimer();
 }
 
@@ -13,6 +13,10 @@
 #include "wpi/units/time.hpp"
 
 namespace wpi::sim {
+
+template <int States, int Inputs, int Outputs>
+class LinearSystemSimBatch;
+
 /**
  * This class helps simulate linear systems. To use this class, do the following
  * in the simulationPeriodic() method.
@@ -21,6 +25,9 @@ namespace wpi::sim {
  * voltage). Call the Update() method to update the simulation. Set simulated
  * sensor readings with the simulated positions in the GetOutput() method.
  *
+ * To update many simulations of the same size at once, see
+ * LinearSystemSimBatch.
+ *
  * @tparam States  Number of states of the system.
  * @tparam Inputs  Number of inputs to the system.
  * @tparam Outputs Number of outputs of the system.
@@ -124,6 +131,8 @@ class LinearSystemSim {
   }
 
  protected:
+  friend class LinearSystemSimBatch<States, Inputs, Outputs>;
+
   /**
    * Updates the state estimate of the system.
    *
@@ -0,0 +1,203 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "wpi/math/linalg/EigenCore.hpp"
+#include "wpi/math/random/Normal.hpp"
+#include "wpi/math/system/Discretization.hpp"
+#include "wpi/math/system/LinearSystem.hpp"
+#include "wpi/simulation/LinearSystemSim.hpp"
+#include "wpi/units/time.hpp"
+
+namespace wpi::sim {
+
+/**
+ * Steps many linear system simulations at once. This is useful for swarm or
+ * Monte Carlo simulations with many mechanisms.
+ *
+ * Simulations with identical plants are grouped together. Each group caches
+ * its discretized A and B matrices for the last timestep, and its members are
+ * stepped with a single matrix product over all of their states instead of
+ * discretizing the plant once per simulation.
+ *
+ * Only simulations using the plain linear system dynamics can be batched (for
+ * example DCMotorSim and FlywheelSim). Simulations that override the
+ * dynamics, such as ElevatorSim and SingleJointedArmSim, must still be updated
+ * individually.
+ *
+ * Added simulations must outlive the batch (or be removed from it first).
+ * Inputs are set on the simulations as usual before calling Update().
+ *
+ * @tparam States  Number of states of the systems.
+ * @tparam Inputs  Number of inputs to the systems.
+ * @tparam Outputs Number of outputs of the systems.
+ */
+template <int States, int Inputs, int Outputs>
+class LinearSystemSimBatch {
+ public:
+  /// The type of simulation this batch steps.
+  using Sim = LinearSystemSim<States, Inputs, Outputs>;
+
+  /**
+   * True if SimType uses the linear system dynamics of LinearSystemSim (i.e.
+   * does not override UpdateX()).
+   */
+  template <typename SimType>
+  static constexpr bool kIsBatchable =
+      std::derived_from<SimType, Sim> && requires {
+        requires std::is_same_v<decltype(&SimType::UpdateX),
+                                decltype(&Sim::UpdateX)>;
+      };
+
+  /**
+   * Adds a simulation to the batch.
+   *
+   * @param sim The simulation to add.
+   */
+  template <typename SimType>
+    requires kIsBatchable<SimType>
+  void Add(SimType& sim) {
+    auto group =
+        std::find_if(m_groups.begin(), m_groups.end(), [&](const Group& group) {
+          return IsSamePlant(group.plant, sim.m_plant);
+        });
+    if (group == m_groups.end()) {
+      group = m_groups.insert(m_groups.end(), Group{sim.m_plant});
+    }
+    group->members.emplace_back(
+        &sim, std::any_of(sim.m_measurementStdDevs.begin(),
+                          sim.m_measurementStdDevs.end(),
+                          [](double stdDev) { return stdDev != 0.0; }));
+  }
+
+  /**
+   * Removes a simulation from the batch.
+   *
+   * @param sim The simulation to remove.
+   */
+  void Remove(const Sim& sim) {
+    for (auto it = m_groups.begin(); it != m_groups.end(); ++it) {
+      auto& members = it->members;
+      auto member = std::find_if(
+          members.begin(), members.end(),
+          [&](const Member& member) { return member.sim == &sim; });
+      if (member != members.end()) {
+        members.erase(member);
+        if (members.empty()) {
+          m_groups.erase(it);
+        }
+        return;
+      }
+    }
+  }
+
+  /**
+   * Returns the number of simulations in the batch.
+   *
+   * @return The number of simulations in the batch.
+   */
+  size_t Size() const {
+    size_t size = 0;
+    for (auto&& group : m_groups) {
+      size += group.members.size();
+    }
+    return size;
+  }
+
+  /**
+   * Updates every simulation in the batch. This is equivalent to calling
+   * Update() on each of them.
+   *
+   * @param dt The time between updates.
+   */
+  void Update(wpi::units::second_t dt) {
+    for (auto&& group : m_groups) {
+      UpdateGroup(group, dt);
+    }
+  }
+
+ private:
+  struct Member {
+    Member(Sim* sim, bool hasNoise) : sim{sim}, hasNoise{hasNoise} {}
+
+    Sim* sim;
+    bool hasNoise;
+  };
+
+  struct Group {
+    explicit Group(
+        const wpi::math::LinearSystem<States, Inputs, Outputs>& plant)
+        : plant{plant} {}
+
+    wpi::math::LinearSystem<States, Inputs, Outputs> plant;
+    std::vector<Member> members;
+
+    // Discretized plant for discDt
+    wpi::units::second_t discDt{-1};
+    wpi::math::Matrixd<States, States> discA =
+        wpi::math::Matrixd<States, States>::Zero();
+    wpi::math::Matrixd<States, Inputs> discB =
+        wpi::math::Matrixd<States, Inputs>::Zero();
+
+    // Scratch storage with one column per member
+    Eigen::Matrix<double, States, Eigen::Dynamic> x;
+    Eigen::Matrix<double, Inputs, Eigen::Dynamic> u;
+    Eigen::Matrix<double, Outputs, Eigen::Dynamic> y;
+  };
+
+  static void UpdateGroup(Group& group, wpi::units::second_t dt) {
+    if (dt != group.discDt) {
+      wpi::math::DiscretizeAB<States, Inputs>(
+          group.plant.A(), group.plant.B(), dt, &group.discA, &group.discB);
+      group.discDt = dt;
+    }
+
+    // Gather the members' states and inputs into one column each
+    int count = static_cast<int>(group.members.size());
+    group.x.resize(Eigen::NoChange, count);
+    group.u.resize(Eigen::NoChange, count);
+    for (int i = 0; i < count; ++i) {
+      group.x.col(i) = group.members[i].sim->m_x;
+      group.u.col(i) = group.members[i].sim->m_u;
+    }
+
+    // xₖ₊₁ = Axₖ + Buₖ
+    group.x = group.discA * group.x + group.discB * group.u;
+
+    // yₖ = Cxₖ + Duₖ
+    group.y.noalias() = group.plant.C() * group.x;
+    group.y.noalias() += group.plant.D() * group.u;
+
+    for (int i = 0; i < count; ++i) {
+      auto& member = group.members[i];
+      member.sim->m_x = group.x.col(i);
+      member.sim->m_y = group.y.col(i);
+      if (member.hasNoise) {
+        member.sim->m_y +=
+            wpi::math::Normal<Outputs>(member.sim->m_measurementStdDevs);
+      }
+    }
+  }
+
+  static bool IsSamePlant(
+      const wpi::math::LinearSystem<States, Inputs, Outputs>& a,
+      const wpi::math::LinearSystem<States, Inputs, Outputs>& b) {
+    return a.A() == b.A() && a.B() == b.B() && a.C() == b.C() &&
+           a.D() == b.D();
+  }
+
+  std::vector<Group> m_groups;
+};
+
+}  // namespace wpi::sim
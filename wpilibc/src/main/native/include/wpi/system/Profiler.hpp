@@ -0,0 +1,173 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "wpi/hal/monotonic_clock.hpp"
+#include "wpi/units/time.hpp"
+
+namespace wpi::log {
+class DataLog;
+}  // namespace wpi::log
+
+namespace wpi::util {
+class raw_ostream;
+}  // namespace wpi::util
+
+namespace wpi {
+
+/**
+ * A hierarchical profiler for finding out where loop time goes.
+ *
+ * Code is timed by creating a Profiler::Zone at the top of the block to time.
+ * Zones created while another zone is active on the same thread are nested in
+ * it, so zones are identified by their path from the outermost zone, e.g.
+ * "LoopFunc()/RobotPeriodic()/CommandScheduler::Run()/Drive.Periodic()".
+ * TimedRobot, CommandScheduler, and ScopedTracer already add zones for the
+ * parts of the loop that they time with epochs.
+ *
+ * Each thread records into its own buffers without locking. At the end of
+ * each loop, EndLoop() totals the time spent in each zone during the loop and
+ * adds it to the zone's statistics. TimedRobot calls EndLoop() after every
+ * loop; other threads need to call it themselves.
+ *
+ * The profiler is disabled by default, in which case zones only check a flag.
+ */
+class Profiler final {
+ public:
+  Profiler() = delete;
+
+  /**
+   * Statistics of the time spent in a zone per loop, over the loops the zone
+   * was entered in.
+   */
+  struct ZoneStats {
+    /// Zone names from the outermost zone, separated by '/'.
+    std::string path;
+    /// Number of zones the zone is nested in.
+    int depth = 0;
+    /// Number of loops the zone was entered in.
+    uint64_t loops = 0;
+    /// Minimum time.
+    wpi::units::second_t min = 0_s;
+    /// Mean time.
+    wpi::units::second_t mean = 0_s;
+    /// 99th percentile time over the most recent kNumSamples loops.
+    wpi::units::second_t p99 = 0_s;
+    /// Maximum time.
+    wpi::units::second_t max = 0_s;
+  };
+
+  /// Number of recent loops kept for percentiles.
+  static constexpr size_t kNumSamples = 512;
+
+  /**
+   * Times the enclosing block as a zone. Zones must be destroyed in the
+   * reverse order of creation on the thread that created them, which RAII
+   * does naturally.
+   */
+  class Zone {
+   public:
+    /**
+     * Enters a zone.
+     *
+     * @param name The zone name; zones with the same name and parent zone
+     *             are combined.
+     */
+    explicit Zone(std::string_view name) {
+      if (s_enabled.load(std::memory_order_relaxed)) {
+        m_node = Enter(name);
+        m_start = wpi::hal::monotonic_clock::now();
+      }
+    }
+
+    ~Zone() {
+      if (m_node) {
+        Exit(m_node, m_start);
+      }
+    }
+
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+
+   private:
+    void* m_node = nullptr;
+    wpi::hal::monotonic_clock::time_point m_start;
+  };
+
+  /**
+   * Enables or disables the profiler. Zones that are active when it is
+   * disabled are still recorded.
+   *
+   * @param enabled True to enable.
+   */
+  static void SetEnabled(bool enabled);
+
+  /**
+   * Returns true if the profiler is enabled.
+   */
+  static bool IsEnabled();
+
+  /**
+   * Ends a loop on the current thread, adding the time spent in each zone
+   * during the loop to the zone statistics and the data log.
+   */
+  static void EndLoop();
+
+  /**
+   * Gets the statistics of all zones. Each zone follows the zone it is nested
+   * in; zones of different threads are listed separately.
+   */
+  static std::vector<ZoneStats> GetStats();
+
+  /**
+   * Clears the statistics of all zones.
+   */
+  static void ResetStats();
+
+  /**
+   * Prints the statistics of all zones to the DriverStation.
+   */
+  static void PrintStats();
+
+  /**
+   * Prints the statistics of all zones to a stream.
+   *
+   * @param os output stream
+   */
+  static void PrintStats(wpi::util::raw_ostream& os);
+
+  /**
+   * Starts logging the time spent in each zone every loop to a data log.
+   * Entries are named "Profiler/" followed by the zone path. Only one log can
+   * be started; call StopDataLog() before starting another one.
+   *
+   * The log must outlive the program (as DataLogManager::GetLog() does), or
+   * StopDataLog() must be called before it is destroyed.
+   *
+   * @param log data log
+   */
+  static void StartDataLog(wpi::log::DataLog& log);
+
+  /**
+   * Stops logging to the data log started by StartDataLog(), finishing the
+   * log entries. Does nothing if no log is started.
+   */
+  static void StopDataLog();
+
+ private:
+  static void* Enter(std::string_view name);
+  static void Exit(void* node, wpi::hal::monotonic_clock::time_point start);
+
+  static std::atomic_bool s_enabled;
+};
+
+}  // namespace wpi
@@ -7,6 +7,7 @@
 #include <string>
 #include <string_view>
 
+#include "wpi/system/Profiler.hpp"
 #include "wpi/system/Tracer.hpp"
 
 namespace wpi::util {
@@ -20,6 +21,7 @@ namespace wpi {
  * need to create an instance at the top of the block you are timing. After the
  * block finishes execution (i.e. when the ScopedTracer instance gets
  * destroyed), the epoch is printed to the provided wpi::util::raw_ostream.
+ * The block is also timed as a Profiler zone.
  */
 class ScopedTracer {
  public:
@@ -39,5 +41,6 @@ class ScopedTracer {
   Tracer m_tracer;
   std::string m_name;
   wpi::util::raw_ostream& m_os;
+  Profiler::Zone m_zone;
 };
 }  // namespace wpi
@@ -0,0 +1,199 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/system/Profiler.hpp"
+
+#include <stdint.h>
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "wpi/datalog/DataLogReader.hpp"
+#include "wpi/datalog/DataLogWriter.hpp"
+#include "wpi/simulation/SimHooks.hpp"
+#include "wpi/util/MemoryBuffer.hpp"
+#include "wpi/util/SmallString.hpp"
+#include "wpi/util/StringExtras.hpp"
+#include "wpi/util/raw_ostream.hpp"
+
+using Catch::Matchers::WithinAbs;
+
+namespace {
+class ProfilerFixture {
+ public:
+  ProfilerFixture() {
+    wpi::sim::PauseTiming();
+    wpi::Profiler::SetEnabled(true);
+    wpi::Profiler::ResetStats();
+  }
+
+  ~ProfilerFixture() {
+    wpi::Profiler::SetEnabled(false);
+    wpi::sim::ResumeTiming();
+  }
+};
+
+struct LogCounts {
+  int starts = 0;
+  int values = 0;
+  int finishes = 0;
+};
+
+// Counts the records of the "Profiler/logged" entry
+LogCounts ReadLog(std::vector<uint8_t>& data) {
+  wpi::log::DataLogReader reader{
+      wpi::util::MemoryBuffer::GetMemBufferCopy(data, "test")};
+  REQUIRE(reader.IsValid());
+  LogCounts counts;
+  int entry = -1;
+  for (const auto& record : reader) {
+    if (record.IsStart()) {
+      wpi::log::StartRecordData start;
+      REQUIRE(record.GetStartData(&start));
+      if (start.name == "Profiler/logged") {
+        entry = start.entry;
+        ++counts.starts;
+      }
+    } else if (record.IsFinish()) {
+      int finished;
+      REQUIRE(record.GetFinishEntry(&finished));
+      if (finished == entry) {
+        ++counts.finishes;
+      }
+    } else if (!record.IsControl() && record.GetEntry() == entry) {
+      ++counts.values;
+    }
+  }
+  return counts;
+}
+
+void LoggedLoop() {
+  {
+    wpi::Profiler::Zone zone{"logged"};
+    wpi::sim::StepTiming(1_ms);
+  }
+  wpi::Profiler::EndLoop();
+}
+}  // namespace
+
+TEST_CASE_METHOD(ProfilerFixture, "Profiler nested zones", "[wpilibc]") {
+  for (int i = 1; i <= 3; ++i) {
+    {
+      wpi::Profiler::Zone outer{"outer"};
+      wpi::sim::StepTiming(1_ms);
+      wpi::Profiler::Zone inner{"inner"};
+      wpi::sim::StepTiming(i * 2_ms);
+    }
+    wpi::Profiler::EndLoop();
+  }
+
+  auto stats = wpi::Profiler::GetStats();
+  REQUIRE(stats.size() == 2);
+
+  CHECK(stats[0].path == "outer");
+  CHECK(stats[0].depth == 0);
+  CHECK(stats[0].loops == 3);
+  CHECK_THAT(stats[0].min.value(), WithinAbs(0.003, 1e-9));
+  CHECK_THAT(stats[0].mean.value(), WithinAbs(0.005, 1e-9));
+  CHECK_THAT(stats[0].p99.value(), WithinAbs(0.007, 1e-9));
+  CHECK_THAT(stats[0].max.value(), WithinAbs(0.007, 1e-9));
+
+  CHECK(stats[1].path == "outer/inner");
+  CHECK(stats[1].depth == 1);
+  CHECK(stats[1].loops == 3);
+  CHECK_THAT(stats[1].min.value(), WithinAbs(0.002, 1e-9));
+  CHECK_THAT(stats[1].mean.value(), WithinAbs(0.004, 1e-9));
+  CHECK_THAT(stats[1].max.value(), WithinAbs(0.006, 1e-9));
+}
+
+TEST_CASE_METHOD(ProfilerFixture, "Profiler zone entered twice in a loop",
+                 "[wpilibc]") {
+  for (int i = 0; i < 2; ++i) {
+    wpi::Profiler::Zone zone{"twice"};
+    wpi::sim::StepTiming(1_ms);
+  }
+  wpi::Profiler::EndLoop();
+
+  auto stats = wpi::Profiler::GetStats();
+  REQUIRE(stats.size() == 1);
+  CHECK(stats[0].loops == 1);
+  CHECK_THAT(stats[0].max.value(), WithinAbs(0.002, 1e-9));
+}
+
+TEST_CASE_METHOD(ProfilerFixture, "Profiler p99", "[wpilibc]") {
+  // 3 of 200 loops are slow, which is more than the slowest 1%
+  for (int i = 0; i < 200; ++i) {
+    {
+      wpi::Profiler::Zone zone{"p99"};
+      wpi::sim::StepTiming(i < 3 ? 10_ms : 1_ms);
+    }
+    wpi::Profiler::EndLoop();
+  }
+
+  auto stats = wpi::Profiler::GetStats();
+  REQUIRE(stats.size() == 1);
+  CHECK_THAT(stats[0].p99.value(), WithinAbs(0.010, 1e-9));
+  CHECK_THAT(stats[0].min.value(), WithinAbs(0.001, 1e-9));
+}
+
+TEST_CASE_METHOD(ProfilerFixture, "Profiler disabled", "[wpilibc]") {
+  wpi::Profiler::SetEnabled(false);
+  {
+    wpi::Profiler::Zone zone{"disabled"};
+    wpi::sim::StepTiming(1_ms);
+  }
+  wpi::Profiler::EndLoop();
+  CHECK(wpi::Profiler::GetStats().empty());
+}
+
+TEST_CASE_METHOD(ProfilerFixture, "Profiler PrintStats", "[wpilibc]") {
+  {
+    wpi::Profiler::Zone zone{"print"};
+    wpi::sim::StepTiming(1.5_ms);
+  }
+  wpi::Profiler::EndLoop();
+
+  wpi::util::SmallString<128> buf;
+  wpi::util::raw_svector_ostream os(buf);
+  wpi::Profiler::PrintStats(os);
+  std::string_view out = os.str();
+  CHECK(wpi::util::starts_with(out, "\tprint: min 0.001500s"));
+}
+
+TEST_CASE_METHOD(ProfilerFixture, "Profiler StopDataLog", "[wpilibc]") {
+  std::vector<uint8_t> data1;
+  {
+    wpi::log::DataLogWriter log{
+        std::make_unique<wpi::util::raw_uvector_ostream>(data1)};
+    wpi::Profiler::StartDataLog(log);
+    LoggedLoop();
+    LoggedLoop();
+    wpi::Profiler::StopDataLog();
+    log.Flush();
+  }
+
+  // doesn't touch the destroyed log
+  LoggedLoop();
+
+  std::vector<uint8_t> data2;
+  wpi::log::DataLogWriter log{
+      std::make_unique<wpi::util::raw_uvector_ostream>(data2)};
+  wpi::Profiler::StartDataLog(log);
+  LoggedLoop();
+  wpi::Profiler::StopDataLog();
+  log.Flush();
+
+  auto counts1 = ReadLog(data1);
+  CHECK(counts1.starts == 1);
+  CHECK(counts1.values == 2);
+  CHECK(counts1.finishes == 1);
+  auto counts2 = ReadLog(data2);
+  CHECK(counts2.starts == 1);
+  CHECK(counts2.values == 1);
+  CHECK(counts2.finishes == 1);
+}
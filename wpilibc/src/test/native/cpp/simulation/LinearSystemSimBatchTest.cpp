@@ -0,0 +1,91 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/simulation/LinearSystemSimBatch.hpp"
+
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "wpi/math/system/Models.hpp"
+#include "wpi/simulation/DCMotorSim.hpp"
+#include "wpi/simulation/ElevatorSim.hpp"
+#include "wpi/simulation/FlywheelSim.hpp"
+#include "wpi/simulation/SingleJointedArmSim.hpp"
+
+using DCMotorBatch = wpi::sim::LinearSystemSimBatch<2, 1, 2>;
+
+static_assert(DCMotorBatch::kIsBatchable<wpi::sim::DCMotorSim>);
+static_assert(DCMotorBatch::kIsBatchable<wpi::sim::LinearSystemSim<2, 1, 2>>);
+static_assert(
+    wpi::sim::LinearSystemSimBatch<1, 1, 1>::kIsBatchable<wpi::sim::FlywheelSim>);
+static_assert(!DCMotorBatch::kIsBatchable<wpi::sim::ElevatorSim>);
+static_assert(!DCMotorBatch::kIsBatchable<wpi::sim::SingleJointedArmSim>);
+
+static wpi::math::LinearSystem<2, 1, 2> MakePlant(double moi) {
+  return wpi::math::Models::SingleJointedArmFromPhysicalConstants(
+      wpi::math::DCMotor::NEO(1), wpi::units::kilogram_square_meter_t{moi},
+      1.0);
+}
+
+TEST_CASE("LinearSystemSimBatchTest MatchesUpdate", "[wpilibc][simulation]") {
+  auto gearbox = wpi::math::DCMotor::NEO(1);
+  std::vector<wpi::sim::DCMotorSim> batched;
+  std::vector<wpi::sim::DCMotorSim> individual;
+  for (int i = 0; i < 6; ++i) {
+    // two different plants, so two groups
+    auto plant = MakePlant(i % 2 == 0 ? 0.0005 : 0.002);
+    batched.emplace_back(plant, gearbox);
+    individual.emplace_back(plant, gearbox);
+  }
+
+  DCMotorBatch batch;
+  for (auto&& sim : batched) {
+    batch.Add(sim);
+  }
+  CHECK(batch.Size() == 6u);
+
+  for (int step = 0; step < 100; ++step) {
+    // change the timestep halfway through
+    auto dt = step < 50 ? 20_ms : 5_ms;
+    for (int i = 0; i < 6; ++i) {
+      double voltage = (i + 1) * (step % 10 < 5 ? 2.0 : -1.0);
+      batched[i].SetInput(0, voltage);
+      individual[i].SetInput(0, voltage);
+      individual[i].Update(dt);
+    }
+    batch.Update(dt);
+
+    for (int i = 0; i < 6; ++i) {
+      CHECK_THAT(batched[i].GetAngularPosition().value(),
+                 Catch::Matchers::WithinAbs(
+                     individual[i].GetAngularPosition().value(), 1e-9));
+      CHECK_THAT(batched[i].GetOutput(1),
+                 Catch::Matchers::WithinAbs(individual[i].GetOutput(1), 1e-9));
+    }
+  }
+}
+
+TEST_CASE("LinearSystemSimBatchTest Remove", "[wpilibc][simulation]") {
+  auto gearbox = wpi::math::DCMotor::NEO(1);
+  wpi::sim::DCMotorSim a{MakePlant(0.0005), gearbox};
+  wpi::sim::DCMotorSim b{MakePlant(0.0005), gearbox};
+
+  DCMotorBatch batch;
+  batch.Add(a);
+  batch.Add(b);
+  batch.Remove(a);
+  CHECK(batch.Size() == 1u);
+
+  a.SetInput(0, 12.0);
+  b.SetInput(0, 12.0);
+  batch.Update(20_ms);
+  CHECK(a.GetAngularVelocity().value() == 0.0);
+  CHECK(b.GetAngularVelocity().value() > 0.0);
+
+  batch.Remove(b);
+  CHECK(batch.Size() == 0u);
+  batch.Update(20_ms);
+}
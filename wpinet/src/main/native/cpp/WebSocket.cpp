@@ -4,8 +4,11 @@
 
 #include "wpi/net/WebSocket.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <random>
 #include <span>
 #include <string>
@@ -15,12 +18,15 @@
 #include "WebSocketDebug.hpp"
 #include "WebSocketSerializer.hpp"
 #include "wpi/net/HttpParser.hpp"
+#include "wpi/net/detail/WebSocketDeflate.hpp"
+#include "wpi/net/detail/WebSocketMask.hpp"
 #include "wpi/net/raw_uv_ostream.hpp"
 #include "wpi/net/uv/Stream.hpp"
 #include "wpi/util/Base64.hpp"
 #include "wpi/util/SmallString.hpp"
 #include "wpi/util/SmallVector.hpp"
 #include "wpi/util/StringExtras.hpp"
+#include "wpi/util/fmt/raw_ostream.hpp"
 #include "wpi/util/mutex.hpp"
 #include "wpi/util/print.hpp"
 #include "wpi/util/raw_ostream.hpp"
@@ -144,6 +150,8 @@ class WebSocket::ClientHandshakeData {
   bool hasConnection = false;
   bool hasAccept = false;
   bool hasProtocol = false;
+  bool hasExtensions = false;
+  std::optional<DeflateOptions> deflate;  // offered extension options
 
   std::weak_ptr<uv::Timer> timer;
 };
@@ -157,6 +165,71 @@ static std::string_view AcceptHash(std::string_view key,
   return wpi::util::Base64Encode(hash.RawFinal(hashBuf), buf);
 }
 
+namespace {
+// permessage-deflate extension parameters (RFC 7692 section 7.1)
+struct DeflateParams {
+  bool serverNoContextTakeover = false;
+  bool clientNoContextTakeover = false;
+  // 0 if not present
+  int serverMaxWindowBits = 0;
+  // 0 if not present, -1 if present without a value
+  int clientMaxWindowBits = 0;
+};
+}  // namespace
+
+// Parses one permessage-deflate extension offer or response.  Returns empty
+// if it's a different extension or the parameters are invalid.
+static std::optional<DeflateParams> ParseDeflateParams(std::string_view ext) {
+  auto [name, params] = wpi::util::split(ext, ';');
+  if (!wpi::util::equals_lower(wpi::util::trim(name), "permessage-deflate")) {
+    return {};
+  }
+  DeflateParams out;
+  while (!params.empty()) {
+    std::string_view param;
+    std::tie(param, params) = wpi::util::split(params, ';');
+    bool hasValue = param.find('=') != std::string_view::npos;
+    auto [key, value] = wpi::util::split(param, '=');
+    key = wpi::util::trim(key);
+    value = wpi::util::trim(value);
+    if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+      value = value.substr(1, value.size() - 2);
+    }
+    auto parseBits = [&](int* bits) {
+      auto v = wpi::util::parse_integer<int>(value, 10);
+      if (*bits != 0 || !v || *v < 8 || *v > 15) {
+        return false;
+      }
+      *bits = *v;
+      return true;
+    };
+    if (wpi::util::equals_lower(key, "server_no_context_takeover")) {
+      if (hasValue || out.serverNoContextTakeover) {
+        return {};
+      }
+      out.serverNoContextTakeover = true;
+    } else if (wpi::util::equals_lower(key, "client_no_context_takeover")) {
+      if (hasValue || out.clientNoContextTakeover) {
+        return {};
+      }
+      out.clientNoContextTakeover = true;
+    } else if (wpi::util::equals_lower(key, "server_max_window_bits")) {
+      if (!parseBits(&out.serverMaxWindowBits)) {
+        return {};
+      }
+    } else if (wpi::util::equals_lower(key, "client_max_window_bits")) {
+      if (!hasValue && out.clientMaxWindowBits == 0) {
+        out.clientMaxWindowBits = -1;
+      } else if (!parseBits(&out.clientMaxWindowBits)) {
+        return {};
+      }
+    } else {
+      return {};
+    }
+  }
+  return out;
+}
+
 WebSocket::WebSocket(uv::Stream& stream, bool server, const private_init&)
     : m_stream{stream}, m_server{server} {
   // Connect closed and error signals to ourselves
@@ -185,13 +258,13 @@ std::shared_ptr<WebSocket> WebSocket::CreateClient(
   return ws;
 }
 
-std::shared_ptr<WebSocket> WebSocket::CreateServer(uv::Stream& stream,
-                                                   std::string_view key,
-                                                   std::string_view version,
-                                                   std::string_view protocol) {
+std::shared_ptr<WebSocket> WebSocket::CreateServer(
+    uv::Stream& stream, std::string_view key, std::string_view version,
+    std::string_view protocol, std::string_view extensions,
+    const std::optional<DeflateOptions>& deflate) {
   auto ws = std::make_shared<WebSocket>(stream, true, private_init{});
   stream.SetData(ws);
-  ws->StartServer(key, version, protocol);
+  ws->StartServer(key, version, protocol, extensions, deflate);
   return ws;
 }
 
@@ -253,6 +326,30 @@ void WebSocket::StartClient(std::string_view uri, std::string_view host,
     os << "\r\n";
   }
 
+  // compression (if requested)
+  if (options.deflate) {
+    auto& deflate = *options.deflate;
+    os << "Sec-WebSocket-Extensions: permessage-deflate";
+    if (deflate.serverNoContextTakeover) {
+      os << "; server_no_context_takeover";
+    }
+    if (deflate.clientNoContextTakeover) {
+      os << "; client_no_context_takeover";
+    }
+    if (deflate.serverMaxWindowBits < 15) {
+      wpi::util::print(os, "; server_max_window_bits={}",
+                       std::clamp(deflate.serverMaxWindowBits, 8, 15));
+    }
+    // always allow the server to limit our window
+    os << "; client_max_window_bits";
+    if (deflate.clientMaxWindowBits < 15) {
+      wpi::util::print(os, "={}",
+                       std::clamp(deflate.clientMaxWindowBits, 8, 15));
+    }
+    os << "\r\n";
+    m_clientHandshake->deflate = deflate;
+  }
+
   // other headers
   for (auto&& header : options.extraHeaders) {
     os << header.first << ": " << header.second << "\r\n";
@@ -297,10 +394,31 @@ void WebSocket::StartClient(std::string_view uri, std::string_view host,
           }
           m_clientHandshake->hasAccept = true;
         } else if (wpi::util::equals_lower(name, "sec-websocket-extensions")) {
-          // No extensions are supported
-          if (!value.empty()) {
+          // Only permessage-deflate is supported, and only if it was offered
+          if (value.empty()) {
+            return;
+          }
+          auto& deflate = m_clientHandshake->deflate;
+          auto params = ParseDeflateParams(value);
+          if (!deflate || m_clientHandshake->hasExtensions || !params ||
+              params->clientMaxWindowBits < 0 ||
+              params->clientMaxWindowBits >
+                  std::clamp(deflate->clientMaxWindowBits, 8, 15) ||
+              params->serverMaxWindowBits >
+                  std::clamp(deflate->serverMaxWindowBits, 8, 15)) {
             return Terminate(1010, "unsupported extension");
           }
+          m_clientHandshake->hasExtensions = true;
+          int clientBits = std::clamp(deflate->clientMaxWindowBits, 8, 15);
+          if (params->clientMaxWindowBits > 0) {
+            clientBits = params->clientMaxWindowBits;
+          }
+          m_compressor = std::make_unique<detail::FrameCompressor>(
+              *deflate, clientBits, !params->clientNoContextTakeover);
+          m_inflater = std::make_unique<detail::WebSocketInflater>(
+              params->serverMaxWindowBits > 0 ? params->serverMaxWindowBits
+                                              : 15);
+          m_inflaterNoContextTakeover = params->serverNoContextTakeover;
         } else if (wpi::util::equals_lower(name, "sec-websocket-protocol")) {
           // Make sure it was one of the provided protocols
           bool match = false;
@@ -342,7 +460,9 @@ void WebSocket::StartClient(std::string_view uri, std::string_view host,
 }
 
 void WebSocket::StartServer(std::string_view key, std::string_view version,
-                            std::string_view protocol) {
+                            std::string_view protocol,
+                            std::string_view extensions,
+                            const std::optional<DeflateOptions>& deflate) {
   m_protocol = protocol;
 
   // Build server response
@@ -377,6 +497,54 @@ void WebSocket::StartServer(std::string_view key, std::string_view version,
     os << "Sec-WebSocket-Protocol: " << protocol << "\r\n";
   }
 
+  // accept the first acceptable permessage-deflate offer
+  if (deflate) {
+    std::optional<DeflateParams> params;
+    while (!params && !extensions.empty()) {
+      std::string_view ext;
+      std::tie(ext, extensions) = wpi::util::split(extensions, ',');
+      params = ParseDeflateParams(ext);
+    }
+    if (params) {
+      int serverBits = std::clamp(deflate->serverMaxWindowBits, 8, 15);
+      if (params->serverMaxWindowBits > 0) {
+        serverBits = (std::min)(serverBits, params->serverMaxWindowBits);
+      }
+      bool serverNoContextTakeover =
+          params->serverNoContextTakeover || deflate->serverNoContextTakeover;
+      bool clientNoContextTakeover =
+          params->clientNoContextTakeover || deflate->clientNoContextTakeover;
+
+      os << "Sec-WebSocket-Extensions: permessage-deflate";
+      if (serverNoContextTakeover) {
+        os << "; server_no_context_takeover";
+      }
+      if (clientNoContextTakeover) {
+        os << "; client_no_context_takeover";
+      }
+      if (serverBits < 15 || params->serverMaxWindowBits > 0) {
+        wpi::util::print(os, "; server_max_window_bits={}", serverBits);
+      }
+      // the client window can only be limited if the client allows it
+      int clientBits = 15;
+      if (params->clientMaxWindowBits != 0) {
+        clientBits = std::clamp(deflate->clientMaxWindowBits, 8, 15);
+        if (params->clientMaxWindowBits > 0) {
+          clientBits = (std::min)(clientBits, params->clientMaxWindowBits);
+        }
+        if (clientBits < 15 || params->clientMaxWindowBits > 0) {
+          wpi::util::print(os, "; client_max_window_bits={}", clientBits);
+        }
+      }
+      os << "\r\n";
+
+      m_compressor = std::make_unique<detail::FrameCompressor>(
+          *deflate, serverBits, !serverNoContextTakeover);
+      m_inflater = std::make_unique<detail::WebSocketInflater>(clientBits);
+      m_inflaterNoContextTakeover = clientNoContextTakeover;
+    }
+  }
+
   // end headers
   os << "\r\n";
 
@@ -420,19 +588,25 @@ void WebSocket::Shutdown() {
   m_stream.Shutdown([this] { m_stream.Close(); });
 }
 
-static inline void Unmask(std::span<uint8_t> data,
-                          std::span<const uint8_t, 4> key) {
-  int n = 0;
-  for (uint8_t& ch : data) {
-    ch ^= key[n++];
-    if (n >= 4) {
-      n = 0;
-    }
+// Appends payload data, unmasking it during the copy if key is non-null.
+// offset is the position of data within the frame payload.
+static void AppendPayload(wpi::util::SmallVectorImpl<uint8_t>& payload,
+                          std::string_view data, const uint8_t* key,
+                          size_t offset) {
+  size_t pos = payload.size();
+  payload.resize_for_overwrite(pos + data.size());
+  auto src = reinterpret_cast<const uint8_t*>(data.data());
+  if (key) {
+    detail::WebSocketMaskCopy(payload.data() + pos, src, data.size(),
+                              std::span<const uint8_t, 4>{key, 4}, offset);
+  } else if (!data.empty()) {
+    std::memcpy(payload.data() + pos, src, data.size());
   }
 }
 
 void WebSocket::HandleIncoming(uv::Buffer& buf, size_t size) {
-  m_lastReceivedTime = m_stream.GetLoopRef().Now().count();
+  m_lastReceivedTime.store(m_stream.GetLoopRef().Now().count(),
+                           std::memory_order_relaxed);
 
   // ignore incoming data if we're failed or closed
   if (m_state == State::FAILED || m_state == State::CLOSED) {
@@ -474,9 +648,14 @@ void WebSocket::HandleIncoming(uv::Buffer& buf, size_t size) {
           return;  // need more data
         }
 
-        // Validate RSV bits are zero
+        // Validate RSV bits are zero, except for RSV1 on the first frame of
+        // a compressed message
         if ((m_header[0] & 0x70) != 0) {
-          return Fail(1002, "nonzero RSV");
+          uint8_t opcode = m_header[0] & OP_MASK;
+          if ((m_header[0] & 0x30) != 0 || !m_inflater ||
+              (opcode != OP_TEXT && opcode != OP_BINARY)) {
+            return Fail(1002, "nonzero RSV");
+          }
         }
       }
 
@@ -556,45 +735,60 @@ void WebSocket::HandleIncoming(uv::Buffer& buf, size_t size) {
         need = m_frameStart + m_frameSize - m_payload.size();
       }
       size_t toCopy = (std::min)(need, data.size());
+      // If the message has masking, unmask it as it's copied
+      const uint8_t* key = (m_header[1] & FLAG_MASKING) != 0
+                               ? &m_header[m_headerSize - 4]
+                               : nullptr;
       if (control) {
-        m_controlPayload.append(data.data(), data.data() + toCopy);
+        AppendPayload(m_controlPayload, data.substr(0, toCopy), key,
+                      m_controlPayload.size());
       } else {
-        m_payload.append(data.data(), data.data() + toCopy);
+        AppendPayload(m_payload, data.substr(0, toCopy), key,
+                      m_payload.size() - m_frameStart);
       }
       data.remove_prefix(toCopy);
       need -= toCopy;
       if (need == 0) {
         // We have a complete frame
-        // If the message had masking, unmask it
-        if ((m_header[1] & FLAG_MASKING) != 0) {
-          Unmask(control ? std::span{m_controlPayload}
-                         : std::span{m_payload}.subspan(m_frameStart),
-                 std::span<const uint8_t, 4>{&m_header[m_headerSize - 4], 4});
-        }
-
         // Handle message
         bool fin = (m_header[0] & FLAG_FIN) != 0;
         uint8_t opcode = m_header[0] & OP_MASK;
+        if (opcode == OP_TEXT || opcode == OP_BINARY) {
+          m_compressedMessage = (m_header[0] & FLAG_RSV1) != 0;
+        }
+        // compressed messages are only delivered once complete
+        bool deliver = fin || (!m_combineFragments && !m_compressedMessage);
+        std::span<const uint8_t> payload = m_payload;
+        if (m_compressedMessage && fin && !control) {
+          if (m_inflaterNoContextTakeover) {
+            m_inflater->Reset();
+          }
+          auto inflated = m_inflater->Decompress(m_payload, m_maxMessageSize);
+          if (!inflated) {
+            return Fail(1007, "invalid or too large compressed message");
+          }
+          payload = *inflated;
+        }
         switch (opcode) {
           case OP_CONT:
             WS_DEBUG(m_stream, "WS Fragment {} [{}]", m_payload.size(),
                      DebugBinary(m_payload));
             switch (m_fragmentOpcode) {
               case OP_TEXT:
-                if (!m_combineFragments || fin) {
+                if (deliver) {
                   std::string_view content{
-                      reinterpret_cast<char*>(m_payload.data()),
-                      m_payload.size()};
+                      reinterpret_cast<const char*>(payload.data()),
+                      payload.size()};
                   WS_DEBUG(m_stream, "WS RecvText(Defrag) {} ({})",
-                           m_payload.size(), DebugText(content));
+                           payload.size(), DebugText(content));
                   text(content, fin);
                 }
                 break;
               case OP_BINARY:
-                if (!m_combineFragments || fin) {
+                if (deliver) {
                   WS_DEBUG(m_stream, "WS RecvBinary(Defrag) {} ({})",
-                           m_payload.size(), DebugBinary(m_payload));
-                  binary(m_payload, fin);
+                           payload.size(), DebugBinary(payload));
+                  binary(payload, fin);
                 }
                 break;
               default:
@@ -606,15 +800,15 @@ void WebSocket::HandleIncoming(uv::Buffer& buf, size_t size) {
             }
             break;
           case OP_TEXT: {
-            std::string_view content{reinterpret_cast<char*>(m_payload.data()),
-                                     m_payload.size()};
+            std::string_view content{
+                reinterpret_cast<const char*>(payload.data()), payload.size()};
             if (m_fragmentOpcode != 0) {
               WS_DEBUG(m_stream, "WS RecvText {} ({}) -> INCOMPLETE FRAGMENT",
-                       m_payload.size(), DebugText(content));
+                       payload.size(), DebugText(content));
               return Fail(1002, "incomplete fragment");
             }
-            if (!m_combineFragments || fin) {
-              WS_DEBUG(m_stream, "WS RecvText {} ({})", m_payload.size(),
+            if (deliver) {
+              WS_DEBUG(m_stream, "WS RecvText {} ({})", payload.size(),
                        DebugText(content));
               text(content, fin);
             }
@@ -627,13 +821,13 @@ void WebSocket::HandleIncoming(uv::Buffer& buf, size_t size) {
           case OP_BINARY:
             if (m_fragmentOpcode != 0) {
               WS_DEBUG(m_stream, "WS RecvBinary {} ({}) -> INCOMPLETE FRAGMENT",
-                       m_payload.size(), DebugBinary(m_payload));
+                       payload.size(), DebugBinary(payload));
               return Fail(1002, "incomplete fragment");
             }
-            if (!m_combineFragments || fin) {
-              WS_DEBUG(m_stream, "WS RecvBinary {} ({})", m_payload.size(),
-                       DebugBinary(m_payload));
-              binary(m_payload, fin);
+            if (deliver) {
+              WS_DEBUG(m_stream, "WS RecvBinary {} ({})", payload.size(),
+                       DebugBinary(payload));
+              binary(payload, fin);
             }
             if (!fin) {
               WS_DEBUG(m_stream, "WS RecvBinary {} StartFrag",
@@ -705,11 +899,14 @@ void WebSocket::HandleIncoming(uv::Buffer& buf, size_t size) {
         // Prepare for next message
         m_header.clear();
         m_headerSize = 0;
-        if (!m_combineFragments || fin) {
-          if (control) {
+        if (control) {
+          if (!m_combineFragments || fin) {
             m_controlPayload.clear();
-          } else {
-            m_payload.clear();
+          }
+        } else if (deliver) {
+          m_payload.clear();
+          if (fin) {
+            m_compressedMessage = false;
           }
         }
         m_frameStart = m_payload.size();
@@ -770,7 +967,7 @@ void WebSocket::SendFrames(
   int numBytes = 0;
   for (auto&& frame : frames) {
     VerboseDebug(frame);
-    numBytes += req->m_frames.AddFrame(frame, m_server);
+    numBytes += req->m_frames.AddFrame(frame, m_server, m_compressor.get());
     req->m_continueFrameOffs.emplace_back(numBytes);
     req->m_userBufs.append(frame.data.begin(), frame.data.end());
   }
@@ -817,7 +1014,7 @@ std::span<const WebSocket::Frame> WebSocket::TrySendFrames(
         m_lastWriteReq = req;
         return req;
       },
-      std::move(callback));
+      std::move(callback), m_compressor.get());
 }
 
 void WebSocket::SendControl(
@@ -0,0 +1,951 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/net/detail/WebSocketDeflate.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+using namespace wpi::net::detail;
+
+namespace {
+
+constexpr int kHashBits = 15;
+constexpr size_t kMaxWindow = 1 << 15;
+constexpr size_t kPrevMask = kMaxWindow - 1;
+constexpr int kMinMatch = 3;
+constexpr int kMaxMatch = 258;
+// candidates examined per position; trades speed for compression ratio
+constexpr int kMaxChain = 32;
+// matches at least this long are taken without searching further or trying
+// the next position
+constexpr int kGoodMatch = 32;
+constexpr size_t kMaxBlockTokens = 16384;
+// stream positions are rebased before exceeding this
+constexpr size_t kMaxPosition = INT32_MAX / 2;
+constexpr size_t kMaxStored = 65535;
+
+constexpr int kNumLitLen = 286;
+constexpr int kNumDist = 30;
+constexpr int kNumCodeLen = 19;
+constexpr int kMaxBits = 15;
+constexpr int kMaxCodeLenBits = 7;
+constexpr int kEndOfBlock = 256;
+
+constexpr uint16_t kLengthBase[29] = {3,  4,  5,  6,   7,   8,   9,   10,
+                                      11, 13, 15, 17,  19,  23,  27,  31,
+                                      35, 43, 51, 59,  67,  83,  99,  115,
+                                      131, 163, 195, 227, 258};
+constexpr uint8_t kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
+                                      1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                      4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr uint16_t kDistBase[30] = {
+    1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+    33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+    1025, 1537, 2049, 3073, 4097, 6145,  8193,  12289, 16385, 24577};
+constexpr uint8_t kDistExtra[30] = {0, 0, 0, 0, 1, 1, 2,  2,  3,  3,
+                                    4, 4, 5, 5, 6, 6, 7,  7,  8,  8,
+                                    9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+constexpr uint8_t kCodeLenOrder[kNumCodeLen] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// trailer of the empty stored block that ends every message; stripped by the
+// sender and restored by the receiver (RFC 7692 section 7.2.1)
+constexpr uint8_t kSyncTrailer[4] = {0x00, 0x00, 0xff, 0xff};
+
+uint32_t ReverseBits(uint32_t code, int len) {
+  uint32_t rev = 0;
+  for (int i = 0; i < len; ++i) {
+    rev = (rev << 1) | (code & 1);
+    code >>= 1;
+  }
+  return rev;
+}
+
+// Assigns canonical codes to the given code lengths. Codes are bit-reversed,
+// as DEFLATE packs Huffman codes starting from the most significant bit.
+void BuildCodes(const uint8_t* lens, int n, uint16_t* codes) {
+  uint16_t count[kMaxBits + 1] = {};
+  for (int i = 0; i < n; ++i) {
+    ++count[lens[i]];
+  }
+  count[0] = 0;
+  uint16_t next[kMaxBits + 1];
+  uint32_t code = 0;
+  for (int bits = 1; bits <= kMaxBits; ++bits) {
+    code = (code + count[bits - 1]) << 1;
+    next[bits] = code;
+  }
+  for (int i = 0; i < n; ++i) {
+    if (lens[i] != 0) {
+      codes[i] = ReverseBits(next[lens[i]]++, lens[i]);
+    }
+  }
+}
+
+// Computes Huffman code lengths no longer than maxBits. Symbols that don't
+// occur get no code. If the limit is exceeded, the frequencies are flattened
+// and the tree rebuilt; this converges quickly and costs little compression
+// for the rare blocks that need it.
+void BuildLengths(const uint32_t* freqs, int n, uint8_t* lens, int maxBits) {
+  std::array<uint32_t, kNumLitLen> scaled;
+  std::array<uint16_t, kNumLitLen> leaves;
+  std::array<uint32_t, 2 * kNumLitLen> weight;
+  std::array<uint16_t, 2 * kNumLitLen> parent;
+  std::array<uint8_t, 2 * kNumLitLen> depth;
+
+  std::copy_n(freqs, n, scaled.begin());
+  std::fill_n(lens, n, 0);
+  for (;;) {
+    int m = 0;
+    for (int i = 0; i < n; ++i) {
+      if (scaled[i] != 0) {
+        leaves[m++] = i;
+      }
+    }
+    if (m == 0) {
+      return;
+    }
+    if (m == 1) {
+      lens[leaves[0]] = 1;
+      return;
+    }
+    std::stable_sort(leaves.begin(), leaves.begin() + m,
+                     [&](auto a, auto b) { return scaled[a] < scaled[b]; });
+    for (int i = 0; i < m; ++i) {
+      weight[i] = scaled[leaves[i]];
+    }
+
+    // two-queue construction: leaves are sorted and internal nodes are
+    // created in nondecreasing weight order
+    int leaf = 0;
+    int node = m;
+    int next = m;
+    auto pick = [&] {
+      if (leaf < m && (node == next || weight[leaf] <= weight[node])) {
+        return leaf++;
+      }
+      return node++;
+    };
+    while (next < 2 * m - 1) {
+      int a = pick();
+      int b = pick();
+      weight[next] = weight[a] + weight[b];
+      parent[a] = next;
+      parent[b] = next;
+      ++next;
+    }
+    depth[2 * m - 2] = 0;
+    int maxDepth = 0;
+    for (int i = 2 * m - 3; i >= 0; --i) {
+      depth[i] = depth[parent[i]] + 1;
+      maxDepth = std::max<int>(maxDepth, depth[i]);
+    }
+
+    if (maxDepth <= maxBits) {
+      for (int i = 0; i < m; ++i) {
+        lens[leaves[i]] = depth[i];
+      }
+      return;
+    }
+    for (int i = 0; i < n; ++i) {
+      if (scaled[i] != 0) {
+        scaled[i] = (scaled[i] >> 1) | 1;
+      }
+    }
+  }
+}
+
+// Gives at least two symbols a code so the code is complete.
+void EnsureTwoSymbols(uint32_t* freqs, int n) {
+  int used = std::count_if(freqs, freqs + n, [](auto f) { return f != 0; });
+  for (int i = 0; i < n && used < 2; ++i) {
+    if (freqs[i] == 0) {
+      freqs[i] = 1;
+      ++used;
+    }
+  }
+}
+
+struct SymbolTables {
+  SymbolTables() {
+    for (int code = 0; code < 29; ++code) {
+      for (int i = 0; i < (1 << kLengthExtra[code]); ++i) {
+        lengthCode[kLengthBase[code] + i] = code;
+      }
+    }
+    // 258 is representable as 227 + 31, but has its own code
+    lengthCode[258] = 28;
+    for (int code = 0; code < kNumDist; ++code) {
+      for (int i = 0; i < (1 << kDistExtra[code]); ++i) {
+        int dist = kDistBase[code] + i;
+        if (dist <= 256) {
+          distCode[dist - 1] = code;
+        } else {
+          distCode[256 + ((dist - 1) >> 7)] = code;
+        }
+      }
+    }
+
+    for (int i = 0; i < 144; ++i) {
+      fixedLitLenLens[i] = 8;
+    }
+    for (int i = 144; i < 256; ++i) {
+      fixedLitLenLens[i] = 9;
+    }
+    for (int i = 256; i < 280; ++i) {
+      fixedLitLenLens[i] = 7;
+    }
+    for (int i = 280; i < 288; ++i) {
+      fixedLitLenLens[i] = 8;
+    }
+    fixedDistLens.fill(5);
+    BuildCodes(fixedLitLenLens.data(), 288, fixedLitLenCodes.data());
+    BuildCodes(fixedDistLens.data(), kNumDist, fixedDistCodes.data());
+  }
+
+  int LengthCode(int len) const { return lengthCode[len]; }
+  int DistCode(int dist) const {
+    return dist <= 256 ? distCode[dist - 1] : distCode[256 + ((dist - 1) >> 7)];
+  }
+
+  std::array<uint8_t, kMaxMatch + 1> lengthCode;
+  std::array<uint8_t, 512> distCode;
+  std::array<uint8_t, 288> fixedLitLenLens;
+  std::array<uint8_t, 32> fixedDistLens;
+  std::array<uint16_t, 288> fixedLitLenCodes;
+  std::array<uint16_t, 32> fixedDistCodes;
+};
+
+const SymbolTables& GetSymbolTables() {
+  static const SymbolTables tables;
+  return tables;
+}
+
+class BitWriter {
+ public:
+  explicit BitWriter(wpi::util::SmallVectorImpl<uint8_t>& out) : m_out{out} {}
+
+  // count must be 32 or less
+  void Write(uint32_t bits, int count) {
+    m_buf |= uint64_t{bits} << m_count;
+    m_count += count;
+    if (m_count >= 32) {
+      uint8_t bytes[4] = {static_cast<uint8_t>(m_buf),
+                          static_cast<uint8_t>(m_buf >> 8),
+                          static_cast<uint8_t>(m_buf >> 16),
+                          static_cast<uint8_t>(m_buf >> 24)};
+      m_out.append(bytes, bytes + 4);
+      m_buf >>= 32;
+      m_count -= 32;
+    }
+  }
+
+  void AlignToByte() {
+    while (m_count > 0) {
+      m_out.push_back(static_cast<uint8_t>(m_buf));
+      m_buf >>= 8;
+      m_count = std::max(m_count - 8, 0);
+    }
+    m_buf = 0;
+  }
+
+  void WriteBytes(std::span<const uint8_t> data) {
+    m_out.append(data.begin(), data.end());
+  }
+
+ private:
+  wpi::util::SmallVectorImpl<uint8_t>& m_out;
+  uint64_t m_buf = 0;
+  int m_count = 0;
+};
+
+struct CodeLenSymbol {
+  uint8_t symbol;
+  uint8_t extra;
+};
+
+// Run-length encodes the literal/length and distance code lengths for a
+// dynamic block header.
+int EncodeCodeLengths(const uint8_t* lens, int n, CodeLenSymbol* out) {
+  int count = 0;
+  for (int i = 0; i < n;) {
+    uint8_t len = lens[i];
+    int run = 1;
+    while (i + run < n && lens[i + run] == len) {
+      ++run;
+    }
+    i += run;
+    if (len == 0) {
+      while (run >= 11) {
+        int r = std::min(run, 138);
+        out[count++] = {18, static_cast<uint8_t>(r - 11)};
+        run -= r;
+      }
+      if (run >= 3) {
+        out[count++] = {17, static_cast<uint8_t>(run - 3)};
+        run = 0;
+      }
+    } else {
+      out[count++] = {len, 0};
+      --run;
+      while (run >= 3) {
+        int r = std::min(run, 6);
+        out[count++] = {16, static_cast<uint8_t>(r - 3)};
+        run -= r;
+      }
+    }
+    while (run-- > 0) {
+      out[count++] = {len, 0};
+    }
+  }
+  return count;
+}
+
+int ExtraBits(int codeLenSymbol) {
+  switch (codeLenSymbol) {
+    case 16:
+      return 2;
+    case 17:
+      return 3;
+    case 18:
+      return 7;
+    default:
+      return 0;
+  }
+}
+
+void WriteTokens(BitWriter& w, std::span<const WebSocketDeflater::Token> tokens,
+                 const uint8_t* litLenLens, const uint16_t* litLenCodes,
+                 const uint8_t* distLens, const uint16_t* distCodes) {
+  auto& tables = GetSymbolTables();
+  for (auto&& token : tokens) {
+    if (token.dist == 0) {
+      w.Write(litLenCodes[token.litlen], litLenLens[token.litlen]);
+    } else {
+      int lc = tables.LengthCode(token.litlen);
+      w.Write(litLenCodes[257 + lc], litLenLens[257 + lc]);
+      w.Write(token.litlen - kLengthBase[lc], kLengthExtra[lc]);
+      int dc = tables.DistCode(token.dist);
+      w.Write(distCodes[dc], distLens[dc]);
+      w.Write(token.dist - kDistBase[dc], kDistExtra[dc]);
+    }
+  }
+  w.Write(litLenCodes[kEndOfBlock], litLenLens[kEndOfBlock]);
+}
+
+// Writes a (non-final) block using whichever of stored, fixed Huffman, or
+// dynamic Huffman encoding is smallest.
+void WriteBlock(BitWriter& w, std::span<const WebSocketDeflater::Token> tokens,
+                std::span<const uint8_t> raw) {
+  auto& tables = GetSymbolTables();
+
+  uint32_t litLenFreqs[kNumLitLen] = {};
+  uint32_t distFreqs[kNumDist] = {};
+  uint64_t extraBits = 0;
+  for (auto&& token : tokens) {
+    if (token.dist == 0) {
+      ++litLenFreqs[token.litlen];
+    } else {
+      int lc = tables.LengthCode(token.litlen);
+      int dc = tables.DistCode(token.dist);
+      ++litLenFreqs[257 + lc];
+      ++distFreqs[dc];
+      extraBits += kLengthExtra[lc] + kDistExtra[dc];
+    }
+  }
+  litLenFreqs[kEndOfBlock] = 1;
+
+  // fixed Huffman cost
+  uint64_t fixedBits = 3 + extraBits;
+  for (int i = 0; i < kNumLitLen; ++i) {
+    fixedBits += uint64_t{litLenFreqs[i]} * tables.fixedLitLenLens[i];
+  }
+  for (int i = 0; i < kNumDist; ++i) {
+    fixedBits += uint64_t{distFreqs[i]} * 5;
+  }
+
+  // dynamic Huffman cost
+  EnsureTwoSymbols(distFreqs, kNumDist);
+  uint8_t lens[kNumLitLen + kNumDist];
+  uint8_t* litLenLens = lens;
+  uint8_t* distLens = lens + kNumLitLen;
+  BuildLengths(litLenFreqs, kNumLitLen, litLenLens, kMaxBits);
+  BuildLengths(distFreqs, kNumDist, distLens, kMaxBits);
+  int numLitLen = kNumLitLen;
+  while (numLitLen > 257 && litLenLens[numLitLen - 1] == 0) {
+    --numLitLen;
+  }
+  int numDist = kNumDist;
+  while (numDist > 1 && distLens[numDist - 1] == 0) {
+    --numDist;
+  }
+  // the two sets of lengths are encoded as one sequence
+  uint8_t headerLens[kNumLitLen + kNumDist];
+  std::copy_n(litLenLens, numLitLen, headerLens);
+  std::copy_n(distLens, numDist, headerLens + numLitLen);
+  CodeLenSymbol codeLenSyms[kNumLitLen + kNumDist];
+  int numCodeLenSyms =
+      EncodeCodeLengths(headerLens, numLitLen + numDist, codeLenSyms);
+  uint32_t codeLenFreqs[kNumCodeLen] = {};
+  for (int i = 0; i < numCodeLenSyms; ++i) {
+    ++codeLenFreqs[codeLenSyms[i].symbol];
+  }
+  EnsureTwoSymbols(codeLenFreqs, kNumCodeLen);
+  uint8_t codeLenLens[kNumCodeLen];
+  BuildLengths(codeLenFreqs, kNumCodeLen, codeLenLens, kMaxCodeLenBits);
+  int numCodeLen = kNumCodeLen;
+  while (numCodeLen > 4 && codeLenLens[kCodeLenOrder[numCodeLen - 1]] == 0) {
+    --numCodeLen;
+  }
+
+  uint64_t dynamicBits = 3 + 5 + 5 + 4 + 3 * numCodeLen + extraBits;
+  for (int i = 0; i < kNumCodeLen; ++i) {
+    dynamicBits +=
+        uint64_t{codeLenFreqs[i]} * (codeLenLens[i] + ExtraBits(i));
+  }
+  for (int i = 0; i < kNumLitLen; ++i) {
+    dynamicBits += uint64_t{litLenFreqs[i]} * litLenLens[i];
+  }
+  for (int i = 0; i < kNumDist; ++i) {
+    dynamicBits += uint64_t{distFreqs[i]} * distLens[i];
+  }
+
+  // stored cost, assuming worst case alignment padding
+  uint64_t storedBits = raw.size() * 8 +
+                        (raw.size() / kMaxStored + 1) * (3 + 7 + 32);
+
+  if (storedBits < fixedBits && storedBits < dynamicBits) {
+    do {
+      size_t len = std::min(raw.size(), kMaxStored);
+      w.Write(0, 3);
+      w.AlignToByte();
+      w.Write(len, 16);
+      w.Write(~len & 0xffff, 16);
+      w.WriteBytes(raw.subspan(0, len));
+      raw = raw.subspan(len);
+    } while (!raw.empty());
+  } else if (fixedBits <= dynamicBits) {
+    w.Write(1 << 1, 3);
+    WriteTokens(w, tokens, tables.fixedLitLenLens.data(),
+                tables.fixedLitLenCodes.data(), tables.fixedDistLens.data(),
+                tables.fixedDistCodes.data());
+  } else {
+    w.Write(2 << 1, 3);
+    w.Write(numLitLen - 257, 5);
+    w.Write(numDist - 1, 5);
+    w.Write(numCodeLen - 4, 4);
+    for (int i = 0; i < numCodeLen; ++i) {
+      w.Write(codeLenLens[kCodeLenOrder[i]], 3);
+    }
+    uint16_t codeLenCodes[kNumCodeLen];
+    BuildCodes(codeLenLens, kNumCodeLen, codeLenCodes);
+    for (int i = 0; i < numCodeLenSyms; ++i) {
+      auto [symbol, extra] = codeLenSyms[i];
+      w.Write(codeLenCodes[symbol], codeLenLens[symbol]);
+      w.Write(extra, ExtraBits(symbol));
+    }
+    uint16_t litLenCodes[kNumLitLen];
+    uint16_t distCodes[kNumDist];
+    BuildCodes(litLenLens, kNumLitLen, litLenCodes);
+    BuildCodes(distLens, kNumDist, distCodes);
+    WriteTokens(w, tokens, litLenLens, litLenCodes, distLens, distCodes);
+  }
+}
+
+inline uint32_t Hash3(const uint8_t* p) {
+  uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+  return (v * 0x9E3779B1u) >> (32 - kHashBits);
+}
+
+inline int MatchLength(const uint8_t* a, const uint8_t* b, int limit) {
+  int len = 0;
+  if constexpr (std::endian::native == std::endian::little) {
+    for (; len + 8 <= limit; len += 8) {
+      uint64_t x, y;
+      std::memcpy(&x, a + len, sizeof(x));
+      std::memcpy(&y, b + len, sizeof(y));
+      if (x != y) {
+        return len + std::countr_zero(x ^ y) / 8;
+      }
+    }
+  }
+  while (len < limit && a[len] == b[len]) {
+    ++len;
+  }
+  return len;
+}
+
+}  // namespace
+
+WebSocketDeflater::WebSocketDeflater(int windowBits)
+    : m_windowSize{size_t{1} << std::clamp(windowBits, 8, 15)},
+      m_head(size_t{1} << kHashBits, -1),
+      m_prev(kMaxWindow, -1) {}
+
+void WebSocketDeflater::Reset() {
+  // Stale hash entries are excluded by position rather than cleared, as this
+  // is called twice per message when compressing without context takeover.
+  m_offset += m_history.size();
+  m_history.clear();
+  m_validStart = m_offset;
+}
+
+void WebSocketDeflater::Compress(std::span<const uv::Buffer> in,
+                                 wpi::util::SmallVectorImpl<uint8_t>& out) {
+  // Discard history older than the window
+  if (m_history.size() > m_windowSize + kMaxWindow) {
+    size_t drop = m_history.size() - m_windowSize;
+    m_history.erase(m_history.begin(), m_history.begin() + drop);
+    m_offset += drop;
+  }
+
+  size_t size = 0;
+  for (auto&& buf : in) {
+    size += buf.len;
+  }
+
+  // Rebase stream positions before they overflow the hash tables. The shift
+  // is a multiple of the chain table size so chain indices stay valid.
+  if (m_offset + m_history.size() + size > kMaxPosition) {
+    int32_t shift = m_offset & ~kPrevMask;
+    int32_t valid = std::max(m_validStart, m_offset);
+    auto rebase = [&](int32_t& pos) {
+      pos = pos >= valid ? pos - shift : -1;
+    };
+    std::for_each(m_head.begin(), m_head.end(), rebase);
+    std::for_each(m_prev.begin(), m_prev.end(), rebase);
+    m_offset -= shift;
+    m_validStart = std::max(m_validStart - shift, 0);
+  }
+
+  size_t start = m_history.size();
+  m_history.reserve(start + size);
+  for (auto&& buf : in) {
+    auto bytes = buf.bytes();
+    m_history.insert(m_history.end(), bytes.begin(), bytes.end());
+  }
+  size_t end = m_history.size();
+
+  m_tokens.clear();
+  FindMatches(start, end);
+  WriteBlocks(start, out);
+}
+
+void WebSocketDeflater::FindMatches(size_t start, size_t end) {
+  const uint8_t* data = m_history.data();
+
+  // hash tables hold stream positions, which are m_offset + history index
+  auto insert = [&](size_t pos) {
+    if (end - pos >= kMinMatch) {
+      uint32_t h = Hash3(data + pos);
+      int32_t streamPos = m_offset + pos;
+      m_prev[streamPos & kPrevMask] = m_head[h];
+      m_head[h] = streamPos;
+    }
+  };
+
+  auto longestMatch = [&](size_t pos, int* bestDist) {
+    int limit = std::min<size_t>(kMaxMatch, end - pos);
+    int bestLen = kMinMatch - 1;
+    if (limit < kMinMatch) {
+      return 0;
+    }
+    int32_t streamPos = m_offset + pos;
+    int32_t minPos = std::max({streamPos - static_cast<int32_t>(m_windowSize),
+                               m_validStart, m_offset});
+    int32_t cand = m_head[Hash3(data + pos)];
+    for (int chain = kMaxChain; chain > 0 && cand >= minPos; --chain) {
+      const uint8_t* a = data + (cand - m_offset);
+      const uint8_t* b = data + pos;
+      if (a[bestLen] == b[bestLen] && a[0] == b[0] && a[1] == b[1]) {
+        int len = MatchLength(a, b, limit);
+        if (len > bestLen) {
+          bestLen = len;
+          *bestDist = streamPos - cand;
+          if (len >= kGoodMatch || len == limit) {
+            break;
+          }
+        }
+      }
+      // a slot overwritten by a newer position ends the chain
+      int32_t next = m_prev[cand & kPrevMask];
+      if (next >= cand) {
+        break;
+      }
+      cand = next;
+    }
+    return bestLen >= kMinMatch ? bestLen : 0;
+  };
+
+  // positions up to (but not including) next have already been inserted
+  auto emitMatch = [&](size_t pos, int len, int dist, size_t next) {
+    m_tokens.push_back(
+        {static_cast<uint16_t>(len), static_cast<uint16_t>(dist)});
+    for (; next < pos + len; ++next) {
+      insert(next);
+    }
+  };
+
+  // Lazy matching: a match is only taken if the match starting at the next
+  // position isn't longer.
+  int prevLen = 0;
+  int prevDist = 0;
+  size_t pos = start;
+  while (pos < end) {
+    int dist = 0;
+    int len = longestMatch(pos, &dist);
+    insert(pos);
+    if (prevLen != 0) {
+      if (prevLen >= len) {
+        emitMatch(pos - 1, prevLen, prevDist, pos + 1);
+        pos += prevLen - 1;
+        prevLen = 0;
+        continue;
+      }
+      m_tokens.push_back({data[pos - 1], 0});
+    }
+    if (len >= kGoodMatch) {
+      emitMatch(pos, len, dist, pos + 1);
+      pos += len;
+      prevLen = 0;
+    } else if (len != 0) {
+      prevLen = len;
+      prevDist = dist;
+      ++pos;
+    } else {
+      m_tokens.push_back({data[pos], 0});
+      prevLen = 0;
+      ++pos;
+    }
+  }
+}
+
+void WebSocketDeflater::WriteBlocks(size_t start,
+                                    wpi::util::SmallVectorImpl<uint8_t>& out) {
+  BitWriter w{out};
+  std::span<const Token> tokens{m_tokens};
+  size_t pos = start;
+  while (!tokens.empty()) {
+    auto block = tokens.subspan(0, std::min(tokens.size(), kMaxBlockTokens));
+    size_t len = 0;
+    for (auto&& token : block) {
+      len += token.dist == 0 ? 1 : token.litlen;
+    }
+    WriteBlock(w, block, std::span{m_history}.subspan(pos, len));
+    tokens = tokens.subspan(block.size());
+    pos += len;
+  }
+
+  // sync flush: an empty stored block, with its LEN and NLEN omitted
+  w.Write(0, 3);
+  w.AlignToByte();
+}
+
+namespace {
+
+constexpr int kFastBits = 9;
+
+// Huffman decoding table. Codes up to kFastBits long are decoded with a
+// single lookup; longer codes fall back to canonical decoding.
+struct HuffmanTable {
+  bool Build(const uint8_t* lens, int n) {
+    std::fill(std::begin(count), std::end(count), 0);
+    for (int i = 0; i < n; ++i) {
+      ++count[lens[i]];
+    }
+    count[0] = 0;
+    // reject over-subscribed codes
+    int left = 1;
+    for (int len = 1; len <= kMaxBits; ++len) {
+      left = (left << 1) - count[len];
+      if (left < 0) {
+        return false;
+      }
+    }
+    uint16_t offs[kMaxBits + 2];
+    offs[1] = 0;
+    for (int len = 1; len <= kMaxBits; ++len) {
+      offs[len + 1] = offs[len] + count[len];
+    }
+    for (int i = 0; i < n; ++i) {
+      if (lens[i] != 0) {
+        symbol[offs[lens[i]]++] = i;
+      }
+    }
+
+    uint16_t codes[288];
+    BuildCodes(lens, n, codes);
+    std::fill(std::begin(fast), std::end(fast), 0);
+    for (int i = 0; i < n; ++i) {
+      int len = lens[i];
+      if (len != 0 && len <= kFastBits) {
+        for (int j = codes[i]; j < (1 << kFastBits); j += 1 << len) {
+          fast[j] = (i << 4) | len;
+        }
+      }
+    }
+    return true;
+  }
+
+  // symbol << 4 | code length, or 0 for longer codes
+  uint16_t fast[1 << kFastBits];
+  uint16_t count[kMaxBits + 1];
+  uint16_t symbol[288];
+};
+
+// Reads bits from a message followed by the sync trailer.
+class BitReader {
+ public:
+  explicit BitReader(std::span<const uint8_t> in)
+      : m_in{in}, m_total{in.size() + sizeof(kSyncTrailer)} {}
+
+  void Refill() {
+    if constexpr (std::endian::native == std::endian::little) {
+      if (m_pos + 8 <= m_in.size()) {
+        uint64_t v;
+        std::memcpy(&v, m_in.data() + m_pos, sizeof(v));
+        m_buf |= v << m_count;
+        m_pos += (63 - m_count) >> 3;
+        m_count |= 56;
+        return;
+      }
+    }
+    while (m_count <= 56) {
+      uint8_t b = 0;
+      if (m_pos < m_in.size()) {
+        b = m_in[m_pos];
+      } else if (m_pos < m_total) {
+        b = kSyncTrailer[m_pos - m_in.size()];
+      }
+      ++m_pos;
+      m_buf |= uint64_t{b} << m_count;
+      m_count += 8;
+    }
+  }
+
+  // count must be 16 or less
+  uint32_t Bits(int count) {
+    if (m_count < count) {
+      Refill();
+    }
+    uint32_t v = m_buf & ((uint64_t{1} << count) - 1);
+    m_buf >>= count;
+    m_count -= count;
+    return v;
+  }
+
+  int Decode(const HuffmanTable& table) {
+    if (m_count < kMaxBits) {
+      Refill();
+    }
+    uint16_t entry = table.fast[m_buf & ((1 << kFastBits) - 1)];
+    if (entry != 0) {
+      int len = entry & 15;
+      m_buf >>= len;
+      m_count -= len;
+      return entry >> 4;
+    }
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (int len = 1; len <= kMaxBits; ++len) {
+      code |= m_buf & 1;
+      m_buf >>= 1;
+      --m_count;
+      int count = table.count[len];
+      if (code - first < count) {
+        return table.symbol[index + code - first];
+      }
+      index += count;
+      first = (first + count) << 1;
+      code <<= 1;
+    }
+    return -1;
+  }
+
+  void AlignToByte() {
+    int pad = m_count & 7;
+    m_buf >>= pad;
+    m_count -= pad;
+  }
+
+  size_t BitsConsumed() const { return m_pos * 8 - m_count; }
+  bool AtEnd() const { return BitsConsumed() + 7 >= m_total * 8; }
+  bool Overrun() const { return BitsConsumed() > m_total * 8; }
+
+ private:
+  std::span<const uint8_t> m_in;
+  size_t m_total;
+  // next byte to load
+  size_t m_pos = 0;
+  uint64_t m_buf = 0;
+  int m_count = 0;
+};
+
+struct FixedTables {
+  FixedTables() {
+    auto& tables = GetSymbolTables();
+    litLen.Build(tables.fixedLitLenLens.data(), 288);
+    dist.Build(tables.fixedDistLens.data(), 32);
+  }
+
+  HuffmanTable litLen;
+  HuffmanTable dist;
+};
+
+const FixedTables& GetFixedTables() {
+  static const FixedTables tables;
+  return tables;
+}
+
+bool ReadDynamicTables(BitReader& r, HuffmanTable& litLen,
+                       HuffmanTable& dist) {
+  int numLitLen = r.Bits(5) + 257;
+  int numDist = r.Bits(5) + 1;
+  int numCodeLen = r.Bits(4) + 4;
+  if (numLitLen > kNumLitLen || numDist > kNumDist) {
+    return false;
+  }
+
+  uint8_t codeLenLens[kNumCodeLen] = {};
+  for (int i = 0; i < numCodeLen; ++i) {
+    codeLenLens[kCodeLenOrder[i]] = r.Bits(3);
+  }
+  HuffmanTable codeLen;
+  if (!codeLen.Build(codeLenLens, kNumCodeLen)) {
+    return false;
+  }
+
+  uint8_t lens[kNumLitLen + kNumDist];
+  int n = 0;
+  while (n < numLitLen + numDist) {
+    int symbol = r.Decode(codeLen);
+    if (symbol < 0) {
+      return false;
+    }
+    if (symbol < 16) {
+      lens[n++] = symbol;
+      continue;
+    }
+    uint8_t len = 0;
+    int repeat;
+    if (symbol == 16) {
+      if (n == 0) {
+        return false;
+      }
+      len = lens[n - 1];
+      repeat = 3 + r.Bits(2);
+    } else if (symbol == 17) {
+      repeat = 3 + r.Bits(3);
+    } else {
+      repeat = 11 + r.Bits(7);
+    }
+    if (n + repeat > numLitLen + numDist) {
+      return false;
+    }
+    std::fill_n(lens + n, repeat, len);
+    n += repeat;
+  }
+  if (lens[kEndOfBlock] == 0) {
+    return false;
+  }
+  return litLen.Build(lens, numLitLen) && dist.Build(lens + numLitLen, numDist);
+}
+
+}  // namespace
+
+WebSocketInflater::WebSocketInflater(int windowBits)
+    : m_windowSize{size_t{1} << std::clamp(windowBits, 8, 15)} {}
+
+std::optional<std::span<const uint8_t>> WebSocketInflater::Decompress(
+    std::span<const uint8_t> in, size_t maxSize) {
+  if (m_history.size() > 2 * m_windowSize) {
+    m_history.erase(m_history.begin(), m_history.end() - m_windowSize);
+  }
+  size_t start = m_history.size();
+  size_t limit = maxSize < SIZE_MAX - start ? start + maxSize : SIZE_MAX;
+
+  BitReader r{in};
+  HuffmanTable dynLitLen;
+  HuffmanTable dynDist;
+  for (;;) {
+    bool final = r.Bits(1);
+    int type = r.Bits(2);
+    if (type == 0) {
+      r.AlignToByte();
+      uint32_t len = r.Bits(16);
+      if (r.Bits(16) != (~len & 0xffff) || m_history.size() + len > limit) {
+        return {};
+      }
+      for (uint32_t i = 0; i < len; ++i) {
+        m_history.push_back(r.Bits(8));
+      }
+    } else if (type == 1 || type == 2) {
+      const HuffmanTable* litLen;
+      const HuffmanTable* dist;
+      if (type == 1) {
+        litLen = &GetFixedTables().litLen;
+        dist = &GetFixedTables().dist;
+      } else {
+        if (!ReadDynamicTables(r, dynLitLen, dynDist)) {
+          return {};
+        }
+        litLen = &dynLitLen;
+        dist = &dynDist;
+      }
+      for (;;) {
+        int symbol = r.Decode(*litLen);
+        if (symbol < kEndOfBlock) {
+          if (symbol < 0 || m_history.size() >= limit) {
+            return {};
+          }
+          m_history.push_back(symbol);
+        } else if (symbol == kEndOfBlock) {
+          break;
+        } else {
+          symbol -= 257;
+          if (symbol >= 29) {
+            return {};
+          }
+          size_t len = kLengthBase[symbol] + r.Bits(kLengthExtra[symbol]);
+          symbol = r.Decode(*dist);
+          if (symbol < 0 || symbol >= kNumDist) {
+            return {};
+          }
+          size_t d = kDistBase[symbol] + r.Bits(kDistExtra[symbol]);
+          size_t size = m_history.size();
+          if (d > size || size + len > limit) {
+            return {};
+          }
+          m_history.resize(size + len);
+          uint8_t* dst = m_history.data() + size;
+          const uint8_t* src = dst - d;
+          if (d >= len) {
+            std::memcpy(dst, src, len);
+          } else {
+            for (size_t i = 0; i < len; ++i) {
+              dst[i] = src[i];
+            }
+          }
+        }
+        if (r.Overrun()) {
+          return {};
+        }
+      }
+    } else {
+      return {};
+    }
+    if (r.Overrun()) {
+      return {};
+    }
+    // a final block ends the stream, including the appended trailer
+    if (final || r.AtEnd()) {
+      break;
+    }
+  }
+  return std::span{m_history}.subspan(start);
+}
@@ -0,0 +1,97 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/net/detail/WebSocketMask.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WPINET_MASK_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define WPINET_MASK_NEON
+#endif
+
+void wpi::net::detail::WebSocketMaskCopy(uint8_t* dst, const uint8_t* src,
+                                         size_t len,
+                                         std::span<const uint8_t, 4> key,
+                                         size_t offset) {
+  size_t n = offset & 3;
+
+  // Bytes until dst is aligned to the vector width. Source loads stay
+  // unaligned since src and dst generally differ in alignment.
+  constexpr size_t kWidth = 16;
+  size_t head = (kWidth - (reinterpret_cast<uintptr_t>(dst) & (kWidth - 1))) &
+                (kWidth - 1);
+  if (head > len) {
+    head = len;
+  }
+  for (size_t i = 0; i < head; ++i) {
+    dst[i] = src[i] ^ key[n];
+    n = (n + 1) & 3;
+  }
+  dst += head;
+  src += head;
+  len -= head;
+
+  // key rotated to the current phase and repeated to the vector width
+  uint8_t pattern[16];
+  for (size_t i = 0; i < sizeof(pattern); ++i) {
+    pattern[i] = key[(n + i) & 3];
+  }
+
+  size_t i = 0;
+#if defined(WPINET_MASK_SSE2)
+  __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern));
+  for (; i + 64 <= len; i += 64) {
+    auto s = reinterpret_cast<const __m128i*>(src + i);
+    auto d = reinterpret_cast<__m128i*>(dst + i);
+    __m128i v0 = _mm_loadu_si128(s);
+    __m128i v1 = _mm_loadu_si128(s + 1);
+    __m128i v2 = _mm_loadu_si128(s + 2);
+    __m128i v3 = _mm_loadu_si128(s + 3);
+    _mm_store_si128(d, _mm_xor_si128(v0, k));
+    _mm_store_si128(d + 1, _mm_xor_si128(v1, k));
+    _mm_store_si128(d + 2, _mm_xor_si128(v2, k));
+    _mm_store_si128(d + 3, _mm_xor_si128(v3, k));
+  }
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_store_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(v, k));
+  }
+#elif defined(WPINET_MASK_NEON)
+  uint8x16_t k = vld1q_u8(pattern);
+  for (; i + 64 <= len; i += 64) {
+    uint8x16_t v0 = vld1q_u8(src + i);
+    uint8x16_t v1 = vld1q_u8(src + i + 16);
+    uint8x16_t v2 = vld1q_u8(src + i + 32);
+    uint8x16_t v3 = vld1q_u8(src + i + 48);
+    vst1q_u8(dst + i, veorq_u8(v0, k));
+    vst1q_u8(dst + i + 16, veorq_u8(v1, k));
+    vst1q_u8(dst + i + 32, veorq_u8(v2, k));
+    vst1q_u8(dst + i + 48, veorq_u8(v3, k));
+  }
+  for (; i + 16 <= len; i += 16) {
+    vst1q_u8(dst + i, veorq_u8(vld1q_u8(src + i), k));
+  }
+#endif
+
+  // word at a time for the remainder (or everything without SIMD); memcpy
+  // keeps the loads and stores well defined for any alignment
+  uint64_t k64;
+  std::memcpy(&k64, pattern, sizeof(k64));
+  for (; i + 8 <= len; i += 8) {
+    uint64_t v;
+    std::memcpy(&v, src + i, sizeof(v));
+    v ^= k64;
+    std::memcpy(dst + i, &v, sizeof(v));
+  }
+
+  // every step above is a multiple of 4 bytes, so the phase is unchanged
+  for (; i < len; ++i) {
+    dst[i] = src[i] ^ pattern[i & 3];
+  }
+}
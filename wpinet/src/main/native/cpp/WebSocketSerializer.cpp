@@ -6,6 +6,7 @@
 
 #include <random>
 
+#include "wpi/net/detail/WebSocketMask.hpp"
 #include "wpi/util/mutex.hpp"
 
 using namespace wpi::net::detail;
@@ -46,6 +47,70 @@ static std::span<uint8_t> BuildHeader(std::span<uint8_t, 10> header,
   return header.subspan(0, pHeader - header.data());
 }
 
+std::optional<std::span<const uint8_t>> FrameCompressor::Compress(
+    const WebSocket::Frame& frame, bool contextTakeover) {
+  // only complete messages are compressed
+  if (frame.opcode == WebSocket::Frame::TEXT) {
+    if (!m_compressText) {
+      return {};
+    }
+  } else if (frame.opcode == WebSocket::Frame::BINARY) {
+    if (!m_compressBinary) {
+      return {};
+    }
+  } else {
+    return {};
+  }
+  size_t size = 0;
+  for (auto&& buf : frame.data) {
+    size += buf.len;
+  }
+  if (size < m_threshold) {
+    return {};
+  }
+
+  contextTakeover = contextTakeover && m_contextTakeover;
+  if (!contextTakeover) {
+    m_deflater.Reset();
+  }
+  m_buf.clear();
+  m_deflater.Compress(frame.data, m_buf);
+  if (m_buf.size() >= size) {
+    // Not worth it; send uncompressed. The receiver only adds compressed
+    // messages to its window, so the message must be forgotten here too.
+    m_deflater.Reset();
+    return {};
+  }
+  if (!contextTakeover) {
+    m_deflater.Reset();
+  }
+  return m_buf;
+}
+
+size_t SerializedFrames::AddCompressedFrame(uint8_t opcode,
+                                            std::span<const uint8_t> data,
+                                            bool server) {
+  uv::Buffer dataBuf{data};
+  WebSocket::Frame frame{static_cast<uint8_t>(opcode | WebSocket::FLAG_RSV1),
+                         {&dataBuf, 1}};
+  if (!server) {
+    // client frames are copied for masking anyway
+    return AddClientFrame(frame);
+  }
+
+  // the compressor reuses its buffer, so copy the frame into its own
+  uint8_t headerBuf[10];
+  auto header = BuildHeader(headerBuf, true, frame);
+  size_t size = header.size() + data.size();
+  auto buf = uv::Buffer::Allocate(size);
+  std::memcpy(buf.base, header.data(), header.size());
+  std::memcpy(buf.base + header.size(), data.data(), data.size());
+  // the last alloc buf is used for packing headers; keep it there
+  m_allocBufs.insert(m_allocBufs.begin(), buf);
+  m_bufs.emplace_back(buf);
+  return size;
+}
+
 size_t SerializedFrames::AddClientFrame(const WebSocket::Frame& frame) {
   uint8_t headerBuf[10];
   auto header = BuildHeader(headerBuf, false, frame);
@@ -78,14 +143,12 @@ size_t SerializedFrames::AddClientFrame(const WebSocket::Frame& frame) {
   internalBuf += 4;
 
   // copy and mask data
-  int n = 0;
+  size_t offset = 0;
   for (auto&& buf : frame.data) {
-    for (auto&& ch : buf.data()) {
-      *internalBuf++ = static_cast<uint8_t>(ch) ^ key[n++];
-      if (n >= 4) {
-        n = 0;
-      }
-    }
+    WebSocketMaskCopy(reinterpret_cast<uint8_t*>(internalBuf) + offset,
+                      reinterpret_cast<const uint8_t*>(buf.base), buf.len, key,
+                      offset);
+    offset += buf.len;
   }
   return size;
 }
@@ -6,16 +6,46 @@
 
 #include <functional>
 #include <memory>
+#include <optional>
+#include <span>
 #include <utility>
 
 #include "WebSocketDebug.hpp"
 #include "wpi/net/WebSocket.hpp"
+#include "wpi/net/detail/WebSocketDeflate.hpp"
 #include "wpi/net/uv/Buffer.hpp"
 #include "wpi/util/SmallVector.hpp"
 #include "wpi/util/SpanExtras.hpp"
 
 namespace wpi::net::detail {
 
+// Outgoing message compression for the permessage-deflate extension
+class FrameCompressor {
+ public:
+  FrameCompressor(const WebSocket::DeflateOptions& options, int windowBits,
+                  bool contextTakeover)
+      : m_deflater{windowBits},
+        m_threshold{options.threshold},
+        m_compressText{options.compressText},
+        m_compressBinary{options.compressBinary},
+        m_contextTakeover{contextTakeover} {}
+
+  // Compresses the frame payload if the frame is a complete text or binary
+  // message worth compressing. The returned data is valid until the next
+  // call. contextTakeover=false compresses the message independently of the
+  // others, for frames that might be dropped rather than sent.
+  std::optional<std::span<const uint8_t>> Compress(
+      const WebSocket::Frame& frame, bool contextTakeover);
+
+ private:
+  WebSocketDeflater m_deflater;
+  size_t m_threshold;
+  bool m_compressText;
+  bool m_compressBinary;
+  bool m_contextTakeover;
+  wpi::util::SmallVector<uint8_t, 0> m_buf;
+};
+
 class SerializedFrames {
  public:
   SerializedFrames() = default;
@@ -23,7 +53,14 @@ class SerializedFrames {
   SerializedFrames& operator=(const SerializedFrames&) = delete;
   ~SerializedFrames() { ReleaseBufs(); }
 
-  size_t AddFrame(const WebSocket::Frame& frame, bool server) {
+  size_t AddFrame(const WebSocket::Frame& frame, bool server,
+                  FrameCompressor* compressor = nullptr,
+                  bool contextTakeover = true) {
+    if (compressor) {
+      if (auto data = compressor->Compress(frame, contextTakeover)) {
+        return AddCompressedFrame(frame.opcode, *data, server);
+      }
+    }
     if (server) {
       return AddServerFrame(frame);
     } else {
@@ -31,6 +68,9 @@ class SerializedFrames {
     }
   }
 
+  size_t AddCompressedFrame(uint8_t opcode, std::span<const uint8_t> data,
+                            bool server);
+
   size_t AddClientFrame(const WebSocket::Frame& frame);
   size_t AddServerFrame(const WebSocket::Frame& frame);
 
@@ -144,7 +184,8 @@ template <typename MakeReq, typename Stream>
 std::span<const WebSocket::Frame> TrySendFrames(
     bool server, Stream& stream, std::span<const WebSocket::Frame> frames,
     MakeReq&& makeReq,
-    std::function<void(std::span<uv::Buffer>, uv::Error)> callback) {
+    std::function<void(std::span<uv::Buffer>, uv::Error)> callback,
+    FrameCompressor* compressor = nullptr) {
   WS_DEBUG(stream, "TrySendFrames({})", frames.size());
   auto frameIt = frames.begin();
   auto frameEnd = frames.end();
@@ -156,7 +197,9 @@ std::span<const WebSocket::Frame> TrySendFrames(
     wpi::util::SmallVector<int, 32> frameOffs;
     int numBytes = 0;
     while (frameIt != frameEnd) {
-      numBytes += sendFrames.AddFrame(*frameIt++, server);
+      // unsent frames are returned to the caller and may never be sent, so
+      // compression can't carry context between messages
+      numBytes += sendFrames.AddFrame(*frameIt++, server, compressor, false);
       frameOffs.emplace_back(numBytes);
       if ((server && (numBytes >= 65536 || frameOffs.size() > 32)) ||
           (!server && numBytes >= 8192)) {
@@ -29,6 +29,12 @@ WebSocketServerHelper::WebSocketServerHelper(HttpParser& req) {
       m_key = value;
     } else if (wpi::util::equals_lower(name, "sec-websocket-version")) {
       m_version = value;
+    } else if (wpi::util::equals_lower(name, "sec-websocket-extensions")) {
+      // Extensions are comma delimited, repeated headers add to list
+      if (!m_extensions.empty()) {
+        m_extensions += ", ";
+      }
+      m_extensions += value;
     } else if (wpi::util::equals_lower(name, "sec-websocket-protocol")) {
       // Protocols are comma delimited, repeated headers add to list
       wpi::util::split(value, ',', -1, false, [&](auto protocol) {
@@ -124,7 +130,7 @@ WebSocketServer::WebSocketServer(uv::Stream& stream,
     auto self = shared_from_this();
 
     // Accept the upgrade
-    auto ws = m_helper.Accept(m_stream, protocol);
+    auto ws = m_helper.Accept(m_stream, protocol, m_options.deflate);
 
     // Connect the websocket open event to our connected event.
     ws->open.connect_extended(
@@ -6,6 +6,7 @@
 
 #include <initializer_list>
 #include <memory>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
@@ -63,7 +64,7 @@ class HttpWebSocketServerConnection
       auto self = this->shared_from_this();
 
       // Accept the upgrade
-      auto ws = m_helper.Accept(m_stream, protocol);
+      auto ws = m_helper.Accept(m_stream, protocol, m_deflateOptions);
 
       // Set this as the websocket user data to keep it around
       ws->SetData(self);
@@ -120,6 +121,12 @@ class HttpWebSocketServerConnection
    */
   WebSocket* m_websocket = nullptr;
 
+  /**
+   * If set, permessage-deflate extension offers from clients are accepted
+   * with these options.  Must be set before the upgrade is processed.
+   */
+  std::optional<WebSocket::DeflateOptions> m_deflateOptions;
+
  private:
   WebSocketServerHelper m_helper;
   wpi::util::SmallVector<std::string, 2> m_protocols;
@@ -6,9 +6,11 @@
 
 #include <stdint.h>
 
+#include <atomic>
 #include <functional>
 #include <initializer_list>
 #include <memory>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
@@ -26,6 +28,11 @@ namespace uv {
 class Stream;
 }  // namespace uv
 
+namespace detail {
+class FrameCompressor;
+class WebSocketInflater;
+}  // namespace detail
+
 /**
  * RFC 6455 compliant WebSocket client and server implementation.
  */
@@ -41,6 +48,7 @@ class WebSocket : public std::enable_shared_from_this<WebSocket> {
   static constexpr uint8_t OP_PONG = 0x0A;
   static constexpr uint8_t OP_MASK = 0x0F;
   static constexpr uint8_t FLAG_FIN = 0x80;
+  static constexpr uint8_t FLAG_RSV1 = 0x40;
   static constexpr uint8_t FLAG_CONTROL = 0x08;
 
   WebSocket(uv::Stream& stream, bool server, const private_init&);
@@ -66,6 +74,40 @@ class WebSocket : public std::enable_shared_from_this<WebSocket> {
     CLOSED
   };
 
+  /**
+   * Compression options for the permessage-deflate extension (RFC 7692).
+   * The no context takeover and window size parameters are negotiated with
+   * the peer; the rest only affect messages sent by this end.
+   */
+  struct DeflateOptions {
+    /**
+     * Compress each message sent by the server independently.  Saves memory
+     * on both ends at the cost of compression ratio.
+     */
+    bool serverNoContextTakeover = false;
+
+    /**
+     * Compress each message sent by the client independently.  Saves memory
+     * on both ends at the cost of compression ratio.
+     */
+    bool clientNoContextTakeover = false;
+
+    /** Log2 of the LZ77 window size (8-15) for messages sent by the server. */
+    int serverMaxWindowBits = 15;
+
+    /** Log2 of the LZ77 window size (8-15) for messages sent by the client. */
+    int clientMaxWindowBits = 15;
+
+    /** Messages smaller than this many bytes are sent uncompressed. */
+    size_t threshold = 128;
+
+    /** Compress outgoing text messages. */
+    bool compressText = true;
+
+    /** Compress outgoing binary messages. */
+    bool compressBinary = true;
+  };
+
   /**
    * Client connection options.
    */
@@ -77,6 +119,12 @@ class WebSocket : public std::enable_shared_from_this<WebSocket> {
 
     /** Additional headers to include in handshake. */
     std::span<const std::pair<std::string_view, std::string_view>> extraHeaders;
+
+    /**
+     * If set, offer the permessage-deflate extension to the server with these
+     * options.
+     */
+    std::optional<DeflateOptions> deflate;
   };
 
   /**
@@ -144,10 +192,15 @@ class WebSocket : public std::enable_shared_from_this<WebSocket> {
    *                client request
    * @param protocol The subprotocol to send to the client (in the
    *                 Sec-WebSocket-Protocol header field).
+   * @param extensions The value of the Sec-WebSocket-Extensions header
+   *                   field(s) in the client request
+   * @param deflate If set, accept a permessage-deflate extension offer from
+   *                the client with these options
    */
   static std::shared_ptr<WebSocket> CreateServer(
       uv::Stream& stream, std::string_view key, std::string_view version,
-      std::string_view protocol = {});
+      std::string_view protocol = {}, std::string_view extensions = {},
+      const std::optional<DeflateOptions>& deflate = {});
 
   /**
    * Get connection state.
@@ -170,6 +223,12 @@ class WebSocket : public std::enable_shared_from_this<WebSocket> {
    */
   std::string_view GetProtocol() const { return m_protocol; }
 
+  /**
+   * Return if the permessage-deflate extension is in use.  Only valid in or
+   * after the open() event.
+   */
+  bool IsDeflateEnabled() const { return m_inflater != nullptr; }
+
   /**
    * Set the maximum message size.  Default is 128 KB.  If configured to combine
    * fragments this maximum applies to the entire message (all combined
@@ -408,6 +467,9 @@ class WebSocket : public std::enable_shared_from_this<WebSocket> {
    * responsible for how to handle (e.g. re-send) those frames (e.g. when the
    * callback is called).
    *
+   * If permessage-deflate is in use, messages sent this way are compressed
+   * without context takeover, as returned frames may never be sent.
+   *
    * @param frames Frame type/data pairs
    * @param callback Callback which is invoked when the write completes of the
    *                 last frame that is not returned.
@@ -456,10 +518,13 @@ class WebSocket : public std::enable_shared_from_this<WebSocket> {
   void Shutdown();
 
   /**
-   * Gets the last time data was received on the stream.
+   * Gets the last time data was received on the stream. Unlike other functions,
+   * this may be called from any thread.
    * @return Timestamp
    */
-  uint64_t GetLastReceivedTime() const { return m_lastReceivedTime; }
+  uint64_t GetLastReceivedTime() const {
+    return m_lastReceivedTime.load(std::memory_order_relaxed);
+  }
 
   /**
    * Open event.  Emitted when the connection is open and ready to communicate.
@@ -525,7 +590,7 @@ class WebSocket : public std::enable_shared_from_this<WebSocket> {
   State m_state = State::CONNECTING;
 
   // incoming message buffers/state
-  uint64_t m_lastReceivedTime = 0;
+  std::atomic<uint64_t> m_lastReceivedTime{0};
   wpi::util::SmallVector<uint8_t, 14> m_header;
   size_t m_headerSize = 0;
   wpi::util::SmallVector<uint8_t, 1024> m_payload;
@@ -533,6 +598,12 @@ class WebSocket : public std::enable_shared_from_this<WebSocket> {
   size_t m_frameStart = 0;
   uint64_t m_frameSize = UINT64_MAX;
   uint8_t m_fragmentOpcode = 0;
+  bool m_compressedMessage = false;
+
+  // permessage-deflate state; null if not negotiated
+  std::unique_ptr<detail::FrameCompressor> m_compressor;
+  std::unique_ptr<detail::WebSocketInflater> m_inflater;
+  bool m_inflaterNoContextTakeover = false;
 
   // temporary data used only during client handshake
   class ClientHandshakeData;
@@ -542,7 +613,8 @@ class WebSocket : public std::enable_shared_from_this<WebSocket> {
                    std::span<const std::string_view> protocols,
                    const ClientOptions& options);
   void StartServer(std::string_view key, std::string_view version,
-                   std::string_view protocol);
+                   std::string_view protocol, std::string_view extensions,
+                   const std::optional<DeflateOptions>& deflate);
   void SendClose(uint16_t code, std::string_view reason);
   void SetClosed(uint16_t code, std::string_view reason, bool failed = false);
   void HandleIncoming(uv::Buffer& buf, size_t size);
@@ -7,6 +7,7 @@
 #include <functional>
 #include <initializer_list>
 #include <memory>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
@@ -85,10 +86,14 @@ class WebSocketServerHelper {
    * reader) before calling this.  See also WebSocket::CreateServer().
    * @param stream Connection stream
    * @param protocol The subprotocol to send to the client
+   * @param deflate If set, accept a permessage-deflate extension offer from
+   *                the client with these options
    */
-  std::shared_ptr<WebSocket> Accept(uv::Stream& stream,
-                                    std::string_view protocol = {}) {
-    return WebSocket::CreateServer(stream, m_key, m_version, protocol);
+  std::shared_ptr<WebSocket> Accept(
+      uv::Stream& stream, std::string_view protocol = {},
+      const std::optional<WebSocket::DeflateOptions>& deflate = {}) {
+    return WebSocket::CreateServer(stream, m_key, m_version, protocol,
+                                   m_extensions, deflate);
   }
 
   bool IsUpgrade() const { return m_gotHost && m_websocket; }
@@ -104,6 +109,7 @@ class WebSocketServerHelper {
   wpi::util::SmallVector<std::string, 2> m_protocols;
   wpi::util::SmallString<64> m_key;
   wpi::util::SmallString<16> m_version;
+  wpi::util::SmallString<64> m_extensions;
 };
 
 /**
@@ -128,6 +134,12 @@ class WebSocketServer : public std::enable_shared_from_this<WebSocketServer> {
      * default all hosts are accepted.
      */
     std::function<bool(std::string_view)> checkHost;
+
+    /**
+     * If set, accept permessage-deflate extension offers from clients with
+     * these options.  By default compression is not used.
+     */
+    std::optional<WebSocket::DeflateOptions> deflate;
   };
 
   /**
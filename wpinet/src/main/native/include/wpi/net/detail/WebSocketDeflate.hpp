@@ -0,0 +1,124 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "wpi/net/uv/Buffer.hpp"
+#include "wpi/util/SmallVector.hpp"
+
+namespace wpi::net::detail {
+
+/**
+ * Message compressor for the WebSocket permessage-deflate extension
+ * (RFC 7692). Produces raw DEFLATE data (RFC 1951) ending in a sync flush with
+ * the trailing empty stored block marker removed.
+ *
+ * By default the LZ77 window carries over between messages ("context
+ * takeover"); call Reset() before a message to compress it independently.
+ */
+class WebSocketDeflater {
+ public:
+  /**
+   * Constructor.
+   *
+   * @param windowBits log2 of the maximum back-reference distance (8-15)
+   */
+  explicit WebSocketDeflater(int windowBits = 15);
+
+  /**
+   * Compresses one message, appending the compressed data to out.
+   *
+   * @param in message data
+   * @param out output buffer
+   */
+  void Compress(std::span<const uint8_t> in,
+                wpi::util::SmallVectorImpl<uint8_t>& out) {
+    uv::Buffer buf{in};
+    Compress(std::span{&buf, 1}, out);
+  }
+
+  /**
+   * Compresses one message split across several buffers, appending the
+   * compressed data to out.
+   *
+   * @param in message data
+   * @param out output buffer
+   */
+  void Compress(std::span<const uv::Buffer> in,
+                wpi::util::SmallVectorImpl<uint8_t>& out);
+
+  /**
+   * Forgets all previous messages, so the next message is compressed
+   * independently of them.
+   */
+  void Reset();
+
+  /** LZ77 output: a literal byte or a back-reference. */
+  struct Token {
+    uint16_t litlen;  // literal byte, or match length
+    uint16_t dist;    // 0 for literals
+  };
+
+ private:
+  void FindMatches(size_t start, size_t end);
+  void WriteBlocks(size_t start, wpi::util::SmallVectorImpl<uint8_t>& out);
+
+  size_t m_windowSize;
+  // previous data (up to two windows) followed by the current message
+  std::vector<uint8_t> m_history;
+  // stream position of the start of m_history
+  int32_t m_offset = 0;
+  // stream positions before this were discarded by Reset()
+  int32_t m_validStart = 0;
+  // most recent stream position for each hash, or -1
+  std::vector<int32_t> m_head;
+  // previous stream position with the same hash, indexed by position & mask
+  std::vector<int32_t> m_prev;
+  std::vector<Token> m_tokens;
+};
+
+/**
+ * Message decompressor for the WebSocket permessage-deflate extension
+ * (RFC 7692).
+ */
+class WebSocketInflater {
+ public:
+  /**
+   * Constructor.
+   *
+   * @param windowBits log2 of the maximum back-reference distance (8-15)
+   */
+  explicit WebSocketInflater(int windowBits = 15);
+
+  /**
+   * Decompresses one message.
+   *
+   * @param in compressed message data (without the trailing sync marker)
+   * @param maxSize maximum decompressed size
+   * @return Decompressed data, valid until the next call, or empty on error
+   *         or if the message would exceed maxSize
+   */
+  std::optional<std::span<const uint8_t>> Decompress(
+      std::span<const uint8_t> in, size_t maxSize);
+
+  /**
+   * Forgets all previous messages. Used when the peer doesn't use context
+   * takeover, to save memory.
+   */
+  void Reset() { m_history.clear(); }
+
+ private:
+  size_t m_windowSize;
+  // previous output (up to two windows) followed by the current message
+  std::vector<uint8_t> m_history;
+};
+
+}  // namespace wpi::net::detail
@@ -0,0 +1,41 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <span>
+
+namespace wpi::net::detail {
+
+/**
+ * Copies data while applying a WebSocket masking key (RFC 6455 section 5.3).
+ * Masking and unmasking are the same operation. src and dst may be the same
+ * pointer to mask in place, but must not otherwise overlap.
+ *
+ * @param dst destination
+ * @param src source
+ * @param len number of bytes
+ * @param key masking key
+ * @param offset position of src[0] within the frame payload; used to continue
+ *               masking a payload that arrives in pieces
+ */
+void WebSocketMaskCopy(uint8_t* dst, const uint8_t* src, size_t len,
+                       std::span<const uint8_t, 4> key, size_t offset = 0);
+
+/**
+ * Applies a WebSocket masking key in place.
+ *
+ * @param data data
+ * @param key masking key
+ * @param offset position of data[0] within the frame payload
+ */
+inline void WebSocketMask(std::span<uint8_t> data,
+                          std::span<const uint8_t, 4> key, size_t offset = 0) {
+  WebSocketMaskCopy(data.data(), data.data(), data.size(), key, offset);
+}
+
+}  // namespace wpi::net::detail
@@ -0,0 +1,155 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/net/detail/WebSocketDeflate.hpp"
+
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+using wpi::net::detail::WebSocketDeflater;
+using wpi::net::detail::WebSocketInflater;
+
+static std::vector<uint8_t> MakeText(size_t len) {
+  static constexpr std::string_view words[] = {
+      "{\"name\":", "\"/SmartDashboard/", "value", "\"type\":\"double\"", "},",
+      "pubuid",     "properties",         "12",    "true",               ","};
+  std::vector<uint8_t> data;
+  uint32_t state = 1;
+  while (data.size() < len) {
+    state = state * 1103515245 + 12345;
+    auto word = words[(state >> 16) % std::size(words)];
+    data.insert(data.end(), word.begin(), word.end());
+  }
+  data.resize(len);
+  return data;
+}
+
+static std::vector<uint8_t> MakeNoise(size_t len) {
+  std::vector<uint8_t> data(len);
+  uint32_t state = 7;
+  for (auto&& v : data) {
+    state = state * 1103515245 + 12345;
+    v = state >> 24;
+  }
+  return data;
+}
+
+static std::vector<uint8_t> RoundTrip(WebSocketDeflater& deflater,
+                                      WebSocketInflater& inflater,
+                                      const std::vector<uint8_t>& data,
+                                      size_t* compressedSize = nullptr) {
+  wpi::util::SmallVector<uint8_t, 64> compressed;
+  deflater.Compress(data, compressed);
+  if (compressedSize) {
+    *compressedSize = compressed.size();
+  }
+  auto out = inflater.Decompress(compressed, SIZE_MAX);
+  REQUIRE(out);
+  return {out->begin(), out->end()};
+}
+
+TEST_CASE("WebSocketDeflateTest RoundTrip", "[wpinet][websocket]") {
+  auto len = GENERATE(0, 1, 2, 3, 10, 258, 300, 4000, 70000, 200000);
+  auto bits = GENERATE(8, 12, 15);
+  INFO("len " << len << " bits " << bits);
+
+  WebSocketDeflater deflater{bits};
+  WebSocketInflater inflater{bits};
+  auto text = MakeText(len);
+  size_t compressedSize;
+  CHECK(RoundTrip(deflater, inflater, text, &compressedSize) == text);
+  if (len >= 300) {
+    CHECK(compressedSize < text.size() / 2);
+  }
+  // incompressible data is stored, with little overhead
+  auto noise = MakeNoise(len);
+  CHECK(RoundTrip(deflater, inflater, noise, &compressedSize) == noise);
+  CHECK(compressedSize <= len + 16 + len / 1024);
+}
+
+TEST_CASE("WebSocketDeflateTest Empty", "[wpinet][websocket]") {
+  // an empty message is a single empty stored block header
+  WebSocketDeflater deflater;
+  wpi::util::SmallVector<uint8_t, 8> compressed;
+  deflater.Compress(std::span<const uint8_t>{}, compressed);
+  CHECK(compressed.size() == 1);
+  CHECK(compressed[0] == 0x00);
+}
+
+TEST_CASE("WebSocketDeflateTest ContextTakeover", "[wpinet][websocket]") {
+  WebSocketDeflater deflater;
+  WebSocketInflater inflater;
+  auto text = MakeText(2000);
+  size_t first, second;
+  CHECK(RoundTrip(deflater, inflater, text, &first) == text);
+  // a repeated message is a single back-reference into the previous one
+  CHECK(RoundTrip(deflater, inflater, text, &second) == text);
+  CHECK(second < first / 10);
+
+  // without context, it compresses the same as the first time
+  deflater.Reset();
+  size_t third;
+  CHECK(RoundTrip(deflater, inflater, text, &third) == text);
+  CHECK(third == first);
+}
+
+TEST_CASE("WebSocketDeflateTest LongStream", "[wpinet][websocket]") {
+  // many messages, enough to slide both windows several times
+  auto bits = GENERATE(9, 15);
+  WebSocketDeflater deflater{bits};
+  WebSocketInflater inflater{bits};
+  for (int i = 0; i < 200; ++i) {
+    auto text = MakeText(100 + (i * 997) % 3000);
+    text[i % text.size()] = 'x';
+    REQUIRE(RoundTrip(deflater, inflater, text) == text);
+  }
+}
+
+TEST_CASE("WebSocketDeflateTest Known", "[wpinet][websocket]") {
+  // "hello hello hello" compressed by zlib (raw, sync flush, trailer removed)
+  const uint8_t compressed[] = {0xca, 0x48, 0xcd, 0xc9, 0xc9, 0x57,
+                                0xc8, 0x40, 0x90, 0x00, 0x00};
+  WebSocketInflater inflater;
+  auto out = inflater.Decompress(compressed, SIZE_MAX);
+  REQUIRE(out);
+  CHECK(std::string_view{reinterpret_cast<const char*>(out->data()),
+                         out->size()} == "hello hello hello");
+}
+
+TEST_CASE("WebSocketDeflateTest MaxSize", "[wpinet][websocket]") {
+  WebSocketDeflater deflater;
+  auto text = MakeText(5000);
+  wpi::util::SmallVector<uint8_t, 64> compressed;
+  deflater.Compress(text, compressed);
+  CHECK_FALSE(WebSocketInflater{}.Decompress(compressed, 4999));
+  CHECK(WebSocketInflater{}.Decompress(compressed, 5000));
+}
+
+TEST_CASE("WebSocketDeflateTest Corrupt", "[wpinet][websocket]") {
+  // invalid block type
+  const uint8_t badType[] = {0x07};
+  CHECK_FALSE(WebSocketInflater{}.Decompress(badType, SIZE_MAX));
+  // stored block with mismatched length complement
+  const uint8_t badStored[] = {0x00, 0x05, 0x00, 0x00, 0x00};
+  CHECK_FALSE(WebSocketInflater{}.Decompress(badStored, SIZE_MAX));
+  // back-reference before the start of the stream
+  const uint8_t badDistance[] = {0x02, 0x02, 0x00};
+  CHECK_FALSE(WebSocketInflater{}.Decompress(badDistance, SIZE_MAX));
+
+  // corrupting valid data must fail cleanly or decode to something
+  auto text = MakeText(3000);
+  wpi::util::SmallVector<uint8_t, 64> compressed;
+  WebSocketDeflater{}.Compress(text, compressed);
+  for (size_t i = 0; i < compressed.size(); i += 7) {
+    auto corrupt = compressed;
+    corrupt[i] ^= 0x5a;
+    (void)WebSocketInflater{}.Decompress(corrupt, 10000);
+  }
+}
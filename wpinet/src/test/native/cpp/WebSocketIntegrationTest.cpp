@@ -6,6 +6,7 @@
 #include "wpi/net/WebSocketServer.hpp"
 // clang-format on
 
+#include <string>
 #include <vector>
 
 #include "WebSocketTest.hpp"
@@ -209,4 +210,122 @@ TEST_CASE_METHOD(WebSocketIntegrationTest,
   REQUIRE(gotData == 2);
 }
 
+static std::string MakeDeflateText(int n) {
+  std::string str = "[";
+  for (int i = 0; i < n; ++i) {
+    str += "{\"method\":\"announce\",\"params\":{\"name\":\"/topic";
+    str += std::to_string(i);
+    str += "\",\"type\":\"double\"}},";
+  }
+  str.back() = ']';
+  return str;
+}
+
+TEST_CASE_METHOD(WebSocketIntegrationTest, "WebSocketIntegrationTest Deflate",
+                 "[websocket][integration][deflate]") {
+  int gotServerData = 0;
+  int gotClientData = 0;
+  std::string text1 = MakeDeflateText(20);
+  std::string text2 = MakeDeflateText(30);
+
+  serverPipe->Listen([&]() {
+    auto conn = serverPipe->Accept();
+    WebSocketServer::ServerOptions options;
+    options.deflate = WebSocket::DeflateOptions{};
+    auto server = WebSocketServer::Create(*conn, {}, options);
+    server->connected.connect([&](std::string_view, WebSocket& ws) {
+      REQUIRE(ws.IsDeflateEnabled());
+      ws.text.connect([&, s = &ws](std::string_view data, bool fin) {
+        ++gotServerData;
+        REQUIRE(fin);
+        // echo back, once through each send path
+        if (gotServerData == 1) {
+          REQUIRE(data == text1);
+          s->SendText({{data}}, [&](auto, uv::Error) {});
+        } else {
+          REQUIRE(data == text2);
+          uv::Buffer buf{data};
+          WebSocket::Frame frame{WebSocket::Frame::TEXT, {&buf, 1}};
+          REQUIRE(s->TrySendFrames({&frame, 1}, [](auto, uv::Error) {})
+                      .empty());
+        }
+      });
+    });
+  });
+
+  clientPipe->Connect(pipeName, [&] {
+    WebSocket::ClientOptions options;
+    options.deflate = WebSocket::DeflateOptions{};
+    options.deflate->clientMaxWindowBits = 12;
+    auto ws =
+        WebSocket::CreateClient(*clientPipe, "/test", pipeName, {}, options);
+    ws->closed.connect([&](uint16_t code, std::string_view reason) {
+      Finish();
+      if (code != 1005 && code != 1006) {
+        FAIL("Code: " << code << " Reason: " << reason);
+      }
+    });
+    ws->open.connect([&, s = ws.get()](std::string_view) {
+      REQUIRE(s->IsDeflateEnabled());
+      s->SendText({{text1}}, [&](auto, uv::Error) {});
+    });
+    ws->text.connect([&, s = ws.get()](std::string_view data, bool) {
+      ++gotClientData;
+      if (gotClientData == 1) {
+        REQUIRE(data == text1);
+        s->SendText({{text2}}, [&](auto, uv::Error) {});
+      } else {
+        REQUIRE(data == text2);
+        s->Close();
+      }
+    });
+  });
+
+  loop->Run();
+
+  REQUIRE(gotServerData == 2);
+  REQUIRE(gotClientData == 2);
+}
+
+TEST_CASE_METHOD(WebSocketIntegrationTest,
+                 "WebSocketIntegrationTest DeflateNotAccepted",
+                 "[websocket][integration][deflate]") {
+  int gotData = 0;
+  std::string text = MakeDeflateText(10);
+
+  serverPipe->Listen([&]() {
+    auto conn = serverPipe->Accept();
+    auto server = WebSocketServer::Create(*conn);
+    server->connected.connect([&](std::string_view, WebSocket& ws) {
+      REQUIRE(!ws.IsDeflateEnabled());
+      ws.text.connect([&](std::string_view data, bool) {
+        ++gotData;
+        REQUIRE(data == text);
+      });
+    });
+  });
+
+  clientPipe->Connect(pipeName, [&] {
+    WebSocket::ClientOptions options;
+    options.deflate = WebSocket::DeflateOptions{};
+    auto ws =
+        WebSocket::CreateClient(*clientPipe, "/test", pipeName, {}, options);
+    ws->closed.connect([&](uint16_t code, std::string_view reason) {
+      Finish();
+      if (code != 1005 && code != 1006) {
+        FAIL("Code: " << code << " Reason: " << reason);
+      }
+    });
+    ws->open.connect([&, s = ws.get()](std::string_view) {
+      REQUIRE(!s->IsDeflateEnabled());
+      s->SendText({{text}}, [&](auto, uv::Error) {});
+      s->Close();
+    });
+  });
+
+  loop->Run();
+
+  REQUIRE(gotData == 1);
+}
+
 }  // namespace wpi::net
@@ -0,0 +1,82 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/net/detail/WebSocketMask.hpp"
+
+#include <stdint.h>
+
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+using wpi::net::detail::WebSocketMask;
+using wpi::net::detail::WebSocketMaskCopy;
+
+static const uint8_t testKey[4] = {0x37, 0xfa, 0x21, 0x3d};
+
+static std::vector<uint8_t> MakeData(size_t len) {
+  std::vector<uint8_t> data(len);
+  for (size_t i = 0; i < len; ++i) {
+    data[i] = static_cast<uint8_t>(i * 7 + 3);
+  }
+  return data;
+}
+
+static std::vector<uint8_t> ReferenceMask(const std::vector<uint8_t>& data,
+                                          size_t offset) {
+  std::vector<uint8_t> out(data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    out[i] = data[i] ^ testKey[(offset + i) % 4];
+  }
+  return out;
+}
+
+TEST_CASE("WebSocketMaskTest Copy", "[wpinet][websocket]") {
+  auto len = GENERATE(0, 1, 3, 4, 15, 16, 17, 63, 64, 65, 130, 1000);
+  auto offset = GENERATE(0, 1, 2, 3, 6);
+  auto srcAlign = GENERATE(0, 1, 5);
+  auto dstAlign = GENERATE(0, 3, 8);
+  INFO("len " << len << " offset " << offset << " src " << srcAlign << " dst "
+              << dstAlign);
+
+  auto data = MakeData(len);
+  std::vector<uint8_t> src(len + 16);
+  std::copy(data.begin(), data.end(), src.begin() + srcAlign);
+  std::vector<uint8_t> dst(len + 16);
+  WebSocketMaskCopy(dst.data() + dstAlign, src.data() + srcAlign, len, testKey,
+                    offset);
+  std::vector<uint8_t> actual(dst.begin() + dstAlign,
+                              dst.begin() + dstAlign + len);
+  CHECK(actual == ReferenceMask(data, offset));
+}
+
+TEST_CASE("WebSocketMaskTest InPlace", "[wpinet][websocket]") {
+  auto len = GENERATE(0, 5, 16, 77, 4096);
+  auto align = GENERATE(0, 1, 2, 7);
+  auto offset = GENERATE(0, 3);
+  INFO("len " << len << " align " << align << " offset " << offset);
+
+  auto data = MakeData(len);
+  std::vector<uint8_t> buf(len + 8);
+  std::copy(data.begin(), data.end(), buf.begin() + align);
+  WebSocketMask(std::span{buf}.subspan(align, len), testKey, offset);
+  std::vector<uint8_t> actual(buf.begin() + align, buf.begin() + align + len);
+  CHECK(actual == ReferenceMask(data, offset));
+}
+
+TEST_CASE("WebSocketMaskTest Pieces", "[wpinet][websocket]") {
+  // masking a payload in pieces matches masking it all at once
+  auto data = MakeData(301);
+  auto expected = ReferenceMask(data, 0);
+  std::vector<uint8_t> actual(data.size());
+  size_t pos = 0;
+  for (size_t piece : {1, 2, 17, 33, 100, 148}) {
+    WebSocketMaskCopy(actual.data() + pos, data.data() + pos, piece, testKey,
+                      pos);
+    pos += piece;
+  }
+  REQUIRE(pos == data.size());
+  CHECK(actual == expected);
+}
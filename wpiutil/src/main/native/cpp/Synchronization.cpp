@@ -6,8 +6,12 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
 #include <cstring>
 #include <mutex>
+#include <optional>
 
 #include "wpi/util/DenseMap.hpp"
 #include "wpi/util/SmallVector.hpp"
@@ -31,22 +35,49 @@ static std::atomic_int gActive{0};
 
 namespace {
 
+// A thread blocked in WaitForObjects. Signalers set the flag and notify under
+// the waiter's own mutex, so waking one waiter never touches other handles.
+struct Waiter {
+  wpi::util::mutex mutex;
+  wpi::util::condition_variable cv;
+  bool notified{false};
+
+  void Notify() {
+    {
+      std::scoped_lock lock{mutex};
+      notified = true;
+    }
+    cv.notify_all();
+  }
+};
+
 struct State {
   int signaled{0};
+  int maxCount{0};  // semaphores only
   bool autoReset{false};
-  wpi::util::SmallVector<wpi::util::condition_variable*, 2> waiters;
+  wpi::util::SmallVector<Waiter*, 2> waiters;
+};
+
+// Handle states are split across independently locked shards so that
+// unrelated handles (e.g. different NT listeners and notifiers) do not
+// contend on a single lock.
+struct alignas(64) Shard {
+  wpi::util::mutex mutex;
+  wpi::util::DenseMap<WPI_Handle, State> states;
 };
 
 struct HandleManager {
+  static constexpr int kShardBits = 5;
+
   ~HandleManager() {
     gActive.fetch_add(INT_MIN / 2);
 
     // wake up all waiters
-    {
-      std::scoped_lock lock{mutex};
-      for (auto&& [handle, state] : states) {
+    for (auto&& shard : shards) {
+      std::scoped_lock lock{shard.mutex};
+      for (auto&& [handle, state] : shard.states) {
         for (auto&& waiter : state.waiters) {
-          waiter->notify_all();
+          waiter->Notify();
         }
       }
     }
@@ -67,10 +98,17 @@ struct HandleManager {
     }
 #endif
   }
-  wpi::util::mutex mutex;
+
+  Shard& GetShard(WPI_Handle handle) {
+    // handles differ mostly in their low bits, so mix before picking a shard
+    return shards[(static_cast<uint32_t>(handle) * 0x9E3779B1u) >>
+                  (32 - kShardBits)];
+  }
+
+  wpi::util::mutex idMutex;
   wpi::util::UidVector<int, 8> eventIds;
   wpi::util::UidVector<int, 8> semaphoreIds;
-  wpi::util::DenseMap<WPI_Handle, State> states;
+  Shard shards[1 << kShardBits];
 };
 
 class ManagerGuard {
@@ -97,21 +135,31 @@ class ManagerGuard {
 
 }  // namespace
 
+static void InitState(HandleManager& manager, WPI_Handle handle, int signaled,
+                      int maxCount, bool autoReset) {
+  auto& shard = manager.GetShard(handle);
+  std::scoped_lock lock{shard.mutex};
+  auto& state = shard.states[handle];
+  state.signaled = signaled;
+  state.maxCount = maxCount;
+  state.autoReset = autoReset;
+}
+
 WPI_EventHandle wpi::util::MakeEvent(bool manualReset, bool initialState) {
   ManagerGuard guard;
   if (!guard) {
     return {};
   }
   auto& manager = guard.GetManager();
-  std::scoped_lock lock{manager.mutex};
-
-  auto index = manager.eventIds.emplace_back(0);
-  WPI_EventHandle handle = (HANDLE_TYPE_EVENT << 24) | (index & 0xffffff);
+  WPI_EventHandle handle;
+  {
+    std::scoped_lock lock{manager.idMutex};
+    auto index = manager.eventIds.emplace_back(0);
+    handle = (HANDLE_TYPE_EVENT << 24) | (index & 0xffffff);
+  }
 
   // configure state data
-  auto& state = manager.states[handle];
-  state.signaled = initialState ? 1 : 0;
-  state.autoReset = !manualReset;
+  InitState(manager, handle, initialState ? 1 : 0, 0, !manualReset);
   return handle;
 }
 
@@ -127,7 +175,7 @@ void wpi::util::DestroyEvent(WPI_EventHandle handle) {
     return;
   }
   auto& manager = guard.GetManager();
-  std::scoped_lock lock{manager.mutex};
+  std::scoped_lock lock{manager.idMutex};
   manager.eventIds.erase(handle & 0xffffff);
 }
 
@@ -154,16 +202,15 @@ WPI_SemaphoreHandle wpi::util::MakeSemaphore(int initialCount,
     return {};
   }
   auto& manager = guard.GetManager();
-  std::scoped_lock lock{manager.mutex};
-
-  auto index = manager.semaphoreIds.emplace_back(maximumCount);
-  WPI_EventHandle handle = (HANDLE_TYPE_SEMAPHORE << 24) | (index & 0xffffff);
+  WPI_SemaphoreHandle handle;
+  {
+    std::scoped_lock lock{manager.idMutex};
+    auto index = manager.semaphoreIds.emplace_back(maximumCount);
+    handle = (HANDLE_TYPE_SEMAPHORE << 24) | (index & 0xffffff);
+  }
 
   // configure state data
-  auto& state = manager.states[handle];
-  state.signaled = initialCount;
-  state.autoReset = true;
-
+  InitState(manager, handle, initialCount, maximumCount, true);
   return handle;
 }
 
@@ -179,7 +226,7 @@ void wpi::util::DestroySemaphore(WPI_SemaphoreHandle handle) {
     return;
   }
   auto& manager = guard.GetManager();
-  std::scoped_lock lock{manager.mutex};
+  std::scoped_lock lock{manager.idMutex};
   manager.semaphoreIds.erase(handle & 0xffffff);
 }
 
@@ -191,29 +238,27 @@ bool wpi::util::ReleaseSemaphore(WPI_SemaphoreHandle handle, int releaseCount,
   if (releaseCount <= 0) {
     return false;
   }
-  int index = handle & 0xffffff;
 
   ManagerGuard guard;
   if (!guard) {
     return true;
   }
-  auto& manager = guard.GetManager();
-  std::scoped_lock lock{manager.mutex};
-  auto it = manager.states.find(handle);
-  if (it == manager.states.end()) {
+  auto& shard = guard.GetManager().GetShard(handle);
+  std::scoped_lock lock{shard.mutex};
+  auto it = shard.states.find(handle);
+  if (it == shard.states.end()) {
     return false;
   }
   auto& state = it->second;
-  int maxCount = manager.semaphoreIds[index];
   if (prevCount) {
     *prevCount = state.signaled;
   }
-  if ((maxCount - state.signaled) < releaseCount) {
+  if ((state.maxCount - state.signaled) < releaseCount) {
     return false;
   }
   state.signaled += releaseCount;
   for (auto& waiter : state.waiters) {
-    waiter->notify_all();
+    waiter->Notify();
   }
   return true;
 }
@@ -249,34 +294,52 @@ std::span<WPI_Handle> wpi::util::WaitForObjects(
     return {};
   }
   auto& manager = guard.GetManager();
-  std::unique_lock lock{manager.mutex};
-  wpi::util::condition_variable cv;
+  // only constructed if we need to sleep
+  std::optional<Waiter> waiter;
   bool addedWaiters = false;
   bool timedOutVal = false;
   size_t count = 0;
+  std::chrono::steady_clock::time_point timeoutTime;
+  if (timeout > 0) {
+    timeoutTime = std::chrono::steady_clock::now() +
+                  std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::duration<double>(timeout));
+  }
 
   for (;;) {
+    // Check each handle under its shard lock. Once we know we need to sleep,
+    // the waiter is registered in the same critical section as the check, so
+    // a signal that arrives after the check always sees it and sets notified.
+    bool registerWaiter = waiter && !addedWaiters;
     for (auto handle : handles) {
-      auto it = manager.states.find(handle);
-      if (it == manager.states.end()) {
+      auto& shard = manager.GetShard(handle);
+      std::scoped_lock lock{shard.mutex};
+      auto it = shard.states.find(handle);
+      if (it == shard.states.end()) {
         if (count < signaled.size()) {
           // treat a non-existent handle as signaled, but set the error bit
           signaled[count++] = handle | 0x80000000ul;
         }
-      } else {
-        auto& state = it->second;
-        if (state.signaled > 0) {
-          if (count < signaled.size()) {
-            signaled[count++] = handle;
-          }
-          if (state.autoReset) {
-            --state.signaled;
-            if (state.signaled < 0) {
-              state.signaled = 0;
-            }
+        continue;
+      }
+      auto& state = it->second;
+      if (state.signaled > 0) {
+        if (count < signaled.size()) {
+          signaled[count++] = handle;
+        }
+        if (state.autoReset) {
+          --state.signaled;
+          if (state.signaled < 0) {
+            state.signaled = 0;
           }
         }
       }
+      if (registerWaiter) {
+        state.waiters.emplace_back(&*waiter);
+      }
+    }
+    if (registerWaiter) {
+      addedWaiters = true;
     }
 
     if (timedOutVal || count != 0) {
@@ -289,11 +352,9 @@ std::span<WPI_Handle> wpi::util::WaitForObjects(
     }
 
     if (!addedWaiters) {
-      addedWaiters = true;
-      for (auto handle : handles) {
-        auto& state = manager.states[handle];
-        state.waiters.emplace_back(&cv);
-      }
+      // check again, this time registering the waiter
+      waiter.emplace();
+      continue;
     }
 
     if (gActive.load(std::memory_order_acquire) < 0) {
@@ -303,14 +364,15 @@ std::span<WPI_Handle> wpi::util::WaitForObjects(
       break;
     }
 
-    if (timeout < 0) {
-      cv.wait(lock);
-    } else {
-      auto timeoutTime = std::chrono::steady_clock::now() +
-                         std::chrono::duration<double>(timeout);
-      if (cv.wait_until(lock, timeoutTime) == std::cv_status::timeout) {
+    {
+      std::unique_lock lock{waiter->mutex};
+      if (timeout < 0) {
+        waiter->cv.wait(lock, [&] { return waiter->notified; });
+      } else if (!waiter->cv.wait_until(lock, timeoutTime,
+                                        [&] { return waiter->notified; })) {
         timedOutVal = true;
       }
+      waiter->notified = false;
     }
 
     if (gActive.load(std::memory_order_acquire) < 0) {
@@ -323,10 +385,16 @@ std::span<WPI_Handle> wpi::util::WaitForObjects(
 
   if (addedWaiters) {
     for (auto handle : handles) {
-      auto& state = manager.states[handle];
-      auto it = std::find(state.waiters.begin(), state.waiters.end(), &cv);
-      if (it != state.waiters.end()) {
-        state.waiters.erase(it);
+      auto& shard = manager.GetShard(handle);
+      std::scoped_lock lock{shard.mutex};
+      auto it = shard.states.find(handle);
+      if (it == shard.states.end()) {
+        continue;
+      }
+      auto& waiters = it->second.waiters;
+      auto wit = std::find(waiters.begin(), waiters.end(), &*waiter);
+      if (wit != waiters.end()) {
+        waiters.erase(wit);
       }
     }
   }
@@ -344,11 +412,7 @@ void wpi::util::CreateSignalObject(WPI_Handle handle, bool manualReset,
   if (!guard) {
     return;
   }
-  auto& manager = guard.GetManager();
-  std::scoped_lock lock{manager.mutex};
-  auto& state = manager.states[handle];
-  state.signaled = initialState ? 1 : 0;
-  state.autoReset = !manualReset;
+  InitState(guard.GetManager(), handle, initialState ? 1 : 0, 0, !manualReset);
 }
 
 void wpi::util::SetSignalObject(WPI_Handle handle) {
@@ -356,16 +420,16 @@ void wpi::util::SetSignalObject(WPI_Handle handle) {
   if (!guard) {
     return;
   }
-  auto& manager = guard.GetManager();
-  std::scoped_lock lock{manager.mutex};
-  auto it = manager.states.find(handle);
-  if (it == manager.states.end()) {
+  auto& shard = guard.GetManager().GetShard(handle);
+  std::scoped_lock lock{shard.mutex};
+  auto it = shard.states.find(handle);
+  if (it == shard.states.end()) {
     return;
   }
   auto& state = it->second;
   state.signaled = 1;
   for (auto& waiter : state.waiters) {
-    waiter->notify_all();
+    waiter->Notify();
     if (state.autoReset) {
       // expect the first waiter to reset it
       break;
@@ -378,10 +442,10 @@ void wpi::util::ResetSignalObject(WPI_Handle handle) {
   if (!guard) {
     return;
   }
-  auto& manager = guard.GetManager();
-  std::scoped_lock lock{manager.mutex};
-  auto it = manager.states.find(handle);
-  if (it != manager.states.end()) {
+  auto& shard = guard.GetManager().GetShard(handle);
+  std::scoped_lock lock{shard.mutex};
+  auto it = shard.states.find(handle);
+  if (it != shard.states.end()) {
     it->second.signaled = 0;
   }
 }
@@ -391,16 +455,16 @@ void wpi::util::DestroySignalObject(WPI_Handle handle) {
   if (!guard) {
     return;
   }
-  auto& manager = guard.GetManager();
-  std::scoped_lock lock{manager.mutex};
+  auto& shard = guard.GetManager().GetShard(handle);
+  std::scoped_lock lock{shard.mutex};
 
-  auto it = manager.states.find(handle);
-  if (it != manager.states.end()) {
+  auto it = shard.states.find(handle);
+  if (it != shard.states.end()) {
     // wake up any waiters
     for (auto& waiter : it->second.waiters) {
-      waiter->notify_all();
+      waiter->Notify();
     }
-    manager.states.erase(it);
+    shard.states.erase(it);
   }
 }
 
@@ -84,6 +84,7 @@ void apply_pairs_helper(F&& f, Tuple&& t, std::index_sequence<I...>) {
 class json
 {
     friend bool operator==(const json& lhs, const json& rhs);
+    friend class json_reader;
   public:
     using array_t = std::vector<json>;
     using object_t = wpi::util::StringMap<json>;
@@ -416,6 +417,127 @@ class json
     static Status parse(json&, const char*&, const char*, int, int);
 };
 
+/**
+ * Streaming JSON parser.
+ *
+ * Rather than building a json tree, the input is returned as a sequence of
+ * events. Values of interest can be read as they're reached and the rest
+ * skipped, without allocating. Subtrees can still be parsed into a json with
+ * read_value().
+ *
+ * Accepts the same input as json::parse() and reports the same errors,
+ * although an error is only reported once the parser reaches it.
+ */
+class json_reader
+{
+  public:
+    enum class Event
+    {
+        Error,
+        End, // end of input, after the top-level value
+        BeginArray,
+        EndArray,
+        BeginObject,
+        EndObject,
+        Key, // object key; see string()
+        String, // string value; see string()
+        Value // null, bool, or number value; see value()
+    };
+
+    explicit json_reader(std::string_view in);
+
+    /**
+     * Parses up to the next event.
+     */
+    Event next();
+
+    /**
+     * Parses the next value (which must not be the end of an array) into a
+     * json.
+     *
+     * @return false on error
+     */
+    bool read_value(json& out);
+
+    /**
+     * Skips the next value (which must not be the end of an array).
+     *
+     * @return false on error
+     */
+    bool skip_value();
+
+    /**
+     * Skips the rest of the array or object most recently begun, including
+     * its end.
+     *
+     * @return false on error
+     */
+    bool skip_container();
+
+    /**
+     * The key or string for a Key or String event. Valid until the next call.
+     */
+    std::string_view string() const
+    {
+        return string_;
+    }
+
+    /**
+     * The value for a Value event. Valid until the next call.
+     */
+    const json& value() const
+    {
+        return value_;
+    }
+
+    /**
+     * Number of arrays and objects currently open.
+     */
+    int depth() const
+    {
+        return depth_;
+    }
+
+    /**
+     * Description of the error after an Error event.
+     */
+    const char* error() const
+    {
+        return json::StatusToString(status_);
+    }
+
+  private:
+    enum State
+    {
+        ValueState,
+        FirstValueState, // first array element, or end of array
+        KeyState,
+        FirstKeyState, // first object key, or end of object
+        AfterValueState, // comma or end of container
+        EndState,
+        ErrorState
+    };
+
+    bool read_string();
+    Event begin(bool object);
+    Event end();
+    void value_done();
+    Event fail(json::Status status);
+    Event fail_with_context(int context);
+
+    const char* p_;
+    const char* e_;
+    State state_ = ValueState;
+    json::Status status_ = json::success;
+    int depth_ = 0;
+    // bit n is set if the container at depth n + 1 is an object
+    unsigned objects_ = 0;
+    std::string_view string_;
+    json value_;
+    // unescaped strings
+    json scratch_;
+};
+
 bool operator==(const json& lhs, const json& rhs);
 inline bool operator!=(const json& lhs, const json& rhs) {
     return !(lhs == rhs);
@@ -1538,6 +1538,234 @@ json::StatusToString(json::Status status)
     }
 }
 
+json_reader::json_reader(std::string_view in)
+  : p_(in.data()), e_(in.data() + in.size())
+{
+}
+
+json_reader::Event
+json_reader::next()
+{
+    for (;;) {
+        while (p_ < e_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' ||
+                           *p_ == '\t'))
+            ++p_;
+        switch (state_) {
+            case ErrorState:
+                return Event::Error;
+
+            case EndState:
+                if (p_ < e_)
+                    return fail(json::trailing_content);
+                return Event::End;
+
+            case AfterValueState: {
+                if (p_ == e_)
+                    return fail(json::unexpected_eof);
+                bool object = objects_ & (1u << (depth_ - 1));
+                if (*p_ == ',') {
+                    ++p_;
+                    state_ = object ? KeyState : ValueState;
+                    break;
+                }
+                if (*p_ == (object ? '}' : ']')) {
+                    ++p_;
+                    return end();
+                }
+                return fail_with_context(object ? KEY | COMMA | OBJECT
+                                                : ARRAY | COMMA);
+            }
+
+            case KeyState:
+            case FirstKeyState:
+                if (p_ == e_)
+                    return fail(json::unexpected_eof);
+                if (*p_ == '}' && state_ == FirstKeyState) {
+                    ++p_;
+                    return end();
+                }
+                if (*p_ != '"') {
+                    if (state_ == FirstKeyState)
+                        return fail_with_context(KEY | OBJECT);
+                    // a key following a comma is parsed without context
+                    json key;
+                    json::Status status =
+                      json::parse(key, p_, e_, 0, DEPTH - depth_);
+                    return fail(status == json::success
+                                  ? json::object_key_must_be_string
+                                  : status);
+                }
+                if (!read_string())
+                    return Event::Error;
+                while (p_ < e_ && (*p_ == ' ' || *p_ == '\n' ||
+                                   *p_ == '\r' || *p_ == '\t'))
+                    ++p_;
+                if (p_ == e_)
+                    return fail(json::unexpected_eof);
+                if (*p_ != ':')
+                    return fail_with_context(COLON);
+                ++p_;
+                state_ = ValueState;
+                return Event::Key;
+
+            case ValueState:
+            case FirstValueState:
+                if (p_ == e_)
+                    return fail(depth_ == 0 ? json::absent_value
+                                            : json::unexpected_eof);
+                switch (*p_) {
+                    case ']':
+                        if (state_ == FirstValueState) {
+                            ++p_;
+                            return end();
+                        }
+                        break;
+                    case '[':
+                        return begin(false);
+                    case '{':
+                        return begin(true);
+                    case '"':
+                        if (!read_string())
+                            return Event::Error;
+                        value_done();
+                        return Event::String;
+                    default:
+                        break;
+                }
+                value_.clear();
+                json::Status status =
+                  json::parse(value_, p_, e_, 0, DEPTH - depth_);
+                if (status != json::success)
+                    return fail(status);
+                value_done();
+                return Event::Value;
+        }
+    }
+}
+
+bool
+json_reader::read_value(json& out)
+{
+    if (state_ == ErrorState)
+        return false;
+    if (state_ != ValueState && state_ != FirstValueState)
+        ON_LOGIC_ERROR("No JSON value expected here.");
+    while (p_ < e_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' ||
+                       *p_ == '\t'))
+        ++p_;
+    if (p_ == e_) {
+        fail(depth_ == 0 ? json::absent_value : json::unexpected_eof);
+        return false;
+    }
+    out.clear();
+    json::Status status = json::parse(out, p_, e_, 0, DEPTH - depth_);
+    if (status != json::success) {
+        fail(status);
+        return false;
+    }
+    value_done();
+    return true;
+}
+
+bool
+json_reader::skip_value()
+{
+    switch (next()) {
+        case Event::BeginArray:
+        case Event::BeginObject:
+            return skip_container();
+        case Event::String:
+        case Event::Value:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool
+json_reader::skip_container()
+{
+    for (int depth = depth_; depth_ >= depth;) {
+        if (next() == Event::Error)
+            return false;
+    }
+    return true;
+}
+
+bool
+json_reader::read_string()
+{
+    // fast path: printable ASCII without escapes is used in place
+    const char* s = p_ + 1;
+    const char* q = s;
+    while (q < e_ && kJsonStr[*q & 255] == ASCII)
+        ++q;
+    if (q < e_ && *q == '"') {
+        string_ = std::string_view(s, q - s);
+        p_ = q + 1;
+        return true;
+    }
+    scratch_.clear();
+    json::Status status = json::parse(scratch_, p_, e_, 0, DEPTH - depth_);
+    if (status != json::success) {
+        fail(status);
+        return false;
+    }
+    string_ = scratch_.string_value;
+    return true;
+}
+
+json_reader::Event
+json_reader::begin(bool object)
+{
+    // matches the nesting json::parse() allows
+    if (depth_ + 1 >= DEPTH)
+        return fail(json::depth_exceeded);
+    ++p_;
+    if (object)
+        objects_ |= 1u << depth_;
+    else
+        objects_ &= ~(1u << depth_);
+    ++depth_;
+    state_ = object ? FirstKeyState : FirstValueState;
+    return object ? Event::BeginObject : Event::BeginArray;
+}
+
+json_reader::Event
+json_reader::end()
+{
+    --depth_;
+    bool object = objects_ & (1u << depth_);
+    value_done();
+    return object ? Event::EndObject : Event::EndArray;
+}
+
+void
+json_reader::value_done()
+{
+    state_ = depth_ == 0 ? EndState : AfterValueState;
+}
+
+json_reader::Event
+json_reader::fail(json::Status status)
+{
+    status_ = status;
+    state_ = ErrorState;
+    return Event::Error;
+}
+
+json_reader::Event
+json_reader::fail_with_context(int context)
+{
+    // report whatever json::parse() would for the unexpected token
+    json tmp;
+    json::Status status = json::parse(tmp, p_, e_, context, DEPTH - depth_);
+    if (status == json::success || status == json::absent_value)
+        status = context & KEY ? json::object_key_must_be_string
+                               : json::illegal_character;
+    return fail(status);
+}
+
 bool
 operator==(const json& lhs, const json& rhs) {
     if (lhs.type_ != rhs.type_)
@@ -4,7 +4,9 @@
 
 #include "wpi/util/Synchronization.hpp"
 
+#include <algorithm>
 #include <thread>
+#include <vector>
 
 #include <catch2/catch_template_test_macros.hpp>
 #include <catch2/catch_test_macros.hpp>
@@ -59,3 +61,79 @@ TEST_CASE("EventTest WaitMultiple", "[wpiutil]") {
   REQUIRE(timedOut == true);
   REQUIRE(result2.size() == 0u);
 }
+
+TEST_CASE("SemaphoreTest Release", "[wpiutil]") {
+  auto sem = wpi::util::MakeSemaphore(0, 2);
+  int prev;
+  REQUIRE(wpi::util::ReleaseSemaphore(sem, 2, &prev));
+  REQUIRE(prev == 0);
+  REQUIRE_FALSE(wpi::util::ReleaseSemaphore(sem, 1, &prev));
+  REQUIRE(prev == 2);
+  bool timedOut;
+  REQUIRE(wpi::util::WaitForObject(sem, 0, &timedOut));
+  REQUIRE(wpi::util::WaitForObject(sem, 0, &timedOut));
+  wpi::util::WaitForObject(sem, 0, &timedOut);
+  REQUIRE(timedOut == true);
+  wpi::util::DestroySemaphore(sem);
+}
+
+TEST_CASE("EventTest Timeout", "[wpiutil]") {
+  auto event = wpi::util::MakeEvent(false, false);
+  bool timedOut = false;
+  REQUIRE_FALSE(wpi::util::WaitForObject(event, 0.01, &timedOut));
+  REQUIRE(timedOut == true);
+  wpi::util::DestroyEvent(event);
+}
+
+TEST_CASE("EventTest DestroyWakesWaiter", "[wpiutil]") {
+  auto event = wpi::util::MakeEvent(false, false);
+  std::thread thr([&] { wpi::util::DestroyEvent(event); });
+  REQUIRE_FALSE(wpi::util::WaitForObject(event));
+  thr.join();
+}
+
+TEST_CASE("EventTest ManyThreads", "[wpiutil]") {
+  // each thread ping-pongs with the main thread on its own pair of events
+  constexpr int kThreads = 8;
+  constexpr int kIterations = 1000;
+  WPI_EventHandle requests[kThreads];
+  WPI_EventHandle responses[kThreads];
+  for (int i = 0; i < kThreads; ++i) {
+    requests[i] = wpi::util::MakeEvent(false, false);
+    responses[i] = wpi::util::MakeEvent(false, false);
+  }
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&, i] {
+      for (int j = 0; j < kIterations; ++j) {
+        wpi::util::WaitForObject(requests[i]);
+        wpi::util::SetEvent(responses[i]);
+      }
+    });
+  }
+  int received[kThreads] = {};
+  for (int i = 0; i < kThreads; ++i) {
+    wpi::util::SetEvent(requests[i]);
+  }
+  int remaining = kThreads * kIterations;
+  WPI_Handle signaled[kThreads];
+  while (remaining > 0) {
+    for (auto handle : wpi::util::WaitForObjects(responses, signaled)) {
+      REQUIRE((handle & 0x80000000ul) == 0);
+      int i = std::find(responses, responses + kThreads, handle) - responses;
+      REQUIRE(i < kThreads);
+      --remaining;
+      if (++received[i] < kIterations) {
+        wpi::util::SetEvent(requests[i]);
+      }
+    }
+  }
+  for (auto&& thr : threads) {
+    thr.join();
+  }
+  for (int i = 0; i < kThreads; ++i) {
+    REQUIRE(received[i] == kIterations);
+    wpi::util::DestroyEvent(requests[i]);
+    wpi::util::DestroyEvent(responses[i]);
+  }
+}
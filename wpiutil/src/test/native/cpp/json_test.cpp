@@ -4,6 +4,8 @@
 
 #include "wpi/util/json.hpp"
 
+#include <string_view>
+
 #include <catch2/catch_template_test_macros.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
@@ -60,4 +62,63 @@ TEST_CASE("JsonTest BoolArray", "[wpiutil]") {
   CHECK(j[2].get_bool());
 }
 
+TEST_CASE("JsonReaderTest Events", "[wpiutil]") {
+  using enum json_reader::Event;
+  json_reader r{R"({"a":[1,"x\ty",null],"b\u00e9":{}})"};
+  CHECK(r.next() == BeginObject);
+  CHECK(r.depth() == 1);
+  REQUIRE(r.next() == Key);
+  CHECK(r.string() == "a");
+  CHECK(r.next() == BeginArray);
+  CHECK(r.depth() == 2);
+  REQUIRE(r.next() == Value);
+  CHECK(r.value().get_int() == 1);
+  REQUIRE(r.next() == String);
+  CHECK(r.string() == "x\ty");
+  REQUIRE(r.next() == Value);
+  CHECK(r.value().is_null());
+  CHECK(r.next() == EndArray);
+  REQUIRE(r.next() == Key);
+  CHECK(r.string() == "b\xc3\xa9");
+  CHECK(r.next() == BeginObject);
+  CHECK(r.next() == EndObject);
+  CHECK(r.next() == EndObject);
+  CHECK(r.depth() == 0);
+  CHECK(r.next() == End);
+  CHECK(r.next() == End);
+}
+
+TEST_CASE("JsonReaderTest ReadAndSkip", "[wpiutil]") {
+  using enum json_reader::Event;
+  json_reader r{R"([{"k":[1,{"x":2}]},[3,[4]],5,"s"])"};
+  REQUIRE(r.next() == BeginArray);
+  json j;
+  REQUIRE(r.read_value(j));
+  CHECK(j == json::parse_or_throw(R"({"k":[1,{"x":2}]})"));
+  REQUIRE(r.next() == BeginArray);
+  REQUIRE(r.skip_container());
+  CHECK(r.depth() == 1);
+  REQUIRE(r.skip_value());
+  REQUIRE(r.next() == String);
+  CHECK(r.string() == "s");
+  CHECK(r.next() == EndArray);
+  CHECK(r.next() == End);
+}
+
+TEST_CASE("JsonReaderTest ErrorsMatchParse", "[wpiutil]") {
+  for (std::string_view in :
+       {"", "[", "[1,]", "{\"a\" 1}", "{1:2}", "[1 2]", "[1]]", "\"\\x\"",
+        "[\"\x01\"]", "{\"a\":}", "[-]", "[01]"}) {
+    INFO(in);
+    json_reader r{in};
+    json_reader::Event event;
+    while ((event = r.next()) != json_reader::Event::Error) {
+      REQUIRE(event != json_reader::Event::End);
+    }
+    auto expected = json::parse(in);
+    REQUIRE_FALSE(expected);
+    CHECK(std::string_view{r.error()} == expected.error());
+  }
+}
+
 }  // namespace wpi::util